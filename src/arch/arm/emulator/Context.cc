@@ -181,6 +181,7 @@ void Context::Load(const std::vector<std::string> &args,
 	// Create new memory image
 	assert(!memory.get());
 	memory.reset(new mem::Memory());
+	decode_cache.reset(new mem::DecodeCache<DecodedInst, 2>(memory.get()));
 	address_space_index = emulator->getAddressSpaceIndex();
 
 	// Create signal handler table
@@ -455,6 +456,51 @@ void Context::Execute()
 		}
 	}
 
+	// Look for the instruction in the decode cache. A Thumb instruction
+	// in the last half word of a page may continue in the next page, so
+	// it is always fetched from memory.
+	bool thumb = regs.getCPSR().thumb != 0;
+	unsigned address = regs.getPC() - (thumb ? 2 : 4);
+	unsigned offset = address & (mem::Memory::PageSize - 1);
+	DecodedInst *decoded = nullptr;
+	if (Emulator::getDecodeCacheEnabled() && !(address & (thumb ? 1 : 3))
+			&& offset < mem::Memory::PageSize - 2)
+		decoded = decode_cache->Lookup(address,
+				[this, thumb, address](DecodedInst &decoded,
+				const char *buffer)
+				{
+					DecodeInst(decoded, thumb, address, buffer);
+				});
+	if (decoded && (decoded->type == ContextInstTypeArm32) == !thumb)
+	{
+		inst = decoded->inst;
+		setInstType(decoded->type);
+		if (decoded->type == ContextInstTypeThumb32)
+			regs.incPC(2);
+		memory->setSafeDefault();
+	}
+	else
+	{
+		FetchInst();
+	}
+
+	// Execute instruction
+	if(iteq_inst_num != 0 && iteq_block_flag != 0)
+	{
+		//TODO
+	}
+	else
+	{
+		ExecuteInst();
+	}
+
+	// Stats
+	emulator->incNumInstructions();
+}
+
+
+void Context::FetchInst()
+{
 	// Get buffer according to the Program Counter
 	char *buffer_ptr;
 	if (regs.getCPSR().thumb != 0)
@@ -495,19 +541,34 @@ void Context::Execute()
 			throw misc::Panic(misc::fmt("0x%x: not supported arm instruction (%02x %02x %02x %02x...)",
 					(regs.getPC() - 4), buffer_ptr[0], buffer_ptr[1], buffer_ptr[2], buffer_ptr[3]));
 	}
+}
 
-	// Execute instruction
-	if(iteq_inst_num != 0 && iteq_block_flag != 0)
+
+void Context::DecodeInst(DecodedInst &decoded, bool thumb, unsigned address,
+		const char *buffer)
+{
+	Instruction &inst = decoded.inst;
+	if (thumb && IsThumb32(buffer))
 	{
-		//TODO
+		inst.Thumb32Decode(buffer, address);
+		decoded.type = ContextInstTypeThumb32;
+		if (inst.getThumb32Opcode() == Instruction::Thumb32OpcodeInvalid)
+			throw misc::Panic(misc::fmt("0x%x: not supported arm instruction (%02x %02x %02x %02x...)",
+				address, buffer[0], buffer[1], buffer[2], buffer[3]));
+	}
+	else if (thumb)
+	{
+		inst.Thumb16Decode(buffer, address);
+		decoded.type = ContextInstTypeThumb16;
 	}
 	else
 	{
-		ExecuteInst();
+		inst.Decode(address, buffer);
+		decoded.type = ContextInstTypeArm32;
+		if (inst.getOpcode() == Instruction::OpcodeInvalid)
+			throw misc::Panic(misc::fmt("0x%x: not supported arm instruction (%02x %02x %02x %02x...)",
+				address, buffer[0], buffer[1], buffer[2], buffer[3]));
 	}
-
-	// Stats
-	emulator->incNumInstructions();
 }
 
 
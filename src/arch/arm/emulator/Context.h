@@ -28,6 +28,7 @@
 #include <arch/arm/disassembler/Instruction.h>
 #include <arch/arm/disassembler/Disassembler.h>
 #include <lib/cpp/ELFReader.h>
+#include <memory/DecodeCache.h>
 #include <memory/Memory.h>
 #include <memory/SpecMem.h>
 #include <arch/common/FileTable.h>
@@ -153,6 +154,19 @@ class Context
 	// this memory object will be the one automatically freeing it.
 	std::shared_ptr<mem::Memory> memory;
 
+	// Instruction in the decode cache, with the type given by the mode
+	// it was decoded in
+	struct DecodedInst
+	{
+		Instruction inst;
+		ContextInstType type = ContextInstTypeArm32;
+	};
+
+	// Decoded instructions of the code pages in the memory, with one slot
+	// per half word to hold both ARM and Thumb instructions. This object
+	// is shared by all contexts sharing the memory object.
+	std::shared_ptr<mem::DecodeCache<DecodedInst, 2>> decode_cache;
+
 	// Speculative memory. Its initialization is deferred to be able to link
 	// it with the actual memory, known only at context creation.
 	std::unique_ptr<mem::SpecMem> spec_mem;
@@ -191,6 +205,15 @@ class Context
 	// Get instruction type
 	ContextInstType getInstType() { return inst_type; }
 
+	// Fetch and decode the instruction at the program counter from memory
+	// into 'inst', advancing the program counter for Thumb32 instructions
+	void FetchInst();
+
+	// Decode an instruction for the decode cache, given the bytes at its
+	// address in memory
+	void DecodeInst(DecodedInst &decoded, bool thumb, unsigned address,
+			const char *buffer);
+
 	// symbol list used for getting the ARM operating mode
 	std::vector<ELFReader::Symbol *> thumb_symbol_list;
 
@@ -35,6 +35,9 @@ std::string Emulator::isa_debug_file;
 std::string Emulator::context_debug_file;
 std::string Emulator::syscall_debug_file;
 
+// Decoded instruction cache
+bool Emulator::no_decode_cache = false;
+
 // Maximum number of instructions
 long long Emulator::max_instructions;
 
@@ -91,6 +94,14 @@ void Emulator::RegisterOptions()
 			"Debug information for system calls performed by a ARM "
 			"program, including system call code, arguments, and "
 			"return value.");
+
+	// Option --arm-no-decode-cache
+	command_line->RegisterBool("--arm-no-decode-cache", no_decode_cache,
+			"Decode every ARM and Thumb instruction each time it is "
+			"executed, instead of reusing instructions decoded before "
+			"in the same code page. Useful to compare emulation "
+			"throughput (reported as 'InstructionsPerSecond' in the "
+			"statistics summary) with and without the cache.");
 }
 
 
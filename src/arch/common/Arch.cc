@@ -114,6 +114,8 @@ void ArchPool::Run(int &num_active_emulators, int &num_active_timing_simulators)
 				continue;
 
 			// Run
+			esim::ProfilerScope profiler_scope(
+					arch->getEmulatorProfilerRegion());
 			bool active = emulator->Run();
 			arch->setActive(active);
                            
@@ -155,6 +157,8 @@ void ArchPool::Run(int &num_active_emulators, int &num_active_timing_simulators)
 			}
 
 			// Run
+			esim::ProfilerScope profiler_scope(
+					arch->getTimingProfilerRegion());
 			bool active = timing->Run();
 			arch->setActive(active);
 
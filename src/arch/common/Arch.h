@@ -25,6 +25,7 @@
 #include <memory>
 
 #include <lib/cpp/String.h>
+#include <lib/esim/Profiler.h>
 
 
 namespace comm
@@ -73,6 +74,10 @@ private:
 	// True if last iteration had an active simulation
 	bool active = false;
 
+	// Profiler regions measuring the emulator and the timing simulator
+	esim::ProfilerRegion *emulator_profiler_region;
+	esim::ProfilerRegion *timing_profiler_region;
+
 public:
 
 	/// Constructor of a new architecture. New architectures should be
@@ -82,7 +87,14 @@ public:
 	/// \param name
 	///	Name of the architecture
 	///
-	Arch(const std::string &name) : name(name) { }
+	Arch(const std::string &name) :
+			name(name),
+			emulator_profiler_region(esim::Profiler::getRegion(
+					name + ".Emulator")),
+			timing_profiler_region(esim::Profiler::getRegion(
+					name + ".Timing"))
+	{
+	}
 
 	/// Return the name of the architecture
 	const std::string &getName() const { return name; }
@@ -134,6 +146,18 @@ public:
 	/// active. This is done only internally in the architecture pool (call
 	/// ArchPool::Run()).
 	void setActive(bool active) { this->active = active; }
+
+	/// Return the profiler region measuring the emulator
+	esim::ProfilerRegion *getEmulatorProfilerRegion() const
+	{
+		return emulator_profiler_region;
+	}
+
+	/// Return the profiler region measuring the timing simulator
+	esim::ProfilerRegion *getTimingProfilerRegion() const
+	{
+		return timing_profiler_region;
+	}
 };
 
 
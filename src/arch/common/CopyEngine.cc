@@ -0,0 +1,402 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <fstream>
+
+#include <lib/cpp/CommandLine.h>
+#include <lib/cpp/Misc.h>
+#include <lib/cpp/String.h>
+#include <lib/esim/Engine.h>
+
+#include "Context.h"
+#include "CopyEngine.h"
+
+
+namespace comm
+{
+
+//
+// Configuration options
+//
+
+std::string CopyEngine::config_file;
+
+std::string CopyEngine::report_file;
+
+std::string CopyEngine::debug_file;
+
+bool CopyEngine::help = false;
+
+const std::string CopyEngine::help_message =
+	"The copy engine configuration file is a plain text INI file passed\n"
+	"with option '--copy-engine-config <file>'. It defines the timing\n"
+	"of the DMA engines moving data between host memory and the memory\n"
+	"of GPU devices (e.g., 'clEnqueueWriteBuffer' or 'cudaMemcpy'). Only\n"
+	"devices listed in this file model transfer time; transfers to other\n"
+	"devices complete instantly.\n"
+	"\n"
+	"Section '[ CopyEngine <device> ]' configures the copy engine of a\n"
+	"device, where <device> is 'SouthernIslands' or 'Kepler'.\n"
+	"\n"
+	"  Frequency = <value> (Default = 1000)\n"
+	"      Frequency of the host-device link in MHz.\n"
+	"  Bandwidth = <bytes> (Default = 16)\n"
+	"      Bandwidth of the link in bytes per cycle.\n"
+	"  Latency = <cycles> (Default = 1000)\n"
+	"      Fixed latency of every transfer in number of cycles, added to\n"
+	"      the time it takes to move the data over the link.\n"
+	"  Overlap = {t|f} (Default = True)\n"
+	"      If false, transfers do not start while a kernel is running on\n"
+	"      the device. This only applies to Southern Islands. Kepler kernels\n"
+	"      are emulated in zero simulated time, so transfers always overlap\n"
+	"      with them.\n"
+	"\n";
+
+
+//
+// Static variables
+//
+
+const misc::StringMap CopyEngine::DirectionMap =
+{
+	{ "HostToDevice", DirectionHostToDevice },
+	{ "DeviceToHost", DirectionDeviceToHost }
+};
+
+std::map<std::string, std::unique_ptr<CopyEngine>> CopyEngine::copy_engines;
+
+int CopyEngine::num_pending_transfers = 0;
+
+misc::Debug CopyEngine::debug;
+
+
+void CopyEngine::RegisterOptions()
+{
+	// Get command line object
+	misc::CommandLine *command_line = misc::CommandLine::getInstance();
+
+	// Category
+	command_line->setCategory("Copy Engine");
+
+	// Option '--copy-engine-config <file>'
+	command_line->RegisterString("--copy-engine-config <file>", config_file,
+			"Configuration file for the copy engines moving data "
+			"between host and device memory. Without this option, "
+			"host-device transfers take no simulated time. Type "
+			"'m2s --copy-engine-help' for details on the file "
+			"format.");
+
+	// Option '--copy-engine-report <file>'
+	command_line->RegisterString("--copy-engine-report <file>", report_file,
+			"File to dump a report of the copy engines, including "
+			"the number of transfers, bytes moved, and link "
+			"utilization.");
+
+	// Option '--copy-engine-debug <file>'
+	command_line->RegisterString("--copy-engine-debug <file>", debug_file,
+			"Dump debug information about every transfer processed "
+			"by the copy engines.");
+
+	// Option '--copy-engine-help'
+	command_line->RegisterBool("--copy-engine-help", help,
+			"Display a help message describing the format of the "
+			"copy engine configuration file.");
+}
+
+
+void CopyEngine::ProcessOptions()
+{
+	// Help message
+	if (help)
+	{
+		std::cerr << help_message;
+		exit(0);
+	}
+
+	// Debugger
+	debug.setPath(debug_file);
+	debug.setPrefix("[copy-engine]");
+
+	// Nothing else to do without a configuration file
+	if (config_file.empty())
+		return;
+
+	// Create one copy engine per section
+	misc::IniFile ini_file(config_file);
+	for (int i = 0; i < ini_file.getNumSections(); i++)
+	{
+		// Check section name
+		std::string section = ini_file.getSection(i);
+		std::vector<std::string> tokens;
+		misc::StringTokenize(section, tokens);
+		if (tokens.size() != 2 || misc::StringCaseCompare(tokens[0],
+				"CopyEngine"))
+			throw Error(misc::fmt("%s: invalid section '%s'",
+					config_file.c_str(),
+					section.c_str()));
+
+		// Check device name
+		const std::string &name = tokens[1];
+		if (name != "SouthernIslands" && name != "Kepler")
+			throw Error(misc::fmt("%s: section '%s': invalid "
+					"device '%s'",
+					config_file.c_str(),
+					section.c_str(),
+					name.c_str()));
+		if (copy_engines.count(name))
+			throw Error(misc::fmt("%s: duplicate copy engine for "
+					"device '%s'",
+					config_file.c_str(),
+					name.c_str()));
+
+		// Create copy engine
+		copy_engines[name] = misc::new_unique<CopyEngine>(name,
+				&ini_file);
+	}
+
+	// Enforce only the allowed variables
+	ini_file.Check();
+}
+
+
+CopyEngine *CopyEngine::getInstance(const std::string &name)
+{
+	auto it = copy_engines.find(name);
+	return it == copy_engines.end() ? nullptr : it->second.get();
+}
+
+
+CopyEngine::CopyEngine(const std::string &name, misc::IniFile *ini_file) :
+		name(name)
+{
+	// Read configuration
+	std::string section = "CopyEngine " + name;
+	frequency = ini_file->ReadInt(section, "Frequency", frequency);
+	bandwidth = ini_file->ReadInt(section, "Bandwidth", bandwidth);
+	latency = ini_file->ReadInt(section, "Latency", latency);
+	overlap = ini_file->ReadBool(section, "Overlap", overlap);
+
+	// Check values
+	if (!esim::Engine::isValidFrequency(frequency))
+		throw Error(misc::fmt("%s: section '%s': the value for "
+				"'Frequency' must be between 1MHz and "
+				"1000GHz", ini_file->getPath().c_str(),
+				section.c_str()));
+	if (bandwidth < 1)
+		throw Error(misc::fmt("%s: section '%s': invalid value for "
+				"'Bandwidth'", ini_file->getPath().c_str(),
+				section.c_str()));
+	if (latency < 0)
+		throw Error(misc::fmt("%s: section '%s': invalid value for "
+				"'Latency'", ini_file->getPath().c_str(),
+				section.c_str()));
+
+	// Kepler kernels take no simulated time, so there is nothing to hold
+	// transfers back for.
+	if (!overlap && name == "Kepler")
+		misc::Warning("%s: section '%s': 'Overlap = False' has no "
+				"effect, since Kepler kernels are emulated in zero "
+				"simulated time", ini_file->getPath().c_str(),
+				section.c_str());
+
+	// Frequency domain and events
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	frequency_domain = esim_engine->RegisterFrequencyDomain(
+			"CopyEngine " + name, frequency);
+	event_start = esim_engine->RegisterEvent("copy_engine_start",
+			StartHandler, frequency_domain);
+	event_end = esim_engine->RegisterEvent("copy_engine_end",
+			EndHandler, frequency_domain);
+}
+
+
+void CopyEngine::Transfer(Context *context, Direction direction,
+		unsigned size)
+{
+	// Create transfer
+	auto frame = std::make_shared<Frame>(this, context, direction, size);
+	frame->request_cycle = frequency_domain->getCycle();
+	transfers.push_back(frame);
+	num_pending_transfers++;
+
+	// Debug
+	debug << misc::fmt("[%s] [cycle %lld] %s transfer of %u bytes "
+			"queued by %s\n",
+			name.c_str(),
+			frame->request_cycle,
+			DirectionMap[direction],
+			size,
+			context->getName().c_str());
+
+	// The host context waits for the transfer to complete
+	context->Suspend();
+
+	// Start it right away if the link is free
+	StartNext();
+}
+
+
+void CopyEngine::StartNext()
+{
+	// Link occupied or nothing to do
+	if (busy || transfers.empty())
+		return;
+
+	// Hand the transfer at the head of the queue to the event engine. The
+	// frame is scheduled without a parent, since this function may run
+	// within the end event of the previous transfer, and chaining frames
+	// would keep every past transfer alive.
+	busy = true;
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	esim_engine->Schedule(event_start, transfers.front());
+	transfers.pop_front();
+}
+
+
+void CopyEngine::KernelFinished()
+{
+	assert(num_running_kernels > 0);
+	num_running_kernels--;
+}
+
+
+void CopyEngine::StartHandler(esim::Event *event, esim::Frame *esim_frame)
+{
+	// Get frame
+	Frame *frame = misc::cast<Frame *>(esim_frame);
+	CopyEngine *copy_engine = frame->copy_engine;
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+
+	// Without overlap, wait for the device to finish running kernels
+	if (!copy_engine->overlap && copy_engine->num_running_kernels)
+	{
+		copy_engine->overlap_stall_cycles++;
+		esim_engine->Next(copy_engine->event_start, 1);
+		return;
+	}
+
+	// Occupy the link
+	long long cycles = copy_engine->getTransferCycles(frame->size);
+	frame->start_cycle = copy_engine->frequency_domain->getCycle();
+	copy_engine->busy_cycles += cycles;
+	esim_engine->Next(copy_engine->event_end, cycles);
+
+	// Debug
+	debug << misc::fmt("[%s] [cycle %lld] %s transfer of %u bytes "
+			"started, %lld cycles\n",
+			copy_engine->name.c_str(),
+			frame->start_cycle,
+			DirectionMap[frame->direction],
+			frame->size,
+			cycles);
+}
+
+
+void CopyEngine::EndHandler(esim::Event *event, esim::Frame *esim_frame)
+{
+	// Get frame
+	Frame *frame = misc::cast<Frame *>(esim_frame);
+	CopyEngine *copy_engine = frame->copy_engine;
+	long long cycle = copy_engine->frequency_domain->getCycle();
+
+	// Statistics
+	if (frame->direction == DirectionHostToDevice)
+	{
+		copy_engine->num_host_to_device++;
+		copy_engine->bytes_host_to_device += frame->size;
+	}
+	else
+	{
+		copy_engine->num_device_to_host++;
+		copy_engine->bytes_device_to_host += frame->size;
+	}
+	copy_engine->total_latency += cycle - frame->request_cycle;
+
+	// Debug
+	debug << misc::fmt("[%s] [cycle %lld] %s transfer of %u bytes "
+			"finished, waking up %s\n",
+			copy_engine->name.c_str(),
+			cycle,
+			DirectionMap[frame->direction],
+			frame->size,
+			frame->context->getName().c_str());
+
+	// Resume host context
+	frame->context->Wakeup();
+
+	// Release the link and start the next transfer
+	assert(num_pending_transfers > 0);
+	num_pending_transfers--;
+	copy_engine->busy = false;
+	copy_engine->StartNext();
+}
+
+
+void CopyEngine::DumpReport(std::ostream &os) const
+{
+	// Configuration
+	os << misc::fmt("[ CopyEngine %s ]\n", name.c_str());
+	os << misc::fmt("Frequency = %d\n", frequency);
+	os << misc::fmt("Bandwidth = %d\n", bandwidth);
+	os << misc::fmt("Latency = %d\n", latency);
+	os << misc::fmt("Overlap = %s\n", overlap ? "True" : "False");
+	os << '\n';
+
+	// Transfers
+	long long num_transfers = num_host_to_device + num_device_to_host;
+	os << misc::fmt("Transfers = %lld\n", num_transfers);
+	os << misc::fmt("HostToDevice.Transfers = %lld\n", num_host_to_device);
+	os << misc::fmt("HostToDevice.Bytes = %lld\n", bytes_host_to_device);
+	os << misc::fmt("DeviceToHost.Transfers = %lld\n", num_device_to_host);
+	os << misc::fmt("DeviceToHost.Bytes = %lld\n", bytes_device_to_host);
+	os << '\n';
+
+	// Timing
+	long long cycles = frequency_domain->getCycle();
+	os << misc::fmt("Cycles = %lld\n", cycles);
+	os << misc::fmt("BusyCycles = %lld\n", busy_cycles);
+	os << misc::fmt("Utilization = %.4f\n", cycles ?
+			(double) busy_cycles / cycles : 0.0);
+	os << misc::fmt("OverlapStallCycles = %lld\n", overlap_stall_cycles);
+	os << misc::fmt("AverageLatency = %.2f\n", num_transfers ?
+			(double) total_latency / num_transfers : 0.0);
+	os << misc::fmt("\n\n");
+}
+
+
+void CopyEngine::DumpReports()
+{
+	// No report requested
+	if (report_file.empty())
+		return;
+
+	// Open file
+	std::ofstream report(report_file);
+	if (!report)
+		throw Error(misc::fmt("%s: cannot open report file",
+				report_file.c_str()));
+
+	// Dump all copy engines
+	for (auto &it : copy_engines)
+		it.second->DumpReport(report);
+}
+
+
+}  // namespace comm
+
@@ -0,0 +1,280 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_COMMON_COPY_ENGINE_H
+#define ARCH_COMMON_COPY_ENGINE_H
+
+#include <deque>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+
+#include <lib/cpp/Debug.h>
+#include <lib/cpp/Error.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/esim/Event.h>
+#include <lib/esim/Frame.h>
+#include <lib/esim/FrequencyDomain.h>
+
+
+namespace comm
+{
+
+// Forward declarations
+class Context;
+
+
+/// Timing model of the DMA engine that moves data between host memory and
+/// the memory of a GPU device over a PCIe-like link. Device drivers perform
+/// the functional copy immediately, and then hand the transfer to the copy
+/// engine, which suspends the host context until the transfer has completed
+/// in simulated time. Copy engines are only instantiated when a
+/// configuration file is passed with option '--copy-engine-config'.
+class CopyEngine
+{
+public:
+
+	/// Direction of a transfer
+	enum Direction
+	{
+		DirectionInvalid = 0,
+		DirectionHostToDevice,
+		DirectionDeviceToHost
+	};
+
+	/// String map for Direction
+	static const misc::StringMap DirectionMap;
+
+	/// Error related with the copy engine
+	class Error : public misc::Error
+	{
+	public:
+
+		/// Constructor
+		Error(const std::string &message) : misc::Error(message)
+		{
+			AppendPrefix("Copy engine");
+		}
+	};
+
+	/// Event frame for a transfer in flight
+	class Frame : public esim::Frame
+	{
+	public:
+
+		/// Copy engine processing the transfer
+		CopyEngine *copy_engine = nullptr;
+
+		/// Host context suspended until the transfer completes
+		Context *context = nullptr;
+
+		/// Transfer direction
+		Direction direction = DirectionInvalid;
+
+		/// Number of bytes transferred
+		unsigned size = 0;
+
+		/// Cycle in the copy engine frequency domain when the transfer
+		/// was requested by the driver
+		long long request_cycle = 0;
+
+		/// Cycle when the transfer started using the link
+		long long start_cycle = 0;
+
+		/// Constructor
+		Frame(CopyEngine *copy_engine,
+				Context *context,
+				Direction direction,
+				unsigned size) :
+				copy_engine(copy_engine),
+				context(context),
+				direction(direction),
+				size(size)
+		{
+		}
+	};
+
+private:
+
+	//
+	// Static fields
+	//
+
+	// Configuration file passed with '--copy-engine-config'
+	static std::string config_file;
+
+	// Report file passed with '--copy-engine-report'
+	static std::string report_file;
+
+	// Debug file passed with '--copy-engine-debug'
+	static std::string debug_file;
+
+	// Show help message with '--copy-engine-help'
+	static bool help;
+
+	// Message to display with '--copy-engine-help'
+	static const std::string help_message;
+
+	// Copy engines indexed by device name
+	static std::map<std::string, std::unique_ptr<CopyEngine>> copy_engines;
+
+	// Number of transfers queued or in flight in all copy engines
+	static int num_pending_transfers;
+
+	// Event handlers
+	static void StartHandler(esim::Event *event, esim::Frame *frame);
+	static void EndHandler(esim::Event *event, esim::Frame *frame);
+
+
+
+
+	//
+	// Configuration
+	//
+
+	// Device name
+	std::string name;
+
+	// Frequency of the link in MHz
+	int frequency = 1000;
+
+	// Link bandwidth in bytes per cycle
+	int bandwidth = 16;
+
+	// Fixed latency for each transfer in cycles
+	int latency = 1000;
+
+	// Whether transfers can overlap with kernel execution
+	bool overlap = true;
+
+
+
+
+	//
+	// State
+	//
+
+	// Frequency domain of the link
+	esim::FrequencyDomain *frequency_domain = nullptr;
+
+	// Events
+	esim::Event *event_start = nullptr;
+	esim::Event *event_end = nullptr;
+
+	// Transfers waiting for the link, in arrival order
+	std::deque<std::shared_ptr<Frame>> transfers;
+
+	// True while a transfer is occupying the link, or waiting for the
+	// device to become idle when overlap is disabled
+	bool busy = false;
+
+	// Number of kernels currently running on the device, as reported by
+	// the driver
+	int num_running_kernels = 0;
+
+	// Start the transfer at the head of the queue if the link is free
+	void StartNext();
+
+
+
+
+	//
+	// Statistics
+	//
+
+	// Number of transfers and bytes in each direction
+	long long num_host_to_device = 0;
+	long long num_device_to_host = 0;
+	long long bytes_host_to_device = 0;
+	long long bytes_device_to_host = 0;
+
+	// Cycles during which the link was transferring data
+	long long busy_cycles = 0;
+
+	// Accumulated cycles between the driver request and the completion of
+	// each transfer, including queuing and overlap stalls
+	long long total_latency = 0;
+
+	// Cycles transfers were held back by a running kernel
+	long long overlap_stall_cycles = 0;
+
+public:
+
+	/// Debugger
+	static misc::Debug debug;
+
+	/// Register command-line options
+	static void RegisterOptions();
+
+	/// Process command-line options
+	static void ProcessOptions();
+
+	/// Return the copy engine associated with a device name (e.g.,
+	/// `SouthernIslands`), or `nullptr` if no copy engine was configured
+	/// for it.
+	static CopyEngine *getInstance(const std::string &name);
+
+	/// Return whether any copy engine has transfers queued or in flight.
+	/// The main simulation loop keeps advancing simulated time while this
+	/// is the case, even if no timing simulator is active.
+	static bool hasPendingTransfers() { return num_pending_transfers > 0; }
+
+	/// Dump the report of all copy engines into the file given in option
+	/// '--copy-engine-report'.
+	static void DumpReports();
+
+	/// Constructor
+	CopyEngine(const std::string &name, misc::IniFile *ini_file);
+
+	/// Return the device name
+	const std::string &getName() const { return name; }
+
+	/// Return the frequency domain of the link
+	esim::FrequencyDomain *getFrequencyDomain() const
+	{
+		return frequency_domain;
+	}
+
+	/// Return the number of cycles the link is occupied by a transfer of
+	/// \a size bytes, including its fixed latency.
+	long long getTransferCycles(unsigned size) const
+	{
+		return latency + (size + bandwidth - 1) / bandwidth;
+	}
+
+	/// Enqueue a transfer and suspend \a context until it completes. The
+	/// data must have already been copied functionally by the caller.
+	void Transfer(Context *context, Direction direction, unsigned size);
+
+	/// Notify the copy engine that a kernel started running on the device.
+	/// With overlap disabled, transfers are held back while kernels run.
+	void KernelStarted() { num_running_kernels++; }
+
+	/// Notify the copy engine that a kernel finished running
+	void KernelFinished();
+
+	/// Dump the copy engine statistics
+	void DumpReport(std::ostream &os = std::cout) const;
+};
+
+
+}  // namespace comm
+
+#endif
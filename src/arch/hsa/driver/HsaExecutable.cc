@@ -202,6 +202,9 @@ void HsaExecutable::parseFunction(BrigFile *file,
 	function->setFirstEntry(std::move(first_entry));
 	function->setFunctionDirective(std::move(entry));
 
+	// Decode the code of the function once for all work items
+	function->DecodeInstructions();
+
 	if (Emulator::loader_debug)
 		function->Dump(Emulator::loader_debug);
 
@@ -41,13 +41,12 @@ BrInstructionWorker::~BrInstructionWorker()
 void BrInstructionWorker::Execute(BrigCodeEntry *instruction)
 {
 	// Retrieve 1st operand
-	auto operand0 = instruction->getOperand(0);
-	if (operand0->getKind() == BRIG_KIND_OPERAND_CODE_REF)
+	DecodedOperand *operand0 = stack_frame->getDecodedPc()->getOperand(0);
+	if (operand0->kind == BRIG_KIND_OPERAND_CODE_REF &&
+			operand0->target >= 0)
 	{
-		auto label = operand0->getRef();
-
 		// Redirect pc to a certain label
-		stack_frame->setPc(std::move(label));
+		stack_frame->setPc(operand0->target);
 		return;
 	}else{
 		throw misc::Panic("Unsupported operand type for CBR.");
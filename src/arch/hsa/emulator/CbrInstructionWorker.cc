@@ -53,13 +53,13 @@ void CbrInstructionWorker::Execute(BrigCodeEntry *instruction)
 	// Jump if condition is true
 	if (condition){
 		// Retrieve 1st operand
-		auto operand1 = instruction->getOperand(1);
-		if (operand1->getKind() == BRIG_KIND_OPERAND_CODE_REF)
+		DecodedOperand *operand1 = stack_frame->getDecodedPc()->
+				getOperand(1);
+		if (operand1->kind == BRIG_KIND_OPERAND_CODE_REF &&
+				operand1->target >= 0)
 		{
-			auto label = operand1->getRef();
-
 			// Redirect pc to a certain label
-			stack_frame->setPc(std::move(label));
+			stack_frame->setPc(operand1->target);
 			return;
 		}else{
 			throw misc::Panic("Unsupported operand type for CBR.");
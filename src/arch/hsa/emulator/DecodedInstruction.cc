@@ -0,0 +1,149 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2014  Yifan Sun (yifansun@coe.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <arch/hsa/disassembler/AsmService.h>
+#include <arch/hsa/disassembler/BrigImmed.h>
+#include <arch/hsa/disassembler/BrigOperandEntry.h>
+
+#include "DecodedInstruction.h"
+#include "Function.h"
+
+
+namespace HSA
+{
+
+// Resolve a register operand into its location in the register storage
+static DecodedRegister DecodeRegister(Function *function,
+		BrigOperandEntry *operand)
+{
+	DecodedRegister reg;
+	BrigRegisterKind kind = operand->getRegKind();
+	unsigned short number = operand->getRegNumber();
+	switch (kind)
+	{
+	case BRIG_REGISTER_KIND_CONTROL:
+
+		reg.control = true;
+		reg.offset = number;
+		reg.size = 1;
+		return reg;
+
+	case BRIG_REGISTER_KIND_SINGLE:
+
+		reg.size = 4;
+		break;
+
+	case BRIG_REGISTER_KIND_DOUBLE:
+
+		reg.size = 8;
+		break;
+
+	case BRIG_REGISTER_KIND_QUAD:
+
+		reg.size = 16;
+		break;
+	}
+	reg.offset = function->getRegisterOffset(
+			AsmService::RegisterToString(kind, number));
+	return reg;
+}
+
+
+DecodedInstruction::DecodedInstruction(Function *function,
+		std::unique_ptr<BrigCodeEntry> entry) :
+		entry(std::move(entry))
+{
+	// Directives have no operands to decode
+	BrigCodeEntry *inst = this->entry.get();
+	if (!inst->isInstruction())
+		return;
+
+	// Decode operands
+	for (unsigned i = 0; i < inst->getOperandCount(); i++)
+	{
+		auto operand = inst->getOperand(i);
+		if (!operand.get())
+			break;
+		operands.emplace_back();
+		DecodedOperand &decoded = operands.back();
+		decoded.kind = operand->getKind();
+		switch (decoded.kind)
+		{
+		case BRIG_KIND_OPERAND_CONSTANT_BYTES:
+
+		{
+			decoded.bytes = operand->getBytes();
+			BrigImmed immed(decoded.bytes,
+					inst->getOperandType(i));
+			decoded.size = immed.getSize();
+			break;
+		}
+
+		case BRIG_KIND_OPERAND_REGISTER:
+
+			decoded.reg = DecodeRegister(function, operand.get());
+			break;
+
+		case BRIG_KIND_OPERAND_ADDRESS:
+
+		{
+			auto symbol = operand->getSymbol();
+			if (symbol.get())
+				decoded.symbol_name = symbol->getName();
+			auto reg = operand->getReg();
+			if (reg.get())
+			{
+				decoded.has_register = true;
+				decoded.reg = DecodeRegister(function,
+						reg.get());
+			}
+			decoded.offset = operand->getOffset();
+			break;
+		}
+
+		case BRIG_KIND_OPERAND_OPERAND_LIST:
+
+			// Only register elements are supported. Other elements
+			// are detected when the operand is accessed.
+			for (unsigned j = 0; j < operand->getElementCount(); j++)
+			{
+				auto element = operand->getOperandElement(j);
+				if (element->getKind() !=
+						BRIG_KIND_OPERAND_REGISTER)
+					break;
+				decoded.registers.push_back(DecodeRegister(
+						function, element.get()));
+			}
+			break;
+
+		case BRIG_KIND_OPERAND_CODE_REF:
+
+			// Resolved by the function into an instruction index
+			decoded.target_offset = operand->getRef()->getOffset();
+			break;
+
+		default:
+
+			break;
+		}
+	}
+}
+
+
+}  // namespace HSA
@@ -0,0 +1,129 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2014  Yifan Sun (yifansun@coe.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ARCH_HSA_EMULATOR_DECODEDINSTRUCTION_H
+#define ARCH_HSA_EMULATOR_DECODEDINSTRUCTION_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <arch/hsa/disassembler/Brig.h>
+#include <arch/hsa/disassembler/BrigCodeEntry.h>
+
+namespace HSA
+{
+
+class Function;
+
+/// A register resolved to its location in the register storage of a stack
+/// frame
+struct DecodedRegister
+{
+	/// True for control registers ($c), which are stored separately from
+	/// the rest of registers
+	bool control = false;
+
+	/// Index of a control register, or offset of any other register in
+	/// the register storage of the stack frame
+	unsigned offset = 0;
+
+	/// Size of the register in bytes
+	unsigned size = 0;
+};
+
+
+/// An operand of an instruction, with all the information needed to
+/// read or write its value resolved when the function is loaded
+struct DecodedOperand
+{
+	/// Kind of the operand
+	BrigKind kind = BRIG_KIND_NONE;
+
+	/// Register, for register operands, and for the base register of
+	/// address operands if \a has_register is set
+	DecodedRegister reg;
+
+	/// Whether an address operand has a base register
+	bool has_register = false;
+
+	/// Registers of an operand list
+	std::vector<DecodedRegister> registers;
+
+	/// Pointer to the bytes of a constant operand in the BRIG file
+	const unsigned char *bytes = nullptr;
+
+	/// Size in bytes of a constant operand, given by the operand type
+	/// of the instruction
+	unsigned size = 0;
+
+	/// Name of the symbol of an address operand, or empty if the operand
+	/// has no symbol
+	std::string symbol_name;
+
+	/// Offset of an address operand
+	unsigned long long offset = 0;
+
+	/// Offset in the code section of the target of a code reference
+	/// operand
+	unsigned target_offset = 0;
+
+	/// Index of the target of a code reference operand in the decoded
+	/// instructions of the function
+	int target = -1;
+};
+
+
+/// An entry of the code section of a function (instruction or directive)
+/// decoded once when the function is loaded. Executing from the decoded
+/// entries avoids building new entry and operand wrappers around the BRIG
+/// bytes on every instruction of every work item.
+class DecodedInstruction
+{
+	// Code entry in the BRIG file
+	std::unique_ptr<BrigCodeEntry> entry;
+
+	// Decoded operands, only for instructions
+	std::vector<DecodedOperand> operands;
+
+public:
+
+	/// Decode a code entry of a function. Code reference operands are
+	/// left unresolved, since their target index is only known once the
+	/// whole function is decoded.
+	DecodedInstruction(Function *function,
+			std::unique_ptr<BrigCodeEntry> entry);
+
+	/// Return the code entry
+	BrigCodeEntry *getEntry() const { return entry.get(); }
+
+	/// Return the number of decoded operands
+	unsigned getNumOperands() const { return operands.size(); }
+
+	/// Return a decoded operand
+	DecodedOperand *getOperand(unsigned index)
+	{
+		return &operands.at(index);
+	}
+};
+
+
+}  // namespace HSA
+
+#endif
@@ -60,6 +60,42 @@ std::unique_ptr<BrigCodeEntry> Function::getLastEntry() const
 }
 
 
+void Function::DecodeInstructions()
+{
+	// Function without code
+	instructions.clear();
+	if (!first_entry.get() || !last_entry.get())
+		return;
+
+	// Decode all entries, recording the index of each entry offset
+	std::map<unsigned, int> indexes;
+	unsigned last_offset = last_entry->getOffset();
+	auto entry = binary->getCodeEntryByOffset(first_entry->getOffset());
+	while (entry.get() && entry->getOffset() <= last_offset)
+	{
+		auto next_entry = entry->Next();
+		indexes[entry->getOffset()] = instructions.size();
+		instructions.emplace_back(misc::new_unique<DecodedInstruction>(
+				this, std::move(entry)));
+		entry = std::move(next_entry);
+	}
+
+	// Resolve branch targets
+	for (auto &instruction : instructions)
+	{
+		for (unsigned i = 0; i < instruction->getNumOperands(); i++)
+		{
+			DecodedOperand *operand = instruction->getOperand(i);
+			if (operand->kind != BRIG_KIND_OPERAND_CODE_REF)
+				continue;
+			auto it = indexes.find(operand->target_offset);
+			if (it != indexes.end())
+				operand->target = it->second;
+		}
+	}
+}
+
+
 void Function::addArgument(std::unique_ptr<Variable> argument)
 {
 
@@ -23,9 +23,11 @@
 #include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include <arch/hsa/disassembler/BrigCodeEntry.h>
 
+#include "DecodedInstruction.h"
 #include "Variable.h"
 
 
@@ -57,6 +59,10 @@ class Function
 	// The directive where the function is declared
 	std::unique_ptr<BrigCodeEntry> function_directive;
 
+	// Code entries of the function between the first and the last entry,
+	// decoded once when the function is loaded
+	std::vector<std::unique_ptr<DecodedInstruction>> instructions;
+
 	/// Dump argument related information
 	void DumpArgumentInfo(std::ostream &os) const;
 
@@ -123,6 +129,24 @@ public:
 	/// Return pointer to the last entry
 	std::unique_ptr<BrigCodeEntry> getLastEntry() const;
 
+	/// Decode all code entries between the first and the last entry of
+	/// the function, and resolve branch targets into instruction indexes.
+	/// This function must be called after the first and last entries are
+	/// set and registers are allocated.
+	void DecodeInstructions();
+
+	/// Return the number of decoded instructions and directives
+	unsigned getNumInstructions() const { return instructions.size(); }
+
+	/// Return a decoded instruction or directive by its index, or
+	/// \c nullptr if the index is past the end of the function
+	DecodedInstruction *getInstruction(unsigned index) const
+	{
+		if (index >= instructions.size())
+			return nullptr;
+		return instructions[index].get();
+	}
+
 	/// Set the directive
 	void setFunctionDirective(std::unique_ptr<BrigCodeEntry> directive)
 	{
@@ -45,12 +45,12 @@ template<typename T>
 void LdaInstructionWorker::Inst_LDA_Aux(BrigCodeEntry *instruction)
 {
 	// Retrieve operand
-	auto address_operand = instruction->getOperand(1);
-	auto symbol = address_operand->getSymbol();
-	std::string name = symbol->getName();
+	DecodedOperand *address_operand = stack_frame->getDecodedPc()->
+			getOperand(1);
+	const std::string &name = address_operand->symbol_name;
 
 	// Get offset
-	uint64_t offset = address_operand->getOffset();
+	uint64_t offset = address_operand->offset;
 
 	// Declare addres
 	unsigned address;
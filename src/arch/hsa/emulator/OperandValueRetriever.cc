@@ -17,9 +17,10 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <cassert>
+#include <cstring>
+
 #include <arch/hsa/disassembler/BrigCodeEntry.h>
-#include <arch/hsa/disassembler/BrigOperandEntry.h>
-#include <arch/hsa/disassembler/BrigImmed.h>
 
 #include "OperandValueRetriever.h"
 #include "StackFrame.h"
@@ -45,20 +46,19 @@ OperandValueRetriever::~OperandValueRetriever()
 void OperandValueRetriever::Retrieve(BrigCodeEntry *instruction,
 		unsigned int index, void *buffer)
 {
-	// Get the operand entry
-	auto operand = instruction->getOperand(index);
+	// Get the operand decoded when the function was loaded. The
+	// instruction is always the one pointed to by the program counter.
+	DecodedInstruction *decoded = stack_frame->getDecodedPc();
+	assert(decoded && decoded->getEntry() == instruction);
+	DecodedOperand *operand = decoded->getOperand(index);
 
 	// Do corresponding action according to the type of operand
-	switch (operand->getKind())
+	switch (operand->kind)
 	{
 	case BRIG_KIND_OPERAND_CONSTANT_BYTES:
 
-	{
-		BrigImmed immed(operand->getBytes(),
-				instruction->getOperandType(index));
-		immed.getImmedValue(buffer);
+		memcpy(buffer, operand->bytes, operand->size);
 		return;
-	}
 
 	case BRIG_KIND_OPERAND_WAVESIZE:
 
@@ -67,21 +67,16 @@ void OperandValueRetriever::Retrieve(BrigCodeEntry *instruction,
 
 	case BRIG_KIND_OPERAND_REGISTER:
 
-	{
-		std::string register_name = operand->getRegisterName();
-		stack_frame->getRegisterValue(register_name, buffer);
+		stack_frame->getRegisterValue(operand->reg, buffer);
 		return;
-	}
 
 	case BRIG_KIND_OPERAND_ADDRESS:
 
 	{
 		unsigned long long address = 0;
-		unsigned long long offset = operand->getOffset();
-		if (operand->getSymbol().get())
+		if (!operand->symbol_name.empty())
 		{
-			auto symbol = operand->getSymbol();
-			std::string name = symbol->getName();
+			const std::string &name = operand->symbol_name;
 
 			// Get the variable
 			Variable *variable =
@@ -103,16 +98,14 @@ void OperandValueRetriever::Retrieve(BrigCodeEntry *instruction,
 
 			address += variable->getAddress();
 		}
-		if(operand->getReg().get())
+		if (operand->has_register)
 		{
-			std::string register_name = operand->getReg()
-						->getRegisterName();
 			unsigned long long reg_address = 0;
-			stack_frame->getRegisterValue(register_name,
+			stack_frame->getRegisterValue(operand->reg,
 					&reg_address);
 			address += reg_address;
 		}
-		address += offset;
+		address += operand->offset;
 		*(uint32_t *)buffer = address;
 		return;
 	}
@@ -122,32 +115,17 @@ void OperandValueRetriever::Retrieve(BrigCodeEntry *instruction,
 	{
 		// Get the vector modifier
 		unsigned vector_size = instruction->getVectorModifier();
+		if (vector_size > operand->registers.size())
+			throw misc::Panic(misc::fmt(
+					"Unsupported operand "
+					"type in operand list")
+					);
+		unsigned char *ptr = (unsigned char *)buffer;
 		for (unsigned int i = 0; i < vector_size; i++)
 		{
-			auto op_item = operand->getOperandElement(i);
-			switch (op_item->getKind())
-			{
-			case BRIG_KIND_OPERAND_REGISTER:
-
-			{
-				std::string register_name =
-						op_item->
-						getRegisterName();
-				unsigned size = AsmService::getSizeInByteByRegisterName(
-								register_name);
-				stack_frame->getRegisterValue
-						(register_name,
-						(unsigned char *)buffer
-						+ i * size);
-				break;
-			}
-
-			default:
-				throw misc::Panic(misc::fmt(
-						"Unsupported operand "
-						"type in operand list")
-						);
-			}
+			const DecodedRegister &reg = operand->registers[i];
+			stack_frame->getRegisterValue(reg, ptr);
+			ptr += reg.size;
 		}
 		break;
 	}
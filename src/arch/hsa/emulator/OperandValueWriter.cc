@@ -17,8 +17,9 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <cassert>
+
 #include <arch/hsa/disassembler/BrigCodeEntry.h>
-#include <arch/hsa/disassembler/BrigOperandEntry.h>
 
 #include "OperandValueWriter.h"
 #include "StackFrame.h"
@@ -41,50 +42,36 @@ OperandValueWriter::~OperandValueWriter()
 void OperandValueWriter::Write(BrigCodeEntry *instruction,
 		unsigned int index, void *buffer)
 {
-	// Get the operand entry
-	auto operand = instruction->getOperand(index);
+	// Get the operand decoded when the function was loaded. The
+	// instruction is always the one pointed to by the program counter.
+	DecodedInstruction *decoded = stack_frame->getDecodedPc();
+	assert(decoded && decoded->getEntry() == instruction);
+	DecodedOperand *operand = decoded->getOperand(index);
 
 	// Do corresponding action according to the type of operand
-	switch (operand->getKind())
+	switch (operand->kind)
 	{
 	case BRIG_KIND_OPERAND_REGISTER:
 
-	{
-		std::string register_name = operand->getRegisterName();
-		stack_frame->setRegisterValue(register_name, buffer);
+		stack_frame->setRegisterValue(operand->reg, buffer);
 		break;
-	}
 
 	case BRIG_KIND_OPERAND_OPERAND_LIST:
 
 	{
 		// Get the vector modifier
 		unsigned vector_size = instruction->getVectorModifier();
+		if (vector_size > operand->registers.size())
+			throw misc::Panic(misc::fmt(
+					"Unsupported operand "
+					"type in operand list")
+					);
+		unsigned char *ptr = (unsigned char *)buffer;
 		for (unsigned int i = 0; i < vector_size; i++)
 		{
-			auto op_item = operand->getOperandElement(i);
-			switch (op_item->getKind())
-			{
-			case BRIG_KIND_OPERAND_REGISTER:
-
-			{
-				std::string register_name =
-						op_item->
-						getRegisterName();
-				unsigned size = AsmService::getSizeInByteByRegisterName(
-						register_name);
-				stack_frame->setRegisterValue
-						(register_name,
-						 (unsigned char *)buffer + i * size);
-				break;
-			}
-
-			default:
-				throw misc::Panic(misc::fmt(
-						"Unsupported operand "
-						"type in operand list")
-						);
-			}
+			const DecodedRegister &reg = operand->registers[i];
+			stack_frame->setRegisterValue(reg, ptr);
+			ptr += reg.size;
 		}
 		break;
 	}
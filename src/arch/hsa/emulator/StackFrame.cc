@@ -35,9 +35,9 @@ StackFrame::StackFrame(Function *function, WorkItem *work_item,
 	// Set work item
 	this->work_item = work_item;
 
-	// Set the program counter to be pointing to the first entry of the
-	// function
-	pc = function->getFirstEntry();
+	// The program counter points to the first entry of the function,
+	// which is the first decoded instruction
+	pc = 0;
 
 	// Allocate register space
 	register_storage = misc::new_unique_array<char>(
@@ -71,12 +71,6 @@ StackFrame::~StackFrame()
 }
 
 
-void StackFrame::setPc(std::unique_ptr<BrigCodeEntry> pc)
-{
-	this->pc = std::move(pc);
-}
-
-
 void StackFrame::StartArgumentScope(unsigned size)
 {
 	// Check if the previous argument scope has not been closed
@@ -105,10 +99,14 @@ void StackFrame::Dump(std::ostream &os = std::cout) const
 	os << misc::fmt("  Function: %s,\n", function->getName().c_str());
 
 	// Dump program counter and current instruction
-	os << misc::fmt("  Program counter (offset in code section): 0x%x, ",
-			pc->getOffset());
-	pc->Dump(os);
-	os << "\n";
+	BrigCodeEntry *entry = getPc();
+	if (entry)
+	{
+		os << misc::fmt("  Program counter (offset in code "
+				"section): 0x%x, ", entry->getOffset());
+		entry->Dump(os);
+		os << "\n";
+	}
 
 	// Dump Register status
 	os << "  ***** Registers *****\n";
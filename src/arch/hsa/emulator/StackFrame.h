@@ -40,8 +40,9 @@ class StackFrame
 	// The work item that this stack frame belongs to
 	WorkItem *work_item;
 
-	// Pointer to the instruction to be executed
-	std::unique_ptr<BrigCodeEntry> pc;
+	// Index of the instruction to be executed in the decoded instructions
+	// of the function
+	unsigned pc = 0;
 
 	// Function input and output arguments
 	std::map<std::string, std::unique_ptr<Variable>> function_arguments;
@@ -93,11 +94,29 @@ public:
 	/// Return the function
 	Function *getFunction() const { return function; }
 
-	/// Return the program counter
-	BrigCodeEntry *getPc() const { return pc.get(); }
+	/// Return the code entry pointed to by the program counter, or
+	/// \c nullptr if the program counter is past the end of the function
+	BrigCodeEntry *getPc() const
+	{
+		DecodedInstruction *instruction = function->getInstruction(pc);
+		return instruction ? instruction->getEntry() : nullptr;
+	}
+
+	/// Return the decoded instruction pointed to by the program counter,
+	/// or \c nullptr if the program counter is past the end of the
+	/// function
+	DecodedInstruction *getDecodedPc() const
+	{
+		return function->getInstruction(pc);
+	}
+
+	/// Return the program counter, as an index in the decoded
+	/// instructions of the function
+	unsigned getPcIndex() const { return pc; }
 
-	/// Set the program counter
-	void setPc(std::unique_ptr<BrigCodeEntry> pc);
+	/// Set the program counter to an index in the decoded instructions of
+	/// the function
+	void setPc(unsigned pc) { this->pc = pc; }
 
 	/// Dump stack frame information
 	void Dump(std::ostream &os) const;
@@ -161,6 +180,26 @@ public:
 		return;
 	}
 
+	/// Return the value of a register decoded in advance
+	void getRegisterValue(const DecodedRegister &reg, void *buffer) const
+	{
+		if (reg.control)
+			*(unsigned char *) buffer = c_registers[reg.offset];
+		else
+			memcpy(buffer, register_storage.get() + reg.offset,
+					reg.size);
+	}
+
+	/// Set the value of a register decoded in advance
+	void setRegisterValue(const DecodedRegister &reg, const void *value)
+	{
+		if (reg.control)
+			c_registers[reg.offset] = *(const unsigned char *) value;
+		else
+			memcpy(register_storage.get() + reg.offset, value,
+					reg.size);
+	}
+
 	/// Start an argument scope, when a '{' appears. Requires the size to
 	/// be allocated for the argument segment
 	void StartArgumentScope(unsigned size);
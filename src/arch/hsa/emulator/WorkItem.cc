@@ -114,20 +114,18 @@ bool WorkItem::MovePcForwardByOne()
 	StackFrame *stack_top = stack.back().get();
 
 	// Set the stackframe's pc to the next instuction
-	auto next_pc = stack_top->getPc()->Next();
+	unsigned next_pc = stack_top->getPcIndex() + 1;
 
 	// If next pc is beyond last inst, the last instruction of the function
 	// is executed. Return the function.
-	if (!next_pc ||
-		next_pc->getOffset() >
-		stack_top->getFunction()->getLastEntry()->getOffset())
+	if (next_pc >= stack_top->getFunction()->getNumInstructions())
 	{
 		ReturnFunction();
 		return false;
 	}
 
 	// Set program counter to next instruction
-	stack_top->setPc(std::move(next_pc));
+	stack_top->setPc(next_pc);
 
 	// Returns true to tell the caller that the function is not returned
 	return true;
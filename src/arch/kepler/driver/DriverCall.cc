@@ -20,6 +20,7 @@
 
 #include <memory>
 
+#include <arch/common/CopyEngine.h>
 #include <arch/kepler/disassembler/Disassembler.h>
 #include <arch/kepler/emulator/Emulator.h>
 #include <arch/kepler/emulator/Grid.h>
@@ -170,6 +171,12 @@ int Driver::CallMemRead(comm::Context *context,
 	global_mem->Read(device_ptr, size, buffer.get());
 	memory->Write(host_ptr, size, buffer.get());
 
+	// Suspend the host context for the duration of the transfer
+	comm::CopyEngine *copy_engine = comm::CopyEngine::getInstance("Kepler");
+	if (copy_engine)
+		copy_engine->Transfer(context,
+				comm::CopyEngine::DirectionDeviceToHost, size);
+
 	// Return
 	return 0;
 }
@@ -220,6 +227,12 @@ int Driver::CallMemWrite(comm::Context *context,
 	memory->Read(host_ptr, size, buffer.get());
 	global_mem->Write(device_ptr, size, buffer.get());
 
+	// Suspend the host context for the duration of the transfer
+	comm::CopyEngine *copy_engine = comm::CopyEngine::getInstance("Kepler");
+	if (copy_engine)
+		copy_engine->Transfer(context,
+				comm::CopyEngine::DirectionHostToDevice, size);
+
 	// Return
 	return 0;
 }
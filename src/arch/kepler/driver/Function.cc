@@ -71,5 +71,23 @@ Function::Function(int id, Module *module, const std::string &name) :
 		arguments.emplace_back(new Argument(argument_name));
 	}
 }
+
+
+void Function::DecodeInstructions()
+{
+	// Already decoded
+	if (!instructions.empty())
+		return;
+
+	// Decode one instruction per slot. Slots at 64-byte boundaries hold
+	// scheduling information instead of instructions, and are decoded
+	// too to keep a direct mapping between offsets and slots.
+	int size = sizeof(Instruction::Bytes);
+	int num_instructions = text_size / size;
+	instructions.resize(num_instructions);
+	for (int i = 0; i < num_instructions; i++)
+		instructions[i].Decode(text_buffer + i * size, i * size);
+}
+
 } // namespace Kepler
 
@@ -25,6 +25,7 @@ d *  Multi2Sim
 #include <vector>
 
 #include <lib/cpp/Misc.h>
+#include <arch/kepler/disassembler/Instruction.h>
 
 #include "Argument.h"
 //#include "Module.h"
@@ -56,6 +57,11 @@ class Function
 	// Arguments
 	std::vector<std::unique_ptr<Argument>> arguments;
 
+	// Instructions of the ISA section, one per 8-byte slot, decoded the
+	// first time a grid is launched for this function and shared by all
+	// warps of all grids.
+	std::vector<Instruction> instructions;
+
 public:
 
 	/// Constructor
@@ -83,6 +89,20 @@ public:
 
 	/// Get function name
 	std::string getName() const { return name; }
+
+	/// Decode all instructions in the ISA section, if they were not
+	/// decoded before.
+	void DecodeInstructions();
+
+	/// Return the decoded instruction at the given offset of the ISA
+	/// section. Function DecodeInstructions() must have been called
+	/// before.
+	Instruction *getInstruction(unsigned pc)
+	{
+		assert(pc % sizeof(Instruction::Bytes) == 0);
+		assert(pc / sizeof(Instruction::Bytes) < instructions.size());
+		return &instructions[pc / sizeof(Instruction::Bytes)];
+	}
 };
 
 
@@ -85,12 +85,12 @@ class Grid
 	std::list<Grid *>::iterator running_grid_list_iter;
 	std::list<Grid *>::iterator finished_grid_list_iter;
 
+	// Kernel function
+	Function *function;
+
 	// Instruction buffer size in bytes
 	int instruction_buffer_size;
 
-	// Instruction buffer contains the all the instructions in the kernel binary
-	std::vector<unsigned long long> instruction_buffer;
-
 	// Shared memory top pointer
 	unsigned shared_memory_top;
 
@@ -142,10 +142,14 @@ public:
 		return thread_block_count3[index];
 	}
 
-	/// Get instruction buffer
-	std::vector<unsigned long long>::iterator getInstructionBuffer()
+	/// Get kernel function
+	Function *getFunction() const { return function; }
+
+	/// Return the instruction at the given offset of the kernel, decoded
+	/// once for the kernel function
+	Instruction *getInstruction(unsigned pc)
 	{
-		return instruction_buffer.begin();
+		return function->getInstruction(pc);
 	}
 
 	/// Get instruction buffer size
@@ -50,33 +50,70 @@ enum RegValueType
 };
 
 
-// This class includes all kinds of registers used in Thread
+/// Registers of all threads in a warp. Each register is stored as an array
+/// with one element per lane, so that instructions executed for the whole
+/// warp at once access consecutive elements.
+class RegisterFile
+{
+public:
+
+	/// Number of lanes, equal to the warp size
+	static const int NumLanes = 32;
+
+	/// General purpose registers, indexed by register and lane
+	RegValue gpr[256][NumLanes];
+
+	/// Special registers, indexed by register and lane
+	RegValue sr[82][NumLanes];
+
+	/// Predicate registers, indexed by register and lane
+	unsigned pr[8][NumLanes];
+
+	/// Condition code registers, indexed by lane
+	CC cc[NumLanes];
+};
+
+
+// This class includes all kinds of registers used in Thread. The registers
+// are stored in the register file of the warp, at the lane of the thread.
 class Register
 {
 
 private:
 
-	RegValue gpr[256];  /* General purpose registers */
-	RegValue sr[82];  /* Special registers */
-	unsigned pr[8];  /* Predicate registers */
-	CC cc;
+	// Register file of the warp
+	RegisterFile *file;
+
+	// Lane of the thread in the register file
+	int lane;
 
 public:
 
+	/// Constructor
+	Register(RegisterFile *file, int lane) : file(file), lane(lane)
+	{
+	}
+
 	/// Get value of a GPR
 	/// \param vreg GPR identifier
-	unsigned ReadGPR(int gpr_id) const { return gpr[gpr_id].u32; }
+	unsigned ReadGPR(int gpr_id) const
+	{
+		return file->gpr[gpr_id][lane].u32;
+	}
 
 	/// Get float type value of a GPR
 	/// \param vreg GPR identifier
-	float ReadFloatGPR(int gpr_id) const { return gpr[gpr_id].f; }
+	float ReadFloatGPR(int gpr_id) const
+	{
+		return file->gpr[gpr_id][lane].f;
+	}
 
 	/// Set value of a GPR
 	/// \param gpr GPR idenfifier
 	/// \param value Value given as an \a unsigned typed value
 	void WriteGPR(int gpr_id, unsigned value)
 	{
-		gpr[gpr_id].u32 = value;
+		file->gpr[gpr_id][lane].u32 = value;
 	}
 
 	/// Set float value of a GPR
@@ -84,14 +121,14 @@ public:
 	/// \param value Value given as an \a float typed value
 	void WriteFloatGPR(int gpr_id, float value)
 	{
-		gpr[gpr_id].f = value;
+		file->gpr[gpr_id][lane].f = value;
 	}
 
 	/// Get value of a SR
 	/// \param vreg SR identifier
 	unsigned ReadSpecialRegister(int special_register_id)
 	{
-		return sr[special_register_id].u32;
+		return file->sr[special_register_id][lane].u32;
 	}
 
 	/// Set value of a SR
@@ -99,54 +136,54 @@ public:
 	/// \param value Value given as an \a unsigned typed value
 	void WriteSpecialRegister(int special_register_id, unsigned value)
 	{
-		sr[special_register_id].u32 = value;
+		file->sr[special_register_id][lane].u32 = value;
 	}
 
 	/// Get value of a predicate register
 	/// \param pr Predicate register identifier
-	int ReadPredicate(int predicate_id) { return pr[predicate_id]; };
+	int ReadPredicate(int predicate_id) { return file->pr[predicate_id][lane]; };
 
 	/// Write value of a predicate register
 	/// \param pr predicate register identifier
 	void WritePredicate(int predicate_id, unsigned value)
 	{
-		pr[predicate_id] = value;
+		file->pr[predicate_id][lane] = value;
 	};
 
 	/// Read value of Condition Code register
-	unsigned ReadCC_ZF() { return cc.zf; };
+	unsigned ReadCC_ZF() { return file->cc[lane].zf; };
 
 	/// Read value of Condition Code register
-	unsigned ReadCC_SF() { return cc.sf; };
+	unsigned ReadCC_SF() { return file->cc[lane].sf; };
 
 	/// Read value of Condition Code register
-	unsigned ReadCC_CF() { return cc.cf; };
+	unsigned ReadCC_CF() { return file->cc[lane].cf; };
 
 	/// Read value of Condition Code register
-	unsigned ReadCC_OF() { return cc.of; };
+	unsigned ReadCC_OF() { return file->cc[lane].of; };
 
 	/// Write value of Condition register
-	void WriteCC_ZF(unsigned value) { cc.zf = value; };
+	void WriteCC_ZF(unsigned value) { file->cc[lane].zf = value; };
 
 	/// Write value of Condition register
-	void WriteCC_SF(unsigned value) { cc.sf = value; };
+	void WriteCC_SF(unsigned value) { file->cc[lane].sf = value; };
 
 	/// Write value of Condition register
-	void WriteCC_CF(unsigned value) { cc.cf = value; };
+	void WriteCC_CF(unsigned value) { file->cc[lane].cf = value; };
 
 	/// Write value of Condition register
-	void WriteCC_OF(unsigned value) { cc.of = value; };
+	void WriteCC_OF(unsigned value) { file->cc[lane].of = value; };
 
 	/// Read value of register
 	void Read_register(unsigned *dst, int gpr_id)
 	{
-		memcpy(dst, &gpr[gpr_id], 4);
+		memcpy(dst, &file->gpr[gpr_id][lane], 4);
 	}
 
 	/// Write to register
 	void Write_register(unsigned *src, int gpr_id)
 	{
-		memcpy(&gpr[gpr_id], src, 4);
+		memcpy(&file->gpr[gpr_id][lane], src, 4);
 	}
 };
 
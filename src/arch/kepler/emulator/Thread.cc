@@ -27,7 +27,12 @@
 namespace Kepler
 {
 
-Thread::Thread(Warp *warp, int id)
+Thread::InstFunc Thread::inst_func[Instruction::OpcodeCount];
+bool Thread::inst_func_initialized = false;
+
+
+Thread::Thread(Warp *warp, int id) :
+		registers(warp->getRegisterFile(), id % warp_size)
 {
 	// Initialization
 	this->emulator = emulator->getInstance();
@@ -52,10 +57,14 @@ Thread::Thread(Warp *warp, int id)
 			(const char *) &local_memory_top_generic_address);
 
 	// Initialization instruction table
+	if (!inst_func_initialized)
+	{
 #define DEFINST(_name, _fmt_str, ...) \
 		inst_func[Instruction::INST_##_name] = &Thread::ExecuteInst_##_name;
 #include "../disassembler/Instruction.def"
 #undef DEFINST
+		inst_func_initialized = true;
+	}
 
 	// Initialize  general purpose registers
 	for (int i = 0; i < 256; ++i)
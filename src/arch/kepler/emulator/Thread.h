@@ -117,9 +117,11 @@ private:
 	// FIXME in the future
 	void ExecuteInst_Special();
 
-	// Instruction execution table
+	// Instruction execution table, shared by all threads and initialized
+	// when the first thread is created
 	typedef void (Thread::*InstFunc)(Instruction *inst);
-	InstFunc inst_func[Instruction::OpcodeCount];
+	static InstFunc inst_func[Instruction::OpcodeCount];
+	static bool inst_func_initialized;
 
 	// Error massage for unimplemented instructions
 	static void ISAUnimplemented(Instruction *inst);
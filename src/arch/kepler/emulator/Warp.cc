@@ -34,7 +34,7 @@
 namespace Kepler
 {
 
-Warp::Warp(ThreadBlock *thread_block, unsigned id):inst(Instruction())
+Warp::Warp(ThreadBlock *thread_block, unsigned id)
 {
 
 	unsigned am = 0;
@@ -63,6 +63,9 @@ Warp::Warp(ThreadBlock *thread_block, unsigned id):inst(Instruction())
 		thread_count = grid->getThreadBlockSize() -
 		(thread_block->getWarpCount() - 1) * warp_size;
 
+	// Register file, initialized by each thread for its own lane
+	registers = misc::new_unique<RegisterFile>();
+
 	// Return Address Stack
 	return_stack = std::unique_ptr<ReturnAddressStack>(new ReturnAddressStack());
 	// SyncStack
@@ -86,7 +89,6 @@ Warp::Warp(ThreadBlock *thread_block, unsigned id):inst(Instruction())
 	pc = 0;
 	target_pc = 0;
 	inst_size = 8;
-	instruction_buffer = grid->getInstructionBuffer();
 	instruction_buffer_size = grid->getInstructionBufferSize();
 
 
@@ -118,23 +120,16 @@ void Warp::Execute()
 	// Get emu instance
 	Emulator *emulator = Emulator::getInstance();
 
-	// Instruction binary
-	Instruction::Bytes inst_bytes;
-
 	// Instruction opcode
 	Instruction::Opcode inst_op;
 
-	// Read instruction binary
-	inst_bytes.as_uint[0] = instruction_buffer[pc / inst_size] >> 32;
-	inst_bytes.as_uint[1] = instruction_buffer[pc / inst_size];
-
-	// Decode instruction
+	// Get instruction, decoded once for the kernel function
 	if( pc % 64)
 	{
-			inst.Decode((const char *) &inst_bytes, pc);
+			Instruction *inst = grid->getInstruction(pc);
 
 			// Execute instruction
-			inst_op = (Instruction::Opcode) inst.getOpcode();
+			inst_op = (Instruction::Opcode) inst->getOpcode();
 
 			if (!inst_op)
 			{
@@ -143,17 +138,13 @@ void Warp::Execute()
 				misc::Panic("Simulation exits with exception.\n");
 			}
 
-			for (auto thread_id = threads_begin; thread_id < threads_end; ++thread_id)
+			// Common instructions are executed for the whole warp
+			// at once, and the rest one thread at a time.
+			if (!ExecuteVector(inst_op, inst))
 			{
-				/*
-				if (thread_id->get()->getId() == 0)
-				std::cerr << inst.getName() << " id " << thread_id->get()->getId()
-						<< " warp_id " << id << " thread count " << this->thread_count
-						<< " block id " << thread_block->getId()
-						<< " warp count " << thread_block->getWarpCount()
-						<< " pc " << pc << std::endl;
-						*/
-				thread_id->get()->Execute(inst_op,&inst);
+				for (auto thread_id = threads_begin;
+						thread_id < threads_end; ++thread_id)
+					thread_id->get()->Execute(inst_op, inst);
 			}
 	}
 	else
@@ -29,6 +29,7 @@
 #include <lib/util/bit-map.h>
 
 #include "Grid.h"
+#include "Register.h"
 #include "ReturnAddressStack.h"
 #include "ThreadBlock.h"
 #include "Warp.h"
@@ -87,14 +88,11 @@ class Warp
 	// Target PC for next instruction
 	int target_pc;
 
-	// Current instruction
-	Instruction inst;
-
-	// Pointer points to the starting position of instruction buffer
-	std::vector<unsigned long long>::iterator instruction_buffer;
-
 	// The whole instruction buffer size in bytes
 	unsigned instruction_buffer_size;
+
+	// Registers of all threads in the warp
+	std::unique_ptr<RegisterFile> registers;
 	
 	// Return address stack
 	std::unique_ptr<ReturnAddressStack> return_stack;
@@ -140,6 +138,41 @@ class Warp
 	// past-the-end iterator to the thread-block's thread list.
 	std::vector<std::unique_ptr<Thread>>::iterator threads_end;
 
+
+
+
+	//
+	// Warp-wide execution of common instructions, implemented in
+	// WarpIsa.cc
+	//
+
+	// Function executing an instruction for all lanes in \a mask at once
+	typedef void (Warp::*VectorFunc)(Instruction *inst, unsigned mask);
+
+	// Return the function executing the given instruction for the whole
+	// warp, or nullptr if the instruction, or the particular variant
+	// encoded in it, must be executed one thread at a time.
+	VectorFunc getVectorFunc(Instruction::Opcode opcode,
+			Instruction *inst) const;
+
+	// Return the mask of lanes among \a active_mask for which the guard
+	// predicate with the given identifier is true
+	unsigned getPredicateMask(unsigned active_mask, unsigned pred_id) const;
+
+	// Warp-wide instruction implementations
+	void ExecuteVector_FFMA_B(Instruction *inst, unsigned mask);
+	void ExecuteVector_FADD_B(Instruction *inst, unsigned mask);
+	void ExecuteVector_FMUL(Instruction *inst, unsigned mask);
+	void ExecuteVector_IADD_A(Instruction *inst, unsigned mask);
+	void ExecuteVector_MOV_B(Instruction *inst, unsigned mask);
+	void ExecuteVector_MOV32I(Instruction *inst, unsigned mask);
+	void ExecuteVector_ISETP_B(Instruction *inst, unsigned mask);
+
+	// Execute the instruction for the whole warp at once, if supported.
+	// Return false if the instruction must be executed one thread at a
+	// time instead, in which case the warp state is not modified.
+	bool ExecuteVector(Instruction::Opcode opcode, Instruction *inst);
+
 public:
 	/// Constructor
 	///
@@ -162,6 +195,9 @@ public:
 	/// Return PC
 	unsigned getPC() const { return pc; }
 
+	/// Return the register file shared by all threads in the warp
+	RegisterFile *getRegisterFile() const { return registers.get(); }
+
 	/// Return pointer to a thread inside this warp
 	Thread *getThread(int id_in_warp)
 	{
@@ -0,0 +1,444 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2012  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cmath>
+#include <cstdlib>
+
+#include "../disassembler/Instruction.h"
+
+#include "Emulator.h"
+#include "SyncStack.h"
+#include "Warp.h"
+
+
+namespace Kepler
+{
+
+// The functions in this file execute an instruction for all lanes of a warp
+// at once, over the register file of the warp, with the same semantics as
+// the per-thread implementations in ThreadIsa.cc. The result is computed
+// for all lanes, and only written for lanes in the execution mask, so that
+// the loops over lanes have no branches.
+
+static const int NumLanes = RegisterFile::NumLanes;
+
+
+// Fill all lanes of an operand with a 32-bit value from constant memory
+static void BroadcastConstant(unsigned address, RegValue *values)
+{
+	RegValue value;
+	Emulator::getInstance()->ReadConstantMemory(address, 4,
+			(char *) &value);
+	for (int lane = 0; lane < NumLanes; lane++)
+		values[lane] = value;
+}
+
+
+unsigned Warp::getPredicateMask(unsigned active_mask, unsigned pred_id) const
+{
+	// Predicates 8 to 15 are the negated predicates 0 to 7
+	const unsigned *pred = registers->pr[pred_id & 7];
+	bool negate = pred_id > 7;
+
+	// Lanes for which the predicate is true
+	unsigned mask = 0;
+	for (unsigned lane = 0; lane < thread_count; lane++)
+		if (negate ? pred[lane] == 0 : pred[lane] == 1)
+			mask |= 1u << lane;
+	return mask & active_mask;
+}
+
+
+Warp::VectorFunc Warp::getVectorFunc(Instruction::Opcode opcode,
+		Instruction *inst) const
+{
+	// Some per-thread implementations dump information for each thread
+	// when this variable is set
+	static const bool kpl_isa_debug = getenv("M2S_KPL_ISA_DEBUG");
+
+	// Variants that are unsupported or produce undefined results are
+	// left to the per-thread implementations
+	Instruction::Bytes bytes = inst->getInstBytes();
+	switch (opcode)
+	{
+
+	case Instruction::INST_FFMA_B:
+
+		if (bytes.ffma.op2 == 0 || bytes.ffma.fmz == 1 ||
+				bytes.ffma.sat)
+			return nullptr;
+		return &Warp::ExecuteVector_FFMA_B;
+
+	case Instruction::INST_FADD_B:
+
+		if ((bytes.fadd.op2 != 1 && bytes.fadd.op2 != 3) ||
+				bytes.fadd.ftz || bytes.fadd.sat ||
+				bytes.fadd.cc)
+			return nullptr;
+		return &Warp::ExecuteVector_FADD_B;
+
+	case Instruction::INST_FMUL:
+
+		return &Warp::ExecuteVector_FMUL;
+
+	case Instruction::INST_IADD_A:
+
+		if (bytes.iadd.cc || bytes.iadd.x)
+			return nullptr;
+		return &Warp::ExecuteVector_IADD_A;
+
+	case Instruction::INST_MOV_B:
+
+		if (kpl_isa_debug)
+			return nullptr;
+		return &Warp::ExecuteVector_MOV_B;
+
+	case Instruction::INST_MOV32I:
+
+		if (bytes.immediate.s)
+			return nullptr;
+		return &Warp::ExecuteVector_MOV32I;
+
+	case Instruction::INST_ISETP_B:
+	{
+		unsigned cmp_op = ((bytes.general0.op1 & 0x1u) << 2) |
+				(bytes.general0.mod1 >> 10);
+		unsigned bool_op = (bytes.general0.mod1 >> 6) & 0x3;
+		if (kpl_isa_debug || bytes.general0.srcB_mod != 1 ||
+				cmp_op < 1 || cmp_op > 6 || bool_op > 1)
+			return nullptr;
+		return &Warp::ExecuteVector_ISETP_B;
+	}
+
+	default:
+
+		return nullptr;
+	}
+}
+
+
+bool Warp::ExecuteVector(Instruction::Opcode opcode, Instruction *inst)
+{
+	// The ISA debug information is dumped for each thread
+	if (Emulator::isa_debug)
+		return false;
+
+	// Check if the instruction can be executed for the whole warp
+	VectorFunc func = getVectorFunc(opcode, inst);
+	if (!func)
+		return false;
+
+	// Determine whether the warp reaches reconvergence pc. If it is, pop
+	// the synchronization stack top and restore the active mask, as
+	// thread 0 does in the per-thread implementations.
+	SyncStack *stack = getSyncStack()->get();
+	if (pc)
+	{
+		unsigned active_mask;
+		if (stack->pop(pc, active_mask))
+			stack->setActiveMask(active_mask);
+	}
+
+	// Execute for the active lanes with a true predicate
+	unsigned mask = getPredicateMask(stack->getActiveMask(),
+			inst->getInstBytes().general0.pred);
+	(this->*func)(inst, mask);
+
+	// Next instruction, as set by the last thread in the per-thread
+	// implementations
+	target_pc = pc + inst_size;
+	return true;
+}
+
+
+void Warp::ExecuteVector_FFMA_B(Instruction *inst, unsigned mask)
+{
+	Instruction::BytesFFMA format = inst->getInstBytes().ffma;
+
+	// Sources
+	RegValue constant[NumLanes];
+	const RegValue *src1 = registers->gpr[format.src1];
+	const RegValue *src2;
+	const RegValue *src3;
+	if (format.op2 == 1)
+	{
+		// src2 is constant, src3 is register
+		BroadcastConstant(format.src2 << 2, constant);
+		src2 = constant;
+		src3 = registers->gpr[format.src3];
+	}
+	else if (format.op2 == 2)
+	{
+		// src2 is register, src3 is constant
+		src2 = registers->gpr[format.src3];
+		BroadcastConstant(format.src2 << 2, constant);
+		src3 = constant;
+	}
+	else
+	{
+		// Both src2 and src3 are registers
+		src2 = registers->gpr[format.src2];
+		src3 = registers->gpr[format.src3];
+	}
+
+	// Execute
+	RegValue *dst = registers->gpr[format.dst];
+	for (int lane = 0; lane < NumLanes; lane++)
+	{
+		float temp = src1[lane].f * src2[lane].f;
+		float addend = src3[lane].f;
+		if (format.negate_ab == 1)
+			temp = -temp;
+		else if (format.negate_c == 1)
+			addend = -addend;
+		temp += addend;
+		if (mask & (1u << lane))
+			dst[lane].f = temp;
+	}
+}
+
+
+void Warp::ExecuteVector_FADD_B(Instruction *inst, unsigned mask)
+{
+	Instruction::BytesFADD format = inst->getInstBytes().fadd;
+
+	// Sources
+	RegValue constant[NumLanes];
+	const RegValue *src1 = registers->gpr[format.src1];
+	const RegValue *src2;
+	if (format.op2 == 1)
+	{
+		BroadcastConstant(format.src2 << 2, constant);
+		src2 = constant;
+	}
+	else
+	{
+		src2 = registers->gpr[format.src2];
+	}
+
+	// Execute
+	RegValue *dst = registers->gpr[format.dst];
+	for (int lane = 0; lane < NumLanes; lane++)
+	{
+		float value1 = src1[lane].f;
+		float value2 = src2[lane].f;
+		if (format.src1_abs == 1)
+			value1 = fabsf(value1);
+		if (format.src1_negate == 1)
+			value1 = -value1;
+		if (format.src2_abs == 1)
+			value2 = fabsf(value2);
+		if (format.src2_negate == 1)
+			value2 = -value2;
+		float result = value1 + value2;
+		if (mask & (1u << lane))
+			dst[lane].f = result;
+	}
+}
+
+
+void Warp::ExecuteVector_FMUL(Instruction *inst, unsigned mask)
+{
+	Instruction::BytesGeneral0 format = inst->getInstBytes().general0;
+
+	// Sources
+	RegValue constant[NumLanes];
+	const RegValue *src1 = registers->gpr[format.mod0];
+	const RegValue *src2;
+	if (format.srcB_mod == 0)
+	{
+		BroadcastConstant(format.srcB << 2, constant);
+		src2 = constant;
+	}
+	else
+	{
+		src2 = registers->gpr[format.srcB];
+	}
+
+	// Execute
+	RegValue *dst = registers->gpr[format.dst];
+	for (int lane = 0; lane < NumLanes; lane++)
+	{
+		float value1 = src1[lane].f;
+		float value2 = src2[lane].f;
+		if (((format.mod1 >> 3) & 0x1) == 1)
+			value1 = fabsf(value1);
+		if (((format.mod1 >> 5) & 0x1) == 1)
+			value1 = -value1;
+		if (((format.mod1 >> 2) & 0x1) == 1)
+			value2 = fabsf(value2);
+		if (((format.mod1 >> 4) & 0x1) == 1)
+			value2 = -value2;
+		float result = value1 * value2;
+		if (mask & (1u << lane))
+			dst[lane].f = result;
+	}
+}
+
+
+void Warp::ExecuteVector_IADD_A(Instruction *inst, unsigned mask)
+{
+	Instruction::BytesIADD format = inst->getInstBytes().iadd;
+
+	// Source 2 is a sign-extended 20-bit immediate
+	unsigned src2 = ((format.op1 >> 5) & 1) ?
+			format.src2 | 0xfff80000 : format.src2;
+
+	// Operand negation and least significant bit for the addition
+	unsigned lsb = 0;
+	bool negate_src1 = false;
+	if (format.po == 3)
+	{
+		lsb = 1;
+	}
+	else if (format.po == 1)
+	{
+		src2 = ~src2;
+		lsb = 1;
+	}
+	else if (format.po == 2)
+	{
+		negate_src1 = true;
+		lsb = 1;
+	}
+
+	// Execute
+	const RegValue *src1 = registers->gpr[format.src1];
+	RegValue *dst = registers->gpr[format.dst];
+	for (int lane = 0; lane < NumLanes; lane++)
+	{
+		unsigned value1 = negate_src1 ? ~src1[lane].u32 :
+				src1[lane].u32;
+		unsigned result = value1 + src2 + lsb;
+		if (mask & (1u << lane))
+			dst[lane].u32 = result;
+	}
+}
+
+
+void Warp::ExecuteVector_MOV_B(Instruction *inst, unsigned mask)
+{
+	Instruction::BytesGeneral0 format = inst->getInstBytes().general0;
+
+	// Source
+	RegValue constant[NumLanes];
+	const RegValue *src;
+	if (format.srcB_mod == 0)
+	{
+		BroadcastConstant(format.srcB << 2, constant);
+		src = constant;
+	}
+	else
+	{
+		src = registers->gpr[format.srcB];
+	}
+
+	// Execute
+	RegValue *dst = registers->gpr[format.dst];
+	for (int lane = 0; lane < NumLanes; lane++)
+	{
+		unsigned value = src[lane].u32;
+		if (mask & (1u << lane))
+			dst[lane].u32 = value;
+	}
+}
+
+
+void Warp::ExecuteVector_MOV32I(Instruction *inst, unsigned mask)
+{
+	Instruction::BytesImm format = inst->getInstBytes().immediate;
+
+	// Execute
+	unsigned value = format.imm32;
+	RegValue *dst = registers->gpr[format.dst];
+	for (int lane = 0; lane < NumLanes; lane++)
+		if (mask & (1u << lane))
+			dst[lane].u32 = value;
+}
+
+
+void Warp::ExecuteVector_ISETP_B(Instruction *inst, unsigned mask)
+{
+	Instruction::BytesGeneral0 format = inst->getInstBytes().general0;
+
+	// Source B is a sign-extended 19-bit immediate
+	int srcB = format.srcB;
+	if (srcB >> 18)
+		srcB |= 0xfff80000;
+
+	// Operations
+	unsigned cmp_op = ((format.op1 & 0x1u) << 2) | (format.mod1 >> 10);
+	unsigned bool_op = (format.mod1 >> 6) & 0x3;
+	bool negate_pred_3 = (format.mod1 >> 3) & 0x1;
+
+	// Predicates
+	unsigned pred_id_1 = (format.dst >> 3) & 0x7;
+	unsigned pred_id_2 = format.dst & 0x7;
+	unsigned pred_id_3 = format.mod1 & 0x7;
+	const RegValue *srcA = registers->gpr[format.mod0];
+	unsigned *pred_1 = registers->pr[pred_id_1];
+	unsigned *pred_2 = registers->pr[pred_id_2];
+	const unsigned *pred_3 = registers->pr[pred_id_3];
+
+	// Execute
+	for (int lane = 0; lane < NumLanes; lane++)
+	{
+		if (!(mask & (1u << lane)))
+			continue;
+
+		// Compare
+		int value = srcA[lane].s32;
+		bool cmp_res;
+		switch (cmp_op)
+		{
+		case 1: cmp_res = value < srcB; break;
+		case 2: cmp_res = value == srcB; break;
+		case 3: cmp_res = value <= srcB; break;
+		case 4: cmp_res = value > srcB; break;
+		case 5: cmp_res = value != srcB; break;
+		default: cmp_res = value >= srcB; break;
+		}
+
+		// Logic
+		unsigned value_3 = pred_3[lane];
+		if (negate_pred_3)
+			value_3 = !value_3;
+		unsigned value_1;
+		unsigned value_2;
+		if (bool_op == 0)
+		{
+			value_1 = cmp_res && value_3;
+			value_2 = !cmp_res && value_3;
+		}
+		else
+		{
+			value_1 = cmp_res || value_3;
+			value_2 = !cmp_res || value_3;
+		}
+
+		// Write
+		if (pred_id_1 != 7)
+			pred_1[lane] = value_1;
+		if (pred_id_2 != 7)
+			pred_2[lane] = value_2;
+	}
+}
+
+
+}  // namespace Kepler
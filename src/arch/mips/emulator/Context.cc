@@ -170,6 +170,7 @@ void Context::Load(const std::vector<std::string> &args,
 	// Create new memory image
 	assert(!memory.get());
 	memory.reset(new mem::Memory());
+	decode_cache.reset(new mem::DecodeCache<Instruction, 4>(memory.get()));
 	address_space_index = emulator->getAddressSpaceIndex();
 
 	// Create signal handler table
@@ -389,29 +390,45 @@ void Context::Execute()
 	// set PC to the next instruction pointer
 	regs.setPC(next_ip);
 
-	// read 4 bytes mips instruction from memory into buffer
-	char buffer[4];
-
-	char *buffer_ptr = memory->getBuffer(regs.getPC(), 4,
-				mem::Memory::AccessExec);
-	if (!buffer_ptr)
+	// Look for the instruction in the decode cache
+	unsigned pc = regs.getPC();
+	Instruction *cached_inst = nullptr;
+	if (Emulator::getDecodeCacheEnabled() && !(pc & 3))
+		cached_inst = decode_cache->Lookup(pc,
+				[pc](Instruction &inst, const char *buffer)
+				{
+					inst.Decode(pc, buffer);
+				});
+	if (cached_inst)
 	{
-		// Disable safe mode. If a part of the 4 read bytes does not
-		// belong to the actual instruction, and they lie on a page with
-		// no permissions, this would generate an undesired protection
-		// fault.
-		memory->setSafe(false);
-		buffer_ptr = buffer;
-		memory->Access(regs.getPC(), 4, buffer_ptr,
-				mem::Memory::AccessExec);
+		inst = *cached_inst;
+	}
+	else
+	{
+		// read 4 bytes mips instruction from memory into buffer
+		char buffer[4];
+
+		char *buffer_ptr = memory->getBuffer(pc, 4,
+					mem::Memory::AccessExec);
+		if (!buffer_ptr)
+		{
+			// Disable safe mode. If a part of the 4 read bytes does
+			// not belong to the actual instruction, and they lie on
+			// a page with no permissions, this would generate an
+			// undesired protection fault.
+			memory->setSafe(false);
+			buffer_ptr = buffer;
+			memory->Access(pc, 4, buffer_ptr,
+					mem::Memory::AccessExec);
+		}
+
+		// Disassemble
+		inst.Decode(pc, buffer_ptr);
 	}
 
 	// Return to default safe mode
 	memory->setSafeDefault();
 
-	// Disassemble
-	inst.Decode(regs.getPC(), buffer_ptr);
-
 	// Debug
 	if (emulator->isa_debug)
 	{
@@ -25,6 +25,7 @@
 
 #include <arch/common/CallStack.h>
 #include <lib/cpp/ELFReader.h>
+#include <memory/DecodeCache.h>
 #include <memory/Memory.h>
 #include <memory/SpecMem.h>
 #include <arch/common/FileTable.h>
@@ -119,6 +120,10 @@ class Context
 	// this memory object will be the one automatically freeing it.
 	std::shared_ptr<mem::Memory> memory;
 
+	// Decoded instructions of the code pages in the memory. This object
+	// is shared by all contexts sharing the memory object.
+	std::shared_ptr<mem::DecodeCache<Instruction, 4>> decode_cache;
+
 	// Speculative memory. Its initialization is deferred to be able to link
 	// it with the actual memory, known only at context creation.
 	std::unique_ptr<mem::SpecMem> spec_mem;
@@ -48,6 +48,9 @@ class Emulator : public comm::Emulator
 	static std::string isa_debug_file;
 	static std::string syscall_debug_file;
 
+	// Disable the decoded instruction cache
+	static bool no_decode_cache;
+
 	// Unique instance of the singleton
 	static std::unique_ptr<Emulator> instance;
 
@@ -80,7 +83,7 @@ class Emulator : public comm::Emulator
 
 	// Emulator mutex, used to access shared variables between main program
 	// and child host threads.
-	pthread_mutex_t mutex;
+	pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
 
 	// Counter of times that a context has been suspended in a futex. Used
 	// for FIFO wakeups.
@@ -105,6 +108,10 @@ public:
 		}
 	};
 
+	/// Return whether contexts should fetch instructions through the
+	/// cache of decoded instructions of their address space
+	static bool getDecodeCacheEnabled() { return !no_decode_cache; }
+
 	/// Return unique instance of the MIPS emulator singleton.
 	static Emulator *getInstance();
 
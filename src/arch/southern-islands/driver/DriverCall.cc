@@ -19,6 +19,7 @@
 
 #include <cassert>
 
+#include <arch/common/CopyEngine.h>
 #include <arch/southern-islands/disassembler/Argument.h>
 #include <arch/southern-islands/emulator/Emulator.h>
 #include <arch/southern-islands/timing/Gpu.h>
@@ -129,6 +130,13 @@ int Driver::CallMemRead(comm::Context *context,
 	auto buffer = misc::new_unique_array<char>(size);
 	video_memory->Read(device_ptr, size, buffer.get());
 	memory->Write(host_ptr, size, buffer.get());
+
+	// Suspend the host context for the duration of the transfer
+	comm::CopyEngine *copy_engine = comm::CopyEngine::getInstance(
+			"SouthernIslands");
+	if (copy_engine)
+		copy_engine->Transfer(context,
+				comm::CopyEngine::DirectionDeviceToHost, size);
 	
 	// Return                                                         
 	return 0; 
@@ -178,6 +186,13 @@ int Driver::CallMemWrite(comm::Context *context,
 	memory->Read(host_ptr, size, buffer.get());
 	video_memory->Write(device_ptr, size, buffer.get());
 
+	// Suspend the host context for the duration of the transfer
+	comm::CopyEngine *copy_engine = comm::CopyEngine::getInstance(
+			"SouthernIslands");
+	if (copy_engine)
+		copy_engine->Transfer(context,
+				comm::CopyEngine::DirectionHostToDevice, size);
+
 	// Return
 	return 0;
 }
@@ -914,6 +929,13 @@ int Driver::CallNDRangeStart(comm::Context *context,
 	// Increment number of ndranges that are running
 	emulator->incNDRangesRunning();
 
+	// Hold back transfers if the copy engine cannot overlap them with
+	// kernel execution
+	comm::CopyEngine *copy_engine = comm::CopyEngine::getInstance(
+			"SouthernIslands");
+	if (copy_engine)
+		copy_engine->KernelStarted();
+
 	// Return
 	return 0;
 }
@@ -932,6 +954,12 @@ int Driver::CallNDRangeEnd(comm::Context *context,
 	// Decrement number of ndranges that are running
 	emulator->decNDRangesRunning();
 
+	// Release transfers held back by the copy engine
+	comm::CopyEngine *copy_engine = comm::CopyEngine::getInstance(
+			"SouthernIslands");
+	if (copy_engine)
+		copy_engine->KernelFinished();
+
 	// Return
 	return 0;
 }
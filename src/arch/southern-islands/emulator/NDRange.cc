@@ -144,6 +144,24 @@ void NDRange::SetupInstructionMemory(const char *buf, unsigned size, unsigned pc
 	// Save a copy of buffer in NDRange
 	instruction_buffer = misc::new_unique_array<char>(size);
 	instruction_memory->Read(pc, size, instruction_buffer.get());
+
+	// Allocate the table of decoded instructions
+	instructions.clear();
+	instructions.resize(size / 4);
+	instructions_valid.assign(size / 4, false);
+}
+
+
+void NDRange::DecodeInstruction(unsigned index)
+{
+	// Decode directly from the copy of the instruction buffer. A literal
+	// constant following the instruction is read by the decoder from the
+	// next 32-bit word.
+	unsigned offset = index * 4;
+	assert(offset < instruction_buffer_size);
+	instructions[index].Decode(instruction_buffer.get() + offset,
+			instruction_address + offset);
+	instructions_valid[index] = true;
 }
 
 
@@ -23,9 +23,11 @@
 #include <deque>
 #include <list>
 #include <memory>
+#include <vector>
 
 #include <arch/common/Context.h>
 #include <arch/southern-islands/disassembler/Binary.h>
+#include <arch/southern-islands/disassembler/Instruction.h>
 #include <memory/Memory.h>
 #include <memory/Mmu.h>
 
@@ -161,6 +163,15 @@ private:
 	unsigned instruction_address = 0;
 	unsigned instruction_buffer_size = 0;
 
+	// Decoded instructions, with one slot for each 32-bit word of the
+	// instruction buffer. The table is shared by all wavefronts of the
+	// ND-range, and each slot is decoded the first time it is fetched.
+	std::vector<Instruction> instructions;
+	std::vector<bool> instructions_valid;
+
+	// Decode the instruction at the given slot of the table
+	void DecodeInstruction(unsigned index);
+
 	// Local memory top to assign to local arguments.
 	// Initially it is equal to the size of local variables in 
 	// kernel function.
@@ -346,6 +357,20 @@ public:
 	unsigned getInstructionBufferSize() const { 
 			return instruction_buffer_size; }
 
+	/// Return the decoded instruction at address \a pc of the instruction
+	/// memory. The instruction is decoded on its first fetch by any
+	/// wavefront and served from the table of decoded instructions
+	/// afterwards.
+	Instruction *getInstruction(unsigned pc)
+	{
+		unsigned index = (pc - instruction_address) / 4;
+		assert(pc >= instruction_address && !(pc & 3));
+		assert(index < instructions.size());
+		if (!instructions_valid[index])
+			DecodeInstruction(index);
+		return &instructions[index];
+	}
+
 	/// Get user element object
 	BinaryUserElement *getUserElement(int idx)
 	{
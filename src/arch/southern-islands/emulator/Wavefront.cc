@@ -153,7 +153,6 @@ void Wavefront::Execute()
 	NDRange *ndrange = work_group->getNDRange();
 	Emulator *emulator = ndrange->getEmulator();
 	WorkItem *work_item = NULL;
-	this->instruction = misc::new_unique<Instruction>();
 
 	// Reset instruction flags
 	vector_memory_write = 0;
@@ -170,25 +169,10 @@ void Wavefront::Execute()
 	// Make sure the program has not finished yet
 	assert(!finished);
 	
-	// Grab the instruction at PC and update the pointer 
-
-	// Make sure the program counter is not outside the instruction memory
-	unsigned total_inst_buffer_size = ndrange->getInstructionBufferSize();
-	assert(total_inst_buffer_size > pc);
-
-	// Find out the remaining size of the instruction memory
-	unsigned remaining_inst_buffer_size = total_inst_buffer_size - pc;
-
-	// Create a buffer based on the remaining instruction memory
-	auto inst_buffer = misc::new_unique_array<char>(
-			remaining_inst_buffer_size);
-	ndrange->getInstructionMemory()->Read(pc, remaining_inst_buffer_size, 
-			inst_buffer.get());
-
-	// Decode the next instruction in the instruction memory
-	// Note: We need to pass the whole buffer for a single instruction
-	// because we don't know the size of the next instruction yet
-	instruction->Decode(inst_buffer.get(), pc);
+	// Grab the instruction at PC from the table of decoded instructions,
+	// making sure the program counter is not outside the instruction memory
+	assert(ndrange->getInstructionBufferSize() > pc);
+	instruction = ndrange->getInstruction(pc);
 
 	// Update the statistics
 	emulator->incNumInstructions();
@@ -224,7 +208,7 @@ void Wavefront::Execute()
 
 		// Only one work item executes the instruction
 		work_item = scalar_work_item.get();
-		work_item->Execute(opcode, instruction.get());
+		work_item->Execute(opcode, instruction);
 
 		// Add newlines between each instruction
 		Emulator::isa_debug << "\n\n";
@@ -248,7 +232,7 @@ void Wavefront::Execute()
 
 		// Only one work item executes the instruction
 		work_item = scalar_work_item.get();
-		work_item->Execute(opcode, instruction.get());
+		work_item->Execute(opcode, instruction);
 
 		// Add newlines between each instruction
 		Emulator::isa_debug << "\n\n";
@@ -280,7 +264,7 @@ void Wavefront::Execute()
 
 		// Only one work item executes the instruction
 		work_item = scalar_work_item.get();
-		work_item->Execute(opcode, instruction.get());
+		work_item->Execute(opcode, instruction);
 
 		// Add newlines between each instruction
 		Emulator::isa_debug << "\n\n";
@@ -304,7 +288,7 @@ void Wavefront::Execute()
 
 		// Only one work item executes the instruction
 		work_item = scalar_work_item.get();
-		work_item->Execute(opcode, instruction.get());
+		work_item->Execute(opcode, instruction);
 
 		// Add newlines between each instruction
 		Emulator::isa_debug << "\n\n";
@@ -328,7 +312,7 @@ void Wavefront::Execute()
 
 		// Only one work item executes the instruction
 		work_item = scalar_work_item.get();
-		work_item->Execute(opcode, instruction.get());
+		work_item->Execute(opcode, instruction);
 
 		// Add newlines between each instruction
 		Emulator::isa_debug << "\n\n";
@@ -353,7 +337,7 @@ void Wavefront::Execute()
 
 		// Only one work item executes the instruction
 		work_item = scalar_work_item.get();
-		work_item->Execute(opcode, instruction.get());
+		work_item->Execute(opcode, instruction);
 
 		// Add newlines between each instruction
 		Emulator::isa_debug << "\n\n";
@@ -382,7 +366,7 @@ void Wavefront::Execute()
 		{
 			work_item = (*it).get();
 			if (isWorkItemActive(work_item->getIdInWavefront()))
-				work_item->Execute(opcode, instruction.get());
+				work_item->Execute(opcode, instruction);
 		}
 
 		// Add newlines between each instruction
@@ -416,7 +400,7 @@ void Wavefront::Execute()
 			if (work_item->ReadSReg(Instruction::RegisterExec) == 0 && 
 				work_item->ReadSReg(Instruction::RegisterExec + 1) == 0)
 			{
-				work_item->Execute(opcode, instruction.get());
+				work_item->Execute(opcode, instruction);
 			}
 			else 
 			{
@@ -426,7 +410,7 @@ void Wavefront::Execute()
 					work_item = (*it).get();
 					if (isWorkItemActive(work_item->getIdInWavefront()))
 					{
-						work_item->Execute(opcode, instruction.get());
+						work_item->Execute(opcode, instruction);
 					}
 				}
 			}
@@ -440,7 +424,7 @@ void Wavefront::Execute()
 				work_item = (*it).get();
 				if (isWorkItemActive(work_item->getIdInWavefront()))
 				{
-					work_item->Execute(opcode, instruction.get());
+					work_item->Execute(opcode, instruction);
 				}
 			}
 		}
@@ -472,7 +456,7 @@ void Wavefront::Execute()
 			work_item = (*it).get();
 			if (isWorkItemActive(work_item->getIdInWavefront()))
 			{
-				work_item->Execute(opcode, instruction.get());
+				work_item->Execute(opcode, instruction);
 			}
 		}
 
@@ -503,7 +487,7 @@ void Wavefront::Execute()
 			work_item = (*it).get();
 			if (isWorkItemActive(work_item->getIdInWavefront()))
 			{
-				work_item->Execute(opcode, instruction.get());
+				work_item->Execute(opcode, instruction);
 			}
 		}
 
@@ -534,7 +518,7 @@ void Wavefront::Execute()
 			work_item = (*it).get();
 			if (isWorkItemActive(work_item->getIdInWavefront()))
 			{
-				work_item->Execute(opcode, instruction.get());
+				work_item->Execute(opcode, instruction);
 			}
 		}
 
@@ -565,7 +549,7 @@ void Wavefront::Execute()
 			work_item = (*it).get();
 			if (isWorkItemActive(work_item->getIdInWavefront()))
 			{
-				work_item->Execute(opcode, instruction.get());
+				work_item->Execute(opcode, instruction);
 			}
 		}
 
@@ -614,7 +598,7 @@ void Wavefront::Execute()
 			work_item = (*it).get();
 			if (isWorkItemActive(work_item->getIdInWavefront()))
 			{
-				work_item->Execute(opcode, instruction.get());
+				work_item->Execute(opcode, instruction);
 			}
 		}
 
@@ -660,7 +644,7 @@ void Wavefront::Execute()
 			work_item = (*it).get();
 			if (isWorkItemActive(work_item->getIdInWavefront()))
 			{
-				work_item->Execute(opcode, instruction.get());
+				work_item->Execute(opcode, instruction);
 			}
 		}
 
@@ -712,7 +696,7 @@ void Wavefront::Execute()
 			work_item = (*it).get();
 			if (isWorkItemActive(work_item->getIdInWavefront()))
 			{
-				work_item->Execute(opcode, instruction.get());
+				work_item->Execute(opcode, instruction);
 			}
 		}
 
@@ -746,7 +730,7 @@ void Wavefront::Execute()
 			work_item = (*it).get();
 			if (isWorkItemActive(work_item->getIdInWavefront()))
 			{
-				work_item->Execute(opcode, instruction.get());
+				work_item->Execute(opcode, instruction);
 			}
 		}
 
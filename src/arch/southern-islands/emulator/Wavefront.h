@@ -66,8 +66,9 @@ class Wavefront
 	// instruction to be executed.
 	unsigned pc = 0;
 
-	// Current instruction
-	std::unique_ptr<Instruction> instruction;
+	// Current instruction, owned by the ND-range's table of decoded
+	// instructions
+	Instruction *instruction = nullptr;
 	int inst_size = 0;
 
 	// Associated scalar work-item
@@ -231,7 +232,7 @@ public:
 	unsigned getWorkItemCount() const { return work_item_count; }
 
 	/// Get the associated instruction
-	Instruction *getInstruction() const { return instruction.get(); }
+	Instruction *getInstruction() const { return instruction; }
 
 	/// Return true if work-item is active. The work-item identifier is
 	/// given relative to the first work-item in the wavefront
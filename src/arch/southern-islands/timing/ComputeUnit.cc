@@ -22,6 +22,8 @@
 #include <arch/southern-islands/emulator/NDRange.h>
 #include <arch/southern-islands/emulator/Wavefront.h>
 #include <arch/southern-islands/emulator/WorkGroup.h>
+#include <lib/esim/Profiler.h>
+#include <lib/esim/Statistics.h>
 #include <memory/Module.h>
 
 #include "ComputeUnit.h"
@@ -74,6 +76,27 @@ ComputeUnit::ComputeUnit(int index, Gpu *gpu) :
 		fetch_buffers[i] = misc::new_unique<FetchBuffer>(i, this);
 		simd_units[i] = misc::new_unique<SimdUnit>(this);
 	}
+
+	// Interval statistics
+	std::string prefix = misc::fmt("si.cu%d.", index);
+	esim::StatisticsRegistry::Register(prefix + "instructions",
+			&num_total_instructions);
+	esim::StatisticsRegistry::Register(prefix + "branch_instructions",
+			&num_branch_instructions);
+	esim::StatisticsRegistry::Register(prefix + "scalar_alu_instructions",
+			&num_scalar_alu_instructions);
+	esim::StatisticsRegistry::Register(prefix +
+			"scalar_memory_instructions",
+			&num_scalar_memory_instructions);
+	esim::StatisticsRegistry::Register(prefix + "simd_instructions",
+			&num_simd_instructions);
+	esim::StatisticsRegistry::Register(prefix +
+			"vector_memory_instructions",
+			&num_vector_memory_instructions);
+	esim::StatisticsRegistry::Register(prefix + "lds_instructions",
+			&num_lds_instructions);
+	esim::StatisticsRegistry::Register(prefix + "mapped_work_groups",
+			&num_mapped_work_groups);
 }
 
 
@@ -609,10 +632,21 @@ void ComputeUnit::UnmapWorkGroup(WorkGroup *work_group)
 	// Unmap wavefronts from instruction buffer
 	work_group->wavefront_pool->UnmapWavefronts(work_group);
 	
+	// The rest of the work group state is shared with the GPU and the
+	// NDRange. Delay its release if other compute units are running.
+	assert((int) work_groups.size() <= gpu->getWorkGroupsPerComputeUnit());
+	if (commit_deferred)
+		pending_unmapped_work_groups.push_back(work_group);
+	else
+		ReleaseWorkGroup(work_group);
+}
+
+
+void ComputeUnit::ReleaseWorkGroup(WorkGroup *work_group)
+{
 	// If compute unit is not already in the available list, place
 	// it there. The vector list of work groups does not shrink,
 	// when we unmap a workgroup.
-	assert((int) work_groups.size() <= gpu->getWorkGroupsPerComputeUnit());
 	if (!in_available_compute_units)
 		gpu->InsertInAvailableComputeUnits(this);
 
@@ -656,12 +690,8 @@ void ComputeUnit::UpdateFetchVisualization(FetchBuffer *fetch_buffer)
 }
 
 
-void ComputeUnit::Run()
+void ComputeUnit::RunExecutionUnits()
 {
-	// Return if no work groups are mapped to this compute unit
-	if (!work_groups.size())
-		return;
-	
 	// Save timing simulator
 	timing = Timing::getInstance();
 
@@ -669,24 +699,57 @@ void ComputeUnit::Run()
 	int active_issue_buffer = timing->getCycle() % num_wavefront_pools;
 	assert(active_issue_buffer >= 0 && active_issue_buffer < num_wavefront_pools);
 
+	// Profiler regions
+	static esim::ProfilerRegion *simd_profiler_region =
+			esim::Profiler::getRegion("si.SimdUnit");
+	static esim::ProfilerRegion *vector_memory_profiler_region =
+			esim::Profiler::getRegion("si.VectorMemoryUnit");
+	static esim::ProfilerRegion *lds_profiler_region =
+			esim::Profiler::getRegion("si.LdsUnit");
+	static esim::ProfilerRegion *scalar_profiler_region =
+			esim::Profiler::getRegion("si.ScalarUnit");
+	static esim::ProfilerRegion *branch_profiler_region =
+			esim::Profiler::getRegion("si.BranchUnit");
+	static esim::ProfilerRegion *issue_profiler_region =
+			esim::Profiler::getRegion("si.Issue");
+
 	// SIMDs
-	for (auto &simd_unit : simd_units)
-		simd_unit->Run();
+	{
+		esim::ProfilerScope profiler_scope(simd_profiler_region);
+		for (auto &simd_unit : simd_units)
+			simd_unit->Run();
+	}
 
 	// Vector memory
-	vector_memory_unit.Run();
+	{
+		esim::ProfilerScope profiler_scope(
+				vector_memory_profiler_region);
+		vector_memory_unit.Run();
+	}
 
 	// LDS unit
-	lds_unit.Run();
+	{
+		esim::ProfilerScope profiler_scope(lds_profiler_region);
+		lds_unit.Run();
+	}
 
 	// Scalar unit
-	scalar_unit.Run();
+	{
+		esim::ProfilerScope profiler_scope(scalar_profiler_region);
+		scalar_unit.Run();
+	}
 
 	// Branch unit
-	branch_unit.Run();
+	{
+		esim::ProfilerScope profiler_scope(branch_profiler_region);
+		branch_unit.Run();
+	}
 
 	// Issue from the active issue buffer
-	Issue(fetch_buffers[active_issue_buffer].get());
+	{
+		esim::ProfilerScope profiler_scope(issue_profiler_region);
+		Issue(fetch_buffers[active_issue_buffer].get());
+	}
 
 	// Update visualization in non-active issue buffers
 	for (int i = 0; i < (int) simd_units.size(); i++)
@@ -696,13 +759,120 @@ void ComputeUnit::Run()
 			UpdateFetchVisualization(fetch_buffers[i].get());
 		}
 	}
+}
+
+
+void ComputeUnit::FetchAll()
+{
+	// Host time of the stage
+	static esim::ProfilerRegion *profiler_region =
+			esim::Profiler::getRegion("si.Fetch");
+	esim::ProfilerScope profiler_scope(profiler_region);
 
-	// Fetch
 	for (int i = 0; i < num_wavefront_pools; i++)
 		Fetch(fetch_buffers[i].get(), wavefront_pools[i].get());
 }
 
 
+void ComputeUnit::Run()
+{
+	// Return if no work groups are mapped to this compute unit
+	if (!work_groups.size())
+		return;
+
+	// Execution units and issue
+	RunExecutionUnits();
+
+	// Record last completion in the GPU
+	if (last_complete_cycle > gpu->last_complete_cycle)
+		gpu->last_complete_cycle = last_complete_cycle;
+
+	// Fetch
+	FetchAll();
+}
+
+
+void ComputeUnit::RunStages()
+{
+	assert(pending_accesses.empty());
+	assert(pending_unmapped_work_groups.empty());
+	commit_deferred = true;
+	RunExecutionUnits();
+	commit_deferred = false;
+}
+
+
+void ComputeUnit::Commit()
+{
+	// Submit memory accesses in the order they were requested
+	for (auto &pending_access : pending_accesses)
+	{
+		if (pending_access.module)
+			Access(pending_access.module,
+					pending_access.access_type,
+					pending_access.space,
+					pending_access.address,
+					pending_access.witness);
+		else
+			Translate(pending_access.space,
+					pending_access.address);
+	}
+	pending_accesses.clear();
+
+	// Release unmapped work groups
+	for (WorkGroup *work_group : pending_unmapped_work_groups)
+		ReleaseWorkGroup(work_group);
+	pending_unmapped_work_groups.clear();
+
+	// Record last completion in the GPU
+	if (last_complete_cycle > gpu->last_complete_cycle)
+		gpu->last_complete_cycle = last_complete_cycle;
+
+	// Fetch
+	FetchAll();
+}
+
+
+void ComputeUnit::Access(mem::Module *module,
+		mem::Module::AccessType access_type,
+		mem::Mmu::Space *space,
+		unsigned address,
+		int *witness)
+{
+	// Record access if running concurrently with other compute units
+	if (commit_deferred)
+	{
+		pending_accesses.push_back({module, access_type, space,
+				address, witness});
+		return;
+	}
+
+	// Translate virtual address to a physical address
+	if (space)
+		address = gpu->getMmu()->TranslateVirtualAddress(space,
+				address);
+
+	// Submit the access
+	module->Access(access_type, address, witness);
+}
+
+
+void ComputeUnit::Translate(mem::Mmu::Space *space, unsigned address)
+{
+	// Record translation if running concurrently with other compute units
+	if (commit_deferred)
+	{
+		pending_accesses.push_back({nullptr,
+				mem::Module::AccessInvalid, space,
+				address, nullptr});
+		return;
+	}
+
+	// Translate
+	gpu->getMmu()->TranslateVirtualAddress(space, address);
+}
+
+
 void ComputeUnit::Dump(std::ostream &os) const
 {
 	// Title
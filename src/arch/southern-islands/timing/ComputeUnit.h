@@ -22,6 +22,7 @@
 
 #include <list>
 
+#include <memory/Mmu.h>
 #include <memory/Module.h>
 
 #include "BranchUnit.h"
@@ -101,6 +102,47 @@ class ComputeUnit
 	// Counter of identifiers assigned to uops in this compute unit
 	long long uop_id_counter = 0;
 
+	// Memory access or address translation requested by an execution
+	// unit while the compute unit runs concurrently with others.
+	struct PendingAccess
+	{
+		// Module to access, or nullptr for a translation only
+		mem::Module *module;
+
+		// Access type
+		mem::Module::AccessType access_type;
+
+		// Address space used to translate the address, or nullptr if
+		// the address is not translated
+		mem::Mmu::Space *space;
+
+		// Accessed address
+		unsigned address;
+
+		// Witness pointer passed to the module
+		int *witness;
+	};
+
+	// True while RunStages() is running. Updates to state shared with
+	// other compute units are recorded and applied in Commit().
+	bool commit_deferred = false;
+
+	// Accesses recorded by RunStages(), in program order
+	std::vector<PendingAccess> pending_accesses;
+
+	// Work groups unmapped during RunStages(), in program order
+	std::vector<WorkGroup *> pending_unmapped_work_groups;
+
+	// Advance the execution units and the issue stage by one cycle
+	void RunExecutionUnits();
+
+	// Run the fetch stage on all wavefront pools
+	void FetchAll();
+
+	// Release a work group after it has been unmapped from the compute
+	// unit, updating state shared with the rest of the GPU.
+	void ReleaseWorkGroup(WorkGroup *work_group);
+
 public:
 
 	//
@@ -164,6 +206,35 @@ public:
 	/// Advance compute unit state by one cycle
 	void Run();
 
+	/// Advance the execution units and the issue stage by one cycle,
+	/// without modifying any state shared with other compute units.
+	/// Memory accesses and work group releases are recorded instead, and
+	/// applied in the following call to Commit(). This function can run
+	/// concurrently for different compute units.
+	void RunStages();
+
+	/// Apply the effects recorded by RunStages() and run the fetch
+	/// stage. Calling RunStages() and Commit() for all busy compute units
+	/// in index order produces exactly the same result as calling Run().
+	void Commit();
+
+	/// Return whether the compute unit has work groups mapped. Only busy
+	/// compute units are advanced in each cycle.
+	bool isBusy() const { return work_groups.size() > 0; }
+
+	/// Submit an access to \a module on behalf of an execution unit. If
+	/// \a space is other than nullptr, \a address is a virtual address
+	/// translated by the GPU MMU before submitting the access.
+	void Access(mem::Module *module,
+			mem::Module::AccessType access_type,
+			mem::Mmu::Space *space,
+			unsigned address,
+			int *witness);
+
+	/// Translate a virtual address without accessing memory, allocating
+	/// the MMU page if this is the first time the address is used.
+	void Translate(mem::Mmu::Space *space, unsigned address);
+
 	/// Return the index of this compute unit in the GPU
 	int getIndex() const { return index; }
 
@@ -224,6 +295,9 @@ public:
 	/// Flag to indicate if the compute unit is currently available or not
 	bool in_available_compute_units = false;
 
+	/// Last cycle when a uop completed execution in this compute unit
+	long long last_complete_cycle = 0;
+
 
 
 
@@ -35,6 +35,7 @@ int Gpu::num_vector_registers = 65536;
 int Gpu::lds_allocation_size = 64; 
 int Gpu::lds_size = 65536;
 long long Gpu::max_cycles = 0;
+int Gpu::num_threads = 1;
 
 // String map of the argument's access type                                      
 const misc::StringMap Gpu::register_allocation_granularity_map =                                
@@ -59,6 +60,10 @@ Gpu::Gpu()
 		ComputeUnit *compute_unit = compute_units.back().get();
 		InsertInAvailableComputeUnits(compute_unit);
 	}
+
+	// Create worker threads
+	if (num_threads > 1)
+		worker_pool = misc::new_unique<misc::WorkerPool>(num_threads);
 }
 
 
@@ -213,9 +218,32 @@ void Gpu::CalcGetWorkGroupsPerWavefrontPool(int work_items_per_work_group,
 
 void Gpu::Run()
 {
-	// Advance one cycle in each compute unit
+	// Advance one cycle in each compute unit sequentially. Traces and
+	// debug output are emitted in pipeline order, so they also force
+	// sequential simulation.
+	if (!worker_pool || Timing::trace || Timing::pipeline_debug)
+	{
+		for (auto &compute_unit : compute_units)
+			compute_unit->Run();
+		return;
+	}
+
+	// Collect busy compute units
+	busy_compute_units.clear();
 	for (auto &compute_unit : compute_units)
-		compute_unit->Run();
+		if (compute_unit->isBusy())
+			busy_compute_units.push_back(compute_unit.get());
+
+	// Advance the pipeline stages of all busy compute units in parallel
+	worker_pool->Run(busy_compute_units.size(), [this](int index)
+	{
+		busy_compute_units[index]->RunStages();
+	});
+
+	// Commit the memory accesses and run the fetch stage in compute unit
+	// order, exactly as the sequential simulation would do
+	for (ComputeUnit *compute_unit : busy_compute_units)
+		compute_unit->Commit();
 }
 
 }
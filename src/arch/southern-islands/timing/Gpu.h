@@ -23,6 +23,7 @@
 #include <vector>
 
 #include <lib/cpp/Misc.h>
+#include <lib/cpp/WorkerPool.h>
 #include <memory/Mmu.h>
 
 #include "ComputeUnit.h"
@@ -76,6 +77,14 @@ private:
 	/// Mapped NDRange to the GPU
 	NDRange *mapped_ndrange = nullptr;
 
+	// Pool of threads advancing compute units in parallel, or nullptr
+	// if compute units are simulated sequentially
+	std::unique_ptr<misc::WorkerPool> worker_pool;
+
+	// Compute units with work groups mapped at the beginning of the
+	// current cycle, used in parallel simulation
+	std::vector<ComputeUnit *> busy_compute_units;
+
 public:
 
 	//
@@ -88,6 +97,10 @@ public:
 
 	// Number of compute units
 	static int num_compute_units;
+
+	// Number of threads used to simulate compute units, set with option
+	// '--si-threads'
+	static int num_threads;
 	
 
 
@@ -117,7 +117,7 @@ void LdsUnit::Complete()
 
 		// Statistics
 		num_instructions++;
-		compute_unit->getGpu()->last_complete_cycle = compute_unit->
+		compute_unit->last_complete_cycle = compute_unit->
 				getTiming()->getCycle();
 	}
 }
@@ -323,8 +323,10 @@ void LdsUnit::Mem()
 				}
 
 				// Start access
-				compute_unit->getLdsModule()->Access(
+				compute_unit->Access(
+						compute_unit->getLdsModule(),
 						access_type,
+						nullptr,
 						work_item_info->lds_access[i].addr,
 						&uop->lds_witness);
 				uop->lds_witness--;
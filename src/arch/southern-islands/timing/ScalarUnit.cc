@@ -103,7 +103,6 @@ void ScalarUnit::Complete()
 {
 	// Get useful objects
 	ComputeUnit *compute_unit = getComputeUnit();
-	Gpu *gpu = compute_unit->getGpu();
 
 	// Initialize iterator
 	auto it = write_buffer.begin();
@@ -256,7 +255,7 @@ void ScalarUnit::Complete()
 
 		// Statistics
 		num_instructions++;
-		gpu->last_complete_cycle = compute_unit->getTiming()->getCycle();
+		compute_unit->last_complete_cycle = compute_unit->getTiming()->getCycle();
 	}
 }
 
@@ -515,18 +514,13 @@ void ScalarUnit::Execute()
 			uop->global_memory_access_address = uop->getWavefront()->
 					getScalarWorkItem()->global_memory_access_address;
 
-			// Translate virtual address to physical address
-			unsigned phys_addr = compute_unit->getGpu()->
-					getMmu()->TranslateVirtualAddress(
-							uop->getWorkGroup()->
-							getNDRange()->
-							address_space,
-						uop->global_memory_access_address);
-
-			// Submit the access
-			compute_unit->scalar_cache->Access(
+			// Submit the access, translating the virtual address
+			compute_unit->Access(compute_unit->scalar_cache,
 					mem::Module::AccessType::AccessLoad,
-					phys_addr, &uop->global_memory_witness);
+					uop->getWorkGroup()->getNDRange()->
+					address_space,
+					uop->global_memory_access_address,
+					&uop->global_memory_witness);
 
 			// Trace
 			Timing::trace << misc::fmt("si.inst "
@@ -663,6 +663,17 @@ void Timing::RegisterOptions()
 			"to run.  If this maximum is reached, the simulation "
 			"will finish with the SIMaxCycles string.");
 
+	// Option --si-threads <num>
+	command_line->RegisterInt32("--si-threads <num> (default = 1)",
+			Gpu::num_threads,
+			"Number of host threads used to simulate the compute "
+			"units of the GPU in a detailed simulation. Pipeline "
+			"stages of all busy compute units advance in parallel, "
+			"while memory accesses are issued afterwards in compute "
+			"unit order, so results are identical for any number "
+			"of threads. Simulation falls back to one thread when "
+			"options '--trace' or '--si-debug' are used.");
+
 	// Option --si-help
 	command_line->RegisterBool("--si-help", help,
 			"Display a help message describing the format of the "
@@ -682,6 +693,10 @@ void Timing::ProcessOptions()
 	if (!config_file.empty())
 		ini_file.Load(config_file);
 		
+	// Number of threads
+	if (Gpu::num_threads < 1)
+		throw Error("Option '--si-threads' must be greater than 0");
+
 	// Instantiate timing simulator if '--si-sim detailed' is present
 	if (sim_kind == comm::Arch::SimDetailed)
 	{
@@ -82,9 +82,8 @@ void VectorMemoryUnit::Issue(std::unique_ptr<Uop> uop)
 
 void VectorMemoryUnit::Complete()
 {
-	// Get compute unit and GPU objects
+	// Get compute unit object
 	ComputeUnit *compute_unit = getComputeUnit();
-	Gpu *gpu = compute_unit->getGpu();
 
 	// Sanity check the write buffer
 	assert((int) write_buffer.size() <= width);
@@ -121,7 +120,7 @@ void VectorMemoryUnit::Complete()
 
 		// Statistics
 		num_instructions++;
-		gpu->last_complete_cycle = compute_unit->getTiming()->getCycle();
+		compute_unit->last_complete_cycle = compute_unit->getTiming()->getCycle();
 	}
 }
 
@@ -337,29 +336,29 @@ void VectorMemoryUnit::Memory()
 				if (work_item_info->accessed_cache)	
 					continue;
 
-				// Translate virtual address to a physical 
-				// address
-				unsigned physical_address = compute_unit->
-						getGpu()->
-						getMmu()->
-						TranslateVirtualAddress(
-						uop->getWorkGroup()->
+				// Get the address space of the work item
+				mem::Mmu::Space *address_space = uop->
+						getWorkGroup()->
 						getNDRange()->
-						address_space,
-						work_item_info->
-						global_memory_access_address);
-		
+						address_space;
 
 				// Make sure we can access the vector cache. If 
 				// so, submit the access. If we can access the
 				// cache, mark the accessed flag of the work 
-				// item info struct.
+				// item info struct. The cache only checks for
+				// free ports and MSHR entries, so the virtual
+				// address can be passed here.
 				if (compute_unit->vector_cache->
-						canAccess(physical_address))
+						canAccess(work_item_info->
+						global_memory_access_address))
 				{
-					compute_unit->vector_cache->Access(
+					compute_unit->Access(
+							compute_unit->
+							vector_cache,
 							module_access_type,
-							physical_address, 
+							address_space,
+							work_item_info->
+							global_memory_access_address,
 							&uop->global_memory_witness);
 					work_item_info->accessed_cache = true;
 
@@ -368,6 +367,13 @@ void VectorMemoryUnit::Memory()
 				}
 				else
 				{
+					// Translate the address anyway, so
+					// that MMU pages are allocated in
+					// the same order as accesses are
+					// attempted.
+					compute_unit->Translate(address_space,
+							work_item_info->
+							global_memory_access_address);
 					all_work_items_accessed = false;
 				}
 			}
@@ -36,6 +36,43 @@ namespace x86
 #define assert __COMPILATION_ERROR__
 
 
+// Compute the result of a double precision shift of 'dst' by 'count' bits to
+// the left or to the right, filling in the vacated bits from 'src', as done
+// by instructions 'shld' and 'shrd' on operands of 'size' bytes. Flags are
+// left unchanged when the count masked to 5 bits is 0. Flag AF, undefined,
+// is left unchanged, and flag OF, undefined for counts greater than 1, is
+// computed as for a count of 1. The result and flag CF for counts greater
+// than the operand size, also undefined, follow a 32-bit shift.
+static unsigned shift_double(Regs &regs, unsigned dst, unsigned src,
+		unsigned char count, int size, bool left)
+{
+	int width = size * 8;
+	count &= 0x1f;
+	if (!count)
+		return dst;
+	unsigned long long mask = (1ull << width) - 1;
+	unsigned long long wide;
+	unsigned result;
+	bool cf;
+	if (left)
+	{
+		wide = (unsigned long long) (dst & mask) << width | (src & mask);
+		result = (wide << count >> width) & mask;
+		cf = (wide >> (2 * width - count)) & 1;
+	}
+	else
+	{
+		wide = (unsigned long long) (src & mask) << width | (dst & mask);
+		result = (wide >> count) & mask;
+		cf = (wide >> (count - 1)) & 1;
+	}
+	regs.setFlag(Instruction::FlagCF, cf);
+	regs.setFlag(Instruction::FlagOF, ((result ^ dst) >> (width - 1)) & 1);
+	regs.setZpsFlags(result, size);
+	return result;
+}
+
+
 void Context::ExecuteInst_bound_r16_rm32()
 {
 	throw misc::Panic("Unimplemented instruction");
@@ -52,25 +89,13 @@ void Context::ExecuteInst_bsf_r32_rm32()
 {
 	unsigned int r32 = LoadR32();
 	unsigned int rm32 = LoadRm32();
-	unsigned long flags = regs.getEflags();
 
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %4\n\t"
-		"popf\n\t"
-		"mov %2, %%eax\n\t"
-		"bsf %3, %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=g" (r32)
-		: "g" (r32), "g" (rm32), "g" (flags)
-		: "eax"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
+	// The destination is left unchanged if the source is 0
+	if (rm32)
+		r32 = __builtin_ctz(rm32);
+	regs.setFlag(Instruction::FlagZF, !rm32);
 
 	StoreR32(r32);
-	regs.setEflags(flags);
 
 	newUinst(Uinst::OpcodeShift,
 			Uinst::DepRm32,
@@ -84,27 +109,12 @@ void Context::ExecuteInst_bsf_r32_rm32()
 
 void Context::ExecuteInst_tzcnt_r32_rm32()
 {
-	unsigned int r32 = LoadR32();
 	unsigned int rm32 = LoadRm32();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %4\n\t"
-		"popf\n\t"
-		"mov %2, %%eax\n\t"
-		"tzcnt %3, %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=g" (r32)
-		: "g" (r32), "g" (rm32), "g" (flags)
-		: "eax"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
+	unsigned int r32 = rm32 ? __builtin_ctz(rm32) : 32;
+	regs.setFlag(Instruction::FlagCF, !rm32);
+	regs.setFlag(Instruction::FlagZF, !r32);
 
 	StoreR32(r32);
-	regs.setEflags(flags);
 
 	newUinst(Uinst::OpcodeShift,
 			Uinst::DepRm32,
@@ -121,25 +131,13 @@ void Context::ExecuteInst_bsr_r32_rm32()
 {
 	unsigned int r32 = LoadR32();
 	unsigned int rm32 = LoadRm32();
-	unsigned long flags = regs.getEflags();
 
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %4\n\t"
-		"popf\n\t"
-		"mov %2, %%eax\n\t"
-		"bsr %3, %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=m" (r32)
-		: "m" (r32), "m" (rm32), "g" (flags)
-		: "eax"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
+	// The destination is left unchanged if the source is 0
+	if (rm32)
+		r32 = 31 - __builtin_clz(rm32);
+	regs.setFlag(Instruction::FlagZF, !rm32);
 
 	StoreR32(r32);
-	regs.setEflags(flags);
 
 	newUinst(Uinst::OpcodeShift,
 			Uinst::DepRm32,
@@ -155,19 +153,7 @@ void Context::ExecuteInst_bsr_r32_rm32()
 void Context::ExecuteInst_bswap_ir32()
 {
 	unsigned int ir32 = LoadIR32();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"mov %1, %%eax\n\t"
-		"bswap %%eax\n\t"
-		"mov %%eax, %0\n\t"
-		: "=g" (ir32)
-		: "g" (ir32)
-		: "eax"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	StoreIR32(ir32);
+	StoreIR32(__builtin_bswap32(ir32));
 
 	newUinst(Uinst::OpcodeShift,
 			Uinst::DepIr32,
@@ -184,24 +170,7 @@ void Context::ExecuteInst_bt_rm32_r32()
 {
 	unsigned int rm32 = LoadRm32();
 	unsigned int r32 = LoadR32();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %3\n\t"
-		"popf\n\t"
-		"mov %2, %%ecx\n\t"
-		"mov %1, %%eax\n\t"
-		"bt %%ecx, %%eax\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags)
-		: "m" (rm32), "m" (r32), "g" (flags)
-		: "eax", "ecx"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	regs.setEflags(flags);
+	regs.setFlag(Instruction::FlagCF, (rm32 >> (r32 & 0x1f)) & 1);
 
 	newUinst(Uinst::OpcodeShift,
 			Uinst::DepRm32,
@@ -218,24 +187,7 @@ void Context::ExecuteInst_bt_rm32_imm8()
 {
 	unsigned int rm32 = LoadRm32();
 	unsigned int imm8 = inst.getImmByte();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %3\n\t"
-		"popf\n\t"
-		"mov %2, %%ecx\n\t"
-		"mov %1, %%eax\n\t"
-		"bt %%ecx, %%eax\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags)
-		: "m" (rm32), "m" (imm8), "g" (flags)
-		: "eax", "ecx"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	regs.setEflags(flags);
+	regs.setFlag(Instruction::FlagCF, (rm32 >> (imm8 & 0x1f)) & 1);
 
 	newUinst(Uinst::OpcodeShift,
 			Uinst::DepRm32,
@@ -252,26 +204,10 @@ void Context::ExecuteInst_bts_rm32_imm8()
 {
 	unsigned int rm32 = LoadRm32();
 	unsigned int imm8 = inst.getImmByte();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %4\n\t"
-		"popf\n\t"
-		"mov %3, %%ecx\n\t"
-		"mov %2, %%eax\n\t"
-		"btsl %%ecx, %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=m" (rm32)
-		: "m" (rm32), "m" (imm8), "g" (flags)
-		: "eax", "ecx"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
+	regs.setFlag(Instruction::FlagCF, (rm32 >> (imm8 & 0x1f)) & 1);
+	rm32 |= 1u << (imm8 & 0x1f);
 
 	StoreRm32(rm32);
-	regs.setEflags(flags);
 
 	newUinst(Uinst::OpcodeShift,
 			Uinst::DepRm32,
@@ -437,29 +373,17 @@ void Context::ExecuteInst_cld()
 void Context::ExecuteInst_cmpxchg_rm32_r32()
 {
 	unsigned int eax = regs.getEax();
-	unsigned long flags = regs.getEflags();
 	unsigned int rm32 = LoadRm32();
 	unsigned int r32 = LoadR32();
 
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %3\n\t"
-		"popf\n\t"
-		"mov %4, %%eax\n\t"
-		"mov %5, %%ebx\n\t"
-		"mov %6, %%ecx\n\t"
-		"cmpxchg %%ecx, %%ebx\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		"mov %%eax, %1\n\t"
-		"mov %%ebx, %2\n\t"
-		: "=g" (flags), "=m" (eax), "=m" (rm32)
-		: "g" (flags), "m" (eax), "m" (rm32), "m" (r32)
-		: "eax", "ebx", "ecx"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
+	// Compare 'eax' with the destination, replacing the destination if
+	// equal, or loading it into 'eax' otherwise
+	regs.setLazyFlags(Regs::LazyFlagsSub, 4, eax, rm32, eax - rm32);
+	if (eax == rm32)
+		rm32 = r32;
+	else
+		eax = rm32;
 
-	regs.setEflags(flags);
 	regs.Write(Instruction::RegEax, eax);
 	StoreRm32(rm32);
 
@@ -717,25 +641,10 @@ void Context::ExecuteInst_cwde()
 void Context::ExecuteInst_dec_rm8()
 {
 	unsigned char rm8 = LoadRm8();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %3\n\t"
-		"popf\n\t"
-		"mov %2, %%al\n\t"
-		"dec %%al\n\t"
-		"mov %%al, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=g" (rm8)
-		: "g" (rm8), "g" (flags)
-		: "al"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	StoreRm8(rm8);
-	regs.setEflags(flags);
+	unsigned char result = rm8 - 1;
+	regs.setLazyFlags(Regs::LazyFlagsDec, 1, rm8, 1, result,
+			regs.getFlag(Instruction::FlagCF));
+	StoreRm8(result);
 
 	newUinst(Uinst::OpcodeSub,
 			Uinst::DepRm8,
@@ -751,25 +660,10 @@ void Context::ExecuteInst_dec_rm8()
 void Context::ExecuteInst_dec_rm16()
 {
 	unsigned short rm16 = LoadRm16();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %3\n\t"
-		"popf\n\t"
-		"mov %2, %%ax\n\t"
-		"dec %%ax\n\t"
-		"mov %%ax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=g" (rm16)
-		: "g" (rm16), "g" (flags)
-		: "ax"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	StoreRm16(rm16);
-	regs.setEflags(flags);
+	unsigned short result = rm16 - 1;
+	regs.setLazyFlags(Regs::LazyFlagsDec, 2, rm16, 1, result,
+			regs.getFlag(Instruction::FlagCF));
+	StoreRm16(result);
 
 	newUinst(Uinst::OpcodeSub,
 			Uinst::DepRm16,
@@ -785,25 +679,10 @@ void Context::ExecuteInst_dec_rm16()
 void Context::ExecuteInst_dec_rm32()
 {
 	unsigned int rm32 = LoadRm32();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %3\n\t"
-		"popf\n\t"
-		"mov %2, %%eax\n\t"
-		"dec %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=g" (rm32)
-		: "g" (rm32), "g" (flags)
-		: "eax"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	StoreRm32(rm32);
-	regs.setEflags(flags);
+	unsigned int result = rm32 - 1;
+	regs.setLazyFlags(Regs::LazyFlagsDec, 4, rm32, 1, result,
+			regs.getFlag(Instruction::FlagCF));
+	StoreRm32(result);
 
 	newUinst(Uinst::OpcodeSub,
 			Uinst::DepRm32,
@@ -819,25 +698,10 @@ void Context::ExecuteInst_dec_rm32()
 void Context::ExecuteInst_dec_ir16()
 {
 	unsigned short ir16 = LoadIR16();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %3\n\t"
-		"popf\n\t"
-		"mov %2, %%ax\n\t"
-		"dec %%ax\n\t"
-		"mov %%ax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=g" (ir16)
-		: "g" (ir16), "g" (flags)
-		: "eax"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	StoreIR16(ir16);
-	regs.setEflags(flags);
+	unsigned short result = ir16 - 1;
+	regs.setLazyFlags(Regs::LazyFlagsDec, 2, ir16, 1, result,
+			regs.getFlag(Instruction::FlagCF));
+	StoreIR16(result);
 
 	newUinst(Uinst::OpcodeSub,
 			Uinst::DepIr16,
@@ -853,25 +717,10 @@ void Context::ExecuteInst_dec_ir16()
 void Context::ExecuteInst_dec_ir32()
 {
 	unsigned int ir32 = LoadIR32();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %3\n\t"
-		"popf\n\t"
-		"mov %2, %%eax\n\t"
-		"dec %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=g" (ir32)
-		: "g" (ir32), "g" (flags)
-		: "eax"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	StoreIR32(ir32);
-	regs.setEflags(flags);
+	unsigned int result = ir32 - 1;
+	regs.setLazyFlags(Regs::LazyFlagsDec, 4, ir32, 1, result,
+			regs.getFlag(Instruction::FlagCF));
+	StoreIR32(result);
 
 	newUinst(Uinst::OpcodeSub,
 			Uinst::DepIr32,
@@ -1040,31 +889,15 @@ void Context::ExecuteInst_idiv_rm32()
 
 void Context::ExecuteInst_imul_rm32()
 {
-	unsigned int eax = regs.Read(Instruction::RegEax);
-	unsigned int rm32 = LoadRm32();
-	unsigned long flags = regs.getEflags();
-	unsigned int edx;
+	int eax = regs.Read(Instruction::RegEax);
+	int rm32 = LoadRm32();
+	long long product = (long long) eax * rm32;
+	bool overflow = product != (int) product;
+	regs.setFlag(Instruction::FlagCF, overflow);
+	regs.setFlag(Instruction::FlagOF, overflow);
 
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %5\n\t"
-		"popf\n\t"
-		"mov %3, %%eax\n\t"
-		"mov %4, %%edx\n\t"
-		"imul %%edx\n\t"
-		"mov %%edx, %1\n\t"
-		"mov %%eax, %2\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=m" (edx), "=m" (eax)
-		: "m" (eax), "m" (rm32), "g" (flags)
-		: "eax", "edx"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	regs.Write(Instruction::RegEax, eax);
-	regs.Write(Instruction::RegEdx, edx);
-	regs.setEflags(flags);
+	regs.Write(Instruction::RegEax, product);
+	regs.Write(Instruction::RegEdx, product >> 32);
 
 	newUinst(Uinst::OpcodeMult,
 			Uinst::DepRm32,
@@ -1081,26 +914,12 @@ void Context::ExecuteInst_imul_r16_rm16()
 {
 	unsigned int r16 = LoadR16();
 	unsigned int rm16 = LoadRm16();
-	unsigned long flags = regs.getEflags();
+	int product = (int) (short) r16 * (short) rm16;
+	bool overflow = product != (short) product;
+	regs.setFlag(Instruction::FlagCF, overflow);
+	regs.setFlag(Instruction::FlagOF, overflow);
 
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %4\n\t"
-		"popf\n\t"
-		"mov %2, %%ax\n\t"
-		"mov %3, %%bx\n\t"
-		"imul %%bx, %%ax\n\t"
-		"mov %%ax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=m" (r16)
-		: "m" (r16), "m" (rm16), "g" (flags)
-		: "ax", "bx"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	StoreR16(r16);
-	regs.setEflags(flags);
+	StoreR16(product);
 
 	newUinst(Uinst::OpcodeMult,
 			Uinst::DepR16,
@@ -1117,26 +936,12 @@ void Context::ExecuteInst_imul_r32_rm32()
 {
 	unsigned int r32 = LoadR32();
 	unsigned int rm32 = LoadRm32();
-	unsigned long flags = regs.getEflags();
+	long long product = (long long) (int) r32 * (int) rm32;
+	bool overflow = product != (int) product;
+	regs.setFlag(Instruction::FlagCF, overflow);
+	regs.setFlag(Instruction::FlagOF, overflow);
 
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %4\n\t"
-		"popf\n\t"
-		"mov %2, %%eax\n\t"
-		"mov %3, %%ebx\n\t"
-		"imul %%ebx, %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=m" (r32)
-		: "m" (r32), "m" (rm32), "g" (flags)
-		: "eax", "ebx"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	StoreR32(r32);
-	regs.setEflags(flags);
+	StoreR32(product);
 
 	newUinst(Uinst::OpcodeMult,
 			Uinst::DepR32,
@@ -1151,29 +956,14 @@ void Context::ExecuteInst_imul_r32_rm32()
 
 void Context::ExecuteInst_imul_r32_rm32_imm8()
 {
-	unsigned int r32;
 	unsigned int rm32 = LoadRm32();
 	unsigned int imm8 = (char) inst.getImmByte();
-	unsigned long flags = regs.getEflags();
+	long long product = (long long) (int) rm32 * (int) imm8;
+	bool overflow = product != (int) product;
+	regs.setFlag(Instruction::FlagCF, overflow);
+	regs.setFlag(Instruction::FlagOF, overflow);
 
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %4\n\t"
-		"popf\n\t"
-		"mov %2, %%eax\n\t"
-		"mov %3, %%ebx\n\t"
-		"imul %%ebx, %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=m" (r32)
-		: "m" (rm32), "m" (imm8), "g" (flags)
-		: "eax", "ebx"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	StoreR32(r32);
-	regs.setEflags(flags);
+	StoreR32(product);
 
 	newUinst(Uinst::OpcodeMult,
 			Uinst::DepRm32,
@@ -1188,29 +978,14 @@ void Context::ExecuteInst_imul_r32_rm32_imm8()
 
 void Context::ExecuteInst_imul_r32_rm32_imm32()
 {
-	unsigned int r32;
 	unsigned int rm32 = LoadRm32();
 	unsigned int imm32 = inst.getImmDWord();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %4\n\t"
-		"popf\n\t"
-		"mov %2, %%eax\n\t"
-		"mov %3, %%ebx\n\t"
-		"imul %%ebx, %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=m" (r32)
-		: "m" (rm32), "m" (imm32), "g" (flags)
-		: "eax", "ebx"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
+	long long product = (long long) (int) rm32 * (int) imm32;
+	bool overflow = product != (int) product;
+	regs.setFlag(Instruction::FlagCF, overflow);
+	regs.setFlag(Instruction::FlagOF, overflow);
 
-	StoreR32(r32);
-	regs.setEflags(flags);
+	StoreR32(product);
 
 	newUinst(Uinst::OpcodeMult,
 			Uinst::DepRm32,
@@ -1226,25 +1001,10 @@ void Context::ExecuteInst_imul_r32_rm32_imm32()
 void Context::ExecuteInst_inc_rm8()
 {
 	unsigned char rm8 = LoadRm8();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %3\n\t"
-		"popf\n\t"
-		"mov %2, %%al\n\t"
-		"inc %%al\n\t"
-		"mov %%al, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=g" (rm8)
-		: "g" (rm8), "g" (flags)
-		: "al"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	StoreRm8(rm8);
-	regs.setEflags(flags);
+	unsigned char result = rm8 + 1;
+	regs.setLazyFlags(Regs::LazyFlagsInc, 1, rm8, 1, result,
+			regs.getFlag(Instruction::FlagCF));
+	StoreRm8(result);
 
 	newUinst(Uinst::OpcodeAdd,
 			Uinst::DepRm8,
@@ -1260,25 +1020,10 @@ void Context::ExecuteInst_inc_rm8()
 void Context::ExecuteInst_inc_rm16()
 {
 	unsigned short rm16 = LoadRm16();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %3\n\t"
-		"popf\n\t"
-		"mov %2, %%ax\n\t"
-		"inc %%ax\n\t"
-		"mov %%ax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=g" (rm16)
-		: "g" (rm16), "g" (flags)
-		: "ax"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	StoreRm16(rm16);
-	regs.setEflags(flags);
+	unsigned short result = rm16 + 1;
+	regs.setLazyFlags(Regs::LazyFlagsInc, 2, rm16, 1, result,
+			regs.getFlag(Instruction::FlagCF));
+	StoreRm16(result);
 
 	newUinst(Uinst::OpcodeAdd,
 			Uinst::DepRm16,
@@ -1294,25 +1039,10 @@ void Context::ExecuteInst_inc_rm16()
 void Context::ExecuteInst_inc_rm32()
 {
 	unsigned int rm32 = LoadRm32();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %3\n\t"
-		"popf\n\t"
-		"mov %2, %%eax\n\t"
-		"inc %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=g" (rm32)
-		: "g" (rm32), "g" (flags)
-		: "eax"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	StoreRm32(rm32);
-	regs.setEflags(flags);
+	unsigned int result = rm32 + 1;
+	regs.setLazyFlags(Regs::LazyFlagsInc, 4, rm32, 1, result,
+			regs.getFlag(Instruction::FlagCF));
+	StoreRm32(result);
 
 	newUinst(Uinst::OpcodeAdd,
 			Uinst::DepRm32,
@@ -1328,25 +1058,10 @@ void Context::ExecuteInst_inc_rm32()
 void Context::ExecuteInst_inc_ir16()
 {
 	unsigned short ir16 = LoadIR16();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %3\n\t"
-		"popf\n\t"
-		"mov %2, %%ax\n\t"
-		"inc %%ax\n\t"
-		"mov %%ax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=g" (ir16)
-		: "g" (ir16), "g" (flags)
-		: "ax"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	StoreIR16(ir16);
-	regs.setEflags(flags);
+	unsigned short result = ir16 + 1;
+	regs.setLazyFlags(Regs::LazyFlagsInc, 2, ir16, 1, result,
+			regs.getFlag(Instruction::FlagCF));
+	StoreIR16(result);
 
 	newUinst(Uinst::OpcodeAdd,
 			Uinst::DepIr16,
@@ -1362,25 +1077,10 @@ void Context::ExecuteInst_inc_ir16()
 void Context::ExecuteInst_inc_ir32()
 {
 	unsigned int ir32 = LoadIR32();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %3\n\t"
-		"popf\n\t"
-		"mov %2, %%eax\n\t"
-		"inc %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=g" (ir32)
-		: "g" (ir32), "g" (flags)
-		: "eax"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	StoreIR32(ir32);
-	regs.setEflags(flags);
+	unsigned int result = ir32 + 1;
+	regs.setLazyFlags(Regs::LazyFlagsInc, 4, ir32, 1, result,
+			regs.getFlag(Instruction::FlagCF));
+	StoreIR32(result);
 
 	newUinst(Uinst::OpcodeAdd,
 			Uinst::DepIr32,
@@ -2062,29 +1762,13 @@ void Context::ExecuteInst_mul_rm32()
 {
 	unsigned int eax = regs.Read(Instruction::RegEax);
 	unsigned int rm32 = LoadRm32();
-	unsigned long flags = regs.getEflags();
-	unsigned int edx;
+	unsigned long long product = (unsigned long long) eax * rm32;
+	bool overflow = product >> 32;
+	regs.setFlag(Instruction::FlagCF, overflow);
+	regs.setFlag(Instruction::FlagOF, overflow);
 
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %5\n\t"
-		"popf\n\t"
-		"mov %3, %%eax\n\t"
-		"mov %4, %%edx\n\t"
-		"mul %%edx\n\t"
-		"mov %%edx, %1\n\t"
-		"mov %%eax, %2\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=m" (edx), "=m" (eax)
-		: "m" (eax), "m" (rm32), "g" (flags)
-		: "eax", "edx"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	regs.Write(Instruction::RegEax, eax);
-	regs.Write(Instruction::RegEdx, edx);
-	regs.setEflags(flags);
+	regs.Write(Instruction::RegEax, product);
+	regs.Write(Instruction::RegEdx, product >> 32);
 
 	newUinst(Uinst::OpcodeMult,
 			Uinst::DepRm32,
@@ -2100,25 +1784,9 @@ void Context::ExecuteInst_mul_rm32()
 void Context::ExecuteInst_neg_rm8()
 {
 	unsigned char rm8 = LoadRm8();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %3\n\t"
-		"popf\n\t"
-		"mov %2, %%al\n\t"
-		"neg %%al\n\t"
-		"mov %%al, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=g" (rm8)
-		: "g" (rm8), "g" (flags)
-		: "al"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	StoreRm8(rm8);
-	regs.setEflags(flags);
+	unsigned char result = -rm8;
+	regs.setLazyFlags(Regs::LazyFlagsSub, 1, 0, rm8, result);
+	StoreRm8(result);
 
 	newUinst(Uinst::OpcodeSub,
 			Uinst::DepRm8,
@@ -2134,25 +1802,9 @@ void Context::ExecuteInst_neg_rm8()
 void Context::ExecuteInst_neg_rm32()
 {
 	unsigned int rm32 = LoadRm32();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %3\n\t"
-		"popf\n\t"
-		"mov %2, %%eax\n\t"
-		"neg %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=g" (rm32)
-		: "g" (rm32), "g" (flags)
-		: "eax"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
-
-	StoreRm32(rm32);
-	regs.setEflags(flags);
+	unsigned int result = -rm32;
+	regs.setLazyFlags(Regs::LazyFlagsSub, 4, 0, rm32, result);
+	StoreRm32(result);
 
 	newUinst(Uinst::OpcodeSub,
 			Uinst::DepRm32,
@@ -2789,27 +2441,9 @@ void Context::ExecuteInst_shld_rm16_r16_imm8()
 	unsigned short rm16 = LoadRm16();
 	unsigned short r16 = LoadR16();
 	unsigned char imm8 = inst.getImmByte();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %5\n\t"
-		"popf\n\t"
-		"mov %4, %%cl\n\t"
-		"mov %3, %%bx\n\t"
-		"mov %2, %%ax\n\t"
-		"shld %%cl, %%bx, %%ax\n\t"
-		"mov %%ax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=m" (rm16)
-		: "m" (rm16), "m" (r16), "m" (imm8), "g" (flags)
-		: "ax", "bx", "cl"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
+	rm16 = shift_double(regs, rm16, r16, imm8, 2, true);
 
 	StoreRm16(rm16);
-	regs.setEflags(flags);
 
 	newUinst(Uinst::OpcodeShift,
 			Uinst::DepRm16,
@@ -2827,27 +2461,9 @@ void Context::ExecuteInst_shld_rm16_r16_cl()
 	unsigned short rm16 = LoadRm16();
 	unsigned short r16 = LoadR16();
 	unsigned char cl = regs.Read(Instruction::RegCl);
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %5\n\t"
-		"popf\n\t"
-		"mov %4, %%cl\n\t"
-		"mov %3, %%bx\n\t"
-		"mov %2, %%ax\n\t"
-		"shld %%cl, %%bx, %%ax\n\t"
-		"mov %%ax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=m" (rm16)
-		: "m" (rm16), "m" (r16), "m" (cl), "g" (flags)
-		: "ax", "bx", "cl"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
+	rm16 = shift_double(regs, rm16, r16, cl, 2, true);
 
 	StoreRm16(rm16);
-	regs.setEflags(flags);
 
 	newUinst(Uinst::OpcodeShift,
 			Uinst::DepRm16,
@@ -2865,27 +2481,9 @@ void Context::ExecuteInst_shld_rm32_r32_imm8()
 	unsigned int rm32 = LoadRm32();
 	unsigned int r32 = LoadR32();
 	unsigned char imm8 = inst.getImmByte();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %5\n\t"
-		"popf\n\t"
-		"mov %4, %%cl\n\t"
-		"mov %3, %%ebx\n\t"
-		"mov %2, %%eax\n\t"
-		"shld %%cl, %%ebx, %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=m" (rm32)
-		: "m" (rm32), "m" (r32), "m" (imm8), "g" (flags)
-		: "eax", "ebx", "cl"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
+	rm32 = shift_double(regs, rm32, r32, imm8, 4, true);
 
 	StoreRm32(rm32);
-	regs.setEflags(flags);
 
 	newUinst(Uinst::OpcodeShift,
 			Uinst::DepRm32,
@@ -2903,27 +2501,9 @@ void Context::ExecuteInst_shld_rm32_r32_cl()
 	unsigned int rm32 = LoadRm32();
 	unsigned int r32 = LoadR32();
 	unsigned char cl = regs.Read(Instruction::RegCl);
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %5\n\t"
-		"popf\n\t"
-		"mov %4, %%cl\n\t"
-		"mov %3, %%ebx\n\t"
-		"mov %2, %%eax\n\t"
-		"shld %%cl, %%ebx, %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=m" (rm32)
-		: "m" (rm32), "m" (r32), "m" (cl), "g" (flags)
-		: "eax", "ebx", "cl"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
+	rm32 = shift_double(regs, rm32, r32, cl, 4, true);
 
 	StoreRm32(rm32);
-	regs.setEflags(flags);
 
 	newUinst(Uinst::OpcodeShift,
 			Uinst::DepRm32,
@@ -2941,27 +2521,9 @@ void Context::ExecuteInst_shrd_rm32_r32_imm8()
 	unsigned int rm32 = LoadRm32();
 	unsigned int r32 = LoadR32();
 	unsigned char imm8 = inst.getImmByte();
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %5\n\t"
-		"popf\n\t"
-		"mov %4, %%cl\n\t"
-		"mov %3, %%ebx\n\t"
-		"mov %2, %%eax\n\t"
-		"shrd %%cl, %%ebx, %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=m" (rm32)
-		: "m" (rm32), "m" (r32), "m" (imm8), "g" (flags)
-		: "eax", "ebx", "cl"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
+	rm32 = shift_double(regs, rm32, r32, imm8, 4, false);
 
 	StoreRm32(rm32);
-	regs.setEflags(flags);
 
 	newUinst(Uinst::OpcodeShift,
 			Uinst::DepRm32,
@@ -2979,27 +2541,9 @@ void Context::ExecuteInst_shrd_rm32_r32_cl()
 	unsigned int rm32 = LoadRm32();
 	unsigned int r32 = LoadR32();
 	unsigned char cl = regs.Read(Instruction::RegCl);
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %5\n\t"
-		"popf\n\t"
-		"mov %4, %%cl\n\t"
-		"mov %3, %%ebx\n\t"
-		"mov %2, %%eax\n\t"
-		"shrd %%cl, %%ebx, %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=m" (rm32)
-		: "m" (rm32), "m" (r32), "m" (cl), "g" (flags)
-		: "eax", "ebx", "cl"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
+	rm32 = shift_double(regs, rm32, r32, cl, 4, false);
 
 	StoreRm32(rm32);
-	regs.setEflags(flags);
 
 	newUinst(Uinst::OpcodeShift,
 			Uinst::DepRm32,
@@ -3031,27 +2575,11 @@ void Context::ExecuteInst_xadd_rm8_r8()
 {
 	unsigned char rm8 = LoadRm8();
 	unsigned char r8 = LoadR8();
-	unsigned char sum;
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %4\n\t"
-		"popf\n\t"
-		"mov %2, %%al\n\t"
-		"add %3, %%al\n\t"
-		"mov %%al, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=m" (sum)
-		: "m" (rm8), "m" (r8), "g" (flags)
-		: "al"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
+	unsigned char sum = rm8 + r8;
+	regs.setLazyFlags(Regs::LazyFlagsAdd, 1, rm8, r8, sum);
 
 	StoreR8(rm8);
 	StoreRm8(sum);
-	regs.setEflags(flags);
 
 	newUinst(Uinst::OpcodeAdd,
 			Uinst::DepRm8,
@@ -3084,27 +2612,11 @@ void Context::ExecuteInst_xadd_rm32_r32()
 {
 	unsigned int rm32 = LoadRm32();
 	unsigned int r32 = LoadR32();
-	unsigned int sum;
-	unsigned long flags = regs.getEflags();
-
-	__X86_CONTEXT_SAVE_FLAGS__
-	asm volatile (
-		"push %4\n\t"
-		"popf\n\t"
-		"mov %2, %%eax\n\t"
-		"add %3, %%eax\n\t"
-		"mov %%eax, %1\n\t"
-		"pushf\n\t"
-		"pop %0\n\t"
-		: "=g" (flags), "=m" (sum)
-		: "m" (rm32), "m" (r32), "g" (flags)
-		: "eax"
-	);
-	__X86_CONTEXT_RESTORE_FLAGS__
+	unsigned int sum = rm32 + r32;
+	regs.setLazyFlags(Regs::LazyFlagsAdd, 4, rm32, r32, sum);
 
 	StoreR32(rm32);
 	StoreRm32(sum);
-	regs.setEflags(flags);
 
 	newUinst(Uinst::OpcodeAdd,
 			Uinst::DepRm32,
@@ -32,6 +32,133 @@ namespace x86
 #define assert __COMPILATION_ERROR__
 
 
+// Functions computing the result of each rotate and shift instruction on a
+// 'value' of 'size' bytes, and updating the flags. As on hardware, the count
+// is masked to 5 bits, and flags are left unchanged when the masked count is
+// 0. Flag AF, undefined for shifts, is left unchanged, and flag OF, undefined
+// for counts greater than 1, is computed as for a count of 1.
+
+static inline unsigned rot_rcl(Regs &regs, unsigned value, unsigned char count,
+		int size)
+{
+	int width = size * 8;
+	count &= 0x1f;
+	if (!count)
+		return value;
+	unsigned long long mask = (1ull << (width + 1)) - 1;
+	unsigned long long wide = (unsigned long long) regs.getFlag(
+			Instruction::FlagCF) << width | value;
+	count %= width + 1;
+	wide = (wide << count | wide >> (width + 1 - count)) & mask;
+	unsigned result = wide & (mask >> 1);
+	bool cf = (wide >> width) & 1;
+	regs.setFlag(Instruction::FlagCF, cf);
+	regs.setFlag(Instruction::FlagOF, ((result >> (width - 1)) & 1) ^ cf);
+	return result;
+}
+
+static inline unsigned rot_rcr(Regs &regs, unsigned value, unsigned char count,
+		int size)
+{
+	int width = size * 8;
+	count &= 0x1f;
+	if (!count)
+		return value;
+	unsigned long long mask = (1ull << (width + 1)) - 1;
+	unsigned long long wide = (unsigned long long) regs.getFlag(
+			Instruction::FlagCF) << width | value;
+	count %= width + 1;
+	wide = (wide >> count | wide << (width + 1 - count)) & mask;
+	unsigned result = wide & (mask >> 1);
+	regs.setFlag(Instruction::FlagCF, (wide >> width) & 1);
+	regs.setFlag(Instruction::FlagOF, ((result >> (width - 1)) ^
+			(result >> (width - 2))) & 1);
+	return result;
+}
+
+static inline unsigned rot_rol(Regs &regs, unsigned value, unsigned char count,
+		int size)
+{
+	int width = size * 8;
+	count &= 0x1f;
+	if (!count)
+		return value;
+	unsigned long long mask = (1ull << width) - 1;
+	count %= width;
+	unsigned result = ((unsigned long long) value << count |
+			(unsigned long long) value >> (width - count)) & mask;
+	bool cf = result & 1;
+	regs.setFlag(Instruction::FlagCF, cf);
+	regs.setFlag(Instruction::FlagOF, ((result >> (width - 1)) & 1) ^ cf);
+	return result;
+}
+
+static inline unsigned rot_ror(Regs &regs, unsigned value, unsigned char count,
+		int size)
+{
+	int width = size * 8;
+	count &= 0x1f;
+	if (!count)
+		return value;
+	unsigned long long mask = (1ull << width) - 1;
+	count %= width;
+	unsigned result = ((unsigned long long) value >> count |
+			(unsigned long long) value << (width - count)) & mask;
+	regs.setFlag(Instruction::FlagCF, (result >> (width - 1)) & 1);
+	regs.setFlag(Instruction::FlagOF, ((result >> (width - 1)) ^
+			(result >> (width - 2))) & 1);
+	return result;
+}
+
+static inline unsigned rot_sar(Regs &regs, unsigned value, unsigned char count,
+		int size)
+{
+	int width = size * 8;
+	count &= 0x1f;
+	if (!count)
+		return value;
+	unsigned long long mask = (1ull << width) - 1;
+	long long wide = (long long) (int) (value << (32 - width)) >>
+			(32 - width);
+	unsigned result = (wide >> count) & mask;
+	regs.setFlag(Instruction::FlagCF, (wide >> (count - 1)) & 1);
+	regs.setFlag(Instruction::FlagOF, false);
+	regs.setZpsFlags(result, size);
+	return result;
+}
+
+static inline unsigned rot_shl(Regs &regs, unsigned value, unsigned char count,
+		int size)
+{
+	int width = size * 8;
+	count &= 0x1f;
+	if (!count)
+		return value;
+	unsigned long long mask = (1ull << width) - 1;
+	unsigned long long wide = ((unsigned long long) value & mask) << count;
+	unsigned result = wide & mask;
+	bool cf = (wide >> width) & 1;
+	regs.setFlag(Instruction::FlagCF, cf);
+	regs.setFlag(Instruction::FlagOF, ((result >> (width - 1)) & 1) ^ cf);
+	regs.setZpsFlags(result, size);
+	return result;
+}
+
+static inline unsigned rot_shr(Regs &regs, unsigned value, unsigned char count,
+		int size)
+{
+	int width = size * 8;
+	count &= 0x1f;
+	if (!count)
+		return value;
+	unsigned long long mask = (1ull << width) - 1;
+	unsigned long long wide = value & mask;
+	unsigned result = wide >> count;
+	regs.setFlag(Instruction::FlagCF, (wide >> (count - 1)) & 1);
+	regs.setFlag(Instruction::FlagOF, (wide >> (width - 1)) & 1);
+	regs.setZpsFlags(result, size);
+	return result;
+}
 
 
 #define op_xxx_rm8_1_impl(xxx, idep) \
@@ -39,24 +166,8 @@ void Context::ExecuteInst_##xxx##_rm8_1() \
 { \
 	unsigned char rm8 = LoadRm8(); \
 	unsigned char count = 1; \
-	unsigned long flags = regs.getEflags(); \
-	__X86_CONTEXT_SAVE_FLAGS__ \
-	asm volatile ( \
-		"push %4\n\t" \
-		"popf\n\t" \
-		"mov %2, %%al\n\t" \
-		"mov %3, %%cl\n\t" \
-		#xxx " %%cl, %%al\n\t" \
-		"mov %%al, %1\n\t" \
-		"pushf\n\t" \
-		"pop %0\n\t" \
-		: "=g" (flags), "=m" (rm8) \
-		: "m" (rm8), "m" (count), "g" (flags) \
-		: "al", "cl" \
-	); \
-	__X86_CONTEXT_RESTORE_FLAGS__ \
+	rm8 = rot_##xxx(regs, rm8, count, 1); \
 	StoreRm8(rm8); \
-	regs.setEflags(flags); \
 	newUinst(Uinst::OpcodeShift, \
 			idep, \
 			Uinst::DepRm8, \
@@ -73,24 +184,8 @@ void Context::ExecuteInst_##xxx##_rm8_cl() \
 { \
 	unsigned char rm8 = LoadRm8(); \
 	unsigned char count = regs.Read(Instruction::RegCl); \
-	unsigned long flags = regs.getEflags(); \
-	__X86_CONTEXT_SAVE_FLAGS__ \
-	asm volatile ( \
-		"push %4\n\t" \
-		"popf\n\t" \
-		"mov %2, %%al\n\t" \
-		"mov %3, %%cl\n\t" \
-		#xxx " %%cl, %%al\n\t" \
-		"mov %%al, %1\n\t" \
-		"pushf\n\t" \
-		"pop %0\n\t" \
-		: "=g" (flags), "=m" (rm8) \
-		: "m" (rm8), "m" (count), "g" (flags) \
-		: "al", "cl" \
-	); \
-	__X86_CONTEXT_RESTORE_FLAGS__ \
+	rm8 = rot_##xxx(regs, rm8, count, 1); \
 	StoreRm8(rm8); \
-	regs.setEflags(flags); \
 	newUinst(Uinst::OpcodeShift, \
 			idep, \
 			Uinst::DepRm8, \
@@ -107,24 +202,8 @@ void Context::ExecuteInst_##xxx##_rm8_imm8() \
 { \
 	unsigned char rm8 = LoadRm8(); \
 	unsigned char count = inst.getImmByte(); \
-	unsigned long flags = regs.getEflags(); \
-	__X86_CONTEXT_SAVE_FLAGS__ \
-	asm volatile ( \
-		"push %4\n\t" \
-		"popf\n\t" \
-		"mov %2, %%al\n\t" \
-		"mov %3, %%cl\n\t" \
-		#xxx " %%cl, %%al\n\t" \
-		"mov %%al, %1\n\t" \
-		"pushf\n\t" \
-		"pop %0\n\t" \
-		: "=g" (flags), "=m" (rm8) \
-		: "m" (rm8), "m" (count), "g" (flags) \
-		: "al", "cl" \
-	); \
-	__X86_CONTEXT_RESTORE_FLAGS__ \
+	rm8 = rot_##xxx(regs, rm8, count, 1); \
 	StoreRm8(rm8); \
-	regs.setEflags(flags); \
 	newUinst(Uinst::OpcodeShift, \
 			idep, \
 			Uinst::DepRm8, \
@@ -141,24 +220,8 @@ void Context::ExecuteInst_##xxx##_rm16_1() \
 { \
 	unsigned short rm16 = LoadRm16(); \
 	unsigned char count = 1; \
-	unsigned long flags = regs.getEflags(); \
-	__X86_CONTEXT_SAVE_FLAGS__ \
-	asm volatile ( \
-		"push %4\n\t" \
-		"popf\n\t" \
-		"mov %2, %%ax\n\t" \
-		"mov %3, %%cl\n\t" \
-		#xxx " %%cl, %%ax\n\t" \
-		"mov %%ax, %1\n\t" \
-		"pushf\n\t" \
-		"pop %0\n\t" \
-		: "=g" (flags), "=m" (rm16) \
-		: "m" (rm16), "m" (count), "g" (flags) \
-		: "ax", "cl" \
-	); \
-	__X86_CONTEXT_RESTORE_FLAGS__ \
+	rm16 = rot_##xxx(regs, rm16, count, 2); \
 	StoreRm16(rm16); \
-	regs.setEflags(flags); \
 	newUinst(Uinst::OpcodeShift, \
 			idep, \
 			Uinst::DepRm16, \
@@ -175,24 +238,8 @@ void Context::ExecuteInst_##xxx##_rm16_cl() \
 { \
 	unsigned short rm16 = LoadRm16(); \
 	unsigned char count = regs.Read(Instruction::RegCl); \
-	unsigned long flags = regs.getEflags(); \
-	__X86_CONTEXT_SAVE_FLAGS__ \
-	asm volatile ( \
-		"push %4\n\t" \
-		"popf\n\t" \
-		"mov %2, %%ax\n\t" \
-		"mov %3, %%cl\n\t" \
-		#xxx " %%cl, %%ax\n\t" \
-		"mov %%ax, %1\n\t" \
-		"pushf\n\t" \
-		"pop %0\n\t" \
-		: "=g" (flags), "=m" (rm16) \
-		: "m" (rm16), "m" (count), "g" (flags) \
-		: "ax", "cl" \
-	); \
-	__X86_CONTEXT_RESTORE_FLAGS__ \
+	rm16 = rot_##xxx(regs, rm16, count, 2); \
 	StoreRm16(rm16); \
-	regs.setEflags(flags); \
 	newUinst(Uinst::OpcodeShift, \
 			idep, \
 			Uinst::DepRm16, \
@@ -209,24 +256,8 @@ void Context::ExecuteInst_##xxx##_rm16_imm8() \
 { \
 	unsigned short rm16 = LoadRm16(); \
 	unsigned char count = inst.getImmByte(); \
-	unsigned long flags = regs.getEflags(); \
-	__X86_CONTEXT_SAVE_FLAGS__ \
-	asm volatile ( \
-		"push %4\n\t" \
-		"popf\n\t" \
-		"mov %2, %%ax\n\t" \
-		"mov %3, %%cl\n\t" \
-		#xxx " %%cl, %%ax\n\t" \
-		"mov %%ax, %1\n\t" \
-		"pushf\n\t" \
-		"pop %0\n\t" \
-		: "=g" (flags), "=m" (rm16) \
-		: "m" (rm16), "m" (count), "g" (flags) \
-		: "ax", "cl" \
-	); \
-	__X86_CONTEXT_RESTORE_FLAGS__ \
+	rm16 = rot_##xxx(regs, rm16, count, 2); \
 	StoreRm16(rm16); \
-	regs.setEflags(flags); \
 	newUinst(Uinst::OpcodeShift, \
 			idep, \
 			Uinst::DepRm16, \
@@ -243,24 +274,8 @@ void Context::ExecuteInst_##xxx##_rm32_1() \
 { \
 	unsigned int rm32 = LoadRm32(); \
 	unsigned char count = 1; \
-	unsigned long flags = regs.getEflags(); \
-	__X86_CONTEXT_SAVE_FLAGS__ \
-	asm volatile ( \
-		"push %4\n\t" \
-		"popf\n\t" \
-		"mov %2, %%eax\n\t" \
-		"mov %3, %%cl\n\t" \
-		#xxx " %%cl, %%eax\n\t" \
-		"mov %%eax, %1\n\t" \
-		"pushf\n\t" \
-		"pop %0\n\t" \
-		: "=g" (flags), "=m" (rm32) \
-		: "m" (rm32), "m" (count), "g" (flags) \
-		: "eax", "cl" \
-	); \
-	__X86_CONTEXT_RESTORE_FLAGS__ \
+	rm32 = rot_##xxx(regs, rm32, count, 4); \
 	StoreRm32(rm32); \
-	regs.setEflags(flags); \
 	newUinst(Uinst::OpcodeShift, \
 			idep, \
 			Uinst::DepRm32, \
@@ -277,24 +292,8 @@ void Context::ExecuteInst_##xxx##_rm32_cl() \
 { \
 	unsigned int rm32 = LoadRm32(); \
 	unsigned char count = regs.Read(Instruction::RegCl); \
-	unsigned long flags = regs.getEflags(); \
-	__X86_CONTEXT_SAVE_FLAGS__ \
-	asm volatile ( \
-		"push %4\n\t" \
-		"popf\n\t" \
-		"mov %2, %%eax\n\t" \
-		"mov %3, %%cl\n\t" \
-		#xxx " %%cl, %%eax\n\t" \
-		"mov %%eax, %1\n\t" \
-		"pushf\n\t" \
-		"pop %0\n\t" \
-		: "=g" (flags), "=m" (rm32) \
-		: "m" (rm32), "m" (count), "g" (flags) \
-		: "eax", "cl" \
-	); \
-	__X86_CONTEXT_RESTORE_FLAGS__ \
+	rm32 = rot_##xxx(regs, rm32, count, 4); \
 	StoreRm32(rm32); \
-	regs.setEflags(flags); \
 	newUinst(Uinst::OpcodeShift, \
 			idep, \
 			Uinst::DepRm32, \
@@ -311,24 +310,8 @@ void Context::ExecuteInst_##xxx##_rm32_imm8() \
 { \
 	unsigned int rm32 = LoadRm32(); \
 	unsigned char count = inst.getImmByte(); \
-	unsigned long flags = regs.getEflags(); \
-	__X86_CONTEXT_SAVE_FLAGS__ \
-	asm volatile ( \
-		"push %4\n\t" \
-		"popf\n\t" \
-		"mov %2, %%eax\n\t" \
-		"mov %3, %%cl\n\t" \
-		#xxx " %%cl, %%eax\n\t" \
-		"mov %%eax, %1\n\t" \
-		"pushf\n\t" \
-		"pop %0\n\t" \
-		: "=g" (flags), "=m" (rm32) \
-		: "m" (rm32), "m" (count), "g" (flags) \
-		: "eax", "cl" \
-	); \
-	__X86_CONTEXT_RESTORE_FLAGS__ \
+	rm32 = rot_##xxx(regs, rm32, count, 4); \
 	StoreRm32(rm32); \
-	regs.setEflags(flags); \
 	newUinst(Uinst::OpcodeShift, \
 			idep, \
 			Uinst::DepRm32, \
@@ -201,6 +201,82 @@ void Regs::DumpFpuStack(std::ostream &os) const
 }
 
 
+unsigned Regs::ComputeEflags() const
+{
+	// Operands and result truncated to the operand size
+	unsigned mask = this->mask[lazy_size];
+	unsigned sign = 1u << (lazy_size * 8 - 1);
+	unsigned src1 = lazy_src1 & mask;
+	unsigned src2 = lazy_src2 & mask;
+	unsigned result = lazy_result & mask;
+
+	// Flags CF, OF, and AF depend on the operation. Logic operations
+	// clear all three, leaving AF cleared although it is undefined.
+	bool cf = false;
+	bool of = false;
+	bool af = false;
+	switch (lazy_op)
+	{
+
+	case LazyFlagsAdd:
+	case LazyFlagsAdc:
+
+		cf = lazy_op == LazyFlagsAdc && lazy_carry ?
+				result <= src1 : result < src1;
+		of = (src1 ^ result) & (src2 ^ result) & sign;
+		af = (src1 ^ src2 ^ result) & 0x10;
+		break;
+
+	case LazyFlagsSub:
+	case LazyFlagsSbb:
+
+		cf = lazy_op == LazyFlagsSbb && lazy_carry ?
+				src1 <= src2 : src1 < src2;
+		of = (src1 ^ src2) & (src1 ^ result) & sign;
+		af = (src1 ^ src2 ^ result) & 0x10;
+		break;
+
+	case LazyFlagsInc:
+
+		cf = lazy_carry;
+		of = result == sign;
+		af = (result & 0xf) == 0;
+		break;
+
+	case LazyFlagsDec:
+
+		cf = lazy_carry;
+		of = result == sign - 1;
+		af = (result & 0xf) == 0xf;
+		break;
+
+	default:
+		break;
+	}
+
+	// Build flags
+	unsigned flags = eflags & ~ArithmeticFlagsMask;
+	flags |= cf << Instruction::FlagCF;
+	flags |= !__builtin_parity(result & 0xff) << Instruction::FlagPF;
+	flags |= af << Instruction::FlagAF;
+	flags |= (result == 0) << Instruction::FlagZF;
+	flags |= ((result & sign) != 0) << Instruction::FlagSF;
+	flags |= of << Instruction::FlagOF;
+	return flags;
+}
+
+
+void Regs::setZpsFlags(unsigned result, int size)
+{
+	MaterializeFlags();
+	result &= mask[size];
+	unsigned sign = 1u << (size * 8 - 1);
+	setFlag(Instruction::FlagZF, result == 0);
+	setFlag(Instruction::FlagSF, result & sign);
+	setFlag(Instruction::FlagPF, !__builtin_parity(result & 0xff));
+}
+
+
 void Regs::Dump(std::ostream &os) const
 {
 	// Integer registers
@@ -211,6 +287,7 @@ void Regs::Dump(std::ostream &os) const
 	os << misc::fmt("  es=%x, cs=%x, ss=%x, ds=%x, fs=%x, gs=%x\n",
 		es, cs, ss, ds, fs, gs);
 	os << misc::fmt("  eip=%08x\n", eip);
+	unsigned eflags = getEflags();
 	os << misc::fmt("  flags=%04x (cf=%d  pf=%d  af=%d  zf=%d  sf=%d  df=%d  of=%d)\n",
 		eflags,
 		(eflags & (1 << Instruction::FlagCF)) > 0,
@@ -36,6 +36,34 @@ namespace x86
 /// Class representing the state of the x86 architected register file.
 class Regs
 {
+public:
+
+	/// Operations whose arithmetic flags (CF, PF, AF, ZF, SF, OF) are
+	/// computed lazily, from the operands and result recorded with
+	/// setLazyFlags(), only when an instruction reads them.
+	enum LazyFlagsOp
+	{
+		LazyFlagsNone = 0,
+		LazyFlagsAdd,
+		LazyFlagsAdc,
+		LazyFlagsSub,
+		LazyFlagsSbb,
+		LazyFlagsLogic,
+		LazyFlagsInc,
+		LazyFlagsDec
+	};
+
+	/// Mask of the arithmetic flags in register \c eflags
+	static const unsigned ArithmeticFlagsMask =
+			(1 << Instruction::FlagCF) |
+			(1 << Instruction::FlagPF) |
+			(1 << Instruction::FlagAF) |
+			(1 << Instruction::FlagZF) |
+			(1 << Instruction::FlagSF) |
+			(1 << Instruction::FlagOF);
+
+private:
+
 	union
 	{
 		// View of the main set of registers as defined in the register
@@ -74,6 +102,32 @@ class Regs
 	unsigned eip;
 	unsigned eflags;
 
+	// Last operation that updated the arithmetic flags, together with its
+	// operand size in bytes, operands, and result. While the operation is
+	// other than 'LazyFlagsNone', the arithmetic flags in 'eflags' are
+	// stale. Field 'lazy_carry' holds the carry-in of 'adc' and 'sbb', and
+	// the preserved value of flag CF for 'inc' and 'dec'.
+	LazyFlagsOp lazy_op = LazyFlagsNone;
+	int lazy_size = 0;
+	unsigned lazy_src1 = 0;
+	unsigned lazy_src2 = 0;
+	unsigned lazy_result = 0;
+	bool lazy_carry = false;
+
+	// Return the value of 'eflags' with the arithmetic flags produced by
+	// the last lazy operation.
+	unsigned ComputeEflags() const;
+
+	// Store the arithmetic flags of the last lazy operation into 'eflags'
+	void MaterializeFlags()
+	{
+		if (lazy_op != LazyFlagsNone)
+		{
+			eflags = ComputeEflags();
+			lazy_op = LazyFlagsNone;
+		}
+	}
+
 	// Floating-point stack
 	struct
 	{
@@ -125,19 +179,56 @@ public:
 
 	/// Set the value of a flag, given as an \c Inst::FlagXXX identifier.
 	void setFlag(Instruction::Flag flag) {
+		if ((1 << flag) & ArithmeticFlagsMask)
+			MaterializeFlags();
 		eflags = misc::setBit32(eflags, flag);
 	}
 
 	/// Clear the value of a flag, given as an \c Inst::FlagXXX identifier.
 	void clearFlag(Instruction::Flag flag) {
+		if ((1 << flag) & ArithmeticFlagsMask)
+			MaterializeFlags();
 		eflags = misc::clearBit32(eflags, flag);
 	}
 
+	/// Set or clear a flag, given as an \c Inst::FlagXXX identifier,
+	/// depending on \a value.
+	void setFlag(Instruction::Flag flag, bool value) {
+		if ((1 << flag) & ArithmeticFlagsMask)
+			MaterializeFlags();
+		eflags = value ? misc::setBit32(eflags, flag) :
+				misc::clearBit32(eflags, flag);
+	}
+
 	/// Get the value of a flag, given as an \c Inst::FlagXXX constant.
 	bool getFlag(Instruction::Flag flag) {
+		if ((1 << flag) & ArithmeticFlagsMask)
+			MaterializeFlags();
 		return misc::getBit32(eflags, flag);
 	}
 
+	/// Record the last operation updating the arithmetic flags, instead of
+	/// computing them. Operands \a src1 and \a src2 and the \a result
+	/// are truncated to \a size bytes when the flags are computed. Argument
+	/// \a carry is the carry-in for \c LazyFlagsAdc and \c LazyFlagsSbb,
+	/// and the value of flag CF to preserve for \c LazyFlagsInc and
+	/// \c LazyFlagsDec.
+	void setLazyFlags(LazyFlagsOp op, int size, unsigned src1,
+			unsigned src2, unsigned result, bool carry = false)
+	{
+		lazy_op = op;
+		lazy_size = size;
+		lazy_src1 = src1;
+		lazy_src2 = src2;
+		lazy_result = result;
+		lazy_carry = carry;
+	}
+
+	/// Set flags ZF, SF, and PF based on a \a result of \a size bytes,
+	/// as produced by shift, rotate, and bit scan instructions. The
+	/// remaining flags are left unchanged.
+	void setZpsFlags(unsigned result, int size);
+
 	/// Read a 10-byte extended value from the FPU stack at \a index, given
 	/// as a relative position to the top of the stack.
 	Extended ReadFpu(int index) const;
@@ -242,7 +333,9 @@ public:
 	unsigned getEip() const { return eip; }
 
 	/// Get value of register \c eflags
-	unsigned getEflags() const { return eflags; }
+	unsigned getEflags() const {
+		return lazy_op == LazyFlagsNone ? eflags : ComputeEflags();
+	}
 
 	/// Get value of register \c es
 	unsigned short getEs() const { return es; }
@@ -386,7 +479,10 @@ public:
 	void decEip(int value) { eip -= value; }
 
 	/// Set value of register \c eflags
-	void setEflags(unsigned value) { eflags = value; }
+	void setEflags(unsigned value) {
+		eflags = value;
+		lazy_op = LazyFlagsNone;
+	}
 
 	/// Get the top of the FP stack
 	int getFpuTop() const { return fpu_top; }
@@ -17,6 +17,10 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
 #include <lib/cpp/Misc.h>
 
 #include "BranchPredictor.h"
@@ -35,6 +39,27 @@ int BranchPredictor::two_level_l1_size;
 int BranchPredictor::two_level_l2_size;
 int BranchPredictor::two_level_history_size;
 int BranchPredictor::two_level_l2_height;
+int BranchPredictor::tage_num_tables;
+int BranchPredictor::tage_table_size;
+int BranchPredictor::tage_tag_bits;
+int BranchPredictor::tage_min_history;
+int BranchPredictor::tage_max_history;
+int BranchPredictor::tage_base_size;
+bool BranchPredictor::tage_loop_predictor;
+bool BranchPredictor::tage_statistical_corrector;
+int BranchPredictor::loop_size;
+int BranchPredictor::sc_size;
+int BranchPredictor::perceptron_num_tables;
+int BranchPredictor::perceptron_table_size;
+int BranchPredictor::perceptron_history_length;
+int BranchPredictor::perceptron_threshold;
+
+// Number of TAGE updates between two consecutive agings of the useful
+// counters
+static const int tage_useful_reset_period = 1 << 18;
+
+// Global history lengths of statistical corrector tables 1 and above
+static const int sc_history_lengths[BranchPredictor::ScNumTables] = { 0, 4, 8, 16 };
 
 misc::StringMap BranchPredictor::KindMap =
 {
@@ -43,7 +68,9 @@ misc::StringMap BranchPredictor::KindMap =
 	{"NotTaken", KindNottaken},
 	{"Bimodal", KindBimod},
 	{"TwoLevel", KindTwoLevel},
-	{"Combined", KindCombined}
+	{"Combined", KindCombined},
+	{"TAGE", KindTage},
+	{"Perceptron", KindPerceptron}
 };
 
 BranchPredictor::BranchPredictor(const std::string &name)
@@ -78,6 +105,86 @@ BranchPredictor::BranchPredictor(const std::string &name)
 			choice[i] = 2;
 	}
 
+	// Global history shared by TAGE, the statistical corrector, and the
+	// hashed perceptron. The buffer holds at least one more outcome than
+	// the longest history, since the folded histories need the outcome
+	// leaving each of them.
+	if (kind == KindTage || kind == KindPerceptron)
+	{
+		int max_length = kind == KindTage ?
+				std::max(tage_max_history, sc_history_lengths[ScNumTables - 1]) :
+				perceptron_history_length;
+		history_size = 1;
+		while (history_size <= max_length)
+			history_size <<= 1;
+		history = misc::new_unique_array<uint8_t>(history_size);
+	}
+
+	// TAGE predictor
+	if (kind == KindTage)
+	{
+		// Base predictor
+		tage_base = misc::new_unique_array<int8_t>(tage_base_size);
+		for (int i = 0; i < tage_base_size; i++)
+			tage_base[i] = 2;
+
+		// Tagged tables
+		int table_bits = misc::LogBase2(tage_table_size);
+		tage_tables = misc::new_unique_array<TageEntry>(tage_num_tables *
+				tage_table_size);
+		for (int table = 0; table < tage_num_tables; table++)
+		{
+			// Geometric series of history lengths
+			int length = tage_min_history;
+			if (tage_num_tables > 1)
+				length = (int) (tage_min_history * pow((double)
+						tage_max_history / tage_min_history,
+						(double) table / (tage_num_tables - 1)) + 0.5);
+			tage_history_lengths[table] = length;
+
+			// Folded histories for index and tag
+			tage_index_history[table] = AddFoldedHistory(length, table_bits);
+			tage_tag_history[table][0] = AddFoldedHistory(length, tage_tag_bits);
+			tage_tag_history[table][1] = AddFoldedHistory(length, tage_tag_bits - 1);
+		}
+
+		// Loop predictor
+		if (tage_loop_predictor)
+			loop_table = misc::new_unique_array<LoopEntry>(loop_size);
+
+		// Statistical corrector. Table 0 does not use global history.
+		if (tage_statistical_corrector)
+		{
+			sc_tables = misc::new_unique_array<int8_t>(ScNumTables * sc_size);
+			sc_history[0] = -1;
+			for (int table = 1; table < ScNumTables; table++)
+				sc_history[table] = AddFoldedHistory(
+						sc_history_lengths[table],
+						misc::LogBase2(sc_size) - 1);
+		}
+	}
+
+	// Hashed perceptron. Table 0 is the bias table, indexed by PC only, and
+	// the remaining tables use global history lengths growing geometrically
+	// from 2 to the configured history length.
+	if (kind == KindPerceptron)
+	{
+		int table_bits = misc::LogBase2(perceptron_table_size);
+		perceptron_weights = misc::new_unique_array<int8_t>(
+				perceptron_num_tables * perceptron_table_size);
+		perceptron_history[0] = -1;
+		for (int table = 1; table < perceptron_num_tables; table++)
+		{
+			int length = perceptron_history_length;
+			if (perceptron_num_tables > 2)
+				length = (int) (2 * pow((double) perceptron_history_length / 2,
+						(double) (table - 1) / (perceptron_num_tables - 2))
+						+ 0.5);
+			perceptron_history[table] = AddFoldedHistory(length, table_bits);
+		}
+		perceptron_theta = perceptron_threshold;
+	}
+
 	// Allocate BTB and assign LRU counters
 	btb = misc::new_unique_array<BtbEntry>(btb_num_sets * btb_num_ways);
 	for (int i = 0; i < btb_num_sets; i++)
@@ -105,9 +212,31 @@ void BranchPredictor::ParseConfiguration(misc::IniFile *ini_file)
 	two_level_l2_size = ini_file->ReadInt(section, "TwoLevel.L2Size", 1024);
 	two_level_history_size = ini_file->ReadInt(section, "TwoLevel.HistorySize", 8);
 
+	// TAGE predictor
+	tage_num_tables = ini_file->ReadInt(section, "Tage.NumTables", 4);
+	tage_table_size = ini_file->ReadInt(section, "Tage.TableSize", 1024);
+	tage_tag_bits = ini_file->ReadInt(section, "Tage.TagBits", 9);
+	tage_min_history = ini_file->ReadInt(section, "Tage.MinHistory", 4);
+	tage_max_history = ini_file->ReadInt(section, "Tage.MaxHistory", 64);
+	tage_base_size = ini_file->ReadInt(section, "Tage.BaseSize", 4096);
+	tage_loop_predictor = ini_file->ReadBool(section, "Tage.LoopPredictor", false);
+	tage_statistical_corrector = ini_file->ReadBool(section, "Tage.StatisticalCorrector", false);
+	loop_size = ini_file->ReadInt(section, "Loop.Size", 64);
+	sc_size = ini_file->ReadInt(section, "SC.Size", 1024);
+
+	// Hashed perceptron predictor
+	perceptron_num_tables = ini_file->ReadInt(section, "Perceptron.NumTables", 8);
+	perceptron_table_size = ini_file->ReadInt(section, "Perceptron.TableSize", 1024);
+	perceptron_history_length = ini_file->ReadInt(section, "Perceptron.HistoryLength", 64);
+	perceptron_threshold = ini_file->ReadInt(section, "Perceptron.Threshold", 0);
+
 	// Two-level branch predictor parameter
 	two_level_l2_height = 1 << two_level_history_size;
 
+	// Default perceptron threshold, as a function of the number of tables
+	if (!perceptron_threshold)
+		perceptron_threshold = (int) (2.14 * (perceptron_num_tables + 1) + 20.58);
+
 	// Integrity
 	if (bimod_size & (bimod_size - 1))
 		throw Error("number of entries in bimodal precitor must be a power of 2");
@@ -123,6 +252,36 @@ void BranchPredictor::ParseConfiguration(misc::IniFile *ini_file)
 		throw Error("two-level predictor sizes must be power of 2");
 	if (two_level_l2_size & (two_level_l2_size - 1))
 		throw Error("two-level predictor sizes must be power of 2");
+	if (tage_num_tables < 1 || tage_num_tables > MaxTables)
+		throw Error(misc::fmt("number of TAGE tables must be >=1 and <=%d",
+				MaxTables));
+	if (tage_table_size < 2 || tage_table_size > 65536 ||
+			(tage_table_size & (tage_table_size - 1)))
+		throw Error("TAGE table size must be a power of 2 between 2 and 65536");
+	if (tage_tag_bits < 2 || tage_tag_bits > 16)
+		throw Error("TAGE tag bits must be >=2 and <=16");
+	if (tage_min_history < 1 || tage_max_history < tage_min_history ||
+			tage_max_history > 1024)
+		throw Error("TAGE history lengths must satisfy "
+				"1 <= MinHistory <= MaxHistory <= 1024");
+	if (tage_base_size < 1 || (tage_base_size & (tage_base_size - 1)))
+		throw Error("number of entries in TAGE base predictor must be a power of 2");
+	if (loop_size < 1 || (loop_size & (loop_size - 1)))
+		throw Error("number of entries in loop predictor must be a power of 2");
+	if (sc_size < 4 || sc_size > 65536 || (sc_size & (sc_size - 1)))
+		throw Error("statistical corrector size must be a power of 2 "
+				"between 4 and 65536");
+	if (perceptron_num_tables < 1 || perceptron_num_tables > MaxTables)
+		throw Error(misc::fmt("number of perceptron tables must be "
+				">=1 and <=%d", MaxTables));
+	if (perceptron_table_size < 2 || perceptron_table_size > 65536 ||
+			(perceptron_table_size & (perceptron_table_size - 1)))
+		throw Error("perceptron table size must be a power of 2 "
+				"between 2 and 65536");
+	if (perceptron_history_length < 2 || perceptron_history_length > 1024)
+		throw Error("perceptron history length must be >=2 and <=1024");
+	if (perceptron_threshold < 0)
+		throw Error("perceptron threshold must be >=0");
 }
 
 
@@ -138,6 +297,505 @@ void BranchPredictor::DumpConfiguration(std::ostream &os)
 	os << misc::fmt("\tTwoLevel.L1Size: %d\n", two_level_l1_size);
 	os << misc::fmt("\tTwoLevel.L2Size: %d\n", two_level_l2_size);
 	os << misc::fmt("\tTwoLevel.HistorySize: %d\n", two_level_history_size);
+	os << misc::fmt("\tTage.NumTables: %d\n", tage_num_tables);
+	os << misc::fmt("\tTage.TableSize: %d\n", tage_table_size);
+	os << misc::fmt("\tTage.TagBits: %d\n", tage_tag_bits);
+	os << misc::fmt("\tTage.MinHistory: %d\n", tage_min_history);
+	os << misc::fmt("\tTage.MaxHistory: %d\n", tage_max_history);
+	os << misc::fmt("\tTage.BaseSize: %d\n", tage_base_size);
+	os << misc::fmt("\tTage.LoopPredictor: %s\n", tage_loop_predictor ? "True" : "False");
+	os << misc::fmt("\tTage.StatisticalCorrector: %s\n", tage_statistical_corrector ? "True" : "False");
+	os << misc::fmt("\tLoop.Size: %d\n", loop_size);
+	os << misc::fmt("\tSC.Size: %d\n", sc_size);
+	os << misc::fmt("\tPerceptron.NumTables: %d\n", perceptron_num_tables);
+	os << misc::fmt("\tPerceptron.TableSize: %d\n", perceptron_table_size);
+	os << misc::fmt("\tPerceptron.HistoryLength: %d\n", perceptron_history_length);
+	os << misc::fmt("\tPerceptron.Threshold: %d\n", perceptron_threshold);
+}
+
+
+void BranchPredictor::DumpReport(std::ostream &os, long long num_instructions) const
+{
+	os << "; Branch predictor (direction of conditional branches)\n";
+	os << misc::fmt("BranchPredictor.Kind = %s\n", KindMap[kind]);
+	os << misc::fmt("BranchPredictor.StorageBytes = %d\n", getStorageSize());
+	os << misc::fmt("BranchPredictor.CondBranches = %lld\n", num_conditional_branches);
+	os << misc::fmt("BranchPredictor.CondMispred = %lld\n", num_direction_mispredictions);
+	os << misc::fmt("BranchPredictor.MPKI = %.4g\n", num_instructions ?
+			(double) num_direction_mispredictions * 1000
+			/ num_instructions : 0.0);
+	if (kind == KindTage && tage_loop_predictor)
+	{
+		os << misc::fmt("BranchPredictor.LoopOverrides = %lld\n", num_loop_overrides);
+		os << misc::fmt("BranchPredictor.LoopOverridesCorrect = %lld\n", num_loop_overrides_correct);
+	}
+	if (kind == KindTage && tage_statistical_corrector)
+	{
+		os << misc::fmt("BranchPredictor.SCOverrides = %lld\n", num_sc_overrides);
+		os << misc::fmt("BranchPredictor.SCOverridesCorrect = %lld\n", num_sc_overrides_correct);
+	}
+	os << '\n';
+}
+
+
+int BranchPredictor::getStorageSize() const
+{
+	int size = 0;
+	if (bimod)
+		size += bimod_size;
+	if (two_level_bht)
+		size += two_level_l1_size * sizeof(unsigned) +
+				two_level_l2_size * two_level_l2_height;
+	if (choice)
+		size += choice_size;
+	if (history)
+		size += history_size;
+	if (tage_tables)
+		size += tage_base_size + tage_num_tables * tage_table_size *
+				sizeof(TageEntry);
+	if (loop_table)
+		size += loop_size * sizeof(LoopEntry);
+	if (sc_tables)
+		size += ScNumTables * sc_size;
+	if (perceptron_weights)
+		size += perceptron_num_tables * perceptron_table_size;
+	return size;
+}
+
+
+int BranchPredictor::AddFoldedHistory(int length, int width)
+{
+	assert(length < history_size);
+	assert(width > 0 && width < 32);
+	FoldedHistory folded_history;
+	folded_history.length = length;
+	folded_history.width = width;
+	folded_history.outpoint = length % width;
+	folded_histories.push_back(folded_history);
+	return folded_histories.size() - 1;
+}
+
+
+void BranchPredictor::PushHistory(bool taken)
+{
+	// Insert outcome
+	history_pointer = (history_pointer - 1) & (history_size - 1);
+	history[history_pointer] = taken;
+
+	// Update folded histories with the new outcome and the outcome that
+	// just left each of them
+	for (auto &folded_history : folded_histories)
+	{
+		unsigned outgoing = history[(history_pointer + folded_history.length)
+				& (history_size - 1)];
+		folded_history.value = (folded_history.value << 1) | taken;
+		folded_history.value ^= outgoing << folded_history.outpoint;
+		folded_history.value ^= folded_history.value >> folded_history.width;
+		folded_history.value &= (1u << folded_history.width) - 1;
+	}
+}
+
+
+unsigned BranchPredictor::getTageIndex(unsigned eip, int table) const
+{
+	unsigned folded = getFoldedHistory(tage_index_history[table]);
+	return (eip ^ (eip >> (table + 1)) ^ folded) & (tage_table_size - 1);
+}
+
+
+unsigned BranchPredictor::getTageTag(unsigned eip, int table) const
+{
+	unsigned folded_0 = getFoldedHistory(tage_tag_history[table][0]);
+	unsigned folded_1 = getFoldedHistory(tage_tag_history[table][1]);
+	return (eip ^ folded_0 ^ (folded_1 << 1)) & ((1u << tage_tag_bits) - 1);
+}
+
+
+BranchPredictor::Prediction BranchPredictor::LookupTage(Uop *uop)
+{
+	// Base prediction
+	uop->tage_base_index = uop->eip & (tage_base_size - 1);
+	Prediction base_prediction = tage_base[uop->tage_base_index] > 1 ?
+			PredictionTaken : PredictionNotTaken;
+
+	// Compute indices and tags with the current global history, and find
+	// the two hitting tables with the longest histories
+	uop->tage_provider = -1;
+	uop->tage_alt_provider = -1;
+	for (int table = tage_num_tables - 1; table >= 0; table--)
+	{
+		uop->table_index[table] = getTageIndex(uop->eip, table);
+		uop->tage_tag[table] = getTageTag(uop->eip, table);
+		TageEntry *entry = &tage_tables[table * tage_table_size +
+				uop->table_index[table]];
+		if (entry->tag != uop->tage_tag[table])
+			continue;
+		if (uop->tage_provider < 0)
+			uop->tage_provider = table;
+		else if (uop->tage_alt_provider < 0)
+			uop->tage_alt_provider = table;
+	}
+
+	// Alternate prediction
+	uop->tage_alt_prediction = base_prediction;
+	if (uop->tage_alt_provider >= 0)
+	{
+		TageEntry *entry = &tage_tables[uop->tage_alt_provider *
+				tage_table_size +
+				uop->table_index[uop->tage_alt_provider]];
+		uop->tage_alt_prediction = entry->counter >= 0 ?
+				PredictionTaken : PredictionNotTaken;
+	}
+
+	// No tagged table hit, use the base prediction
+	if (uop->tage_provider < 0)
+	{
+		uop->tage_provider_prediction = base_prediction;
+		uop->tage_prediction = base_prediction;
+		return base_prediction;
+	}
+
+	// Provider prediction. An entry that was just allocated is not
+	// trusted if the alternate prediction has been more accurate for such
+	// entries.
+	TageEntry *entry = &tage_tables[uop->tage_provider * tage_table_size +
+			uop->table_index[uop->tage_provider]];
+	uop->tage_provider_prediction = entry->counter >= 0 ?
+			PredictionTaken : PredictionNotTaken;
+	bool new_entry = !entry->useful &&
+			(entry->counter == 0 || entry->counter == -1);
+	uop->tage_prediction = new_entry && tage_use_alt_on_new >= 0 ?
+			uop->tage_alt_prediction :
+			uop->tage_provider_prediction;
+	return uop->tage_prediction;
+}
+
+
+void BranchPredictor::UpdateTage(Uop *uop, bool taken)
+{
+	Prediction outcome = taken ? PredictionTaken : PredictionNotTaken;
+	int provider = uop->tage_provider;
+
+	// On a misprediction, allocate an entry in one of the tables with a
+	// longer history than the provider. Shorter histories are favored. If
+	// no entry can be replaced, make all candidates less useful.
+	if (uop->tage_prediction != outcome && provider < tage_num_tables - 1)
+	{
+		int candidates[MaxTables];
+		int num_candidates = 0;
+		for (int table = provider + 1; table < tage_num_tables; table++)
+			if (!tage_tables[table * tage_table_size +
+					uop->table_index[table]].useful)
+				candidates[num_candidates++] = table;
+		if (num_candidates)
+		{
+			tage_seed = tage_seed * 1103515245 + 12345;
+			int table = candidates[num_candidates > 1 &&
+					!((tage_seed >> 16) & 3) ? 1 : 0];
+			TageEntry *entry = &tage_tables[table * tage_table_size +
+					uop->table_index[table]];
+			entry->tag = uop->tage_tag[table];
+			entry->counter = taken ? 0 : -1;
+			entry->useful = 0;
+		}
+		else
+		{
+			for (int table = provider + 1; table < tage_num_tables; table++)
+			{
+				TageEntry *entry = &tage_tables[table * tage_table_size +
+						uop->table_index[table]];
+				if (entry->useful)
+					entry->useful--;
+			}
+		}
+	}
+
+	// Train base predictor if it provided the prediction
+	int8_t *base = &tage_base[uop->tage_base_index];
+	if (provider < 0)
+	{
+		if (taken)
+			*base = *base + 1 > 3 ? 3 : *base + 1;
+		else
+			*base = *base - 1 < 0 ? 0 : *base - 1;
+	}
+	else
+	{
+		TageEntry *entry = &tage_tables[provider * tage_table_size +
+				uop->table_index[provider]];
+
+		// Learn whether the alternate prediction is better for newly
+		// allocated entries
+		bool new_entry = !entry->useful &&
+				(entry->counter == 0 || entry->counter == -1);
+		if (new_entry && uop->tage_provider_prediction !=
+				uop->tage_alt_prediction)
+		{
+			if (uop->tage_alt_prediction == outcome)
+				tage_use_alt_on_new = std::min(tage_use_alt_on_new + 1, 7);
+			else
+				tage_use_alt_on_new = std::max(tage_use_alt_on_new - 1, -8);
+		}
+
+		// Train the alternate prediction too while the provider has not
+		// proven useful
+		if (!entry->useful)
+		{
+			if (uop->tage_alt_provider >= 0)
+			{
+				TageEntry *alt_entry = &tage_tables[uop->tage_alt_provider *
+						tage_table_size +
+						uop->table_index[uop->tage_alt_provider]];
+				if (taken)
+					alt_entry->counter = std::min(alt_entry->counter + 1, 3);
+				else
+					alt_entry->counter = std::max(alt_entry->counter - 1, -4);
+			}
+			else if (taken)
+				*base = *base + 1 > 3 ? 3 : *base + 1;
+			else
+				*base = *base - 1 < 0 ? 0 : *base - 1;
+		}
+
+		// Train provider
+		if (taken)
+			entry->counter = std::min(entry->counter + 1, 3);
+		else
+			entry->counter = std::max(entry->counter - 1, -4);
+
+		// The provider is useful if it was right where the alternate
+		// prediction was wrong
+		if (uop->tage_provider_prediction != uop->tage_alt_prediction)
+		{
+			if (uop->tage_provider_prediction == outcome)
+				entry->useful = std::min(entry->useful + 1, 3);
+			else if (entry->useful)
+				entry->useful--;
+		}
+	}
+
+	// Periodically age all useful counters, so that stale entries can be
+	// replaced
+	if (++tage_tick >= tage_useful_reset_period)
+	{
+		tage_tick = 0;
+		for (int i = 0; i < tage_num_tables * tage_table_size; i++)
+			tage_tables[i].useful >>= 1;
+	}
+}
+
+
+void BranchPredictor::LookupLoop(Uop *uop)
+{
+	int index = uop->eip & (loop_size - 1);
+	uint16_t tag = uop->eip >> misc::LogBase2(loop_size);
+	LoopEntry *entry = &loop_table[index];
+	uop->loop_index = index;
+	uop->loop_hit = entry->age && entry->tag == tag;
+	uop->loop_valid = uop->loop_hit && entry->confidence == 3;
+	if (!uop->loop_hit)
+		return;
+
+	// The loop exits when the iteration count of its last execution is
+	// reached
+	bool exit = entry->current_iterations + 1 == entry->past_iterations;
+	uop->loop_prediction = (entry->direction != exit) ?
+			PredictionTaken : PredictionNotTaken;
+}
+
+
+void BranchPredictor::UpdateLoop(Uop *uop, bool taken)
+{
+	Prediction outcome = taken ? PredictionTaken : PredictionNotTaken;
+	LoopEntry *entry = &loop_table[uop->loop_index];
+
+	// Allocate a new entry when TAGE mispredicts a branch, assuming that
+	// the misprediction is a loop exit. Entries are only replaced when
+	// their age has dropped to zero.
+	if (!uop->loop_hit)
+	{
+		if (uop->tage_prediction == outcome)
+			return;
+		if (entry->age)
+		{
+			entry->age--;
+			return;
+		}
+		entry->tag = uop->eip >> misc::LogBase2(loop_size);
+		entry->direction = !taken;
+		entry->past_iterations = 0;
+		entry->current_iterations = 0;
+		entry->confidence = 0;
+		entry->age = 31;
+		return;
+	}
+
+	// Free the entry on a wrong confident prediction
+	if (uop->loop_valid && uop->loop_prediction != outcome)
+	{
+		entry->age = 0;
+		return;
+	}
+
+	// Correct predictions that TAGE got wrong make the entry older
+	if (uop->loop_valid && uop->loop_prediction != uop->tage_prediction &&
+			entry->age < 127)
+		entry->age++;
+
+	// Count iteration, giving up on loops that are too long
+	entry->current_iterations++;
+	if (!entry->current_iterations)
+	{
+		entry->age = 0;
+		return;
+	}
+
+	// Loop body
+	if (taken == entry->direction)
+	{
+		if (entry->past_iterations &&
+				entry->current_iterations >= entry->past_iterations)
+			entry->confidence = 0;
+		return;
+	}
+
+	// Loop exit, gain confidence if the iteration count repeats
+	if (entry->current_iterations == entry->past_iterations)
+	{
+		if (entry->confidence < 3)
+			entry->confidence++;
+	}
+	else
+	{
+		entry->past_iterations = entry->current_iterations;
+		entry->confidence = 0;
+	}
+	entry->current_iterations = 0;
+}
+
+
+void BranchPredictor::LookupStatisticalCorrector(Uop *uop)
+{
+	// Tables are indexed by PC, global history, and the TAGE prediction
+	int tage_taken = uop->tage_prediction == PredictionTaken;
+	uop->sc_sum = 0;
+	for (int table = 0; table < ScNumTables; table++)
+	{
+		unsigned folded = sc_history[table] < 0 ? 0 :
+				getFoldedHistory(sc_history[table]);
+		uop->sc_index[table] = (((uop->eip ^ folded) << 1) | tage_taken)
+				& (sc_size - 1);
+		uop->sc_sum += 2 * sc_tables[table * sc_size +
+				uop->sc_index[table]] + 1;
+	}
+
+	// High-confidence TAGE predictions and loop predictions are kept
+	if (uop->loop_valid)
+		return;
+	if (uop->tage_provider >= 0)
+	{
+		TageEntry *entry = &tage_tables[uop->tage_provider * tage_table_size
+				+ uop->table_index[uop->tage_provider]];
+		if (entry->counter == 3 || entry->counter == -4)
+			return;
+	}
+
+	// Revert TAGE when the corrector strongly disagrees
+	if ((uop->sc_sum >= 0) != (bool) tage_taken &&
+			std::abs(uop->sc_sum) >= sc_threshold)
+		uop->prediction = uop->sc_sum >= 0 ?
+				PredictionTaken : PredictionNotTaken;
+}
+
+
+void BranchPredictor::UpdateStatisticalCorrector(Uop *uop, bool taken)
+{
+	bool sc_taken = uop->sc_sum >= 0;
+	bool tage_taken = uop->tage_prediction == PredictionTaken;
+
+	// Adapt threshold when the corrector disagreed with TAGE with enough
+	// strength to override it
+	if (sc_taken != tage_taken && std::abs(uop->sc_sum) >= sc_threshold)
+	{
+		sc_threshold_counter += sc_taken == taken ? -1 : 1;
+		if (sc_threshold_counter >= 16)
+		{
+			sc_threshold++;
+			sc_threshold_counter = 0;
+		}
+		else if (sc_threshold_counter <= -16)
+		{
+			sc_threshold = std::max(sc_threshold - 1, 2);
+			sc_threshold_counter = 0;
+		}
+	}
+
+	// Train counters on a wrong or weak corrector prediction
+	if (sc_taken == taken && std::abs(uop->sc_sum) >= sc_threshold)
+		return;
+	for (int table = 0; table < ScNumTables; table++)
+	{
+		int8_t *counter = &sc_tables[table * sc_size + uop->sc_index[table]];
+		if (taken)
+			*counter = std::min(*counter + 1, 31);
+		else
+			*counter = std::max(*counter - 1, -32);
+	}
+}
+
+
+BranchPredictor::Prediction BranchPredictor::LookupPerceptron(Uop *uop)
+{
+	uop->perceptron_sum = 0;
+	for (int table = 0; table < perceptron_num_tables; table++)
+	{
+		unsigned folded = perceptron_history[table] < 0 ? 0 :
+				getFoldedHistory(perceptron_history[table]);
+		uop->table_index[table] = (uop->eip ^ (uop->eip >> (table + 1))
+				^ folded) & (perceptron_table_size - 1);
+		uop->perceptron_sum += perceptron_weights[table *
+				perceptron_table_size + uop->table_index[table]];
+	}
+	return uop->perceptron_sum >= 0 ? PredictionTaken : PredictionNotTaken;
+}
+
+
+void BranchPredictor::UpdatePerceptron(Uop *uop, bool taken)
+{
+	bool perceptron_taken = uop->perceptron_sum >= 0;
+	bool weak = std::abs(uop->perceptron_sum) <= perceptron_theta;
+
+	// Adapt threshold so that mispredictions and weak correct
+	// predictions are balanced
+	if (perceptron_taken != taken)
+	{
+		if (++perceptron_theta_counter >= 64)
+		{
+			perceptron_theta++;
+			perceptron_theta_counter = 0;
+		}
+	}
+	else if (weak)
+	{
+		if (--perceptron_theta_counter <= -64)
+		{
+			perceptron_theta = std::max(perceptron_theta - 1, 0);
+			perceptron_theta_counter = 0;
+		}
+	}
+
+	// Train weights
+	if (perceptron_taken == taken && !weak)
+		return;
+	for (int table = 0; table < perceptron_num_tables; table++)
+	{
+		int8_t *weight = &perceptron_weights[table * perceptron_table_size
+				+ uop->table_index[table]];
+		if (taken)
+			*weight = std::min(*weight + 1, 127);
+		else
+			*weight = std::max(*weight - 1, -128);
+	}
 }
 
 
@@ -222,6 +880,39 @@ BranchPredictor::Prediction BranchPredictor::Lookup(Uop *uop)
 		uop->prediction = choice_prediction;
 	}
 
+	// TAGE, optionally refined by the loop predictor and the statistical
+	// corrector
+	if (kind == KindTage)
+	{
+		uop->prediction = LookupTage(uop);
+		uop->loop_valid = false;
+		if (tage_loop_predictor)
+		{
+			LookupLoop(uop);
+			if (uop->loop_valid)
+				uop->prediction = uop->loop_prediction;
+		}
+		if (tage_statistical_corrector)
+			LookupStatisticalCorrector(uop);
+	}
+
+	// Hashed perceptron
+	if (kind == KindPerceptron)
+		uop->prediction = LookupPerceptron(uop);
+
+	// Branches in the correct path have already been resolved by the
+	// functional emulator, so their outcome enters the global history and
+	// the loop predictor right away. This models a speculative history
+	// update with perfect repair on recovery, since branches in the wrong
+	// path never modify it.
+	if ((kind == KindTage || kind == KindPerceptron) && !uop->speculative_mode)
+	{
+		bool taken = uop->neip != uop->eip + uop->mop_size;
+		if (kind == KindTage && tage_loop_predictor)
+			UpdateLoop(uop, taken);
+		PushHistory(taken);
+	}
+
 	// Return prediction
 	assert(uop->prediction == PredictionTaken || uop->prediction == PredictionNotTaken);
 	return uop->prediction;
@@ -284,6 +975,15 @@ void BranchPredictor::Update(Uop *uop)
 	if (uop->neip == uop->predicted_neip)
 		hits++;
 
+	// Direction statistics of conditional branches
+	bool internal = uop->getUinst()->getOpcode() == Uinst::OpcodeIbranch;
+	if (!(uop->getFlags() & Uinst::FlagUncond) && !internal)
+	{
+		num_conditional_branches++;
+		if (uop->prediction != (taken ? PredictionTaken : PredictionNotTaken))
+			num_direction_mispredictions++;
+	}
+
 	// Update predictors. This is only done for conditional branches. Thus,
 	// exit now if instruction is a call, ret, or jmp.
 	// No update is performed in a perfect branch predictor either.
@@ -292,6 +992,38 @@ void BranchPredictor::Update(Uop *uop)
 	if (uop->getFlags() & Uinst::FlagUncond)
 		return;
 
+	// TAGE predictor. Internal branches are always predicted taken, and
+	// do not train it.
+	if (kind == KindTage && !internal)
+	{
+		Prediction outcome = taken ? PredictionTaken : PredictionNotTaken;
+		if (uop->loop_valid && uop->loop_prediction != uop->tage_prediction)
+		{
+			num_loop_overrides++;
+			if (uop->loop_prediction == outcome)
+				num_loop_overrides_correct++;
+		}
+		if (tage_statistical_corrector)
+		{
+			if (!uop->loop_valid && uop->prediction != uop->tage_prediction)
+			{
+				num_sc_overrides++;
+				if (uop->prediction == outcome)
+					num_sc_overrides_correct++;
+			}
+			UpdateStatisticalCorrector(uop, taken);
+		}
+		UpdateTage(uop, taken);
+		return;
+	}
+
+	// Hashed perceptron
+	if (kind == KindPerceptron && !internal)
+	{
+		UpdatePerceptron(uop, taken);
+		return;
+	}
+
 	// Bimodal predictor was used
 	if (kind == KindBimod ||
 			(kind == KindCombined && uop->choice_prediction == PredictionNotTaken))
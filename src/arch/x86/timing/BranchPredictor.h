@@ -20,7 +20,9 @@
 #ifndef ARCH_X86_TIMING_BRANCH_PREDICTOR_H
 #define ARCH_X86_TIMING_BRANCH_PREDICTOR_H
 
+#include <cstdint>
 #include <string>
+#include <vector>
 
 #include <arch/x86/emulator/Uinst.h>
 #include <lib/cpp/Error.h>
@@ -54,9 +56,19 @@ public:
 		KindNottaken,
 		KindBimod,
 		KindTwoLevel,
-		KindCombined
+		KindCombined,
+		KindTage,
+		KindPerceptron
 	};
 
+	/// Maximum number of tagged tables in the TAGE predictor, or weight
+	/// tables in the hashed perceptron predictor. Micro-instructions keep
+	/// one table index per table for the update at commit.
+	static const int MaxTables = 16;
+
+	/// Number of tables in the statistical corrector
+	static const int ScNumTables = 4;
+
 	/// string map of branch predictor kind
 	static misc::StringMap KindMap;
 
@@ -96,6 +108,45 @@ private:
 	// Height of the level 2 table of the two-level predictor
 	static int two_level_l2_height;
 
+	// Number of tagged tables in the TAGE predictor
+	static int tage_num_tables;
+
+	// Number of entries in each tagged table of the TAGE predictor
+	static int tage_table_size;
+
+	// Number of tag bits in the TAGE tagged tables
+	static int tage_tag_bits;
+
+	// Shortest and longest global history lengths of the TAGE tagged
+	// tables. Intermediate tables use a geometric series.
+	static int tage_min_history;
+	static int tage_max_history;
+
+	// Number of entries of the bimodal base predictor of TAGE
+	static int tage_base_size;
+
+	// Loop predictor and statistical corrector enabled for TAGE
+	static bool tage_loop_predictor;
+	static bool tage_statistical_corrector;
+
+	// Number of entries of the loop predictor
+	static int loop_size;
+
+	// Number of entries in each table of the statistical corrector
+	static int sc_size;
+
+	// Number of weight tables in the hashed perceptron
+	static int perceptron_num_tables;
+
+	// Number of weights in each table of the hashed perceptron
+	static int perceptron_table_size;
+
+	// Global history length covered by the hashed perceptron
+	static int perceptron_history_length;
+
+	// Initial training threshold of the hashed perceptron
+	static int perceptron_threshold;
+
 
 
 
@@ -138,10 +189,168 @@ private:
 	//   2,3 - Use two-level adaptive predictor
 	std::unique_ptr<char[]> choice;
 
+	// Folded global history. The most recent 'length' bits of the global
+	// history are compressed into 'width' bits by XOR-ing consecutive
+	// chunks, and the result is updated incrementally for every new bit.
+	struct FoldedHistory
+	{
+		unsigned value = 0;
+		int length = 0;
+		int width = 0;
+		int outpoint = 0;
+	};
+
+	// Global history of conditional branch outcomes, stored as a circular
+	// buffer of one byte per outcome. Entry 'history_pointer' contains the
+	// most recent outcome.
+	std::unique_ptr<uint8_t[]> history;
+
+	// Size of the global history buffer (power of 2)
+	int history_size = 0;
+
+	// Position of the most recent outcome in the global history
+	int history_pointer = 0;
+
+	// Folded histories used to index and tag all tables
+	std::vector<FoldedHistory> folded_histories;
+
+	// Register a folded history and return its index
+	int AddFoldedHistory(int length, int width);
+
+	// Insert the outcome of a conditional branch into the global history
+	// and update all folded histories.
+	void PushHistory(bool taken);
+
+	// Return the value of a folded history
+	unsigned getFoldedHistory(int index) const
+	{
+		return folded_histories[index].value;
+	}
+
+	// Entry of a TAGE tagged table, 4 bytes
+	struct TageEntry
+	{
+		// Partial tag
+		uint16_t tag;
+
+		// Signed 3-bit prediction counter, in the range [-4, 3]
+		int8_t counter;
+
+		// 2-bit useful counter
+		uint8_t useful;
+	};
+
+	// TAGE base predictor, array of 2-bit counters indexed by PC
+	std::unique_ptr<int8_t[]> tage_base;
+
+	// TAGE tagged tables, array of tage_num_tables * tage_table_size
+	// entries. Table 0 uses the shortest history.
+	std::unique_ptr<TageEntry[]> tage_tables;
+
+	// History length used by each TAGE tagged table
+	int tage_history_lengths[MaxTables];
+
+	// Folded histories used to compute the index and the two components
+	// of the tag of each TAGE tagged table
+	int tage_index_history[MaxTables];
+	int tage_tag_history[MaxTables][2];
+
+	// Signed 4-bit counter deciding whether the alternate prediction is
+	// used when the provider entry was just allocated
+	int tage_use_alt_on_new = 0;
+
+	// Number of TAGE updates since useful counters were last aged
+	int tage_tick = 0;
+
+	// Pseudo-random state choosing among candidate tables for allocation
+	unsigned tage_seed = 1;
+
+	// Return the index and tag of TAGE table 'table' for address 'eip'
+	unsigned getTageIndex(unsigned eip, int table) const;
+	unsigned getTageTag(unsigned eip, int table) const;
+
+	// Lookup and update of the TAGE predictor
+	Prediction LookupTage(Uop *uop);
+	void UpdateTage(Uop *uop, bool taken);
+
+	// Entry of the loop predictor, 8 bytes
+	struct LoopEntry
+	{
+		// Partial tag
+		uint16_t tag;
+
+		// Number of iterations of the last complete execution of the loop
+		uint16_t past_iterations;
+
+		// Number of iterations of the current execution of the loop
+		uint16_t current_iterations;
+
+		// 2-bit confidence counter, prediction is used when saturated
+		uint8_t confidence;
+
+		// Replacement age, also telling whether the entry is valid
+		uint8_t age : 7;
+
+		// Direction of the loop body, the exit goes the other way
+		uint8_t direction : 1;
+	};
+
+	// Loop predictor, direct-mapped array of loop_size entries
+	std::unique_ptr<LoopEntry[]> loop_table;
+
+	// Lookup and update of the loop predictor
+	void LookupLoop(Uop *uop);
+	void UpdateLoop(Uop *uop, bool taken);
+
+	// Statistical corrector tables, each an array of sc_size signed 6-bit
+	// counters. Table 0 is indexed by PC, the rest by PC and global
+	// history of increasing length.
+	std::unique_ptr<int8_t[]> sc_tables;
+
+	// Folded history used by each statistical corrector table
+	int sc_history[ScNumTables];
+
+	// Threshold of the statistical corrector and its adaptation counter
+	int sc_threshold = 6;
+	int sc_threshold_counter = 0;
+
+	// Lookup and update of the statistical corrector
+	void LookupStatisticalCorrector(Uop *uop);
+	void UpdateStatisticalCorrector(Uop *uop, bool taken);
+
+	// Hashed perceptron weight tables, array of perceptron_num_tables *
+	// perceptron_table_size signed 8-bit weights. Table 0 is indexed by
+	// PC only and acts as the bias weight.
+	std::unique_ptr<int8_t[]> perceptron_weights;
+
+	// Folded history used by each perceptron table
+	int perceptron_history[MaxTables];
+
+	// Current training threshold and its adaptation counter
+	int perceptron_theta = 0;
+	int perceptron_theta_counter = 0;
+
+	// Lookup and update of the hashed perceptron
+	Prediction LookupPerceptron(Uop *uop);
+	void UpdatePerceptron(Uop *uop, bool taken);
+
 	// Stats 
 	long long accesses = 0;
 	long long hits = 0;
 
+	// Number of committed conditional branches, and how many of them had
+	// their direction mispredicted
+	long long num_conditional_branches = 0;
+	long long num_direction_mispredictions = 0;
+
+	// Number of committed conditional branches where the loop predictor
+	// or the statistical corrector overrode the TAGE prediction, and how
+	// many of those overrides were correct
+	long long num_loop_overrides = 0;
+	long long num_loop_overrides_correct = 0;
+	long long num_sc_overrides = 0;
+	long long num_sc_overrides_correct = 0;
+
 public:
 
 	//
@@ -185,6 +394,34 @@ public:
 
 	static int getTwoLevelL2Height() { return two_level_l2_height; }
 
+	static int getTageNumTables() { return tage_num_tables; }
+
+	static int getTageTableSize() { return tage_table_size; }
+
+	static int getTageTagBits() { return tage_tag_bits; }
+
+	static int getTageMinHistory() { return tage_min_history; }
+
+	static int getTageMaxHistory() { return tage_max_history; }
+
+	static int getTageBaseSize() { return tage_base_size; }
+
+	static bool getTageLoopPredictor() { return tage_loop_predictor; }
+
+	static bool getTageStatisticalCorrector() { return tage_statistical_corrector; }
+
+	static int getLoopSize() { return loop_size; }
+
+	static int getScSize() { return sc_size; }
+
+	static int getPerceptronNumTables() { return perceptron_num_tables; }
+
+	static int getPerceptronTableSize() { return perceptron_table_size; }
+
+	static int getPerceptronHistoryLength() { return perceptron_history_length; }
+
+	static int getPerceptronThreshold() { return perceptron_threshold; }
+
 
 
 
@@ -201,6 +438,29 @@ public:
 	/// Dump configuration
 	void DumpConfiguration(std::ostream &os = std::cout);
 
+	/// Dump the statistics of the branch predictor in the pipeline report.
+	/// Argument \a num_instructions is the number of x86 instructions
+	/// committed by the thread owning the predictor, used to compute the
+	/// number of mispredictions per kilo-instruction (MPKI).
+	void DumpReport(std::ostream &os, long long num_instructions) const;
+
+	/// Return the number of committed conditional branches
+	long long getNumConditionalBranches() const
+	{
+		return num_conditional_branches;
+	}
+
+	/// Return the number of committed conditional branches whose direction
+	/// was mispredicted
+	long long getNumDirectionMispredictions() const
+	{
+		return num_direction_mispredictions;
+	}
+
+	/// Return the number of bytes used by the prediction tables, not
+	/// including the BTB and the RAS
+	int getStorageSize() const;
+
 	char getBimodStatus(int index) const { return bimod[index]; }
 
 	int getTwoLevelBhtStatus(int index) const { return two_level_bht[index]; }
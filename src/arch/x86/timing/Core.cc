@@ -17,6 +17,9 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <lib/esim/Profiler.h>
+#include <lib/esim/Statistics.h>
+
 #include "Core.h"
 #include "Cpu.h"
 #include "Timing.h"
@@ -37,6 +40,23 @@ Core::Core(Cpu *cpu,
 	threads.reserve(Cpu::getNumThreads());
 	for (int i = 0; i < Cpu::getNumThreads(); i++)
 		threads.emplace_back(misc::new_unique<Thread>(this, i));
+
+	// Interval statistics
+	std::string prefix = misc::fmt("x86.core%d.", id);
+	esim::StatisticsRegistry::Register(prefix + "committed_instructions",
+			&num_committed_instructions);
+	esim::StatisticsRegistry::Register(prefix + "committed_uinsts",
+			&num_committed_uinsts);
+	esim::StatisticsRegistry::Register(prefix + "dispatched_uinsts",
+			&num_dispatched_uinsts);
+	esim::StatisticsRegistry::Register(prefix + "issued_uinsts",
+			&num_issued_uinsts);
+	esim::StatisticsRegistry::Register(prefix + "squashed_uinsts",
+			&num_squashed_uinsts);
+	esim::StatisticsRegistry::Register(prefix + "branches",
+			&num_branches);
+	esim::StatisticsRegistry::Register(prefix + "mispredicted_branches",
+			&num_mispredicted_branches);
 }
 
 
@@ -95,6 +115,11 @@ void Core::ExtractFromEventQueue(Uop *uop)
 
 void Core::Fetch()
 {
+	// Host time of the stage
+	static esim::ProfilerRegion *profiler_region =
+			esim::Profiler::getRegion("x86.Fetch");
+	esim::ProfilerScope profiler_scope(profiler_region);
+
 	// Invoke fetch stage function according to the kind
 	switch (Cpu::getFetchKind())
 	{
@@ -139,6 +164,11 @@ void Core::Fetch()
 
 void Core::Decode()
 {
+	// Host time of the stage
+	static esim::ProfilerRegion *profiler_region =
+			esim::Profiler::getRegion("x86.Decode");
+	esim::ProfilerScope profiler_scope(profiler_region);
+
 	// Run decode stage for all threads
 	for (auto &thread : threads)
 		thread->Decode();
@@ -147,6 +177,11 @@ void Core::Decode()
 
 void Core::Dispatch()
 {
+	// Host time of the stage
+	static esim::ProfilerRegion *profiler_region =
+			esim::Profiler::getRegion("x86.Dispatch");
+	esim::ProfilerScope profiler_scope(profiler_region);
+
 	// Maximum number of threads to skip
 	int skip = Cpu::getNumThreads();
 
@@ -212,6 +247,11 @@ void Core::Dispatch()
 
 void Core::Issue()
 {
+	// Host time of the stage
+	static esim::ProfilerRegion *profiler_region =
+			esim::Profiler::getRegion("x86.Issue");
+	esim::ProfilerScope profiler_scope(profiler_region);
+
 	switch (Cpu::getIssueKind())
 	{
 	
@@ -304,6 +344,11 @@ void Core::Issue()
 
 void Core::Writeback()
 {
+	// Host time of the stage
+	static esim::ProfilerRegion *profiler_region =
+			esim::Profiler::getRegion("x86.Writeback");
+	esim::ProfilerScope profiler_scope(profiler_region);
+
 	// Traverse event queue
 	for (;;)
 	{
@@ -379,6 +424,11 @@ void Core::Writeback()
 
 void Core::Commit()
 {
+	// Host time of the stage
+	static esim::ProfilerRegion *profiler_region =
+			esim::Profiler::getRegion("x86.Commit");
+	esim::ProfilerScope profiler_scope(profiler_region);
+
 	// Check type of commit
 	switch (Cpu::getCommitKind())
 	{
@@ -461,5 +511,123 @@ void Core::Run()
 	Fetch();
 }
 
+
+void Core::RunStages()
+{
+	// Run all stages but fetch in reverse order
+	assert(pending_memory_accesses.empty());
+	assert(pending_evicted_contexts.empty());
+	commit_deferred = true;
+	Commit();
+	Writeback();
+	Issue();
+	Dispatch();
+	Decode();
+	commit_deferred = false;
+}
+
+
+void Core::FinishCycle()
+{
+	// Contexts evicted in the commit stage
+	for (Context *context : pending_evicted_contexts)
+		DeallocateContext(context);
+	pending_evicted_contexts.clear();
+
+	// Memory accesses from the issue stage
+	for (auto &access : pending_memory_accesses)
+		cpu->MemoryAccess(access.module,
+				access.access_type,
+				access.address,
+				access.uop);
+	pending_memory_accesses.clear();
+
+	// Commit stall, reported once the state of the core is final
+	if (pending_stalled_thread)
+	{
+		CommitStall(pending_stalled_thread);
+		pending_stalled_thread = nullptr;
+	}
+
+	// Simulation end
+	if (!pending_finish_reason.empty())
+	{
+		Finish(pending_finish_reason);
+		pending_finish_reason.clear();
+	}
+
+	// Fetch stage
+	Fetch();
+}
+
+
+void Core::MemoryAccess(mem::Module *module,
+		mem::Module::AccessType access_type,
+		unsigned address,
+		std::shared_ptr<Uop> uop)
+{
+	// Record the access if running concurrently with other cores
+	if (commit_deferred)
+	{
+		pending_memory_accesses.push_back({module, access_type,
+				address, uop});
+		return;
+	}
+
+	// Access memory system
+	cpu->MemoryAccess(module, access_type, address, uop);
+}
+
+
+void Core::DeallocateContext(Context *context)
+{
+	// Clearing the allocation state raises the emulator's scheduling
+	// signal, which is shared by all cores.
+	if (commit_deferred)
+		pending_evicted_contexts.push_back(context);
+	else
+		context->clearState(Context::StateAlloc);
+}
+
+
+void Core::CommitStall(Thread *thread)
+{
+	// Record the first stalled thread if running concurrently with other
+	// cores, whose output would be interleaved with this one
+	if (commit_deferred)
+	{
+		if (!pending_stalled_thread)
+			pending_stalled_thread = thread;
+		return;
+	}
+
+	// Show warning
+	misc::Warning("[x86] %s: simulation ended due to a commit "
+			"stall.\n\t%s",
+			thread->getName().c_str(),
+			Thread::commit_stall_error);
+
+	// Print state of the core
+	std::cerr << *this;
+
+	// Finish simulation
+	Finish("Stall");
+}
+
+
+void Core::Finish(const std::string &reason)
+{
+	// Record reason if running concurrently with other cores
+	if (commit_deferred)
+	{
+		pending_finish_reason = reason;
+		return;
+	}
+
+	// Finish simulation
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	esim_engine->Finish(reason);
+}
+
 }
 
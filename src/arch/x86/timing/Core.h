@@ -25,6 +25,7 @@
 #include <string>
 
 #include <arch/x86/emulator/Uinst.h>
+#include <memory/Module.h>
 
 #include "Alu.h"
 #include "Thread.h"
@@ -156,6 +157,9 @@ private:
 	// Number of committed micro-instructions
 	long long num_committed_uinsts = 0;
 
+	// Number of committed macro-instructions
+	long long num_committed_instructions = 0;
+
 	// Number of squashed micro-instructions
 	long long num_squashed_uinsts = 0;
 
@@ -190,6 +194,47 @@ private:
 	long long num_xmm_register_reads = 0;
 	long long num_xmm_register_writes = 0;
 
+
+
+
+	//
+	// Parallel simulation
+	//
+
+	// Memory access requested while the core runs concurrently with
+	// other cores
+	struct PendingMemoryAccess
+	{
+		// Module to access
+		mem::Module *module;
+
+		// Access type
+		mem::Module::AccessType access_type;
+
+		// Physical address
+		unsigned address;
+
+		// Uop performing the access
+		std::shared_ptr<Uop> uop;
+	};
+
+	// True while RunStages() is running. Interactions with other cores
+	// are recorded and replayed in FinishCycle().
+	bool commit_deferred = false;
+
+	// Memory accesses recorded by RunStages(), in program order
+	std::vector<PendingMemoryAccess> pending_memory_accesses;
+
+	// Contexts evicted during RunStages() whose state must still be
+	// updated in the emulator
+	std::vector<Context *> pending_evicted_contexts;
+
+	// Reason to finish the simulation found during RunStages(), or empty
+	std::string pending_finish_reason;
+
+	// Thread that stalled the commit stage during RunStages(), or null
+	Thread *pending_stalled_thread = nullptr;
+
 public:
 
 	/// Constructor
@@ -382,6 +427,40 @@ public:
 	/// Run one simulation cycle for all pipeline stages of the core.
 	void Run();
 
+	/// Run one simulation cycle for all pipeline stages of the core
+	/// except fetch, which runs the functional emulation. Memory
+	/// accesses, context evictions, and simulation end requests are
+	/// recorded instead of applied, so this function can run concurrently
+	/// for different cores.
+	void RunStages();
+
+	/// Replay the interactions recorded by RunStages() and run the fetch
+	/// stage. Must be called sequentially for all cores in order.
+	void FinishCycle();
+
+	/// Return whether interactions with other cores are currently being
+	/// recorded instead of applied.
+	bool isCommitDeferred() const { return commit_deferred; }
+
+	/// Perform a memory access on behalf of a uop of this core. See
+	/// Cpu::MemoryAccess() for details.
+	void MemoryAccess(mem::Module *module,
+			mem::Module::AccessType access_type,
+			unsigned address,
+			std::shared_ptr<Uop> uop);
+
+	/// Clear the allocation state of a context that was just evicted
+	/// from one of the core's threads.
+	void DeallocateContext(Context *context);
+
+	/// Show a warning with the state of the core and finish the
+	/// simulation, after a thread has not committed any instruction for
+	/// too long.
+	void CommitStall(Thread *thread);
+
+	/// Finish the simulation with the given reason
+	void Finish(const std::string &reason);
+
 	/// Fetch stage
 	void Fetch();
 
@@ -591,6 +670,15 @@ public:
 		return num_xmm_register_writes;
 	}
 
+	/// Increment the number of committed macro-instructions
+	void incNumCommittedInstructions() { num_committed_instructions++; }
+
+	/// Return the number of committed macro-instructions
+	long long getNumCommittedInstructions() const
+	{
+		return num_committed_instructions;
+	}
+
 	/// Increment the number of squashed micro-instructions
 	void incNumSquashedUinsts() { num_squashed_uinsts++; }
 
@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include "Cpu.h"
 #include "Timing.h"
 
@@ -78,6 +80,7 @@ int Cpu::context_quantum;
 int Cpu::thread_quantum;
 int Cpu::thread_switch_penalty;
 long long Cpu::num_fast_forward_instructions;
+int Cpu::num_host_threads = 1;
 long long Cpu::max_cycles = 0;
 int Cpu::recover_penalty;
 Cpu::RecoverKind Cpu::recover_kind;
@@ -124,6 +127,11 @@ Cpu::Cpu(Timing *timing) : timing(timing)
 	cores.reserve(num_cores);
 	for (int i = 0; i < num_cores; i++)
 		cores.emplace_back(misc::new_unique<Core>(this, i));
+
+	// Create host threads
+	if (num_host_threads > 1 && num_cores > 1)
+		worker_pool = misc::new_unique<misc::WorkerPool>(
+				std::min(num_host_threads, num_cores));
 }
 
 
@@ -181,9 +189,25 @@ void Cpu::Run()
 	// Invoke scheduler
 	Schedule();
 
-	// Run all cores
+	// Run all cores sequentially. Traces and debug output are produced
+	// in pipeline order, so they also force sequential simulation.
+	if (!worker_pool || Timing::trace || Emulator::context_debug ||
+			RegisterFile::debug || TraceCache::debug)
+	{
+		for (auto &core : cores)
+			core->Run();
+		return;
+	}
+
+	// Run all pipeline stages but fetch in parallel
+	worker_pool->Run(cores.size(), [this](int index)
+	{
+		cores[index]->RunStages();
+	});
+
+	// Replay interactions with other cores and fetch, in core order
 	for (auto &core : cores)
-		core->Run();
+		core->FinishCycle();
 }
 
 
@@ -235,6 +259,106 @@ void Cpu::MemoryAccessHandler(esim::Event *event, esim::Frame *esim_frame)
 }
 
 
+void Cpu::SumUinstArrays(long long *array,
+		const long long *(Core::*getter)() const) const
+{
+	std::fill(array, array + Uinst::OpcodeCount, 0);
+	for (auto &core : cores)
+	{
+		const long long *core_array = (core.get()->*getter)();
+		for (int i = 0; i < Uinst::OpcodeCount; i++)
+			array[i] += core_array[i];
+	}
+}
+
+
+const long long *Cpu::getNumDispatchedUinstArray() const
+{
+	SumUinstArrays(num_dispatched_uinst_array,
+			&Core::getNumDispatchedUinstArray);
+	return num_dispatched_uinst_array;
+}
+
+
+long long Cpu::getNumDispatchedUinsts() const
+{
+	long long count = 0;
+	for (auto &core : cores)
+		count += core->getNumDispatchedUinsts();
+	return count;
+}
+
+
+const long long *Cpu::getNumIssuedUinstArray() const
+{
+	SumUinstArrays(num_issued_uinst_array,
+			&Core::getNumIssuedUinstArray);
+	return num_issued_uinst_array;
+}
+
+
+long long Cpu::getNumIssuedUinsts() const
+{
+	long long count = 0;
+	for (auto &core : cores)
+		count += core->getNumIssuedUinsts();
+	return count;
+}
+
+
+const long long *Cpu::getNumCommittedUinstArray() const
+{
+	SumUinstArrays(num_committed_uinst_array,
+			&Core::getNumCommittedUinstArray);
+	return num_committed_uinst_array;
+}
+
+
+long long Cpu::getNumCommittedUinsts() const
+{
+	long long count = 0;
+	for (auto &core : cores)
+		count += core->getNumCommittedUinsts();
+	return count;
+}
+
+
+long long Cpu::getNumSquashedUinsts() const
+{
+	long long count = 0;
+	for (auto &core : cores)
+		count += core->getNumSquashedUinsts();
+	return count;
+}
+
+
+long long Cpu::getNumCommittedInstructions() const
+{
+	long long count = 0;
+	for (auto &core : cores)
+		count += core->getNumCommittedInstructions();
+	return count;
+}
+
+
+long long Cpu::getNumBranches() const
+{
+	long long count = 0;
+	for (auto &core : cores)
+		count += core->getNumBranches();
+	return count;
+}
+
+
+long long Cpu::getNumMispredictedBranches() const
+{
+	long long count = 0;
+	for (auto &core : cores)
+		count += core->getNumMispredictedBranches();
+	return count;
+}
+
+
 long long Cpu::getCycle() const
 {
 	return timing->getCycle();
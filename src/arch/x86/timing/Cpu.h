@@ -24,6 +24,7 @@
 #include <list>
 #include <vector>
 
+#include <lib/cpp/WorkerPool.h>
 #include <memory/Mmu.h>
 #include <memory/Module.h>
 #include <arch/x86/emulator/Emulator.h>
@@ -136,6 +137,10 @@ public:
 	// Maximum number of cycles to simulate
 	static long long max_cycles;
 
+	// Number of host threads used to simulate cores, set with option
+	// '--x86-host-threads'
+	static int num_host_threads;
+
 
 private:
 
@@ -176,6 +181,10 @@ private:
 	// Array of cores 
 	std::vector<std::unique_ptr<Core>> cores;
 
+	// Pool of host threads running the pipeline stages of cores in
+	// parallel, or nullptr if cores are simulated sequentially
+	std::unique_ptr<misc::WorkerPool> worker_pool;
+
 	// MMU used by this CPU
 	std::shared_ptr<mem::Mmu> mmu;
 
@@ -195,36 +204,15 @@ private:
 	// Number of fectched micro-instructions
 	long long num_fetched_uinsts = 0;
 
-	// Number of dispatched micro-instructions for every opcode
-	long long num_dispatched_uinst_array[Uinst::OpcodeCount] = { };
-
-	// Number of issued micro-instructions for every opcode
-	long long num_issued_uinst_array[Uinst::OpcodeCount] = { };
-
-	// Number of committed micro-instructions for every opcode
-	long long num_committed_uinst_array[Uinst::OpcodeCount] = { };
-
-	// Number of dispatched micro-instructions
-	long long num_dispatched_uinsts = 0;
-
-	// Number of issued micro-instructions
-	long long num_issued_uinsts = 0;
-
-	// Number of committed micro-instructions
-	long long num_committed_uinsts = 0;
-
-
-	// Committed macro-instructions
-	long long num_committed_instructions = 0;
+	// Per-opcode counters aggregated from all cores, updated when
+	// requested by the getters
+	mutable long long num_dispatched_uinst_array[Uinst::OpcodeCount] = { };
+	mutable long long num_issued_uinst_array[Uinst::OpcodeCount] = { };
+	mutable long long num_committed_uinst_array[Uinst::OpcodeCount] = { };
 
-	// Number of squashed micro-instructions
-	long long num_squashed_uinsts = 0;
-
-	// Number of branch micro-instructions
-	long long num_branches = 0;
-
-	// Number of mis-predicted branch micro-instructions
-	long long num_mispredicted_branches = 0;
+	// Add up the per-opcode counters of all cores into an array
+	void SumUinstArrays(long long *array,
+			const long long *(Core::*getter)() const) const;
 
 
 
@@ -541,89 +529,36 @@ public:
 	/// Increment the number of fetched micro-instructions
 	void incNumFetchedUinsts() { num_fetched_uinsts++; }
 
-	/// Increment the number of dispatched micro-instructions of a kind
-	void incNumDispatchedUinsts(Uinst::Opcode opcode)
-	{
-		assert(opcode < Uinst::OpcodeCount);
-		num_dispatched_uinst_array[opcode]++;
-		num_dispatched_uinsts++;
-	}
-
-	/// Return the array of dispatched micro-instructions
-	const long long *getNumDispatchedUinstArray() const
-	{
-		return num_dispatched_uinst_array;
-	}
+	/// Return the array of dispatched micro-instructions of each kind,
+	/// added up for all cores
+	const long long *getNumDispatchedUinstArray() const;
 
 	/// Return the number of dispatched micro-instructions
-	long long getNumDispatchedUinsts() const
-	{
-		return num_dispatched_uinsts;
-	}
+	long long getNumDispatchedUinsts() const;
 
-	/// Increment the number of issued micro-instructions of a kind
-	void incNumIssuedUinsts(Uinst::Opcode opcode)
-	{
-		assert(opcode < Uinst::OpcodeCount);
-		num_issued_uinst_array[opcode]++;
-		num_issued_uinsts++;
-	}
-
-	/// Return the array of issued micro-instructions
-	const long long *getNumIssuedUinstArray() const
-	{
-		return num_issued_uinst_array;
-	}
+	/// Return the array of issued micro-instructions of each kind
+	const long long *getNumIssuedUinstArray() const;
 
 	/// Return the number of issued micro-instructions
-	long long getNumIssuedUinsts() const
-	{
-		return num_issued_uinsts;
-	}
-
-	/// Increment the number of committed micro-instructions of a type
-	void incNumCommittedUinsts(Uinst::Opcode opcode)
-	{
-		assert(opcode < Uinst::OpcodeCount);
-		num_committed_uinst_array[opcode]++;
-		num_committed_uinsts++;
-	}
+	long long getNumIssuedUinsts() const;
 
-	/// Return the array of committed micro-instructions
-	const long long *getNumCommittedUinstArray() const
-	{
-		return num_committed_uinst_array;
-	}
+	/// Return the array of committed micro-instructions of each kind
+	const long long *getNumCommittedUinstArray() const;
 
 	/// Return the number of committed micro-instructions
-	long long getNumCommittedUinsts() const
-	{
-		return num_committed_uinsts;
-	}
-
-	/// Increment the number of squashed micro-instructions
-	void incNumSquashedUinsts() { num_squashed_uinsts++; }
+	long long getNumCommittedUinsts() const;
 
 	/// Return the number of squashed micro-instructions
-	long long getNumSquashedUinsts() const { return num_squashed_uinsts; }
+	long long getNumSquashedUinsts() const;
 
-	/// Increment the number of committed instructions
-	void incNumCommittedInstructions() { num_committed_instructions++; }
-	
 	/// Return the number of committed macro-instructions
-	long long getNumCommittedInstructions() const { return num_committed_instructions; }
-
-	/// Increment the number of branches
-	void incNumBranches() { num_branches++; }
+	long long getNumCommittedInstructions() const;
 
 	/// Return the number of committed branches
-	long long getNumBranches() const { return num_branches; }
-
-	/// Increment the number of mispredicted branches
-	void incNumMispredictedBranches() { num_mispredicted_branches++; }
+	long long getNumBranches() const;
 
 	/// Return the number of mispredicted branches
-	long long getNumMispredictedBranches() const { return num_mispredicted_branches; }
+	long long getNumMispredictedBranches() const;
 };
 
 }
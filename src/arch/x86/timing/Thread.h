@@ -282,6 +282,9 @@ private:
 	// Number of committed micro-instructions
 	long long num_committed_uinsts = 0;
 
+	// Number of committed x86 instructions
+	long long num_committed_instructions = 0;
+
 	// Number of dispatched micro-instructions for every opcode
 	long long num_dispatched_uinst_array[Uinst::OpcodeCount] = { };
 
@@ -379,6 +382,9 @@ public:
 	/// Return the thread's register file
 	RegisterFile *getRegisterFile() const { return register_file.get(); }
 
+	/// Return the thread's branch predictor
+	BranchPredictor *getBranchPredictor() const { return branch_predictor.get(); }
+
 	/// Increment the number of writes to integer registers
 	void incNumIntegerRegisterWrites(int count = 1)
 	{
@@ -672,6 +678,12 @@ public:
 		return num_committed_uinsts;
 	}
 
+	/// Return the number of committed x86 instructions
+	long long getNumCommittedInstructions() const
+	{
+		return num_committed_instructions;
+	}
+
 	/// Return the number of squashed micro-instructions
 	long long getNumSquashedUinsts() const { return num_squashed_uinsts; }
 
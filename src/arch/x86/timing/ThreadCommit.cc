@@ -42,20 +42,7 @@ bool Thread::canCommit()
 	if (!context || !context->getState(Context::StateRunning))
 		last_commit_cycle = cycle;
 	if (cycle - last_commit_cycle > 1000000)
-	{
-		// Show warning
-		misc::Warning("[x86] %s: simulation ended due to a commit "
-				"stall.\n\t%s",
-				name.c_str(),
-				commit_stall_error);
-
-		// Print state of the core
-		std::cerr << *core;
-
-		// Finish simulation
-		esim::Engine *esim_engine = esim::Engine::getInstance();
-		esim_engine->Finish("Stall");
-	}
+		core->CommitStall(this);
 
 	// If there is no instruction in the reorder buffer, cannot commit
 	if (reorder_buffer.empty())
@@ -128,9 +115,11 @@ void Thread::Commit(int quantum)
 		// Record committed uops of each kind
 		incNumCommittedUinsts(uop->getOpcode());
 		core->incNumCommittedUinsts(uop->getOpcode());
-		cpu->incNumCommittedUinsts(uop->getOpcode());
 		if (!uop->mop_index)
-			cpu->incNumCommittedInstructions();
+		{
+			num_committed_instructions++;
+			core->incNumCommittedInstructions();
+		}
 
 		// Trace cache statistics
 		if (uop->from_trace_cache)
@@ -142,14 +131,12 @@ void Thread::Commit(int quantum)
 			// Number of branches
 			num_branches++;
 			core->incNumBranches();
-			cpu->incNumBranches();
 
 			// Mispredicted branches
 			if (uop->neip != uop->predicted_neip)
 			{
 				num_mispredicted_branches++;
 				core->incNumMispredictedBranches();
-				cpu->incNumMispredictedBranches();
 			}
 		}
 
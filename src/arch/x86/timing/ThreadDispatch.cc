@@ -113,7 +113,6 @@ int Thread::Dispatch(int quantum)
 		// kind
 		incNumDispatchedUinsts(uop->getOpcode());
 		core->incNumDispatchedUinsts(uop->getOpcode());
-		cpu->incNumDispatchedUinsts(uop->getOpcode());
 		
 		// Increment number of dispatched micro-instructions coming from
 		// the trace cache
@@ -52,7 +52,7 @@ int Thread::IssueLoadQueue(int quantum)
 		ExtractFromLoadQueue(uop.get());
 
 		// Access memory system
-		cpu->MemoryAccess(data_module,
+		core->MemoryAccess(data_module,
 				mem::Module::AccessLoad,
 				uop->physical_address,
 				uop);
@@ -64,7 +64,6 @@ int Thread::IssueLoadQueue(int quantum)
 		// Increment the number of issued instructions of this kind
 		incNumIssuedUinsts(uop->getOpcode());
 		core->incNumIssuedUinsts(uop->getOpcode());
-		cpu->incNumIssuedUinsts(uop->getOpcode());
 
 		// Increment number of reads from load-store-queue
 		num_load_store_queue_reads++;
@@ -130,7 +129,7 @@ int Thread::IssueStoreQueue(int quantum)
 		ExtractFromStoreQueue(uop.get());
 
 		// Issue store to memory system
-		cpu->MemoryAccess(data_module,
+		core->MemoryAccess(data_module,
 				mem::Module::AccessStore,
 				uop->physical_address,
 				uop);
@@ -142,7 +141,6 @@ int Thread::IssueStoreQueue(int quantum)
 		// Increment the number of issued instructions of this kind
 		incNumIssuedUinsts(uop->getOpcode());
 		core->incNumIssuedUinsts(uop->getOpcode());
-		cpu->incNumIssuedUinsts(uop->getOpcode());
 
 		// Increment number of reads from load-store-queue
 		num_load_store_queue_reads++;
@@ -227,7 +225,6 @@ int Thread::IssueInstructionQueue(int quantum)
 		// Increment the number of issued instructions of this kind
 		incNumIssuedUinsts(uop->getOpcode());
 		core->incNumIssuedUinsts(uop->getOpcode());
-		cpu->incNumIssuedUinsts(uop->getOpcode());
 
 		// Increment number of reads from instruction queue
 		num_instruction_queue_reads++;
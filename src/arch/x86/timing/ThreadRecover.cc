@@ -194,7 +194,6 @@ void Thread::Recover()
 		// Statistics
 		num_squashed_uinsts++;
 		core->incNumSquashedUinsts();
-		cpu->incNumSquashedUinsts();
 		if (uop->from_trace_cache)
 			trace_cache->incNumSquashedUinsts();
 
@@ -191,7 +191,7 @@ void Thread::EvictContext()
 	assert(context->evict_signal);
 
 	// Update context state
-	context->clearState(Context::StateAlloc);
+	core->DeallocateContext(context);
 	context->evict_cycle = cpu->getCycle();
 	context->evict_signal = 0;
 
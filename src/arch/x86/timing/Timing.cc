@@ -213,7 +213,8 @@ const std::string Timing::help_message =
 		"\n"
 		"Section '[ BranchPredictor ]':\n"
 		"\n"
-		"  Kind = {Perfect|Taken|NotTaken|Bimodal|TwoLevel|Combined} (Default = TwoLevel)\n"
+		"  Kind = {Perfect|Taken|NotTaken|Bimodal|TwoLevel|Combined|TAGE|Perceptron}\n"
+		"      (Default = TwoLevel)\n"
 		"      Branch predictor type.\n"
 		"  BTB.Sets = <num_sets> (Default = 256)\n"
 		"      Number of sets in the BTB.\n"
@@ -231,6 +232,38 @@ const std::string Timing::help_message =
 		"      For the two-level adaptive predictor, level 2 size.\n"
 		"  TwoLevel.HistorySize = <size> (Default = 8)\n"
 		"      For the two-level adaptive predictor, level 2 history size.\n"
+		"  Tage.NumTables = <num> (Default = 4)\n"
+		"      Number of tagged tables of the TAGE predictor (maximum 16).\n"
+		"  Tage.TableSize = <entries> (Default = 1024)\n"
+		"      Number of entries of each TAGE tagged table (4 bytes per entry).\n"
+		"  Tage.TagBits = <bits> (Default = 9)\n"
+		"      Number of tag bits in TAGE tagged table entries.\n"
+		"  Tage.MinHistory = <length> (Default = 4)\n"
+		"  Tage.MaxHistory = <length> (Default = 64)\n"
+		"      Global history lengths of the TAGE tables with the shortest and\n"
+		"      longest histories. Tables in between follow a geometric series.\n"
+		"  Tage.BaseSize = <entries> (Default = 4096)\n"
+		"      Number of entries of the bimodal base predictor of TAGE.\n"
+		"  Tage.LoopPredictor = {t|f} (Default = False)\n"
+		"      Add a loop predictor overriding TAGE for loops with a constant\n"
+		"      iteration count.\n"
+		"  Tage.StatisticalCorrector = {t|f} (Default = False)\n"
+		"      Add a statistical corrector reverting low-confidence TAGE\n"
+		"      predictions.\n"
+		"  Loop.Size = <entries> (Default = 64)\n"
+		"      Number of entries of the loop predictor.\n"
+		"  SC.Size = <entries> (Default = 1024)\n"
+		"      Number of counters in each of the 4 statistical corrector tables.\n"
+		"  Perceptron.NumTables = <num> (Default = 8)\n"
+		"      Number of weight tables of the hashed perceptron predictor\n"
+		"      (maximum 16), including the bias table.\n"
+		"  Perceptron.TableSize = <entries> (Default = 1024)\n"
+		"      Number of 8-bit weights in each perceptron table.\n"
+		"  Perceptron.HistoryLength = <length> (Default = 64)\n"
+		"      Global history length covered by the perceptron tables.\n"
+		"  Perceptron.Threshold = <value> (Default = 0)\n"
+		"      Initial training threshold of the perceptron, adapted at\n"
+		"      runtime. Value 0 uses 2.14 * (NumTables + 1) + 20.58.\n"
 		"\n";
 
 const char *Timing::error_fast_forward =
@@ -610,6 +643,21 @@ void Timing::RegisterOptions()
 			"to run.  If this maximum is reached, the simulation "
 			"will finish with the X86MaxCycles string.");
 
+	// Option --x86-host-threads <num>
+	command_line->RegisterInt32("--x86-host-threads <num> (default = 1)",
+			Cpu::num_host_threads,
+			"Number of host threads used to simulate the cores of "
+			"the CPU in a detailed simulation. With more than one "
+			"thread, all pipeline stages except fetch advance in "
+			"parallel for all cores, while memory accesses and "
+			"context evictions are replayed in core order at the "
+			"end of each cycle, followed by the fetch stage of "
+			"each core. Results do not depend on the number of "
+			"threads, but a context woken up by the emulation in "
+			"one core becomes visible to the other cores one "
+			"cycle later than in a sequential simulation. Options "
+			"'--trace' and the x86 debug options force a "
+			"sequential simulation.");
 }
 
 
@@ -620,6 +668,11 @@ void Timing::ProcessOptions()
 	if (!config_file.empty())
 		ini_file.Load(config_file);
 
+	// Number of host threads
+	if (Cpu::num_host_threads < 1)
+		throw Error("Option '--x86-host-threads' must be greater "
+				"than 0");
+
 	// Instantiate timing simulator if '--x86-sim detailed' is present
 	if (sim_kind == comm::Arch::SimDetailed)
 	{
@@ -996,6 +1049,10 @@ void Timing::DumpReport() const
 					/ thread->getNumBranches() : 0.0);
 			os << '\n';
 
+			// Branch predictor
+			thread->getBranchPredictor()->DumpReport(os,
+					thread->getNumCommittedInstructions());
+
 			// Occupancy statistics
 			os << "; Structure statistics (reorder buffer, instruction queue,\n";
 			os << "; load-store queue, integer/floating-point/XMM register file,\n";
@@ -1138,6 +1195,20 @@ void Timing::DumpConfiguration(std::ofstream &os) const
 	os << misc::fmt("TwoLevel.L2Size = %d\n", BranchPredictor::getTwoLevelL2Size());
 	os << misc::fmt("TwoLevel.L2Height = %d\n", BranchPredictor::getTwoLevelL2Height());
 	os << misc::fmt("TwoLevel.HistorySize = %d\n", BranchPredictor::getTwoLevelHistorySize());
+	os << misc::fmt("Tage.NumTables = %d\n", BranchPredictor::getTageNumTables());
+	os << misc::fmt("Tage.TableSize = %d\n", BranchPredictor::getTageTableSize());
+	os << misc::fmt("Tage.TagBits = %d\n", BranchPredictor::getTageTagBits());
+	os << misc::fmt("Tage.MinHistory = %d\n", BranchPredictor::getTageMinHistory());
+	os << misc::fmt("Tage.MaxHistory = %d\n", BranchPredictor::getTageMaxHistory());
+	os << misc::fmt("Tage.BaseSize = %d\n", BranchPredictor::getTageBaseSize());
+	os << misc::fmt("Tage.LoopPredictor = %s\n", BranchPredictor::getTageLoopPredictor() ? "True" : "False");
+	os << misc::fmt("Tage.StatisticalCorrector = %s\n", BranchPredictor::getTageStatisticalCorrector() ? "True" : "False");
+	os << misc::fmt("Loop.Size = %d\n", BranchPredictor::getLoopSize());
+	os << misc::fmt("SC.Size = %d\n", BranchPredictor::getScSize());
+	os << misc::fmt("Perceptron.NumTables = %d\n", BranchPredictor::getPerceptronNumTables());
+	os << misc::fmt("Perceptron.TableSize = %d\n", BranchPredictor::getPerceptronTableSize());
+	os << misc::fmt("Perceptron.HistoryLength = %d\n", BranchPredictor::getPerceptronHistoryLength());
+	os << misc::fmt("Perceptron.Threshold = %d\n", BranchPredictor::getPerceptronThreshold());
 	os << misc::fmt("\n");
 
 	// End of configuration
@@ -413,6 +413,44 @@ public:
 
 	/// Prediction in the combined branch predictor
 	BranchPredictor::Prediction choice_prediction = BranchPredictor::PredictionNotTaken;
+
+	/// Table indices used by the TAGE or hashed perceptron predictors
+	unsigned short table_index[BranchPredictor::MaxTables];
+
+	/// Tags computed for the TAGE tagged tables
+	unsigned short tage_tag[BranchPredictor::MaxTables];
+
+	/// TAGE table providing the prediction, or -1 for the base predictor
+	int tage_provider = -1;
+
+	/// TAGE table providing the alternate prediction, or -1 for the base
+	/// predictor
+	int tage_alt_provider = -1;
+
+	/// Index in the TAGE base predictor
+	int tage_base_index = 0;
+
+	/// Predictions of the TAGE provider and alternate entries
+	BranchPredictor::Prediction tage_provider_prediction = BranchPredictor::PredictionNotTaken;
+	BranchPredictor::Prediction tage_alt_prediction = BranchPredictor::PredictionNotTaken;
+
+	/// Final TAGE prediction, before the loop predictor and the
+	/// statistical corrector
+	BranchPredictor::Prediction tage_prediction = BranchPredictor::PredictionNotTaken;
+
+	/// Loop predictor entry index, and whether it provided a confident
+	/// prediction
+	int loop_index = 0;
+	bool loop_valid = false;
+	bool loop_hit = false;
+	BranchPredictor::Prediction loop_prediction = BranchPredictor::PredictionNotTaken;
+
+	/// Statistical corrector table indices and sum of its counters
+	unsigned short sc_index[BranchPredictor::ScNumTables];
+	int sc_sum = 0;
+
+	/// Sum of the hashed perceptron weights
+	int perceptron_sum = 0;
 	
 	
 	
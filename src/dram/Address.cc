@@ -17,8 +17,6 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 
-#include <cmath>
-
 #include <lib/cpp/String.h>
 
 #include "Address.h"
@@ -27,6 +25,24 @@
 namespace dram
 {
 
+misc::StringMap AddressFieldMap
+{
+	{ "Controller", AddressFieldController },
+	{ "Channel", AddressFieldChannel },
+	{ "Rank", AddressFieldRank },
+	{ "Bank", AddressFieldBank },
+	{ "Row", AddressFieldRow },
+	{ "Column", AddressFieldColumn },
+	{ "ColumnHigh", AddressFieldColumnHigh },
+	{ "ColumnLow", AddressFieldColumnLow }
+};
+
+misc::StringMap BankHashTypeMap
+{
+	{ "None", BankHashNone },
+	{ "Xor", BankHashXor }
+};
+
 
 Address::Address(long long encoded)
 		:
@@ -42,43 +58,47 @@ void Address::DecodeAddress()
 	// Get the DRAM system.
 	System *dram = System::getInstance();
 
-	// Get the sizes of each address component in number of bits required
-	// to represent it.
-	int physical_size = dram->getPhysicalSize();
-	int logical_size = dram->getLogicalSize();
-	int rank_size = dram->getRankSize();
-	int bank_size = dram->getBankSize();
-	int row_size = dram->getRowSize();
-	int column_size = dram->getColumnSize();
-
 	// Make a local copy of the address.  Don't use the one in the address
 	// struct because it will be altered during decoding.
 	long long decoding = encoded;
 
-	// Step through the address to parse out the components.
-	// This will be configurable, but for now the address mapping is
-	// (from MSB to LSB) physical:logical:rank:bank:row:column.
-	column = decoding & int(pow(2, column_size) - 1);
-	// Step to row.
-	decoding >>= column_size;
-	row = decoding & int(pow(2, row_size) - 1);
-	// Step to bank.
-	decoding >>= row_size;
-	bank = decoding & int(pow(2, bank_size) - 1);
-	// Step to rank.
-	decoding >>= bank_size;
-	rank = decoding & int(pow(2, rank_size) - 1);
-	// Step to logical.
-	decoding >>= rank_size;
-	logical = decoding & int(pow(2, logical_size) - 1);
-	// Step to physical.
-	decoding >>= logical_size;
-	physical = decoding & int(pow(2, physical_size) - 1);
+	// Step through the address fields, from LSB to MSB, to parse out the
+	// components.
+	int column_low = 0;
+	int column_low_size = 0;
+	physical = logical = rank = bank = row = column = 0;
+	for (AddressField field : dram->getAddressFields())
+	{
+		int size = dram->getAddressFieldSize(field);
+		int value = decoding & ((1LL << size) - 1);
+		decoding >>= size;
+		switch (field)
+		{
+		case AddressFieldController: physical = value; break;
+		case AddressFieldChannel: logical = value; break;
+		case AddressFieldRank: rank = value; break;
+		case AddressFieldBank: bank = value; break;
+		case AddressFieldRow: row = value; break;
+		case AddressFieldColumn: column = value; break;
+		case AddressFieldColumnHigh: column = value; break;
+		case AddressFieldColumnLow:
+			column_low = value;
+			column_low_size = size;
+			break;
+		default:
+			throw misc::Panic("Invalid address field");
+		}
+	}
+
+	// Join the two parts of the column. The high part is decoded to the
+	// column above.
+	column = (column << column_low_size) | column_low;
+
+	// Permutation-based interleaving
+	if (dram->getBankHash() == BankHashXor)
+		bank ^= row & ((1 << dram->getBankSize()) - 1);
 
 	// Debug
-	// System::debug << misc::fmt("Sizes: %d, %d, %d, %d, %d, %d\n",
-	// 		physical_size, logical_size, rank_size, bank_size,
-	// 		row_size, column_size);
 	// dump(System::debug);
 }
 
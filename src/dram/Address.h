@@ -22,10 +22,42 @@
 
 #include <iostream>
 
+#include <lib/cpp/String.h>
+
 
 namespace dram
 {
 
+/// Fields of an encoded address. The column can either be one field, or be
+/// split into its high bits and the low bits that address the columns of one
+/// cache line.
+enum AddressField
+{
+	AddressFieldInvalid = 0,
+	AddressFieldController,
+	AddressFieldChannel,
+	AddressFieldRank,
+	AddressFieldBank,
+	AddressFieldRow,
+	AddressFieldColumn,
+	AddressFieldColumnHigh,
+	AddressFieldColumnLow
+};
+
+/// String map for AddressField
+extern misc::StringMap AddressFieldMap;
+
+/// Bank hashing schemes
+enum BankHashType
+{
+	BankHashNone = 0,
+	BankHashXor
+};
+
+/// String map for BankHashType
+extern misc::StringMap BankHashTypeMap;
+
+
 class Address
 {
 	// Encoded address
@@ -43,9 +75,11 @@ class Address
 	/// them in the class.  The encoded address is taken from the class's
 	/// encoded member
 	///
-	/// For now, this decodes in the order:
+	/// The order of the fields is given by the address mapping of the
+	/// DRAM system, which defaults to
 	/// 	physical:logical:rank:bank:row:column.
-	/// This will eventually be configurable.
+	/// With XOR bank hashing, the bank is XORed with the low bits of the
+	/// row, so that rows conflicting in one bank spread over all banks.
 	void DecodeAddress();
 
 public:
@@ -54,6 +54,9 @@ void Bank::setLastScheduledCommand(CommandType type)
 
 	// Make the rank that this bank belongs to do the same update.
 	rank->setLastScheduledCommand(type);
+
+	// The commands waiting in other banks may have to wait longer now.
+	rank->getChannel()->UpdateReadyCycles(this);
 }
 
 
@@ -61,6 +64,71 @@ void Bank::ProcessRequest(std::shared_ptr<Request> request)
 {
 	// Get the current cycle.
 	long long cycle = System::frequency_domain->getCycle();
+	num_requests++;
+
+	// Under the FR-FCFS scheduler, wait in the request queue for the
+	// command queue to empty. Otherwise, break the request down right away.
+	Channel *channel = getRank()->getChannel();
+	if (channel->getSchedulerType() == SchedulerFRFCFS)
+	{
+		request_queue.push_back({request, cycle});
+		if (command_queue.empty())
+			ProcessNextRequest();
+	}
+	else
+	{
+		CreateCommands(request, cycle);
+	}
+
+	// Ensure the scheduler is running.
+	channel->UpdateBank(this);
+	channel->CallScheduler();
+
+	// Debug
+	System::debug << misc::fmt("[%lld] Processed request for 0x%llx in "
+			"bank %d\n", cycle,
+			request->getAddress()->getEncoded(), id);
+}
+
+
+void Bank::ProcessNextRequest()
+{
+	// Oldest request by default
+	auto it = request_queue.begin();
+
+	// Look for the oldest request accessing the row that will be open,
+	// unless the oldest request has been bypassed too many times already.
+	// With the closed page policy, rows are never left open.
+	int row_hit_cap = getRank()->getChannel()->getController()->
+			getRowHitCap();
+	if (num_row_hits_bypassing < row_hit_cap && !isPrechargedFuture())
+	{
+		for (auto i = request_queue.begin(); i != request_queue.end(); ++i)
+		{
+			if (i->request->getAddress()->getRow() == future_active_row)
+			{
+				it = i;
+				break;
+			}
+		}
+	}
+
+	// Count the times that the oldest request has been bypassed
+	if (it == request_queue.begin())
+		num_row_hits_bypassing = 0;
+	else
+		num_row_hits_bypassing++;
+
+	// Break it down into commands
+	CreateCommands(it->request, it->cycle);
+	request_queue.erase(it);
+}
+
+
+void Bank::CreateCommands(std::shared_ptr<Request> request, long long cycle)
+{
+	// Number of commands before the request
+	int num_commands = command_queue.size();
 
 	// Pull the address out of the request.
 	Address *address = request->getAddress();
@@ -141,13 +209,56 @@ void Bank::ProcessRequest(std::shared_ptr<Request> request)
 		future_active_row = -1;
 	}
 
-	// Ensure the scheduler is running.
-	getRank()->getChannel()->CallScheduler();
+	// Record the new commands in the rank.
+	rank->AddCommands(command_queue.size() - num_commands);
+}
+
+
+void Bank::AddRefresh()
+{
+	// Get the current cycle.
+	long long cycle = System::frequency_domain->getCycle();
+	int num_commands = command_queue.size();
+
+	// The refresh goes ahead of all queued commands, which work on the
+	// row that is open now. A precharge at the front is no longer needed,
+	// and a read or write at the front needs its row activated again.
+	// The refresh takes the age of the front command, so that schedulers
+	// do not put it off behind older commands of other banks.
+	long long cycle_created = cycle;
+	if (!command_queue.empty())
+	{
+		std::shared_ptr<Command> front = command_queue.front();
+		cycle_created = front->getCycleCreated();
+		if (front->getType() == CommandPrecharge)
+			command_queue.pop_front();
+		else if (front->getType() == CommandRead ||
+				front->getType() == CommandWrite)
+			command_queue.push_front(std::make_shared<Command>(
+					front->getRequest(), CommandActivate,
+					front->getCycleCreated(), this));
+	}
+
+	// The bank stays precharged if there are no other commands.
+	if (command_queue.empty())
+		future_active_row = -1;
+
+	// Close the open row, if any, and refresh the bank. Refresh commands
+	// are not created for a request.
+	command_queue.push_front(std::make_shared<Command>(
+			nullptr, CommandRefresh, cycle_created, this));
+	if (!isPrecharged())
+		command_queue.push_front(std::make_shared<Command>(
+				nullptr, CommandPrecharge, cycle_created, this));
+
+	// Record the new commands and ensure the scheduler is running.
+	rank->AddCommands(command_queue.size() - num_commands);
+	rank->getChannel()->UpdateBank(this);
+	rank->getChannel()->CallScheduler();
 
 	// Debug
-	System::debug << misc::fmt("[%lld] Processed request for 0x%llx in "
-			"bank %d\n", cycle,
-			address->getEncoded(), id);
+	System::debug << misc::fmt("[%lld] Added refresh in bank %d : %d\n",
+			cycle, rank->getId(), id);
 }
 
 
@@ -168,6 +279,16 @@ void Bank::RunFrontCommand()
 	// Add this command to the last scheduled command matrix.
 	setLastScheduledCommand(command->getType());
 
+	// Update the active row and record the command in the rank.
+	bool was_open = !isPrecharged();
+	if (command->getType() == CommandActivate)
+		current_active_row = command->getAddress()->getRow();
+	else if (command->getType() == CommandPrecharge ||
+			command->getType() == CommandRefresh)
+		current_active_row = -1;
+	rank->RecordCommand(command->getType(), command->getDuration(),
+			(int) !isPrecharged() - (int) was_open);
+
 	// Get the esim engine instance.
 	esim::Engine *esim = esim::Engine::getInstance();
 
@@ -177,13 +298,17 @@ void Bank::RunFrontCommand()
 			command->getDuration());
 
 	// Debug
-	System::activity << misc::fmt("[%lld] [%d : %d] Running command #%d "
-			"%s for 0x%llx\n", cycle, rank->getId(), id,
-			command->getId(), command->getTypeString().c_str(),
-			command->getAddress()->getEncoded());
+	System::activity << misc::fmt("[%lld] [%d : %d] Running command "
+			"%s\n", cycle, rank->getId(), id,
+			command->getDescription().c_str());
 
 	// Command is being run, remove it from the queue.
 	command_queue.pop_front();
+
+	// Break down the next pending request, if any
+	if (command_queue.empty() && !request_queue.empty())
+		ProcessNextRequest();
+	rank->getChannel()->UpdateBank(this);
 }
 
 
@@ -203,6 +328,11 @@ void Bank::dump(std::ostream &os) const
 		os << misc::fmt("\t\t\t\t%d - %s\n", i,
 				command_queue[i]->getTypeString().c_str());
 	}
+
+	// Print the requests waiting to be broken down into commands
+	if (!request_queue.empty())
+		os << misc::fmt("\t\t\t%d Requests in queue\n",
+				(int) request_queue.size());
 }
 
 
@@ -50,9 +50,35 @@ class Bank
 	// Queue of commands to be sent to the Bank
 	std::deque<std::shared_ptr<Command>> command_queue;
 
+	// A request waiting to be broken down into commands, together with
+	// the cycle when it arrived at the bank.
+	struct PendingRequest
+	{
+		std::shared_ptr<Request> request;
+		long long cycle;
+	};
+
+	// Requests waiting in arrival order, only used under the FR-FCFS
+	// scheduler. A request is broken down into commands when the command
+	// queue becomes empty.
+	std::deque<PendingRequest> request_queue;
+
+	// Number of requests received by the bank
+	long long num_requests = 0;
+
+	// Cycle when the command at the front of the queue can run, valid
+	// while the bank is pending in its channel
+	long long ready_cycle = 0;
+
+	// Number of row hits served in a row ahead of the oldest request
+	int num_row_hits_bypassing = 0;
+
 	// Last scheduled command information
 	CommandType last_scheduled_command_type = CommandInvalid;
-	long long last_scheduled_commands[5] = {-100, -100, -100, -100, -100};
+	// The last refresh starts further in the past, since tRFC is longer
+	// than the other timings.
+	long long last_scheduled_commands[6] = {-100, -100, -100, -100, -100,
+			-100000};
 
 	// Current and future row activations.
 	// A value of -1 means the bank is precharged.
@@ -74,6 +100,9 @@ public:
 	/// Returns the rank that this bank belongs to.
 	Rank *getRank() const { return rank; }
 
+	/// Returns the number of requests received by the bank.
+	long long getNumRequests() const { return num_requests; }
+
 	/// Returns the type of the last scheduled command.
 	CommandType getLastScheduledCommandType() const
 	{
@@ -106,12 +135,22 @@ public:
 	/// Returns how many commands are in the queue.
 	int getNumCommandsInQueue() const { return (int) command_queue.size(); }
 
+	/// Returns how many requests are waiting to be broken down into
+	/// commands.
+	int getNumRequestsInQueue() const { return (int) request_queue.size(); }
+
 	/// Returns the command in the queue at a certain position.
 	std::string getCommandInQueueType(int position = 0)
 	{
 		return command_queue[position]->getTypeString();
 	}
 
+	/// Returns the type of the command at the front of the queue.
+	CommandType getFrontCommandType() const
+	{
+		return command_queue.front()->getType();
+	}
+
 	/// Returns the cycle when the command at the front of the queue was
 	/// created.
 	long long getFrontCommandCycleCreated()
@@ -119,17 +158,46 @@ public:
 		return command_queue.front()->getCycleCreated();
 	}
 
+	/// Returns the command at the front of the queue.
+	Command *getFrontCommand() const { return command_queue.front().get(); }
+
 	/// Returns the cycle when the command at the front of the queue will
 	/// be ready to be run.
 	long long getFrontCommandTiming();
 
+	/// Returns the cycle when the command at the front of the queue will
+	/// be ready to be run, as last calculated by the channel. This value
+	/// is only valid while the bank is pending in the channel.
+	long long getReadyCycle() const { return ready_cycle; }
+
+	/// Set the cycle when the command at the front of the queue will be
+	/// ready to be run.
+	void setReadyCycle(long long ready_cycle)
+	{
+		this->ready_cycle = ready_cycle;
+	}
+
 	/// Pops off the top command in the queue.
 	void RunFrontCommand();
 
-	/// Breaks a request down into it's component commands and adds them to the
-	/// bank's command queue.
+	/// Breaks a request down into it's component commands and adds them to
+	/// the bank's command queue. Under the FR-FCFS scheduler, the request
+	/// is queued instead, and requests are broken down one at a time when
+	/// the command queue empties, picking the oldest request that hits in
+	/// the open row before older row misses.
 	void ProcessRequest(std::shared_ptr<Request> request);
 
+	/// Adds the commands for a request arrived in the given cycle to the
+	/// end of the command queue.
+	void CreateCommands(std::shared_ptr<Request> request, long long cycle);
+
+	/// Breaks down the next request from the request queue into commands.
+	void ProcessNextRequest();
+
+	/// Adds a refresh command to the end of the command queue, preceded by
+	/// a precharge command if a row will be open.
+	void AddRefresh();
+
 	/// Dump the object to an output stream.
 	void dump(std::ostream &os = std::cout) const;
 
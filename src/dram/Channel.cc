@@ -45,8 +45,14 @@ Channel::Channel(int id,
 		id(id),
 		controller(parent),
 		num_ranks(num_ranks),
-		num_banks(num_banks)
+		num_banks(num_banks),
+		scheduler_type(scheduler_type)
 {
+	// Bitmaps of banks, initially all empty
+	int num_words = (num_ranks * num_banks + 63) / 64;
+	pending_banks.resize(num_words);
+	row_hit_banks.resize(num_words);
+
 	// Create the ranks for this channel.
 	for (int i = 0; i < num_ranks; i++)
 		ranks.emplace_back(new Rank(i, this, num_banks, num_rows,
@@ -65,10 +71,60 @@ Channel::Channel(int id,
 		scheduler = std::unique_ptr<Scheduler>(
 				new OldestFirst(this));
 		break;
+
+	// Create a First-Ready First-Come-First-Serve scheduler.
+	case SchedulerFRFCFS:
+		scheduler = std::unique_ptr<Scheduler>(
+				new FRFCFS(this));
+		break;
 	}
 }
 
 
+int Channel::getBankIndex(Bank *bank)
+{
+	return bank->getRank()->getId() * num_banks + bank->getId();
+}
+
+
+Bank *Channel::getBank(int index) const
+{
+	return getRank(index / num_banks)->getBank(index % num_banks);
+}
+
+
+void Channel::UpdateBank(Bank *bank)
+{
+	// Position of the bank bit
+	int index = getBankIndex(bank);
+	unsigned long long mask = 1ULL << (index % 64);
+	int word = index / 64;
+
+	// Clear both bits
+	pending_banks[word] &= ~mask;
+	row_hit_banks[word] &= ~mask;
+	if (bank->getNumCommandsInQueue() == 0)
+		return;
+
+	// An all-bank refresh waits for all banks in the rank
+	CommandType type = bank->getFrontCommandType();
+	if (type == CommandRefresh &&
+			controller->getRefreshPolicy() == RefreshPolicyAllBank &&
+			!bank->getRank()->isRefreshReady())
+		return;
+
+	// Pending bank. Reads and writes at the front of the queue always
+	// access the open row, since the activation in front of them has run.
+	pending_banks[word] |= mask;
+	if (type == CommandRead || type == CommandWrite)
+		row_hit_banks[word] |= mask;
+
+	// Cycle when the front command can run, kept up to date by
+	// UpdateReadyCycles() while the bank is pending.
+	bank->setReadyCycle(bank->getFrontCommandTiming());
+}
+
+
 void Channel::CallScheduler(int after)
 {
 	// Get the esim engine instance.
@@ -116,9 +172,11 @@ void Channel::RunScheduler()
 	// Get a pointer to the bank whose front command should be run next.
 	// This is either the result of the scheduling algorithm from a previous
 	// cycle (if timing constraints prevented it from being run then), or
-	// we run the scheduling algorithm again to get the next one.
+	// we run the scheduling algorithm again to get the next one. The bank
+	// from a previous cycle is dropped if a refresh made it wait for the
+	// rest of its rank.
 	Bank *bank = next_scheduled_bank;
-	if (bank == nullptr)
+	if (bank == nullptr || !isBankPending(bank))
 	{
 		bank = scheduler->FindNext();
 
@@ -129,14 +187,20 @@ void Channel::RunScheduler()
 
 	// Check the timing for the command at the front of the selected
 	// bank's queue.
-	long long cycle_ready = bank->getFrontCommandTiming();
+	long long cycle_ready = bank->getReadyCycle();
 
 	// Run the command now if able, otherwise put off running the
 	// command until it is able.
 	if (cycle >= cycle_ready)
 	{
-		// Run the command.
-		bank->RunFrontCommand();
+		// Run the command. An all-bank refresh runs in every bank
+		// of the rank.
+		if (bank->getFrontCommandType() == CommandRefresh &&
+				controller->getRefreshPolicy() ==
+				RefreshPolicyAllBank)
+			bank->getRank()->RunRefresh();
+		else
+			bank->RunFrontCommand();
 		next_scheduled_bank = nullptr;
 
 		// Call the scheduler again for next cycle.
@@ -157,11 +221,30 @@ void Channel::RunScheduler()
 
 long long Channel::CalculateReadyCycle(Command *cmd)
 {
-	// Yes, Rafa, this is ugly.
-
 	// Set the ready cycle to be this cycle.
 	long long ready = System::frequency_domain->getCycle();
 
+	// Wait for the rank to exit power-down.
+	ready = std::max(getRank(cmd->getRankId())->getPowerUpCycle(), ready);
+
+	// Iterate through every rank and bank in the channel.
+	for (int rank_id = 0; rank_id < num_ranks; rank_id++)
+		for (int bank_id = 0; bank_id < num_banks; bank_id++)
+			ready = std::max(CalculateReadyCycle(cmd, rank_id,
+					bank_id), ready);
+
+	// Return the final cycle that the command will be ready to run.
+	return ready;
+}
+
+
+long long Channel::CalculateReadyCycle(Command *cmd, int rank_id, int bank_id)
+{
+	// Yes, Rafa, this is ugly.
+
+	// No constraint by default.
+	long long ready = 0;
+
 	// Get the rank and bank ids of the commands location.
 	int cmd_bank = cmd->getBankId();
 	int cmd_rank = cmd->getRankId();
@@ -169,171 +252,213 @@ long long Channel::CalculateReadyCycle(Command *cmd)
 	// Get the command's type.
 	CommandType cmd_type = cmd->getType();
 
-	// Iterate through every rank and bank in the channel.
-	for (int rank_id = 0; rank_id < num_ranks; rank_id++)
+	// Whether a refresh command covers all banks in the rank.
+	bool all_bank = controller->getRefreshPolicy() == RefreshPolicyAllBank;
+
+	// Get the current rank and bank
+	Rank *rank = getRank(rank_id);
+	Bank *bank = rank->getBank(bank_id);
+
+	switch (cmd_type)
 	{
-		// Get the current rank
-		Rank *rank = getRank(rank_id);
 
-		for (int bank_id = 0; bank_id < num_banks; bank_id++)
+	// All the following statements change the ready cycle
+	// to follow the DRAM timing constraints depending on
+	// when previous commands of certain types were
+	// scheduled to certain locations.
+	// The read cycle to follow each rule is calculated,
+	// and then the max of that cycle and the current ready
+	// cycle is taken and assigned to be the new ready cycle.
+
+	case CommandPrecharge:
+		// The rank and bank are the same as the
+		// new command.
+		if (rank_id == cmd_rank && bank_id == cmd_bank)
+		{
+			// A P s s
+			ready = std::max(bank->getLastScheduledCommand(CommandActivate)
+					+ controller->getTiming(TimingActivate, TimingPrecharge, TimingSame, TimingSame),
+					ready);
+
+			// R P s s
+			ready = std::max(bank->getLastScheduledCommand(CommandRead)
+					+ controller->getTiming(TimingRead, TimingPrecharge, TimingSame, TimingSame),
+					ready);
+
+			// W P s s
+			ready = std::max(bank->getLastScheduledCommand(CommandWrite)
+					+ controller->getTiming(TimingWrite, TimingPrecharge, TimingSame, TimingSame),
+					ready);
+		}
+		break;
+
+	case CommandActivate:
+		// The rank and bank are the same as the
+		// new command.
+		if (rank_id == cmd_rank && bank_id == cmd_bank)
+		{
+			// A A s s
+			ready = std::max(bank->getLastScheduledCommand(CommandActivate)
+					+ controller->getTiming(TimingActivate, TimingActivate, TimingSame, TimingSame),
+					ready);
+
+			// P A s s
+			ready = std::max(bank->getLastScheduledCommand(CommandPrecharge)
+					+ controller->getTiming(TimingPrecharge, TimingActivate, TimingSame, TimingSame),
+					ready);
+
+			// REF A s s
+			ready = std::max(bank->getLastScheduledCommand(CommandRefresh)
+					+ controller->getCommandDuration(CommandRefresh),
+					ready);
+		}
+
+		// The rank is the same as the new command, and
+		// the bank is different.
+		if (rank_id == cmd_rank && bank_id != cmd_bank)
+		{
+			// A A s d
+			ready = std::max(bank->getLastScheduledCommand(CommandActivate)
+					+ controller->getTiming(TimingActivate, TimingActivate, TimingSame, TimingDifferent),
+					ready);
+		}
+		break;
+
+	case CommandRead:
+		// The rank and bank are the same as the
+		// new command.
+		if (rank_id == cmd_rank && bank_id == cmd_bank)
+		{
+			// A R s s
+			ready = std::max(bank->getLastScheduledCommand(CommandActivate)
+					+ controller->getTiming(TimingActivate, TimingRead, TimingSame, TimingSame),
+					ready);
+		}
+
+		// The rank is the same as the new command,
+		// the bank is either the same or different.
+		if (rank_id == cmd_rank)
+		{
+			// R R s a
+			ready = std::max(rank->getLastScheduledCommand(CommandRead)
+					+ controller->getTiming(TimingRead, TimingRead, TimingSame, TimingAny),
+					ready);
+
+			// W R s a
+			ready = std::max(rank->getLastScheduledCommand(CommandWrite)
+					+ controller->getTiming(TimingWrite, TimingRead, TimingSame, TimingAny),
+					ready);
+		}
+
+		// The rank is different than the new command,
+		// the bank is either the same or different.
+		if (rank_id != cmd_rank)
 		{
-			// Get the current bank
-			Bank *bank = rank->getBank(bank_id);
-
-			switch (cmd_type)
-			{
-
-			// All the following statements change the ready cycle
-			// to follow the DRAM timing constraints depending on
-			// when previous commands of certain types were
-			// scheduled to certain locations.
-			// The read cycle to follow each rule is calculated,
-			// and then the max of that cycle and the current ready
-			// cycle is taken and assigned to be the new ready cycle.
-
-			case CommandPrecharge:
-				// The rank and bank are the same as the
-				// new command.
-				if (rank_id == cmd_rank && bank_id == cmd_bank)
-				{
-					// A P s s
-					ready = std::max(bank->getLastScheduledCommand(CommandActivate)
-							+ controller->getTiming(TimingActivate, TimingPrecharge, TimingSame, TimingSame),
-							ready);
-
-					// R P s s
-					ready = std::max(bank->getLastScheduledCommand(CommandRead)
-							+ controller->getTiming(TimingRead, TimingPrecharge, TimingSame, TimingSame),
-							ready);
-
-					// W P s s
-					ready = std::max(bank->getLastScheduledCommand(CommandWrite)
-							+ controller->getTiming(TimingWrite, TimingPrecharge, TimingSame, TimingSame),
-							ready);
-				}
-				break;
-
-			case CommandActivate:
-				// The rank and bank are the same as the
-				// new command.
-				if (rank_id == cmd_rank && bank_id == cmd_bank)
-				{
-					// A A s s
-					ready = std::max(bank->getLastScheduledCommand(CommandActivate)
-							+ controller->getTiming(TimingActivate, TimingActivate, TimingSame, TimingSame),
-							ready);
-
-					// P A s s
-					ready = std::max(bank->getLastScheduledCommand(CommandPrecharge)
-							+ controller->getTiming(TimingPrecharge, TimingActivate, TimingSame, TimingSame),
-							ready);
-				}
-
-				// The rank is the same as the new command, and
-				// the bank is different.
-				if (rank_id == cmd_rank && bank_id != cmd_bank)
-				{
-					// A A s d
-					ready = std::max(bank->getLastScheduledCommand(CommandActivate)
-							+ controller->getTiming(TimingActivate, TimingActivate, TimingSame, TimingDifferent),
-							ready);
-				}
-				break;
-
-			case CommandRead:
-				// The rank and bank are the same as the
-				// new command.
-				if (rank_id == cmd_rank && bank_id == cmd_bank)
-				{
-					// A R s s
-					ready = std::max(bank->getLastScheduledCommand(CommandActivate)
-							+ controller->getTiming(TimingActivate, TimingRead, TimingSame, TimingSame),
-							ready);
-				}
-
-				// The rank is the same as the new command,
-				// the bank is either the same or different.
-				if (rank_id == cmd_rank)
-				{
-					// R R s a
-					ready = std::max(rank->getLastScheduledCommand(CommandRead)
-							+ controller->getTiming(TimingRead, TimingRead, TimingSame, TimingAny),
-							ready);
-
-					// W R s a
-					ready = std::max(rank->getLastScheduledCommand(CommandWrite)
-							+ controller->getTiming(TimingWrite, TimingRead, TimingSame, TimingAny),
-							ready);
-				}
-
-				// The rank is different than the new command,
-				// the bank is either the same or different.
-				if (rank_id != cmd_rank)
-				{
-					// R R d a
-					ready = std::max(rank->getLastScheduledCommand(CommandRead)
-							+ controller->getTiming(TimingRead, TimingRead, TimingDifferent, TimingAny),
-							ready);
-
-					// W R d a
-					ready = std::max(rank->getLastScheduledCommand(CommandWrite)
-							+ controller->getTiming(TimingRead, TimingRead, TimingDifferent, TimingAny),
-							ready);
-				}
-				break;
-
-			case CommandWrite:
-				// The rank and bank are the same as the
-				// new command.
-				if (rank_id == cmd_rank && bank_id == cmd_bank)
-				{
-					// A W s s
-					ready = std::max(rank->getLastScheduledCommand(CommandActivate)
-							+ controller->getTiming(TimingActivate, TimingWrite, TimingSame, TimingSame),
-							ready);
-				}
-
-				// The rank is the same as the new command,
-				// the bank is either the same or different.
-				if (rank_id == cmd_rank)
-				{
-					// W W s a
-					ready = std::max(rank->getLastScheduledCommand(CommandWrite)
-							+ controller->getTiming(TimingWrite, TimingWrite, TimingSame, TimingAny),
-							ready);
-				}
-
-				// The rank is different than the new command,
-				// the bank is either the same or different.
-				if (rank_id != cmd_rank)
-				{
-					// W W d a
-					ready = std::max(rank->getLastScheduledCommand(CommandWrite)
-							+ controller->getTiming(TimingWrite, TimingWrite, TimingDifferent, TimingAny),
-							ready);
-				}
-
-				// Both the rank and bank are either the same
-				// or different than the new command.
-				// R W a a
-				ready = std::max(rank->getLastScheduledCommand(CommandRead)
-						+ controller->getTiming(TimingRead, TimingWrite, TimingAny, TimingAny),
-						ready);
-				break;
-
-			// Timings cannot be calculated for an invalid command.
-			case CommandInvalid:
-				throw misc::Panic("Can't calculate timing for invalid command");
-
-			}
+			// R R d a
+			ready = std::max(rank->getLastScheduledCommand(CommandRead)
+					+ controller->getTiming(TimingRead, TimingRead, TimingDifferent, TimingAny),
+					ready);
+
+			// W R d a
+			ready = std::max(rank->getLastScheduledCommand(CommandWrite)
+					+ controller->getTiming(TimingRead, TimingRead, TimingDifferent, TimingAny),
+					ready);
 		}
+		break;
+
+	case CommandWrite:
+		// The rank and bank are the same as the
+		// new command.
+		if (rank_id == cmd_rank && bank_id == cmd_bank)
+		{
+			// A W s s
+			ready = std::max(rank->getLastScheduledCommand(CommandActivate)
+					+ controller->getTiming(TimingActivate, TimingWrite, TimingSame, TimingSame),
+					ready);
+		}
+
+		// The rank is the same as the new command,
+		// the bank is either the same or different.
+		if (rank_id == cmd_rank)
+		{
+			// W W s a
+			ready = std::max(rank->getLastScheduledCommand(CommandWrite)
+					+ controller->getTiming(TimingWrite, TimingWrite, TimingSame, TimingAny),
+					ready);
+		}
+
+		// The rank is different than the new command,
+		// the bank is either the same or different.
+		if (rank_id != cmd_rank)
+		{
+			// W W d a
+			ready = std::max(rank->getLastScheduledCommand(CommandWrite)
+					+ controller->getTiming(TimingWrite, TimingWrite, TimingDifferent, TimingAny),
+					ready);
+		}
+
+		// Both the rank and bank are either the same
+		// or different than the new command.
+		// R W a a
+		ready = std::max(rank->getLastScheduledCommand(CommandRead)
+				+ controller->getTiming(TimingRead, TimingWrite, TimingAny, TimingAny),
+				ready);
+		break;
+
+	case CommandRefresh:
+		// The rank is the same as the new command, and
+		// the bank is the same or any bank is refreshed.
+		if (rank_id == cmd_rank && (bank_id == cmd_bank || all_bank))
+		{
+			// P REF s s
+			ready = std::max(bank->getLastScheduledCommand(CommandPrecharge)
+					+ controller->getTiming(TimingPrecharge, TimingActivate, TimingSame, TimingSame),
+					ready);
+
+			// REF REF s s
+			ready = std::max(bank->getLastScheduledCommand(CommandRefresh)
+					+ controller->getCommandDuration(CommandRefresh),
+					ready);
+		}
+		break;
+
+	// Timings cannot be calculated for an invalid command.
+	case CommandInvalid:
+		throw misc::Panic("Can't calculate timing for invalid command");
+
 	}
 
-	// Return the final cycle that the command will be ready to run.
+	// Return the cycle that the command will be ready to run in.
 	return ready;
 }
 
 
+void Channel::UpdateReadyCycles(Bank *bank)
+{
+	// Only the timestamps of the given bank and of its rank changed. The
+	// rank timestamps are visited together with each of its banks, and
+	// some rules only look at them with the bank of the command itself.
+	int rank_id = bank->getRank()->getId();
+	for (int word = 0; word < (int) pending_banks.size(); word++)
+	{
+		for (unsigned long long bits = pending_banks[word]; bits;
+				bits &= bits - 1)
+		{
+			Bank *pending = getBank(word * 64 +
+					__builtin_ctzll(bits));
+			Command *cmd = pending->getFrontCommand();
+			long long ready = std::max(pending->getReadyCycle(),
+					CalculateReadyCycle(cmd, rank_id,
+					bank->getId()));
+			if (cmd->getRankId() == rank_id)
+				ready = std::max(CalculateReadyCycle(cmd, rank_id,
+						cmd->getBankId()), ready);
+			pending->setReadyCycle(ready);
+		}
+	}
+}
+
+
 void Channel::dump(std::ostream &os) const
 {
 	// Print header
@@ -61,6 +61,18 @@ class Channel
 	// Total number of commands in bank queues under this channel
 	int num_commands_in_queue = 0;
 
+	// Scheduling algorithm used in this channel
+	SchedulerType scheduler_type;
+
+	// Bitmaps with one bit per bank in the channel, indexed by the bank
+	// position returned by getBankIndex(). The first one marks the banks
+	// with commands in their queue, and the second one the banks with a
+	// read or write command to an open row at the front of their queue.
+	// A bank waiting for the rest of its rank to reach an all-bank
+	// refresh is not marked.
+	std::vector<unsigned long long> pending_banks;
+	std::vector<unsigned long long> row_hit_banks;
+
 public:
 
 	Channel(int id,
@@ -91,6 +103,42 @@ public:
 	/// Returns the total number of banks in this channel.
 	int getNumBanksTotal() const { return num_banks * num_ranks; }
 
+	/// Returns the position of a bank among all banks in this channel.
+	int getBankIndex(Bank *bank);
+
+	/// Returns the bank at the given position among all banks in this
+	/// channel.
+	Bank *getBank(int index) const;
+
+	/// Returns the scheduling algorithm used in this channel.
+	SchedulerType getSchedulerType() const { return scheduler_type; }
+
+	/// Returns the bitmap of banks with commands in their queue.
+	const std::vector<unsigned long long> &getPendingBanks() const
+	{
+		return pending_banks;
+	}
+
+	/// Returns the bitmap of banks with a row hit at the front of their
+	/// queue.
+	const std::vector<unsigned long long> &getRowHitBanks() const
+	{
+		return row_hit_banks;
+	}
+
+	/// Returns whether a bank has a command in its queue that can be
+	/// scheduled.
+	bool isBankPending(Bank *bank)
+	{
+		int index = getBankIndex(bank);
+		return pending_banks[index / 64] & (1ULL << (index % 64));
+	}
+
+	/// Update the bits of a bank in the bitmaps of pending banks and row
+	/// hits. This function must be invoked every time that the command
+	/// queue of the bank changes.
+	void UpdateBank(Bank *bank);
+
 	/// Call the scheduler for this channel.  This function will only
 	/// invoke the scheduler if it is not already scheduled to run.  The
 	/// scheduler will keep reinvoking itself while there are commands in
@@ -114,6 +162,17 @@ public:
 	/// given the current state of the system.
 	long long CalculateReadyCycle(Command *cmd);
 
+	/// Calculates the cycle that the command passed can be run in first,
+	/// only following the timing constraints with the commands last
+	/// scheduled in the given bank and its rank.
+	long long CalculateReadyCycle(Command *cmd, int rank_id, int bank_id);
+
+	/// Update the ready cycles of the front commands of all pending banks
+	/// after a command was scheduled in the given bank. This only looks
+	/// at the constraints with that bank and its rank, instead of
+	/// recalculating the ready cycles over all banks of the channel.
+	void UpdateReadyCycles(Bank *bank);
+
 	/// Dump the object to an output stream.
 	void dump(std::ostream &os = std::cout) const;
 
@@ -19,6 +19,7 @@
 
 #include <lib/cpp/String.h>
 
+#include "Address.h"
 #include "Bank.h"
 #include "Channel.h"
 #include "Command.h"
@@ -36,7 +37,8 @@ misc::StringMap CommandTypeMap
 	{"Precharge", CommandPrecharge},
 	{"Activate", CommandActivate},
 	{"Read", CommandRead},
-	{"Write", CommandWrite}
+	{"Write", CommandWrite},
+	{"Refresh", CommandRefresh}
 };
 
 std::map<CommandType, std::string> CommandTypeMapToString = {
@@ -44,7 +46,8 @@ std::map<CommandType, std::string> CommandTypeMapToString = {
 	{CommandPrecharge, "Precharge"},
 	{CommandActivate, "Activate"},
 	{CommandRead, "Read"},
-	{CommandWrite, "Write"}
+	{CommandWrite, "Write"},
+	{CommandRefresh, "Refresh"}
 };
 
 
@@ -89,7 +92,19 @@ int Command::getRankId() const
 
 Address *Command::getAddress()
 {
-	return request->getAddress();
+	return request ? request->getAddress() : nullptr;
+}
+
+
+std::string Command::getDescription()
+{
+	// Refresh commands have no address
+	std::string description = misc::fmt("#%d %s", id,
+			getTypeString().c_str());
+	if (request)
+		description += misc::fmt(" for 0x%llx",
+				request->getAddress()->getEncoded());
+	return description;
 }
 
 
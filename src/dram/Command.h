@@ -43,7 +43,8 @@ enum CommandType
 	CommandPrecharge,
 	CommandActivate,
 	CommandRead,
-	CommandWrite
+	CommandWrite,
+	CommandRefresh
 };
 
 // String map for SchedulerType
@@ -91,6 +92,10 @@ public:
 	/// scheduled.
 	int getDuration() const;
 
+	/// Returns the request that the command was created for, or nullptr
+	/// for refresh commands.
+	std::shared_ptr<Request> getRequest() { return request; }
+
 	/// Returns the cycle when the command was created.
 	long long getCycleCreated() { return cycle_created; }
 
@@ -103,9 +108,14 @@ public:
 	int getBankId() const;
 	int getRankId() const;
 
-	/// Returns a pointer to the address object of the command.
+	/// Returns a pointer to the address object of the command, or
+	/// nullptr for refresh commands, which are not created for a request.
 	Address *getAddress();
 
+	/// Returns a short description of the command for debug messages,
+	/// with its id, type, and address.
+	std::string getDescription();
+
 	/// Marks the command as finished and decrements the number of in
 	/// flight commands for associated request.
 	void setFinished();
@@ -21,12 +21,15 @@
 #include <vector>
 
 #include <lib/esim/Engine.h>
+#include <lib/esim/Statistics.h>
 
 #include "Address.h"
 #include "Bank.h"
 #include "Channel.h"
 #include "Controller.h"
 #include "Command.h"
+#include "EnergyParameters.h"
+#include "Rank.h"
 #include "Request.h"
 #include "Scheduler.h"
 #include "System.h"
@@ -44,6 +47,21 @@ misc::StringMap PagePolicyTypeMap
 	{ "Closed", PagePolicyClosed }
 };
 
+misc::StringMap RefreshPolicyTypeMap
+{
+	{ "None", RefreshPolicyNone },
+	{ "AllBank", RefreshPolicyAllBank },
+	{ "PerBank", RefreshPolicyPerBank }
+};
+
+misc::StringMap PowerStateMap
+{
+	{ "ActiveStandby", PowerActiveStandby },
+	{ "PrechargeStandby", PowerPrechargeStandby },
+	{ "ActivePowerDown", PowerActivePowerDown },
+	{ "PrechargePowerDown", PowerPrechargePowerDown }
+};
+
 std::map<int, esim::Event *> Controller::REQUEST_PROCESSORS;
 
 
@@ -90,6 +108,25 @@ void Controller::ParseConfiguration(misc::IniFile *config,
 			"SchedulingPolicy", SchedulerTypeMap,
 			SchedulerOldestFirst);
 
+	// Load the cap on row hits served ahead of older requests
+	row_hit_cap = config->ReadInt(section, "RowHitCap", 4);
+	if (row_hit_cap < 0)
+		throw Error(misc::fmt("%s: RowHitCap must be at least 0.\n%s",
+				config->getPath().c_str(),
+				System::err_config_note));
+
+	// Load the refresh policy, defaulting to all-bank refresh
+	refresh_policy = (RefreshPolicyType) config->ReadEnum(section,
+			"RefreshPolicy", RefreshPolicyTypeMap,
+			RefreshPolicyAllBank);
+
+	// Load the number of idle cycles before power-down
+	power_down_idle = config->ReadInt(section, "PowerDownIdle", 0);
+	if (power_down_idle < 0)
+		throw Error(misc::fmt("%s: PowerDownIdle must be at least 0.\n%s",
+				config->getPath().c_str(),
+				System::err_config_note));
+
 	// Read DRAM size settings
 	num_channels = config->ReadInt(section, "NumChannels", 1);
 	if (num_channels <= 0)
@@ -102,7 +139,6 @@ void Controller::ParseConfiguration(misc::IniFile *config,
 				config->getPath().c_str(),
 				System::err_config_note));
 
-	// int num_devices = config.ReadInt(section, "NumDevices", 8);
 	num_banks = config->ReadInt(section, "NumBanks", 8);
 	if (num_banks <= 0)
 		throw Error(misc::fmt("%s: NumBanks must be at least 1.\n%s",
@@ -135,6 +171,18 @@ void Controller::ParseConfiguration(misc::IniFile *config,
 
 	// Create a set of new scheduler events for all the channels.
 	CreateSchedulers(num_channels);
+
+	// Start refreshing ranks
+	if (refresh_policy != RefreshPolicyNone)
+		for (auto &channel : channels)
+			for (int i = 0; i < num_ranks; i++)
+				channel->getRank(i)->CallRefresh();
+
+	// Interval statistics
+	esim::StatisticsRegistry::Register("dram." + name + ".read_requests",
+			&num_read_requests);
+	esim::StatisticsRegistry::Register("dram." + name + ".write_requests",
+			&num_write_requests);
 }
 
 
@@ -206,11 +254,80 @@ void Controller::ParseConfigurationTiming(misc::IniFile *ini_file,
 		parameters.getTimeBurst();
 	command_durations[CommandWrite] = parameters.getTimeCwd() +
 		parameters.getTimeBurst() + parameters.getTimeWtr();
+
+	// Refresh takes tRFC for all banks, or tRFCpb for one bank.
+	command_durations[CommandRefresh] =
+			refresh_policy == RefreshPolicyPerBank ?
+			parameters.getTimeRfcpb() : parameters.getTimeRfc();
+
+	// A refresh operation must happen every tREFI cycles on average, so
+	// per-bank refreshes are spread over that interval.
+	refresh_interval = parameters.getTimeRefi();
+	if (refresh_policy == RefreshPolicyPerBank)
+		refresh_interval /= num_banks;
+	if (refresh_policy != RefreshPolicyNone && refresh_interval <= 0)
+		throw Error(misc::fmt("%s: tREFI must be at least the number "
+				"of banks with per-bank refresh, or 1 otherwise.\n%s",
+				ini_file->getPath().c_str(),
+				System::err_config_note));
+
+	// Power-down timings
+	power_down_exit = parameters.getTimeXp();
+	power_down_minimum = parameters.getTimeCke();
+
+	// Energy
+	EnergyParameters energy(ini_file, section);
+	ComputeEnergy(parameters, energy);
+}
+
+
+void Controller::ComputeEnergy(TimingParameters &timing,
+		EnergyParameters &energy)
+{
+	// Energy in pJ for one cycle at 1 mA, for all devices in a rank
+	double cycle_time = 1000.0 / System::frequency_domain->getFrequency();
+	double scale = energy.getVdd() * cycle_time * energy.getNumDevices();
+
+	// Activation and precharge split the energy of one row cycle (IDD0)
+	// over the background current of the time the row is open (IDD3N)
+	// and closed (IDD2N).
+	command_energy[CommandActivate] = std::max(0.0,
+			(energy.getIdd0() - energy.getIdd3n()) *
+			timing.getTimeRas()) * scale;
+	command_energy[CommandPrecharge] = std::max(0.0,
+			(energy.getIdd0() - energy.getIdd2n()) *
+			(timing.getTimeRc() - timing.getTimeRas())) * scale;
+
+	// Bursts, over active standby
+	command_energy[CommandRead] = std::max(0.0,
+			(energy.getIdd4r() - energy.getIdd3n()) *
+			timing.getTimeBurst()) * scale;
+	command_energy[CommandWrite] = std::max(0.0,
+			(energy.getIdd4w() - energy.getIdd3n()) *
+			timing.getTimeBurst()) * scale;
+
+	// An all-bank refresh draws IDD5 during tRFC. Each bank is charged
+	// its share, so that per-bank refresh costs the same per row.
+	command_energy[CommandRefresh] = std::max(0.0,
+			(energy.getIdd5() - energy.getIdd3n()) *
+			timing.getTimeRfc()) * scale / num_banks;
+
+	// Background
+	background_energy[PowerActiveStandby] = energy.getIdd3n() * scale;
+	background_energy[PowerPrechargeStandby] = energy.getIdd2n() * scale;
+	background_energy[PowerActivePowerDown] = energy.getIdd3p() * scale;
+	background_energy[PowerPrechargePowerDown] = energy.getIdd2p() * scale;
 }
 
 
 void Controller::AddRequest(std::shared_ptr<Request> request)
 {
+	// Statistics
+	if (request->getType() == RequestRead)
+		num_read_requests++;
+	else if (request->getType() == RequestWrite)
+		num_write_requests++;
+
 	// Add the request to the controller incoming request queue.
 	incoming_requests.push(request);
 
@@ -322,11 +439,51 @@ void Controller::CommandReturnHandler(esim::Event *type, esim::Frame *frame)
 
 	// Debug
 	long long cycle = System::frequency_domain->getCycle();
-	System::activity << misc::fmt("[%lld] [%d : %d] Finished command #%d "
-			"%s for 0x%llx\n", cycle, command->getRankId(),
-			command->getBankId(), command->getId(),
-			command->getTypeString().c_str(),
-			command->getAddress()->getEncoded());
+	System::activity << misc::fmt("[%lld] [%d : %d] Finished command "
+			"%s\n", cycle, command->getRankId(),
+			command->getBankId(),
+			command->getDescription().c_str());
+}
+
+
+void Controller::DumpReport(std::ostream &os, long long cycle) const
+{
+	// Requests
+	os << misc::fmt("[ DRAM.%s ]\n", name.c_str());
+	os << misc::fmt("ReadRequests = %lld\n", num_read_requests);
+	os << misc::fmt("WriteRequests = %lld\n", num_write_requests);
+
+	// Balance of the requests over all banks, as the ratio between the
+	// busiest bank and the mean.
+	long long max_bank_requests = 0;
+	long long total_bank_requests = 0;
+	int num_all_banks = 0;
+	for (auto &channel : channels)
+		for (int i = 0; i < num_ranks; i++)
+			for (int j = 0; j < num_banks; j++)
+			{
+				long long requests = channel->getRank(i)->
+						getBank(j)->getNumRequests();
+				max_bank_requests = std::max(max_bank_requests,
+						requests);
+				total_bank_requests += requests;
+				num_all_banks++;
+			}
+	double mean_bank_requests = num_all_banks ?
+			(double) total_bank_requests / num_all_banks : 0.0;
+	os << misc::fmt("BankRequestsMax = %lld\n", max_bank_requests);
+	os << misc::fmt("BankRequestsMean = %.2f\n", mean_bank_requests);
+	os << misc::fmt("BankImbalance = %.2f\n", mean_bank_requests > 0 ?
+			max_bank_requests / mean_bank_requests : 0.0);
+	os << "\n";
+
+	// Ranks
+	for (auto &channel : channels)
+		for (int i = 0; i < num_ranks; i++)
+			channel->getRank(i)->DumpReport(os, misc::fmt(
+					"DRAM.%s.Channel%d.Rank%d",
+					name.c_str(), channel->getId(), i),
+					cycle);
 }
 
 
@@ -39,7 +39,9 @@ namespace dram
 // Forward declarations
 class Channel;
 class Command;
+class EnergyParameters;
 class Request;
+class TimingParameters;
 
 
 // Definitions of lookup values for timing tables
@@ -72,6 +74,30 @@ enum PagePolicyType
 /// String map for PagePolicyType
 extern misc::StringMap PagePolicyTypeMap;
 
+/// Refresh Policy Types
+enum RefreshPolicyType
+{
+	RefreshPolicyNone = 0,
+	RefreshPolicyAllBank,
+	RefreshPolicyPerBank
+};
+
+/// String map for RefreshPolicyType
+extern misc::StringMap RefreshPolicyTypeMap;
+
+/// Background power states of a rank, depending on whether any of its
+/// banks has an open row, and whether it is powered down.
+enum PowerState
+{
+	PowerActiveStandby = 0,
+	PowerPrechargeStandby,
+	PowerActivePowerDown,
+	PowerPrechargePowerDown
+};
+
+/// String map for PowerState
+extern misc::StringMap PowerStateMap;
+
 
 class Controller
 {
@@ -90,11 +116,32 @@ class Controller
 	// The page policy that command processors in this controller follow
 	PagePolicyType page_policy;
 
+	// Refresh policy of the ranks in this controller
+	RefreshPolicyType refresh_policy;
+
+	// Number of idle cycles after which a rank powers down, or 0 if ranks
+	// never power down
+	int power_down_idle;
+
+	// Maximum number of younger row hits that can be served in a bank
+	// before its oldest request, under the FR-FCFS scheduler
+	int row_hit_cap;
+
 	// Timing matrix
 	int timings[4][4][2][2] = {};
 
 	// Command durations
-	int command_durations[5] = {};
+	int command_durations[6] = {};
+
+	// Refresh and power-down timings
+	int refresh_interval = 0;
+	int power_down_exit = 0;
+	int power_down_minimum = 0;
+
+	// Energy of each command type, and background energy per cycle in
+	// each power state, in pJ for all devices in a rank
+	double command_energy[6] = {};
+	double background_energy[4] = {};
 
 	// List of physical channels contained in this controller
 	std::vector<std::unique_ptr<Channel>> channels;
@@ -102,6 +149,10 @@ class Controller
 	// Incoming request queue
 	std::queue<std::shared_ptr<Request>> incoming_requests;
 
+	// Statistics
+	long long num_read_requests = 0;
+	long long num_write_requests = 0;
+
 	// Map of ids to EventTypes for each controller's request processor
 	static std::map<int, esim::Event *> REQUEST_PROCESSORS;
 
@@ -128,10 +179,52 @@ public:
 	int getNumRows() const { return num_rows; }
 	int getNumColumns() const { return num_columns; }
 
+	/// Return the number of read requests received
+	long long getNumReadRequests() const { return num_read_requests; }
+
+	/// Return the number of write requests received
+	long long getNumWriteRequests() const { return num_write_requests; }
+
 	/// Returns that page policy that command processers under this
 	/// controller follow.
 	PagePolicyType getPagePolicy() { return page_policy; }
 
+	/// Returns the refresh policy of the ranks in this controller.
+	RefreshPolicyType getRefreshPolicy() const { return refresh_policy; }
+
+	/// Returns the number of cycles between two refresh operations in a
+	/// rank. With per-bank refresh, every operation refreshes one bank.
+	int getRefreshInterval() const { return refresh_interval; }
+
+	/// Returns the number of idle cycles after which a rank powers down,
+	/// or 0 if power-down is disabled.
+	int getPowerDownIdle() const { return power_down_idle; }
+
+	/// Returns the number of cycles between the exit from power-down and
+	/// the first command (tXP).
+	int getPowerDownExit() const { return power_down_exit; }
+
+	/// Returns the minimum number of cycles that a rank stays powered
+	/// down (tCKE).
+	int getPowerDownMinimum() const { return power_down_minimum; }
+
+	/// Returns the energy in pJ consumed by a rank to run a command.
+	double getCommandEnergy(CommandType type) const
+	{
+		return command_energy[type];
+	}
+
+	/// Returns the background energy in pJ consumed by a rank in each
+	/// cycle spent in a power state.
+	double getBackgroundEnergy(PowerState state) const
+	{
+		return background_energy[state];
+	}
+
+	/// Returns the maximum number of younger row hits that a bank can
+	/// serve ahead of its oldest request under the FR-FCFS scheduler.
+	int getRowHitCap() const { return row_hit_cap; }
+
 	/// Returns the minimum timing seperation (in number of cycles) between
 	/// two commands in two locations, based on the timing protocol matrix.
 	int getTiming(TimingCommand prev, TimingCommand next,
@@ -152,6 +245,11 @@ public:
 	void ParseConfigurationTiming(misc::IniFile *config,
 			const std::string &section);
 
+	/// Compute the energy of commands and power states out of the timing
+	/// and energy parameters of the devices, following DRAMPower.
+	void ComputeEnergy(TimingParameters &timing,
+			EnergyParameters &energy);
+
 	/// Add a request to the controller's incoming request queue.
 	void AddRequest(std::shared_ptr<Request> request);
 
@@ -189,6 +287,10 @@ public:
 	/// Event handler that for when a command finishes executing.
 	static void CommandReturnHandler(esim::Event *, esim::Frame *);
 
+	/// Dump the statistics of this controller and its ranks in the
+	/// format of the DRAM report, at the given cycle.
+	void DumpReport(std::ostream &os, long long cycle) const;
+
 	/// Dump the object to an output stream.
 	void dump(std::ostream &os = std::cout) const;
 
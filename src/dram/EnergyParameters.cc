@@ -0,0 +1,68 @@
+/*
+ * Multi2Sim
+ * Copyright (C) 2014 Agamemnon Despopoulos (agdespopoulos@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <lib/cpp/String.h>
+
+#include "EnergyParameters.h"
+#include "System.h"
+
+
+namespace dram
+{
+
+
+EnergyParameters::EnergyParameters(misc::IniFile *ini_file,
+		const std::string &section)
+{
+	// Parse the configuration file section
+	ParseEnergy(ini_file, section);
+}
+
+
+void EnergyParameters::ParseEnergy(misc::IniFile *ini_file,
+		const std::string &section)
+{
+	// Set the parameters if present, else default to the values of a
+	// typical x8 DDR3 device at 1600MHz
+	vdd = ini_file->ReadDouble(section, "VDD", 1.5);
+	idd0 = ini_file->ReadDouble(section, "IDD0", 65);
+	idd2p = ini_file->ReadDouble(section, "IDD2P", 12);
+	idd2n = ini_file->ReadDouble(section, "IDD2N", 32);
+	idd3p = ini_file->ReadDouble(section, "IDD3P", 35);
+	idd3n = ini_file->ReadDouble(section, "IDD3N", 47);
+	idd4r = ini_file->ReadDouble(section, "IDD4R", 150);
+	idd4w = ini_file->ReadDouble(section, "IDD4W", 155);
+	idd5 = ini_file->ReadDouble(section, "IDD5", 235);
+	num_devices = ini_file->ReadInt(section, "NumDevices", 8);
+
+	// Check values
+	if (vdd < 0 || idd0 < 0 || idd2p < 0 || idd2n < 0 || idd3p < 0 ||
+			idd3n < 0 || idd4r < 0 || idd4w < 0 || idd5 < 0)
+		throw Error(misc::fmt("%s: VDD and IDD values cannot be "
+				"negative.\n%s",
+				ini_file->getPath().c_str(),
+				System::err_config_note));
+	if (num_devices <= 0)
+		throw Error(misc::fmt("%s: NumDevices must be at least 1.\n%s",
+				ini_file->getPath().c_str(),
+				System::err_config_note));
+}
+
+
+}  // namespace dram
@@ -0,0 +1,73 @@
+/*
+ * Multi2Sim
+ * Copyright (C) 2014 Agamemnon Despopoulos (agdespopoulos@gmail.com)
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef DRAM_ENERGY_PARAMETERS_H
+#define DRAM_ENERGY_PARAMETERS_H
+
+#include <lib/cpp/IniFile.h>
+
+
+namespace dram
+{
+
+/// Supply voltage and datasheet currents (IDD values) of the devices in a
+/// rank, used to estimate energy in the style of DRAMPower. Currents are
+/// given in mA for a single device, and the supply voltage in V.
+class EnergyParameters
+{
+	// These values are initialized in the contructor while parsing the
+	// IniFile
+	double vdd;
+	double idd0;
+	double idd2p;
+	double idd2n;
+	double idd3p;
+	double idd3n;
+	double idd4r;
+	double idd4w;
+	double idd5;
+	int num_devices;
+
+public:
+
+	/// Create a new EnergyParameters instance with all parameters parsed
+	/// from the configuration file MemoryController section.
+	EnergyParameters(misc::IniFile *ini_file, const std::string &section);
+
+	/// Parse the energy parameters out of a MemoryController section of a
+	/// dram configuration file.
+	void ParseEnergy(misc::IniFile *ini_file, const std::string &section);
+
+	// Getters for the energy parameters
+	double getVdd() { return vdd; }
+	double getIdd0() { return idd0; }
+	double getIdd2p() { return idd2p; }
+	double getIdd2n() { return idd2n; }
+	double getIdd3p() { return idd3p; }
+	double getIdd3n() { return idd3n; }
+	double getIdd4r() { return idd4r; }
+	double getIdd4w() { return idd4w; }
+	double getIdd5() { return idd5; }
+	int getNumDevices() { return num_devices; }
+};
+
+}  // namespace dram
+
+#endif
+
@@ -17,9 +17,15 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 
+#include <algorithm>
+#include <climits>
+
 #include "lib/cpp/String.h"
+#include "lib/esim/Engine.h"
 
 #include "Bank.h"
+#include "Channel.h"
+#include "Controller.h"
 #include "Rank.h"
 #include "System.h"
 
@@ -52,6 +58,218 @@ void Rank::setLastScheduledCommand(CommandType type)
 }
 
 
+long long Rank::getPowerDownCycle() const
+{
+	// No power-down with pending commands
+	int power_down_idle = channel->getController()->getPowerDownIdle();
+	if (num_commands > 0 || power_down_idle == 0)
+		return LLONG_MAX;
+
+	// Power down after the last command finishes and the idle period
+	return busy_until + power_down_idle;
+}
+
+
+void Rank::AddPowerStateCycles(long long cycle, long long *cycles) const
+{
+	// Power states while powered up and down
+	bool open = num_open_banks > 0;
+	PowerState standby = open ? PowerActiveStandby : PowerPrechargeStandby;
+	PowerState power_down = open ? PowerActivePowerDown :
+			PowerPrechargePowerDown;
+
+	// Split the cycles at the power-down entry, if any
+	long long power_down_cycle = std::max(last_background_cycle,
+			std::min(getPowerDownCycle(), cycle));
+	cycles[standby] += power_down_cycle - last_background_cycle;
+	cycles[power_down] += cycle - power_down_cycle;
+}
+
+
+void Rank::UpdatePowerState(long long cycle)
+{
+	AddPowerStateCycles(cycle, power_state_cycles);
+	last_background_cycle = cycle;
+}
+
+
+void Rank::AddCommands(int count)
+{
+	// Nothing to do
+	if (count == 0)
+		return;
+
+	// Exit power-down if the rank was idle long enough. The first command
+	// waits for the minimum power-down time and the exit latency.
+	long long cycle = System::frequency_domain->getCycle();
+	long long power_down_cycle = getPowerDownCycle();
+	if (power_down_cycle < cycle)
+	{
+		Controller *controller = channel->getController();
+		UpdatePowerState(cycle);
+		num_power_downs++;
+		power_up_cycle = std::max(cycle, power_down_cycle +
+				controller->getPowerDownMinimum()) +
+				controller->getPowerDownExit();
+
+		// Debug
+		System::debug << misc::fmt("[%lld] Rank %d exits power-down, "
+				"entered in cycle %lld\n", cycle, id,
+				power_down_cycle);
+	}
+
+	// Record commands
+	num_commands += count;
+}
+
+
+void Rank::RecordCommand(CommandType type, int duration, int open_banks)
+{
+	// Account for the power state before the number of open banks changes
+	long long cycle = System::frequency_domain->getCycle();
+	UpdatePowerState(cycle);
+	num_open_banks += open_banks;
+
+	// Command is no longer pending
+	num_commands--;
+	num_commands_run[type]++;
+	busy_until = std::max(busy_until, cycle + duration);
+}
+
+
+bool Rank::isRefreshReady() const
+{
+	for (auto &bank : banks)
+		if (bank->getNumCommandsInQueue() == 0 ||
+				bank->getFrontCommandType() != CommandRefresh)
+			return false;
+	return true;
+}
+
+
+void Rank::RunRefresh()
+{
+	for (auto &bank : banks)
+		bank->RunFrontCommand();
+}
+
+
+void Rank::CallRefresh()
+{
+	// Create the frame to pass containing a reference to this rank.
+	auto frame = std::make_shared<RefreshFrame>();
+	frame->rank = this;
+
+	// Call the event after a refresh interval. Refreshes stop at the end
+	// of the simulation, so that the remaining events can be drained.
+	esim::Engine *esim = esim::Engine::getInstance();
+	if (esim->hasFinished())
+		return;
+	esim->Call(System::event_refresh, frame, nullptr,
+			channel->getController()->getRefreshInterval());
+}
+
+
+void Rank::RefreshHandler(esim::Event *type, esim::Frame *frame)
+{
+	// Get the rank pointer out of the frame.
+	RefreshFrame *refresh_frame = dynamic_cast<RefreshFrame *>(frame);
+	Rank *rank = refresh_frame->rank;
+
+	// Refresh the rank.
+	rank->Refresh();
+}
+
+
+void Rank::Refresh()
+{
+	// Refresh the next bank, or all of them
+	if (channel->getController()->getRefreshPolicy() ==
+			RefreshPolicyPerBank)
+	{
+		banks[next_refresh_bank]->AddRefresh();
+		next_refresh_bank = (next_refresh_bank + 1) % banks.size();
+	}
+	else
+	{
+		for (auto &bank : banks)
+			bank->AddRefresh();
+	}
+
+	// Next refresh
+	CallRefresh();
+}
+
+
+void Rank::DumpReport(std::ostream &os, const std::string &section,
+		long long cycle) const
+{
+	// Cycles in each power state until now
+	long long cycles[4];
+	std::copy(power_state_cycles, power_state_cycles + 4, cycles);
+	AddPowerStateCycles(cycle, cycles);
+
+	// Power-down in progress
+	long long power_downs = num_power_downs;
+	if (getPowerDownCycle() < cycle)
+		power_downs++;
+
+	// Commands
+	os << misc::fmt("[ %s ]\n", section.c_str());
+	os << misc::fmt("Activates = %lld\n",
+			num_commands_run[CommandActivate]);
+	os << misc::fmt("Precharges = %lld\n",
+			num_commands_run[CommandPrecharge]);
+	os << misc::fmt("Reads = %lld\n", num_commands_run[CommandRead]);
+	os << misc::fmt("Writes = %lld\n", num_commands_run[CommandWrite]);
+	os << misc::fmt("BankRefreshes = %lld\n",
+			num_commands_run[CommandRefresh]);
+	os << misc::fmt("PowerDowns = %lld\n", power_downs);
+
+	// Requests received by each bank
+	os << "BankRequests =";
+	for (auto &bank : banks)
+		os << misc::fmt(" %lld", bank->getNumRequests());
+	os << "\n";
+
+	// Power states
+	for (int state = 0; state < 4; state++)
+		os << misc::fmt("%sCycles = %lld\n",
+				PowerStateMap.MapValue(state), cycles[state]);
+
+	// Energy of commands, in nJ
+	Controller *controller = channel->getController();
+	double command_energy = 0;
+	for (int type = CommandPrecharge; type <= CommandRefresh; type++)
+	{
+		double energy = num_commands_run[type] *
+				controller->getCommandEnergy((CommandType) type) /
+				1000;
+		command_energy += energy;
+		os << misc::fmt("%sEnergy = %.4f\n",
+				CommandTypeMapToString[(CommandType) type].c_str(),
+				energy);
+	}
+
+	// Background energy, in nJ
+	double background_energy = 0;
+	for (int state = 0; state < 4; state++)
+		background_energy += cycles[state] *
+				controller->getBackgroundEnergy((PowerState) state) /
+				1000;
+	os << misc::fmt("BackgroundEnergy = %.4f\n", background_energy);
+
+	// Totals
+	double energy = command_energy + background_energy;
+	long long accesses = num_commands_run[CommandRead] +
+			num_commands_run[CommandWrite];
+	os << misc::fmt("Energy = %.4f\n", energy);
+	os << misc::fmt("EnergyPerAccess = %.4f\n", accesses ?
+			energy / accesses : 0.0);
+	os << "\n";
+}
+
+
 void Rank::dump(std::ostream &os) const
 {
 	// Print header
@@ -20,8 +20,12 @@
 #ifndef DRAM_RANK_H
 #define DRAM_RANK_H
 
-#include <vector>
 #include <iostream>
+#include <string>
+#include <vector>
+
+#include <lib/esim/Event.h>
+#include <lib/esim/Frame.h>
 
 #include "Command.h"
 
@@ -46,7 +50,44 @@ class Rank
 
 	// Last scheduled command information
 	CommandType last_scheduled_command_type = CommandInvalid;
-	long long last_scheduled_commands[5] = {-100, -100, -100, -100, -100};
+	// The last refresh starts further in the past, since tRFC is longer
+	// than the other timings.
+	long long last_scheduled_commands[6] = {-100, -100, -100, -100, -100,
+			-100000};
+
+	// Number of commands in the queues of the banks of this rank
+	int num_commands = 0;
+
+	// Number of banks with an open row
+	int num_open_banks = 0;
+
+	// Cycle when the last command run in this rank finishes
+	long long busy_until = 0;
+
+	// First cycle when a command can run after exiting power-down
+	long long power_up_cycle = 0;
+
+	// Next bank to refresh under the per-bank refresh policy
+	int next_refresh_bank = 0;
+
+	// Last cycle when the background power states were accounted for
+	long long last_background_cycle = 0;
+
+	// Statistics
+	long long num_commands_run[6] = {};
+	long long num_power_downs = 0;
+	long long power_state_cycles[4] = {};
+
+	// Return the cycle when the rank powers down if it stays idle, or
+	// LLONG_MAX if it has pending commands or power-down is disabled.
+	long long getPowerDownCycle() const;
+
+	// Add the cycles spent in each power state from the last accounted
+	// cycle until the given one to the array.
+	void AddPowerStateCycles(long long cycle, long long *cycles) const;
+
+	// Account for the power states until the given cycle.
+	void UpdatePowerState(long long cycle);
 
 public:
 
@@ -84,6 +125,41 @@ public:
 	/// type and updates the last scheduled command type.
 	void setLastScheduledCommand(CommandType type);
 
+	/// Returns the first cycle when a command can run after the last exit
+	/// from power-down.
+	long long getPowerUpCycle() const { return power_up_cycle; }
+
+	/// Record that commands were added to the queue of a bank. If the rank
+	/// was powered down, it exits power-down now.
+	void AddCommands(int count);
+
+	/// Record that a command ran in one of the banks, changing the number
+	/// of banks with an open row by \a open_banks.
+	void RecordCommand(CommandType type, int duration, int open_banks);
+
+	/// Returns whether every bank has a refresh command at the front of
+	/// its queue, which is required for an all-bank refresh.
+	bool isRefreshReady() const;
+
+	/// Run the refresh command at the front of the queue of every bank,
+	/// for an all-bank refresh.
+	void RunRefresh();
+
+	/// Schedule the next refresh operation of this rank.
+	void CallRefresh();
+
+	/// Event handler that refreshes a rank.
+	static void RefreshHandler(esim::Event *, esim::Frame *);
+
+	/// Add refresh commands to the queue of all banks, or the next bank
+	/// under the per-bank refresh policy.
+	void Refresh();
+
+	/// Dump the statistics of this rank in the format of the DRAM report,
+	/// at the given cycle.
+	void DumpReport(std::ostream &os, const std::string &section,
+			long long cycle) const;
+
 	/// Dump the object to an output stream.
 	void dump(std::ostream &os = std::cout) const;
 
@@ -97,6 +173,17 @@ public:
 };
 
 
+class RefreshFrame : public esim::Frame
+{
+public:
+	RefreshFrame()
+	{
+	}
+
+	Rank *rank;
+};
+
+
 }  // namespace dram
 
 #endif
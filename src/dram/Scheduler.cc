@@ -17,7 +17,9 @@
  * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
  */
 
+#include <algorithm>
 #include <climits>
+#include <vector>
 
 #include <lib/cpp/String.h>
 
@@ -33,49 +35,97 @@ namespace dram
 misc::StringMap SchedulerTypeMap
 {
 	{ "RankBankRoundRobin", SchedulerRankBankRoundRobin},
-	{ "OldestFirst", SchedulerOldestFirst }
+	{ "OldestFirst", SchedulerOldestFirst },
+	{ "FRFCFS", SchedulerFRFCFS }
 };
 
 
-Bank *OldestFirst::FindNext()
+// Return the bank with the oldest front command among the banks marked in
+// the given bitmap, or nullptr if the bitmap is empty.
+static Bank *FindOldest(Channel *channel,
+		const std::vector<unsigned long long> &bitmap)
 {
-	// Keep track of the bank with the oldest command found so far.
 	long long oldest_cycle = LLONG_MAX;
 	Bank *oldest_bank = nullptr;
 
-	// Get the number of banks in each rank of the channel.
-	int num_banks = channel->getNumBanks();
-
-	// Iterate through all the ranks and banks.
-	for (int i = 0; i < channel->getNumBanksTotal(); i++)
+	// Only visit the banks whose bit is set
+	for (int word = 0; word < (int) bitmap.size(); word++)
 	{
-		// Get the current bank
-		Bank *bank = channel->getRank(i / num_banks)
-				->getBank(i % num_banks);
-
-		// Move to the next bank if this one has no commands in queue.
-		if (bank->getNumCommandsInQueue() == 0)
+		for (unsigned long long bits = bitmap[word]; bits;
+				bits &= bits - 1)
 		{
-			continue;
+			int index = word * 64 + __builtin_ctzll(bits);
+			Bank *bank = channel->getBank(index);
+			long long cycle = bank->getFrontCommandCycleCreated();
+			if (cycle < oldest_cycle)
+			{
+				oldest_cycle = cycle;
+				oldest_bank = bank;
+			}
 		}
+	}
+
+	// Done
+	return oldest_bank;
+}
+
+
+Bank *OldestFirst::FindNext()
+{
+	// Return the bank with the oldest command at the front of its queue.
+	// Banks with empty queues are skipped through the channel's bitmap of
+	// pending banks, and nullptr is returned if there is none.
+	return FindOldest(channel, channel->getPendingBanks());
+}
 
-		// Get the cycle when the front command in this bank was
-		// created.
-		long long current_bank_cycle =
-				bank->getFrontCommandCycleCreated();
 
-		// Make this the bank with the oldest command if it is.
-		if (current_bank_cycle < oldest_cycle)
+Bank *FRFCFS::FindNext()
+{
+	// Commands are compared by the cycle when they can run, as cached by
+	// the channel, then by whether they are row hits, and then by age.
+	long long cycle = System::frequency_domain->getCycle();
+	const std::vector<unsigned long long> &pending =
+			channel->getPendingBanks();
+	const std::vector<unsigned long long> &row_hits =
+			channel->getRowHitBanks();
+	Bank *best_bank = nullptr;
+	long long best_ready = LLONG_MAX;
+	bool best_hit = false;
+	long long best_age = LLONG_MAX;
+
+	// Only visit the banks with pending commands
+	for (int word = 0; word < (int) pending.size(); word++)
+	{
+		for (unsigned long long bits = pending[word]; bits;
+				bits &= bits - 1)
 		{
-			oldest_cycle = current_bank_cycle;
-			oldest_bank = bank;
+			int bit = __builtin_ctzll(bits);
+			Bank *bank = channel->getBank(word * 64 + bit);
+			long long ready = std::max(cycle,
+					bank->getReadyCycle());
+			bool hit = row_hits[word] & (1ULL << bit);
+			long long age = bank->getFrontCommandCycleCreated();
+			if (ready < best_ready || (ready == best_ready &&
+					(hit > best_hit || (hit == best_hit &&
+					age < best_age))))
+			{
+				best_bank = bank;
+				best_ready = ready;
+				best_hit = hit;
+				best_age = age;
+			}
 		}
 	}
 
-	// Return the bank with the oldest command at the front of its queue.
-	// If no bank was found, then the value of oldest_bank will still be
-	// nullptr, which is the return value that indicates none was found.
-	return oldest_bank;
+	// Debug
+	if (best_bank != nullptr)
+		System::debug << misc::fmt("[%lld] Scheduler returns %d : %d "
+				"for next command scheduling\n", cycle,
+				best_bank->getRank()->getId(),
+				best_bank->getId());
+
+	// Done
+	return best_bank;
 }
 
 
@@ -104,8 +154,9 @@ Bank *RankBankRoundRobin::FindNext()
 		Bank *bank = channel->getRank(current_rank)->
 				getBank(current_bank);
 
-		// Move to the next bank if this one has no commands in queue.
-		if (bank->getNumCommandsInQueue() == 0)
+		// Move to the next bank if this one has no commands that can
+		// be scheduled.
+		if (!channel->isBankPending(bank))
 		{
 			continue;
 		}
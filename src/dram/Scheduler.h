@@ -39,7 +39,8 @@ class Channel;
 enum SchedulerType
 {
 	SchedulerRankBankRoundRobin,
-	SchedulerOldestFirst
+	SchedulerOldestFirst,
+	SchedulerFRFCFS
 };
 
 // String map for SchedulerType
@@ -92,6 +93,28 @@ public:
 };
 
 
+/// First-Ready First-Come-First-Serve scheduler. Among the commands that can
+/// run first, column accesses to rows that are already open (row hits) are
+/// scheduled before any other command, and ties are broken by age. Banks
+/// under this scheduler also reorder their pending requests to serve row
+/// hits first, see Bank::ProcessRequest().
+class FRFCFS : public Scheduler
+{
+
+public:
+	FRFCFS(Channel *owner)
+			:
+			Scheduler(owner)
+	{
+	}
+
+	/// Returns the pointer to the bank whose front command can run first,
+	/// preferring row hits and then older commands among those that can
+	/// run in the same cycle.
+	Bank *FindNext();
+};
+
+
 class RankBankRoundRobin : public Scheduler
 {
 	int current_rank = 0;
@@ -19,7 +19,9 @@
 
 #include <vector>
 #include <algorithm>
+#include <fstream>
 #include <iostream>
+#include <sstream>
 
 #include <lib/cpp/CommandLine.h>
 #include <lib/cpp/Misc.h>
@@ -30,6 +32,7 @@
 #include "Bank.h"
 #include "Controller.h"
 #include "Channel.h"
+#include "Rank.h"
 #include "Scheduler.h"
 #include "System.h"
 
@@ -47,6 +50,12 @@ std::string activity_file;
 
 std::string config_file;
 
+std::string trace_file;
+
+std::string report_file;
+
+long long max_cycles = 1000;
+
 bool System::stand_alone = false;
 
 bool System::help = false;
@@ -68,6 +77,8 @@ esim::FrequencyDomain *System::frequency_domain(nullptr);
 
 esim::Event *System::event_command_return(nullptr);
 
+esim::Event *System::event_refresh(nullptr);
+
 const char *System::err_config_note =
 		"Please run 'm2s --dram-help' or consult the Multi2Sim Guide for "
 		"a description of the DRAM system configuration file format.";
@@ -85,6 +96,21 @@ const std::string System::help_message =
 		"\n"
 		"  Frequency = <value>  (Default = 1000)\n"
 		"      Frequency of the DRAM system in MHz.\n"
+		"  AddressMapping = <fields> (Default = Controller:Channel:Rank:Bank:Row:Column)\n"
+		"      Order of the address fields, from MSB to LSB, separated by colons.\n"
+		"      Possible fields are Controller, Channel, Rank, Bank, Row, and either\n"
+		"      Column or both ColumnHigh and ColumnLow, where ColumnLow addresses\n"
+		"      the columns of one cache line. For example, 'Row:Rank:Bank:Column'\n"
+		"      maps consecutive rows to different banks, and\n"
+		"      'Row:Rank:Bank:ColumnHigh:Controller:Channel:ColumnLow' interleaves\n"
+		"      cache lines across channels.\n"
+		"  LineColumns = <num> (Default = 8)\n"
+		"      Number of columns in a cache line, given by field ColumnLow. Must\n"
+		"      be a power of 2 not larger than NumColumns. Only used when\n"
+		"      AddressMapping contains ColumnLow.\n"
+		"  BankHash = {None|Xor} (Default = None)\n"
+		"      With Xor, the bank is XORed with the low bits of the row, so that\n"
+		"      accesses conflicting in one bank spread over all banks.\n"
 		"\n"
 		"Section [MemoryController <name>] defines a generic DRAM device. This section is\n"
 		"used to define the modes of the DRAM, the size of the componants and the timings.\n"
@@ -93,8 +119,14 @@ const std::string System::help_message =
 		"\n"
 		"  PagePolicy = {Open|Closed} (Default = Open) \n"
 		"      Policy that dictates whether the row of a bank remains open or closed.\n"
-		"  SchedulingPolicy = {OldestFirst|BankRoundRobin} (Default = OldestFirst)\n"
+		"  SchedulingPolicy = {OldestFirst|RankBankRoundRobin|FRFCFS} (Default = OldestFirst)\n"
 		"      Policy that determines which bank is allowed to execute a command.\n"
+		"      Policy FRFCFS serves reads and writes to open rows first, both\n"
+		"      across banks and among the pending requests of each bank.\n"
+		"  RowHitCap = <num> (Default = 4)\n"
+		"      Maximum number of younger row hits that a bank serves ahead of its\n"
+		"      oldest request under policy FRFCFS. A value of 0 disables request\n"
+		"      reordering within banks.\n"
 		"  NumChannels = <num> (Default =  1)\n"
 		"      Number of channels in the DRAM system.\n"
 		"  NumRanks = <num> (Default = 2)\n"
@@ -107,6 +139,18 @@ const std::string System::help_message =
 		"      Number of columns in each row.\n"
 		"  NumBits = <num> (Default = 8)\n"
 		"      Number of bits in each column.\n"
+		"  NumDevices = <num> (Default = 8)\n"
+		"      Number of devices in each rank, used for energy estimates.\n"
+		"  RefreshPolicy = {None|AllBank|PerBank} (Default = AllBank)\n"
+		"      Refresh of the ranks every tREFI cycles, either of all banks at\n"
+		"      once during tRFC, or of one bank at a time during tRFCpb.\n"
+		"      Note that earlier versions did not model refresh, so the default\n"
+		"      changes the timing of existing configurations. Use None to\n"
+		"      reproduce their results.\n"
+		"  PowerDownIdle = <num> (Default = 0)\n"
+		"      Number of idle cycles after which a rank powers down. The first\n"
+		"      command after that waits for tCKE and tXP. A value of 0 disables\n"
+		"      power-down.\n"
 		"  tRC = <num> (Default = 49)\n"
 		"  tRRD = <num> (Default = 5)\n"
 		"  tRP = <num> (Default = 11)\n"
@@ -121,7 +165,29 @@ const std::string System::help_message =
 		"  tRAS = <num> (Default = 28)\n"
 		"  tWR = <num> (Default = 12)\n"
 		"  tRTP = <num> (Default = 6)\n"
-		"  tBURST = <num> (Default = 4)\n";
+		"  tBURST = <num> (Default = 4)\n"
+		"  tREFI = <num> (Default = 6240)\n"
+		"  tRFCpb = <num> (Default = 64)\n"
+		"  tXP = <num> (Default = 5)\n"
+		"  tCKE = <num> (Default = 4)\n"
+		"\n"
+		"The energy of each rank is estimated from the supply voltage in V and the\n"
+		"currents of one device in mA, as found in device datasheets:\n"
+		"\n"
+		"  VDD = <value> (Default = 1.5)\n"
+		"  IDD0 = <value> (Default = 65)\n"
+		"      Activate-precharge current.\n"
+		"  IDD2P = <value> (Default = 12)\n"
+		"  IDD2N = <value> (Default = 32)\n"
+		"      Precharge power-down and standby currents.\n"
+		"  IDD3P = <value> (Default = 35)\n"
+		"  IDD3N = <value> (Default = 47)\n"
+		"      Active power-down and standby currents.\n"
+		"  IDD4R = <value> (Default = 150)\n"
+		"  IDD4W = <value> (Default = 155)\n"
+		"      Read and write burst currents.\n"
+		"  IDD5 = <value> (Default = 235)\n"
+		"      Refresh current.\n";
 
 
 System *System::getInstance()
@@ -181,38 +247,12 @@ int System::getCapacity()
 
 void System::RegisterOptions()
 {
-/*
-	//
-	// FIXME: These options are removed, in order to be excluded from
-	// the m2s --help. However, later when we hook up the DRAM model to
-	// the memory system, it will come back.
-	// 
-	// FIXME 2: A whole --dram-trace option should be added as an 
-	// input to the stand-alone DRAM. Otherwise, the stand-alone
-	// does not make any sense. It cannot be actions, as part of the
-	// configuration file.
-	//
-	// FIXME 3: The debug and debug_activity files should be combined
-	// into one. It does not make sense to have both of them as two
-	// separate file.  
 	// Get command line object
 	misc::CommandLine *command_line = misc::CommandLine::getInstance();
 
 	// Category
 	command_line->setCategory("DRAM");
 
-	// Debugger for dram
-	command_line->RegisterString("--dram-debug <file>",
-			debug_file,
-			"Dump debug information related with the DRAM "
-			"simulation.");
-
-	// Activity log for dram
-	command_line->RegisterString("--dram-debug-activity <file>",
-			activity_file,
-			"Dump debug information related with DRAM activity "
-			"during simulation.");
-
 	// Dram system configuration
 	command_line->RegisterString("--dram-config <file>",
 			config_file,
@@ -222,22 +262,66 @@ void System::RegisterOptions()
 	// Help message for dram configuration
 	command_line->RegisterBool("--dram-help",
 			help,
-			"Print help message describing the network configuration"
+			"Print help message describing the DRAM configuration"
 			" file, passed in option '--dram-config <file>'.");
 
 	// Stand-alone simulator
 	command_line->RegisterBool("--dram-sim",
 			stand_alone,
-			"Runs a DRAM simulation using the actions provided "
-			"in the DRAM configuration file (option "
-			"'--dram-config').");
+			"Runs a stand-alone DRAM simulation of the memory "
+			"controllers in the DRAM configuration file (option "
+			"'--dram-config'), with the requests given in option "
+			"'--dram-trace'.");
+
+	// Request trace for the stand-alone simulator
+	command_line->RegisterString("--dram-trace <file>",
+			trace_file,
+			"For DRAM simulation, file with the requests to inject, "
+			"one per line, given by the cycle, the type (Read or "
+			"Write), and the address. Lines starting with '#' are "
+			"ignored.");
+
+	// Maximum simulation time in cycles
+	command_line->RegisterInt64("--dram-max-cycles <number> "
+			"(default = 1000)",
+			max_cycles,
+			"Number of cycles of a DRAM simulation, together with "
+			"option '--dram-sim'.");
+
+	// Report for dram statistics
+	command_line->RegisterString("--dram-report <file>",
+			report_file,
+			"File to dump statistics of each memory controller "
+			"and rank, including refresh, power-down, energy "
+			"estimates, and the number of requests of each bank.");
+
+/*
+	//
+	// FIXME: These options are removed, in order to be excluded from
+	// the m2s --help. However, later when we hook up the DRAM model to
+	// the memory system, it will come back.
+	//
+	// FIXME 2: The debug and debug_activity files should be combined
+	// into one. It does not make sense to have both of them as two
+	// separate file.  
+
+	// Debugger for dram
+	command_line->RegisterString("--dram-debug <file>",
+			debug_file,
+			"Dump debug information related with the DRAM "
+			"simulation.");
+
+	// Activity log for dram
+	command_line->RegisterString("--dram-debug-activity <file>",
+			activity_file,
+			"Dump debug information related with DRAM activity "
+			"during simulation.");
 */
 }
 
 
 void System::ProcessOptions()
 {
-/*
 	// DRAM help
 	if (help)
 	{
@@ -245,6 +329,7 @@ void System::ProcessOptions()
 		exit(1);
 	}
 
+/*
 	// Debugger
 	if (!debug_file.empty())
 		setDebugPath(debug_file);
@@ -252,12 +337,19 @@ void System::ProcessOptions()
 	// Activity Debugger
 	if (!activity_file.empty())
 		setActivityDebugPath(activity_file);
+*/
 
 	// Stand-Alone requires config file
 	if (stand_alone && config_file.empty())
 		throw Error(misc::fmt("Option --dram-sim requires "
 				" --dram-config option "));
-*/
+
+	// Trace and report require stand-alone simulation
+	if (!stand_alone && (!trace_file.empty() || !report_file.empty()))
+		throw Error("Options --dram-trace and --dram-report require "
+				"option --dram-sim");
+	if (max_cycles < 1)
+		throw Error("Option --dram-max-cycles must be positive");
 }
 
 
@@ -287,6 +379,14 @@ void System::ParseConfiguration(misc::IniFile *ini_file)
 				ini_file->getPath().c_str(),
 				err_config_note));
 
+	// Address mapping
+	std::string address_mapping = ini_file->ReadString("General",
+			"AddressMapping", "Controller:Channel:Rank:Bank:Row:Column");
+	line_columns = ini_file->ReadInt("General", "LineColumns",
+			line_columns);
+	bank_hash = (BankHashType) ini_file->ReadEnum("General", "BankHash",
+			BankHashTypeMap, BankHashNone);
+
 	// Register frequency domain
 	esim::Engine *esim = esim::Engine::getInstance();
 	frequency_domain = esim->RegisterFrequencyDomain(
@@ -295,6 +395,8 @@ void System::ParseConfiguration(misc::IniFile *ini_file)
 	// Create events used by the entire system
 	event_command_return = esim->RegisterEvent("command_return",
 			Controller::CommandReturnHandler, frequency_domain);
+	event_refresh = esim->RegisterEvent("refresh",
+			Rank::RefreshHandler, frequency_domain);
 
 	// Iterate through each section.
 	// Parse it if it is a MemoryController section.
@@ -316,19 +418,166 @@ void System::ParseConfiguration(misc::IniFile *ini_file)
 	// All controllers and all the memory hierarchy under them has been
 	// made, so now calculate the sizes of address components.
 	GenerateAddressSizes();
+
+	// Parse the address mapping
+	ParseAddressMapping(ini_file->getPath(), address_mapping);
+
+	// Check the number of columns in a cache line, only used when the
+	// column is split
+	column_low_size = 0;
+	if (std::count(address_fields.begin(), address_fields.end(),
+			AddressFieldColumnLow))
+	{
+		if (line_columns < 1 || (line_columns & (line_columns - 1)) ||
+				Log2(line_columns) > column_size)
+			throw Error(misc::fmt("%s: LineColumns must be a power "
+					"of 2 not larger than NumColumns.\n%s",
+					ini_file->getPath().c_str(),
+					err_config_note));
+		column_low_size = Log2(line_columns);
+	}
+}
+
+
+void System::ParseAddressMapping(const std::string &path,
+		const std::string &mapping)
+{
+	// Fields from MSB to LSB
+	std::vector<std::string> tokens;
+	misc::StringTokenize(mapping, tokens, ":");
+	address_fields.clear();
+	for (auto it = tokens.rbegin(); it != tokens.rend(); ++it)
+	{
+		bool error;
+		std::string token = *it;
+		misc::StringTrim(token);
+		AddressField field = (AddressField) AddressFieldMap.MapString(
+				token, error);
+		if (error)
+			throw Error(misc::fmt("%s: Invalid field '%s' in "
+					"AddressMapping. Possible values are %s.\n%s",
+					path.c_str(), token.c_str(),
+					AddressFieldMap.toString().c_str(),
+					err_config_note));
+		address_fields.push_back(field);
+	}
+
+	// Each component must appear once, and the column either as one field
+	// or as its high and low parts.
+	auto count = [this](AddressField field)
+	{
+		return std::count(address_fields.begin(),
+				address_fields.end(), field);
+	};
+	bool valid = count(AddressFieldController) == 1 &&
+			count(AddressFieldChannel) == 1 &&
+			count(AddressFieldRank) == 1 &&
+			count(AddressFieldBank) == 1 &&
+			count(AddressFieldRow) == 1 &&
+			count(AddressFieldColumnHigh) ==
+			count(AddressFieldColumnLow) &&
+			count(AddressFieldColumn) +
+			count(AddressFieldColumnHigh) == 1;
+	if (!valid)
+		throw Error(misc::fmt("%s: AddressMapping must contain fields "
+				"Controller, Channel, Rank, Bank, Row, and either "
+				"Column or both ColumnHigh and ColumnLow, each of "
+				"them once.\n%s",
+				path.c_str(), err_config_note));
+}
+
+
+int System::getAddressFieldSize(AddressField field) const
+{
+	switch (field)
+	{
+	case AddressFieldController: return physical_size;
+	case AddressFieldChannel: return logical_size;
+	case AddressFieldRank: return rank_size;
+	case AddressFieldBank: return bank_size;
+	case AddressFieldRow: return row_size;
+	case AddressFieldColumn: return column_size;
+	case AddressFieldColumnHigh: return column_size - column_low_size;
+	case AddressFieldColumnLow: return column_low_size;
+	default: throw misc::Panic("Invalid address field");
+	}
 }
 
 
 void System::Run()
 {
+	// Requests of the trace, in cycle order
+	struct TraceRequest
+	{
+		long long cycle;
+		RequestType type;
+		long long address;
+	};
+	std::vector<TraceRequest> requests;
+	if (!trace_file.empty())
+	{
+		std::ifstream file(trace_file);
+		if (!file)
+			throw Error(misc::fmt("%s: Cannot open trace file",
+					trace_file.c_str()));
+		std::string line;
+		for (int line_num = 1; std::getline(file, line); line_num++)
+		{
+			// Skip comments and empty lines
+			misc::StringTrim(line);
+			if (line.empty() || line[0] == '#')
+				continue;
+
+			// Parse fields
+			std::istringstream stream(line);
+			long long cycle;
+			std::string type;
+			std::string address_str;
+			if (!(stream >> cycle >> type >> address_str) ||
+					cycle < 0 || (type != "Read" &&
+					type != "Write"))
+				throw Error(misc::fmt("%s:%d: Invalid request",
+						trace_file.c_str(), line_num));
+
+			// Address
+			misc::StringError error;
+			long long address = misc::StringToInt64(address_str,
+					error);
+			if (error || address < 0 || address >= getCapacity())
+				throw Error(misc::fmt("%s:%d: Invalid address",
+						trace_file.c_str(), line_num));
+
+			// Add request
+			requests.push_back({ cycle, type == "Read" ?
+					RequestRead : RequestWrite, address });
+		}
+		std::stable_sort(requests.begin(), requests.end(),
+				[](const TraceRequest &a, const TraceRequest &b)
+				{
+					return a.cycle < b.cycle;
+				});
+	}
+
 	// Get the simulation engine.
 	esim::Engine *engine = esim::Engine::getInstance();
 
-	// Run a simulation with 1000 cycles.
-	for (int i = 0; i < 1000; i++)
+	// Run the simulation, injecting the requests of the trace at their
+	// cycle.
+	auto it = requests.begin();
+	for (long long cycle = 0; cycle < max_cycles; cycle++)
 	{
+		for (; it != requests.end() && it->cycle == cycle; ++it)
+		{
+			if (it->type == RequestRead)
+				Read(it->address);
+			else
+				Write(it->address);
+		}
 		engine->ProcessEvents();
 	}
+
+	// Statistics
+	DumpReport();
 }
 
 
@@ -428,6 +677,35 @@ void System::Write(long long address)
 }
 
 
+void System::DumpReport(std::ostream &os) const
+{
+	// Report of each controller
+	long long cycle = frequency_domain->getCycle();
+	os << misc::fmt("; DRAM report at cycle %lld\n", cycle);
+	os << "; Energy values are given in nJ\n\n";
+	for (auto &controller : controllers)
+		controller->DumpReport(os, cycle);
+}
+
+
+void System::DumpReport() const
+{
+	// No report requested
+	if (report_file.empty())
+		return;
+
+	// Open file
+	std::ofstream f(report_file);
+	if (!f)
+		throw Error(misc::fmt("%s: Cannot open file for write",
+				report_file.c_str()));
+
+	// Dump into file
+	DumpReport(f);
+}
+
+
+
 void System::Dump(std::ostream &os) const
 {
 	
@@ -31,6 +31,8 @@
 #include <lib/esim/FrequencyDomain.h>
 #include <lib/esim/Event.h>
 
+#include "Address.h"
+
 
 namespace dram
 {
@@ -74,13 +76,26 @@ class System
 	int row_size = 0;
 	int column_size = 0;
 
+	// Address fields, from LSB to MSB
+	std::vector<AddressField> address_fields;
+
+	// Number of columns in a cache line
+	int line_columns = 8;
+
+	// Size in bits of the low part of the column when the column field
+	// is split
+	int column_low_size = 0;
+
+	// Bank hashing scheme
+	BankHashType bank_hash = BankHashNone;
+
 	/// Frequency
 	static int frequency;
 
 	// Stand-alone simulator instantiator
 	static bool stand_alone;
 
-	// Message to display with '--net-help'
+	// Message to display with '--dram-help'
 	static const std::string help_message;
 
 	// Counter of commands created in the system.  This serves to let every
@@ -94,6 +109,12 @@ class System
 	/// required to represent it.
 	void GenerateAddressSizes();
 
+	/// Parses the address mapping from its string in the form
+	/// <tt>Field:Field:...</tt>, from MSB to LSB, checking that every
+	/// address component appears once.
+	void ParseAddressMapping(const std::string &path,
+			const std::string &mapping);
+
 public:
 
 	// Error messages
@@ -115,10 +136,10 @@ public:
 	static esim::FrequencyDomain *frequency_domain;
 	static esim::Event *event_request;
 	static esim::Event *event_command_return;
+	static esim::Event *event_refresh;
 
 	/// Obtain the instance of the dram simulator singleton.
 	static System *getInstance();
-
 	/// Returns a channel that belongs to this controller with the
 	/// specified id.
 	Controller *getController(int id) { return controllers[id].get(); }
@@ -144,6 +165,18 @@ public:
 	/// Returns the size in bits of the column address component.
 	int getColumnSize() const { return column_size; }
 
+	/// Returns the fields of an encoded address, from LSB to MSB.
+	const std::vector<AddressField> &getAddressFields() const
+	{
+		return address_fields;
+	}
+
+	/// Returns the size in bits of an address field.
+	int getAddressFieldSize(AddressField field) const;
+
+	/// Returns the bank hashing scheme.
+	BankHashType getBankHash() const { return bank_hash; }
+
 	/// Return the maximum address
 	int getCapacity();
 
@@ -160,7 +193,10 @@ public:
 	// file passed with '--dram-config'
 	void ReadConfiguration();
 
-	/// Run the stand-alone DRAM simulation loop.
+	/// Run the stand-alone DRAM simulation loop for the number of cycles
+	/// given in '--dram-max-cycles', injecting the requests of the trace
+	/// given in '--dram-trace'. The report given in '--dram-report' is
+	/// written at the end.
 	void Run();
 
 	/// Returns the next available unique command id.
@@ -201,6 +237,13 @@ public:
 	/// Send a write request to the dram device
 	void Write(long long address);
 
+	/// Dump the statistics of all controllers and ranks, including their
+	/// energy, at the current cycle.
+	void DumpReport(std::ostream &os) const;
+
+	/// Dump the report into the file given with '--dram-report', if any.
+	void DumpReport() const;
+
 	/// Dump the object to an output stream.
 	void Dump(std::ostream &os = std::cout) const;
 
@@ -53,6 +53,10 @@ void TimingParameters::ParseTiming(misc::IniFile *ini_file,
 	time_wr = ini_file->ReadInt(section, "tWR", 12);
 	time_rtp = ini_file->ReadInt(section, "tRTP", 6);
 	time_burst = ini_file->ReadInt(section, "tBURST", 4);
+	time_refi = ini_file->ReadInt(section, "tREFI", 6240);
+	time_rfcpb = ini_file->ReadInt(section, "tRFCpb", 64);
+	time_xp = ini_file->ReadInt(section, "tXP", 5);
+	time_cke = ini_file->ReadInt(section, "tCKE", 4);
 }
 
 
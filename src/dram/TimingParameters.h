@@ -45,6 +45,10 @@ class TimingParameters
 	int time_wr;
 	int time_rtp;
 	int time_burst;
+	int time_refi;
+	int time_rfcpb;
+	int time_xp;
+	int time_cke;
 
 public:
 
@@ -72,6 +76,10 @@ public:
 	int getTimeWr() { return time_wr; }
 	int getTimeRtp() { return time_rtp; }
 	int getTimeBurst() { return time_burst; }
+	int getTimeRefi() { return time_refi; }
+	int getTimeRfcpb() { return time_rfcpb; }
+	int getTimeXp() { return time_xp; }
+	int getTimeCke() { return time_cke; }
 };
 
 }  // namespace dram
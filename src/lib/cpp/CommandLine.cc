@@ -443,5 +443,37 @@ void CommandLine::Process(int argc, char **argv, bool options_anywhere)
 	}
 }
 
+
+void CommandLine::ProcessOptions(const std::vector<std::string> &options)
+{
+	// Must follow the original command line
+	assert(processed);
+
+	// Process options
+	std::deque<std::string> arguments(options.begin(), options.end());
+	while (arguments.size() > 0)
+	{
+		// Get option
+		std::string argument = arguments.front();
+		arguments.pop_front();
+		auto it = option_table.find(argument);
+		if (it == option_table.end())
+			throw Error(misc::fmt("Invalid option: %s\n%s",
+					argument.c_str(),
+					error_message.c_str()));
+
+		// Check number of option arguments
+		CommandLineOption *option = it->second;
+		if ((int) arguments.size() < option->getNumArguments())
+			throw Error(misc::fmt("Option '%s' expects %d "
+					"argument(s)",
+					option->getName().c_str(),
+					option->getNumArguments()));
+
+		// Process command-line option
+		option->Read(arguments);
+	}
+}
+
 }  // namespace misc
 
@@ -562,6 +562,18 @@ public:
 	///	An exception will occur if any of the options passed in the
 	///	command line are invalid or does not have enough arguments.
 	void Process(int argc, char **argv, bool options_anywhere = true);
+
+	/// Process an additional list of command-line options after the
+	/// command line has been processed with a call to Process(). Each
+	/// option updates the variable it was registered with, while the
+	/// values set by the original command line are kept for all other
+	/// options. This is used, for example, by each worker of a parameter
+	/// sweep to apply its own configuration.
+	///
+	/// 	hrow
+	///	An exception will occur if any element of \a options is not a
+	///	valid option, or if an option does not have enough arguments.
+	void ProcessOptions(const std::vector<std::string> &options);
 };
 
 
@@ -0,0 +1,146 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "WorkerPool.h"
+
+
+namespace misc
+{
+
+
+WorkerPool::WorkerPool(int num_threads) :
+		next_index(0)
+{
+	for (int i = 1; i < num_threads; i++)
+		threads.emplace_back(&WorkerPool::ThreadMain, this);
+}
+
+
+WorkerPool::~WorkerPool()
+{
+	// Wake up all threads for termination
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		done = true;
+	}
+	start_condition.notify_all();
+
+	// Join them
+	for (auto &thread : threads)
+		thread.join();
+}
+
+
+void WorkerPool::Work()
+{
+	for (;;)
+	{
+		// Claim next work item
+		int index = next_index.fetch_add(1);
+		if (index >= count)
+			return;
+
+		// Run it, recording the first exception
+		try
+		{
+			work(index);
+		}
+		catch (...)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			if (!exception)
+				exception = std::current_exception();
+		}
+	}
+}
+
+
+void WorkerPool::ThreadMain()
+{
+	long long last_step = 0;
+	for (;;)
+	{
+		// Wait for a new step
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			start_condition.wait(lock, [&]
+			{
+				return done || step != last_step;
+			});
+			if (done)
+				return;
+			last_step = step;
+		}
+
+		// Process work items
+		Work();
+
+		// Notify the caller if this is the last thread to finish
+		std::unique_lock<std::mutex> lock(mutex);
+		num_busy_threads--;
+		if (!num_busy_threads)
+			end_condition.notify_one();
+	}
+}
+
+
+void WorkerPool::Run(int count, const std::function<void(int)> &work)
+{
+	// Sequential execution
+	if (threads.empty() || count <= 1)
+	{
+		for (int index = 0; index < count; index++)
+			work(index);
+		return;
+	}
+
+	// Publish new step
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		this->work = work;
+		this->count = count;
+		next_index = 0;
+		exception = nullptr;
+		num_busy_threads = threads.size();
+		step++;
+	}
+	start_condition.notify_all();
+
+	// The caller takes work items too
+	Work();
+
+	// Wait for pool threads to finish
+	std::exception_ptr exception;
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		end_condition.wait(lock, [&]
+		{
+			return num_busy_threads == 0;
+		});
+		exception = this->exception;
+		this->work = nullptr;
+	}
+
+	// Propagate exception
+	if (exception)
+		std::rethrow_exception(exception);
+}
+
+
+}  // namespace misc
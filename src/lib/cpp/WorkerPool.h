@@ -0,0 +1,108 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIB_CPP_WORKER_POOL_H
+#define LIB_CPP_WORKER_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+
+namespace misc
+{
+
+
+/// Fixed pool of threads used to run independent pieces of work in
+/// parallel. Each call to Run() is a fork-join step: the calling thread
+/// distributes \a count work items among itself and the pool threads, and
+/// returns once all of them have completed. Work items are handed out in
+/// increasing index order, but may complete in any order, so the caller is
+/// responsible for making them independent of each other.
+class WorkerPool
+{
+	// Threads created by the pool, not including the caller
+	std::vector<std::thread> threads;
+
+	// Mutex protecting the fields below
+	std::mutex mutex;
+
+	// Condition signaled when a new step is available, or when the pool
+	// is destroyed
+	std::condition_variable start_condition;
+
+	// Condition signaled when the last thread leaves the current step
+	std::condition_variable end_condition;
+
+	// Incremented for every call to Run(), used by pool threads to detect
+	// a new step
+	long long step = 0;
+
+	// Number of pool threads still working on the current step
+	int num_busy_threads = 0;
+
+	// Set by the destructor to terminate pool threads
+	bool done = false;
+
+	// Work function and number of work items of the current step
+	std::function<void(int)> work;
+	int count = 0;
+
+	// Index of the next work item to hand out
+	std::atomic<int> next_index;
+
+	// First exception thrown by a work item in the current step
+	std::exception_ptr exception;
+
+	// Process work items of the current step until none is left
+	void Work();
+
+	// Main function of pool threads
+	void ThreadMain();
+
+public:
+
+	/// Create a pool that runs work items on \a num_threads threads in
+	/// total, including the thread calling Run(). A value of 1 or less
+	/// creates no additional threads, and Run() executes all work items
+	/// sequentially in the caller.
+	explicit WorkerPool(int num_threads);
+
+	/// Destructor, joining all pool threads
+	~WorkerPool();
+
+	/// Return the number of threads that execute work items, including
+	/// the calling thread.
+	int getNumThreads() const { return threads.size() + 1; }
+
+	/// Invoke \a work once for each index in the range [0, \a count), and
+	/// return when all invocations have completed. If any invocation
+	/// throws an exception, the remaining work items are still completed,
+	/// and the first exception is rethrown in the caller.
+	void Run(int count, const std::function<void(int)> &work);
+};
+
+
+}  // namespace misc
+
+#endif
@@ -23,6 +23,7 @@
 
 #include "Engine.h"
 #include "Queue.h"
+#include "Statistics.h"
 
 
 namespace esim
@@ -121,8 +122,7 @@ bool Engine::Drain(int max_events)
 		num_events++;
 
 		// Run event handler
-		EventHandler event_handler = event->getEventHandler();
-		event_handler(event, current_frame.get());
+		RunEventHandler(event);
 
 		// Free frame
 		current_frame = nullptr;
@@ -156,8 +156,7 @@ void Engine::ProcessEndEvents()
 				event->getName().c_str());
 
 		// Run event handler with null frame
-		EventHandler event_handler = event->getEventHandler();
-		event_handler(event, current_frame.get());
+		RunEventHandler(event);
 
 		// Free frame
 		current_frame = nullptr;
@@ -165,6 +164,22 @@ void Engine::ProcessEndEvents()
 }
 
 
+void Engine::RunEventHandler(Event *event)
+{
+	// Profiler inactive
+	EventHandler event_handler = event->getEventHandler();
+	if (!Profiler::isActive())
+	{
+		event_handler(event, current_frame.get());
+		return;
+	}
+
+	// Measure handler
+	ProfilerScope scope(Profiler::getEventRegion(event));
+	event_handler(event, current_frame.get());
+}
+
+
 Engine *Engine::getInstance()
 {
 	// Instance already exists
@@ -204,6 +219,11 @@ void Engine::ProcessEvents()
 		Finish("Signal");
 	}
 	
+	// Host time in the engine, including event handlers
+	static ProfilerRegion *profiler_region =
+			Profiler::getRegion("esim.ProcessEvents");
+	ProfilerScope profiler_scope(profiler_region);
+
 	// Process events scheduled for this cycle
 	while (1)
 	{
@@ -238,8 +258,7 @@ void Engine::ProcessEvents()
 		event->decInFlight();
 
 		// Run event handler
-		EventHandler event_handler = event->getEventHandler();
-		event_handler(event, current_frame.get());
+		RunEventHandler(event);
 
 		// Reschedule if it is periodic
 		int period = current_frame->period;
@@ -250,6 +269,10 @@ void Engine::ProcessEvents()
 		current_frame = nullptr;
 	}
 	
+	// Interval statistics
+	if (shortest_cycle_time)
+		StatisticsRegistry::Update(getCycle());
+
 	// Next simulation cycle
 	current_time += shortest_cycle_time;
 }
@@ -412,8 +435,7 @@ void Engine::Execute(Event *event, std::shared_ptr<Frame> frame,
 	current_frame = frame;
 
 	// Execute event handler
-	EventHandler event_handler = event->getEventHandler();
-	event_handler(event, current_frame.get());
+	RunEventHandler(event);
 
 	// Restore previous current frame
 	current_frame = old_current_frame;
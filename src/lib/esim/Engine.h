@@ -36,6 +36,7 @@
 #include "Event.h"
 #include "Frame.h"
 #include "FrequencyDomain.h"
+#include "Profiler.h"
 
 
 namespace esim
@@ -144,6 +145,10 @@ class Engine
 	// Process all events scheduled with a previous call to EndEvent()
 	void ProcessEndEvents();
 
+	// Run the handler of an event with the current frame, measuring its
+	// host time if the profiler is active
+	void RunEventHandler(Event *event);
+
 public:
 
 	// Constructor
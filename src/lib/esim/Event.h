@@ -31,6 +31,7 @@ namespace esim
 class Event;
 class Frame;
 class FrequencyDomain;
+class ProfilerRegion;
 
 
 /// Event handler function prototype
@@ -54,6 +55,9 @@ class Event
 	// Current number of scheduled events of this type
 	int num_in_flight = 0;
 
+	// Region measuring the host time spent in the handler
+	ProfilerRegion *profiler_region = nullptr;
+
 public:
 
 	/// Constructor
@@ -89,6 +93,16 @@ public:
 
 	/// Decrease the number of in-flight events of this type by one.
 	void decInFlight() { num_in_flight--; }
+
+	/// Return the profiler region measuring the event handler, or
+	/// `nullptr` if it was not assigned yet.
+	ProfilerRegion *getProfilerRegion() const { return profiler_region; }
+
+	/// Assign the profiler region measuring the event handler
+	void setProfilerRegion(ProfilerRegion *profiler_region)
+	{
+		this->profiler_region = profiler_region;
+	}
 };
 
 }  // namespace esim
@@ -0,0 +1,147 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2014  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <vector>
+
+#include <lib/cpp/String.h>
+
+#include "Event.h"
+#include "Profiler.h"
+
+
+namespace esim
+{
+
+
+bool Profiler::active = false;
+
+thread_local ProfilerRegion *Profiler::current_region = nullptr;
+
+std::list<ProfilerRegion> Profiler::regions;
+
+std::mutex Profiler::mutex;
+
+
+ProfilerRegion *Profiler::getRegion(const std::string &name, bool event)
+{
+	// Existing region
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto &region : regions)
+		if (region.name == name && region.event == event)
+			return &region;
+
+	// New region
+	regions.emplace_back(name, event);
+	return &regions.back();
+}
+
+
+ProfilerRegion *Profiler::getEventRegion(Event *event)
+{
+	// Region already assigned to the event type. Event types with the
+	// same name share their region.
+	ProfilerRegion *region = event->getProfilerRegion();
+	if (region)
+		return region;
+
+	// Assign region
+	region = getRegion(event->getName(), true);
+	event->setProfilerRegion(region);
+	return region;
+}
+
+
+void Profiler::Reset()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (auto &region : regions)
+	{
+		region.count = 0;
+		region.time = 0;
+		region.child_time = 0;
+	}
+}
+
+
+void Profiler::Dump(std::ostream &os, long long cycles, long long real_time)
+{
+	// Host time per cycle and event throughput
+	long long num_events = 0;
+	for (auto &region : regions)
+		if (region.event)
+			num_events += region.count;
+	double seconds = (double) real_time / 1.0e6;
+	os << "[ Profiler ]\n";
+	os << misc::fmt("RealTime = %.3f [s]\n", seconds);
+	if (cycles)
+		os << misc::fmt("HostTimePerCycle = %.1f [ns]\n",
+				(double) real_time * 1.0e3 / cycles);
+	os << misc::fmt("Events = %lld\n", num_events);
+	os << misc::fmt("EventsPerSecond = %.0f\n", seconds > 0 ?
+			num_events / seconds : 0.0);
+
+	// Regions that were entered, sorted by self time
+	std::vector<const ProfilerRegion *> sorted;
+	for (auto &region : regions)
+		if (region.count)
+			sorted.push_back(&region);
+	std::sort(sorted.begin(), sorted.end(),
+			[](const ProfilerRegion *a, const ProfilerRegion *b)
+	{
+		return a->getSelfTime() > b->getSelfTime();
+	});
+
+	// Time by region, with the time of the region itself, its time
+	// including other regions entered from it, and the number of times
+	// that it was entered
+	for (const ProfilerRegion *region : sorted)
+		os << misc::fmt("%s%s = %.3f [ms] %.1f%% (%.3f [ms] total, "
+				"%lld calls)\n",
+				region->event ? "Event." : "",
+				region->name.c_str(),
+				region->getSelfTime() / 1.0e6,
+				real_time ? region->getSelfTime() / 10.0 /
+						real_time : 0.0,
+				region->getTime() / 1.0e6,
+				region->getCount());
+	os << '\n';
+}
+
+
+void ProfilerScope::Enter()
+{
+	parent = Profiler::current_region;
+	Profiler::current_region = region;
+	start_time = Profiler::getTime();
+}
+
+
+void ProfilerScope::Exit()
+{
+	long long time = Profiler::getTime() - start_time;
+	region->count.fetch_add(1, std::memory_order_relaxed);
+	region->time.fetch_add(time, std::memory_order_relaxed);
+	if (parent)
+		parent->child_time.fetch_add(time, std::memory_order_relaxed);
+	Profiler::current_region = parent;
+}
+
+
+}  // namespace esim
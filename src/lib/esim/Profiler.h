@@ -0,0 +1,207 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2014  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef LIB_CPP_ESIM_PROFILER_H
+#define LIB_CPP_ESIM_PROFILER_H
+
+#include <atomic>
+#include <ctime>
+#include <iostream>
+#include <list>
+#include <mutex>
+#include <string>
+
+
+namespace esim
+{
+
+// Forward declarations
+class Event;
+
+
+/// Region of the simulator code whose host time is measured by the
+/// profiler. Regions are identified by name, and are never destroyed once
+/// created, so pointers to them can be cached by the code they measure.
+class ProfilerRegion
+{
+	friend class Profiler;
+	friend class ProfilerScope;
+
+	// Name of the region
+	std::string name;
+
+	// Whether the region measures the handler of an event type
+	bool event;
+
+	// Number of times the region was entered
+	std::atomic<long long> count;
+
+	// Host time spent in the region, in nanoseconds
+	std::atomic<long long> time;
+
+	// Host time spent in other regions entered from this region, in
+	// nanoseconds
+	std::atomic<long long> child_time;
+
+public:
+
+	/// Constructor
+	ProfilerRegion(const std::string &name, bool event) :
+			name(name),
+			event(event),
+			count(0),
+			time(0),
+			child_time(0)
+	{
+	}
+
+	/// Return the name of the region
+	const std::string &getName() const { return name; }
+
+	/// Return the number of times that the region was entered
+	long long getCount() const { return count; }
+
+	/// Return the host time spent in the region, including the regions
+	/// entered from it, in nanoseconds
+	long long getTime() const { return time; }
+
+	/// Return the host time spent in the region, excluding the regions
+	/// entered from it, in nanoseconds
+	long long getSelfTime() const { return time - child_time; }
+};
+
+
+/// Profiler measuring the host time spent by the simulator itself in the
+/// engine, in the handlers of each event type, and in other regions such
+/// as the emulators and the pipeline stages of the timing simulators.
+/// Regions can be entered concurrently from several threads. The
+/// profiler is activated with option '--profile'. When inactive, entering
+/// a region only costs the check of a global flag.
+class Profiler
+{
+	// Whether the profiler is active
+	static bool active;
+
+	// Region being measured by the current thread
+	static thread_local ProfilerRegion *current_region;
+
+	// All regions
+	static std::list<ProfilerRegion> regions;
+
+	// Lock protecting the creation of regions
+	static std::mutex mutex;
+
+	// Create a region or return an existing one
+	static ProfilerRegion *getRegion(const std::string &name, bool event);
+
+public:
+
+	/// Activate or deactivate the profiler
+	static void setActive(bool active) { Profiler::active = active; }
+
+	/// Return whether the profiler is active
+	static bool isActive() { return active; }
+
+	/// Return the region with the given name, creating it if needed.
+	/// Regions are created even when the profiler is inactive, so this
+	/// function is typically invoked once to initialize a static
+	/// pointer.
+	static ProfilerRegion *getRegion(const std::string &name)
+	{
+		return getRegion(name, false);
+	}
+
+	/// Return the region measuring the handler of \a event
+	static ProfilerRegion *getEventRegion(Event *event);
+
+	/// Return the current host time in nanoseconds
+	static long long getTime()
+	{
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC, &ts);
+		return (long long) ts.tv_sec * 1000000000ll + ts.tv_nsec;
+	}
+
+	/// Reset the counters of all regions
+	static void Reset();
+
+	/// Dump a summary with the host time per simulated cycle, the event
+	/// throughput, and the time spent in each region, sorted by the time
+	/// spent in the region itself.
+	///
+	/// \param cycles
+	///	Number of simulated cycles
+	///
+	/// \param real_time
+	///	Host time of the simulation in microseconds
+	static void Dump(std::ostream &os, long long cycles,
+			long long real_time);
+
+	friend class ProfilerScope;
+};
+
+
+/// Object measuring the host time spent in a region of code between its
+/// construction and its destruction.
+///
+/// \code
+///	static esim::ProfilerRegion *region =
+///			esim::Profiler::getRegion("x86.commit");
+///	esim::ProfilerScope scope(region);
+/// \endcode
+class ProfilerScope
+{
+	// Region being measured, or null if the profiler is inactive
+	ProfilerRegion *region;
+
+	// Region that was being measured when this one was entered
+	ProfilerRegion *parent;
+
+	// Host time when the region was entered
+	long long start_time;
+
+	// Enter the region
+	void Enter();
+
+	// Exit the region
+	void Exit();
+
+public:
+
+	/// Enter \a region if the profiler is active
+	ProfilerScope(ProfilerRegion *region)
+	{
+		this->region = Profiler::active ? region : nullptr;
+		if (this->region)
+			Enter();
+	}
+
+	/// Exit the region
+	~ProfilerScope()
+	{
+		if (region)
+			Exit();
+	}
+};
+
+
+}  // namespace esim
+
+#endif
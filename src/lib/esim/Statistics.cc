@@ -0,0 +1,165 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2014  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cassert>
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/String.h>
+
+#include "Statistics.h"
+
+
+namespace esim
+{
+
+
+std::unique_ptr<StatisticsRegistry> StatisticsRegistry::instance;
+
+long long StatisticsRegistry::next_sample_cycle = LLONG_MAX;
+
+
+StatisticsRegistry *StatisticsRegistry::getInstance()
+{
+	// Instance already exists
+	if (instance.get())
+		return instance.get();
+
+	// Create instance
+	instance.reset(new StatisticsRegistry());
+	return instance.get();
+}
+
+
+void StatisticsRegistry::Destroy()
+{
+	instance = nullptr;
+	next_sample_cycle = LLONG_MAX;
+}
+
+
+void StatisticsRegistry::setPath(const std::string &path, long long interval,
+		bool binary)
+{
+	// Check interval
+	if (interval < 1)
+		throw misc::Error(misc::fmt("%s: Invalid statistics interval "
+				"(%lld)", path.c_str(), interval));
+
+	// Open file
+	file.open(path, binary ? std::ios::binary : std::ios::out);
+	if (!file)
+		throw misc::Error(misc::fmt("%s: Cannot open statistics file",
+				path.c_str()));
+
+	// Activate
+	active = true;
+	this->binary = binary;
+	this->interval = interval;
+	last_sample_cycle = 0;
+	next_sample_cycle = interval;
+}
+
+
+void StatisticsRegistry::WriteVarint(unsigned long long value)
+{
+	while (value >= 0x80)
+	{
+		file.put((char) (value | 0x80));
+		value >>= 7;
+	}
+	file.put((char) value);
+}
+
+
+void StatisticsRegistry::WriteHeader()
+{
+	// Binary header
+	header_written = true;
+	if (binary)
+	{
+		file.write("M2SSTATS", 8);
+		WriteVarint(counters.size());
+		for (auto &counter : counters)
+		{
+			WriteVarint(counter.name.size());
+			file.write(counter.name.data(), counter.name.size());
+		}
+		return;
+	}
+
+	// CSV header
+	file << "cycle";
+	for (auto &counter : counters)
+		file << ',' << counter.name;
+	file << '\n';
+}
+
+
+void StatisticsRegistry::Sample(long long cycle)
+{
+	// Header before the first sample
+	assert(active);
+	if (!header_written)
+		WriteHeader();
+
+	// Last cycle of the interval
+	if (binary)
+		WriteVarint(cycle);
+	else
+		file << cycle;
+
+	// Increments
+	for (auto &counter : counters)
+	{
+		long long value = *counter.value;
+		long long delta = value - counter.last_value;
+		counter.last_value = value;
+		if (binary)
+			WriteVarint(((unsigned long long) delta << 1) ^
+					(unsigned long long) (delta >> 63));
+		else
+			file << ',' << delta;
+	}
+	if (!binary)
+		file << '\n';
+
+	// Next sample
+	last_sample_cycle = cycle;
+	next_sample_cycle = cycle + interval;
+}
+
+
+void StatisticsRegistry::Finish(long long cycle)
+{
+	// Nothing if inactive
+	if (!active)
+		return;
+
+	// Last interval, if any cycle passed since the last sample
+	if (cycle > last_sample_cycle || !header_written)
+		Sample(cycle);
+
+	// Close
+	file.close();
+	active = false;
+	next_sample_cycle = LLONG_MAX;
+}
+
+
+}  // namespace esim
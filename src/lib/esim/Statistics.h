@@ -0,0 +1,148 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2014  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LIB_CPP_ESIM_STATISTICS_H
+#define LIB_CPP_ESIM_STATISTICS_H
+
+#include <climits>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+
+namespace esim
+{
+
+/// Registry of statistics counters, sampled at a fixed interval of cycles
+/// of the fastest frequency domain. Simulator components register their
+/// counters when they are created, and the registry writes the increment
+/// of every counter over each interval into a statistics file. Counters
+/// registered after the first sample are ignored.
+///
+/// In the CSV format, the first line contains the column names 'cycle'
+/// followed by the counter names, and every other line contains the last
+/// cycle of an interval followed by the counter increments.
+///
+/// The binary format contains the following, where all integers are
+/// unsigned LEB128 variable-length integers, and increments are encoded
+/// in zigzag form:
+///
+///	"M2SSTATS"
+///	Number of counters
+///	For each counter: name length, name characters
+///	For each interval: last cycle, increment of each counter
+///
+/// When the registry is not active, registering a counter returns right
+/// away, and the engine only compares the cycle against the next sampling
+/// cycle once per simulation cycle.
+///
+class StatisticsRegistry
+{
+	// Unique instance
+	static std::unique_ptr<StatisticsRegistry> instance;
+
+	// Cycle of the next sample, or LLONG_MAX if inactive
+	static long long next_sample_cycle;
+
+	// A registered counter
+	struct Counter
+	{
+		std::string name;
+		const long long *value;
+		long long last_value;
+	};
+
+	// Registered counters
+	std::vector<Counter> counters;
+
+	// Whether the user activated the registry
+	bool active = false;
+
+	// Whether the binary format is used
+	bool binary = false;
+
+	// Number of cycles between samples
+	long long interval = 0;
+
+	// Cycle of the last sample
+	long long last_sample_cycle = 0;
+
+	// Output file
+	std::ofstream file;
+
+	// Whether the header was written, after which no more counters are
+	// accepted
+	bool header_written = false;
+
+	// Write the header with the counter names
+	void WriteHeader();
+
+	// Write one unsigned variable-length integer in the binary format
+	void WriteVarint(unsigned long long value);
+
+	// Write the increment of all counters since the last sample
+	void Sample(long long cycle);
+
+public:
+
+	/// Return the registry singleton
+	static StatisticsRegistry *getInstance();
+
+	/// Destroy the registry singleton, closing the statistics file
+	static void Destroy();
+
+	/// Activate the registry, writing samples into \a path every
+	/// \a interval cycles. If \a binary is set, the binary format is used
+	/// instead of CSV.
+	void setPath(const std::string &path, long long interval,
+			bool binary = false);
+
+	/// Return whether the registry has been activated by the user
+	bool isActive() const { return active; }
+
+	/// Register a counter under the given name. The counter must stay
+	/// valid until the end of the simulation. This call is ignored if
+	/// the registry is not active.
+	static void Register(const std::string &name, const long long *counter)
+	{
+		if (next_sample_cycle == LLONG_MAX)
+			return;
+		StatisticsRegistry *registry = getInstance();
+		if (!registry->header_written)
+			registry->counters.push_back({name, counter, *counter});
+	}
+
+	/// Sample all counters if \a cycle is the last cycle of an interval.
+	/// This function is invoked by the engine once per cycle.
+	static void Update(long long cycle)
+	{
+		if (cycle >= next_sample_cycle)
+			getInstance()->Sample(cycle);
+	}
+
+	/// Write the last, possibly shorter, interval ending at \a cycle
+	/// and close the statistics file.
+	void Finish(long long cycle);
+};
+
+
+}  // namespace esim
+
+#endif
@@ -17,7 +17,9 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <cstdlib>
 #include <iostream>
+#include <zlib.h>
 
 #include <lib/cpp/Error.h>
 #include <lib/cpp/Misc.h>
@@ -30,17 +32,260 @@
 namespace esim
 {
 
+//
+// Class 'TraceEncoder'
+//
+
+// Append an unsigned LEB128 integer to a string
+static void AppendVarInt(std::string &output, unsigned long long value)
+{
+	while (value >= 0x80)
+	{
+		output += (char) (value | 0x80);
+		value >>= 7;
+	}
+	output += (char) value;
+}
+
+
+// Parse a decimal integer in the canonical form produced by printf,
+// returning false if the text would not be reproduced exactly.
+static bool ParseDecimal(const char *s, int length, long long &value)
+{
+	int start = s[0] == '-' ? 1 : 0;
+	if (length - start < 1 || length - start > 18)
+		return false;
+	if (s[start] == '0' && (length - start > 1 || start))
+		return false;
+	value = 0;
+	for (int i = start; i < length; i++)
+	{
+		if (s[i] < '0' || s[i] > '9')
+			return false;
+		value = value * 10 + s[i] - '0';
+	}
+	if (start)
+		value = -value;
+	return true;
+}
+
+
+// Parse a lower-case hexadecimal integer with a '0x' prefix, in the
+// canonical form produced by printf.
+static bool ParseHex(const char *s, int length, unsigned long long &value)
+{
+	if (length < 3 || length > 18 || s[0] != '0' || s[1] != 'x')
+		return false;
+	if (s[2] == '0' && length > 3)
+		return false;
+	value = 0;
+	for (int i = 2; i < length; i++)
+	{
+		if (s[i] >= '0' && s[i] <= '9')
+			value = value * 16 + s[i] - '0';
+		else if (s[i] >= 'a' && s[i] <= 'f')
+			value = value * 16 + s[i] - 'a' + 10;
+		else
+			return false;
+	}
+	return true;
+}
+
+
+int TraceEncoder::getStringId(const char *s, int length, std::string &output)
+{
+	// Existing string
+	std::string str(s, length);
+	auto it = strings.find(str);
+	if (it != strings.end())
+		return it->second;
+
+	// New definition
+	int id = strings.size();
+	strings[str] = id;
+	output += StringMarker;
+	AppendVarInt(output, id);
+	AppendVarInt(output, length);
+	output.append(s, length);
+	return id;
+}
+
+
+bool TraceEncoder::EncodeRecord(const char *line, int length,
+		std::string &output)
+{
+	// Command
+	const char *end = line + length;
+	const char *command_end = (const char *) memchr(line, ' ', length);
+	if (!command_end)
+		return false;
+	int command_length = command_end - line;
+	if (!(command_length == 8 && !memcmp(line, "x86.inst", 8)) &&
+			!(command_length == 7 && !memcmp(line, "si.inst", 7)) &&
+			!(command_length == 10 && !memcmp(line, "mem.access", 10)))
+		return false;
+
+	// Parse fields before encoding them, so that no string definition is
+	// added for lines that do not follow the record syntax.
+	struct Field
+	{
+		const char *key;
+		int key_length;
+		const char *value;
+		int value_length;
+		bool quoted;
+	};
+	Field fields[32];
+	int num_fields = 0;
+	const char *p = command_end;
+	while (p < end)
+	{
+		// Fields are separated by exactly one space
+		if (*p != ' ' || num_fields == 32)
+			return false;
+		Field &field = fields[num_fields++];
+		p++;
+
+		// Key
+		field.key = p;
+		while (p < end && *p != '=' && *p != ' ' && *p != '"')
+			p++;
+		if (p == end || *p != '=' || p == field.key)
+			return false;
+		field.key_length = p - field.key;
+		p++;
+
+		// Value
+		field.value = p;
+		field.quoted = p < end && *p == '"';
+		if (field.quoted)
+		{
+			field.value = ++p;
+			while (p < end && *p != '"')
+				p++;
+			if (p == end)
+				return false;
+			field.value_length = p - field.value;
+			p++;
+		}
+		else
+		{
+			while (p < end && *p != ' ' && *p != '"')
+				p++;
+			field.value_length = p - field.value;
+		}
+	}
+
+	// Encode fields into a temporary record, since definitions of new
+	// strings must precede it.
+	std::string record;
+	int command_id = getStringId(line, command_length, output);
+	for (int i = 0; i < num_fields; i++)
+	{
+		Field &field = fields[i];
+		AppendVarInt(record, getStringId(field.key, field.key_length,
+				output));
+		long long decimal;
+		unsigned long long hex;
+		if (field.quoted && field.value_length <= MaxStringLength &&
+				(int) strings.size() < MaxStrings)
+		{
+			record += 'q';
+			AppendVarInt(record, getStringId(field.value,
+					field.value_length, output));
+		}
+		else if (field.quoted)
+		{
+			record += 'Q';
+			AppendVarInt(record, field.value_length);
+			record.append(field.value, field.value_length);
+		}
+		else if (ParseDecimal(field.value, field.value_length, decimal))
+		{
+			record += 'd';
+			AppendVarInt(record, ((unsigned long long) decimal << 1) ^
+					(unsigned long long) (decimal >> 63));
+		}
+		else if (ParseHex(field.value, field.value_length, hex))
+		{
+			record += 'x';
+			AppendVarInt(record, hex);
+		}
+		else
+		{
+			record += 'r';
+			AppendVarInt(record, field.value_length);
+			record.append(field.value, field.value_length);
+		}
+	}
+
+	// Emit record
+	output += RecordMarker;
+	AppendVarInt(output, command_id);
+	AppendVarInt(output, num_fields);
+	output += record;
+	return true;
+}
+
+
+void TraceEncoder::Encode(const char *line, int length, std::string &output)
+{
+	// Lines that are not records, or that do not follow the record
+	// syntax, are copied as plain text
+	assert(length > 0 && line[length - 1] == '\n');
+	if (!EncodeRecord(line, length - 1, output))
+		output.append(line, length);
+}
+
+
+void TraceEncoder::Reset(std::string &output)
+{
+	if (strings.empty())
+		return;
+	strings.clear();
+	output += ResetMarker;
+}
+
+
+
+
+//
+// Class 'TraceSystem'
+//
+
 std::unique_ptr<TraceSystem> TraceSystem::instance;
 
 
+TraceSystem::TraceSystem() :
+		num_produced(0),
+		num_consumed(0),
+		done(false)
+{
+}
+
+
 TraceSystem::~TraceSystem()
 {
 	// Ignore if trace is not active
 	if (!active)
 		return;
 	
-	// Close ZIP file
-	gzclose(gz_file);
+	// Hand over the last buffer and wait for the background thread to
+	// write all buffers
+	int index = num_produced % NumBuffers;
+	if (buffer_sizes[index])
+		Flush();
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		done = true;
+	}
+	produced_condition.notify_one();
+	thread.join();
+
+	// Write last block and index, and close trace file
+	WriteBlock();
+	WriteIndex();
+	fclose(file);
 }
 
 
@@ -55,26 +300,198 @@ TraceSystem *TraceSystem::getInstance()
 	return instance.get();
 }
 
+
+void TraceSystem::Destroy()
+{
+	instance = nullptr;
+}
+
 	
-void TraceSystem::setPath(const std::string &path)
+void TraceSystem::setPath(const std::string &path, bool binary)
 {
 	// Trace must not have been activated yet
 	if (active)
 		throw misc::Panic("Trace already active");
 
+	// Open trace file
+	file = fopen(path.c_str(), "wb");
+	if (!file)
+		throw misc::Error(misc::fmt("%s: cannot open trace file",
+				path.c_str()));
+
 	// Save path
 	this->path = path;
+	this->binary = binary;
 	active = true;
-	
-	// Open ZIP file
-	gz_file = gzopen(path.c_str(), "wt");
-	if (!gz_file)
-		throw misc::Error(misc::fmt("%s: cannot open trace file",
-				path.c_str()));
+
+	// Allocate buffers
+	for (int i = 0; i < NumBuffers; i++)
+	{
+		buffers[i] = misc::new_unique_array<char>(BufferSize);
+		buffer_sizes[i] = 0;
+	}
+
+	// Start background thread
+	thread = std::thread(&TraceSystem::ThreadMain, this);
+}
+
+
+void TraceSystem::ThreadMain()
+{
+	TraceEncoder encoder;
+	std::string line;
+	while (true)
+	{
+		// Wait for a full buffer
+		if (num_consumed == num_produced)
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			produced_condition.wait(lock, [this] {
+				return num_consumed < num_produced || done;
+			});
+			if (num_consumed == num_produced)
+				break;
+		}
+
+		// Process complete lines. Lines spanning two buffers are
+		// carried over to the next one.
+		int index = num_consumed % NumBuffers;
+		const char *buffer = buffers[index].get();
+		int size = buffer_sizes[index];
+		int start = 0;
+		for (int i = 0; i < size; i++)
+		{
+			// Find end of line
+			if (buffer[i] != '\n')
+				continue;
+			const char *data = buffer + start;
+			int length = i + 1 - start;
+			if (!line.empty())
+			{
+				line.append(data, length);
+				data = line.c_str();
+				length = line.length();
+			}
+			start = i + 1;
+
+			// A cycle line starts a new block after the header, or
+			// once the current block is full.
+			if (length > 6 && !memcmp(data, "c clk=", 6))
+			{
+				long long cycle = atoll(data + 6);
+				if (block.empty())
+				{
+					block_cycle = cycle;
+				}
+				else if (block_cycle < 0 ||
+						(int) block.length() >= BlockSize)
+				{
+					WriteBlock();
+					if (binary)
+						encoder.Reset(block);
+					block_cycle = cycle;
+				}
+			}
+
+			// Add line to block
+			if (binary)
+				encoder.Encode(data, length, block);
+			else
+				block.append(data, length);
+			line.clear();
+		}
+		line.append(buffer + start, size - start);
+
+		// Release buffer
+		buffer_sizes[index] = 0;
+		{
+			std::lock_guard<std::mutex> lock(mutex);
+			num_consumed++;
+		}
+		consumed_condition.notify_one();
+	}
+
+	// Incomplete last line
+	block += line;
+}
+
+
+void TraceSystem::WriteBlock()
+{
+	// Nothing to write
+	if (block.empty())
+		return;
+
+	// Compress block as a complete gzip member
+	z_stream stream;
+	memset(&stream, 0, sizeof stream);
+	if (deflateInit2(&stream, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 15 + 16,
+			8, Z_DEFAULT_STRATEGY) != Z_OK)
+		throw misc::Panic("Cannot initialize trace compression");
+	std::string output;
+	output.resize(deflateBound(&stream, block.length()));
+	stream.next_in = (Bytef *) block.c_str();
+	stream.avail_in = block.length();
+	stream.next_out = (Bytef *) &output[0];
+	stream.avail_out = output.length();
+	int result = deflate(&stream, Z_FINISH);
+	assert(result == Z_STREAM_END);
+	(void) result;
+	int size = stream.total_out;
+	deflateEnd(&stream);
+
+	// Write it and add it to the index
+	fwrite(output.c_str(), 1, size, file);
+	index.push_back({ block_cycle, block_offset });
+	block_offset += size;
+	block.clear();
+}
+
+
+// Append a 64-bit little-endian integer to a string
+static void AppendInt64(std::string &output, long long value)
+{
+	for (int i = 0; i < 8; i++)
+		output += (char) ((unsigned long long) value >> (i * 8));
+}
+
+
+void TraceSystem::WriteIndex()
+{
+	std::string output = "M2STRIDX";
+	for (IndexEntry &entry : index)
+	{
+		AppendInt64(output, entry.cycle);
+		AppendInt64(output, entry.offset);
+	}
+	AppendInt64(output, index.size());
+	AppendInt64(output, block_offset);
+	output += "M2STRIDX";
+	fwrite(output.c_str(), 1, output.length(), file);
+}
+
+
+void TraceSystem::Flush()
+{
+	// Hand over current buffer
+	{
+		std::lock_guard<std::mutex> lock(mutex);
+		num_produced++;
+	}
+	produced_condition.notify_one();
+
+	// Wait for the next buffer to be free
+	if (num_produced - num_consumed == NumBuffers)
+	{
+		std::unique_lock<std::mutex> lock(mutex);
+		consumed_condition.wait(lock, [this] {
+			return num_produced - num_consumed < NumBuffers;
+		});
+	}
 }
 
 
-void TraceSystem::Write(const std::string &s, bool print_cycle)
+void TraceSystem::Write(const char *s, int length, bool print_cycle)
 {
 	// Trace system must be active
 	assert(active);
@@ -86,13 +503,16 @@ void TraceSystem::Write(const std::string &s, bool print_cycle)
 		long long cycle = engine->getCycle();
 		if (cycle > last_cycle)
 		{
-			gzprintf(gz_file, "c clk=%lld\n", cycle);
+			char line[32];
+			int line_length = snprintf(line, sizeof line,
+					"c clk=%lld\n", cycle);
+			Append(line, line_length);
 			last_cycle = cycle;
 		}
 	}
 
 	// Dump string
-	gzwrite(gz_file, s.c_str(), s.length());
+	Append(s, length);
 }
 
 
@@ -104,7 +524,7 @@ void TraceSystem::Header(const std::string &s)
 				"simulation started");
 
 	// Write it
-	Write(s, false);
+	Write(s.c_str(), s.length(), false);
 }
 
 
@@ -20,52 +20,243 @@
 #ifndef LIB_CPP_ESIM_TRACE_H
 #define LIB_CPP_ESIM_TRACE_H
 
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <sstream>
-#include <zlib.h>
+#include <thread>
+#include <unordered_map>
+#include <vector>
 
 
 namespace esim
 {
 
+/// Encoder of trace lines into the compact binary trace format. Lines of
+/// the form 'cmd key=value key="value" ...' whose command is one of the
+/// high-volume commands 'x86.inst', 'si.inst', or 'mem.access' are encoded
+/// as binary records, while any other line is copied as plain text. Both
+/// kinds of lines can be interleaved in the same trace. A binary record
+/// decodes back into exactly the original line.
+///
+/// All integers below are unsigned LEB128 variable-length integers.
+///
+/// - A string definition starts with byte 0x02, followed by the string
+///   identifier, the string length, and the string characters. Commands,
+///   keys, and short quoted values are defined once, and referred to by
+///   their identifier afterwards. Identifiers are assigned in increasing
+///   order starting at 0.
+///
+/// - A record starts with byte 0x01, followed by the command identifier,
+///   the number of fields, and each field as a key identifier, a type
+///   byte, and a value. Type 'd' is a decimal integer encoded in zigzag
+///   form, type 'x' is an hexadecimal integer with a '0x' prefix, type 'q'
+///   is the identifier of a quoted string, and types 'Q' and 'r' are a
+///   quoted or unquoted string given as its length and characters.
+///
+/// - Byte 0x03 discards all string definitions. It starts every block of
+///   an indexed trace file in which strings were defined before, so that
+///   blocks can be decoded independently.
+///
+class TraceEncoder
+{
+	// Identifiers of defined strings
+	std::unordered_map<std::string, int> strings;
+
+	// Return the identifier of a string, adding its definition to the
+	// output if it is the first occurrence
+	int getStringId(const char *s, int length, std::string &output);
+
+	// Try to encode a line without its trailing newline as a binary
+	// record. Return false if the line does not follow the record syntax,
+	// leaving the output unchanged.
+	bool EncodeRecord(const char *line, int length, std::string &output);
+
+public:
+
+	/// Marker byte starting a binary record
+	static const char RecordMarker = 0x01;
+
+	/// Marker byte starting a string definition
+	static const char StringMarker = 0x02;
+
+	/// Marker byte discarding all string definitions
+	static const char ResetMarker = 0x03;
+
+	/// Maximum length of quoted values added to the string definitions
+	static const int MaxStringLength = 32;
+
+	/// Maximum number of string definitions
+	static const int MaxStrings = 4096;
+
+	/// Encode one complete line, including its trailing newline, and
+	/// append the result to \a output.
+	void Encode(const char *line, int length, std::string &output);
+
+	/// Discard all string definitions, appending a reset marker to
+	/// \a output if any string had been defined.
+	void Reset(std::string &output);
+};
+
+
+/// Trace system, writing the trace file shared by all Trace objects. Trace
+/// messages are appended to a ring of buffers by the simulation thread,
+/// and a background thread encodes and compresses full buffers into the
+/// trace file. The simulation thread only synchronizes with the background
+/// thread when a buffer fills up.
+///
+/// The trace file is a sequence of independently compressed gzip members,
+/// or blocks, which any gzip reader decompresses as a single stream. The
+/// lines before the first cycle form the first block, and every other
+/// block starts with a cycle line ('c clk=<cycle>'). The file ends with an
+/// index of all blocks, ignored by gzip readers as trailing data:
+///
+///	"M2STRIDX"
+///	For each block: first cycle (-1 for the header block), file offset
+///	Number of blocks
+///	File offset of the index
+///	"M2STRIDX"
+///
+/// All numbers in the index are 64-bit little-endian integers.
+///
 class TraceSystem
 {
 	// Unique trace system instance
 	static std::unique_ptr<TraceSystem> instance;
 
+	// Number of buffers in the ring
+	static const int NumBuffers = 4;
+
+	// Size of each buffer in bytes
+	static const int BufferSize = 1 << 20;
+
+	// Minimum uncompressed size of a block in bytes. A new block starts
+	// at the first cycle line found after reaching this size.
+	static const int BlockSize = 1 << 20;
+
+	// Entry of the block index
+	struct IndexEntry
+	{
+		long long cycle;
+		long long offset;
+	};
+
 	// Path of trace file
 	std::string path;
 
 	// Flag indicating whether trace is active
 	bool active = false;
 
-	// ZIP file object
-	gzFile gz_file;
+	// Encode high-volume trace lines in binary format
+	bool binary = false;
+
+	// Trace file
+	FILE *file = nullptr;
+
+	// Uncompressed contents of the block being filled by the background
+	// thread, first cycle in the block, or -1 for the header block, and
+	// offset of the block in the trace file
+	std::string block;
+	long long block_cycle = -1;
+	long long block_offset = 0;
+
+	// Index of all blocks written to the trace file
+	std::vector<IndexEntry> index;
 
 	// Last cycle when a trace message was printed
 	long long last_cycle = -1;
 
+	// Ring of buffers and number of bytes used in each of them
+	std::unique_ptr<char[]> buffers[NumBuffers];
+	int buffer_sizes[NumBuffers];
+
+	// Number of buffers filled by the simulation thread, and number of
+	// buffers written to the trace file by the background thread. The
+	// buffer currently being filled is 'num_produced % NumBuffers'.
+	std::atomic<long long> num_produced;
+	std::atomic<long long> num_consumed;
+
+	// Set when the background thread must write the remaining buffers
+	// and finish
+	std::atomic<bool> done;
+
+	// Mutex and condition variables used to suspend the simulation thread
+	// while the ring is full, and the background thread while it is empty
+	std::mutex mutex;
+	std::condition_variable produced_condition;
+	std::condition_variable consumed_condition;
+
+	// Background thread
+	std::thread thread;
+
+	// Main function of the background thread
+	void ThreadMain();
+
+	// Compress the current block into the trace file and add it to the
+	// index. Invoked by the background thread.
+	void WriteBlock();
+
+	// Write the block index at the end of the trace file
+	void WriteIndex();
+
+	// Hand over the current buffer to the background thread, waiting for
+	// a free buffer if the ring is full.
+	void Flush();
+
+	// Append data to the current buffer, flushing it when full
+	void Append(const char *data, int length)
+	{
+		while (length)
+		{
+			int index = num_produced % NumBuffers;
+			int size = std::min(length, BufferSize -
+					buffer_sizes[index]);
+			memcpy(buffers[index].get() + buffer_sizes[index],
+					data, size);
+			buffer_sizes[index] += size;
+			data += size;
+			length -= size;
+			if (buffer_sizes[index] == BufferSize)
+				Flush();
+		}
+	}
+
 	// Write a message to the trace file. If argument 'print_cycle' is set,
 	// a line with the current cycle will be printed if this is the first
 	// message for the cycle. The trace system must be active.
-	void Write(const std::string &s, bool print_cycle = true);
+	void Write(const char *s, int length, bool print_cycle = true);
 
 public:
 
 	/// Return trace system singleton.
 	static TraceSystem *getInstance();
 
+	/// Destroy the trace system singleton, writing all pending messages
+	/// and closing the trace file.
+	static void Destroy();
+
+	/// Constructor
+	TraceSystem();
+
 	/// Destructor
 	~TraceSystem();
 
-	/// Activate the trace system and set the output ZIP trace file to the
-	/// given path.
-	void setPath(const std::string &path);
+	/// Activate the trace system and set the output indexed trace file to
+	/// the given path. If \a binary is set, high-volume trace lines are
+	/// written in the binary format described in TraceEncoder.
+	void setPath(const std::string &path, bool binary = false);
 
 	/// Return whether trace system has been activated by the user
 	bool isActive() const { return active; }
 
+	/// Return whether high-volume trace lines are encoded in binary
+	bool isBinary() const { return binary; }
+
 	/// Dump a message to the trace system if it was activated with a
 	/// previous call to setPath(). A line with the current cycle will be
 	/// printed if this is the first message for it.
@@ -76,12 +267,29 @@ public:
 		{
 			std::ostringstream os;
 			os << value;
-			Write(os.str());
+			std::string s = os.str();
+			Write(s.c_str(), s.length());
 		}
 
 		// Return reference to this for chaining
 		return *this;
 	}
+
+	/// Dump a string message, without an intermediate string stream
+	TraceSystem& operator<<(const std::string &s)
+	{
+		if (active)
+			Write(s.c_str(), s.length());
+		return *this;
+	}
+
+	/// Dump a C string message, without an intermediate string stream
+	TraceSystem& operator<<(const char *s)
+	{
+		if (active)
+			Write(s, strlen(s));
+		return *this;
+	}
 	
 	/// Write a line of output in the beginning of the trace file. This
 	/// function must be invoked before dumping trace information with
@@ -122,7 +330,7 @@ public:
 	/// cycle to be printed in the trace file if it is the first message
 	/// for this cycle.
 	/// The argument can be of any type accepted by \c std::ostream.
-	template<typename T> Trace& operator<<(T value)
+	template<typename T> Trace& operator<<(const T &value)
 	{
 		if (active)
 			*trace_system << value;
@@ -17,11 +17,19 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <cerrno>
 #include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
 #include <iostream>
+#include <set>
 #include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include <arch/common/CallStack.h>
+#include <arch/common/CopyEngine.h>
 #include <arch/common/Driver.h>
 #include <arch/common/Runtime.h>
 #include <arch/kepler/disassembler/Disassembler.h>
@@ -52,8 +60,11 @@
 #include <lib/cpp/Environment.h>
 #include <lib/cpp/IniFile.h>
 #include <lib/cpp/Misc.h>
+#include <lib/cpp/String.h>
 #include <lib/cpp/Terminal.h>
 #include <lib/esim/Engine.h>
+#include <lib/esim/Profiler.h>
+#include <lib/esim/Statistics.h>
 #include <lib/esim/Trace.h>
 
 extern "C"
@@ -94,9 +105,85 @@ std::string m2s_opencl_devices;
 // Trace file
 std::string m2s_trace_file;
 
+// Encode high-volume trace lines in binary format
+bool m2s_trace_binary = false;
+
 // Visualization tool input file
 std::string m2s_visual_file;
 
+// Interval statistics file
+std::string m2s_stats_file;
+
+// Number of cycles between interval statistics samples
+long long m2s_stats_interval = 10000;
+
+// Write interval statistics in binary format
+bool m2s_stats_binary = false;
+
+// Self-profiling of the simulator
+bool m2s_profile = false;
+
+// Parameter sweep configuration file
+std::string m2s_sweep_config;
+
+// Show help message for the parameter sweep configuration file
+bool m2s_sweep_help = false;
+
+// Help message for the parameter sweep configuration file
+const std::string m2s_sweep_help_message =
+	"Option '--sweep <file>' runs a parameter sweep. The program given "
+	"in the\n"
+	"command line (or with option '--ctx-config') is loaded once, and "
+	"emulated\n"
+	"functionally for a number of instructions. The simulator then forks "
+	"one\n"
+	"worker process per configuration, which shares the state of the "
+	"guest\n"
+	"program with the parent process copy-on-write. Each worker applies "
+	"its own\n"
+	"command-line options on top of those given in the command line, runs "
+	"the\n"
+	"simulation, and writes its statistics summary into one consolidated "
+	"report.\n"
+	"Detailed simulation options (e.g., '--x86-sim detailed') must be "
+	"given in\n"
+	"the options of each configuration. The standard output and error of "
+	"each\n"
+	"worker are written into file '<report>.<name>.log'.\n"
+	"\n"
+	"Sections and variables allowed in the sweep configuration file:\n"
+	"\n"
+	"[ General ]\n"
+	"FastForward = <num_inst> (Default = 0)\n"
+	"    Number of instructions emulated functionally in the parent "
+	"process\n"
+	"    before forking the workers, added up for all architectures.\n"
+	"Workers = <num> (Default = number of host processors)\n"
+	"    Maximum number of workers running at the same time.\n"
+	"Report = <file> (Default = sweep-report)\n"
+	"    Consolidated report, with one section per configuration, "
+	"followed by\n"
+	"    the statistics summary of its worker. Section names in the "
+	"summary are\n"
+	"    prefixed with the name of the configuration.\n"
+	"\n"
+	"[ Config <index> ]\n"
+	"    Configuration simulated by one worker. Indexes must be "
+	"consecutive,\n"
+	"    starting at 0.\n"
+	"Name = <name> (Default = config-<index>)\n"
+	"    Name of the configuration in the report and in the worker log "
+	"file.\n"
+	"Options = <options>\n"
+	"    Command-line options applied by the worker, e.g., "
+	"'--x86-sim detailed\n"
+	"    --x86-config x86-config --mem-config mem-config'. Stand-alone "
+	"network\n"
+	"    and DRAM simulations ('--net-sim', '--dram-sim') do not run the "
+	"guest\n"
+	"    program, and are not allowed.\n"
+	"\n";
+
 
 
 
@@ -299,16 +386,84 @@ void RegisterOptions()
 			"will stop once this time is exceeded. A value of 0 "
 			"(default) means no time limit.");
 	
+	// Interval statistics
+	command_line->RegisterString("--stats <file>",
+			m2s_stats_file,
+			"Write the increments of the statistics counters of the "
+			"x86 and Southern Islands pipelines, memory modules, "
+			"network links, and DRAM controllers over fixed "
+			"intervals of simulation into <file>. The file is in "
+			"CSV format, with one column per counter and one row "
+			"per interval. In a parameter sweep, each worker "
+			"writes into <file>.<name>.");
+
+	// Interval statistics format
+	command_line->RegisterBool("--stats-binary",
+			m2s_stats_binary,
+			"Write the statistics file generated with option "
+			"'--stats' in a compact binary format, described in "
+			"lib/esim/Statistics.h, instead of CSV.");
+
+	// Interval statistics period
+	command_line->RegisterInt64("--stats-interval <cycles> "
+			"(default = 10000)",
+			m2s_stats_interval,
+			"Number of cycles of the fastest frequency domain "
+			"between two samples of the statistics file generated "
+			"with option '--stats'.");
+
+	// Self-profiling
+	command_line->RegisterBool("--profile",
+			m2s_profile,
+			"Measure the host time spent by the simulator in the "
+			"event-driven engine, in the handler of each event "
+			"type, in the emulator and timing simulator of each "
+			"architecture, and in the x86 and Southern Islands "
+			"pipeline stages. A summary with the host time per "
+			"simulated cycle, the number of events processed per "
+			"second, and the time spent in each region is printed "
+			"with the statistics summary at the end of the "
+			"simulation.");
+
+	// Parameter sweep
+	command_line->RegisterString("--sweep <file>",
+			m2s_sweep_config,
+			"Run a parameter sweep described in <file>. The guest "
+			"program is loaded and fast-forwarded once, and then "
+			"simulated with each configuration in a separate worker "
+			"process forked from the simulator. Use option "
+			"--sweep-help for a description of the sweep "
+			"configuration file format.");
+
+	// Help for parameter sweep
+	command_line->RegisterBool("--sweep-help",
+			m2s_sweep_help,
+			"Print help message describing the parameter sweep "
+			"configuration file, passed with option '--sweep "
+			"<file>'.");
+
 	// Trace file
 	command_line->RegisterString("--trace <file>",
 			m2s_trace_file,
 			"Generate a trace file with debug information on the "
 			"configuration of the modeled CPUs, GPUs, and memory "
 			"system, as well as their dynamic simulation. The "
-			"trace is a compressed plain-text file in format. The "
+			"trace is a compressed plain-text file, written in "
+			"independently compressed blocks followed by a cycle "
+			"index that lets the visualization tool seek to any "
+			"cycle. The "
 			"user should watch the size of the generated trace as "
 			"simulation runs, since the trace file can quickly "
 			"become extremely large.");
+
+	// Binary trace
+	command_line->RegisterBool("--trace-binary",
+			m2s_trace_binary,
+			"Encode the high-volume 'x86.inst', 'si.inst', and "
+			"'mem.access' lines of the trace generated with option "
+			"'--trace' in a compact binary format, interleaved with "
+			"the remaining plain-text lines. The visualization tool "
+			"reads both formats.");
 	
 	// Visualization tool input file
 	command_line->RegisterString("--visual <file>",
@@ -404,20 +559,97 @@ void ProcessOptions()
 	if (!m2s_opencl_binary.empty())
 		environment->addVariable("M2S_OPENCL_BINARY", m2s_opencl_binary);
 
+	// Interval statistics, activated by each worker in a parameter sweep
+	if (!m2s_stats_file.empty() && m2s_sweep_config.empty())
+	{
+		esim::StatisticsRegistry *statistics =
+				esim::StatisticsRegistry::getInstance();
+		statistics->setPath(m2s_stats_file, m2s_stats_interval,
+				m2s_stats_binary);
+	}
+
+	// Self-profiling
+	esim::Profiler::setActive(m2s_profile);
+
+	// The trace is written by a background thread, which does not
+	// survive in the workers of a parameter sweep
+	if (!m2s_sweep_config.empty() && !m2s_trace_file.empty())
+		throw misc::Error("Options '--sweep' and '--trace' are "
+				"incompatible");
+
 	// Trace file
 	if (!m2s_trace_file.empty())
 	{
 		esim::TraceSystem *trace_system = esim::TraceSystem::getInstance();
-		trace_system->setPath(m2s_trace_file);
+		trace_system->setPath(m2s_trace_file, m2s_trace_binary);
 	}
 
 	// Visualization
 	if (!m2s_visual_file.empty())
 		visual_run(m2s_visual_file.c_str());
+
+	// Help for parameter sweep
+	if (m2s_sweep_help)
+	{
+		std::cerr << m2s_sweep_help_message;
+		exit(0);
+	}
 		
 }
 
 
+// Process the command-line options of all modules. Workers of a parameter
+// sweep call this function again after applying their own options.
+void ProcessModuleOptions()
+{
+	HSA::Disassembler::ProcessOptions();
+	HSA::Driver::ProcessOptions();
+	HSA::Emulator::ProcessOptions();
+	Kepler::Disassembler::ProcessOptions();
+	Kepler::Driver::ProcessOptions();
+	Kepler::Emulator::ProcessOptions();
+	mem::Mmu::ProcessOptions();
+	mem::Manager::ProcessOptions();
+	MIPS::Disassembler::ProcessOptions();
+	MIPS::Emulator::ProcessOptions();
+	SI::Driver::ProcessOptions();
+	SI::Disassembler::ProcessOptions();
+	SI::Emulator::ProcessOptions();
+	SI::Timing::ProcessOptions();
+	x86::Disassembler::ProcessOptions();
+	x86::Emulator::ProcessOptions();
+	x86::Timing::ProcessOptions();
+	mem::System::ProcessOptions();
+	dram::System::ProcessOptions();
+	net::System::ProcessOptions();
+	ARM::Disassembler::ProcessOptions();
+	ARM::Emulator::ProcessOptions();
+	comm::CopyEngine::ProcessOptions();
+}
+
+
+// Read the network and memory configuration files
+void ReadSystemConfiguration()
+{
+	// Initialize memory system, only if there is at least one timing
+	// simulation active.
+	comm::ArchPool *arch_pool = comm::ArchPool::getInstance();
+	if (arch_pool->getNumTiming())
+	{
+		// We need to load the network configuration file prior to
+		// parsing memory config file. The memory config file searches
+		// for the external network if it cannot find the network
+		// in the memory configuration file sections.
+		net::System *net_system = net::System::getInstance();
+		net_system->ReadConfiguration();
+
+		// Parse the memory configuration file
+		mem::System *memory_system = mem::System::getInstance();
+		memory_system->ReadConfiguration();
+	}
+}
+
+
 void RegisterRuntimes()
 {
 	// Get runtime pool
@@ -476,8 +708,10 @@ void MainLoop()
 
 		// Event-driven simulation. Only process events and advance to
 		// next global simulation cycle if any architecture performed a
-		// useful timing simulation.
-		if (num_active_timing_simulators)
+		// useful timing simulation, or if a host-device transfer is in
+		// flight in a copy engine.
+		if (num_active_timing_simulators ||
+				comm::CopyEngine::hasPendingTransfers())
 			esim->ProcessEvents();
 
 		// If neither functional nor timing simulation was performed for
@@ -499,6 +733,11 @@ void MainLoop()
 	// Process all remaining events
 	esim->ProcessAllEvents();
 
+	// Last interval of statistics
+	esim::StatisticsRegistry *statistics =
+			esim::StatisticsRegistry::getInstance();
+	statistics->Finish(esim->getTime() ? esim->getCycle() - 1 : 0);
+
 	// Restore default signal handlers
 	esim->DisableSignals();
 }
@@ -542,18 +781,38 @@ void DumpStatisticsSummary(std::ostream &os = std::cerr)
 
 	// Summary for all architectures
 	comm::ArchPool *arch_pool = comm::ArchPool::getInstance();
-	arch_pool->DumpSummary();
+	arch_pool->DumpSummary(os);
 
 	// Reset terminal color
 	misc::Terminal::Reset(os);
 }
 
+void DumpProfile(std::ostream &os = std::cerr)
+{
+	// Only if self-profiling was activated. The profile is also dumped
+	// for stand-alone network and DRAM simulations.
+	if (!esim::Profiler::isActive())
+		return;
+
+	// Dump in blue
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	misc::Terminal::Blue(os);
+	esim::Profiler::Dump(os, esim_engine->getTime() ?
+			esim_engine->getCycle() : 0,
+			esim_engine->getRealTime());
+	misc::Terminal::Reset(os);
+}
+
+
 void DumpReports()
 {
 	// Reports for all architectures
 	comm::ArchPool *arch_pool = comm::ArchPool::getInstance();
 	arch_pool->DumpReports();
 
+	// Reports for copy engines
+	comm::CopyEngine::DumpReports();
+
 	// Dumping memory report
 	if (mem::System::hasInstance())
 	{
@@ -579,6 +838,281 @@ void DumpReports()
 }
 
 
+// Return the number of instructions emulated by all architectures
+long long getNumInstructions()
+{
+	long long num_instructions = 0;
+	comm::ArchPool *arch_pool = comm::ArchPool::getInstance();
+	for (auto &arch : *arch_pool)
+		if (arch->getEmulator())
+			num_instructions += arch->getEmulator()->getNumInstructions();
+	return num_instructions;
+}
+
+
+// Emulate the loaded programs functionally until the given number of
+// instructions is reached
+void SweepFastForward(long long num_instructions)
+{
+	comm::ArchPool *arch_pool = comm::ArchPool::getInstance();
+	while (getNumInstructions() < num_instructions)
+	{
+		int num_active_emulators;
+		int num_active_timing_simulators;
+		arch_pool->Run(num_active_emulators,
+				num_active_timing_simulators);
+		if (!num_active_emulators)
+			throw misc::Error(misc::fmt("%s: All contexts finished "
+					"after %lld instructions, before "
+					"reaching the number of instructions "
+					"given in 'FastForward'",
+					m2s_sweep_config.c_str(),
+					getNumInstructions()));
+	}
+}
+
+
+// Simulate one configuration of a parameter sweep. This function runs in
+// the worker process and never returns.
+void RunSweepWorker(const std::string &name,
+		const std::string &options_str,
+		const std::string &log_path,
+		const std::string &summary_path)
+{
+	int status = 0;
+	try
+	{
+		// Redirect standard output and error, shared with the guest
+		// program, into the worker log
+		int fd = open(log_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC,
+				0644);
+		if (fd < 0)
+			throw misc::Error(misc::fmt("%s: Cannot create "
+					"sweep log file", log_path.c_str()));
+		dup2(fd, 1);
+		dup2(fd, 2);
+		close(fd);
+
+		// Apply configuration
+		std::vector<std::string> options;
+		misc::StringTokenize(options_str, options);
+		misc::CommandLine *command_line = misc::CommandLine::getInstance();
+		command_line->ProcessOptions(options);
+		if (!m2s_stats_file.empty())
+		{
+			esim::StatisticsRegistry *statistics =
+					esim::StatisticsRegistry::getInstance();
+			statistics->setPath(m2s_stats_file + "." + name,
+					m2s_stats_interval, m2s_stats_binary);
+		}
+		esim::Profiler::setActive(m2s_profile);
+		esim::Profiler::Reset();
+		ProcessModuleOptions();
+		ReadSystemConfiguration();
+
+		// The x86 contexts were created under functional simulation
+		// and do not produce micro-instructions. Activate them if this
+		// configuration runs a detailed simulation.
+		if (x86::Timing::getSimKind() == comm::Arch::SimDetailed)
+		{
+			x86::Emulator *emulator = x86::Emulator::getInstance();
+			for (auto it = emulator->getContextsBegin(),
+					e = emulator->getContextsEnd();
+					it != e; ++it)
+				(*it)->setUinstActive(true);
+		}
+
+		// Simulate
+		MainLoop();
+
+		// Statistics summary for the consolidated report
+		std::ofstream summary(summary_path);
+		if (!summary.good())
+			throw misc::Error(misc::fmt("%s: Cannot create "
+					"sweep summary file",
+					summary_path.c_str()));
+		DumpStatisticsSummary(summary);
+		DumpProfile(summary);
+		summary.close();
+
+		// Reports
+		DumpReports();
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		status = 1;
+	}
+
+	// Done
+	std::cout.flush();
+	std::cerr.flush();
+	exit(status);
+}
+
+
+// Run a parameter sweep, described in the file given in option '--sweep'
+void RunSweep()
+{
+	// Configuration file
+	misc::IniFile ini_file(m2s_sweep_config);
+	std::string section = "General";
+	long long fast_forward = ini_file.ReadInt64(section, "FastForward", 0);
+	int max_workers = ini_file.ReadInt(section, "Workers",
+			sysconf(_SC_NPROCESSORS_ONLN));
+	std::string report_path = ini_file.ReadString(section, "Report",
+			"sweep-report");
+	if (fast_forward < 0)
+		throw misc::Error(misc::fmt("%s: Invalid value for "
+				"'FastForward'", m2s_sweep_config.c_str()));
+	if (max_workers < 1)
+		throw misc::Error(misc::fmt("%s: Invalid value for 'Workers'",
+				m2s_sweep_config.c_str()));
+
+	// Configurations
+	struct SweepConfig
+	{
+		std::string name;
+		std::string options;
+		pid_t pid = 0;
+		int status = -1;
+	};
+	std::vector<SweepConfig> configs;
+	std::set<std::string> names;
+	for (int index = 0; ; index++)
+	{
+		// Stop if section does not exist
+		section = misc::fmt("Config %d", index);
+		if (!ini_file.Exists(section))
+			break;
+
+		// Read configuration
+		configs.emplace_back();
+		SweepConfig &config = configs.back();
+		config.name = ini_file.ReadString(section, "Name",
+				misc::fmt("config-%d", index));
+		config.options = ini_file.ReadString(section, "Options");
+		if (!names.insert(config.name).second)
+			throw misc::Error(misc::fmt("%s: Duplicate "
+					"configuration name '%s'",
+					m2s_sweep_config.c_str(),
+					config.name.c_str()));
+
+		// Stand-alone simulations would ignore the guest program
+		std::vector<std::string> options;
+		misc::StringTokenize(config.options, options);
+		for (auto &option : options)
+			if (option == "--net-sim" || option == "--dram-sim")
+				throw misc::Error(misc::fmt("%s: Option '%s' "
+						"not allowed in configuration "
+						"'%s'. Stand-alone simulations "
+						"cannot run in a parameter "
+						"sweep.",
+						m2s_sweep_config.c_str(),
+						option.c_str(),
+						config.name.c_str()));
+	}
+	if (configs.empty())
+		throw misc::Error(misc::fmt("%s: No section [ Config 0 ] "
+				"found", m2s_sweep_config.c_str()));
+
+	// Check valid report file
+	std::ofstream report(report_path);
+	if (!report.good())
+		throw misc::Error(misc::fmt("%s: Cannot open sweep report file",
+				report_path.c_str()));
+
+	// Load and fast-forward programs
+	LoadPrograms();
+	SweepFastForward(fast_forward);
+	std::cerr << misc::fmt("Sweep: %d configuration(s) forked after "
+			"%lld instructions\n", (int) configs.size(),
+			getNumInstructions());
+
+	// Pending output would be written again by every worker
+	std::cout.flush();
+	std::cerr.flush();
+
+	// Run workers
+	unsigned next_config = 0;
+	int num_workers = 0;
+	while (next_config < configs.size() || num_workers)
+	{
+		// Fork a new worker
+		if (next_config < configs.size() && num_workers < max_workers)
+		{
+			SweepConfig &config = configs[next_config++];
+			pid_t pid = fork();
+			if (pid < 0)
+				throw misc::Error(misc::fmt("Cannot fork sweep "
+						"worker: %s", strerror(errno)));
+			if (!pid)
+				RunSweepWorker(config.name, config.options,
+						report_path + "." + config.name + ".log",
+						report_path + "." + config.name + ".summary");
+			config.pid = pid;
+			num_workers++;
+			continue;
+		}
+
+		// Wait for a worker to finish
+		int status;
+		pid_t pid = waitpid(-1, &status, 0);
+		if (pid < 0 && errno == EINTR)
+			continue;
+		if (pid < 0)
+			throw misc::Error(misc::fmt("Cannot wait for sweep "
+					"workers: %s", strerror(errno)));
+		for (auto &config : configs)
+		{
+			if (config.pid != pid)
+				continue;
+			config.status = WIFEXITED(status) ?
+					WEXITSTATUS(status) :
+					128 + WTERMSIG(status);
+			num_workers--;
+			std::cerr << misc::fmt("Sweep: configuration '%s' "
+					"finished with status %d\n",
+					config.name.c_str(), config.status);
+		}
+	}
+
+	// Consolidated report
+	report << "; Parameter sweep report\n";
+	report << "; Configuration file: " << m2s_sweep_config << '\n';
+	report << "; Fast-forward instructions: " << fast_forward << '\n';
+	report << '\n';
+	for (unsigned index = 0; index < configs.size(); index++)
+	{
+		// Configuration
+		SweepConfig &config = configs[index];
+		std::string log_path = report_path + "." + config.name + ".log";
+		std::string summary_path = report_path + "." + config.name +
+				".summary";
+		report << misc::fmt("[ Config %d ]\n", index);
+		report << "Name = " << config.name << '\n';
+		report << "Options = " << config.options << '\n';
+		report << "ExitStatus = " << config.status << '\n';
+		report << "Log = " << log_path << '\n';
+		report << '\n';
+
+		// Worker summary, with section names prefixed with the
+		// configuration name
+		std::ifstream summary(summary_path);
+		std::string line;
+		while (std::getline(summary, line))
+		{
+			if (misc::StringPrefix(line, "[ "))
+				line = "[ " + config.name + " " + line.substr(2);
+			report << line << '\n';
+		}
+		summary.close();
+		remove(summary_path.c_str());
+	}
+	std::cerr << "Sweep: report written to " << report_path << '\n';
+}
+
+
 int MainProgram(int argc, char **argv)
 {
 	// Print welcome message in standard error output
@@ -608,6 +1142,7 @@ int MainProgram(int argc, char **argv)
 	net::System::RegisterOptions();
 	ARM::Disassembler::RegisterOptions();
 	ARM::Emulator::RegisterOptions();
+	comm::CopyEngine::RegisterOptions();
 
 	// Process command line. Return to C version of Multi2Sim if a
 	// command-line option was not recognized.
@@ -616,31 +1151,9 @@ int MainProgram(int argc, char **argv)
 	
 	// Process command line
 	ProcessOptions();
-	HSA::Disassembler::ProcessOptions();
-	HSA::Driver::ProcessOptions();
-	HSA::Emulator::ProcessOptions();
-	Kepler::Disassembler::ProcessOptions();
-	Kepler::Driver::ProcessOptions();
-	Kepler::Emulator::ProcessOptions();
-	mem::Mmu::ProcessOptions();
-	mem::Manager::ProcessOptions();
-	MIPS::Disassembler::ProcessOptions();
-	MIPS::Emulator::ProcessOptions();
-	SI::Driver::ProcessOptions();
-	SI::Disassembler::ProcessOptions();
-	SI::Emulator::ProcessOptions();
-	SI::Timing::ProcessOptions();
-	x86::Disassembler::ProcessOptions();
-	x86::Emulator::ProcessOptions();
-	x86::Timing::ProcessOptions();
-	mem::System::ProcessOptions();
-	dram::System::ProcessOptions();
-	net::System::ProcessOptions();
-	ARM::Disassembler::ProcessOptions();
-	ARM::Emulator::ProcessOptions();
+	ProcessModuleOptions();
 
-	// Initialize memory system, only if there is at least one timing
-	// simulation active. Check this in the architecture pool after all
+	// Check active simulations in the architecture pool after all
 	// '--xxx-sim' command-line options have been processed.
 	comm::ArchPool *arch_pool = comm::ArchPool::getInstance();
 
@@ -664,19 +1177,17 @@ int MainProgram(int argc, char **argv)
 						"time");
 	}
 			
-	if (arch_pool->getNumTiming())
-	{
-		// We need to load the network configuration file prior to
-		// parsing memory config file. The memory config file searches
-		// for the external network if it cannot find the network
-		// in the memory configuration file sections.
-		net::System *net_system = net::System::getInstance();
-		net_system->ReadConfiguration();
-
-		// Parse the memory configuration file
-		mem::System *memory_system = mem::System::getInstance();
-		memory_system->ReadConfiguration();
-	}
+	// A parameter sweep configures detailed simulation in each worker
+	if (!m2s_sweep_config.empty() && (arch_pool->getNumTiming() ||
+			net::System::isStandAlone() ||
+			dram::System::isStandAlone()))
+		throw misc::Error("Option '--sweep' is incompatible with "
+				"detailed and stand-alone simulation options "
+				"in the command line. Give them in the options "
+				"of each sweep configuration instead.");
+
+	// Read memory system configuration
+	ReadSystemConfiguration();
 
 	// Initialize network system, only if the option --net-sim is used
 	if (net::System::isStandAlone())
@@ -698,6 +1209,13 @@ int MainProgram(int argc, char **argv)
 	RegisterDrivers();
 	RegisterRuntimes();
 
+	// Parameter sweep
+	if (!m2s_sweep_config.empty())
+	{
+		RunSweep();
+		return 0;
+	}
+
 	// Load programs
 	LoadPrograms();
 		
@@ -707,6 +1225,9 @@ int MainProgram(int argc, char **argv)
 	// Statistics summary
 	DumpStatisticsSummary();
 
+	// Self-profiling summary
+	DumpProfile();
+
 	// Reports
 	DumpReports();
 
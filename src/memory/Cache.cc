@@ -155,6 +155,11 @@ void Cache::setBlock(unsigned set_id,
 		set->lru_list.PushFront(block->lru_node);
 	}
 
+	// A new block was not brought by a prefetch, unless the prefetch
+	// sets the flag explicitly afterwards.
+	if (block->tag != tag || state == BlockInvalid)
+		block->prefetched = false;
+
 	// Set new values for block
 	block->tag = tag;
 	block->state = state;
@@ -90,6 +90,10 @@ public:
 		// Block state
 		BlockState state = BlockInvalid;
 
+		// Block brought by a prefetch and not accessed by a demand access
+		// since then
+		bool prefetched = false;
+
 		// The block belongs to an LRU list
 		misc::List<Block>::Node lru_node;
 	
@@ -112,6 +116,14 @@ public:
 		/// Get the block state
 		BlockState getState() const { return state; }
 
+		/// Return whether the block was brought by a prefetch and has
+		/// not been accessed by a demand access yet
+		bool isPrefetched() const { return prefetched; }
+
+		/// Set or clear the flag indicating that the block was brought
+		/// by a prefetch
+		void setPrefetched(bool prefetched) { this->prefetched = prefetched; }
+
 		/// Set new state and tag
 		void setStateTag(BlockState state, unsigned tag)
 		{
@@ -0,0 +1,170 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2012  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MEMORY_DECODE_CACHE_H
+#define MEMORY_DECODE_CACHE_H
+
+#include <memory>
+#include <unordered_map>
+
+#include <lib/cpp/Misc.h>
+
+#include "Memory.h"
+
+
+namespace mem
+{
+
+/// Cache of decoded instructions for the code pages of a memory object.
+/// Entries are organized per page, with one slot every \a SlotSize bytes.
+/// The cache is meant to be shared by all contexts executing in the
+/// address space of \a memory. A page is checked against its version in
+/// the memory object on every lookup, and all its slots are dropped when
+/// its contents were written (self-modifying code, dynamic loaders) or
+/// the page was unmapped and mapped again.
+///
+/// \param Entry
+///	Type of a decoded instruction. It must be default-constructible and
+///	copy-assignable.
+///
+/// \param SlotSize
+///	Distance in bytes between two consecutive instruction addresses.
+///
+template<typename Entry, unsigned SlotSize> class DecodeCache
+{
+public:
+
+	/// Number of slots in a page
+	static const unsigned NumSlots = Memory::PageSize / SlotSize;
+
+private:
+
+	// Decoded instructions of one page
+	struct Page
+	{
+		// Version of the memory page contents when decoded
+		unsigned long long version = 0;
+
+		// Decoded instructions
+		Entry entries[NumSlots];
+
+		// Whether each slot contains a decoded instruction
+		bool valid[NumSlots] = {};
+	};
+
+	// Memory object whose pages are decoded
+	Memory *memory;
+
+	// Pages indexed by their tag
+	std::unordered_map<unsigned, std::unique_ptr<Page>> pages;
+
+	// Page of the last lookup, which is usually the page of the next
+	// lookup as well
+	unsigned last_tag = 0;
+	Page *last_page = nullptr;
+
+	// Statistics
+	long long num_hits = 0;
+	long long num_misses = 0;
+	long long num_invalidations = 0;
+
+public:
+
+	/// Constructor
+	DecodeCache(Memory *memory) : memory(memory)
+	{
+	}
+
+	/// Return the decoded instruction at \a address. If it is not
+	/// cached, function \a decode is invoked with a reference to the
+	/// slot and a pointer to the instruction bytes in the page, and
+	/// the slot is cached.
+	///
+	/// \return
+	///	The decoded instruction, or `nullptr` if the address cannot be
+	///	served from the cache. This happens if the page is not mapped,
+	///	or if it lacks execute permission while memory is in safe mode.
+	///	The caller must then fetch the instruction through the regular
+	///	memory access path, which reports the fault.
+	template<typename DecodeFunction>
+	Entry *Lookup(unsigned address, DecodeFunction decode)
+	{
+		// Memory page
+		Memory::Page *memory_page = memory->getPage(address);
+		if (!memory_page)
+			return nullptr;
+		if (memory->getSafe() && !(memory_page->getPerm() &
+				Memory::AccessExec))
+			return nullptr;
+
+		// Cache page
+		unsigned tag = address & Memory::PageMask;
+		Page *page = last_page;
+		if (!page || last_tag != tag)
+		{
+			std::unique_ptr<Page> &slot = pages[tag];
+			if (!slot)
+				slot = misc::new_unique<Page>();
+			page = slot.get();
+			last_tag = tag;
+			last_page = page;
+		}
+
+		// Drop decoded instructions if page contents changed
+		if (page->version != memory_page->getVersion())
+		{
+			if (page->version)
+				num_invalidations++;
+			for (unsigned i = 0; i < NumSlots; i++)
+				page->valid[i] = false;
+			page->version = memory_page->getVersion();
+		}
+
+		// Hit
+		unsigned offset = address & (Memory::PageSize - 1);
+		unsigned index = offset / SlotSize;
+		if (page->valid[index])
+		{
+			num_hits++;
+			return &page->entries[index];
+		}
+
+		// Miss
+		num_misses++;
+		memory_page->AllocateData();
+		decode(page->entries[index], memory_page->getData() + offset);
+		page->valid[index] = true;
+		return &page->entries[index];
+	}
+
+	/// Return the number of lookups served with a decoded instruction
+	long long getNumHits() const { return num_hits; }
+
+	/// Return the number of lookups that decoded the instruction
+	long long getNumMisses() const { return num_misses; }
+
+	/// Return the number of times that the decoded instructions of a
+	/// page were dropped because its contents changed
+	long long getNumInvalidations() const { return num_invalidations; }
+};
+
+
+}  // namespace mem
+
+#endif
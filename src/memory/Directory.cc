@@ -16,6 +16,7 @@
  *  along with this program; if not, write to the Free Software
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
+#include <vector>
 
 #include <lib/cpp/Misc.h>
 #include <lib/cpp/String.h>
@@ -31,27 +32,92 @@ namespace mem
 const int Directory::NoOwner;
 
 
+const misc::StringMap Directory::EncodingMap =
+{
+	{ "FullMap", EncodingFullMap },
+	{ "LimitedPointer", EncodingLimitedPointer },
+	{ "CoarseVector", EncodingCoarseVector }
+};
+
+
 Directory::Directory(const std::string &name,
 		int num_sets,
 		int num_ways,
 		int num_sub_blocks,
-		int num_nodes)
+		int num_nodes,
+		Encoding encoding,
+		int num_pointers)
 		:
 		name(name),
 		num_sets(num_sets),
 		num_ways(num_ways),
 		num_sub_blocks(num_sub_blocks),
 		num_nodes(num_nodes),
-		sharers(num_sets * num_ways * num_sub_blocks * num_nodes)
+		encoding(encoding),
+		num_pointers(num_pointers),
+		sharers(encoding == EncodingFullMap ? num_sets * num_ways *
+				num_sub_blocks * num_nodes : 0)
 {
+	// Sanity
+	assert(num_nodes > 0 && num_nodes <= INT16_MAX);
+	assert(encoding == EncodingFullMap || num_pointers > 0);
+
 	// Initialize entries
-	entries = misc::new_unique_array<Entry>(num_sets
-			* num_ways * num_sub_blocks);
+	int num_entries = num_sets * num_ways * num_sub_blocks;
+	entries = misc::new_unique_array<Entry>(num_entries);
+
+	// Initialize sharer pointers
+	if (encoding != EncodingFullMap)
+	{
+		pointers = misc::new_unique_array<uint16_t>(num_entries *
+				num_pointers);
+		int num_bits = num_pointers * 16;
+		coarse_group_size = (num_nodes + num_bits - 1) / num_bits;
+	}
 
 	// Initialize locks
-	locks = misc::new_unique_array<Lock>(num_sets * num_ways);
+	lock_access_ids = misc::new_unique_array<long long>(num_sets *
+			num_ways);
 }
-	
+
+
+long long Directory::getStorageSize() const
+{
+	long long num_entries = (long long) num_sets * num_ways *
+			num_sub_blocks;
+	long long size = num_entries * sizeof(Entry) +
+			(long long) num_sets * num_ways * sizeof(long long) +
+			lock_queues.size() * sizeof(esim::Queue);
+	if (encoding == EncodingFullMap)
+		size += (num_entries * num_nodes + 7) / 8;
+	else
+		size += num_entries * num_pointers * sizeof(uint16_t);
+	return size;
+}
+
+
+void Directory::Overflow(Entry *entry, uint16_t *entry_pointers)
+{
+	// Convert the pointers into a coarse vector
+	assert(!entry->overflow);
+	entry->overflow = true;
+	if (encoding == EncodingCoarseVector)
+	{
+		std::vector<int> nodes(entry_pointers, entry_pointers +
+				entry->num_sharers);
+		for (int i = 0; i < num_pointers; i++)
+			entry_pointers[i] = 0;
+		for (int node_id : nodes)
+			setCoarseVectorSharer(entry_pointers, node_id);
+	}
+
+	// Debug
+	System::debug << misc::fmt("    dir=\"%s\": sharer pointers "
+			"overflow (%s)\n",
+			name.c_str(),
+			EncodingMap[encoding]);
+}
+
 
 void Directory::setOwner(int set_id, int way_id, int sub_block_id, int owner)
 {
@@ -83,26 +149,56 @@ void Directory::setOwner(int set_id, int way_id, int sub_block_id, int owner)
 void Directory::setSharer(int set_id, int way_id, int sub_block_id, int node_id)
 {
 	// Sanity
-	assert(misc::inRange(set_id, 0, num_sets - 1));
-	assert(misc::inRange(way_id, 0, num_ways - 1));
-	assert(misc::inRange(sub_block_id, 0, num_sub_blocks - 1));
 	assert(misc::inRange(node_id, 0, num_nodes - 1));
+	int entry_index = getEntryIndex(set_id, way_id, sub_block_id);
+	Entry *entry = &entries[entry_index];
 
-	// Get position in bitmap
-	int bit_id = set_id * num_ways * num_sub_blocks * num_nodes +
-			way_id * num_sub_blocks * num_nodes +
-			sub_block_id * num_nodes +
-			node_id;
-	
-	// Check if already set
-	if (sharers[bit_id])
-		return;
-	
-	// Set sharer
-	Entry *entry = getEntry(set_id, way_id, sub_block_id);
-	assert(entry->getNumSharers() < num_nodes);
-	entry->incNumSharers();
-	sharers.Set(bit_id);
+	// Full-map
+	if (encoding == EncodingFullMap)
+	{
+		// Get position in bitmap
+		int bit_id = entry_index * num_nodes + node_id;
+
+		// Check if already set
+		if (sharers[bit_id])
+			return;
+
+		// Set sharer
+		assert(entry->getNumSharers() < num_nodes);
+		entry->incNumSharers();
+		sharers.Set(bit_id);
+	}
+	else if (!entry->overflow)
+	{
+		// Check if already set
+		uint16_t *entry_pointers = getPointers(entry_index);
+		for (int i = 0; i < entry->num_sharers; i++)
+			if (entry_pointers[i] == node_id)
+				return;
+
+		// Set sharer in a free pointer, or overflow
+		if (entry->num_sharers < num_pointers)
+		{
+			entry_pointers[entry->num_sharers] = node_id;
+		}
+		else
+		{
+			Overflow(entry, entry_pointers);
+			if (encoding == EncodingCoarseVector)
+				setCoarseVectorSharer(entry_pointers, node_id);
+		}
+		entry->incNumSharers();
+	}
+	else
+	{
+		// With overflowed pointers, it is not possible to tell whether
+		// the node was already a sharer, so the number of sharers is
+		// an upper bound.
+		if (encoding == EncodingCoarseVector)
+			setCoarseVectorSharer(getPointers(entry_index), node_id);
+		if (entry->num_sharers < num_nodes)
+			entry->incNumSharers();
+	}
 	
 	// Trace
 	System::trace << misc::fmt("mem.set_sharer dir=\"%s\" "
@@ -126,26 +222,47 @@ void Directory::setSharer(int set_id, int way_id, int sub_block_id, int node_id)
 void Directory::clearSharer(int set_id, int way_id, int sub_block_id, int node_id)
 {
 	// Sanity
-	assert(misc::inRange(set_id, 0, num_sets - 1));
-	assert(misc::inRange(way_id, 0, num_ways - 1));
-	assert(misc::inRange(sub_block_id, 0, num_sub_blocks - 1));
 	assert(misc::inRange(node_id, 0, num_nodes - 1));
+	int entry_index = getEntryIndex(set_id, way_id, sub_block_id);
+	Entry *entry = &entries[entry_index];
 
-	// Get position in bitmap
-	int bit_id = set_id * num_ways * num_sub_blocks * num_nodes +
-			way_id * num_sub_blocks * num_nodes +
-			sub_block_id * num_nodes +
-			node_id;
-	
-	// Check if already clear
-	if (!sharers[bit_id])
+	// Full-map
+	if (encoding == EncodingFullMap)
+	{
+		// Get position in bitmap
+		int bit_id = entry_index * num_nodes + node_id;
+
+		// Check if already clear
+		if (!sharers[bit_id])
+			return;
+
+		// Clear sharer
+		assert(entry->getNumSharers() > 0);
+		entry->decNumSharers();
+		sharers.Set(bit_id, false);
+	}
+	else if (!entry->overflow)
+	{
+		// Look for the pointer
+		uint16_t *entry_pointers = getPointers(entry_index);
+		int index = 0;
+		while (index < entry->num_sharers &&
+				entry_pointers[index] != node_id)
+			index++;
+
+		// Check if already clear
+		if (index == entry->num_sharers)
+			return;
+
+		// Clear sharer, moving the last pointer into its place
+		entry->decNumSharers();
+		entry_pointers[index] = entry_pointers[entry->num_sharers];
+	}
+	else
+	{
+		// Sharers cannot be removed from an overflowed entry
 		return;
-	
-	// Clear sharer
-	Entry *entry = getEntry(set_id, way_id, sub_block_id);
-	assert(entry->getNumSharers() > 0);
-	entry->decNumSharers();
-	sharers.Set(bit_id, false);
+	}
 	
 	// Trace
 	System::trace << misc::fmt("mem.clear_sharer dir=\"%s\" "
@@ -170,19 +287,26 @@ void Directory::clearSharer(int set_id, int way_id, int sub_block_id, int node_i
 void Directory::clearAllSharers(int set_id, int way_id, int sub_block_id)
 {
 	// Skip if no sharer is present
-	Entry *entry = getEntry(set_id, way_id, sub_block_id);
+	int entry_index = getEntryIndex(set_id, way_id, sub_block_id);
+	Entry *entry = &entries[entry_index];
 	if (entry->getNumSharers() == 0)
 		return;
 	
-	// Get position in bitmap
-	int bit_id = set_id * num_ways * num_sub_blocks * num_nodes +
-			way_id * num_sub_blocks * num_nodes +
-			sub_block_id * num_nodes;
-	
 	// Clear all sharers
 	entry->setNumSharers(0);
-	for (int i = 0; i < num_nodes; i++)
-		sharers.Set(bit_id + i, false);
+	entry->overflow = false;
+	if (encoding == EncodingFullMap)
+	{
+		int bit_id = entry_index * num_nodes;
+		for (int i = 0; i < num_nodes; i++)
+			sharers.Set(bit_id + i, false);
+	}
+	else
+	{
+		uint16_t *entry_pointers = getPointers(entry_index);
+		for (int i = 0; i < num_pointers; i++)
+			entry_pointers[i] = 0;
+	}
 	
 	// Trace
 	System::trace << misc::fmt("mem.clear_all_sharers dir=\"%s\" "
@@ -202,22 +326,49 @@ void Directory::clearAllSharers(int set_id, int way_id, int sub_block_id)
 }
 
 
+void Directory::clearAllSharersExcept(int set_id, int way_id, int sub_block_id,
+		int node_id)
+{
+	// Entries with an exact set of sharers have been updated already by
+	// the calls to clearSharer() for each invalidated sharer.
+	Entry *entry = getEntry(set_id, way_id, sub_block_id);
+	if (!entry->overflow)
+		return;
+
+	// Keep only the given node, if it was a possible sharer
+	bool keep = node_id >= 0 && isSharer(set_id, way_id, sub_block_id,
+			node_id);
+	clearAllSharers(set_id, way_id, sub_block_id);
+	if (keep)
+		setSharer(set_id, way_id, sub_block_id, node_id);
+}
+
+
 bool Directory::isSharer(int set_id, int way_id, int sub_block_id, int node_id)
 {
 	// Sanity
-	assert(misc::inRange(set_id, 0, num_sets - 1));
-	assert(misc::inRange(way_id, 0, num_ways - 1));
-	assert(misc::inRange(sub_block_id, 0, num_sub_blocks - 1));
 	assert(misc::inRange(node_id, 0, num_nodes - 1));
+	int entry_index = getEntryIndex(set_id, way_id, sub_block_id);
 
-	// Get position in bitmap
-	int bit_id = set_id * num_ways * num_sub_blocks * num_nodes +
-			way_id * num_sub_blocks * num_nodes +
-			sub_block_id * num_nodes +
-			node_id;
-	
-	// Return whether sharer is present
-	return sharers[bit_id];
+	// Full-map
+	if (encoding == EncodingFullMap)
+		return sharers[entry_index * num_nodes + node_id];
+
+	// Exact sharer pointers
+	Entry *entry = &entries[entry_index];
+	uint16_t *entry_pointers = getPointers(entry_index);
+	if (!entry->overflow)
+	{
+		for (int i = 0; i < entry->num_sharers; i++)
+			if (entry_pointers[i] == node_id)
+				return true;
+		return false;
+	}
+
+	// Overflowed pointers. Limited pointers broadcast to all nodes.
+	if (encoding == EncodingLimitedPointer)
+		return true;
+	return isCoarseVectorSharer(entry_pointers, node_id);
 }
 
 
@@ -258,18 +409,19 @@ bool Directory::LockEntry(
 	assert(access_id > 0);
 	assert(misc::inRange(set_id, 0, num_sets - 1));
 	assert(misc::inRange(way_id, 0, num_ways - 1));
-	Lock *lock = &locks[set_id * num_ways + way_id];
+	int lock_index = set_id * num_ways + way_id;
+	long long &lock_access_id = lock_access_ids[lock_index];
 
 	// If the entry is already locked, enqueue a new waiter and return
-	// failure to lock.
-	if (lock->access_id)
+	// failure to lock. The queue is created on the first waiter.
+	if (lock_access_id)
 	{
-		lock->queue.Wait(event);
+		lock_queues[lock_index].Wait(event);
 		System::debug << misc::fmt("    "
 				"A-%lld suspended, "
 				"A-%lld has directory entry lock\n",
 				access_id,
-				lock->access_id);
+				lock_access_id);
 		return false;
 	}
 
@@ -293,7 +445,7 @@ bool Directory::LockEntry(
 			way_id);
 
 	// Lock entry
-	lock->access_id = access_id;
+	lock_access_id = access_id;
 	return true;
 }
 
@@ -303,9 +455,10 @@ void Directory::UnlockEntry(int set_id, int way_id, long long access_id)
 	// Get lock
 	assert(misc::inRange(set_id, 0, num_sets - 1));
 	assert(misc::inRange(way_id, 0, num_ways - 1));
-	Lock *lock = &locks[set_id * num_ways + way_id];
-	assert(lock->access_id > 0);
-	assert(access_id == lock->access_id);
+	int lock_index = set_id * num_ways + way_id;
+	long long &lock_access_id = lock_access_ids[lock_index];
+	assert(lock_access_id > 0);
+	assert(access_id == lock_access_id);
 
 	// Debug
 	System::debug << misc::fmt("    "
@@ -315,17 +468,20 @@ void Directory::UnlockEntry(int set_id, int way_id, long long access_id)
 			set_id,
 			way_id);
 
-	// Wake up all frames waiting in the queue.
+	// Wake up all frames waiting in the queue, and release the queue.
 	//
 	// NOTE: A previous bug causing deadlock consisted in only waking up the
 	// first waiter. If the first waiter, for some reason, doesn't get to
 	// lock the directory entry again, it will not reach the point where
 	// other waiters are eventually woken up.
 	//
-	if (lock->queue.getHead())
+	auto it = lock_queues.find(lock_index);
+	if (it != lock_queues.end())
 	{
 		// Debug
-		Frame *frame = misc::cast<Frame *>(lock->queue.getHead());
+		esim::Queue &queue = it->second;
+		assert(queue.getHead());
+		Frame *frame = misc::cast<Frame *>(queue.getHead());
 		while (true)
 		{
 			// Print debug info
@@ -342,7 +498,8 @@ void Directory::UnlockEntry(int set_id, int way_id, long long access_id)
 		}
 
 		// Wake up access
-		lock->queue.WakeupAll();
+		queue.WakeupAll();
+		lock_queues.erase(it);
 	}
 
 	// Trace
@@ -357,21 +514,17 @@ void Directory::UnlockEntry(int set_id, int way_id, long long access_id)
 			way_id);
 
 	// Unlock entry
-	lock->access_id = 0;
+	lock_access_id = 0;
 }
 
 
 long long Directory::getEntryAccessId(int set_id, int way_id) const
 {
-	// Get lock
+	// Return access locking entry
 	assert(misc::inRange(set_id, 0, num_sets - 1));
 	assert(misc::inRange(way_id, 0, num_ways - 1));
-	Lock *lock = &locks[set_id * num_ways + way_id];
-
-	// Return frame locking entry
-	return lock->access_id;
+	return lock_access_ids[set_id * num_ways + way_id];
 }
 
 
 }  // namespace mem
-
@@ -21,9 +21,12 @@
 #define MEMORY_DIRECTORY_H
 
 #include <cassert>
+#include <cstdint>
+#include <unordered_map>
 
 #include <lib/cpp/Bitmap.h>
 #include <lib/cpp/Misc.h>
+#include <lib/cpp/String.h>
 #include <lib/esim/Queue.h>
 
 
@@ -41,14 +44,44 @@ public:
 	/// Value set to an owner identifier to represent no owner
 	static const int NoOwner = -1;
 
+	/// Encoding of the set of sharers of a directory entry
+	enum Encoding
+	{
+		EncodingInvalid = 0,
+
+		/// One bit per node and entry. The set of sharers is always
+		/// exact.
+		EncodingFullMap,
+
+		/// A fixed number of node pointers per entry. When more nodes
+		/// share the entry, the entry falls back to broadcast, and all
+		/// nodes are considered sharers.
+		EncodingLimitedPointer,
+
+		/// A fixed number of node pointers per entry. When more nodes
+		/// share the entry, the pointer storage is reinterpreted as a
+		/// bit vector with one bit per group of nodes.
+		EncodingCoarseVector
+	};
+
+	/// String map for Encoding
+	static const misc::StringMap EncodingMap;
+
 	/// Directory entry
 	class Entry
 	{
+		// Only Directory updates the overflow flag
+		friend class Directory;
+
 		// Owner identifier
-		int owner = NoOwner;
+		int16_t owner = NoOwner;
+
+		// Number of sharers. When the sharer pointers have overflowed,
+		// this is an upper bound on the number of sharers.
+		uint16_t num_sharers = 0;
 
-		// Number of sharers
-		int num_sharers = 0;
+		// Set when the sharers no longer fit in the entry pointers
+		bool overflow = false;
 
 	public:
 
@@ -58,6 +91,11 @@ public:
 		/// Return number of sharers
 		int getNumSharers() const { return num_sharers; }
 
+		/// Return whether the set of sharers is no longer exact because
+		/// the sharer pointers have overflowed. This only occurs with
+		/// encodings other than full-map.
+		bool isOverflow() const { return overflow; }
+
 		/// Set new owner
 		void setOwner(int owner) { this->owner = owner; }
 
@@ -76,17 +114,6 @@ public:
 
 private:
 
-	// Entry lock
-	struct Lock
-	{
-		// Unique identifier of access locking directory entry, or 0
-		// if the directory entry is not locked.
-		long long access_id = 0;
-
-		// Queue of frames waiting for the lock to be released.
-		esim::Queue queue;
-	};
-
 	// Name of directory
 	std::string name;
 
@@ -96,14 +123,70 @@ private:
 	int num_sub_blocks;
 	int num_nodes;
 
-	// Bitmap of sharers for the entire directory
+	// Sharer encoding
+	Encoding encoding;
+
+	// Number of sharer pointers per entry for encodings other than
+	// full-map
+	int num_pointers;
+
+	// Number of nodes represented by each bit of a coarse vector
+	int coarse_group_size = 1;
+
+	// Bitmap of sharers for the entire directory, for the full-map
+	// encoding
 	misc::Bitmap sharers;
 
+	// Sharer pointers for the entire directory, for encodings other than
+	// full-map. An entry in coarse vector mode uses its pointers as a
+	// bit vector instead.
+	std::unique_ptr<uint16_t[]> pointers;
+
 	// Directory entries
 	std::unique_ptr<Entry[]> entries;
 
-	// Directory locks
-	std::unique_ptr<Lock[]> locks;
+	// Identifier of the access locking each directory entry, or 0 if the
+	// entry is not locked
+	std::unique_ptr<long long[]> lock_access_ids;
+
+	// Queues of accesses waiting for a directory entry lock to be
+	// released, indexed by set and way. A queue is only allocated while
+	// there are accesses waiting for the entry.
+	std::unordered_map<int, esim::Queue> lock_queues;
+
+	// Return the index of a directory entry
+	int getEntryIndex(int set_id, int way_id, int sub_block_id) const
+	{
+		assert(misc::inRange(set_id, 0, num_sets - 1));
+		assert(misc::inRange(way_id, 0, num_ways - 1));
+		assert(misc::inRange(sub_block_id, 0, num_sub_blocks - 1));
+		return (set_id * num_ways + way_id) * num_sub_blocks +
+				sub_block_id;
+	}
+
+	// Return the sharer pointers of a directory entry
+	uint16_t *getPointers(int entry_index) const
+	{
+		return &pointers[entry_index * num_pointers];
+	}
+
+	// Return whether a node is present in the coarse vector formed by
+	// the given pointers.
+	bool isCoarseVectorSharer(uint16_t *vector, int node_id) const
+	{
+		int bit = node_id / coarse_group_size;
+		return vector[bit / 16] & (1 << (bit % 16));
+	}
+
+	// Add a node to the coarse vector formed by the given pointers
+	void setCoarseVectorSharer(uint16_t *vector, int node_id)
+	{
+		int bit = node_id / coarse_group_size;
+		vector[bit / 16] |= 1 << (bit % 16);
+	}
+
+	// Switch an entry whose pointers are full to overflow mode
+	void Overflow(Entry *entry, uint16_t *entry_pointers);
 
 public:
 
@@ -124,11 +207,20 @@ public:
 	/// \param num_nodes
 	///	Number of nodes that can be sharers of each sub-block
 	///
+	/// \param encoding
+	///	Encoding of the set of sharers of each sub-block
+	///
+	/// \param num_pointers
+	///	Number of sharer pointers per sub-block, for encodings other
+	///	than full-map
+	///
 	Directory(const std::string &name,
 			int num_sets,
 			int num_ways,
 			int num_sub_blocks,
-			int num_nodes);
+			int num_nodes,
+			Encoding encoding = EncodingFullMap,
+			int num_pointers = 4);
 	
 	/// Return the number of sets
 	int getNumSets() { return num_sets; }
@@ -142,15 +234,20 @@ public:
 	/// Return the number of nodes that can be sharers of each sub-block
 	int getNumNodes() { return num_nodes; }
 
+	/// Return the sharer encoding
+	Encoding getEncoding() const { return encoding; }
+
+	/// Return the number of sharer pointers per sub-block
+	int getNumPointers() const { return num_pointers; }
+
+	/// Return the approximate amount of host memory used by the sharer
+	/// information, entries, and locks of the directory, in bytes
+	long long getStorageSize() const;
+
 	/// Return a directory entry
 	Entry *getEntry(int set_id, int way_id, int sub_block_id)
 	{
-		assert(misc::inRange(set_id, 0, num_sets - 1));
-		assert(misc::inRange(way_id, 0, num_ways - 1));
-		assert(misc::inRange(sub_block_id, 0, num_sub_blocks - 1));
-		return &entries.get()[set_id * num_ways * num_sub_blocks +
-				way_id * num_sub_blocks +
-				sub_block_id];
+		return &entries[getEntryIndex(set_id, way_id, sub_block_id)];
 	}
 
 	/// Set new owner for the directory entry
@@ -159,13 +256,26 @@ public:
 	/// Activate one sharer for a directory entry
 	void setSharer(int set_id, int way_id, int sub_block_id, int node);
 
-	/// Disable one sharer for a directory entry
+	/// Disable one sharer for a directory entry. If the sharer pointers
+	/// of the entry have overflowed, the sharer cannot be removed, and
+	/// the entry keeps its conservative set of sharers until a call to
+	/// clearAllSharers() or clearAllSharersExcept().
 	void clearSharer(int set_id, int way_id, int sub_block_id, int node);
 
 	/// Clear all sharers of a directory entry
 	void clearAllSharers(int set_id, int way_id, int sub_block_id);
 
-	/// Return whether a sharer is present in a directory entry
+	/// Clear all sharers of a directory entry except \a node_id, which
+	/// remains the only sharer if it was a sharer before. A value of -1
+	/// for \a node_id clears all sharers. This function is invoked once
+	/// all sharers but \a node_id have been invalidated, and returns an
+	/// overflowed entry to its exact representation.
+	void clearAllSharersExcept(int set_id, int way_id, int sub_block_id,
+			int node_id);
+
+	/// Return whether a sharer is present in a directory entry. If the
+	/// sharer pointers of the entry have overflowed, the function can
+	/// return true for nodes that are not actual sharers.
 	bool isSharer(int set_id, int way_id, int sub_block_id, int node_id);
 
 	/// Return whether part of a block is shared or owned
@@ -153,6 +153,10 @@ public:
 	/// Flag indicating whether this access is a non-coherent write.
 	bool nc_write = false;
 
+	/// Flag indicating whether this access is a load issued by the
+	/// prefetcher of the module, instead of a demand access.
+	bool prefetch = false;
+
 	/// Flag indicating whether there is a block eviction in the current
 	/// access.
 	bool eviction = false;
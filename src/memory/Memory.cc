@@ -91,6 +91,7 @@ Memory::Page *Memory::newPage(unsigned address, unsigned perm)
 	// Obtain inserted page
 	auto it = ret.first;
 	Page *page = it->second.get();
+	Modify(page);
 
 	// Return it
 	return page;
@@ -117,6 +118,7 @@ void Memory::Copy(unsigned dest, unsigned src, unsigned size)
 		
 		// Different actions depending on whether source and
 		// destination page data are allocated.
+		Modify(page_dest);
 		if (page_src->getData())
 		{
 			page_dest->AllocateData();
@@ -153,6 +155,10 @@ char *Memory::getBuffer(unsigned address, unsigned size, AccessType access)
 	if ((page->getPerm() & access) != access && safe)
 		throw Error(misc::fmt("[0x%x] Permission denied", address));
 	
+	// The caller may write through the returned pointer
+	if (access & (AccessWrite | AccessInit))
+		Modify(page);
+
 	// Return pointer to page data
 	page->AllocateData();
 	return page->getData() + offset;
@@ -210,6 +216,7 @@ void Memory::AccessAtPageBoundary(unsigned address, unsigned size,
 	// Write/initialize access
 	if (access == AccessWrite || access == AccessInit)
 	{
+		Modify(page);
 		page->AllocateData();
 		memcpy(page->getData() + offset, buffer, size);
 		return;
@@ -80,6 +80,9 @@ public:
 		// Page permissions
 		unsigned perm;
 
+		// Version of the page contents, changed on every write
+		unsigned long long version = 0;
+
 		// The page data
 		std::unique_ptr<char[]> data;
 	
@@ -120,6 +123,18 @@ public:
 		/// Add a flag to the page permissions, given as a bitmap of
 		/// flags of type AccessType.
 		void addPerm(unsigned perm) { this->perm |= perm; }
+
+		/// Return the version of the page contents. Two pages of the
+		/// same memory object never share a version, and the version
+		/// of a page changes every time its contents are written, so
+		/// a version seen before guarantees unchanged contents.
+		unsigned long long getVersion() const { return version; }
+
+		/// Set the version of the page contents
+		void setVersion(unsigned long long version)
+		{
+			this->version = version;
+		}
 	};
 
 private:
@@ -140,6 +155,12 @@ private:
 	/// Last accessed address
 	unsigned last_address = 0;
 
+	/// Last version assigned to a page
+	unsigned long long last_version = 0;
+
+	// Assign a new version to the contents of a page
+	void Modify(Page *page) { page->setVersion(++last_version); }
+
 	/// Create a new page and add it to the page table. The value given in
 	/// \a perm is an *or*'ed bitmap of AccessType flags.
 	Page *newPage(unsigned address, unsigned perm);
@@ -22,6 +22,8 @@
 #include <iostream>
 #include <iomanip>
 
+#include <lib/esim/Statistics.h>
+
 #include "Frame.h"
 #include "Module.h"
 #include "System.h"
@@ -49,6 +51,23 @@ Module::Module(const std::string &name,
 	// Block size
 	assert(!(block_size & (block_size - 1)) && block_size >= 4);
 	log_block_size = misc::LogBase2(block_size);
+
+	// Interval statistics
+	std::string prefix = "mem." + name + ".";
+	esim::StatisticsRegistry::Register(prefix + "accesses",
+			&num_accesses);
+	esim::StatisticsRegistry::Register(prefix + "evictions",
+			&num_evictions);
+	esim::StatisticsRegistry::Register(prefix + "reads", &num_reads);
+	esim::StatisticsRegistry::Register(prefix + "read_hits",
+			&num_read_hits);
+	esim::StatisticsRegistry::Register(prefix + "read_misses",
+			&num_read_misses);
+	esim::StatisticsRegistry::Register(prefix + "writes", &num_writes);
+	esim::StatisticsRegistry::Register(prefix + "write_hits",
+			&num_write_hits);
+	esim::StatisticsRegistry::Register(prefix + "write_misses",
+			&num_write_misses);
 }
 
 
@@ -197,6 +216,12 @@ long long Module::Access(AccessType access_type,
 			event = System::event_nc_store;
 			break;
 
+		case AccessPrefetch:
+
+			event = System::event_load;
+			frame->prefetch = true;
+			break;
+
 		default:
 
 			throw misc::Panic("Invalid access type");
@@ -851,6 +876,16 @@ void Module::DumpReport(std::ostream &os) const
 	if (type == TypeCache)
 		os << misc::fmt("ConflictInvalidation = %lld\n",
 				num_conflict_invalidations);
+
+	// Statistics - Prefetcher
+	if (prefetcher)
+	{
+		os << "\n";
+		prefetcher->DumpReport(os, num_read_misses +
+				num_write_misses + num_nc_write_misses -
+				num_retry_read_misses - num_retry_write_misses -
+				num_retry_nc_write_misses);
+	}
 	
 	// Separating line between modules
 	os << "\n\n";
@@ -20,6 +20,7 @@
 #ifndef MEMORY_MODULE_H
 #define MEMORY_MODULE_H
 
+#include <algorithm>
 #include <list>
 #include <memory>
 #include <unordered_map>
@@ -32,6 +33,7 @@
 
 #include "Cache.h"
 #include "Directory.h"
+#include "Prefetcher.h"
 
 
 // Forward declarations
@@ -74,7 +76,8 @@ public:
 		AccessInvalid = 0,
 		AccessLoad,
 		AccessStore,
-		AccessNCStore
+		AccessNCStore,
+		AccessPrefetch
 	};
 
 	// Port in a memory module
@@ -190,6 +193,12 @@ private:
 	// Directory associativity
 	int directory_num_ways = 0;
 
+	// Encoding of directory sharers
+	Directory::Encoding directory_encoding = Directory::EncodingFullMap;
+
+	// Number of sharer pointers per directory entry
+	int directory_num_pointers = 4;
+
 
 
 	//
@@ -245,6 +254,9 @@ private:
 	// Associated cache
 	std::unique_ptr<Cache> cache;
 
+	// Hardware prefetcher, or nullptr if prefetching is disabled
+	std::unique_ptr<Prefetcher> prefetcher;
+
 	// List of previous-level modules, closer to the processor
 	std::vector<Module *> high_modules;
 
@@ -333,6 +345,16 @@ public:
 		directory_size = directory_num_sets * directory_num_ways;
 	}
 
+	/// Set the encoding of directory sharers, and the number of sharer
+	/// pointers per directory entry for encodings other than full-map.
+	/// This does not instantiate the directory.
+	void setDirectoryEncoding(Directory::Encoding directory_encoding,
+			int directory_num_pointers)
+	{
+		this->directory_encoding = directory_encoding;
+		this->directory_num_pointers = directory_num_pointers;
+	}
+
 	/// Initialize the associated directory.
 	void InitializeDirectory(
 			int num_sets,
@@ -346,7 +368,9 @@ public:
 				num_sets,
 				num_ways,
 				num_sub_blocks,
-				num_nodes);
+				num_nodes,
+				directory_encoding,
+				directory_num_pointers);
 	}
 
 	/// Return the directory associated with the module. If no directory
@@ -460,6 +484,28 @@ public:
 	/// created by a call to setCache(). If setCache() wasn't invoked
 	/// before, return nullptr.
 	Cache *getCache() const { return cache.get(); }
+
+	/// Attach a hardware prefetcher to the module. The module must have
+	/// a cache, created with a previous call to setCache().
+	void setPrefetcher(Prefetcher::Kind kind,
+			int degree,
+			int distance,
+			int table_size,
+			int max_in_flight)
+	{
+		assert(cache.get());
+		assert(!prefetcher.get());
+		prefetcher = misc::new_unique<Prefetcher>(this,
+				kind,
+				degree,
+				distance,
+				table_size,
+				max_in_flight);
+	}
+
+	/// Return the prefetcher associated with the module, or nullptr if
+	/// the module has no prefetcher.
+	Prefetcher *getPrefetcher() const { return prefetcher.get(); }
 	
 	/// Set the address range served by the module between \a low and
 	/// \a high physical addresses.
@@ -499,6 +545,13 @@ public:
 		high_modules.push_back(high_module);
 	}
 
+	/// Return whether the given module is a high module of this module.
+	bool isHighModule(Module *module) const
+	{
+		return std::find(high_modules.begin(), high_modules.end(),
+				module) != high_modules.end();
+	}
+
 	/// Return the number of low modules connected to this module (closer to
 	/// main memory).
 	int getNumLowModules() const { return low_modules.size(); }
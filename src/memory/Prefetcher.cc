@@ -0,0 +1,346 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cassert>
+
+#include <lib/cpp/Misc.h>
+
+#include "Mmu.h"
+#include "Module.h"
+#include "Prefetcher.h"
+#include "System.h"
+
+
+namespace mem
+{
+
+const misc::StringMap Prefetcher::KindMap =
+{
+	{ "None", KindNone },
+	{ "NextLine", KindNextLine },
+	{ "Stride", KindStride },
+	{ "Stream", KindStream }
+};
+
+
+Prefetcher::Prefetcher(Module *module,
+		Kind kind,
+		int degree,
+		int distance,
+		int table_size,
+		int max_in_flight) :
+		module(module),
+		kind(kind),
+		degree(degree),
+		distance(distance),
+		table_size(table_size),
+		max_in_flight(max_in_flight)
+{
+	// Block size
+	log_block_size = misc::LogBase2(module->getBlockSize());
+
+	// Tables
+	if (kind == KindStride)
+		stride_table = misc::new_unique_array<StrideEntry>(table_size);
+	else if (kind == KindStream)
+		streams = misc::new_unique_array<StreamEntry>(table_size);
+}
+
+
+void Prefetcher::Issue(int block, unsigned page)
+{
+	// Never cross a page boundary, since the physical address of the next
+	// virtual page is unknown.
+	unsigned address = (unsigned) block << log_block_size;
+	if (block < 0 || address >> Mmu::LogPageSize != page)
+		return;
+
+	// Skip blocks served by another module in an interleaved configuration
+	if (!module->ServesAddress(address))
+		return;
+
+	// Skip blocks that are already present or in flight
+	int set;
+	int way;
+	int tag;
+	Cache::BlockState state;
+	if (module->isInFlightAddress(address) ||
+			module->FindBlock(address, set, way, tag, state))
+		return;
+
+	// Prefetches have lower priority than demand accesses. They are
+	// dropped if they would take the last resources of the module.
+	if ((int) in_flight.size() >= max_in_flight ||
+			!module->canAccess(address))
+	{
+		num_dropped++;
+		return;
+	}
+
+	// Issue prefetch
+	System::debug << misc::fmt("  %lld prefetch %s 0x%x\n",
+			esim::Engine::getInstance()->getCycle(),
+			module->getName().c_str(), address);
+	long long id = module->Access(Module::AccessPrefetch, address);
+	in_flight[id].block_address = address;
+	num_issued++;
+}
+
+
+void Prefetcher::TrainNextLine(int block, unsigned page)
+{
+	for (int i = 0; i < degree; i++)
+		Issue(block + distance + i, page);
+}
+
+
+void Prefetcher::TrainStride(int block, unsigned page)
+{
+	// Look up the entry for the page, direct-mapped
+	StrideEntry &entry = stride_table[page % table_size];
+	if (!entry.valid || entry.page != page)
+	{
+		entry.valid = true;
+		entry.page = page;
+		entry.last_block = block;
+		entry.stride = 0;
+		entry.confidence = 0;
+		return;
+	}
+
+	// Repeated access to the same block
+	int stride = block - entry.last_block;
+	if (!stride)
+		return;
+
+	// Update confidence as a 2-bit saturating counter
+	if (stride == entry.stride)
+	{
+		if (entry.confidence < 3)
+			entry.confidence++;
+	}
+	else
+	{
+		if (entry.confidence > 0)
+			entry.confidence--;
+		if (entry.confidence == 0)
+			entry.stride = stride;
+	}
+	entry.last_block = block;
+
+	// Prefetch ahead along the stride once it is confirmed
+	if (entry.confidence < 2)
+		return;
+	for (int i = 0; i < degree; i++)
+		Issue(block + entry.stride * (distance + i), page);
+}
+
+
+void Prefetcher::TrainStream(int block, unsigned page)
+{
+	// Look for an active stream that the access falls into, between the
+	// last demand access and the prefetch head.
+	stream_clock++;
+	for (int i = 0; i < table_size; i++)
+	{
+		StreamEntry &stream = streams[i];
+		if (!stream.valid || !stream.direction)
+			continue;
+		int offset = (block - stream.last_block) * stream.direction;
+		int window = (stream.head_block - stream.last_block) *
+				stream.direction;
+		if (offset <= 0 || offset > window + 1)
+			continue;
+
+		// Advance the stream, keeping up to 'distance' blocks ahead of
+		// the demand accesses, issuing up to 'degree' per trigger.
+		stream.last_block = block;
+		stream.last_use = stream_clock;
+		if ((stream.head_block - block) * stream.direction < 0)
+			stream.head_block = block;
+		for (int j = 0; j < degree; j++)
+		{
+			int next = stream.head_block + stream.direction;
+			if ((next - block) * stream.direction > distance)
+				break;
+			stream.head_block = next;
+			Issue(next, page);
+		}
+		return;
+	}
+
+	// Look for a stream in training mode whose miss is adjacent to this one,
+	// which sets the direction of the stream.
+	for (int i = 0; i < table_size; i++)
+	{
+		StreamEntry &stream = streams[i];
+		if (!stream.valid || stream.direction)
+			continue;
+		int offset = block - stream.last_block;
+		if (offset != 1 && offset != -1)
+			continue;
+		stream.direction = offset;
+		stream.last_block = block;
+		stream.head_block = block;
+		stream.last_use = stream_clock;
+		for (int j = 0; j < degree; j++)
+		{
+			stream.head_block += stream.direction;
+			Issue(stream.head_block, page);
+		}
+		return;
+	}
+
+	// Allocate a new stream in training mode, replacing the least recently
+	// used one.
+	StreamEntry *victim = &streams[0];
+	for (int i = 0; i < table_size; i++)
+	{
+		StreamEntry &stream = streams[i];
+		if (!stream.valid)
+		{
+			victim = &stream;
+			break;
+		}
+		if (stream.last_use < victim->last_use)
+			victim = &stream;
+	}
+	victim->valid = true;
+	victim->direction = 0;
+	victim->last_block = block;
+	victim->head_block = block;
+	victim->last_use = stream_clock;
+}
+
+
+void Prefetcher::Train(unsigned address, bool hit, bool prefetch_hit)
+{
+	// Prefetchers are triggered by demand misses, and by the first hit on
+	// a prefetched block, which would have been a miss otherwise.
+	if (hit && !prefetch_hit && kind != KindStride)
+		return;
+
+	// Block number and page
+	int block = address >> log_block_size;
+	unsigned page = address >> Mmu::LogPageSize;
+
+	// Train
+	switch (kind)
+	{
+
+	case KindNextLine:
+
+		TrainNextLine(block, page);
+		break;
+
+	case KindStride:
+
+		TrainStride(block, page);
+		break;
+
+	case KindStream:
+
+		TrainStream(block, page);
+		break;
+
+	default:
+
+		break;
+	}
+}
+
+
+void Prefetcher::RecordUse(unsigned block_address)
+{
+	// Statistics
+	num_useful++;
+
+	// Mark in-flight prefetches to the block as used
+	for (auto &pair : in_flight)
+		if (pair.second.block_address == block_address)
+			pair.second.used = true;
+
+	// Clear the flag of the block if the prefetch already filled it
+	Cache *cache = module->getCache();
+	unsigned set;
+	unsigned way;
+	Cache::BlockState state;
+	if (cache->FindBlock(block_address, set, way, state))
+		cache->getBlock(set, way)->setPrefetched(false);
+}
+
+
+void Prefetcher::RecordLateUse(long long id)
+{
+	// Ignore accesses other than prefetches, or prefetches already used
+	auto it = in_flight.find(id);
+	if (it == in_flight.end() || it->second.used)
+		return;
+
+	// Record use. The demand access would have missed without the
+	// prefetch, so it triggers the prefetcher like a hit on a prefetched
+	// block.
+	unsigned block_address = it->second.block_address;
+	num_late++;
+	RecordUse(block_address);
+	Train(block_address, true, true);
+}
+
+
+void Prefetcher::RecordTimelyUse(unsigned address)
+{
+	RecordUse(address & ~(module->getBlockSize() - 1));
+}
+
+
+bool Prefetcher::isUsed(long long id) const
+{
+	auto it = in_flight.find(id);
+	assert(it != in_flight.end());
+	return it->second.used;
+}
+
+
+void Prefetcher::FinishPrefetch(long long id)
+{
+	int count = in_flight.erase(id);
+	assert(count == 1);
+	(void) count;
+}
+
+
+void Prefetcher::DumpReport(std::ostream &os, long long num_demand_misses) const
+{
+	os << "Prefetcher = " << KindMap.MapValue(kind) << '\n';
+	os << misc::fmt("Prefetches = %lld\n", num_issued);
+	os << misc::fmt("DroppedPrefetches = %lld\n", num_dropped);
+	os << misc::fmt("UsefulPrefetches = %lld\n", num_useful);
+	os << misc::fmt("LatePrefetches = %lld\n", num_late);
+	os << misc::fmt("PrefetchAccuracy = %.4g\n", num_issued ?
+			(double) num_useful / num_issued : 0.0);
+	os << misc::fmt("PrefetchCoverage = %.4g\n",
+			num_useful + num_demand_misses ?
+			(double) num_useful / (num_useful + num_demand_misses) :
+			0.0);
+	os << misc::fmt("PrefetchTimeliness = %.4g\n", num_useful ?
+			(double) (num_useful - num_late) / num_useful : 0.0);
+}
+
+
+}  // namespace mem
@@ -0,0 +1,207 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MEMORY_PREFETCHER_H
+#define MEMORY_PREFETCHER_H
+
+#include <iostream>
+#include <memory>
+#include <unordered_map>
+
+#include <lib/cpp/String.h>
+
+
+namespace mem
+{
+
+// Forward declarations
+class Module;
+
+
+/// Hardware prefetcher attached to a cache module. The prefetcher observes
+/// the demand accesses that reach the module, and issues prefetches for the
+/// blocks it predicts will be accessed next. Prefetches are regular loads
+/// started with Module::Access(), and are only issued when the module has
+/// a free port and MSHR entry, so that they never hold back demand accesses.
+class Prefetcher
+{
+public:
+
+	/// Prefetcher kinds
+	enum Kind
+	{
+		KindInvalid = 0,
+		KindNone,
+		KindNextLine,
+		KindStride,
+		KindStream
+	};
+
+	/// String map for Kind
+	static const misc::StringMap KindMap;
+
+private:
+
+	// Entry of the stride table, tracking the last block accessed within
+	// a memory page and the stride between consecutive accesses.
+	struct StrideEntry
+	{
+		bool valid = false;
+		unsigned page = 0;
+		int last_block = 0;
+		int stride = 0;
+		int confidence = 0;
+	};
+
+	// Stream tracker. A stream is allocated on a demand miss, and becomes
+	// active once a second miss to an adjacent block sets its direction.
+	// Blocks between 'last_block' and 'head_block' have been prefetched.
+	struct StreamEntry
+	{
+		bool valid = false;
+		int direction = 0;
+		int last_block = 0;
+		int head_block = 0;
+		long long last_use = 0;
+	};
+
+	// Prefetch in flight
+	struct InFlightEntry
+	{
+		// Address of the prefetched block
+		unsigned block_address = 0;
+
+		// A demand access already used the prefetch
+		bool used = false;
+	};
+
+	// Module the prefetcher is attached to
+	Module *module;
+
+	// Prefetcher kind
+	Kind kind;
+
+	// Number of blocks prefetched per trigger
+	int degree;
+
+	// Distance in blocks, or in strides, of the first prefetched block
+	// from the triggering access
+	int distance;
+
+	// Number of entries in the stride table or number of stream trackers
+	int table_size;
+
+	// Maximum number of prefetches in flight
+	int max_in_flight;
+
+	// Log base 2 of the module block size
+	int log_block_size;
+
+	// Stride table
+	std::unique_ptr<StrideEntry[]> stride_table;
+
+	// Stream trackers
+	std::unique_ptr<StreamEntry[]> streams;
+
+	// Counter used to order stream trackers by last use
+	long long stream_clock = 0;
+
+	// Prefetches in flight, indexed by access identifier
+	std::unordered_map<long long, InFlightEntry> in_flight;
+
+	// Count a use of the prefetched block at the given address, and clear
+	// its prefetched flag if it is already present in the cache.
+	void RecordUse(unsigned block_address);
+
+	// Issue a prefetch for the block with the given block number, only if
+	// it lies in the same page as 'page', it is not present or in flight
+	// in the module, and the module has resources available.
+	void Issue(int block, unsigned page);
+
+	// Train each prefetcher kind with a demand access
+	void TrainNextLine(int block, unsigned page);
+	void TrainStride(int block, unsigned page);
+	void TrainStream(int block, unsigned page);
+
+	// Statistics
+	long long num_issued = 0;
+	long long num_dropped = 0;
+	long long num_useful = 0;
+	long long num_late = 0;
+
+public:
+
+	/// Constructor
+	Prefetcher(Module *module,
+			Kind kind,
+			int degree,
+			int distance,
+			int table_size,
+			int max_in_flight);
+
+	/// Return the prefetcher kind
+	Kind getKind() const { return kind; }
+
+	/// Observe a demand access to \a address that reached the module. Flag
+	/// \a hit indicates whether the access hit in the cache, and flag
+	/// \a prefetch_hit whether it hit a block brought by a prefetch that
+	/// had not been used yet. This function may issue new prefetches.
+	void Train(unsigned address, bool hit, bool prefetch_hit);
+
+	/// Record that a demand access found the access with identifier \a id
+	/// in flight and will wait for it. If \a id is a prefetch that had not
+	/// been used yet, it is counted as a useful but late prefetch.
+	void RecordLateUse(long long id);
+
+	/// Record that a demand access to \a address hit a block with the
+	/// prefetched flag set. The prefetch is counted as useful and timely,
+	/// and the flag is cleared.
+	void RecordTimelyUse(unsigned address);
+
+	/// Return whether a demand access already waited for the prefetch with
+	/// identifier \a id, which must be in flight.
+	bool isUsed(long long id) const;
+
+	/// Record the completion of the prefetch with identifier \a id
+	void FinishPrefetch(long long id);
+
+	/// Return the number of prefetches in flight
+	int getNumInFlight() const { return in_flight.size(); }
+
+	/// Return the number of issued prefetches
+	long long getNumIssued() const { return num_issued; }
+
+	/// Return the number of prefetches that were used by a demand access
+	long long getNumUseful() const { return num_useful; }
+
+	/// Return the number of useful prefetches that were still in flight
+	/// when the demand access arrived
+	long long getNumLate() const { return num_late; }
+
+	/// Dump the prefetcher statistics as part of the module report.
+	/// Argument \a num_demand_misses is the number of demand misses in the
+	/// module, used to compute the coverage.
+	void DumpReport(std::ostream &os, long long num_demand_misses) const;
+};
+
+
+}  // namespace mem
+
+#endif
+
@@ -202,6 +202,10 @@ class System
 			Module *module,
 			const std::string &section);
 
+	void ConfigReadModuleDirectoryEncoding(misc::IniFile *ini_file,
+			Module *module,
+			const std::string &section);
+
 	void ConfigReadModules(misc::IniFile *ini_file);
 
 	void ConfigCheckRouteToMainMemory(
@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+
 #include <arch/common/Arch.h>
 #include <arch/common/Timing.h>
 #include <lib/esim/Engine.h>
@@ -141,6 +143,20 @@ const std::string System::help_message =
 	"      When a module serves only a subset of the address space, the user must\n"
 	"      make sure that the rest of the modules at the same level serve the\n"
 	"      remaining address space.\n"
+	"  DirectoryEncoding = {FullMap|LimitedPointer|CoarseVector}\n"
+	"      (Default = FullMap)\n"
+	"      Encoding of the set of upper-level sharers of each directory entry.\n"
+	"      'FullMap' keeps one bit per upper-level node, and always knows the\n"
+	"      exact sharers. 'LimitedPointer' keeps 'DirectoryPointers' node\n"
+	"      identifiers per entry, and falls back to broadcast invalidations\n"
+	"      when more nodes share the entry. 'CoarseVector' keeps the same\n"
+	"      pointers, but falls back to a bit vector where each bit covers a\n"
+	"      group of nodes. The last two reduce the host memory used by\n"
+	"      directories with many upper-level nodes, at the cost of extra\n"
+	"      invalidation traffic.\n"
+	"  DirectoryPointers = <num> (Default = 4)\n"
+	"      Number of sharer pointers per directory entry for encodings other\n"
+	"      than 'FullMap'.\n"
 	"\n"
 	"Section [CacheGeometry <geo>] defines a geometry for a cache. Caches using\n"
 	"this geometry are instantiated [Module <name>] sections.\n"
@@ -170,6 +186,24 @@ const std::string System::help_message =
 	"      it is resolved, but releases the cache port.\n"
 	"  DirectoryLatency = <cycles> (Default = 1)\n"
 	"      Latency for a directory access in number of cycles.\n"
+	"  Prefetcher = {None|NextLine|Stride|Stream} (Default = None)\n"
+	"      Hardware prefetcher attached to the cache. 'NextLine' prefetches the\n"
+	"      blocks following a missing block. 'Stride' detects constant strides\n"
+	"      between consecutive accesses within the same memory page. 'Stream'\n"
+	"      detects sequences of misses to adjacent blocks, and keeps a window of\n"
+	"      blocks prefetched ahead of them. Prefetches never cross a page\n"
+	"      boundary, and are dropped when the cache runs out of free ports or\n"
+	"      MSHR entries.\n"
+	"  PrefetcherDegree = <num> (Default = 2)\n"
+	"      Maximum number of blocks prefetched after each triggering access.\n"
+	"  PrefetcherDistance = <num> (Default = 1)\n"
+	"      For 'NextLine' and 'Stride', distance in blocks or strides of the\n"
+	"      first prefetched block from the triggering access. For 'Stream',\n"
+	"      maximum number of blocks prefetched ahead of the last access.\n"
+	"  PrefetcherTableSize = <num> (Default = 64)\n"
+	"      Number of entries in the stride table, or number of streams tracked.\n"
+	"  PrefetcherMaxInFlight = <num> (Default = MSHR / 2)\n"
+	"      Maximum number of prefetches in flight in the cache.\n"
 	"\n"
 	"Section [Network <net>] defines an internal default interconnect, formed of\n"
 	"a single switch connecting all modules pointing to the network. For every\n"
@@ -500,6 +534,16 @@ Module *System::ConfigReadCache(misc::IniFile *ini_file,
 			"WritePolicy", "WriteBack");
 	int mshr_size = ini_file->ReadInt(geometry_section, "MSHR", 16);
 	int num_ports = ini_file->ReadInt(geometry_section, "Ports", 2);
+	std::string prefetcher_str = ini_file->ReadString(geometry_section,
+			"Prefetcher", "None");
+	int prefetcher_degree = ini_file->ReadInt(geometry_section,
+			"PrefetcherDegree", 2);
+	int prefetcher_distance = ini_file->ReadInt(geometry_section,
+			"PrefetcherDistance", 1);
+	int prefetcher_table_size = ini_file->ReadInt(geometry_section,
+			"PrefetcherTableSize", 64);
+	int prefetcher_max_in_flight = ini_file->ReadInt(geometry_section,
+			"PrefetcherMaxInFlight", std::max(1, mshr_size / 2));
 
 	// Check replacement policy
 	Cache::ReplacementPolicy replacement_policy =
@@ -577,6 +621,42 @@ Module *System::ConfigReadCache(misc::IniFile *ini_file,
 				module_name.c_str(),
 				err_config_note));
 
+	// Check prefetcher
+	Prefetcher::Kind prefetcher_kind = (Prefetcher::Kind)
+			Prefetcher::KindMap.MapString(prefetcher_str);
+	if (!prefetcher_kind)
+		throw Error(misc::fmt("%s: Cache %s: %s: "
+				"Invalid prefetcher.\n%s",
+				ini_file->getPath().c_str(),
+				module_name.c_str(),
+				prefetcher_str.c_str(),
+				err_config_note));
+	if (prefetcher_degree < 1)
+		throw Error(misc::fmt("%s: cache %s: invalid value for "
+				"variable 'PrefetcherDegree'.\n%s",
+				ini_file->getPath().c_str(),
+				module_name.c_str(),
+				err_config_note));
+	if (prefetcher_distance < 1)
+		throw Error(misc::fmt("%s: cache %s: invalid value for "
+				"variable 'PrefetcherDistance'.\n%s",
+				ini_file->getPath().c_str(),
+				module_name.c_str(),
+				err_config_note));
+	if (prefetcher_table_size < 1)
+		throw Error(misc::fmt("%s: cache %s: invalid value for "
+				"variable 'PrefetcherTableSize'.\n%s",
+				ini_file->getPath().c_str(),
+				module_name.c_str(),
+				err_config_note));
+	if (prefetcher_max_in_flight < 1 ||
+			prefetcher_max_in_flight > mshr_size)
+		throw Error(misc::fmt("%s: cache %s: invalid value for "
+				"variable 'PrefetcherMaxInFlight'.\n%s",
+				ini_file->getPath().c_str(),
+				module_name.c_str(),
+				err_config_note));
+
 	// Create module
 	Module *module = addModule(module_name,
 			Module::TypeCache,
@@ -621,6 +701,14 @@ Module *System::ConfigReadCache(misc::IniFile *ini_file,
 			replacement_policy,
 			write_policy);
 
+	// Create prefetcher
+	if (prefetcher_kind != Prefetcher::KindNone)
+		module->setPrefetcher(prefetcher_kind,
+				prefetcher_degree,
+				prefetcher_distance,
+				prefetcher_table_size,
+				prefetcher_max_in_flight);
+
 	// Done
 	return module;
 }
@@ -858,6 +946,37 @@ void System::ConfigReadModuleAddressRange(misc::IniFile *ini_file,
 }
 
 
+void System::ConfigReadModuleDirectoryEncoding(misc::IniFile *ini_file,
+		Module *module,
+		const std::string &section)
+{
+	// Read variables
+	std::string encoding_str = ini_file->ReadString(section,
+			"DirectoryEncoding", "FullMap");
+	int num_pointers = ini_file->ReadInt(section, "DirectoryPointers", 4);
+
+	// Check encoding
+	Directory::Encoding encoding = (Directory::Encoding)
+			Directory::EncodingMap.MapString(encoding_str);
+	if (!encoding)
+		throw Error(misc::fmt("%s: %s: %s: invalid value for variable "
+				"'DirectoryEncoding'.\n%s",
+				ini_file->getPath().c_str(),
+				module->getName().c_str(),
+				encoding_str.c_str(),
+				err_config_note));
+	if (num_pointers < 1)
+		throw Error(misc::fmt("%s: %s: invalid value for variable "
+				"'DirectoryPointers'.\n%s",
+				ini_file->getPath().c_str(),
+				module->getName().c_str(),
+				err_config_note));
+
+	// Set encoding
+	module->setDirectoryEncoding(encoding, num_pointers);
+}
+
+
 void System::ConfigReadModules(misc::IniFile *ini_file)
 {
 	// Create modules
@@ -894,6 +1013,9 @@ void System::ConfigReadModules(misc::IniFile *ini_file)
 		// Read module address range
 		ConfigReadModuleAddressRange(ini_file, module, section);
 
+		// Read directory sharer encoding
+		ConfigReadModuleDirectoryEncoding(ini_file, module, section);
+
 		// Debug
 		debug << "\t" << module_name << '\n';
 	}
@@ -1180,7 +1302,7 @@ void System::ConfigCreateSwitches(misc::IniFile *ini_file)
 		// Calculate routes
 		net::RoutingTable *routing_table = network->getRoutingTable();
 		routing_table->Initialize();
-		routing_table->FloydWarshall();
+		routing_table->ComputeRoutes();
 
 		// Debug
 		debug << '\n';
@@ -1301,7 +1423,7 @@ void System::ConfigCalculateSubBlockSizes()
 				num_nodes);
 		Directory *directory = module->getDirectory();
 		debug << misc::fmt("\t%s - %dx%dx%d (%dx%dx%d effective) - "
-				"%d entries, %d sub-blocks\n",
+				"%d entries, %d sub-blocks, %s, %lld bytes\n",
 				module->getName().c_str(),
 				directory->getNumSets(),
 				directory->getNumWays(),
@@ -1310,7 +1432,9 @@ void System::ConfigCalculateSubBlockSizes()
 				directory->getNumWays(),
 				module->getNumHighModules(),
 				module->getDirectorySize(),
-				module->getNumSubBlocks());
+				module->getNumSubBlocks(),
+				Directory::EncodingMap[directory->getEncoding()],
+				directory->getStorageSize());
 	}
 
 	// Debug
@@ -164,7 +164,13 @@ void System::EventLoadHandler(esim::Event *event, esim::Frame *esim_frame)
 				frame);
 		if (master_frame)
 		{
-			module->incCoalescedReads();
+			if (!frame->prefetch)
+			{
+				module->incCoalescedReads();
+				if (module->getPrefetcher())
+					module->getPrefetcher()->RecordLateUse(
+							master_frame->getId());
+			}
 			module->Coalesce(master_frame, frame);
 			master_frame->queue.Wait(event_load_finish);
 			return;
@@ -210,6 +216,9 @@ void System::EventLoadHandler(esim::Event *event, esim::Frame *esim_frame)
 			debug << misc::fmt("    A-%lld wait for access A-%lld\n",
 					frame->getId(),
 					older_frame->getId());
+			if (!frame->prefetch && module->getPrefetcher())
+				module->getPrefetcher()->RecordLateUse(
+						older_frame->getId());
 			older_frame->queue.Wait(event_load_lock);
 			return;
 		}
@@ -222,6 +231,7 @@ void System::EventLoadHandler(esim::Event *event, esim::Frame *esim_frame)
 		new_frame->request_direction = Frame::RequestDirectionUpDown;
 		new_frame->blocking = true;
 		new_frame->read = true;
+		new_frame->prefetch = frame->prefetch;
 		new_frame->retry = frame->retry;
 		esim_engine->Call(event_find_and_lock,
 				new_frame,
@@ -328,6 +338,14 @@ void System::EventLoadHandler(esim::Event *event, esim::Frame *esim_frame)
 				frame->tag,
 				frame->shared ? Cache::BlockShared : Cache::BlockExclusive);
 
+		// A block brought by a prefetch is flagged until its first use
+		// by a demand access, unless a demand access already waited
+		// for the prefetch.
+		if (frame->prefetch)
+			cache->getBlock(frame->set, frame->way)->setPrefetched(
+					!module->getPrefetcher()->isUsed(
+					frame->getId()));
+
 		// Continue
 		esim_engine->Next(event_load_unlock);
 		return;
@@ -387,6 +405,10 @@ void System::EventLoadHandler(esim::Event *event, esim::Frame *esim_frame)
 		if (frame->witness)
 			(*frame->witness)++;
 
+		// Release prefetcher resources
+		if (frame->prefetch)
+			module->getPrefetcher()->FinishPrefetch(frame->getId());
+
 		// Finish access
 		module->FinishAccess(frame);
 
@@ -481,20 +503,32 @@ void System::EventStoreHandler(esim::Event *event,
 				frame->getId(),
 				module->getName().c_str());
 
-		// If there is any older access, wait for it
+		// If there is any older access, wait for it. Prefetches to
+		// other blocks are skipped, since they do not need to be
+		// ordered with respect to the store.
 		auto it = frame->accesses_iterator;
 		assert(it != module->getAccessListEnd());
-		if (it != module->getAccessListBegin())
+		unsigned block_mask = ~(module->getBlockSize() - 1);
+		while (it != module->getAccessListBegin())
 		{
 			// Get older access
 			--it;
 			Frame *older_frame = *it;
+			if (older_frame->prefetch && (older_frame->getAddress() &
+					block_mask) != (frame->getAddress() &
+					block_mask))
+				continue;
 
 			// Debug
 			debug << misc::fmt("    A-%lld wait for access A-%lld\n",
 					frame->getId(),
 					older_frame->getId());
 
+			// A store waiting for a prefetch to the same block uses it
+			if (module->getPrefetcher())
+				module->getPrefetcher()->RecordLateUse(
+						older_frame->getId());
+
 			// Enqueue
 			older_frame->queue.Wait(event_store_lock);
 			return;
@@ -771,6 +805,11 @@ void System::EventNCStoreHandler(esim::Event *event,
 					frame->getId(),
 					older_frame->getId());
 
+			// Record use of an in-flight prefetch
+			if (module->getPrefetcher())
+				module->getPrefetcher()->RecordLateUse(
+						older_frame->getId());
+
 			// Wait for it
 			older_frame->queue.Wait(event_nc_store_lock);
 			return;
@@ -1116,10 +1155,13 @@ void System::EventFindAndLockHandler(esim::Event *event,
 				frame->getId(),
 				module->getName().c_str());
 
-		// Statistics
-		module->incAccesses();
-		if (frame->retry)
-			module->incRetryAccesses();
+		// Statistics. Prefetches are not counted as accesses.
+		if (!frame->prefetch)
+		{
+			module->incAccesses();
+			if (frame->retry)
+				module->incRetryAccesses();
+		}
 
 		// Set parent frame flag expressing that port has already been 
 		// locked. This flag is checked by new writes to find out if 
@@ -1197,6 +1239,15 @@ void System::EventFindAndLockHandler(esim::Event *event,
 					directory->getEntryAccessId(frame->set,
 							frame->way));
 
+			// A demand access finding the block being brought by
+			// a prefetch uses it
+			if (frame->hit && module->getPrefetcher() &&
+					frame->request_direction ==
+					Frame::RequestDirectionUpDown)
+				module->getPrefetcher()->RecordLateUse(
+						directory->getEntryAccessId(
+						frame->set, frame->way));
+
 			// Return error code to parent frame
 			parent_frame->error = true;
 			module->UnlockPort(port, frame);
@@ -1234,6 +1285,15 @@ void System::EventFindAndLockHandler(esim::Event *event,
 					directory->getEntryAccessId(frame->set,
 							frame->way));
 
+			// A demand access finding the block being brought by
+			// a prefetch uses it
+			if (frame->hit && module->getPrefetcher() &&
+					frame->request_direction ==
+					Frame::RequestDirectionUpDown)
+				module->getPrefetcher()->RecordLateUse(
+						directory->getEntryAccessId(
+						frame->set, frame->way));
+
 			// Unlock port
 			module->UnlockPort(port, frame);
 			parent_frame->port_locked = false;
@@ -1273,7 +1333,25 @@ void System::EventFindAndLockHandler(esim::Event *event,
 		}
 
 		// Statistics
-		module->UpdateStats(frame);
+		if (!frame->prefetch)
+			module->UpdateStats(frame);
+
+		// Train the prefetcher with demand accesses coming from upper
+		// levels. A hit on a block brought by a prefetch is its first
+		// use.
+		Prefetcher *prefetcher = module->getPrefetcher();
+		if (prefetcher && !frame->prefetch &&
+				frame->request_direction ==
+				Frame::RequestDirectionUpDown)
+		{
+			bool prefetch_hit = frame->hit && cache->getBlock(
+					frame->set, frame->way)->isPrefetched();
+			if (prefetch_hit)
+				prefetcher->RecordTimelyUse(frame->getAddress());
+			prefetcher->Train(frame->getAddress(),
+					frame->hit,
+					prefetch_hit);
+		}
 
 		// Entry is locked. Record the transient tag so that a 
 		// subsequent lookup detects that the block is being brought.
@@ -3337,6 +3415,7 @@ void System::EventInvalidateHandler(esim::Event *event,
 					frame->set, frame->way, z);
 
 			// Process all the high level modules connected to it
+			int except_index = -1;
 			for (int i = 0; i < directory->getNumNodes(); i++)
 			{
 				// Skip non-sharers and 'except_module'
@@ -3346,11 +3425,19 @@ void System::EventInvalidateHandler(esim::Event *event,
 						i))
 					continue;
 
+				// Skip nodes other than high modules, such as
+				// switches or the node of this module, which an
+				// entry with overflowed sharer pointers can include
 				net::Network *high_network = module->getHighNetwork();
 				net::Node *node = high_network->getNode(i);
 				Module *sharer = (Module *) node->getUserData();
+				if (!sharer || !module->isHighModule(sharer))
+					continue;
 				if (sharer == frame->except_module)
+				{
+					except_index = i;
 					continue;
+				}
 
 				// Clear sharer and owner
 				directory->clearSharer(frame->set,
@@ -3384,6 +3471,13 @@ void System::EventInvalidateHandler(esim::Event *event,
 						new_frame,
 						event_invalidate_finish);
 			}
+
+			// All sharers but 'except_module' are now invalidated.
+			// This makes an overflowed entry exact again.
+			directory->clearAllSharersExcept(frame->set,
+					frame->way,
+					z,
+					except_index);
 		}
 
 		// Continue with 'invalidate-finish' event
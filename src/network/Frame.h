@@ -47,6 +47,39 @@ public:
 	bool automatic_receive = false;
 };
 
+
+/// Event frame for the injection of messages by one end node in a
+/// stand-alone network simulation
+class InjectionFrame : public esim::Frame
+{
+	// Index of the end node in the simulated network
+	int node_index;
+
+public:
+
+	/// Constructor
+	InjectionFrame(int node_index) : node_index(node_index)
+	{
+	}
+
+	/// Return the index of the injecting end node
+	int getNodeIndex() const { return node_index; }
+
+	/// Time of the next synthetic injection, in cycles
+	double next_time = 0.0;
+
+	/// Synthetic messages generated but not sent yet because the node
+	/// could not send them
+	long long num_queued_messages = 0;
+
+	/// Destination end node of the first queued synthetic message, or
+	/// -1 if not chosen yet
+	int destination = -1;
+
+	/// Position of the next message to send in the node's replay trace
+	unsigned replay_position = 0;
+};
+
 }
 
 #endif
@@ -20,6 +20,7 @@
 #include <algorithm>
 
 #include <lib/esim/Event.h>
+#include <lib/esim/Statistics.h>
 
 #include "Node.h"
 #include "Link.h"
@@ -55,6 +56,16 @@ Link::Link(Network *network,
 				destination_buffer_size, this);
 		addDestinationBuffer(destination_buffer);
 	}
+
+	// Interval statistics
+	std::string prefix = "net." + network->getName() + "." +
+			getName() + ".";
+	esim::StatisticsRegistry::Register(prefix + "transferred_bytes",
+			&transferred_bytes);
+	esim::StatisticsRegistry::Register(prefix + "transferred_packets",
+			&transferred_packets);
+	esim::StatisticsRegistry::Register(prefix + "busy_cycles",
+			&busy_cycles);
 }
 
 
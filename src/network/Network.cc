@@ -17,6 +17,8 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <csignal>
 #include <fstream>
@@ -119,6 +121,13 @@ void Network::ParseConfiguration(misc::IniFile *config,
 				"negative.\n%s", config->getPath().c_str(),
 				name.c_str(), System::err_config_note));
 
+	// Generated topology
+	if (config->Exists(section, "Topology"))
+	{
+		ParseConfigurationForTopology(config, section);
+		return;
+	}
+
 	// Parse the configure file for nodes
 	ParseConfigurationForNodes(config);
 
@@ -136,7 +145,7 @@ void Network::ParseConfiguration(misc::IniFile *config,
 
 	// Parse the routing elements, for manual routing.
 	if (!ParseConfigurationForRoutes(config))
-		routing_table.FloydWarshall();
+		routing_table.ComputeRoutes();
 
 	// If the network with current routing contains a cycle, warn
 	if (routing_table.hasCycle())
@@ -146,6 +155,39 @@ void Network::ParseConfiguration(misc::IniFile *config,
 }
 
 
+void Network::ParseConfigurationForTopology(misc::IniFile *config,
+		const std::string &section)
+{
+	// Nodes, links, buses, and routes cannot be given
+	for (int i = 0; i < config->getNumSections(); i++)
+	{
+		std::vector<std::string> tokens;
+		misc::StringTokenize(config->getSection(i), tokens, ".");
+		if (tokens.size() > 2 &&
+				!strcasecmp(tokens[0].c_str(), "Network") &&
+				!strcasecmp(tokens[1].c_str(), name.c_str()))
+			throw Error(misc::fmt("%s: Section '%s' not allowed in "
+					"network '%s' with a generated "
+					"topology.\n%s",
+					config->getPath().c_str(),
+					config->getSection(i).c_str(),
+					name.c_str(),
+					System::err_config_note));
+	}
+
+	// Generate nodes and links
+	topology = Topology::Create(this, config, section,
+			default_input_buffer_size,
+			default_output_buffer_size,
+			default_bandwidth);
+
+	// Routes are computed by the topology, so neither the routing table
+	// nor a cycle check is needed. Routes are deadlock-free by
+	// construction.
+	routing_table.setTopology(topology.get());
+}
+
+
 void Network::ParseConfigurationForNodes(misc::IniFile *config)
 {
 	for (int i = 0; i < config->getNumSections(); i++)
@@ -676,7 +718,6 @@ bool Network::ParseConfigurationForRoutes(misc::IniFile *ini_file)
 				}
 			}
 		}
-		routing_table.UpdateManualRoutingCost();
 	}
 	return routing;
 }
@@ -750,6 +791,25 @@ Node *Network::getNodeByUserData(void *user_data) const
 }
 
 
+long long Network::getLatencyPercentile(double fraction) const
+{
+	// Number of messages within the percentile, at least one
+	long long count = (long long) std::ceil(fraction * transfers);
+	count = std::max(count, 1LL);
+
+	// Traverse histogram
+	long long accumulated = 0;
+	for (long long latency = 0; latency < (long long)
+			latency_histogram.size(); latency++)
+	{
+		accumulated += latency_histogram[latency];
+		if (accumulated >= count)
+			return latency;
+	}
+	return 0;
+}
+
+
 void Network::DumpReport(const std::string &path)
 {
 	// Open file
@@ -908,6 +968,9 @@ Message *Network::Send(EndNode *source_node,
 	// Create message
 	Message *message = newMessage(source_node, destination_node, size);
 
+	// Record message for a later replay
+	System::TraceMessage(this, source_node, destination_node, size);
+
 	// Updating trace with new message creation
 	net::System::trace << misc::fmt("net.new_msg net=\"%s\" "
 			"name=\"M-%lld\" size=%d state=\"%s:create\"\n",
@@ -1019,7 +1082,11 @@ void Network::Receive(EndNode *node, Message *message)
 	long long cycle = System::getInstance()->getCycle();
 	transfers++;
 	accumulated_bytes += message->getSize();
-	accumulated_latency += cycle - message->getSendCycle();
+	long long latency = cycle - message->getSendCycle();
+	accumulated_latency += latency;
+	if (latency >= (long long) latency_histogram.size())
+		latency_histogram.resize(latency + 1);
+	latency_histogram[latency]++;
 
 	// Remove packets from their buffer
 	for (int i = 0; i < message->getNumPackets(); i++)
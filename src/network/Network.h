@@ -33,6 +33,7 @@
 #include "Node.h"
 #include "RoutingTable.h"
 #include "System.h"
+#include "Topology.h"
 
 namespace net
 {
@@ -72,6 +73,10 @@ class Network
 	// Routing table
 	RoutingTable routing_table;
 
+	// Generated topology, or nullptr if nodes and links are listed in the
+	// configuration file
+	std::unique_ptr<Topology> topology;
+
 	// Parse the config file to add all the nodes belongs to the network
 	void ParseConfigurationForNodes(misc::IniFile *ini_file);
 
@@ -87,6 +92,11 @@ class Network
 	// Parse the routing elements, for manual routing.
 	bool ParseConfigurationForRoutes(misc::IniFile *ini_file);
 
+	// Generate the nodes and links of the topology given in variable
+	// 'Topology' of the network section
+	void ParseConfigurationForTopology(misc::IniFile *ini_file,
+			const std::string &section);
+
 
 
 
@@ -128,6 +138,9 @@ class Network
 	// Accumulation of size of all messages in the network
 	long long accumulated_bytes = 0;
 
+	// Number of delivered messages for each latency in cycles
+	std::vector<long long> latency_histogram;
+
 
 
 
@@ -166,6 +179,10 @@ public:
 	/// Return the routing table of the network.
 	RoutingTable *getRoutingTable() { return &routing_table; }
 
+	/// Return the generated topology of the network, or `nullptr` if its
+	/// nodes and links are listed in the configuration file.
+	Topology *getTopology() const { return topology.get(); }
+
 	/// Set packet size
 	void setPacketSize(int packet_size) { this->packet_size = packet_size; }
 
@@ -342,6 +359,20 @@ public:
 	/// Return the number of end nodes
 	int getNumEndNodes() const { return num_end_nodes; }
 
+	/// Return the number of messages delivered to their destination
+	long long getNumTransfers() const { return transfers; }
+
+	/// Return the average latency of delivered messages in cycles
+	double getAverageLatency() const
+	{
+		return transfers ? (double) accumulated_latency / transfers : 0.0;
+	}
+
+	/// Return the lowest latency in cycles that is not exceeded by a
+	/// fraction \a fraction of the delivered messages, between 0 and 1.
+	/// The maximum latency is returned for a fraction of 1.
+	long long getLatencyPercentile(double fraction) const;
+
 	/// Return a node by its index.
 	Node *getNode(int index)
 	{
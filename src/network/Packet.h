@@ -46,6 +46,10 @@ class Packet
 	// Current position in the network, which buffer it is at
 	Buffer *buffer;
 
+	// Output buffer chosen by adaptive routing in the switch where the
+	// packet was last forwarded or tried to be forwarded
+	Buffer *output_buffer = nullptr;
+
 
 public:
 
@@ -73,6 +77,16 @@ public:
 	/// Get buffer
 	Buffer *getBuffer() const { return buffer; }
 
+	/// Set the output buffer chosen by adaptive routing
+	void setOutputBuffer(Buffer *output_buffer)
+	{
+		this->output_buffer = output_buffer;
+	}
+
+	/// Return the output buffer chosen by adaptive routing, which may
+	/// belong to a switch the packet already left
+	Buffer *getOutputBuffer() const { return output_buffer; }
+
 	/// Update the cycle until which the packet is in transit
 	void setBusy(long long busy) { this->busy = busy; }
 
@@ -17,16 +17,23 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
-#include <climits>
+#include <algorithm>
+#include <cstdio>
 #include <fstream>
 #include <iostream>
 #include <iomanip>
+#include <set>
+#include <unistd.h>
 
 #include <lib/cpp/Error.h>
+#include <lib/cpp/WorkerPool.h>
 
+#include "Connection.h"
+#include "Link.h"
 #include "Node.h"
 #include "Network.h"
 #include "RoutingTable.h"
+#include "Topology.h"
 
 namespace net
 {
@@ -34,6 +41,9 @@ namespace net
 class Buffer;
 class Connection;
 
+const int RoutingTable::min_parallel_dimension = 256;
+
+
 RoutingTable::RoutingTable(Network *network) :
 		network(network)
 {
@@ -42,140 +52,252 @@ RoutingTable::RoutingTable(Network *network) :
 }
 
 
-void RoutingTable::Initialize()
+void RoutingTable::InitializeHops()
 {
 	// Check if the routing table is already initialized
-	if (!entries.empty())
+	if (!hops.empty())
 		throw misc::Panic("Routing table already initialized.");
 
-	// Set dimension
+	// One hop for each output buffer and each node it reaches. The
+	// destination buffers of a link are the virtual channels of a single
+	// node.
 	dimension = network->getNumNodes();
-
-	// Initiate table with infinite costs
+	hops.resize(dimension);
+	buffer_hops.resize(dimension);
 	for (int i = 0; i < dimension; i++)
 	{
-		for (int j = 0; j < dimension; j++)
+		Node *node = network->getNode(i);
+		for (int j = 0; j < node->getNumOutputBuffers(); j++)
 		{
-			entries.emplace_back(misc::new_unique<Entry>(
-					i == j ? 0 : dimension, 
-					nullptr, nullptr));
+			Buffer *buffer = node->getOutputBuffer(j);
+			Connection *connection = buffer->getConnection();
+			int first_hop = hops[i].size();
+			buffer_hops[i].push_back(first_hop);
+			for (int k = 0; k < connection->getNumDestinationBuffers();
+					k++)
+			{
+				Node *next_node = connection->
+						getDestinationBuffer(k)->getNode();
+				bool found = next_node == node;
+				for (unsigned hop = first_hop; hop < hops[i].size()
+						&& !found; hop++)
+					found = hops[i][hop]->getNextNode() ==
+							next_node;
+				if (!found)
+					hops[i].emplace_back(misc::new_unique<Entry>(
+							next_node, buffer));
+			}
 		}
 	}
 
+	// Special entries
+	self_entry = misc::new_unique<Entry>(nullptr, nullptr);
+	missing_entry = misc::new_unique<Entry>(nullptr, nullptr);
+}
+
+
+void RoutingTable::Initialize()
+{
+	// Hops
+	InitializeHops();
+
+	// Table without routes, with the narrowest entries that can index
+	// the hops of every node
+	unsigned max_hops = 0;
+	for (auto &node_hops : hops)
+		max_hops = std::max(max_hops, (unsigned) node_hops.size());
+	if (max_hops <= INT16_MAX)
+		short_table.assign((size_t) dimension * dimension, -1);
+	else
+		long_table.assign((size_t) dimension * dimension, -1);
+
 	// Set 1-hop connections
 	for (int i = 0; i < dimension; i++)
+		for (unsigned hop = 0; hop < hops[i].size(); hop++)
+			setHop(i, hops[i][hop]->getNextNode()->getIndex(), hop);
+}
+
+
+void RoutingTable::setTopology(Topology *topology)
+{
+	// Only the hops are needed
+	this->topology = topology;
+	InitializeHops();
+}
+
+
+void RoutingTable::BreadthFirstSearch(int source)
+{
+	// Forget the 1-hop connections, which may have been overwritten by
+	// later output buffers to the same node
+	for (int i = 0; i < dimension; i++)
+		setHop(source, i, -1);
+
+	// Every node is reached through the first hop out of the source
+	// that leads to it on a shortest path. Nodes already reached have a
+	// hop in the table.
+	std::vector<int> queue;
+	queue.reserve(dimension);
+	queue.push_back(source);
+	for (unsigned index = 0; index < queue.size(); index++)
 	{
-		Node *node = network->getNode(i);
-		for (int j = 0; j < node->getNumOutputBuffers(); j++)
+		int node_index = queue[index];
+		for (unsigned hop = 0; hop < hops[node_index].size(); hop++)
 		{
-			Buffer *source_buffer = node->getOutputBuffer(j);
-			Connection* connection = source_buffer->getConnection();
-			for (int k = 0; k < 
-					connection->getNumDestinationBuffers();
-					k++)
-			{
-				Buffer *dst_buffer = connection->
-					getDestinationBuffer(k);
-				Node* dst_node = dst_buffer->getNode();
-				if (node != dst_node)
-				{
-					Entry* entry = Lookup(node, dst_node);
-					entry->cost = 1;
-					entry->setNextNode(dst_node);
-					entry->setBuffer(source_buffer);
-				}
-			}
+			int next_index = hops[node_index][hop]->getNextNode()->
+					getIndex();
+			if (next_index == source || getHop(source,
+					next_index) >= 0)
+				continue;
+			setHop(source, next_index, node_index == source ?
+					hop : getHop(source, node_index));
+			queue.push_back(next_index);
 		}
 	}
 }
 
 
-void RoutingTable::FloydWarshall()
+void RoutingTable::ComputeRoutes()
 {
-	// The entry->next_node values do not necessarily point
-	// to the immediate next hop after this.
-	for (int k = 0; k < dimension; k++)
+	// Generated topologies have no table
+	if (topology)
+		throw misc::Panic("Routing table of a generated topology");
+
+	// Routes from a previous run
+	unsigned long long hash = 0;
+	std::string cache_path;
+	if (!System::getRouteCacheDirectory().empty())
+	{
+		hash = getHash();
+		cache_path = misc::fmt("%s/m2s-routes-%016llx",
+				System::getRouteCacheDirectory().c_str(),
+				hash);
+		if (LoadCache(cache_path, hash))
+			return;
+	}
+
+	// Searches only write the table row of their source node, so they
+	// are independent of each other
+	int num_threads = std::min(System::getRouteThreads(), dimension);
+	if (num_threads > 1 && dimension >= min_parallel_dimension)
 	{
-		for (int i = 0; i < dimension; i++)
+		misc::WorkerPool worker_pool(num_threads);
+		worker_pool.Run(dimension, [this](int source)
 		{
-			for (int j = 0; j < dimension; j++)
-			{
-				Node *node_i = network->getNode(i);
-				Node *node_j = network->getNode(j);
-				Node *node_k = network->getNode(k);
-
-				Entry *entry_i_k = Lookup(node_i,node_k);
-				Entry *entry_k_j = Lookup(node_k,node_j);
-				Entry *entry_i_j = Lookup(node_i,node_j);
-
-				int temp_cost = entry_i_k->cost +
-						entry_k_j->cost;
-				if (entry_i_j->cost > temp_cost)
-				{
-					entry_i_j->cost = temp_cost;
-					entry_i_j->setNextNode(node_k);
-				}
-			}
-		}
+			BreadthFirstSearch(source);
+		});
+	}
+	else
+	{
+		for (int source = 0; source < dimension; source++)
+			BreadthFirstSearch(source);
 	}
 
-	// Calculating the output buffer for the entry.
-	Node *next_node = nullptr;
-	Entry *entry = nullptr;
-	for (int i = 0; i < dimension; i++)
+	// Save routes for the next run
+	if (!cache_path.empty())
+		SaveCache(cache_path, hash);
+}
+
+
+unsigned long long RoutingTable::getHash() const
+{
+	// FNV-1a hash of the table entry size and the next node of every hop
+	// of every node, which is all the routes depend on
+	unsigned long long hash = 14695981039346656037ULL;
+	auto add = [&hash](long long value)
 	{
-		for (int j = 0; j < dimension; j++)
+		for (int i = 0; i < 8; i++)
 		{
+			hash ^= (value >> (i * 8)) & 0xff;
+			hash *= 1099511628211ULL;
+		}
+	};
+	add(dimension);
+	add(long_table.empty() ? sizeof(std::int16_t) : sizeof(std::int32_t));
+	for (auto &node_hops : hops)
+	{
+		add(node_hops.size());
+		for (auto &hop : node_hops)
+			add(hop->getNextNode()->getIndex());
+	}
+	return hash;
+}
 
-			Node *node_i = network->getNode(i);
-			Node *node_j = network->getNode(j);
 
-			auto entry_i_j = Lookup(node_i, node_j);
-			next_node = entry_i_j->getNextNode();
+bool RoutingTable::LoadCache(const std::string &path, unsigned long long hash)
+{
+	// Open file
+	std::ifstream f(path, std::ios::binary);
+	if (!f)
+		return false;
+
+	// Header
+	char magic[8];
+	unsigned long long file_hash;
+	int file_dimension;
+	f.read(magic, sizeof magic);
+	f.read((char *) &file_hash, sizeof file_hash);
+	f.read((char *) &file_dimension, sizeof file_dimension);
+	if (!f || std::string(magic, sizeof magic) != "M2SROUTE" ||
+			file_hash != hash || file_dimension != dimension)
+		return false;
+
+	// Table, which must end the file
+	if (long_table.empty())
+		f.read((char *) short_table.data(), short_table.size() *
+				sizeof(std::int16_t));
+	else
+		f.read((char *) long_table.data(), long_table.size() *
+				sizeof(std::int32_t));
+	if (!f || f.peek() != EOF)
+		return false;
+
+	// Debug
+	System::debug << misc::fmt("Network %s: routes loaded from %s\n",
+			network->getName().c_str(), path.c_str());
+	return true;
+}
 
-			if (!next_node)
-			{
-				entry_i_j->setBuffer(nullptr);
-				continue;
-			}
 
-			// Follow the buffers path
-			for (;;)
-			{
-				entry = Lookup(node_i, next_node);
-				if (entry->cost <= 1)
-					break;
-				next_node = entry->getNextNode();
-			}
+void RoutingTable::SaveCache(const std::string &path,
+		unsigned long long hash) const
+{
+	// Write into a temporary file first, so that concurrent runs never
+	// read a partial table
+	std::string temp_path = misc::fmt("%s.%d", path.c_str(), getpid());
+	std::ofstream f(temp_path, std::ios::binary);
+	f.write("M2SROUTE", 8);
+	f.write((const char *) &hash, sizeof hash);
+	f.write((const char *) &dimension, sizeof dimension);
+	if (long_table.empty())
+		f.write((const char *) short_table.data(), short_table.size() *
+				sizeof(std::int16_t));
+	else
+		f.write((const char *) long_table.data(), long_table.size() *
+				sizeof(std::int32_t));
+	f.close();
+	if (!f || rename(temp_path.c_str(), path.c_str()))
+	{
+		remove(temp_path.c_str());
+		misc::Warning("%s: Cannot write routing table cache",
+				path.c_str());
+	}
+}
 
-			// Get the output buffer based on the next node
-			for (int k = 0; k < node_i->getNumOutputBuffers(); k++)
-			{
-				Buffer *buffer = node_i->getOutputBuffer(k);
-				bool found = false;
-				Connection *connection = buffer->getConnection();
-				for (int m = 0; m < connection->
-						getNumDestinationBuffers(); 
-						m++)
-				{
-					Buffer *destination_buffer = 
-						connection->
-						getDestinationBuffer(m);
-					Node *receive_node = 
-							destination_buffer->
-							getNode();
-					if (next_node != receive_node)
-						continue;
-					entry_i_j->setNextNode(receive_node);
-					entry_i_j->setBuffer(buffer);
-					found = true;
-					break;
-				}
-				if (found)
-					break;
-			}
-		}
+
+int RoutingTable::getCost(Node *source, Node *destination) const
+{
+	// Follow the route, which may be incomplete or contain a loop with
+	// manual routing
+	int cost = 0;
+	for (Node *node = source; node != destination; cost++)
+	{
+		Entry *entry = Lookup(node, destination);
+		if (!entry->getBuffer() || cost == dimension)
+			return dimension;
+		node = entry->getNextNode();
 	}
+	return cost;
 }
 
 
@@ -184,157 +306,68 @@ bool RoutingTable::hasCycle()
 	// First create an empty graph
 	std::unique_ptr<misc::Graph> graph = misc::new_unique<misc::Graph>();
 
-	// Create an unordered_map for mapping each buffer to vertices of
-	// the graph
+	// Create an unordered_map for mapping each buffer involved in a
+	// route to vertices of the graph
 	std::unordered_map<Buffer *, misc::Vertex *> buffer_to_vertex;
-
-	// For every output buffer that plays a role in routing table
-	for (int node_id = 0; node_id < dimension; node_id++)
+	auto getVertex = [&](Buffer *buffer)
 	{
-		// Get the node
-		Node *node = network->getNode(node_id);
-
-		// For each output buffer from the output buffer list,
-		// figure out if the output buffer is in the routing table
-		for (int buffer_id = 0; buffer_id < node->getNumOutputBuffers();
-				buffer_id++)
-		{
-			// Get the output buffer from the list in the node 
-			Buffer *output_buffer = node->getOutputBuffer(
-					buffer_id);
-
-			// Find the buffer in the routing table
-			for (int destination_node_id = 0; 
-					destination_node_id < dimension;
-					destination_node_id++)
-			{
-				// Get the destination node
-				Node *destination_node = network->getNode(
-					destination_node_id);
-
-				// Look up the routing table
-				Entry *entry = Lookup(node, destination_node);
-
-				// Check if the current output buffer is the 
-				// path between the two nodes
-				if (output_buffer == entry->getBuffer())
-				{
-					// This means the buffer is involved 
-					// in the graph and might be part of 
-					// a deadlock scenario. So we create
-					// a vertex for it
-					graph->addVertex(misc::new_unique<
-							misc::Vertex>
-							(output_buffer->getName().
-							c_str()));
-
-					// Get the vertex which is the last
-					// vertex in the vertices list
-					misc::Vertex *vertex = graph->getVertex(
-							graph->getNumVertices() - 1);
-
-					// Map the vertex with the buffer for
-					// future easy reference
-					buffer_to_vertex.insert(std::make_pair(
-							output_buffer,
-							vertex));
-					
-					// We break from the for look and move
-					// on to the next buffer since we
-					// already find the buffer in the table
-					break;
-				}
-			}
-		} 
-	}
+		auto it = buffer_to_vertex.find(buffer);
+		if (it != buffer_to_vertex.end())
+			return it->second;
+		graph->addVertex(misc::new_unique<misc::Vertex>(
+				buffer->getName().c_str()));
+		misc::Vertex *vertex = graph->getVertex(
+				graph->getNumVertices() - 1);
+		buffer_to_vertex.emplace(buffer, vertex);
+		return vertex;
+	};
 
 	// For every source node
 	for (int source_id = 0; source_id < dimension; source_id++)
 	{
-		// Get the source node
+		// Pairs of output buffers used in sequence by the routes
+		// leaving the source node. There are few of them, so they
+		// are collected first instead of searching the edges of the
+		// graph for each destination.
 		Node *source_node = network->getNode(source_id);
-
-		//For every destination node
-		for (int destination_id = 0; destination_id< dimension; 
+		std::set<std::pair<Buffer *, Buffer *>> dependencies;
+		for (int destination_id = 0; destination_id < dimension;
 				destination_id++)
 		{
-			// Get the destination node
+			// Output buffer towards the destination
 			Node *destination_node = network->getNode(
 					destination_id);
-
-			// If the source and destination are the same, continue
-			if (source_node == destination_node)
+			Entry *entry = Lookup(source_node, destination_node);
+			Buffer *source_vertex_buffer = entry->getBuffer();
+			if (!source_vertex_buffer)
 				continue;
 
-			// Find the entry in the routing table
-			Entry *entry = Lookup(source_node, destination_node);
+			// Output buffer taken next, if any
+			Entry *next_entry = Lookup(entry->getNextNode(),
+					destination_node);
+			Buffer *destination_vertex_buffer = next_entry->
+					getBuffer();
+			getVertex(source_vertex_buffer);
+			if (destination_vertex_buffer)
+				dependencies.emplace(source_vertex_buffer,
+						destination_vertex_buffer);
+		}
 
-			// Get the associated output buffer for the entry
-			Buffer *source_vertex_buffer = entry->getBuffer();
-			if (source_vertex_buffer)
-			{
-				// Get the next node of the entry
-				Node *next_node = entry->getNextNode();
-
-				// Based on the next node perform another 
-				// lookup in the routing table to retrieve the 
-				// next output buffer (next_node, destination)
-				Entry *next_entry = Lookup(next_node, 
-						destination_node);
-
-				// Get the associated output buffer for the
-				// next entry if any
-				Buffer *destination_vertex_buffer = next_entry->
-						getBuffer();
-				if (destination_vertex_buffer)
-				{
-
-					// Find the source vertex based on the 
-					// source output buffer in the unordered 
-					// map
-					auto source_vertex_it = 
-							buffer_to_vertex.find(
-							source_vertex_buffer);
-					assert(source_vertex_it != 
-							buffer_to_vertex.end());
-
-					// Find the destination vertex based on 
-					// the destination output buffer
-					auto destination_vertex_it = 
-							buffer_to_vertex.find(
-							destination_vertex_buffer);
-					assert(destination_vertex_it != 
-							buffer_to_vertex.end());
-
-					// First see if the edge exists
-					if (!graph->findEdge(source_vertex_it->second,
-						destination_vertex_it->second))
-					{
-						// Add an edge to the graph based 
-						// on the source and the destination 
-						//vertex
-						graph->addEdge(misc::new_unique<
-								misc::Edge>
-								(source_vertex_it->
-								second,
-								destination_vertex_it->
-								second),
-								source_vertex_it->
-								second,
-								destination_vertex_it->
-								second);
-					}
-				}
-			}
+		// Add one edge for each dependency
+		for (auto &dependency : dependencies)
+		{
+			misc::Vertex *source_vertex = getVertex(
+					dependency.first);
+			misc::Vertex *destination_vertex = getVertex(
+					dependency.second);
+			graph->addEdge(misc::new_unique<misc::Edge>(
+					source_vertex, destination_vertex),
+					source_vertex, destination_vertex);
 		}
 	}
 
 	// Run the cycle-detection algorithm on the graph to find cycle
-	if (graph->hasCycle())
-		return true;
-
-	// No cycle was detected
-	return false;	
+	return graph->hasCycle();
 }
 
 
@@ -345,8 +378,21 @@ RoutingTable::Entry *RoutingTable::Lookup(Node *source,
 	int j = destination->getIndex();
 	assert((dimension > 0) && (i < dimension) && (j < dimension));
 
-	int location = i * dimension + j;
-	return entries.at(location).get();
+	// Algorithmic routing
+	if (topology)
+	{
+		if (i == j)
+			return self_entry.get();
+		Buffer *buffer = topology->Route(source, destination);
+		return buffer ? hops[i][buffer_hops[i][buffer->getIndex()]].
+				get() : missing_entry.get();
+	}
+
+	// Table
+	int hop = getHop(i, j);
+	if (hop >= 0)
+		return hops[i][hop].get();
+	return i == j ? self_entry.get() : missing_entry.get();
 }
 
 
@@ -375,7 +421,8 @@ void RoutingTable::Dump(std::ostream &os) const
 			// Get the string size of the members that
 			// will be printed, and add them up
 			// Starting with the cost
-			entry_text_size += std::to_string(entry->cost).length();
+			entry_text_size += std::to_string(getCost(node_i,
+					network->getNode(j))).length();
 
 			// Then add 2 for the separator, followed by the
 			// name of the next_node
@@ -474,7 +521,7 @@ void RoutingTable::Dump(std::ostream &os) const
 				if (entry->getBuffer())
 					element = element + entry->getBuffer()->
 							getName();
-				element = element + ' ' + '(' + std::to_string(entry->cost)
+				element = element + ' ' + '(' + std::to_string(getCost(node_i, node_j))
 							+ ')';
 
 				// Printing the entry out
@@ -512,56 +559,35 @@ void RoutingTable::UpdateRoute(Node *source, Node *destination,
 				source->getName().c_str(),
 				destination->getName().c_str()));
 
-	// Getting the routing table entry
-	Entry *entry = Lookup(source, destination);
-
-	// Setting the next node
-	entry->setNextNode(next);
-
-	// Exit strategy from the nested loop
-	bool route_updated = false;
-
-	// Setting the next buffer
-	Buffer *buffer = nullptr;
-	for (int i = 0; i < source->getNumOutputBuffers(); i++)
+	// Find the hop to the next node
+	int i = source->getIndex();
+	int route_hop = -1;
+	for (unsigned hop = 0; hop < hops[i].size() && route_hop < 0; hop++)
 	{
-		// Exit the loop if route has already been updated
-		if (route_updated == true)
-			break;
-
-		// Find a buffer that is connected to next node through a 
-		// connection
-		buffer = source->getOutputBuffer(i);
-		Connection *connection = buffer->getConnection();
-
-		// If the connection is a link, all its destination
-		// buffers are connected to the same node.
-		if (dynamic_cast<Link *>(connection))
+		// Skip hops to other nodes
+		Entry *entry = hops[i][hop].get();
+		if (entry->getNextNode() != next)
+			continue;
+
+		// If the connection is a link, each of its source buffers
+		// is the hop through one virtual channel
+		Buffer *buffer = entry->getBuffer();
+		Link *link = dynamic_cast<Link *>(buffer->getConnection());
+		if (link)
 		{
-			// Compare link's destination to next node of the route
-			Link *link = misc::cast<Link *>(connection);
-			if (link->getDestinationNode() == next)
-			{
-				// Check the value of the virtual channel
-				if (virtual_channel > link->getNumVirtualChannels() - 1)
-					throw Error(misc::fmt("Network %s: route "
-							"%s.to.%s: wrong virtual "
-							"channel\n",
-							network->getName().c_str(),
-							source->getName().c_str(),
-							destination->getName().c_str()));
-
-				// The virtual channel acts as an offset in 
-				// link's source list
-				Buffer *entry_buffer = link->getSourceBuffer(
-						virtual_channel);
-				assert(entry_buffer->getNode() == source);
-
-				// Update the entry with calculated buffer
-				entry->setBuffer(entry_buffer);
-				route_updated = true;
-				break;
-			}
+			// Check the value of the virtual channel
+			if (virtual_channel > link->getNumVirtualChannels() - 1)
+				throw Error(misc::fmt("Network %s: route "
+						"%s.to.%s: wrong virtual "
+						"channel\n",
+						network->getName().c_str(),
+						source->getName().c_str(),
+						destination->getName().c_str()));
+
+			// The virtual channel acts as an offset in link's
+			// source list
+			if (link->getSourceBuffer(virtual_channel) == buffer)
+				route_hop = hop;
 		}
 		else
 		{
@@ -573,32 +599,20 @@ void RoutingTable::UpdateRoute(Node *source, Node *destination,
 						network->getName().c_str(),
 						source->getName().c_str(),
 						destination->getName().c_str()));
-
-			// Find the buffer connected to next node
-			for (int j = 0; j < connection->getNumDestinationBuffers(); j++)
-			{
-				Buffer *destination_buffer = connection->
-						getDestinationBuffer(j);
-				if (destination_buffer->getNode() == next)
-				{
-					// Update the entry
-					entry->setBuffer(destination_buffer);
-
-					// Exit the nested loop
-					route_updated = true;
-					break;
-				}
-			}
+			route_hop = hop;
 		}
 	}
 
 	// If the route was not found, the route-step is wrongly provided.
-	if (!route_updated)
+	if (route_hop < 0)
 		throw Error(misc::fmt("Network %s: route %s.to.%s: "
 				"missing connection\n",
 				network->getName().c_str(),
 				source->getName().c_str(),
 				destination->getName().c_str()));
+
+	// Update the route
+	setHop(i, destination->getIndex(), route_hop);
 }
 
 
@@ -614,59 +628,4 @@ void RoutingTable::DumpRoutes(const std::string &path)
 	Dump(f);
 }
 
-void RoutingTable::UpdateManualRoutingCost()
-{
-	// For every entry in the 2D routing table
-	for (int i = 0; i < dimension; i++)
-	{
-		for(int j = 0; j < dimension; j++)
-		{
-			// Get the dimensions of the entry
-			Node *source = network->getNode(i);
-			Node *destination = network->getNode(j);
-
-			// Lookup the entry
-			Entry *entry = Lookup(source, destination);
-
-			// Get the next node
-			Node *next = entry->getNextNode();
-
-			// If the entry has a next node we have to update
-			// the cost
-			if (next)
-			{
-				// The cost of the first step in the route
-				entry->cost = Lookup(source, next)->cost;
-
-				// Traverse through the path
-				for(;;)
-				{
-					// We reached end of the path
-					if (next == destination)
-						break;
-
-					// Get the next element in the path
-					Node *path_entry = Lookup(next, 
-							destination)->getNextNode();
-
-					// If there is a missing link just break
-					// No error is reported since the
-					// route steps can overlap
-					if (!path_entry)
-						break;
-
-					// Update the cost one step at a time
-					// The entry cost here should already
-					// been 1.
-					entry->cost += Lookup(next, path_entry)->cost;
-
-					// We set the update the next, to 
-					// become next in path
-					next = path_entry;
-				}
-			}
-		}
-	}
-}
-
 }
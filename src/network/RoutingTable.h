@@ -20,8 +20,10 @@
 #ifndef NETWORK_ROUTINGTABLE_H
 #define NETWORK_ROUTINGTABLE_H
 
-#include <vector>
+#include <cstdint>
+#include <iostream>
 #include <memory>
+#include <vector>
 
 namespace net
 {
@@ -29,6 +31,7 @@ namespace net
 class Network;
 class Node;
 class Buffer;
+class Topology;
   
 class RoutingTable
 {
@@ -36,13 +39,6 @@ public:
 
 	class Entry
 	{
-	public:
-
-		// Cost in hops
-		int cost;
-
-	private:
-
 		// Next node to destination
 		Node *next_node = nullptr;
 
@@ -52,8 +48,7 @@ public:
 	public:
 
 		/// Constructor.
-		Entry(int cost, Node *next_node, Buffer *buffer) :
-			cost(cost),
+		Entry(Node *next_node, Buffer *buffer) :
 			next_node(next_node),
 			buffer(buffer)
 		{};
@@ -61,29 +56,83 @@ public:
 		/// Get entry's next node.
 		Node *getNextNode() const { return next_node; }
 
-		/// Set next node
-		void setNextNode(Node *next_node) 
-		{ 
-			this->next_node = next_node; 
-		}
-
 		/// Get entry's next buffer.
 		Buffer *getBuffer() const { return buffer; }
-
-		/// Set the buffer to next node
-		void setBuffer(Buffer *buffer) { this->buffer = buffer; }
 	};
 
 private:
 
+	// Number of nodes below which routes are computed by the calling
+	// thread alone
+	static const int min_parallel_dimension;
+
 	// Associated network
 	Network *network;
 
 	// Dimension
 	int dimension = 0;
 
-	// Entries
-	std::vector<std::unique_ptr<Entry>> entries;
+	// Entry for each hop out of each node, indexed by node index and hop
+	// index. A hop is a pair of an output buffer and a node reached
+	// through it, so there is one hop per output buffer for links, and
+	// one hop per node on the bus for buses. Entries are shared by all
+	// routes through the hop, so the cost of a route is given by
+	// getCost().
+	std::vector<std::vector<std::unique_ptr<Entry>>> hops;
+
+	// Index of the first hop through each output buffer, indexed by node
+	// index and buffer index
+	std::vector<std::vector<int>> buffer_hops;
+
+	// Hop taken from each source node towards each destination node,
+	// indexed by source index * dimension + destination index, or -1 if
+	// there is no route. Only one of the tables is allocated: the 16-bit
+	// one unless some node has more hops than it can index.
+	std::vector<std::int16_t> short_table;
+	std::vector<std::int32_t> long_table;
+
+	// Generated topology routing packets algorithmically, or nullptr if
+	// routes are given by the table
+	Topology *topology = nullptr;
+
+	// Entries for routes from a node to itself, and for missing routes
+	std::unique_ptr<Entry> self_entry;
+	std::unique_ptr<Entry> missing_entry;
+
+	// Create the hops of all nodes
+	void InitializeHops();
+
+	// Return the hop taken from node index i towards node index j
+	int getHop(int i, int j) const
+	{
+		int location = i * dimension + j;
+		return long_table.empty() ? short_table[location] :
+				long_table[location];
+	}
+
+	// Set the hop taken from node index i towards node index j
+	void setHop(int i, int j, int hop)
+	{
+		int location = i * dimension + j;
+		if (long_table.empty())
+			short_table[location] = hop;
+		else
+			long_table[location] = hop;
+	}
+
+	// Fill the routes from node index source with a breadth-first search
+	void BreadthFirstSearch(int source);
+
+	// Return a hash of the nodes and the hops between them, which
+	// identifies the routes computed for them
+	unsigned long long getHash() const;
+
+	// Load the routes from a cache file created for the same hash.
+	// Return false if the file does not exist or does not match.
+	bool LoadCache(const std::string &path, unsigned long long hash);
+
+	// Save the routes into a cache file
+	void SaveCache(const std::string &path, unsigned long long hash) const;
 
 public:
 
@@ -94,16 +143,31 @@ public:
 	int getDimension() const { return dimension; }
 
 	/// Initialize the routing table based on the nodes and links present
-	/// in the network. This does not set up the routes, it just initializes
-	/// the table structures.
+	/// in the network. Only the routes to adjacent nodes are set up.
 	void Initialize();
 
-	/// Perform a Floyd-Warshall to find the best routes
-	void FloydWarshall();
-
-	/// Look up the entry from a certain node to a certain node
+	/// Compute the shortest routes between all nodes, with one
+	/// breadth-first search per source node. Searches run in parallel
+	/// on the number of host threads given with option
+	/// '--net-route-threads'. If a cache directory was given with option
+	/// '--net-route-cache', the routes are loaded from a previous run on
+	/// the same network when possible, and saved otherwise.
+	void ComputeRoutes();
+
+	/// Route packets with the algorithm of a generated topology instead of
+	/// a table, so the table takes no space and no time to compute.
+	void setTopology(Topology *topology);
+
+	/// Look up the entry from a certain node to a certain node. The
+	/// entry is shared by all routes leaving the source node through
+	/// the same output buffer towards the same next node.
 	Entry *Lookup(Node *source, Node *destination) const;
 
+	/// Return the number of hops from \a source to \a destination,
+	/// following the routes, or the dimension of the table if there is
+	/// no complete route.
+	int getCost(Node *source, Node *destination) const;
+
 	/// Generating the route file
 	void DumpRoutes(const std::string &path);
 
@@ -136,11 +200,6 @@ public:
 			Node *destination,
 			Node *next,
 			int virtual_channel);
-
-	/// Update the cost of the paths in the routing table based on 
-	/// all the routes that are created
-	void UpdateManualRoutingCost();
-
 };
 
 }
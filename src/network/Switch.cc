@@ -17,8 +17,10 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include "Link.h"
 #include "Packet.h"
 #include "Switch.h"
+#include "Topology.h"
 
 namespace net
 {
@@ -108,6 +110,14 @@ void Switch::Forward(Packet *packet)
 				destination_node->getName().c_str()));
 	Buffer *output_buffer = entry->getBuffer();
 
+	// Adaptive routing
+	Topology *topology = network->getTopology();
+	if (topology && topology->isAdaptive())
+	{
+		output_buffer = SelectOutputBuffer(packet, output_buffer);
+		packet->setOutputBuffer(output_buffer);
+	}
+
 	// Check if the output buffer is busy
 	if (output_buffer->write_busy >= cycle)
 	{
@@ -227,6 +237,40 @@ void Switch::Forward(Packet *packet)
 }
 
 
+Buffer *Switch::SelectOutputBuffer(Packet *packet, Buffer *escape_buffer)
+{
+	// Minimal routes
+	Network *network = packet->getMessage()->getNetwork();
+	adaptive_buffers.clear();
+	network->getTopology()->getAdaptiveRoutes(this,
+			packet->getMessage()->getDestinationNode(),
+			adaptive_buffers);
+
+	// Least occupied buffer that can take the packet now
+	long long cycle = System::getInstance()->getCycle();
+	Buffer *best_buffer = nullptr;
+	int best_occupancy = 0;
+	for (Buffer *buffer : adaptive_buffers)
+	{
+		if (buffer->write_busy >= cycle || buffer->getCount() +
+				packet->getSize() > buffer->getSize())
+			continue;
+		Link *link = misc::cast<Link *>(buffer->getConnection());
+		int occupancy = buffer->getCount() + link->
+				getDestinationBufferfromSource(buffer)->
+				getCount();
+		if (!best_buffer || occupancy < best_occupancy)
+		{
+			best_buffer = buffer;
+			best_occupancy = occupancy;
+		}
+	}
+
+	// Escape route if no adaptive route is available
+	return best_buffer ? best_buffer : escape_buffer;
+}
+
+
 Buffer *Switch::Schedule(Buffer *output_buffer) 
 {
 	// Checks if the scheduler is an output buffer
@@ -301,6 +345,9 @@ Buffer *Switch::Schedule(Buffer *output_buffer)
 					this->getName().c_str(),
 					destination_node->getName().c_str()));
 		Buffer *next_buffer = entry->getBuffer();
+		Topology *topology = network->getTopology();
+		if (topology && topology->isAdaptive())
+			next_buffer = packet->getOutputBuffer();
 		if (next_buffer != output_buffer)
 			continue;
 	
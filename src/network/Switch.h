@@ -20,6 +20,8 @@
 #ifndef NETWORK_SWITCH_H
 #define NETWORK_SWITCH_H
 
+#include <vector>
+
 #include "Node.h"
 
 namespace net
@@ -31,6 +33,17 @@ class Switch : public Node
 	// Bandwidth of the switch
 	int bandwidth;
 
+	// Candidate output buffers of adaptive routing, kept to avoid
+	// allocating them for every packet
+	std::vector<Buffer *> adaptive_buffers;
+
+	// Return the output buffer for a packet with adaptive routing: the
+	// least occupied adaptive output buffer of a minimal route that can
+	// take the packet in this cycle, counting the occupancy of the input
+	// buffer at the other end of the link, or the escape output buffer
+	// of the deterministic route otherwise.
+	Buffer *SelectOutputBuffer(Packet *packet, Buffer *escape_buffer);
+
 public:
 
 	/// Constructor
@@ -67,6 +80,11 @@ public:
 	/// output_buffer event will be scheduled after a certain amount of 
 	/// latency, which is specified in the node class.
 	///
+	/// In a generated topology with adaptive routing, the output buffer
+	/// is chosen among the minimal routes every time the packet tries to
+	/// leave the switch, and the deterministic route is taken when none
+	/// of them can accept the packet.
+	///
 	/// This function is designed to be called from the input buffer
 	/// event handler and the input buffer event handler has to check 
 	/// if the packets has arrived its destination node before calling
@@ -17,6 +17,10 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <algorithm>
+#include <sstream>
+#include <unistd.h>
+
 #include <lib/cpp/CommandLine.h>
 #include <lib/esim/Engine.h>
 #include <lib/cpp/Misc.h>
@@ -24,6 +28,8 @@
 #include "Network.h"
 #include "Node.h"
 #include "EndNode.h"
+#include "Frame.h"
+#include "RoutingTable.h"
 #include "System.h"
 
 namespace net
@@ -51,8 +57,32 @@ int System::message_size = 1;
 
 double System::injection_rate = 0.001;
 
+int System::source_queue_size = -1;
+
 bool System::stand_alone = false;
 
+TrafficPattern::Kind System::traffic_kind = TrafficPattern::KindUniform;
+
+int System::hotspot_node = 0;
+
+double System::hotspot_fraction = 0.2;
+
+std::string System::replay_file;
+
+std::string System::message_trace_file;
+
+std::ofstream System::message_trace;
+
+std::string System::sweep_file;
+
+int System::sweep_jobs = 0;
+
+int System::sweep_rounds = 4;
+
+int System::route_threads = 0;
+
+std::string System::route_cache_directory;
+
 bool System::help = false;
 
 int System::frequency = 1000;
@@ -100,7 +130,8 @@ System::System()
 			frequency_domain);
 	event_receive = esim_engine->RegisterEvent("receive", 
 			EventTypeReceiveHandler, frequency_domain);
-
+	event_inject = esim_engine->RegisterEvent("inject",
+			EventTypeInjectHandler, frequency_domain);
 
 }
 
@@ -147,8 +178,116 @@ void System::RegisterOptions()
 			" (e.g. 0.001 means one packet every 1000 cycles on "
 			"average. Nodes will inject packets into the network "
 			"using random delays with exponential distribution with "
-			"lambda = <rate>. This option must be used together "
-			"with '--net-sim'.");
+			"lambda = <rate>. Messages that a node cannot send "
+			"right away are dropped, unless option "
+			"'--net-source-queue' is given. This option must be "
+			"used together with '--net-sim'.");
+
+	// Source queue for stand-alone simulator
+	command_line->RegisterInt32("--net-source-queue <size> "
+			"(default = 0, or 64 with '--net-sweep')",
+			source_queue_size,
+			"For network simulation with synthetic traffic, number "
+			"of messages that each end node keeps waiting while it "
+			"cannot send them. Messages generated while the queue "
+			"is full are dropped. Waiting nodes retry when their "
+			"output buffer has room again. The saturation sweep "
+			"uses a queue by default, so that collisions at the "
+			"injection port do not count as network saturation.");
+
+	// Traffic pattern for stand-alone simulator
+	command_line->RegisterEnum("--net-traffic {uniform|transpose|"
+			"bit-complement|hotspot|tornado|neighbor} "
+			"(default = uniform)",
+			(int &) traffic_kind, TrafficPattern::KindMap,
+			"For network simulation, destination of the messages "
+			"injected by each end node, where end nodes are "
+			"numbered in the order they appear in the network "
+			"configuration file. Patterns 'transpose', 'tornado', "
+			"and 'neighbor' place end nodes on a square grid in "
+			"row-major order, and 'tornado' and 'neighbor' use a "
+			"ring if their number is not a perfect square. This "
+			"option must be used together with '--net-sim'.");
+
+	// Hotspot node
+	command_line->RegisterInt32("--net-hotspot <node> (default = 0)",
+			hotspot_node,
+			"For network simulation with '--net-traffic hotspot', "
+			"index of the end node receiving the additional "
+			"traffic.");
+
+	// Hotspot fraction
+	command_line->RegisterDouble("--net-hotspot-fraction <fraction> "
+			"(default = 0.2)",
+			hotspot_fraction,
+			"For network simulation with '--net-traffic hotspot', "
+			"fraction of the messages sent to the hotspot node. "
+			"The rest are sent to uniformly random destinations.");
+
+	// Trace replay
+	command_line->RegisterString("--net-replay <file>", replay_file,
+			"For network simulation, inject the messages recorded "
+			"in <file> with option '--net-msg-trace' instead of "
+			"synthetic traffic. Only messages of the network given "
+			"in '--net-sim' are injected, at their original cycle, "
+			"or as soon as the source end node can send them after "
+			"that. Options '--net-traffic' and "
+			"'--net-injection-rate' are ignored.");
+
+	// Message trace
+	command_line->RegisterString("--net-msg-trace <file>",
+			message_trace_file,
+			"Record every message sent in any network into <file>, "
+			"one per line, with the cycle, network name, source "
+			"and destination end node names, and size in bytes. "
+			"The file can be replayed in a network simulation with "
+			"option '--net-replay'.");
+
+	// Saturation sweep
+	command_line->RegisterString("--net-sweep <file>", sweep_file,
+			"For network simulation, search for the saturation "
+			"throughput of the network instead of running a single "
+			"injection rate. Injection rates are simulated in "
+			"parallel worker processes for '--net-max-cycles' "
+			"cycles each, and the interval containing the "
+			"saturation point is refined with a parallel binary "
+			"search. The network is considered saturated when its "
+			"average latency exceeds 3 times the zero-load latency, "
+			"or when it accepts less than 90% of the offered load. "
+			"The latency-versus-offered-load curve is written into "
+			"<file> in INI format.");
+
+	// Sweep workers
+	command_line->RegisterInt32("--net-sweep-jobs <num> (default = "
+			"number of CPUs)",
+			sweep_jobs,
+			"Maximum number of worker processes simulating injection "
+			"rates in parallel with option '--net-sweep'.");
+
+	// Sweep rounds
+	command_line->RegisterInt32("--net-sweep-rounds <num> (default = 4)",
+			sweep_rounds,
+			"Number of binary search rounds refining the saturation "
+			"point with option '--net-sweep', after the initial "
+			"round covering injection rates up to 1.");
+
+	// Route computation threads
+	command_line->RegisterInt32("--net-route-threads <num> (default = "
+			"number of CPUs)",
+			route_threads,
+			"Number of host threads computing the shortest routes "
+			"of networks with more than a few hundred nodes. Routes "
+			"do not depend on the number of threads.");
+
+	// Routing table cache
+	command_line->RegisterString("--net-route-cache <dir>",
+			route_cache_directory,
+			"Directory where the routing table of each network is "
+			"saved after it is computed. Later runs on a network "
+			"with the same nodes and connections load the routing "
+			"table from this directory instead of computing it. "
+			"Manual routes given in the network configuration file "
+			"are not cached.");
 
 	// Stand-alone simulator
 	command_line->RegisterString("--net-sim <network name>",
@@ -208,6 +347,63 @@ void System::ProcessOptions()
 	if (stand_alone && config_file.empty())
 		throw Error(misc::fmt("Option --net-sim requires "
 				" --net-config option "));
+
+	// Trace replay requires stand-alone simulation
+	if (!replay_file.empty() && !stand_alone)
+		throw Error("Option --net-replay requires option --net-sim");
+
+	// Saturation sweep
+	if (!sweep_file.empty())
+	{
+		if (!stand_alone)
+			throw Error("Option --net-sweep requires option "
+					"--net-sim");
+		if (!replay_file.empty() || !message_trace_file.empty())
+			throw Error("Option --net-sweep cannot be combined "
+					"with options --net-replay and "
+					"--net-msg-trace");
+		if (sweep_jobs < 0 || sweep_rounds < 0)
+			throw Error("Invalid value for options "
+					"--net-sweep-jobs and --net-sweep-rounds");
+		if (!sweep_jobs)
+			sweep_jobs = sysconf(_SC_NPROCESSORS_ONLN);
+	}
+
+	// Source queue
+	if (source_queue_size < 0)
+		source_queue_size = sweep_file.empty() ? 0 : 64;
+
+	// Route computation threads
+	if (route_threads < 0)
+		throw Error("Invalid value for option --net-route-threads");
+	if (!route_threads)
+		route_threads = sysconf(_SC_NPROCESSORS_ONLN);
+
+	// Message trace
+	if (!message_trace_file.empty())
+	{
+		message_trace.open(message_trace_file);
+		if (!message_trace)
+			throw Error(misc::fmt("%s: Cannot open message trace",
+					message_trace_file.c_str()));
+		message_trace << "# cycle network source destination size\n";
+	}
+}
+
+
+void System::TraceMessage(Network *network, EndNode *source_node,
+		EndNode *destination_node, int size)
+{
+	// Nothing if not recording
+	if (!message_trace.is_open())
+		return;
+
+	// Record message
+	message_trace << getInstance()->getCycle() << ' '
+			<< network->getName() << ' '
+			<< source_node->getName() << ' '
+			<< destination_node->getName() << ' '
+			<< size << '\n';
 }
 
 
@@ -243,79 +439,233 @@ void System::TraceHeader()
 }
 
 
-void System::UniformTrafficSimulation(Network *network)
+void System::ReadReplayFile()
+{
+	// Open file
+	std::ifstream file(replay_file);
+	if (!file)
+		throw Error(misc::fmt("%s: Cannot open trace file",
+				replay_file.c_str()));
+
+	// Read messages
+	replay_messages.resize(sim_end_nodes.size());
+	std::string line;
+	for (int line_num = 1; std::getline(file, line); line_num++)
+	{
+		// Skip comments and empty lines
+		misc::StringTrim(line);
+		if (line.empty() || line[0] == '#')
+			continue;
+
+		// Parse fields
+		std::istringstream stream(line);
+		long long cycle;
+		std::string network_name;
+		std::string source_name;
+		std::string destination_name;
+		int size;
+		if (!(stream >> cycle >> network_name >> source_name >>
+				destination_name >> size) || cycle < 0 ||
+				size < 1)
+			throw Error(misc::fmt("%s:%d: Invalid message",
+					replay_file.c_str(), line_num));
+
+		// Only messages of the simulated network
+		if (network_name != sim_network->getName())
+			continue;
+
+		// End nodes
+		auto source = std::find(sim_end_nodes.begin(),
+				sim_end_nodes.end(),
+				sim_network->getNodeByName(source_name));
+		auto destination = std::find(sim_end_nodes.begin(),
+				sim_end_nodes.end(),
+				sim_network->getNodeByName(destination_name));
+		if (source == sim_end_nodes.end() ||
+				destination == sim_end_nodes.end())
+			throw Error(misc::fmt("%s:%d: Invalid end node in "
+					"network '%s'",
+					replay_file.c_str(), line_num,
+					network_name.c_str()));
+
+		// Messages without a route would be retried forever
+		RoutingTable::Entry *entry = sim_network->getRoutingTable()->
+				Lookup(*source, *destination);
+		if (!entry->getBuffer())
+			throw Error(misc::fmt("%s:%d: No route from '%s' to "
+					"'%s'", replay_file.c_str(), line_num,
+					source_name.c_str(),
+					destination_name.c_str()));
+
+		// Add message to the source end node
+		replay_messages[source - sim_end_nodes.begin()].push_back({
+				cycle,
+				(int) (destination - sim_end_nodes.begin()),
+				size});
+	}
+
+	// Messages of each end node in cycle order, keeping the order of
+	// messages recorded in the same cycle
+	for (auto &messages : replay_messages)
+		std::stable_sort(messages.begin(), messages.end(),
+				[](const ReplayMessage &a,
+						const ReplayMessage &b)
+				{
+					return a.cycle < b.cycle;
+				});
+}
+
+
+void System::InjectSynthetic(InjectionFrame *frame)
 {
-	// Initiate a list of double for injection time
-	auto inject_time = misc::new_unique_array<double>(network->getNumNodes());
+	// Generate all messages due by the current cycle
+	long long cycle = getCycle();
+	while (frame->next_time <= cycle)
+	{
+		frame->next_time += RandomExponential(injection_rate);
+		frame->num_queued_messages++;
+		num_generated_messages++;
+	}
 
-	// Loop from the beginning to the end the simulation
-	while (1)
+	// Send queued messages in order while the node can send
+	EndNode *node = sim_end_nodes[frame->getNodeIndex()];
+	while (frame->num_queued_messages)
 	{
-		// Get current cycle and check max cycles
-		esim::Engine *esim_engine = esim::Engine::getInstance();
-		long long cycle = System::getInstance()->getCycle();
-		if (cycle >= max_cycles)
+		if (frame->destination < 0)
+			frame->destination = traffic_pattern->getDestination(
+					frame->getNodeIndex());
+		EndNode *destination_node = sim_end_nodes[frame->destination];
+		if (!sim_network->CanSend(node, destination_node,
+				message_size))
 			break;
+		sim_network->Send(node, destination_node, message_size);
+		frame->num_queued_messages--;
+		frame->destination = -1;
+	}
 
-		// Traverse all nodes to check if some nodes need injection
-		for (int i = 0; i < network->getNumNodes(); i++)
-		{
-			// Get end node
-			EndNode *node = dynamic_cast<EndNode *>(
-					network->getNode(i));
-			if (!node)
-				continue;
+	// Drop the messages that do not fit in the source queue
+	if (frame->num_queued_messages > source_queue_size)
+		frame->num_queued_messages = source_queue_size;
 
-			// Check turn for next injection
-			if (inject_time[i] > cycle)
-				continue;
+	// If messages are left in the source queue, the network schedules
+	// this event again when the node can send the first one. Messages
+	// generated in the meantime are added to the queue then.
+	if (frame->num_queued_messages)
+	{
+		sim_network->CanSend(node, sim_end_nodes[frame->destination],
+				message_size, event_inject);
+		return;
+	}
 
-			// Get a random destination node
-			EndNode *destination_node = nullptr;
-			while (1)
-			{
-				int num_nodes = network->getNumNodes();
-				int index = random() % num_nodes;
-				destination_node = dynamic_cast<EndNode *>(
-						network->getNode(index));
-				if (destination_node && destination_node != 
-						node)
-					break;
-			}
-
-			// Inject
-			while (inject_time[i] < cycle)
-			{
-				// Schedule next injection
-				inject_time[i] += RandomExponential(
-						injection_rate);
-
-				// Send the packet
-				if (network->CanSend(node, destination_node,
-					System::message_size))
-					network->Send(node, destination_node,
-							System::message_size);
-			}
+	// Wait for the next generated message
+	frame->destination = -1;
+	long long next_cycle = (long long) std::ceil(frame->next_time);
+	if (next_cycle < max_cycles)
+		esim_engine->Next(event_inject, next_cycle - cycle);
+}
+
+
+void System::InjectReplay(InjectionFrame *frame)
+{
+	// Send the messages due by the current cycle in order. If the node
+	// cannot send one of them, the network schedules this event again
+	// when it can.
+	long long cycle = getCycle();
+	EndNode *node = sim_end_nodes[frame->getNodeIndex()];
+	auto &messages = replay_messages[frame->getNodeIndex()];
+	while (frame->replay_position < messages.size())
+	{
+		// Wait for the next message
+		ReplayMessage &message = messages[frame->replay_position];
+		if (message.cycle > cycle)
+		{
+			if (message.cycle < max_cycles)
+				esim_engine->Next(event_inject,
+						message.cycle - cycle);
+			return;
 		}
 
-		// Next cycle
-		debug << misc::fmt("___ cycle %lld ___\n", cycle);	
-		esim_engine->ProcessEvents();
+		// Send it
+		EndNode *destination_node = sim_end_nodes[message.destination];
+		if (!sim_network->CanSend(node, destination_node,
+				message.size, event_inject))
+			return;
+		sim_network->Send(node, destination_node, message.size);
+		frame->replay_position++;
 	}
 }
 
+
 void System::StandAlone()
 {
-	// Generate a uniform traffic pattern on the network.
-	// Later, this function can be easily extended (via a switch)
-	// to support other traffic patterns, hence the stand-alone
-	// function is not combined with the uniform traffic function.
-	Network *network = getNetworkByName(sim_net_name);
-	if (!network)
+	// Network
+	sim_network = getNetworkByName(sim_net_name);
+	if (!sim_network)
 		throw Error(misc::fmt("%s: The network does not exist for "
 				"stand-alone simulation\n",
 				config_file.c_str()));
-	UniformTrafficSimulation(network);
+
+	// End nodes
+	for (int i = 0; i < sim_network->getNumNodes(); i++)
+	{
+		EndNode *node = dynamic_cast<EndNode *>(
+				sim_network->getNode(i));
+		if (node)
+			sim_end_nodes.push_back(node);
+	}
+
+	// Traffic source
+	if (replay_file.empty())
+		traffic_pattern = misc::new_unique<TrafficPattern>(
+				traffic_kind, sim_end_nodes.size(),
+				hotspot_node, hotspot_fraction);
+	else
+		ReadReplayFile();
+
+	// Saturation sweep
+	if (!sweep_file.empty())
+	{
+		SaturationSweep();
+		return;
+	}
+
+	// Single simulation
+	RunStandAlone();
+}
+
+
+void System::RunStandAlone()
+{
+	// Schedule the first injection of each end node. Idle nodes never
+	// have an event in flight.
+	for (int i = 0; i < (int) sim_end_nodes.size(); i++)
+	{
+		auto frame = misc::new_shared<InjectionFrame>(i);
+		long long first_cycle;
+		if (traffic_pattern)
+		{
+			if (traffic_pattern->isIdle(i))
+				continue;
+			frame->next_time = RandomExponential(injection_rate);
+			first_cycle = (long long) std::ceil(frame->next_time);
+		}
+		else
+		{
+			if (replay_messages[i].empty())
+				continue;
+			first_cycle = replay_messages[i][0].cycle;
+		}
+		if (first_cycle < max_cycles)
+			esim_engine->Call(event_inject, frame, nullptr,
+					first_cycle - getCycle());
+	}
+
+	// Simulate until the maximum number of cycles
+	while (getCycle() < max_cycles)
+	{
+		debug << misc::fmt("___ cycle %lld ___\n", getCycle());
+		esim_engine->ProcessEvents();
+	}
 }
 
 
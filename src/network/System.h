@@ -22,6 +22,8 @@
 
 #include <cassert>
 #include <cmath>
+#include <fstream>
+#include <vector>
 
 #include <lib/cpp/Debug.h>
 #include <lib/cpp/Error.h>
@@ -31,9 +33,13 @@
 #include <lib/esim/Trace.h>
 
 #include "Network.h"
+#include "TrafficPattern.h"
+
 namespace net
 {
 
+class EndNode;
+class InjectionFrame;
 class Network;
 
 
@@ -88,9 +94,45 @@ class System
 	// Stand-alone message injection rate
 	static double injection_rate;
 
+	// Messages that each end node keeps waiting in stand-alone synthetic
+	// traffic when it cannot send them, or -1 for the default. Others are
+	// dropped.
+	static int source_queue_size;
+
 	// Stand-alone simulator instantiator
 	static bool stand_alone;
 
+	// Stand-alone traffic pattern
+	static TrafficPattern::Kind traffic_kind;
+
+	// End node receiving extra traffic in the hotspot pattern
+	static int hotspot_node;
+
+	// Fraction of messages sent to the hotspot node
+	static double hotspot_fraction;
+
+	// Message trace to replay in the stand-alone simulation
+	static std::string replay_file;
+
+	// Message trace recorded during the simulation
+	static std::string message_trace_file;
+	static std::ofstream message_trace;
+
+	// Report of the saturation-throughput sweep
+	static std::string sweep_file;
+
+	// Maximum number of sweep workers running in parallel
+	static int sweep_jobs;
+
+	// Number of refinement rounds in the sweep
+	static int sweep_rounds;
+
+	// Number of host threads computing routing tables
+	static int route_threads;
+
+	// Directory where computed routing tables are cached
+	static std::string route_cache_directory;
+
 	// Unique instance of singleton
 	static std::unique_ptr<System> instance;
 
@@ -120,6 +162,7 @@ class System
 	static void EventTypeOutputBufferHandler(esim::Event *, esim::Frame *);
 	static void EventTypeInputBufferHandler(esim::Event *, esim::Frame *);
 	static void EventTypeReceiveHandler(esim::Event *, esim::Frame *);
+	static void EventTypeInjectHandler(esim::Event *, esim::Frame *);
 
 
 
@@ -140,6 +183,80 @@ class System
 	// List of networks in the system
 	std::vector<std::unique_ptr<Network>> networks;
 
+
+
+
+	//
+	// Stand-alone simulation
+	//
+
+	// A message of a replayed trace
+	struct ReplayMessage
+	{
+		long long cycle;
+		int destination;
+		int size;
+	};
+
+	// Network simulated stand-alone
+	Network *sim_network = nullptr;
+
+	// End nodes of the simulated network, in the order in which they
+	// appear in the configuration file
+	std::vector<EndNode *> sim_end_nodes;
+
+	// Synthetic traffic pattern, or nullptr when replaying a trace
+	std::unique_ptr<TrafficPattern> traffic_pattern;
+
+	// Messages to replay, for each end node, sorted by cycle
+	std::vector<std::vector<ReplayMessage>> replay_messages;
+
+	// Number of synthetic messages generated by all end nodes, including
+	// those dropped because the source could not send them
+	long long num_generated_messages = 0;
+
+	// Results of a simulation in the saturation sweep
+	struct SweepPoint
+	{
+		// Injection rate given to each end node
+		double injection_rate;
+
+		// Messages generated and delivered per end node per cycle
+		double offered_load;
+		double accepted_throughput;
+
+		// Latency of delivered messages, in cycles
+		double average_latency;
+		long long p50_latency;
+		long long p99_latency;
+		long long max_latency;
+
+		// Whether the network is saturated at this injection rate
+		bool saturated;
+	};
+
+	// Read the messages of the simulated network from the replay file
+	void ReadReplayFile();
+
+	// Inject synthetic messages from an end node
+	void InjectSynthetic(InjectionFrame *frame);
+
+	// Inject replayed messages from an end node
+	void InjectReplay(InjectionFrame *frame);
+
+	// Schedule the injections of all end nodes and simulate until the
+	// maximum number of cycles
+	void RunStandAlone();
+
+	// Simulate the given injection rates in parallel worker processes,
+	// and return their results in the same order
+	std::vector<SweepPoint> RunSweepPoints(
+			const std::vector<double> &injection_rates);
+
+	// Search for the saturation throughput of the stand-alone network
+	// with option '--net-sweep', and write the report
+	void SaturationSweep();
+
 public:
 
 	//
@@ -163,6 +280,7 @@ public:
 	static esim::Event *event_output_buffer;
 	static esim::Event *event_input_buffer;
 	static esim::Event *event_receive;
+	static esim::Event *event_inject;
 
 	/// Network system trace
 	static esim::Trace trace;
@@ -199,6 +317,39 @@ public:
 	/// by the user.
 	static int getMessageSize() { return message_size; }
 
+	/// Return the number of host threads computing routing tables, given
+	/// with option '--net-route-threads'.
+	static int getRouteThreads() { return route_threads; }
+
+	/// Set the number of host threads computing routing tables.
+	static void setRouteThreads(int route_threads)
+	{
+		System::route_threads = route_threads;
+	}
+
+	/// Return the directory given with option '--net-route-cache', or an
+	/// empty string if routing tables are not cached.
+	static const std::string &getRouteCacheDirectory()
+	{
+		return route_cache_directory;
+	}
+
+	/// Set the directory where routing tables are cached, or an empty
+	/// string to disable the cache.
+	static void setRouteCacheDirectory(const std::string &directory)
+	{
+		route_cache_directory = directory;
+	}
+
+	/// Record a message sent through \a network in the message trace
+	/// given with option '--net-msg-trace', if any. Each line of the
+	/// trace contains the cycle, network name, source end node name,
+	/// destination end node name, and message size. The trace can be
+	/// replayed later in a stand-alone simulation with option
+	/// '--net-replay'.
+	static void TraceMessage(Network *network, EndNode *source_node,
+			EndNode *destination_node, int size);
+
 
 
 
@@ -242,10 +393,12 @@ public:
 	// file passed with '--net-config' by the user.
 	void ReadConfiguration();
 
-	// Uniform traffic simulation
-	void UniformTrafficSimulation(Network *network);
-
-	// Stand-Alone simulation
+	/// Stand-alone simulation of the network given with option
+	/// '--net-sim'. Each end node injects messages following the
+	/// synthetic traffic pattern given with option '--net-traffic', or
+	/// the messages recorded in the trace given with '--net-replay'.
+	/// Injections are scheduled as events of each end node, so idle
+	/// nodes do not cost simulation time.
 	void StandAlone();
 
     int getNumNetworks() const { return networks.size(); }
@@ -70,6 +70,36 @@ const std::string System::help_message =
 		"      packetizing, with the fix_latency, regardless of\n"
 		"      the network topology. The ideal option still requires a\n"
 		"      network to connect the end-nodes to each other\n"
+		"  Topology = {Mesh|Torus|FatTree|Dragonfly} (Optional)\n"
+		"      If set, the nodes and links of the network are generated\n"
+		"      from the parameters below, and sections for nodes, links,\n"
+		"      buses, and routes of the network are not allowed. End\n"
+		"      nodes are named 'n0', 'n1', ..., and switches 's0', 's1',\n"
+		"      .... Packets are routed algorithmically with no routing\n"
+		"      table: dimension-order routing for meshes and tori, using\n"
+		"      two virtual channels in tori; up*/down* routing for fat\n"
+		"      trees; and minimal routing for dragonflies, using two\n"
+		"      virtual channels in local links.\n"
+		"  Dimensions = <k1>x<k2>x... (Required for Mesh and Torus)\n"
+		"      Number of switches in each dimension, each with one end\n"
+		"      node. For example, '16x16' creates a 256-node 2D network.\n"
+		"  Arity = <k> (Required for FatTree)\n"
+		"  Levels = <n> (Required for FatTree)\n"
+		"      Fat tree with k^n end nodes and n levels of k^(n-1)\n"
+		"      switches with k down and k up ports.\n"
+		"  RoutersPerGroup = <a> (Required for Dragonfly)\n"
+		"  TerminalsPerRouter = <p> (Required for Dragonfly)\n"
+		"  GlobalLinksPerRouter = <h> (Required for Dragonfly)\n"
+		"      Dragonfly with a*h+1 fully connected groups of a switches,\n"
+		"      each with p end nodes and h global links.\n"
+		"  Routing = {Deterministic|Adaptive} (Default = Deterministic)\n"
+		"      Routing algorithm of a generated topology. With adaptive\n"
+		"      routing, links between switches get one more virtual\n"
+		"      channel, and switches forward packets on that channel\n"
+		"      through the least occupied minimal route, counting the\n"
+		"      input buffer at the other end of the link. When none can\n"
+		"      take the packet, the deterministic route is used as a\n"
+		"      deadlock-free escape path.\n"
 		"\n"
 		"Sections '[ Network.<network>.Node.<node> ]' are used to \n"
 		"define nodes in network '<network>'.\n"
@@ -35,6 +35,7 @@ esim::Event *System::event_send;
 esim::Event *System::event_output_buffer;
 esim::Event *System::event_input_buffer;
 esim::Event *System::event_receive;
+esim::Event *System::event_inject;
 
 
 void System::EventTypeSendHandler(esim::Event *event,
@@ -231,5 +232,19 @@ void System::EventTypeReceiveHandler(esim::Event *event,
 	}
 }
 
+
+void System::EventTypeInjectHandler(esim::Event *event,
+		esim::Frame *frame)
+{
+	// Cast event frame type
+	InjectionFrame *injection_frame = misc::cast<InjectionFrame *>(frame);
+
+	// Synthetic traffic or trace replay
+	System *system = getInstance();
+	if (system->traffic_pattern)
+		system->InjectSynthetic(injection_frame);
+	else
+		system->InjectReplay(injection_frame);
 }
 
+}
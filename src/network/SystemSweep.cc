@@ -0,0 +1,305 @@
+/* 
+ *  Multi2Sim
+ *  Copyright (C) 2014  Amir Kavyan Ziabari (aziabari@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <lib/cpp/Misc.h>
+
+#include "EndNode.h"
+#include "Network.h"
+#include "System.h"
+
+namespace net
+{
+
+// Injection rate of the point used to measure the zero-load latency
+static const double sweep_zero_load_rate = 0.001;
+
+// Minimum number of points simulated in every round of the sweep
+static const int sweep_min_points = 4;
+
+// The network is saturated above this multiple of the zero-load latency
+static const double sweep_latency_factor = 3.0;
+
+// The network is saturated below this fraction of accepted offered load
+static const double sweep_accepted_fraction = 0.9;
+
+
+std::vector<System::SweepPoint> System::RunSweepPoints(
+		const std::vector<double> &injection_rates)
+{
+	// Running workers
+	struct Worker
+	{
+		pid_t pid;
+		int fd;
+		unsigned index;
+	};
+	std::vector<Worker> workers;
+	std::vector<SweepPoint> points(injection_rates.size());
+
+	// Pending output would be written again by every worker
+	std::cout.flush();
+	std::cerr.flush();
+
+	// Run workers
+	unsigned next_index = 0;
+	while (next_index < injection_rates.size() || workers.size())
+	{
+		// Fork a new worker
+		if (next_index < injection_rates.size() &&
+				(int) workers.size() < sweep_jobs)
+		{
+			int fds[2];
+			if (pipe(fds) < 0)
+				throw Error(misc::fmt("Cannot create pipe for "
+						"sweep worker: %s",
+						strerror(errno)));
+			unsigned index = next_index++;
+			pid_t pid = fork();
+			if (pid < 0)
+				throw Error(misc::fmt("Cannot fork sweep "
+						"worker: %s", strerror(errno)));
+
+			// Worker simulates the injection rate and sends its
+			// results through the pipe
+			if (!pid)
+			{
+				int status = 0;
+				try
+				{
+					close(fds[0]);
+					injection_rate = injection_rates[index];
+
+					// Every worker inherits the random state of
+					// the parent. Seed it from the injection rate
+					// to give each point its own sequence.
+					srandom((unsigned) std::lround(injection_rate *
+							1e6));
+					RunStandAlone();
+
+					// Results
+					double node_cycles = (double) getCycle() *
+							sim_end_nodes.size();
+					SweepPoint point;
+					point.injection_rate = injection_rate;
+					point.offered_load = num_generated_messages /
+							node_cycles;
+					point.accepted_throughput = sim_network->
+							getNumTransfers() / node_cycles;
+					point.average_latency = sim_network->
+							getAverageLatency();
+					point.p50_latency = sim_network->
+							getLatencyPercentile(0.5);
+					point.p99_latency = sim_network->
+							getLatencyPercentile(0.99);
+					point.max_latency = sim_network->
+							getLatencyPercentile(1.0);
+					point.saturated = false;
+					if (write(fds[1], &point, sizeof point) !=
+							sizeof point)
+						status = 1;
+				}
+				catch (misc::Exception &e)
+				{
+					e.Dump();
+					status = 1;
+				}
+				std::cerr.flush();
+				_exit(status);
+			}
+
+			// Parent keeps the read end of the pipe
+			close(fds[1]);
+			workers.push_back({pid, fds[0], index});
+			continue;
+		}
+
+		// Wait for a worker to finish
+		int status;
+		pid_t pid = waitpid(-1, &status, 0);
+		if (pid < 0 && errno == EINTR)
+			continue;
+		if (pid < 0)
+			throw Error(misc::fmt("Cannot wait for sweep workers: %s",
+					strerror(errno)));
+		auto it = std::find_if(workers.begin(), workers.end(),
+				[pid](const Worker &worker)
+				{
+					return worker.pid == pid;
+				});
+		if (it == workers.end())
+			continue;
+
+		// Read results
+		SweepPoint &point = points[it->index];
+		bool valid = read(it->fd, &point, sizeof point) ==
+				sizeof point;
+		close(it->fd);
+		if (!valid || !WIFEXITED(status) || WEXITSTATUS(status))
+			throw Error(misc::fmt("Sweep worker for injection rate "
+					"%g failed",
+					injection_rates[it->index]));
+		workers.erase(it);
+
+		// Progress
+		std::cerr << misc::fmt("Network sweep: injection rate %.6f, "
+				"average latency %.2f, accepted throughput "
+				"%.6f\n", point.injection_rate,
+				point.average_latency,
+				point.accepted_throughput);
+	}
+
+	// Done
+	return points;
+}
+
+
+void System::SaturationSweep()
+{
+	// Check valid report file
+	std::ofstream report(sweep_file);
+	if (!report)
+		throw Error(misc::fmt("%s: Cannot open sweep report file",
+				sweep_file.c_str()));
+
+	// First round with the zero-load point and evenly distributed
+	// injection rates up to one message per node and cycle
+	int num_points = std::max(sweep_jobs, sweep_min_points);
+	std::vector<double> injection_rates = { sweep_zero_load_rate };
+	for (int i = 1; i <= num_points; i++)
+		injection_rates.push_back((double) i / num_points);
+	std::vector<SweepPoint> points = RunSweepPoints(injection_rates);
+
+	// Zero-load latency
+	double zero_load_latency = points[0].average_latency;
+	if (!points[0].accepted_throughput)
+		throw Error(misc::fmt("No message delivered at the zero-load "
+				"injection rate (%g). Increase the number of "
+				"cycles with option '--net-max-cycles'",
+				sweep_zero_load_rate));
+
+	// Refine the saturation point
+	double unsaturated_rate = 0.0;
+	double saturated_rate = 0.0;
+	for (int round = 0; ; round++)
+	{
+		// Classify points
+		for (auto &point : points)
+			point.saturated = point.average_latency >
+					sweep_latency_factor * zero_load_latency ||
+					point.accepted_throughput <
+					sweep_accepted_fraction *
+					point.offered_load;
+
+		// Lowest saturated rate, and highest unsaturated rate below
+		// it. Rates are not monotonic in the presence of noise.
+		saturated_rate = 0.0;
+		for (auto &point : points)
+			if (point.saturated && (!saturated_rate ||
+					point.injection_rate < saturated_rate))
+				saturated_rate = point.injection_rate;
+		unsaturated_rate = 0.0;
+		for (auto &point : points)
+			if (!point.saturated && (!saturated_rate ||
+					point.injection_rate < saturated_rate))
+				unsaturated_rate = std::max(unsaturated_rate,
+						point.injection_rate);
+
+		// Stop if the network never saturates or after the last round
+		if (!saturated_rate || round == sweep_rounds)
+			break;
+
+		// Evenly distributed rates between the bounds
+		injection_rates.clear();
+		for (int i = 1; i <= num_points; i++)
+			injection_rates.push_back(unsaturated_rate +
+					(saturated_rate - unsaturated_rate) *
+					i / (num_points + 1));
+		std::vector<SweepPoint> round_points =
+				RunSweepPoints(injection_rates);
+		points.insert(points.end(), round_points.begin(),
+				round_points.end());
+	}
+
+	// Points in order of injection rate
+	std::sort(points.begin(), points.end(),
+			[](const SweepPoint &a, const SweepPoint &b)
+			{
+				return a.injection_rate < b.injection_rate;
+			});
+
+	// Accepted throughput at the saturation point
+	double saturation_throughput = 0.0;
+	for (auto &point : points)
+		if (point.injection_rate == unsaturated_rate)
+			saturation_throughput = point.accepted_throughput;
+
+	// Summary
+	report << "; Network saturation sweep report\n";
+	report << "; Offered load and accepted throughput are given in "
+			"messages per end node per cycle.\n";
+	report << "; Latencies are given in cycles.\n";
+	report << "\n";
+	report << "[ Sweep ]\n";
+	report << "Network = " << sim_network->getName() << '\n';
+	report << "Traffic = " << TrafficPattern::KindMap[traffic_kind]
+			<< '\n';
+	report << "EndNodes = " << sim_end_nodes.size() << '\n';
+	report << "MessageSize = " << message_size << '\n';
+	report << "SourceQueue = " << source_queue_size << '\n';
+	report << "Cycles = " << max_cycles << '\n';
+	report << misc::fmt("ZeroLoadLatency = %.4f\n", zero_load_latency);
+	report << misc::fmt("SaturationRate = %.6f\n", unsaturated_rate);
+	report << misc::fmt("SaturatedRate = %.6f\n", saturated_rate);
+	report << misc::fmt("SaturationThroughput = %.6f\n",
+			saturation_throughput);
+	report << "Points = " << points.size() << '\n';
+	report << '\n';
+
+	// Latency-versus-offered-load curve
+	for (unsigned index = 0; index < points.size(); index++)
+	{
+		SweepPoint &point = points[index];
+		report << misc::fmt("[ Point %d ]\n", index);
+		report << misc::fmt("InjectionRate = %.6f\n",
+				point.injection_rate);
+		report << misc::fmt("OfferedLoad = %.6f\n", point.offered_load);
+		report << misc::fmt("AcceptedThroughput = %.6f\n",
+				point.accepted_throughput);
+		report << misc::fmt("AverageLatency = %.4f\n",
+				point.average_latency);
+		report << "P50Latency = " << point.p50_latency << '\n';
+		report << "P99Latency = " << point.p99_latency << '\n';
+		report << "MaxLatency = " << point.max_latency << '\n';
+		report << "Saturated = " << (point.saturated ? "True" : "False")
+				<< '\n';
+		report << '\n';
+	}
+}
+
+
+}  // namespace net
@@ -0,0 +1,590 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2014  Amir Kavyan Ziabari (aziabari@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cassert>
+
+#include "EndNode.h"
+#include "Link.h"
+#include "Network.h"
+#include "Switch.h"
+#include "System.h"
+#include "Topology.h"
+
+
+namespace net
+{
+
+
+const misc::StringMap Topology::KindMap =
+{
+	{ "Mesh", KindMesh },
+	{ "Torus", KindTorus },
+	{ "FatTree", KindFatTree },
+	{ "Dragonfly", KindDragonfly }
+};
+
+
+const misc::StringMap Topology::RoutingMap =
+{
+	{ "Deterministic", RoutingDeterministic },
+	{ "Adaptive", RoutingAdaptive }
+};
+
+
+Topology::Topology(Network *network, Kind kind, Routing routing,
+		int input_buffer_size, int output_buffer_size, int bandwidth) :
+		network(network),
+		kind(kind),
+		routing(routing),
+		input_buffer_size(input_buffer_size),
+		output_buffer_size(output_buffer_size),
+		bandwidth(bandwidth)
+{
+}
+
+
+std::unique_ptr<Topology> Topology::Create(Network *network,
+		misc::IniFile *ini_file,
+		const std::string &section,
+		int input_buffer_size,
+		int output_buffer_size,
+		int bandwidth)
+{
+	// Topology kind
+	std::string kind_name = ini_file->ReadString(section, "Topology");
+	bool error;
+	Kind kind = (Kind) KindMap.MapString(kind_name, error);
+	if (error)
+		throw Error(misc::fmt("%s: %s: Invalid value for 'Topology'. "
+				"Possible values are %s.\n%s",
+				ini_file->getPath().c_str(), section.c_str(),
+				KindMap.toString().c_str(),
+				System::err_config_note));
+
+	// Routing algorithm
+	std::string routing_name = ini_file->ReadString(section, "Routing",
+			"Deterministic");
+	Routing routing = (Routing) RoutingMap.MapString(routing_name, error);
+	if (error)
+		throw Error(misc::fmt("%s: %s: Invalid value for 'Routing'. "
+				"Possible values are %s.\n%s",
+				ini_file->getPath().c_str(), section.c_str(),
+				RoutingMap.toString().c_str(),
+				System::err_config_note));
+
+	// Mesh and torus
+	if (kind == KindMesh || kind == KindTorus)
+	{
+		ini_file->Enforce(section, "Dimensions");
+		std::string text = ini_file->ReadString(section, "Dimensions");
+		std::vector<std::string> tokens;
+		misc::StringTokenize(text, tokens, "x");
+		std::vector<int> dimensions;
+		for (auto &token : tokens)
+		{
+			misc::StringError error;
+			int size = misc::StringToInt(token, error);
+			if (error || size < 1)
+				throw Error(misc::fmt("%s: %s: Invalid value "
+						"for 'Dimensions' (%s).\n%s",
+						ini_file->getPath().c_str(),
+						section.c_str(), text.c_str(),
+						System::err_config_note));
+			dimensions.push_back(size);
+		}
+		if (dimensions.empty())
+			throw Error(misc::fmt("%s: %s: No dimensions given.\n%s",
+					ini_file->getPath().c_str(),
+					section.c_str(),
+					System::err_config_note));
+		return misc::new_unique<MeshTopology>(network, kind, routing,
+				input_buffer_size, output_buffer_size,
+				bandwidth, dimensions);
+	}
+
+	// Fat tree
+	if (kind == KindFatTree)
+	{
+		ini_file->Enforce(section, "Arity");
+		ini_file->Enforce(section, "Levels");
+		int arity = ini_file->ReadInt(section, "Arity");
+		int levels = ini_file->ReadInt(section, "Levels");
+		if (arity < 2 || levels < 1)
+			throw Error(misc::fmt("%s: %s: Fat tree requires an "
+					"arity of at least 2 and at least one "
+					"level.\n%s",
+					ini_file->getPath().c_str(),
+					section.c_str(),
+					System::err_config_note));
+		return misc::new_unique<FatTreeTopology>(network, routing,
+				input_buffer_size, output_buffer_size,
+				bandwidth, arity, levels);
+	}
+
+	// Dragonfly
+	assert(kind == KindDragonfly);
+	ini_file->Enforce(section, "RoutersPerGroup");
+	ini_file->Enforce(section, "TerminalsPerRouter");
+	ini_file->Enforce(section, "GlobalLinksPerRouter");
+	int group_size = ini_file->ReadInt(section, "RoutersPerGroup");
+	int concentration = ini_file->ReadInt(section, "TerminalsPerRouter");
+	int num_global_links = ini_file->ReadInt(section,
+			"GlobalLinksPerRouter");
+	if (group_size < 1 || concentration < 1 || num_global_links < 1)
+		throw Error(misc::fmt("%s: %s: Dragonfly parameters must be "
+				"at least 1.\n%s",
+				ini_file->getPath().c_str(), section.c_str(),
+				System::err_config_note));
+	return misc::new_unique<DragonflyTopology>(network, routing,
+			input_buffer_size, output_buffer_size, bandwidth,
+			group_size, concentration, num_global_links);
+}
+
+
+void Topology::AddNodes(int num_end_nodes, int num_switches,
+		int num_switch_ports)
+{
+	// End nodes first, so that their index in the network is their index
+	// in the topology
+	assert(!network->getNumNodes());
+	this->num_end_nodes = num_end_nodes;
+	this->num_switches = num_switches;
+	for (int i = 0; i < num_end_nodes; i++)
+		network->addEndNode(input_buffer_size, output_buffer_size,
+				misc::fmt("n%d", i), nullptr);
+	for (int i = 0; i < num_switches; i++)
+		network->addSwitch(input_buffer_size, output_buffer_size,
+				bandwidth, misc::fmt("s%d", i));
+
+	// Ports
+	ports.resize(num_end_nodes + num_switches);
+	for (int i = 0; i < num_end_nodes; i++)
+		ports[i].resize(1);
+	for (int i = 0; i < num_switches; i++)
+		ports[num_end_nodes + i].resize(num_switch_ports);
+}
+
+
+Node *Topology::getEndNode(int index) const
+{
+	assert(index >= 0 && index < num_end_nodes);
+	return network->getNode(index);
+}
+
+
+Node *Topology::getSwitch(int index) const
+{
+	assert(index >= 0 && index < num_switches);
+	return network->getNode(num_end_nodes + index);
+}
+
+
+void Topology::Connect(Node *node_a, int port_a, Node *node_b, int port_b,
+		int num_virtual_channels)
+{
+	std::string name = node_a->getName() + "-" + node_b->getName();
+	Link *&link_a = ports[node_a->getIndex()][port_a];
+	Link *&link_b = ports[node_b->getIndex()][port_b];
+	assert(!link_a && !link_b);
+	link_a = network->addLink(name, node_a, node_b, bandwidth,
+			output_buffer_size, input_buffer_size,
+			num_virtual_channels);
+	link_b = network->addLink(name, node_b, node_a, bandwidth,
+			output_buffer_size, input_buffer_size,
+			num_virtual_channels);
+}
+
+
+Buffer *Topology::getOutputBuffer(Node *node, int port,
+		int virtual_channel) const
+{
+	Link *link = ports[node->getIndex()][port];
+	assert(link);
+	return link->getSourceBuffer(virtual_channel);
+}
+
+
+Buffer *Topology::getAdaptiveBuffer(Node *node, int port) const
+{
+	// Links to end nodes have no adaptive channel
+	Link *link = ports[node->getIndex()][port];
+	assert(link);
+	if (routing != RoutingAdaptive ||
+			link->getDestinationNode()->getIndex() < num_end_nodes)
+		return nullptr;
+	return link->getSourceBuffer(link->getNumVirtualChannels() - 1);
+}
+
+
+void Topology::AdaptiveRouteSwitch(int index, int destination,
+		std::vector<Buffer *> &buffers) const
+{
+	// Adaptive channel of the port of the deterministic route
+	Buffer *buffer = RouteSwitch(index, destination);
+	Node *node = getSwitch(index);
+	for (unsigned port = 0; port < ports[node->getIndex()].size(); port++)
+	{
+		Link *link = ports[node->getIndex()][port];
+		if (link && link == buffer->getConnection())
+		{
+			buffer = getAdaptiveBuffer(node, port);
+			if (buffer)
+				buffers.push_back(buffer);
+			return;
+		}
+	}
+}
+
+
+Buffer *Topology::Route(Node *node, Node *destination) const
+{
+	// Only end nodes are destinations
+	int index = node->getIndex();
+	int destination_index = destination->getIndex();
+	if (destination_index >= num_end_nodes || destination_index == index)
+		return nullptr;
+
+	// End nodes have a single link to their switch
+	if (index < num_end_nodes)
+		return getOutputBuffer(node, 0);
+
+	// Route in the topology
+	return RouteSwitch(index - num_end_nodes, destination_index);
+}
+
+
+void Topology::getAdaptiveRoutes(Node *node, Node *destination,
+		std::vector<Buffer *> &buffers) const
+{
+	// Only switches route adaptively
+	int index = node->getIndex();
+	int destination_index = destination->getIndex();
+	if (routing != RoutingAdaptive || index < num_end_nodes ||
+			destination_index >= num_end_nodes)
+		return;
+	AdaptiveRouteSwitch(index - num_end_nodes, destination_index,
+			buffers);
+}
+
+
+
+
+//
+// Class 'MeshTopology'
+//
+
+MeshTopology::MeshTopology(Network *network, Kind kind, Routing routing,
+		int input_buffer_size, int output_buffer_size, int bandwidth,
+		const std::vector<int> &dimensions) :
+		Topology(network, kind, routing, input_buffer_size,
+				output_buffer_size, bandwidth),
+		dimensions(dimensions)
+{
+	// Strides
+	int size = 1;
+	for (int dimension : dimensions)
+	{
+		strides.push_back(size);
+		size *= dimension;
+	}
+
+	// Nodes
+	AddNodes(size, size, 1 + 2 * dimensions.size());
+	for (int i = 0; i < size; i++)
+		Connect(getSwitch(i), 0, getEndNode(i), 0);
+
+	// Links to the next switch in each dimension. Rings of a torus use
+	// two virtual channels to break the cyclic dependence.
+	int num_virtual_channels = getNumVirtualChannels(kind == KindTorus ?
+			2 : 1);
+	for (int i = 0; i < size; i++)
+	{
+		for (unsigned d = 0; d < dimensions.size(); d++)
+		{
+			int coordinate = i / strides[d] % dimensions[d];
+			int next;
+			if (coordinate + 1 < dimensions[d])
+				next = i + strides[d];
+			else if (kind == KindTorus && dimensions[d] > 1)
+				next = i - coordinate * strides[d];
+			else
+				continue;
+			Connect(getSwitch(i), getPort(d, true),
+					getSwitch(next), getPort(d, false),
+					num_virtual_channels);
+		}
+	}
+}
+
+
+Buffer *MeshTopology::RouteSwitch(int index, int destination) const
+{
+	// The destination end node is attached to the switch with its index
+	Node *node = getSwitch(index);
+	for (unsigned d = 0; d < dimensions.size(); d++)
+	{
+		// First dimension where coordinates differ
+		int size = dimensions[d];
+		int coordinate = index / strides[d] % size;
+		int target = destination / strides[d] % size;
+		if (coordinate == target)
+			continue;
+
+		// Mesh
+		if (kind == KindMesh)
+			return getOutputBuffer(node, getPort(d, target >
+					coordinate));
+
+		// Torus, in the shortest direction, and on virtual channel 0
+		// while the wrap-around link is still ahead
+		bool positive = (target - coordinate + size) % size <= size / 2;
+		bool wraps = positive ? target < coordinate :
+				target > coordinate;
+		return getOutputBuffer(node, getPort(d, positive),
+				wraps ? 0 : 1);
+	}
+
+	// Arrived
+	return getOutputBuffer(node, 0);
+}
+
+
+void MeshTopology::AdaptiveRouteSwitch(int index, int destination,
+		std::vector<Buffer *> &buffers) const
+{
+	// Every direction reducing the distance in some dimension. Both
+	// directions of a torus ring are minimal halfway around it.
+	Node *node = getSwitch(index);
+	for (unsigned d = 0; d < dimensions.size(); d++)
+	{
+		int size = dimensions[d];
+		int coordinate = index / strides[d] % size;
+		int target = destination / strides[d] % size;
+		if (coordinate == target)
+			continue;
+		if (kind == KindMesh)
+		{
+			buffers.push_back(getAdaptiveBuffer(node, getPort(d,
+					target > coordinate)));
+			continue;
+		}
+		int distance = (target - coordinate + size) % size;
+		if (distance <= size / 2)
+			buffers.push_back(getAdaptiveBuffer(node,
+					getPort(d, true)));
+		if (size - distance <= size / 2)
+			buffers.push_back(getAdaptiveBuffer(node,
+					getPort(d, false)));
+	}
+}
+
+
+
+
+//
+// Class 'FatTreeTopology'
+//
+
+FatTreeTopology::FatTreeTopology(Network *network, Routing routing,
+		int input_buffer_size, int output_buffer_size, int bandwidth,
+		int arity, int levels) :
+		Topology(network, KindFatTree, routing, input_buffer_size,
+				output_buffer_size, bandwidth),
+		arity(arity),
+		levels(levels)
+{
+	// Nodes
+	level_size = 1;
+	for (int i = 1; i < levels; i++)
+		level_size *= arity;
+	AddNodes(level_size * arity, level_size * levels, 2 * arity);
+
+	// End nodes on the down ports of the first level
+	for (int w = 0; w < level_size; w++)
+		for (int j = 0; j < arity; j++)
+			Connect(getSwitch(w), j, getEndNode(w * arity + j), 0);
+
+	// Up ports of each level
+	for (int level = 0; level < levels - 1; level++)
+	{
+		for (int w = 0; w < level_size; w++)
+		{
+			for (int j = 0; j < arity; j++)
+			{
+				int parent = (level + 1) * level_size +
+						setDigit(w, level, j);
+				Connect(getSwitch(level * level_size + w),
+						arity + j,
+						getSwitch(parent),
+						getDigit(w, level),
+						getNumVirtualChannels(1));
+			}
+		}
+	}
+}
+
+
+int FatTreeTopology::getDigit(int value, int digit) const
+{
+	for (int i = 0; i < digit; i++)
+		value /= arity;
+	return value % arity;
+}
+
+
+int FatTreeTopology::setDigit(int value, int digit, int replace) const
+{
+	int weight = 1;
+	for (int i = 0; i < digit; i++)
+		weight *= arity;
+	return value + (replace - getDigit(value, digit)) * weight;
+}
+
+
+Buffer *FatTreeTopology::RouteSwitch(int index, int destination) const
+{
+	// The subtree of switch (l, w) contains the end nodes whose digits
+	// above l match the digits of w from l on
+	Node *node = getSwitch(index);
+	int level = index / level_size;
+	int w = index % level_size;
+	bool below = true;
+	for (int i = level; i < levels - 1 && below; i++)
+		below = getDigit(w, i) == getDigit(destination, i + 1);
+
+	// Down towards the destination, or up
+	if (below)
+		return getOutputBuffer(node, getDigit(destination, level));
+	return getOutputBuffer(node, arity + getDigit(destination,
+			level + 1));
+}
+
+
+void FatTreeTopology::AdaptiveRouteSwitch(int index, int destination,
+		std::vector<Buffer *> &buffers) const
+{
+	// Down towards the destination
+	Link *link = misc::cast<Link *>(RouteSwitch(index, destination)->
+			getConnection());
+	int next = link->getDestinationNode()->getIndex() - num_end_nodes;
+	if (next < 0 || next / level_size < index / level_size)
+	{
+		Topology::AdaptiveRouteSwitch(index, destination, buffers);
+		return;
+	}
+
+	// Any up port leads to a common ancestor
+	Node *node = getSwitch(index);
+	for (int j = 0; j < arity; j++)
+		buffers.push_back(getAdaptiveBuffer(node, arity + j));
+}
+
+
+
+
+//
+// Class 'DragonflyTopology'
+//
+
+DragonflyTopology::DragonflyTopology(Network *network, Routing routing,
+		int input_buffer_size, int output_buffer_size, int bandwidth,
+		int group_size, int concentration, int num_global_links) :
+		Topology(network, KindDragonfly, routing, input_buffer_size,
+				output_buffer_size, bandwidth),
+		group_size(group_size),
+		concentration(concentration),
+		num_global_links(num_global_links)
+{
+	// Nodes
+	num_groups = group_size * num_global_links + 1;
+	int num_switches = num_groups * group_size;
+	AddNodes(num_switches * concentration, num_switches,
+			concentration + group_size - 1 + num_global_links);
+
+	// End nodes
+	for (int i = 0; i < num_switches; i++)
+		for (int j = 0; j < concentration; j++)
+			Connect(getSwitch(i), j,
+					getEndNode(i * concentration + j), 0);
+
+	// Local links, with two virtual channels for the source and
+	// destination groups
+	for (int group = 0; group < num_groups; group++)
+		for (int member = 0; member < group_size; member++)
+			for (int other = member + 1; other < group_size;
+					other++)
+				Connect(getSwitch(group * group_size + member),
+						getLocalPort(member, other),
+						getSwitch(group * group_size +
+								other),
+						getLocalPort(other, member),
+						getNumVirtualChannels(2));
+
+	// Global links, once for each pair of groups
+	for (int group = 0; group < num_groups; group++)
+	{
+		for (int other = group + 1; other < num_groups; other++)
+		{
+			int link = getGroupLink(group, other);
+			int other_link = getGroupLink(other, group);
+			Connect(getSwitch(group * group_size +
+					link / num_global_links),
+					getGlobalPort(link % num_global_links),
+					getSwitch(other * group_size +
+					other_link / num_global_links),
+					getGlobalPort(other_link %
+					num_global_links),
+					getNumVirtualChannels(1));
+		}
+	}
+}
+
+
+Buffer *DragonflyTopology::RouteSwitch(int index, int destination) const
+{
+	// Position of the current and destination switches
+	Node *node = getSwitch(index);
+	int group = index / group_size;
+	int member = index % group_size;
+	int destination_switch = destination / concentration;
+	int destination_group = destination_switch / group_size;
+	int destination_member = destination_switch % group_size;
+
+	// Destination group
+	if (group == destination_group)
+	{
+		if (member == destination_member)
+			return getOutputBuffer(node, destination %
+					concentration);
+		return getOutputBuffer(node, getLocalPort(member,
+				destination_member), 1);
+	}
+
+	// Global link to the destination group, or local hop to the switch
+	// owning it
+	int link = getGroupLink(group, destination_group);
+	int owner = link / num_global_links;
+	if (member == owner)
+		return getOutputBuffer(node, getGlobalPort(link %
+				num_global_links));
+	return getOutputBuffer(node, getLocalPort(member, owner));
+}
+
+
+}  // namespace net
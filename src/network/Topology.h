@@ -0,0 +1,329 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2014  Amir Kavyan Ziabari (aziabari@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NETWORK_TOPOLOGY_H
+#define NETWORK_TOPOLOGY_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/String.h>
+
+
+namespace net
+{
+
+class Buffer;
+class Link;
+class Network;
+class Node;
+
+
+/// Topology generated from a few parameters given in the network section of
+/// the configuration file, instead of listing every node and link. The
+/// topology creates the nodes and links of the network, and routes packets
+/// algorithmically, with no routing table.
+///
+/// End nodes are named 'n<i>' and created first, so that end node 'n<i>'
+/// has index i in the network. Switches are named 's<i>' and follow the
+/// end nodes.
+///
+/// With adaptive routing, links between switches have one more virtual
+/// channel than the topology needs for its deterministic routes, used as
+/// the adaptive channel. Switches forward packets on the adaptive channel
+/// of any minimal route, or on the deterministic route otherwise. The
+/// deterministic routes are deadlock-free and always available, so they
+/// act as escape paths out of any cyclic dependence between adaptive
+/// channels.
+class Topology
+{
+public:
+
+	/// Topology kinds
+	enum Kind
+	{
+		KindInvalid = 0,
+		KindMesh,
+		KindTorus,
+		KindFatTree,
+		KindDragonfly
+	};
+
+	/// String map for values of type Kind
+	static const misc::StringMap KindMap;
+
+	/// Routing algorithms
+	enum Routing
+	{
+		RoutingInvalid = 0,
+		RoutingDeterministic,
+		RoutingAdaptive
+	};
+
+	/// String map for values of type Routing
+	static const misc::StringMap RoutingMap;
+
+protected:
+
+	// Network where the topology is generated
+	Network *network;
+
+	// Topology kind
+	Kind kind;
+
+	// Routing algorithm
+	Routing routing;
+
+	// Buffer sizes and bandwidth of all nodes and links
+	int input_buffer_size;
+	int output_buffer_size;
+	int bandwidth;
+
+	// Number of end nodes and switches
+	int num_end_nodes = 0;
+	int num_switches = 0;
+
+	// Output links of each node, indexed by node index and port number.
+	// Ports without a link contain nullptr.
+	std::vector<std::vector<Link *>> ports;
+
+	// Create the end nodes and switches of the network, with the given
+	// number of ports in each switch. End nodes have one port.
+	void AddNodes(int num_end_nodes, int num_switches,
+			int num_switch_ports);
+
+	// Return end node or switch by index
+	Node *getEndNode(int index) const;
+	Node *getSwitch(int index) const;
+
+	// Connect port \a port_a of node \a node_a with port \a port_b of node
+	// \a node_b through a pair of links with the given number of virtual
+	// channels.
+	void Connect(Node *node_a, int port_a, Node *node_b, int port_b,
+			int num_virtual_channels = 1);
+
+	// Return the number of virtual channels of a link between switches
+	// that needs the given number of channels for deterministic routes
+	int getNumVirtualChannels(int num_deterministic_channels) const
+	{
+		return num_deterministic_channels +
+				(routing == RoutingAdaptive ? 1 : 0);
+	}
+
+	// Return the output buffer of \a node for a port and virtual channel
+	Buffer *getOutputBuffer(Node *node, int port,
+			int virtual_channel = 0) const;
+
+	// Return the output buffer of the adaptive virtual channel of a
+	// port of \a node, or nullptr if the port has no adaptive channel
+	Buffer *getAdaptiveBuffer(Node *node, int port) const;
+
+	// Route from a switch to an end node, both given by their index
+	// among switches and end nodes, respectively.
+	virtual Buffer *RouteSwitch(int index, int destination) const = 0;
+
+	// Add the adaptive output buffers of all minimal routes from a switch
+	// to an end node into \a buffers. By default, only the adaptive
+	// channel of the deterministic route is added.
+	virtual void AdaptiveRouteSwitch(int index, int destination,
+			std::vector<Buffer *> &buffers) const;
+
+public:
+
+	/// Constructor
+	Topology(Network *network, Kind kind, Routing routing,
+			int input_buffer_size, int output_buffer_size,
+			int bandwidth);
+
+	/// Destructor
+	virtual ~Topology() { }
+
+	/// Create the topology given in variable 'Topology' of section
+	/// \a section, and generate its nodes and links in \a network.
+	static std::unique_ptr<Topology> Create(Network *network,
+			misc::IniFile *ini_file,
+			const std::string &section,
+			int input_buffer_size,
+			int output_buffer_size,
+			int bandwidth);
+
+	/// Return the topology kind
+	Kind getKind() const { return kind; }
+
+	/// Return whether packets are routed adaptively
+	bool isAdaptive() const { return routing == RoutingAdaptive; }
+
+	/// Return the number of end nodes
+	int getNumEndNodes() const { return num_end_nodes; }
+
+	/// Return the number of switches
+	int getNumSwitches() const { return num_switches; }
+
+	/// Return the output buffer of \a node leading to \a destination,
+	/// or `nullptr` if \a destination is \a node itself or is not an end
+	/// node. Routes are deadlock-free, using virtual channels where the
+	/// topology requires them.
+	Buffer *Route(Node *node, Node *destination) const;
+
+	/// Add into \a buffers the output buffers of \a node on the adaptive
+	/// virtual channel of every minimal route to \a destination. Nothing
+	/// is added with deterministic routing, or where the only route is a
+	/// link to an end node.
+	void getAdaptiveRoutes(Node *node, Node *destination,
+			std::vector<Buffer *> &buffers) const;
+};
+
+
+/// Mesh or torus with any number of dimensions, with one end node attached
+/// to each switch. Switch 's<i>' and end node 'n<i>' have coordinates given
+/// by the digits of i, with the first dimension varying fastest. Packets
+/// are routed in dimension order. In a torus, packets take the shortest
+/// direction in each ring and use virtual channel 0 while their path still
+/// crosses the wrap-around link of the ring, and 1 after that. Adaptive
+/// routes include every direction that reduces the distance.
+class MeshTopology : public Topology
+{
+	// Size of each dimension
+	std::vector<int> dimensions;
+
+	// Distance between the indexes of consecutive switches in each
+	// dimension
+	std::vector<int> strides;
+
+	// Port of a switch to the positive or negative direction of a
+	// dimension. Port 0 leads to the end node.
+	static int getPort(int dimension, bool positive)
+	{
+		return 1 + 2 * dimension + (positive ? 0 : 1);
+	}
+
+	Buffer *RouteSwitch(int index, int destination) const override;
+
+	void AdaptiveRouteSwitch(int index, int destination,
+			std::vector<Buffer *> &buffers) const override;
+
+public:
+
+	/// Constructor
+	MeshTopology(Network *network, Kind kind, Routing routing,
+			int input_buffer_size, int output_buffer_size,
+			int bandwidth, const std::vector<int> &dimensions);
+
+	/// Return the size of each dimension
+	const std::vector<int> &getDimensions() const { return dimensions; }
+};
+
+
+/// k-ary n-tree fat tree with k^n end nodes and n levels of k^(n-1)
+/// switches. Switch (l, w) at level l, where level 0 is attached to the
+/// end nodes, is 's<l * k^(n-1) + w>'. It connects its up port j to
+/// switch (l + 1, w') where w' is w with base-k digit l replaced by j.
+/// Packets go up until they reach a common ancestor of the destination,
+/// choosing the up port from the destination digits to spread the
+/// traffic, and then down (up*/down* routing). Adaptive routes go up
+/// through any up port.
+class FatTreeTopology : public Topology
+{
+	// Number of down and up ports in each switch
+	int arity;
+
+	// Number of levels of switches
+	int levels;
+
+	// Number of switches in each level
+	int level_size;
+
+	// Return base-k digit \a digit of \a value
+	int getDigit(int value, int digit) const;
+
+	// Return \a value with base-k digit \a digit replaced by \a replace
+	int setDigit(int value, int digit, int replace) const;
+
+	Buffer *RouteSwitch(int index, int destination) const override;
+
+	void AdaptiveRouteSwitch(int index, int destination,
+			std::vector<Buffer *> &buffers) const override;
+
+public:
+
+	/// Constructor
+	FatTreeTopology(Network *network, Routing routing,
+			int input_buffer_size, int output_buffer_size,
+			int bandwidth, int arity, int levels);
+};
+
+
+/// Dragonfly with a * h + 1 groups of a switches each, where every switch
+/// has p end nodes and h global links, and switches in a group are fully
+/// connected. Every pair of groups is connected by exactly one global
+/// link. Packets take the minimal route: a local hop to the switch owning
+/// the global link to the destination group, the global hop, and a local
+/// hop to the destination switch. Local hops in the destination group use
+/// virtual channel 1 and all others virtual channel 0.
+class DragonflyTopology : public Topology
+{
+	// Switches per group
+	int group_size;
+
+	// End nodes per switch
+	int concentration;
+
+	// Global links per switch
+	int num_global_links;
+
+	// Number of groups
+	int num_groups;
+
+	// Port of a switch to another switch of the same group
+	int getLocalPort(int member, int other_member) const
+	{
+		return concentration + (other_member < member ? other_member :
+				other_member - 1);
+	}
+
+	// Port of a switch for one of its global links
+	int getGlobalPort(int global_link) const
+	{
+		return concentration + group_size - 1 + global_link;
+	}
+
+	// Index of the global link of a group leading to another group,
+	// among the group_size * num_global_links links of the group
+	static int getGroupLink(int group, int other_group)
+	{
+		return other_group < group ? other_group : other_group - 1;
+	}
+
+	Buffer *RouteSwitch(int index, int destination) const override;
+
+public:
+
+	/// Constructor
+	DragonflyTopology(Network *network, Routing routing,
+			int input_buffer_size, int output_buffer_size,
+			int bandwidth, int group_size, int concentration,
+			int num_global_links);
+};
+
+
+}  // namespace net
+
+#endif
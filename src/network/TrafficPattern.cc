@@ -0,0 +1,167 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2014  Amir Kavyan Ziabari (aziabari@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cassert>
+#include <cmath>
+#include <cstdlib>
+
+#include "System.h"
+#include "TrafficPattern.h"
+
+
+namespace net
+{
+
+
+const misc::StringMap TrafficPattern::KindMap =
+{
+	{ "uniform", KindUniform },
+	{ "transpose", KindTranspose },
+	{ "bit-complement", KindBitComplement },
+	{ "hotspot", KindHotspot },
+	{ "tornado", KindTornado },
+	{ "neighbor", KindNeighbor }
+};
+
+
+TrafficPattern::TrafficPattern(Kind kind,
+		int num_nodes,
+		int hotspot,
+		double hotspot_fraction) :
+		kind(kind),
+		num_nodes(num_nodes),
+		hotspot(hotspot),
+		hotspot_fraction(hotspot_fraction)
+{
+	// At least two end nodes are needed to exchange messages
+	if (num_nodes < 2)
+		throw Error(misc::fmt("Traffic pattern '%s' requires at least "
+				"two end nodes (%d found)",
+				KindMap[kind], num_nodes));
+
+	// Grid side, if the number of end nodes is a perfect square
+	int root = (int) std::lround(std::sqrt((double) num_nodes));
+	if (root * root == num_nodes)
+		side = root;
+
+	// Transpose requires a grid
+	if (kind == KindTranspose && !side)
+		throw Error(misc::fmt("Traffic pattern 'transpose' requires a "
+				"square number of end nodes (%d found)",
+				num_nodes));
+
+	// Hotspot parameters
+	if (kind == KindHotspot)
+	{
+		if (hotspot < 0 || hotspot >= num_nodes)
+			throw Error(misc::fmt("Invalid hotspot end node (%d). "
+					"Value must be between 0 and %d",
+					hotspot, num_nodes - 1));
+		if (hotspot_fraction < 0.0 || hotspot_fraction > 1.0)
+			throw Error(misc::fmt("Invalid hotspot fraction (%g). "
+					"Value must be between 0 and 1",
+					hotspot_fraction));
+	}
+}
+
+
+int TrafficPattern::getUniformDestination(int source) const
+{
+	// Pick among the other nodes, skipping the source
+	int destination = random() % (num_nodes - 1);
+	if (destination >= source)
+		destination++;
+	return destination;
+}
+
+
+int TrafficPattern::getDestination(int source) const
+{
+	assert(source >= 0 && source < num_nodes);
+	switch (kind)
+	{
+
+	case KindUniform:
+
+		return getUniformDestination(source);
+
+	case KindTranspose:
+	{
+		// Node (x, y) sends to (y, x)
+		int x = source % side;
+		int y = source / side;
+		return x * side + y;
+	}
+
+	case KindBitComplement:
+
+		// Node i sends to N - 1 - i, which is the bit-wise complement
+		// of i when N is a power of 2.
+		return num_nodes - 1 - source;
+
+	case KindHotspot:
+
+		// The hotspot sends uniformly, other nodes send to the hotspot
+		// with the given probability.
+		if (source != hotspot && (double) random() / RAND_MAX <
+				hotspot_fraction)
+			return hotspot;
+		return getUniformDestination(source);
+
+	case KindTornado:
+	{
+		// Each node sends half way minus one around every dimension
+		if (side)
+		{
+			int offset = (side + 1) / 2 - 1;
+			int x = (source % side + offset) % side;
+			int y = (source / side + offset) % side;
+			return y * side + x;
+		}
+		int offset = (num_nodes + 1) / 2 - 1;
+		return (source + offset) % num_nodes;
+	}
+
+	case KindNeighbor:
+
+		// Each node sends to the next node along the x dimension of the
+		// grid, or along the ring, with wrap-around.
+		if (side)
+			return source - source % side +
+					(source % side + 1) % side;
+		return (source + 1) % num_nodes;
+
+	default:
+
+		throw misc::Panic("Invalid traffic pattern");
+	}
+}
+
+
+bool TrafficPattern::isIdle(int source) const
+{
+	// Random patterns never pick the source
+	if (kind == KindUniform || kind == KindHotspot)
+		return false;
+	return getDestination(source) == source;
+}
+
+
+}  // namespace net
+
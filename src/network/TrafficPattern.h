@@ -0,0 +1,108 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2014  Amir Kavyan Ziabari (aziabari@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef NETWORK_TRAFFIC_PATTERN_H
+#define NETWORK_TRAFFIC_PATTERN_H
+
+#include <lib/cpp/String.h>
+
+
+namespace net
+{
+
+/// Synthetic traffic pattern for stand-alone network simulation. A pattern
+/// maps the index of a source end node to the index of a destination end
+/// node, where end nodes are numbered in the order in which they appear in
+/// the network configuration file.
+///
+/// Patterns based on node coordinates (transpose, tornado, neighbor) lay
+/// out the end nodes on a k x k grid in row-major order when their number
+/// is a perfect square. Tornado and neighbor fall back to a ring of end
+/// nodes otherwise, while transpose requires a square grid.
+class TrafficPattern
+{
+public:
+
+	/// Traffic pattern kinds
+	enum Kind
+	{
+		KindInvalid = 0,
+		KindUniform,
+		KindTranspose,
+		KindBitComplement,
+		KindHotspot,
+		KindTornado,
+		KindNeighbor
+	};
+
+	/// String map for values of type Kind
+	static const misc::StringMap KindMap;
+
+private:
+
+	// Pattern kind
+	Kind kind;
+
+	// Number of end nodes
+	int num_nodes;
+
+	// Side of the grid of end nodes, or 0 if their number is not a
+	// perfect square
+	int side = 0;
+
+	// Destination of a fraction of the messages in the hotspot pattern
+	int hotspot;
+
+	// Fraction of messages sent to the hotspot node
+	double hotspot_fraction;
+
+	// Random destination other than the source
+	int getUniformDestination(int source) const;
+
+public:
+
+	/// Constructor. For the hotspot pattern, a fraction \a hotspot_fraction
+	/// of the messages is sent to end node \a hotspot and the rest are
+	/// distributed uniformly. An exception of type net::Error is thrown if
+	/// the pattern cannot be applied to \a num_nodes end nodes.
+	TrafficPattern(Kind kind,
+			int num_nodes,
+			int hotspot = 0,
+			double hotspot_fraction = 0.2);
+
+	/// Return the pattern kind
+	Kind getKind() const { return kind; }
+
+	/// Return the side of the grid of end nodes, or 0 if end nodes are
+	/// laid out in a ring.
+	int getSide() const { return side; }
+
+	/// Return the index of the end node receiving the next message from
+	/// end node \a source. The source itself is returned if it is idle.
+	int getDestination(int source) const;
+
+	/// Return whether the pattern maps end node \a source to itself,
+	/// in which case the node does not inject any traffic.
+	bool isIdle(int source) const;
+};
+
+
+}  // namespace net
+
+#endif
@@ -35,28 +35,36 @@
  * State checkpoint
  */
 
+/* Interval between checkpoints for traces without a block index. Indexed
+ * traces have one checkpoint at the beginning of each block. */
 #define VI_STATE_CHECKPOINT_INTERVAL  1000
 #define VI_STATE_PROGRESS_INTERVAL  100000
 
 struct vi_state_checkpoint_t
 {
+	/* Cycle of the trace line where the checkpoint was taken. The state
+	 * does not include this cycle yet. */
 	long long cycle;
 
-	/* Position in files */
-	long int unzipped_trace_file_offset;
+	/* Position of the cycle trace line in the trace file */
+	int trace_block;
+	long int trace_offset;
+
+	/* Position in checkpoint file */
 	long int checkpoint_file_offset;
 };
 
 
 struct vi_state_checkpoint_t *vi_state_checkpoint_create(long long cycle,
-	long int unzipped_trace_file_offset, long int checkpoint_file_offset)
+	int trace_block, long int trace_offset, long int checkpoint_file_offset)
 {
 	struct vi_state_checkpoint_t *checkpoint;
 
 	/* Initialize */
 	checkpoint = xcalloc(1, sizeof(struct vi_state_checkpoint_t));
 	checkpoint->cycle = cycle;
-	checkpoint->unzipped_trace_file_offset = unzipped_trace_file_offset;
+	checkpoint->trace_block = trace_block;
+	checkpoint->trace_offset = trace_offset;
 	checkpoint->checkpoint_file_offset = checkpoint_file_offset;
 	
 	/* Return */
@@ -157,9 +165,14 @@ void vi_state_category_free(struct vi_state_category_t *category)
 
 struct vi_state_t
 {
-	/* Uncompressed trace file */
-	char *unzipped_trace_file_name;
-	FILE *unzipped_trace_file;
+	/* Trace file name */
+	char *trace_file_name;
+
+	/* Trace file read to update the state in 'vi_state_go_to_cycle' */
+	struct vi_trace_t *trace_file;
+
+	/* Trace file read to enumerate body trace lines */
+	struct vi_trace_t *body_trace_file;
 
 	/* Checkpoint file */
 	char *checkpoint_file_name;
@@ -180,12 +193,15 @@ struct vi_state_t
 	struct hash_table_t *command_table;
 
 	/* Enumeration of header trace lines */
+	struct vi_trace_t *header_trace_file;
 	struct vi_trace_line_t *header_trace_line;
-	long int header_trace_line_offset;
 
 	/* Enumeration of body trace lines */
 	struct vi_trace_line_t *body_trace_line;
-	long int body_trace_line_offset;
+
+	/* Cycle trace line read past the current cycle in 'trace_file', to
+	 * be processed first when moving forward */
+	struct vi_trace_line_t *next_trace_line;
 };
 
 
@@ -205,8 +221,16 @@ static void vi_state_read_checkpoint(int index)
 
 	/* Set file positions */
 	fseek(vi_state->checkpoint_file, checkpoint->checkpoint_file_offset, SEEK_SET);
-	fseek(vi_state->unzipped_trace_file, checkpoint->unzipped_trace_file_offset, SEEK_SET);
-	vi_state->cycle = checkpoint->cycle;
+	vi_trace_seek(vi_state->trace_file, checkpoint->trace_block,
+		checkpoint->trace_offset);
+	if (vi_state->next_trace_line)
+	{
+		vi_trace_line_free(vi_state->next_trace_line);
+		vi_state->next_trace_line = NULL;
+	}
+
+	/* The checkpoint state does not include its cycle yet */
+	vi_state->cycle = checkpoint->cycle - 1;
 
 	/* Read checkpoint for every category */
 	LIST_FOR_EACH(vi_state->category_list, i)
@@ -218,6 +242,32 @@ static void vi_state_read_checkpoint(int index)
 }
 
 
+/* Return the index of the last checkpoint taken at or before 'cycle', or
+ * the first checkpoint if there is none. */
+static int vi_state_find_checkpoint(long long cycle)
+{
+	struct vi_state_checkpoint_t *checkpoint;
+
+	int low;
+	int high;
+	int mid;
+
+	/* Binary search */
+	low = 0;
+	high = list_count(vi_state->checkpoint_list) - 1;
+	while (low < high)
+	{
+		mid = (low + high + 1) / 2;
+		checkpoint = list_get(vi_state->checkpoint_list, mid);
+		if (checkpoint->cycle <= cycle)
+			low = mid;
+		else
+			high = mid - 1;
+	}
+	return low;
+}
+
+
 static void vi_state_write_checkpoint(void)
 {
 	struct vi_state_category_t *category;
@@ -235,19 +285,21 @@ static void vi_state_write_checkpoint(void)
 
 void vi_state_init(const char *trace_file_name)
 {
-	struct vi_trace_t *trace_file;
 	struct vi_trace_line_t *trace_line;
 
-	int num_trace_lines;
+	long long num_trace_lines;
+
+	int num_blocks;
 
 	char buf[MAX_STRING_SIZE];
 
 	/* Create */
 	vi_state = xcalloc(1, sizeof(struct vi_state_t));
-	
-	/* Create uncompressed trace file */
-	vi_state->unzipped_trace_file = file_create_temp(buf, sizeof buf);
-	vi_state->unzipped_trace_file_name = xstrdup(buf);
+	vi_state->trace_file_name = xstrdup(trace_file_name);
+
+	/* Open trace file */
+	vi_state->trace_file = vi_trace_create(trace_file_name);
+	vi_state->body_trace_file = vi_trace_create(trace_file_name);
 
 	/* Create checkpoint file */
 	vi_state->checkpoint_file = file_create_temp(buf, sizeof buf);
@@ -258,13 +310,15 @@ void vi_state_init(const char *trace_file_name)
 	vi_state->category_list = list_create();
 	vi_state->command_table = hash_table_create(0, FALSE);
 
-	/* Unpack trace */
+	/* Find the number of cycles. In an indexed trace, only the last
+	 * block needs to be read. */
+	num_blocks = vi_trace_get_num_blocks(vi_state->trace_file);
+	if (num_blocks)
+		vi_trace_seek(vi_state->trace_file, num_blocks - 1, 0);
 	num_trace_lines = 0;
-	trace_file = vi_trace_create(trace_file_name);
-	while ((trace_line = vi_trace_line_create_from_trace(trace_file)))
+	while ((trace_line = vi_trace_line_create_from_trace(vi_state->trace_file)))
 	{
-		/* Copy trace */
-		vi_trace_line_dump(trace_line, vi_state->unzipped_trace_file);
+		/* Cycle */
 		if (!strcmp(vi_trace_line_get_command(trace_line), "c"))
 			vi_state->num_cycles = vi_trace_line_get_symbol_long_long(trace_line, "clk");
 		vi_trace_line_free(trace_line);
@@ -273,16 +327,14 @@ void vi_state_init(const char *trace_file_name)
 		num_trace_lines++;
 		if (num_trace_lines % VI_STATE_PROGRESS_INTERVAL == 1)
 		{
-			printf("Uncompressing trace (%.1fMB, %lld cycles)   \r",
-				ftell(vi_state->unzipped_trace_file) / 1.048e6, vi_state->num_cycles);
+			printf("Reading trace (%lld cycles)   \r", vi_state->num_cycles);
 			fflush(stdout);
 		}
 	}
-	vi_trace_free(trace_file);
 
 	/* Final progress */
-	printf("Uncompressing trace (%.1fMB, %lld cycles)   \n",
-		ftell(vi_state->unzipped_trace_file) / 1.048e6, vi_state->num_cycles);
+	printf("Reading trace (%lld cycles, %d blocks)   \n",
+		vi_state->num_cycles, num_blocks);
 	fflush(stdout);
 }
 
@@ -297,9 +349,9 @@ void vi_state_done(void)
 
 	int i;
 
-	/* Close and delete uncompressed trace file */
-	fclose(vi_state->unzipped_trace_file);
-	unlink(vi_state->unzipped_trace_file_name);
+	/* Close trace files */
+	vi_trace_free(vi_state->trace_file);
+	vi_trace_free(vi_state->body_trace_file);
 
 	/* Close and detele checkpoint file */
 	fclose(vi_state->checkpoint_file);
@@ -329,13 +381,19 @@ void vi_state_done(void)
 	/* Free current header trace line if any */
 	if (vi_state->header_trace_line)
 		vi_trace_line_free(vi_state->header_trace_line);
+	if (vi_state->header_trace_file)
+		vi_trace_free(vi_state->header_trace_file);
 
 	/* Free current body trace line if any */
 	if (vi_state->body_trace_line)
 		vi_trace_line_free(vi_state->body_trace_line);
 
+	/* Free cycle trace line read ahead if any */
+	if (vi_state->next_trace_line)
+		vi_trace_line_free(vi_state->next_trace_line);
+
 	/* Free */
-	free(vi_state->unzipped_trace_file_name);
+	free(vi_state->trace_file_name);
 	free(vi_state->checkpoint_file_name);
 	free(vi_state);
 }
@@ -356,24 +414,25 @@ long long vi_state_get_current_cycle(void)
 void vi_state_create_checkpoints(void)
 {
 	struct vi_trace_line_t *trace_line;
+	struct vi_trace_t *trace_file;
 
 	long long last_checkpoint_cycle;
-	long unzipped_trace_file_size;
 
 	int num_trace_lines;
-
-	/* Get unzipped trace file size */
-	fseek(vi_state->unzipped_trace_file, 0, SEEK_END);
-	unzipped_trace_file_size = ftell(vi_state->unzipped_trace_file);
+	int num_blocks;
+	int block;
 
 	/* Initialize */
+	trace_file = vi_state->trace_file;
+	num_blocks = vi_trace_get_num_blocks(trace_file);
 	last_checkpoint_cycle = -VI_STATE_CHECKPOINT_INTERVAL;
-	fseek(vi_state->unzipped_trace_file, 0, SEEK_SET);
+	block = 0;
+	vi_trace_seek(trace_file, 0, 0);
 
-	/* Parse uncompressed trace file */
+	/* Parse trace file */
 	num_trace_lines = 0;
 	vi_state->cycle = 0;
-	while ((trace_line = vi_trace_line_create_from_file(vi_state->unzipped_trace_file)))
+	while ((trace_line = vi_trace_line_create_from_trace(trace_file)))
 	{
 		struct vi_state_checkpoint_t *checkpoint;
 		struct vi_state_command_t *state_command;
@@ -383,15 +442,27 @@ void vi_state_create_checkpoints(void)
 		/* Get command */
 		command = vi_trace_line_get_command(trace_line);
 
-		/* New cycle command */
+		/* New cycle command. In an indexed trace, a checkpoint is taken
+		 * at the cycle line starting each block. Otherwise, checkpoints
+		 * are taken at regular cycle intervals. */
 		if (!strcasecmp(command, "c"))
 		{
 			vi_state->cycle = atoll(vi_trace_line_get_symbol(trace_line, "clk"));
-			while (vi_state->cycle >= last_checkpoint_cycle + VI_STATE_CHECKPOINT_INTERVAL)
+			while (block < num_blocks && vi_trace_get_block_cycle(trace_file, block) < 0)
+				block++;
+			if (block < num_blocks && vi_trace_get_block_cycle(trace_file, block) == vi_state->cycle)
+			{
+				checkpoint = vi_state_checkpoint_create(vi_state->cycle,
+					block, 0, ftell(vi_state->checkpoint_file));
+				list_add(vi_state->checkpoint_list, checkpoint);
+				vi_state_write_checkpoint();
+				block++;
+			}
+			else if (!num_blocks && vi_state->cycle >= last_checkpoint_cycle + VI_STATE_CHECKPOINT_INTERVAL)
 			{
-				last_checkpoint_cycle += VI_STATE_CHECKPOINT_INTERVAL;
-				checkpoint = vi_state_checkpoint_create(last_checkpoint_cycle,
-					vi_trace_line_get_offset(trace_line),
+				last_checkpoint_cycle = vi_state->cycle - vi_state->cycle % VI_STATE_CHECKPOINT_INTERVAL;
+				checkpoint = vi_state_checkpoint_create(vi_state->cycle,
+					0, vi_trace_line_get_offset(trace_line),
 					ftell(vi_state->checkpoint_file));
 				list_add(vi_state->checkpoint_list, checkpoint);
 				vi_state_write_checkpoint();
@@ -399,7 +470,7 @@ void vi_state_create_checkpoints(void)
 		}
 
 		/* Process trace line if it is not a header  */
-		else if (last_checkpoint_cycle >= 0)
+		else if (list_count(vi_state->checkpoint_list))
 		{
 			state_command = hash_table_get(vi_state->command_table, command);
 			if (!state_command)
@@ -413,9 +484,9 @@ void vi_state_create_checkpoints(void)
 		{
 			printf("Creating checkpoints (%.1fMB, %.1f%%)   \r",
 				ftell(vi_state->checkpoint_file) / 1.048e6,
-				unzipped_trace_file_size ?
-				(double) ftell(vi_state->unzipped_trace_file) * 100.0 /
-				unzipped_trace_file_size : 0.0);
+				vi_state->num_cycles ?
+				(double) vi_state->cycle * 100.0 /
+				vi_state->num_cycles : 0.0);
 			fflush(stdout);
 		}
 
@@ -464,7 +535,10 @@ void vi_state_new_command(char *command_name,
 
 struct vi_trace_line_t *vi_state_header_first(void)
 {
-	vi_state->header_trace_line_offset = 0;
+	/* Restart enumeration */
+	if (vi_state->header_trace_file)
+		vi_trace_free(vi_state->header_trace_file);
+	vi_state->header_trace_file = vi_trace_create(vi_state->trace_file_name);
 	return vi_state_header_next();
 }
 
@@ -481,41 +555,28 @@ struct vi_trace_line_t *vi_state_header_next(void)
 	}
 
 	/* No more header trace lines */
-	if (vi_state->header_trace_line_offset < 0)
+	if (!vi_state->header_trace_file)
 		return NULL;
 
-	/* Read trace line */
-	fseek(vi_state->unzipped_trace_file, vi_state->header_trace_line_offset, SEEK_SET);
-	trace_line = vi_trace_line_create_from_file(vi_state->unzipped_trace_file);
-	if (!trace_line)
+	/* Read trace line. The header is over at the first cycle. */
+	trace_line = vi_trace_line_create_from_trace(vi_state->header_trace_file);
+	if (!trace_line || !strcmp(vi_trace_line_get_command(trace_line), "c"))
 	{
-		vi_state->header_trace_line_offset = -1;
-		return NULL;
-	}
-
-	/* Header is over */
-	if (!strcmp(vi_trace_line_get_command(trace_line), "c"))
-	{
-		vi_trace_line_free(trace_line);
-		vi_state->header_trace_line_offset = -1;
+		if (trace_line)
+			vi_trace_line_free(trace_line);
+		vi_trace_free(vi_state->header_trace_file);
+		vi_state->header_trace_file = NULL;
 		return NULL;
 	}
 
 	/* Save trace line and return */
 	vi_state->header_trace_line = trace_line;
-	vi_state->header_trace_line_offset = ftell(vi_state->unzipped_trace_file);
 	return trace_line;
 }
 
 
 struct vi_trace_line_t *vi_state_trace_line_first(long long cycle)
 {
-	long int trace_file_offset;
-
-	int checkpoint_index;
-
-	long long checkpoint_cycle;
-
 	struct vi_state_checkpoint_t *checkpoint;
 
 	/* Release previous body trace line if any */
@@ -529,28 +590,23 @@ struct vi_trace_line_t *vi_state_trace_line_first(long long cycle)
 	if (cycle > vi_state->num_cycles)
 		return NULL;
 
-	/* Store current position in trace file */
-	trace_file_offset = ftell(vi_state->unzipped_trace_file);
-
 	/* Get closest checkpoint */
-	checkpoint_index = cycle / VI_STATE_CHECKPOINT_INTERVAL;
-	checkpoint_cycle = (long long) checkpoint_index * VI_STATE_CHECKPOINT_INTERVAL;
-	checkpoint = list_get(vi_state->checkpoint_list, checkpoint_index);
+	checkpoint = list_get(vi_state->checkpoint_list,
+		vi_state_find_checkpoint(cycle));
 	if (!checkpoint)
 		panic("%s: invalid checkpoint index", __FUNCTION__);
 
 	/* Set position in trace file */
-	fseek(vi_state->unzipped_trace_file, checkpoint->unzipped_trace_file_offset, SEEK_SET);
-	vi_state->body_trace_line_offset = checkpoint->unzipped_trace_file_offset;
+	vi_trace_seek(vi_state->body_trace_file, checkpoint->trace_block,
+		checkpoint->trace_offset);
 	for (;;)
 	{
 		/* Read trace line */
-		vi_state->body_trace_line = vi_trace_line_create_from_file(vi_state->unzipped_trace_file);
-		vi_state->body_trace_line_offset = checkpoint->unzipped_trace_file_offset;
-		if (!vi_state->body_trace_line || checkpoint_cycle == cycle)
+		vi_state->body_trace_line = vi_trace_line_create_from_trace(vi_state->body_trace_file);
+		if (!vi_state->body_trace_line)
 			break;
 
-		/* Check if target cycle is exceeded */
+		/* Check if target cycle is reached */
 		if (!strcmp(vi_trace_line_get_command(vi_state->body_trace_line), "c") &&
 			vi_trace_line_get_symbol_long_long(vi_state->body_trace_line, "clk") >= cycle)
 			break;
@@ -560,19 +616,13 @@ struct vi_trace_line_t *vi_state_trace_line_first(long long cycle)
 		vi_state->body_trace_line = NULL;
 	}
 
-	/* Return to original position in trace file */
-	fseek(vi_state->unzipped_trace_file, trace_file_offset, SEEK_SET);
+	/* Return */
 	return vi_state->body_trace_line;
 }
 
 
 struct vi_trace_line_t *vi_state_trace_line_next(void)
 {
-	long long trace_file_offset;
-
-	/* Store current position in trace file */
-	trace_file_offset = ftell(vi_state->unzipped_trace_file);
-
 	/* Release previous body trace line if any */
 	if (vi_state->body_trace_line)
 	{
@@ -581,19 +631,14 @@ struct vi_trace_line_t *vi_state_trace_line_next(void)
 	}
 
 	/* Get next trace line */
-	fseek(vi_state->unzipped_trace_file, vi_state->body_trace_line_offset, SEEK_SET);
-	vi_state->body_trace_line = vi_trace_line_create_from_file(vi_state->unzipped_trace_file);
-	vi_state->body_trace_line_offset = ftell(vi_state->unzipped_trace_file);
-
-	/* Return to original position in trace file */
-	fseek(vi_state->unzipped_trace_file, trace_file_offset, SEEK_SET);
+	vi_state->body_trace_line = vi_trace_line_create_from_trace(vi_state->body_trace_file);
 	return vi_state->body_trace_line;
 }
 
 
 void vi_state_go_to_cycle(long long cycle)
 {
-	long long checkpoint_cycle;
+	struct vi_state_checkpoint_t *checkpoint;
 	int checkpoint_index;
 
 	/* If we are already in this cycle, do nothing */
@@ -601,9 +646,9 @@ void vi_state_go_to_cycle(long long cycle)
 		return;
 
 	/* Load a checkpoint */
-	checkpoint_index = cycle / VI_STATE_CHECKPOINT_INTERVAL;
-	checkpoint_cycle = (long long) checkpoint_index * VI_STATE_CHECKPOINT_INTERVAL;
-	if (cycle < vi_state->cycle || checkpoint_cycle > vi_state->cycle)
+	checkpoint_index = vi_state_find_checkpoint(cycle);
+	checkpoint = list_get(vi_state->checkpoint_list, checkpoint_index);
+	if (cycle < vi_state->cycle || checkpoint->cycle - 1 > vi_state->cycle)
 		vi_state_read_checkpoint(checkpoint_index);
 
 	/* Go to cycle */
@@ -611,12 +656,13 @@ void vi_state_go_to_cycle(long long cycle)
 	{
 		struct vi_trace_line_t *trace_line;
 		struct vi_state_command_t *state_command;
-		long int unzipped_trace_file_pos;
 		char *command;
 
 		/* Read a trace line */
-		unzipped_trace_file_pos = ftell(vi_state->unzipped_trace_file);
-		trace_line = vi_trace_line_create_from_file(vi_state->unzipped_trace_file);
+		trace_line = vi_state->next_trace_line;
+		vi_state->next_trace_line = NULL;
+		if (!trace_line)
+			trace_line = vi_trace_line_create_from_trace(vi_state->trace_file);
 		if (!trace_line)
 			break;
 
@@ -629,11 +675,11 @@ void vi_state_go_to_cycle(long long cycle)
 			/* Get new cycle number */
 			new_cycle = vi_trace_line_get_symbol_long_long(trace_line, "clk");
 
-			/* If we passed the target cycle, done */
+			/* If we passed the target cycle, done. Keep the trace
+			 * line for the next call. */
 			if (new_cycle > cycle)
 			{
-				fseek(vi_state->unzipped_trace_file, unzipped_trace_file_pos, SEEK_SET);
-				vi_trace_line_free(trace_line);
+				vi_state->next_trace_line = trace_line;
 				break;
 			}
 			else
@@ -18,7 +18,9 @@
  */
 
 #include <ctype.h>
+#include <fcntl.h>
 #include <gtk/gtk.h>
+#include <unistd.h>
 #include <zlib.h>
 
 #include <lib/mhandle/mhandle.h>
@@ -30,14 +32,34 @@
 
 
 
+struct vi_trace_block_t
+{
+	/* First cycle in the block, or -1 for the header block */
+	long long cycle;
+
+	/* Offset of the compressed block in the trace file */
+	long int offset;
+};
+
+
 struct vi_trace_t
 {
 	char *name;
 	gzFile f;
 
+	/* Block index of the trace file, or no blocks if the trace has no
+	 * index (see 'esim::TraceSystem'). */
+	struct vi_trace_block_t *blocks;
+	int num_blocks;
+
 	/* Last line number read from zip file with a call to
 	 * 'vi_trace_line_create_from_trace'. */
 	int line_num;
+
+	/* Strings defined in binary records (see 'esim::TraceEncoder') */
+	char **strings;
+	int num_strings;
+	int strings_size;
 };
 
 
@@ -63,6 +85,188 @@ struct vi_trace_line_t
 
 #define isidchar(c) (isalnum((c)) || (c) == '.' || (c) == '_' || (c) =='-')
 
+/* Marker bytes of binary records, string definitions, and string table
+ * resets */
+#define VI_TRACE_RECORD_MARKER  0x01
+#define VI_TRACE_STRING_MARKER  0x02
+#define VI_TRACE_RESET_MARKER  0x03
+
+
+/* Discard all strings defined in binary records */
+static void vi_trace_reset_strings(struct vi_trace_t *trace)
+{
+	int i;
+
+	for (i = 0; i < trace->num_strings; i++)
+		free(trace->strings[i]);
+	trace->num_strings = 0;
+}
+
+
+/* Read an unsigned LEB128 integer from a binary trace record */
+static unsigned long long vi_trace_read_var_int(struct vi_trace_t *trace)
+{
+	unsigned long long value = 0;
+	int shift = 0;
+	int c;
+
+	do
+	{
+		c = gzgetc(trace->f);
+		if (c == -1 || shift > 63)
+			fatal("%s: line %d: invalid binary record",
+				trace->name, trace->line_num);
+		value |= (unsigned long long) (c & 0x7f) << shift;
+		shift += 7;
+	} while (c & 0x80);
+	return value;
+}
+
+
+/* Read 'size' characters of a binary record into 'buf' */
+static void vi_trace_read_chars(struct vi_trace_t *trace, char *buf, int size)
+{
+	if (size && gzread(trace->f, buf, size) != size)
+		fatal("%s: line %d: invalid binary record",
+			trace->name, trace->line_num);
+}
+
+
+/* Read a string definition following its marker byte */
+static void vi_trace_read_string(struct vi_trace_t *trace)
+{
+	int id;
+	int length;
+
+	/* Identifiers are assigned in order */
+	id = vi_trace_read_var_int(trace);
+	length = vi_trace_read_var_int(trace);
+	if (id != trace->num_strings || length >= 4096)
+		fatal("%s: line %d: invalid string definition",
+			trace->name, trace->line_num);
+
+	/* Grow table */
+	if (trace->num_strings == trace->strings_size)
+	{
+		trace->strings_size = trace->strings_size ? trace->strings_size * 2 : 64;
+		trace->strings = xrealloc(trace->strings, trace->strings_size * sizeof(char *));
+	}
+
+	/* Add string */
+	trace->strings[id] = xcalloc(1, length + 1);
+	vi_trace_read_chars(trace, trace->strings[id], length);
+	trace->num_strings++;
+}
+
+
+/* Return a string defined in a binary record */
+static char *vi_trace_get_string(struct vi_trace_t *trace, unsigned long long id)
+{
+	if (id >= (unsigned long long) trace->num_strings)
+		fatal("%s: line %d: undefined string in binary record",
+			trace->name, trace->line_num);
+	return trace->strings[id];
+}
+
+
+/* Append text to a decoded line, checking for overflow */
+static void vi_trace_append(struct vi_trace_t *trace, char *buf, int *length,
+	int buf_size, char *text, int text_length)
+{
+	if (*length + text_length >= buf_size)
+		fatal("%s: buffer too small", __FUNCTION__);
+	memcpy(buf + *length, text, text_length);
+	*length += text_length;
+	buf[*length] = '\0';
+}
+
+
+/* Decode a binary record following its marker byte into the equivalent
+ * plain-text line. */
+static void vi_trace_read_record(struct vi_trace_t *trace, char *buf, int buf_size)
+{
+	char text[4096];
+	char *str;
+
+	unsigned long long value;
+
+	int num_fields;
+	int length;
+	int size;
+	int type;
+	int i;
+
+	/* Command */
+	length = 0;
+	buf[0] = '\0';
+	str = vi_trace_get_string(trace, vi_trace_read_var_int(trace));
+	vi_trace_append(trace, buf, &length, buf_size, str, strlen(str));
+
+	/* Fields */
+	num_fields = vi_trace_read_var_int(trace);
+	for (i = 0; i < num_fields; i++)
+	{
+		/* Key */
+		str = vi_trace_get_string(trace, vi_trace_read_var_int(trace));
+		vi_trace_append(trace, buf, &length, buf_size, " ", 1);
+		vi_trace_append(trace, buf, &length, buf_size, str, strlen(str));
+		vi_trace_append(trace, buf, &length, buf_size, "=", 1);
+
+		/* Value */
+		type = gzgetc(trace->f);
+		switch (type)
+		{
+
+		case 'd':
+
+			value = vi_trace_read_var_int(trace);
+			size = snprintf(text, sizeof text, "%lld",
+				(long long) (value >> 1) ^ -(long long) (value & 1));
+			break;
+
+		case 'x':
+
+			value = vi_trace_read_var_int(trace);
+			size = snprintf(text, sizeof text, "0x%llx", value);
+			break;
+
+		case 'q':
+
+			str = vi_trace_get_string(trace, vi_trace_read_var_int(trace));
+			size = snprintf(text, sizeof text, "\"%s\"", str);
+			break;
+
+		case 'Q':
+		case 'r':
+
+			size = vi_trace_read_var_int(trace);
+			if (size >= (int) sizeof text - 2)
+				fatal("%s: buffer too small", __FUNCTION__);
+			if (type == 'Q')
+			{
+				text[0] = '"';
+				vi_trace_read_chars(trace, text + 1, size);
+				text[size + 1] = '"';
+				size += 2;
+			}
+			else
+			{
+				vi_trace_read_chars(trace, text, size);
+			}
+			break;
+
+		default:
+
+			fatal("%s: line %d: invalid binary record",
+				trace->name, trace->line_num);
+		}
+		vi_trace_append(trace, buf, &length, buf_size, text, size);
+	}
+
+	/* End of line */
+	vi_trace_append(trace, buf, &length, buf_size, "\n", 1);
+}
+
 
 /*
 Read trace line from a file with the following format.
@@ -149,9 +353,35 @@ struct vi_trace_line_t *vi_trace_line_create_from_trace(struct vi_trace_t *trace
 	char buf[4096];
 	char *buf_ptr;
 
-	/* Read line from trace file */
-	offset = gztell(trace->f);
-	buf_ptr = gzgets(trace->f, buf, sizeof buf);
+	int c;
+
+	/* Read line from trace file. Binary records are decoded into their
+	 * plain-text form, after reading any string definitions before them. */
+	while (1)
+	{
+		offset = gztell(trace->f);
+		c = gzgetc(trace->f);
+		if (c == VI_TRACE_STRING_MARKER)
+		{
+			vi_trace_read_string(trace);
+			continue;
+		}
+		if (c == VI_TRACE_RESET_MARKER)
+		{
+			vi_trace_reset_strings(trace);
+			continue;
+		}
+		if (c == VI_TRACE_RECORD_MARKER)
+		{
+			vi_trace_read_record(trace, buf, sizeof buf);
+			buf_ptr = buf;
+			break;
+		}
+		if (c != -1)
+			gzungetc(c, trace->f);
+		buf_ptr = gzgets(trace->f, buf, sizeof buf);
+		break;
+	}
 
 	/* Empty line */
 	if (!buf_ptr)
@@ -358,6 +588,74 @@ unsigned int vi_trace_line_get_symbol_hex(struct vi_trace_line_t *line, char *sy
  */
 
 
+/* Read a 64-bit little-endian integer */
+static long long vi_trace_read_int64(unsigned char *buf)
+{
+	unsigned long long value;
+	int i;
+
+	value = 0;
+	for (i = 0; i < 8; i++)
+		value |= (unsigned long long) buf[i] << (i * 8);
+	return value;
+}
+
+
+/* Read the block index at the end of the trace file, if present */
+static void vi_trace_read_index(struct vi_trace_t *trace)
+{
+	FILE *f;
+
+	unsigned char buf[24];
+	unsigned char *entries;
+
+	long long num_blocks;
+	long long index_offset;
+	long int size;
+
+	int i;
+
+	/* Read index trailer */
+	f = fopen(trace->name, "rb");
+	if (!f)
+		fatal("%s: cannot open trace file", trace->name);
+	fseek(f, 0, SEEK_END);
+	size = ftell(f);
+	if (size < 24 || fseek(f, size - 24, SEEK_SET) ||
+			fread(buf, 1, 24, f) != 24 ||
+			memcmp(buf + 16, "M2STRIDX", 8))
+	{
+		fclose(f);
+		return;
+	}
+
+	/* Check index */
+	num_blocks = vi_trace_read_int64(buf);
+	index_offset = vi_trace_read_int64(buf + 8);
+	if (num_blocks < 0 || index_offset < 0 ||
+			index_offset + 8 + num_blocks * 16 + 24 != size)
+		fatal("%s: invalid trace index", trace->name);
+
+	/* Read entries */
+	entries = xmalloc(num_blocks * 16 + 8);
+	fseek(f, index_offset, SEEK_SET);
+	if ((long long) fread(entries, 1, num_blocks * 16 + 8, f) != num_blocks * 16 + 8 ||
+			memcmp(entries, "M2STRIDX", 8))
+		fatal("%s: invalid trace index", trace->name);
+	trace->num_blocks = num_blocks;
+	trace->blocks = xcalloc(num_blocks + 1, sizeof(struct vi_trace_block_t));
+	for (i = 0; i < num_blocks; i++)
+	{
+		trace->blocks[i].cycle = vi_trace_read_int64(entries + 8 + i * 16);
+		trace->blocks[i].offset = vi_trace_read_int64(entries + 16 + i * 16);
+	}
+
+	/* Free */
+	free(entries);
+	fclose(f);
+}
+
+
 struct vi_trace_t *vi_trace_create(const char *file_name)
 {
 	struct vi_trace_t *trace;
@@ -366,6 +664,9 @@ struct vi_trace_t *vi_trace_create(const char *file_name)
 	trace = xcalloc(1, sizeof(struct vi_trace_t));
 	trace->name = xstrdup(file_name);
 
+	/* Read block index */
+	vi_trace_read_index(trace);
+
 	/* Open */
 	trace->f = gzopen(file_name, "r");
 	if (!trace->f)
@@ -378,8 +679,56 @@ struct vi_trace_t *vi_trace_create(const char *file_name)
 
 void vi_trace_free(struct vi_trace_t *trace)
 {
+	vi_trace_reset_strings(trace);
+	free(trace->strings);
+	free(trace->blocks);
 	gzclose(trace->f);
 	free(trace->name);
 	free(trace);
 }
 
+
+int vi_trace_get_num_blocks(struct vi_trace_t *trace)
+{
+	return trace->num_blocks;
+}
+
+
+long long vi_trace_get_block_cycle(struct vi_trace_t *trace, int block)
+{
+	if (block < 0 || block >= trace->num_blocks)
+		panic("%s: invalid block", __FUNCTION__);
+	return trace->blocks[block].cycle;
+}
+
+
+void vi_trace_seek(struct vi_trace_t *trace, int block, long int offset)
+{
+	int fd;
+
+	/* Trace without index. Only the offset in the uncompressed trace is
+	 * used, and strings defined in binary records are kept, since their
+	 * identifiers are unique in the whole trace. */
+	if (!trace->num_blocks)
+	{
+		if (gzseek(trace->f, offset, SEEK_SET) != offset)
+			fatal("%s: cannot seek trace file", trace->name);
+		return;
+	}
+
+	/* Open a new gzip stream starting at the block. Offsets are given
+	 * relative to the beginning of the block, which does not depend on
+	 * strings defined in other blocks. */
+	if (block < 0 || block >= trace->num_blocks)
+		panic("%s: invalid block", __FUNCTION__);
+	gzclose(trace->f);
+	fd = open(trace->name, O_RDONLY);
+	if (fd < 0 || lseek(fd, trace->blocks[block].offset, SEEK_SET) < 0)
+		fatal("%s: cannot seek trace file", trace->name);
+	trace->f = gzdopen(fd, "r");
+	if (!trace->f)
+		fatal("%s: cannot seek trace file", trace->name);
+	vi_trace_reset_strings(trace);
+	if (offset && gzseek(trace->f, offset, SEEK_SET) != offset)
+		fatal("%s: cannot seek trace file", trace->name);
+}
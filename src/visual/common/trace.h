@@ -28,6 +28,14 @@ struct vi_trace_t;
 struct vi_trace_t *vi_trace_create(const char *file_name);
 void vi_trace_free(struct vi_trace_t *trace);
 
+/* Blocks of an indexed trace file. A trace without index has no blocks. */
+int vi_trace_get_num_blocks(struct vi_trace_t *trace);
+long long vi_trace_get_block_cycle(struct vi_trace_t *trace, int block);
+
+/* Continue reading the trace at 'offset' bytes from the beginning of
+ * 'block', or from the beginning of the trace if it has no index. */
+void vi_trace_seek(struct vi_trace_t *trace, int block, long int offset);
+
 
 struct vi_trace_line_t;
 
@@ -0,0 +1,89 @@
+#!/bin/sh
+#
+# End-to-end simulator throughput, run with 'make bench' after the
+# microbenchmarks. Each sample configuration is simulated with option
+# '--profile', and the statistics summary is turned into lines with the
+# same format as the microbenchmarks:
+#
+#	BENCH <name> <rate> <unit>/s <latency> ns/<unit>
+#
+# A configuration that cannot run in the host prints 'BENCH <name> FAILED'.
+#
+# Usage: bench.sh <m2s binary> <samples directory>
+#
+
+if [ $# -ne 2 ]
+then
+	echo "usage: $0 <m2s binary> <samples directory>" >&2
+	exit 1
+fi
+m2s=$(cd "$(dirname "$1")" && pwd)/$(basename "$1")
+samples=$(cd "$2" && pwd)
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# Run a sample in a copy of its directory
+#	$1 - Benchmark name
+#	$2 - Sample directory, relative to the samples directory
+#	$3... - Options for m2s
+run()
+{
+	name=$1
+	dir=$2
+	shift 2
+	rm -rf "$tmp/run"
+	cp -r "$samples/$dir" "$tmp/run"
+	if ! (cd "$tmp/run" && "$m2s" --profile "$@" \
+			> "$tmp/output" 2> "$tmp/summary")
+	then
+		echo "BENCH sample.$name FAILED"
+		return
+	fi
+	awk -v name="sample.$name" '
+		function report(metric, rate, unit)
+		{
+			if (rate > 0)
+				printf("BENCH %s.%s %.0f %s/s %.2f ns/%s\n",
+						name, metric, rate, unit,
+						1.0e9 / rate, unit)
+		}
+		/^\[ / { section = $2 }
+		/^Instructions = / { inst += $3 }
+		/^RealTime = / && section == "Profiler" { time = $3 }
+		/^HostTimePerCycle = / { ns_per_cycle = $3 }
+		/^EventsPerSecond = / { events = $3 }
+		END {
+			if (time > 0)
+				report("instructions", inst / time, "inst")
+			if (ns_per_cycle > 0)
+				report("cycles", 1.0e9 / ns_per_cycle, "cycle")
+			report("events", events, "event")
+		}' "$tmp/summary"
+}
+
+run x86.functional x86/example-1 \
+	--x86-sim functional --x86-config x86-config.ini \
+	--ctx-config ctx-config.ini
+run x86.detailed x86/example-2 \
+	--x86-sim detailed --x86-config x86-config.ini \
+	--ctx-config ctx-config.ini
+run memory.example-1 memory/example-1 \
+	--x86-sim detailed --x86-config x86-config --mem-config mem-config \
+	"$samples/x86/example-2/test-sort"
+run memory.example-2 memory/example-2 \
+	--x86-sim detailed --x86-config x86-config --mem-config mem-config \
+	--net-config net-config "$samples/x86/example-2/test-sort"
+run network.example-1 network/example-1 \
+	--net-sim si-net-l1-l2 --net-config net-si --net-msg-size 72 \
+	--net-injection-rate 0.01 --net-max-cycles 10000
+run network.example-4 network/example-4 \
+	--net-sim net0 --net-config net-mesh --net-msg-size 1 \
+	--net-injection-rate 0.05 --net-max-cycles 10000
+run mips.functional mips \
+	test-sort
+run mips.functional-no-decode-cache mips \
+	--mips-no-decode-cache test-sort
+run arm.functional arm \
+	test-sort
+run arm.functional-no-decode-cache arm \
+	--arm-no-decode-cache test-sort
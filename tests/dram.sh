@@ -0,0 +1,73 @@
+#!/bin/sh
+#
+# End-to-end test of the stand-alone DRAM simulation, run with 'make check'.
+# Requests of a trace are injected with option '--dram-trace', and the
+# report given in '--dram-report' must contain the per-rank refresh and
+# energy statistics and the number of requests of each bank.
+#
+# The m2s binary is given in environment variable M2S.
+#
+
+if [ -z "$M2S" ]
+then
+	echo "usage: M2S=<m2s binary> $0" >&2
+	exit 1
+fi
+m2s=$(cd "$(dirname "$M2S")" && pwd)/$(basename "$M2S")
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+cd "$tmp" || exit 1
+
+# Report a failure
+#	$1 - Message
+fail()
+{
+	echo "FAIL: $1" >&2
+	exit 1
+}
+
+# One controller with one rank of 8 banks, with a refresh every 500 cycles.
+# Consecutive rows map to the same bank, and are spread over all banks by
+# the bank hash.
+cat > dram.ini << EOF
+[ General ]
+Frequency = 800
+BankHash = Xor
+
+[ MemoryController One ]
+NumRanks = 1
+tREFI = 500
+EOF
+
+# One read to each of the first 16 rows, 20 cycles apart
+i=0
+while [ $i -lt 16 ]
+do
+	echo "$((i * 20)) Read $((i * 1024))"
+	i=$((i + 1))
+done > trace
+"$m2s" --dram-sim --dram-config dram.ini --dram-trace trace \
+		--dram-max-cycles 2000 --dram-report report > output 2>&1 ||
+	fail "simulation exited with an error"
+
+# Report contents
+grep -q '^ReadRequests = 16$' report ||
+	fail "wrong number of read requests"
+grep -q '^Reads = 16$' report ||
+	fail "reads did not complete"
+grep -q '^BankRequests = 2 2 2 2 2 2 2 2$' report ||
+	fail "requests not spread over all banks"
+grep -q '^BankImbalance = 1.00$' report ||
+	fail "wrong bank imbalance"
+grep -q '^BankRefreshes = [1-9]' report ||
+	fail "no refreshes in the report"
+grep -q '^Energy = ' report ||
+	fail "no energy in the report"
+
+# Trace and report require the stand-alone simulation
+if "$m2s" --dram-report report > output 2>&1
+then
+	fail "option '--dram-report' accepted without '--dram-sim'"
+fi
+
+exit 0
@@ -0,0 +1,114 @@
+#!/bin/sh
+#
+# End-to-end test of the stand-alone network simulation with synthetic
+# traffic, run with 'make check'. An end node that cannot send keeps its
+# messages in the source queue given in '--net-source-queue', and must be
+# woken up when the network has space for them. The saturation sweep of
+# option '--net-sweep' must bracket the saturation point between its last
+# unsaturated and its first saturated injection rate.
+#
+# The m2s binary is given in environment variable M2S.
+#
+
+if [ -z "$M2S" ]
+then
+	echo "usage: M2S=<m2s binary> $0" >&2
+	exit 1
+fi
+m2s=$(cd "$(dirname "$M2S")" && pwd)/$(basename "$M2S")
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+cd "$tmp" || exit 1
+
+# Report a failure
+#	$1 - Message
+fail()
+{
+	echo "FAIL: $1" >&2
+	exit 1
+}
+
+# Four end nodes around one switch, with room for one message in each buffer
+cat > net.ini << EOF
+[ Network.net0 ]
+DefaultInputBufferSize = 8
+DefaultOutputBufferSize = 8
+DefaultBandwidth = 8
+EOF
+for i in 0 1 2 3
+do
+	cat >> net.ini << EOF
+[ Network.net0.Node.n$i ]
+Type = EndNode
+[ Network.net0.Link.n$i-s0 ]
+Type = Bidirectional
+Source = n$i
+Dest = s0
+EOF
+done
+cat >> net.ini << EOF
+[ Network.net0.Node.s0 ]
+Type = Switch
+EOF
+
+# Messages delivered with a source queue of the given size
+#	$1 - Source queue size
+transfers()
+{
+	"$m2s" --net-sim net0 --net-config net.ini --net-max-cycles 5000 \
+			--net-msg-size 8 --net-injection-rate 0.5 \
+			--net-source-queue $1 --net-report report > output 2>&1 ||
+		fail "simulation with source queue $1 exited with an error"
+	sed -n 's/^Transfers = //p' net0_report
+}
+
+# Nodes often find their output buffer full at this injection rate. Queued
+# messages are sent when the node is woken up, so more messages are
+# delivered than when they are dropped.
+dropped=$(transfers 0)
+queued=$(transfers 1)
+[ -n "$dropped" ] && [ -n "$queued" ] ||
+	fail "no transfers in the network report"
+[ "$queued" -gt "$dropped" ] ||
+	fail "blocked sources not woken up ($queued transfers, $dropped without source queue)"
+
+# Saturation sweep
+"$m2s" --net-sim net0 --net-config net.ini --net-max-cycles 2000 \
+		--net-msg-size 8 --net-sweep sweep --net-sweep-jobs 2 \
+		--net-sweep-rounds 2 > output 2>&1 ||
+	fail "sweep exited with an error"
+grep -q '^SourceQueue = 64$' sweep ||
+	fail "wrong default source queue in the sweep"
+
+# The saturation rate is the highest unsaturated point, the saturated rate
+# the lowest saturated point, and all points are classified around them
+awk '
+	/^SaturationRate = / { unsaturated = $3 }
+	/^SaturatedRate = / { saturated = $3 }
+	/^Points = / { num_points = $3 }
+	/^InjectionRate = / { rate = $3; points++ }
+	/^Saturated = True$/ {
+		if (rate < saturated) exit 1
+		if (rate == saturated) found_saturated = 1
+	}
+	/^Saturated = False$/ {
+		if (rate > unsaturated && rate < saturated) exit 1
+		if (rate == unsaturated) found_unsaturated = 1
+	}
+	END {
+		if (!(unsaturated < saturated && found_saturated &&
+				found_unsaturated && points == num_points))
+			exit 1
+	}
+' sweep || fail "saturation point not bracketed by the sweep"
+
+# Each point has its own random sequence, seeded from its injection rate, so
+# the report does not depend on the number of workers
+"$m2s" --net-sim net0 --net-config net.ini --net-max-cycles 2000 \
+		--net-msg-size 8 --net-sweep sweep-sequential --net-sweep-jobs 1 \
+		--net-sweep-rounds 2 > output 2>&1 ||
+	fail "sequential sweep exited with an error"
+cmp -s sweep sweep-sequential ||
+	fail "sweep report depends on the number of workers"
+
+exit 0
@@ -0,0 +1,108 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+
+#ifndef TESTS_BENCH_H
+#define TESTS_BENCH_H
+
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <string>
+
+
+/// Harness for the microbenchmarks run with 'make bench'. Each benchmark
+/// prints one line with the following whitespace-separated fields, which
+/// scripts comparing two builds can rely on:
+///
+///	BENCH <name> <rate> <unit>/s <latency> ns/<unit>
+///
+/// The time spent in each measurement can be changed with environment
+/// variable M2S_BENCH_TIME, in seconds (default 0.5).
+namespace bench
+{
+
+// Current host time in nanoseconds
+inline long long getTime()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (long long) ts.tv_sec * 1000000000ll + ts.tv_nsec;
+}
+
+
+/// Run a benchmark and print its result line.
+///
+/// \param name
+///	Benchmark name, in the form '<module>.<operation>'
+///
+/// \param unit
+///	Unit of one operation, such as 'inst' or 'event'
+///
+/// \param function
+///	Function taking a number of operations to perform, and returning
+///	the number of operations actually performed.
+template<typename Function> void Run(const std::string &name,
+		const std::string &unit, Function function)
+{
+	// Time per measurement
+	const char *env = getenv("M2S_BENCH_TIME");
+	double seconds = env ? atof(env) : 0.5;
+	long long min_time = seconds > 0 ? seconds * 1.0e9 : 5.0e8;
+
+	// Grow the number of operations until one run takes a tenth of the
+	// measurement time
+	long long count = 1000;
+	long long time;
+	while (true)
+	{
+		long long start = getTime();
+		function(count);
+		time = getTime() - start;
+		if (time >= min_time / 10)
+			break;
+		count *= 4;
+	}
+
+	// Measure, keeping the best of the runs that fit in the measurement
+	// time
+	double best = 0;
+	long long total = 0;
+	while (total < min_time)
+	{
+		long long start = getTime();
+		long long done = function(count);
+		time = getTime() - start;
+		total += time;
+		double rate = time ? done * 1.0e9 / time : 0;
+		if (rate > best)
+			best = rate;
+	}
+
+	// Result
+	printf("BENCH %s %.0f %s/s %.2f ns/%s\n", name.c_str(), best,
+			unit.c_str(), best ? 1.0e9 / best : 0.0,
+			unit.c_str());
+	fflush(stdout);
+}
+
+
+}  // namespace bench
+
+#endif
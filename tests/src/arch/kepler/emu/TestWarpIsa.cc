@@ -0,0 +1,248 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <elf.h>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+#include <vector>
+
+#include <arch/kepler/disassembler/Instruction.h>
+#include <arch/kepler/driver/Function.h>
+#include <arch/kepler/driver/Module.h>
+#include <arch/kepler/emulator/Grid.h>
+#include <arch/kepler/emulator/Thread.h>
+#include <arch/kepler/emulator/ThreadBlock.h>
+#include <arch/kepler/emulator/Warp.h>
+#include <lib/cpp/Error.h>
+#include <lib/cpp/String.h>
+
+
+namespace Kepler
+{
+
+// Encoding of the instructions with all fields but the opcode set to 0, as
+// recognized by the decoder
+static const unsigned long long ffma_b_opcode = 0x4c00000000000002ull;
+static const unsigned long long isetp_b_opcode = 0xb300000000000001ull;
+
+// Guard predicate that is always true
+static const unsigned pred_true = 7;
+
+
+// Write a cubin file with one kernel function named 'kernel', with the given
+// instructions in its ISA section and no arguments
+static void WriteCubin(const std::string &path,
+		const std::vector<unsigned long long> &instructions)
+{
+	// Section names
+	const char names[] = "\0.shstrtab\0.text.kernel\0.nv.info.kernel";
+	const int shstrtab_name = 1;
+	const int text_name = 11;
+	const int info_name = 24;
+
+	// Section contents, after the ELF header
+	std::string text((const char *) instructions.data(),
+			instructions.size() * 8);
+	std::string info(12, '\0');
+	unsigned names_offset = sizeof(Elf32_Ehdr);
+	unsigned text_offset = names_offset + sizeof names;
+	unsigned info_offset = text_offset + text.size();
+	unsigned headers_offset = info_offset + info.size();
+
+	// ELF header
+	Elf32_Ehdr header;
+	memset(&header, 0, sizeof header);
+	memcpy(header.e_ident, ELFMAG, SELFMAG);
+	header.e_ident[EI_CLASS] = ELFCLASS32;
+	header.e_ident[EI_DATA] = ELFDATA2LSB;
+	header.e_ident[EI_VERSION] = EV_CURRENT;
+	header.e_type = ET_EXEC;
+	header.e_version = EV_CURRENT;
+	header.e_ehsize = sizeof(Elf32_Ehdr);
+	header.e_shoff = headers_offset;
+	header.e_shentsize = sizeof(Elf32_Shdr);
+	header.e_shnum = 4;
+	header.e_shstrndx = 1;
+
+	// Section headers
+	Elf32_Shdr sections[4];
+	memset(sections, 0, sizeof sections);
+	sections[1].sh_name = shstrtab_name;
+	sections[1].sh_type = SHT_STRTAB;
+	sections[1].sh_offset = names_offset;
+	sections[1].sh_size = sizeof names;
+	sections[2].sh_name = text_name;
+	sections[2].sh_type = SHT_PROGBITS;
+	sections[2].sh_flags = SHF_ALLOC | SHF_EXECINSTR;
+	sections[2].sh_offset = text_offset;
+	sections[2].sh_size = text.size();
+	sections[3].sh_name = info_name;
+	sections[3].sh_type = SHT_PROGBITS;
+	sections[3].sh_offset = info_offset;
+	sections[3].sh_size = info.size();
+
+	// Write file
+	std::ofstream f(path, std::ios::binary);
+	f.write((const char *) &header, sizeof header);
+	f.write(names, sizeof names);
+	f << text << info;
+	f.write((const char *) sections, sizeof sections);
+}
+
+
+// FFMA Rdst, Rsrc1, c[0x0][constant], Rsrc3
+static unsigned long long EncodeFFMA(unsigned pred, unsigned dst,
+		unsigned src1, unsigned constant, unsigned src3)
+{
+	Instruction::Bytes bytes;
+	bytes.as_dword = ffma_b_opcode;
+	bytes.ffma.pred = pred;
+	bytes.ffma.dst = dst;
+	bytes.ffma.src1 = src1;
+	bytes.ffma.src2 = constant >> 2;
+	bytes.ffma.src3 = src3;
+	return bytes.as_dword;
+}
+
+
+// ISETP.LT.AND Ppred1, Ppred2, RsrcA, immediate, PT
+static unsigned long long EncodeISETP_LT(unsigned pred1, unsigned pred2,
+		unsigned srcA, int immediate)
+{
+	Instruction::Bytes bytes;
+	bytes.as_dword = isetp_b_opcode;
+	bytes.general0.pred = pred_true;
+	bytes.general0.dst = (pred1 << 3) | pred2;
+	bytes.general0.mod0 = srcA;
+	bytes.general0.srcB = immediate & 0x7ffff;
+	bytes.general0.mod1 = (1u << 10) | pred_true;
+	return bytes.as_dword;
+}
+
+
+// This test runs FFMA and ISETP on a warp of 20 threads, executed for the
+// whole warp at once. Lanes past the thread count, and lanes disabled by
+// the guard predicate, must keep their registers.
+TEST(TestWarpIsa, partial_warp)
+{
+	char path[] = "/tmp/m2s-kepler-XXXXXX";
+	int fd = mkstemp(path);
+	ASSERT_GE(fd, 0);
+	close(fd);
+	try
+	{
+		// Kernel. The first slot holds scheduling information.
+		const unsigned gid_float = 1;
+		const unsigned addend = 2;
+		const unsigned product = 3;
+		const unsigned gid = 4;
+		const unsigned guarded = 5;
+		const unsigned factor_address = 0x140;
+		WriteCubin(path, {
+			0,
+			EncodeFFMA(pred_true, product, gid_float,
+					factor_address, addend),
+			EncodeISETP_LT(0, 1, gid, 10),
+			EncodeFFMA(0, guarded, gid_float,
+					factor_address, addend),
+			0
+		});
+
+		// Grid with one thread block of 20 threads
+		Module module(0, path);
+		Function *function = module.addFunction(&module, "kernel");
+		Grid grid(function);
+		unsigned thread_block_count[3] = { 1, 1, 1 };
+		unsigned thread_block_size[3] = { 20, 1, 1 };
+		grid.SetupSize(thread_block_count, thread_block_size);
+		unsigned id_3d[3] = { 0, 0, 0 };
+		ThreadBlock thread_block(&grid, 0, id_3d);
+		Warp *warp = thread_block.WarpsBegin()->get();
+		ASSERT_EQ(20u, warp->getThreadCount());
+
+		// Instructions decoded as expected
+		ASSERT_EQ((unsigned) Instruction::INST_FFMA_B,
+				function->getInstruction(8)->getOpcode());
+		ASSERT_EQ((unsigned) Instruction::INST_ISETP_B,
+				function->getInstruction(16)->getOpcode());
+
+		// Registers of all lanes, with marks in the destinations
+		const unsigned mark = 0xdeadbeef;
+		float factor = 2.0f;
+		Emulator::getInstance()->WriteConstantMemory(factor_address,
+				4, (const char *) &factor);
+		RegisterFile *registers = warp->getRegisterFile();
+		for (int lane = 0; lane < RegisterFile::NumLanes; lane++)
+		{
+			registers->gpr[gid_float][lane].f = lane;
+			registers->gpr[addend][lane].f = 0.5f;
+			registers->gpr[product][lane].u32 = mark;
+			registers->gpr[gid][lane].s32 = lane;
+			registers->gpr[guarded][lane].u32 = mark;
+			registers->pr[0][lane] = mark;
+			registers->pr[1][lane] = mark;
+		}
+
+		// Execute the three instructions
+		warp->setPC(8);
+		for (int i = 0; i < 3; i++)
+			warp->Execute();
+		EXPECT_EQ(32u, warp->getPC());
+
+		// Check registers
+		for (int lane = 0; lane < RegisterFile::NumLanes; lane++)
+		{
+			SCOPED_TRACE(misc::fmt("lane %d", lane));
+			float result = lane * 2.0f + 0.5f;
+			if (lane < 20)
+			{
+				EXPECT_EQ(result, registers->gpr[product][lane].f);
+				EXPECT_EQ(lane < 10 ? 1u : 0u,
+						registers->pr[0][lane]);
+				EXPECT_EQ(lane < 10 ? 0u : 1u,
+						registers->pr[1][lane]);
+			}
+			else
+			{
+				EXPECT_EQ(mark, registers->gpr[product][lane].u32);
+				EXPECT_EQ(mark, registers->pr[0][lane]);
+				EXPECT_EQ(mark, registers->pr[1][lane]);
+			}
+			if (lane < 10)
+				EXPECT_EQ(result, registers->gpr[guarded][lane].f);
+			else
+				EXPECT_EQ(mark, registers->gpr[guarded][lane].u32);
+		}
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+	remove(path);
+}
+
+
+}  // namespace Kepler
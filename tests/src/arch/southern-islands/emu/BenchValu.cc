@@ -0,0 +1,91 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "Bench.h"
+#include "ObjectPool.h"
+
+
+namespace SI
+{
+
+// VOP2 instructions reading v0 and v1 and writing v2
+static const int opcodes[] =
+{
+	3,	// v_add_f32
+	8,	// v_mul_f32
+	18,	// v_max_i32
+	27,	// v_and_b32
+	29,	// v_xor_b32
+	31,	// v_mac_f32
+	37	// v_add_i32
+};
+
+// Number of instructions
+static const int num_instructions = sizeof opcodes / sizeof opcodes[0];
+
+
+// Execute a mix of vector ALU instructions in a work-item
+static long long ExecuteValu(long long count)
+{
+	// Decode instructions once
+	static ObjectPool pool;
+	static std::vector<std::unique_ptr<Instruction>> instructions;
+	if (instructions.empty())
+	{
+		for (int i = 0; i < num_instructions; i++)
+		{
+			Instruction::BytesVOP2 bytes = { 256, 1, 2,
+					(unsigned) opcodes[i], 0, 0 };
+			auto inst = misc::new_unique<Instruction>();
+			inst->Decode((char *) &bytes, 0);
+			if (inst->getOpcode() == Instruction::OpcodeInvalid)
+			{
+				std::cerr << "SI bench: invalid instruction\n";
+				exit(1);
+			}
+			instructions.push_back(std::move(inst));
+		}
+	}
+
+	// Execute
+	WorkItem *work_item = pool.getWorkItem();
+	work_item->WriteVReg(0, 3);
+	work_item->WriteVReg(1, 5);
+	for (long long i = 0; i < count; i++)
+	{
+		Instruction *inst = instructions[i % num_instructions].get();
+		work_item->Execute(inst->getOpcode(), inst);
+	}
+	return count;
+}
+
+
+}  // namespace SI
+
+
+int main()
+{
+	bench::Run("si.valu_execute", "inst", SI::ExecuteValu);
+	return 0;
+}
@@ -17,11 +17,17 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <sstream>
+
 #include <gtest/gtest.h>
 
+#include <arch/southern-islands/emulator/Emulator.h>
+#include <arch/southern-islands/emulator/NDRange.h>
 #include <arch/southern-islands/timing/Timing.h>
 #include <lib/cpp/IniFile.h>
 #include <lib/esim/Engine.h>
+#include <memory/System.h>
+#include <network/System.h>
 
 namespace SI 
 {
@@ -29,11 +35,138 @@ namespace SI
 static void Cleanup()
 {
         esim::Engine::Destroy();
+        net::System::Destroy();
+        mem::System::Destroy();
         Timing::Destroy();
+        Emulator::Destroy();
         comm::ArchPool::Destroy();
 }
 
 
+// Kernel where work-item 'gid' stores gid * gid at 'kernel_output_0' + 4 * gid,
+// loads it back, and stores the loaded value XOR gid at 'kernel_output_1' +
+// 4 * gid. The work-group ID is received in s0 and the local ID in v0.
+static const unsigned kernel_output_0 = 0x10000;
+static const unsigned kernel_output_1 = 0x20000;
+static const unsigned kernel_code[] =
+{
+	0x8f018600,                     // s_lshl_b32 s1, s0, 6
+	0x4a020001,                     // v_add_i32 v1, vcc, s1, v0
+	0x34040282,                     // v_lshlrev_b32 v2, 2, v1
+	0x12060301,                     // v_mul_i32_i24 v3, v1, v1
+	0xbe8403ff, kernel_output_0,    // s_mov_b32 s4, kernel_output_0
+	0xbe850380,                     // s_mov_b32 s5, 0
+	0xbe8603c1,                     // s_mov_b32 s6, -1
+	0xbe870380,                     // s_mov_b32 s7, 0
+	0xbe880380,                     // s_mov_b32 s8, 0
+	0xe0701000, 0x08010302,         // buffer_store_dword v3, v2, s[4:7], s8 offen
+	0xbf8c0000,                     // s_waitcnt 0
+	0xe0301000, 0x08010402,         // buffer_load_dword v4, v2, s[4:7], s8 offen
+	0xbf8c0000,                     // s_waitcnt 0
+	0x3a0a0304,                     // v_xor_b32 v5, v4, v1
+	0xbe8403ff, kernel_output_1,    // s_mov_b32 s4, kernel_output_1
+	0xe0701000, 0x08010502,         // buffer_store_dword v5, v2, s[4:7], s8 offen
+	0xbf8c0000,                     // s_waitcnt 0
+	0xbf810000                      // s_endpgm
+};
+
+
+// Run the kernel above on a detailed simulation with the given number of
+// threads. Return a dump of the statistics in 'report' and the contents of
+// both output buffers in 'output'.
+static void RunKernel(int num_threads, int num_work_groups,
+		std::string &report, std::vector<unsigned> &output)
+{
+	// Cleanup singleton instances
+	Cleanup();
+
+	// Set up timing simulator. The frequency is given explicitly, since
+	// other tests leave an invalid value behind.
+	Gpu::num_threads = num_threads;
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(
+			"[ Device ]\n"
+			"Frequency = 1000");
+	Timing::ParseConfiguration(&ini_file);
+	Timing *timing = Timing::getInstance();
+	Gpu::num_threads = 1;
+
+	// Set up network and memory system with the default configuration
+	misc::IniFile ini_file_mem;
+	timing->WriteMemoryConfiguration(&ini_file_mem);
+	net::System::getInstance();
+	mem::System *memory_system = mem::System::getInstance();
+	memory_system->ReadConfiguration(&ini_file_mem);
+
+	// Output buffers
+	Emulator *emulator = Emulator::getInstance();
+	unsigned size = num_work_groups * 64 * 4;
+	mem::Memory *global_memory = emulator->getGlobalMemory();
+	global_memory->Map(kernel_output_0, size, mem::Memory::AccessRead |
+			mem::Memory::AccessWrite);
+	global_memory->Map(kernel_output_1, size, mem::Memory::AccessRead |
+			mem::Memory::AccessWrite);
+
+	// Create ND-Range, as the driver would do
+	NDRange *ndrange = emulator->addNDRange();
+	ndrange->setNumSgprUsed(16);
+	ndrange->setNumVgprUsed(8);
+	ndrange->setWgIdSgpr(0);
+	ndrange->SetupInstructionMemory((const char *) kernel_code,
+			sizeof kernel_code, 0);
+	unsigned global_size = num_work_groups * 64;
+	unsigned local_size = 64;
+	ndrange->SetupSize(&global_size, &local_size, 1);
+	for (int i = 0; i < num_work_groups; i++)
+		ndrange->AddWorkgroupIdToWaitingList(i);
+
+	// Simulation loop
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	comm::ArchPool *arch_pool = comm::ArchPool::getInstance();
+	for (int i = 0; i < 100000; i++)
+	{
+		int num_active_emulators;
+		int num_active_timing_simulators;
+		arch_pool->Run(num_active_emulators,
+				num_active_timing_simulators);
+		esim_engine->ProcessEvents();
+		if (ndrange->isWaitingWorkGroupsEmpty() &&
+				ndrange->isRunningWorkGroupsEmpty())
+			break;
+	}
+	esim_engine->ProcessAllEvents();
+
+	// Statistics
+	std::ostringstream os;
+	Gpu *gpu = timing->getGpu();
+	os << "Cycle = " << timing->getCycle() << '\n';
+	os << "LastCompleteCycle = " << gpu->last_complete_cycle << '\n';
+	os << "Instructions = " << emulator->getNumInstructions() << '\n';
+	for (auto it = gpu->getComputeUnitsBegin(),
+			e = gpu->getComputeUnitsEnd();
+			it != e;
+			++it)
+	{
+		ComputeUnit *compute_unit = it->get();
+		os << misc::fmt("ComputeUnit %d = %lld %lld %lld %lld %lld\n",
+				compute_unit->getIndex(),
+				compute_unit->num_mapped_work_groups,
+				compute_unit->num_total_instructions,
+				compute_unit->num_vector_memory_instructions,
+				compute_unit->num_vreg_reads,
+				compute_unit->num_vreg_writes);
+	}
+	memory_system->DumpReport(os);
+	report = os.str();
+
+	// Output buffers
+	output.resize(2 * num_work_groups * 64);
+	global_memory->Read(kernel_output_0, size, (char *) output.data());
+	global_memory->Read(kernel_output_1, size,
+			(char *) output.data() + size);
+}
+
+
 // This test checks to see if the correct error message is returned when
 // a frequency is passed that is larger than the acceptable bounds
 TEST(TestTiming, config_section_device_frequency_0)
@@ -104,4 +237,43 @@ TEST(TestTiming, config_section_device_frequency_1)
 }
 
 
+// This test runs the same kernel sequentially and on several threads, and
+// checks that statistics and memory contents are identical.
+TEST(TestTiming, parallel_compute_units)
+{
+	try
+	{
+		// Sequential simulation
+		const int num_work_groups = 64;
+		std::string report_serial;
+		std::vector<unsigned> output_serial;
+		RunKernel(1, num_work_groups, report_serial, output_serial);
+
+		// Check that the kernel ran. The values loaded back are not
+		// checked, since ISA_BUFFER_LOAD_DWORD_Impl() sign-extends the
+		// lowest byte of the loaded word. The second buffer is only
+		// compared with the sequential simulation below.
+		for (int gid = 0; gid < num_work_groups * 64; gid++)
+		{
+			unsigned square = gid * gid;
+			ASSERT_EQ(square, output_serial[gid]);
+		}
+
+		// Parallel simulation
+		std::string report_parallel;
+		std::vector<unsigned> output_parallel;
+		RunKernel(4, num_work_groups, report_parallel, output_parallel);
+
+		// Compare
+		EXPECT_EQ(report_serial, report_parallel);
+		EXPECT_EQ(output_serial, output_parallel);
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
 } // namespace SI
@@ -0,0 +1,147 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+#include <arch/x86/disassembler/Instruction.h>
+#include <arch/x86/emulator/Context.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <arch/x86/timing/Timing.h>
+#include <memory/Memory.h>
+
+#include "Bench.h"
+
+
+namespace x86
+{
+
+// Instructions with a mix of prefixes, ModR/M and SIB bytes, immediates,
+// and displacements
+static const unsigned char decode_code[] =
+{
+	0x8b, 0x44, 0x24, 0x08,			// mov eax, [esp+8]
+	0x01, 0xd8,				// add eax, ebx
+	0x0f, 0xaf, 0xc3,			// imul eax, ebx
+	0x81, 0xc1, 0x78, 0x56, 0x34, 0x12,	// add ecx, 0x12345678
+	0x66, 0x89, 0x06,			// mov [esi], ax
+	0xe8, 0x00, 0x00, 0x00, 0x00,		// call +0
+	0x8d, 0x04, 0x8d, 0x00, 0x10, 0x00, 0x00, // lea eax, [ecx*4+0x1000]
+	0xf3, 0xa5,				// rep movsd
+	0xd9, 0x45, 0xf8,			// fld dword [ebp-8]
+	0x0f, 0x85, 0x10, 0x00, 0x00, 0x00,	// jnz +0x10
+	0xc3					// ret
+};
+
+// Loop of integer instructions without memory operands
+static const unsigned char execute_code[] =
+{
+	0x01, 0xd8,				// add eax, ebx
+	0x31, 0xc2,				// xor edx, eax
+	0x41,					// inc ecx
+	0x0f, 0xaf, 0xd9,			// imul ebx, ecx
+	0x8d, 0x74, 0x8e, 0x04,			// lea esi, [esi+ecx*4+4]
+	0xd1, 0xe0,				// shl eax, 1
+	0x39, 0xd1,				// cmp ecx, edx
+	0xeb, 0xee				// jmp -18
+};
+
+
+// Decode a sequence of instructions in a loop
+static long long Decode(long long count)
+{
+	Instruction inst;
+	unsigned offset = 0;
+	for (long long i = 0; i < count; i++)
+	{
+		inst.Decode((const char *) decode_code + offset,
+				0x8048000 + offset);
+		if (inst.getOpcode() == Instruction::OpcodeInvalid)
+		{
+			std::cerr << "x86 bench: invalid instruction\n";
+			exit(1);
+		}
+		offset += inst.getSize();
+		if (offset == sizeof decode_code)
+			offset = 0;
+	}
+	return count;
+}
+
+
+// Return a context executing the instruction loop
+static Context *getContext(bool uinst_active)
+{
+	static Context *context;
+	if (!context)
+	{
+		// Timing simulator with the default configuration, as in
+		// detailed simulation
+		Timing::getInstance();
+
+		// Context with the loop in memory
+		Emulator *emulator = Emulator::getInstance();
+		context = emulator->newContext();
+		context->Initialize();
+		mem::Memory *memory = context->getMemory();
+		memory->Map(0x8048000, mem::Memory::PageSize,
+				mem::Memory::AccessRead |
+				mem::Memory::AccessExec |
+				mem::Memory::AccessInit);
+		memory->Init(0x8048000, sizeof execute_code,
+				(const char *) execute_code);
+		context->getRegs().setEip(0x8048000);
+	}
+	context->setUinstActive(uinst_active);
+	return context;
+}
+
+
+// Emulate the instruction loop
+static long long Execute(long long count)
+{
+	Context *context = getContext(false);
+	for (long long i = 0; i < count; i++)
+		context->Execute();
+	return count;
+}
+
+
+// Emulate the instruction loop generating micro-instructions, as done in
+// detailed simulation
+static long long ExecuteUinsts(long long count)
+{
+	Context *context = getContext(true);
+	for (long long i = 0; i < count; i++)
+		context->Execute();
+	return count;
+}
+
+
+}  // namespace x86
+
+
+int main()
+{
+	bench::Run("x86.decode", "inst", x86::Decode);
+	bench::Run("x86.execute", "inst", x86::Execute);
+	bench::Run("x86.execute_uinsts", "inst", x86::ExecuteUinsts);
+	return 0;
+}
@@ -0,0 +1,407 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <random>
+#include <vector>
+
+#include <arch/x86/emulator/Context.h>
+#include <arch/x86/emulator/Emulator.h>
+#include <arch/x86/emulator/Regs.h>
+#include <arch/x86/timing/Timing.h>
+#include <lib/cpp/String.h>
+#include <memory/Memory.h>
+
+
+// The reference for the emulated flags is the host executing the same
+// instruction, which is what the emulator used to do with inline assembly.
+#if defined(__i386__) || defined(__x86_64__)
+
+namespace x86
+{
+
+// Address where the tested instruction is placed
+static const unsigned code_address = 0x8048000;
+
+// Flags affected by arithmetic instructions
+static const unsigned flag_cf = 1 << Instruction::FlagCF;
+static const unsigned flag_pf = 1 << Instruction::FlagPF;
+static const unsigned flag_af = 1 << Instruction::FlagAF;
+static const unsigned flag_zf = 1 << Instruction::FlagZF;
+static const unsigned flag_sf = 1 << Instruction::FlagSF;
+static const unsigned flag_of = 1 << Instruction::FlagOF;
+static const unsigned flags_all = Regs::ArithmeticFlagsMask;
+
+// Register values shared by the host and the emulator
+struct HostRegs
+{
+	unsigned eax;
+	unsigned ebx;
+	unsigned ecx;
+	unsigned edx;
+};
+
+// Class of instruction, determining which flags are architecturally defined
+// after its execution
+enum FlagsKind
+{
+	FlagsArithmetic,
+	FlagsLogic,
+	FlagsShift,
+	FlagsRotate,
+	FlagsShiftDouble,
+	FlagsMultiply,
+	FlagsBitScan,
+	FlagsBitTest
+};
+
+// Tested instruction, run with 'eax' as destination, 'ebx' as source, and
+// 'cl' as shift count
+struct TestCase
+{
+	const char *name;
+	std::vector<unsigned char> bytes;
+	void (*host)(HostRegs &regs, unsigned long &flags);
+	FlagsKind kind;
+	int size;
+
+	// Shift count encoded in the instruction, or 0 if given in 'cl'
+	unsigned count;
+};
+
+
+// Stack adjustment around 'pushf' and 'popf' to avoid clobbering the red
+// zone of the calling function
+#ifdef __x86_64__
+#define RED_ZONE_ENTER "lea -128(%%rsp), %%rsp\n\t"
+#define RED_ZONE_LEAVE "lea 128(%%rsp), %%rsp\n\t"
+#else
+#define RED_ZONE_ENTER
+#define RED_ZONE_LEAVE
+#endif
+
+// Run one instruction on the host, with the given input and output flags
+#define HOST(text) \
+	[](HostRegs &regs, unsigned long &flags) \
+	{ \
+		asm volatile ( \
+			RED_ZONE_ENTER \
+			"push %4\n\t" \
+			"popf\n\t" \
+			text "\n\t" \
+			"pushf\n\t" \
+			"pop %4\n\t" \
+			RED_ZONE_LEAVE \
+			: "+a" (regs.eax), "+b" (regs.ebx), \
+			  "+c" (regs.ecx), "+d" (regs.edx), \
+			  "+r" (flags) \
+			: \
+			: "cc", "memory" \
+		); \
+	}
+
+
+static const std::vector<TestCase> test_cases =
+{
+	// Standard arithmetic, 32-bit
+	{ "add_r32", { 0x01, 0xd8 }, HOST("add %%ebx, %%eax"), FlagsArithmetic, 4 },
+	{ "adc_r32", { 0x11, 0xd8 }, HOST("adc %%ebx, %%eax"), FlagsArithmetic, 4 },
+	{ "sub_r32", { 0x29, 0xd8 }, HOST("sub %%ebx, %%eax"), FlagsArithmetic, 4 },
+	{ "sbb_r32", { 0x19, 0xd8 }, HOST("sbb %%ebx, %%eax"), FlagsArithmetic, 4 },
+	{ "cmp_r32", { 0x39, 0xd8 }, HOST("cmp %%ebx, %%eax"), FlagsArithmetic, 4 },
+	{ "and_r32", { 0x21, 0xd8 }, HOST("and %%ebx, %%eax"), FlagsLogic, 4 },
+	{ "or_r32", { 0x09, 0xd8 }, HOST("or %%ebx, %%eax"), FlagsLogic, 4 },
+	{ "xor_r32", { 0x31, 0xd8 }, HOST("xor %%ebx, %%eax"), FlagsLogic, 4 },
+	{ "test_r32", { 0x85, 0xd8 }, HOST("test %%ebx, %%eax"), FlagsLogic, 4 },
+
+	// Standard arithmetic, 16-bit
+	{ "add_r16", { 0x66, 0x01, 0xd8 }, HOST("add %%bx, %%ax"), FlagsArithmetic, 2 },
+	{ "adc_r16", { 0x66, 0x11, 0xd8 }, HOST("adc %%bx, %%ax"), FlagsArithmetic, 2 },
+	{ "sbb_r16", { 0x66, 0x19, 0xd8 }, HOST("sbb %%bx, %%ax"), FlagsArithmetic, 2 },
+	{ "cmp_r16", { 0x66, 0x39, 0xd8 }, HOST("cmp %%bx, %%ax"), FlagsArithmetic, 2 },
+
+	// Standard arithmetic, 8-bit
+	{ "add_r8", { 0x00, 0xd8 }, HOST("add %%bl, %%al"), FlagsArithmetic, 1 },
+	{ "adc_r8", { 0x10, 0xd8 }, HOST("adc %%bl, %%al"), FlagsArithmetic, 1 },
+	{ "sub_r8", { 0x28, 0xd8 }, HOST("sub %%bl, %%al"), FlagsArithmetic, 1 },
+	{ "sbb_r8", { 0x18, 0xd8 }, HOST("sbb %%bl, %%al"), FlagsArithmetic, 1 },
+	{ "xor_r8", { 0x30, 0xd8 }, HOST("xor %%bl, %%al"), FlagsLogic, 1 },
+
+	// Standard arithmetic with immediates
+	{ "add_imm8", { 0x83, 0xc0, 0x80 }, HOST("add $-128, %%eax"), FlagsArithmetic, 4 },
+	{ "sub_imm16", { 0x66, 0x83, 0xe8, 0x01 }, HOST("sub $1, %%ax"), FlagsArithmetic, 2 },
+	{ "adc_imm32", { 0x15, 0x78, 0x56, 0x34, 0x12 }, HOST("adc $0x12345678, %%eax"), FlagsArithmetic, 4 },
+	{ "cmp_al_imm8", { 0x3c, 0x7f }, HOST("cmp $0x7f, %%al"), FlagsArithmetic, 1 },
+
+	// Increment, decrement, negation
+	{ "inc_r32", { 0x40 }, HOST("inc %%eax"), FlagsArithmetic, 4 },
+	{ "dec_r32", { 0x48 }, HOST("dec %%eax"), FlagsArithmetic, 4 },
+	{ "inc_r16", { 0x66, 0x40 }, HOST("inc %%ax"), FlagsArithmetic, 2 },
+	{ "inc_rm8", { 0xfe, 0xc0 }, HOST("inc %%al"), FlagsArithmetic, 1 },
+	{ "dec_rm8", { 0xfe, 0xc8 }, HOST("dec %%al"), FlagsArithmetic, 1 },
+	{ "neg_rm32", { 0xf7, 0xd8 }, HOST("neg %%eax"), FlagsArithmetic, 4 },
+	{ "neg_rm8", { 0xf6, 0xd8 }, HOST("neg %%al"), FlagsArithmetic, 1 },
+
+	// Shifts and rotates
+	{ "shl_rm32_cl", { 0xd3, 0xe0 }, HOST("shl %%cl, %%eax"), FlagsShift, 4 },
+	{ "shr_rm32_cl", { 0xd3, 0xe8 }, HOST("shr %%cl, %%eax"), FlagsShift, 4 },
+	{ "sar_rm32_cl", { 0xd3, 0xf8 }, HOST("sar %%cl, %%eax"), FlagsShift, 4 },
+	{ "rol_rm32_cl", { 0xd3, 0xc0 }, HOST("rol %%cl, %%eax"), FlagsRotate, 4 },
+	{ "ror_rm32_cl", { 0xd3, 0xc8 }, HOST("ror %%cl, %%eax"), FlagsRotate, 4 },
+	{ "rcl_rm32_cl", { 0xd3, 0xd0 }, HOST("rcl %%cl, %%eax"), FlagsRotate, 4 },
+	{ "rcr_rm32_cl", { 0xd3, 0xd8 }, HOST("rcr %%cl, %%eax"), FlagsRotate, 4 },
+	{ "shl_rm16_cl", { 0x66, 0xd3, 0xe0 }, HOST("shl %%cl, %%ax"), FlagsShift, 2 },
+	{ "sar_rm16_cl", { 0x66, 0xd3, 0xf8 }, HOST("sar %%cl, %%ax"), FlagsShift, 2 },
+	{ "rcl_rm16_cl", { 0x66, 0xd3, 0xd0 }, HOST("rcl %%cl, %%ax"), FlagsRotate, 2 },
+	{ "shl_rm8_cl", { 0xd2, 0xe0 }, HOST("shl %%cl, %%al"), FlagsShift, 1 },
+	{ "shr_rm8_cl", { 0xd2, 0xe8 }, HOST("shr %%cl, %%al"), FlagsShift, 1 },
+	{ "sar_rm8_cl", { 0xd2, 0xf8 }, HOST("sar %%cl, %%al"), FlagsShift, 1 },
+	{ "rol_rm8_cl", { 0xd2, 0xc0 }, HOST("rol %%cl, %%al"), FlagsRotate, 1 },
+	{ "ror_rm8_cl", { 0xd2, 0xc8 }, HOST("ror %%cl, %%al"), FlagsRotate, 1 },
+	{ "rcl_rm8_cl", { 0xd2, 0xd0 }, HOST("rcl %%cl, %%al"), FlagsRotate, 1 },
+	{ "rcr_rm8_cl", { 0xd2, 0xd8 }, HOST("rcr %%cl, %%al"), FlagsRotate, 1 },
+	{ "shl_rm32_1", { 0xd1, 0xe0 }, HOST("shl $1, %%eax"), FlagsShift, 4, 1 },
+	{ "sar_rm32_imm8", { 0xc1, 0xf8, 0x05 }, HOST("sar $5, %%eax"), FlagsShift, 4, 5 },
+	{ "shld_rm32_cl", { 0x0f, 0xa5, 0xd8 }, HOST("shld %%cl, %%ebx, %%eax"), FlagsShiftDouble, 4 },
+	{ "shrd_rm32_cl", { 0x0f, 0xad, 0xd8 }, HOST("shrd %%cl, %%ebx, %%eax"), FlagsShiftDouble, 4 },
+	{ "shld_rm16_cl", { 0x66, 0x0f, 0xa5, 0xd8 }, HOST("shld %%cl, %%bx, %%ax"), FlagsShiftDouble, 2 },
+
+	// Multiplication
+	{ "imul_r32_rm32", { 0x0f, 0xaf, 0xc3 }, HOST("imul %%ebx, %%eax"), FlagsMultiply, 4 },
+	{ "imul_r16_rm16", { 0x66, 0x0f, 0xaf, 0xc3 }, HOST("imul %%bx, %%ax"), FlagsMultiply, 2 },
+	{ "imul_r32_rm32_imm8", { 0x6b, 0xc3, 0x9c }, HOST("imul $-100, %%ebx, %%eax"), FlagsMultiply, 4 },
+	{ "imul_rm32", { 0xf7, 0xeb }, HOST("imul %%ebx"), FlagsMultiply, 4 },
+	{ "mul_rm32", { 0xf7, 0xe3 }, HOST("mul %%ebx"), FlagsMultiply, 4 },
+
+	// Bit scan and bit test
+	{ "bsf_r32_rm32", { 0x0f, 0xbc, 0xc3 }, HOST("bsf %%ebx, %%eax"), FlagsBitScan, 4 },
+	{ "bsr_r32_rm32", { 0x0f, 0xbd, 0xc3 }, HOST("bsr %%ebx, %%eax"), FlagsBitScan, 4 },
+	{ "bt_rm32_r32", { 0x0f, 0xa3, 0xd8 }, HOST("bt %%ebx, %%eax"), FlagsBitTest, 4 },
+	{ "bts_rm32_imm8", { 0x0f, 0xba, 0xe8, 0x11 }, HOST("btsl $0x11, %%eax"), FlagsBitTest, 4 },
+
+	// Exchange and add, compare and exchange
+	{ "xadd_rm32_r32", { 0x0f, 0xc1, 0xd8 }, HOST("xadd %%ebx, %%eax"), FlagsArithmetic, 4 },
+	{ "xadd_rm8_r8", { 0x0f, 0xc0, 0xd8 }, HOST("xadd %%bl, %%al"), FlagsArithmetic, 1 },
+	{ "cmpxchg_rm32_r32", { 0x0f, 0xb1, 0xd8 }, HOST("cmpxchg %%ebx, %%eax"), FlagsArithmetic, 4 },
+};
+
+
+// Return the flags that are architecturally defined after executing an
+// instruction of the given kind, operand size, and shift count
+static unsigned getDefinedFlags(FlagsKind kind, int size, unsigned count)
+{
+	int width = size * 8;
+	count &= 0x1f;
+	switch (kind)
+	{
+
+	case FlagsArithmetic:
+		return flags_all;
+
+	case FlagsLogic:
+		return flags_all & ~flag_af;
+
+	case FlagsShift:
+	case FlagsShiftDouble:
+	{
+		if (!count)
+			return flags_all;
+		if (kind == FlagsShiftDouble && (int) count > width)
+			return 0;
+		unsigned defined = flags_all & ~flag_af;
+		if (count > 1)
+			defined &= ~flag_of;
+		if ((int) count > width)
+			defined &= ~flag_cf;
+		return defined;
+	}
+
+	case FlagsRotate:
+		return count > 1 ? flags_all & ~flag_of : flags_all;
+
+	case FlagsMultiply:
+		return flag_cf | flag_of;
+
+	case FlagsBitScan:
+		return flag_zf;
+
+	case FlagsBitTest:
+		return flag_cf;
+	}
+	return 0;
+}
+
+
+// Return a context ready to execute an instruction at 'code_address'
+static Context *getContext()
+{
+	static Context *context;
+	if (!context)
+	{
+		// The emulator reads the processor configuration from the
+		// timing simulator
+		Timing::getInstance();
+
+		Emulator *emulator = Emulator::getInstance();
+		context = emulator->newContext();
+		context->Initialize();
+		context->getMemory()->Map(code_address, mem::Memory::PageSize,
+				mem::Memory::AccessRead |
+				mem::Memory::AccessExec |
+				mem::Memory::AccessInit);
+	}
+	return context;
+}
+
+
+// Run the test case with the given register values and input flags, on the
+// host and on the emulator, and compare results and defined flags
+static void RunTestCase(const TestCase &test_case, const HostRegs &input,
+		unsigned input_flags)
+{
+	// Host
+	HostRegs host_regs = input;
+	unsigned long host_flags = input_flags | 0x2;
+	test_case.host(host_regs, host_flags);
+
+	// Emulator
+	Context *context = getContext();
+	context->getMemory()->Init(code_address, test_case.bytes.size(),
+			(const char *) test_case.bytes.data());
+	Regs &regs = context->getRegs();
+	regs.setEax(input.eax);
+	regs.setEbx(input.ebx);
+	regs.setEcx(input.ecx);
+	regs.setEdx(input.edx);
+	regs.setEflags(input_flags | 0x2);
+	regs.setEip(code_address);
+	context->Execute();
+
+	// Result of the shift count greater than the operand size is
+	// undefined for double precision shifts
+	std::string message = misc::fmt("%s: eax=0x%x ebx=0x%x ecx=0x%x "
+			"edx=0x%x flags=0x%x", test_case.name, input.eax,
+			input.ebx, input.ecx, input.edx, input_flags);
+	bool undefined_result = test_case.kind == FlagsShiftDouble &&
+			(int) (input.ecx & 0x1f) > test_case.size * 8;
+	if (!undefined_result)
+	{
+		EXPECT_EQ(host_regs.eax, regs.getEax()) << message;
+		EXPECT_EQ(host_regs.edx, regs.getEdx()) << message;
+	}
+	EXPECT_EQ(host_regs.ebx, regs.getEbx()) << message;
+	EXPECT_EQ(host_regs.ecx, regs.getEcx()) << message;
+
+	// Compare defined flags, reading them both through the full register
+	// and flag by flag
+	unsigned defined = getDefinedFlags(test_case.kind, test_case.size,
+			test_case.count ? test_case.count : input.ecx);
+	EXPECT_EQ(host_flags & defined, regs.getEflags() & defined) << message;
+	for (auto flag : { Instruction::FlagCF, Instruction::FlagPF,
+			Instruction::FlagAF, Instruction::FlagZF,
+			Instruction::FlagSF, Instruction::FlagOF })
+		if (defined & (1 << flag))
+			EXPECT_EQ((bool) (host_flags & (1 << flag)),
+					regs.getFlag(flag)) << message;
+}
+
+
+// Compare every test case against the host on boundary values and random
+// values, with random input flags
+TEST(TestFlags, host_differential)
+{
+	// Boundary values
+	const unsigned values[] =
+	{
+		0, 1, 2, 0xf, 0x10, 0x7f, 0x80, 0xff, 0x100, 0x7fff, 0x8000,
+		0xffff, 0x10000, 0x7fffffff, 0x80000000, 0xfffffffe, 0xffffffff
+	};
+	const int num_values = sizeof values / sizeof values[0];
+
+	// Random generator with fixed seed
+	std::mt19937 generator(1);
+	auto random_value = [&]() -> unsigned
+	{
+		unsigned value = generator();
+		switch (generator() % 4)
+		{
+		case 0: return values[value % num_values];
+		case 1: return value & 0xff;
+		case 2: return value & 0xffff;
+		default: return value;
+		}
+	};
+
+	for (auto &test_case : test_cases)
+	{
+		for (int i = 0; i < 2000; i++)
+		{
+			HostRegs input;
+			input.eax = random_value();
+			input.ebx = random_value();
+			input.ecx = generator() % 40;
+			input.edx = random_value();
+			unsigned input_flags = generator() & flags_all;
+			RunTestCase(test_case, input, input_flags);
+			if (::testing::Test::HasFailure())
+				return;
+		}
+	}
+}
+
+
+// Flags of a lazily evaluated instruction must survive the instructions
+// that do not modify them, and be combined with updates to other flags
+TEST(TestFlags, lazy_flags_sequence)
+{
+	Regs regs;
+
+	// 'add' producing a carry and zero
+	regs.setEflags(0x2);
+	regs.setLazyFlags(Regs::LazyFlagsAdd, 4, 0xffffffff, 1, 0);
+	EXPECT_TRUE(regs.getFlag(Instruction::FlagCF));
+	EXPECT_TRUE(regs.getFlag(Instruction::FlagZF));
+	EXPECT_FALSE(regs.getFlag(Instruction::FlagSF));
+
+	// 'inc' preserves the carry flag
+	regs.setLazyFlags(Regs::LazyFlagsInc, 4, 0x7fffffff, 1, 0x80000000,
+			regs.getFlag(Instruction::FlagCF));
+	regs.setFlag(Instruction::FlagDF);
+	EXPECT_TRUE(regs.getFlag(Instruction::FlagDF));
+	EXPECT_TRUE(regs.getFlag(Instruction::FlagCF));
+	EXPECT_TRUE(regs.getFlag(Instruction::FlagOF));
+	EXPECT_TRUE(regs.getFlag(Instruction::FlagSF));
+	EXPECT_FALSE(regs.getFlag(Instruction::FlagZF));
+
+	// Full register
+	EXPECT_EQ(0x2u | flag_cf | flag_pf | flag_af | flag_sf | flag_of |
+			(1 << Instruction::FlagDF), regs.getEflags());
+
+	// Writing the register discards the pending operation
+	regs.setLazyFlags(Regs::LazyFlagsSub, 1, 0, 1, 0xff);
+	regs.setEflags(0x2);
+	EXPECT_EQ(0x2u, regs.getEflags());
+	EXPECT_FALSE(regs.getFlag(Instruction::FlagCF));
+}
+
+
+}  // namespace x86
+
+#endif
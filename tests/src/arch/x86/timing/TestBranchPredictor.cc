@@ -593,6 +593,179 @@ TEST(TestBranchPredictor, test_combined_branch_predictor_1)
 }
 
 
+// Run a sequence of outcomes of a branch at address 'branch_addr' through the
+// branch predictor, performing the lookup and the update of every branch in
+// order, and return the number of mispredictions in the last 'num_checked'
+// outcomes.
+static int RunBranchPattern(BranchPredictor &branch_predictor,
+		unsigned int branch_addr,
+		const std::vector<bool> &outcomes,
+		int num_checked)
+{
+	ObjectPool *object_pool = ObjectPool::getInstance();
+	auto uinst = misc::new_shared<Uinst>(Uinst::OpcodeBranch);
+	int num_mispredictions = 0;
+	for (unsigned i = 0; i < outcomes.size(); i++)
+	{
+		Uop uop(object_pool->getThread(),
+				object_pool->getContext(),
+				uinst);
+		uop.eip = branch_addr;
+		uop.mop_size = 4;
+		uop.neip = outcomes[i] ? branch_addr + 64 : branch_addr + 4;
+		BranchPredictor::Prediction prediction = branch_predictor.Lookup(&uop);
+		uop.predicted_neip = prediction == BranchPredictor::PredictionTaken ?
+				branch_addr + 64 : branch_addr + 4;
+		branch_predictor.Update(&uop);
+		if (i >= outcomes.size() - num_checked &&
+				prediction != (outcomes[i] ?
+				BranchPredictor::PredictionTaken :
+				BranchPredictor::PredictionNotTaken))
+			num_mispredictions++;
+	}
+	return num_mispredictions;
+}
+
+
+TEST(TestBranchPredictor, read_ini_configuration_file_tage_perceptron)
+{
+	// Setup configuration file
+	std::string config =
+		"[ BranchPredictor ]\n"
+		"Kind = TAGE\n"
+		"Tage.NumTables = 6\n"
+		"Tage.TableSize = 512\n"
+		"Tage.TagBits = 11\n"
+		"Tage.MinHistory = 5\n"
+		"Tage.MaxHistory = 130\n"
+		"Tage.BaseSize = 2048\n"
+		"Tage.LoopPredictor = True\n"
+		"Tage.StatisticalCorrector = True\n"
+		"Loop.Size = 32\n"
+		"SC.Size = 256\n"
+		"Perceptron.NumTables = 12\n"
+		"Perceptron.TableSize = 2048\n"
+		"Perceptron.HistoryLength = 128\n"
+		"Perceptron.Threshold = 50";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	BranchPredictor::ParseConfiguration(&ini_file);
+
+	// Assertions
+	EXPECT_EQ(BranchPredictor::KindTage, BranchPredictor::getKind());
+	EXPECT_EQ(6, BranchPredictor::getTageNumTables());
+	EXPECT_EQ(512, BranchPredictor::getTageTableSize());
+	EXPECT_EQ(11, BranchPredictor::getTageTagBits());
+	EXPECT_EQ(5, BranchPredictor::getTageMinHistory());
+	EXPECT_EQ(130, BranchPredictor::getTageMaxHistory());
+	EXPECT_EQ(2048, BranchPredictor::getTageBaseSize());
+	EXPECT_TRUE(BranchPredictor::getTageLoopPredictor());
+	EXPECT_TRUE(BranchPredictor::getTageStatisticalCorrector());
+	EXPECT_EQ(32, BranchPredictor::getLoopSize());
+	EXPECT_EQ(256, BranchPredictor::getScSize());
+	EXPECT_EQ(12, BranchPredictor::getPerceptronNumTables());
+	EXPECT_EQ(2048, BranchPredictor::getPerceptronTableSize());
+	EXPECT_EQ(128, BranchPredictor::getPerceptronHistoryLength());
+	EXPECT_EQ(50, BranchPredictor::getPerceptronThreshold());
+
+	// Invalid number of tables
+	misc::IniFile ini_file_invalid;
+	ini_file_invalid.LoadFromString(
+			"[ BranchPredictor ]\n"
+			"Kind = TAGE\n"
+			"Tage.NumTables = 17");
+	EXPECT_THROW(BranchPredictor::ParseConfiguration(&ini_file_invalid),
+			BranchPredictor::Error);
+
+	// Table sizes too small to hash into
+	for (std::string size : { "Perceptron.TableSize = 1",
+			"SC.Size = 2", "Tage.BaseSize = 0" })
+	{
+		misc::IniFile ini_file_small;
+		ini_file_small.LoadFromString("[ BranchPredictor ]\n" + size);
+		EXPECT_THROW(BranchPredictor::ParseConfiguration(
+				&ini_file_small), BranchPredictor::Error);
+	}
+}
+
+
+TEST(TestBranchPredictor, test_tage_branch_predictor_1)
+{
+	// Pattern taken-taken-taken-not taken, which a bimodal predictor
+	// mispredicts once every four branches
+	std::vector<bool> outcomes;
+	for (int i = 0; i < 1000; i++)
+		outcomes.push_back(i % 4 != 3);
+
+	// Plain TAGE and TAGE with loop predictor and statistical corrector
+	for (int variant = 0; variant < 2; variant++)
+	{
+		misc::IniFile ini_file;
+		ini_file.LoadFromString(std::string(
+				"[ BranchPredictor ]\n"
+				"Kind = TAGE\n") + (variant ?
+				"Tage.LoopPredictor = True\n"
+				"Tage.StatisticalCorrector = True\n" : ""));
+		BranchPredictor::ParseConfiguration(&ini_file);
+		BranchPredictor branch_predictor;
+
+		// Once trained, the pattern is predicted perfectly
+		EXPECT_EQ(0, RunBranchPattern(branch_predictor, 0x1000, outcomes, 200));
+		EXPECT_EQ(1000, branch_predictor.getNumConditionalBranches());
+		EXPECT_LT(branch_predictor.getNumDirectionMispredictions(), 100);
+	}
+}
+
+
+TEST(TestBranchPredictor, test_tage_loop_predictor_1)
+{
+	// Loop with 100 iterations, longer than the longest TAGE history
+	std::vector<bool> outcomes;
+	for (int i = 0; i < 5000; i++)
+		outcomes.push_back(i % 100 != 99);
+
+	// Plain TAGE mispredicts every loop exit
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(
+			"[ BranchPredictor ]\n"
+			"Kind = TAGE\n"
+			"Tage.MaxHistory = 32");
+	BranchPredictor::ParseConfiguration(&ini_file);
+	BranchPredictor tage;
+	EXPECT_LE(10, RunBranchPattern(tage, 0x2000, outcomes, 1000));
+
+	// The loop predictor learns the iteration count
+	misc::IniFile ini_file_loop;
+	ini_file_loop.LoadFromString(
+			"[ BranchPredictor ]\n"
+			"Kind = TAGE\n"
+			"Tage.MaxHistory = 32\n"
+			"Tage.LoopPredictor = True");
+	BranchPredictor::ParseConfiguration(&ini_file_loop);
+	BranchPredictor tage_loop;
+	EXPECT_EQ(0, RunBranchPattern(tage_loop, 0x2000, outcomes, 1000));
+}
+
+
+TEST(TestBranchPredictor, test_perceptron_branch_predictor_1)
+{
+	// Alternating pattern
+	std::vector<bool> outcomes;
+	for (int i = 0; i < 1000; i++)
+		outcomes.push_back(i % 2);
+
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(
+			"[ BranchPredictor ]\n"
+			"Kind = Perceptron");
+	BranchPredictor::ParseConfiguration(&ini_file);
+	BranchPredictor branch_predictor;
+	EXPECT_EQ(0, RunBranchPattern(branch_predictor, 0x3000, outcomes, 200));
+	EXPECT_EQ(8 * 1024 + 128, branch_predictor.getStorageSize());
+}
+
 }
 
 
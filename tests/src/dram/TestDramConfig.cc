@@ -363,6 +363,91 @@ TEST(TestSystemConfiguration, section_invalid_format)
 			message.c_str());
 }
 
+TEST(TestSystemConfiguration, section_invalid_address_mapping)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// Setup configuration file
+	std::string config =
+			"[ General ]\n"
+			"AddressMapping = Controller:Channel:Bank:Bank:Row:Column\n"
+			"[MemoryController One]\n";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+
+	// Set up dram instance
+	System *dram_system = System::getInstance();
+	EXPECT_TRUE(dram_system != nullptr);
+
+	// Test body
+	std::string message;
+	try
+	{
+		dram_system->ParseConfiguration(&ini_file);
+	}
+	catch (misc::Error &error)
+	{
+		message = error.getMessage();
+	}
+
+	EXPECT_REGEX_MATCH(misc::fmt(".*%s:.*AddressMapping must contain.*\n.*",
+			ini_file.getPath().c_str()).c_str(),
+			message.c_str());
+}
+
+TEST(TestSystemConfiguration, section_line_columns)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// Fewer columns than the default LineColumns, without ColumnLow
+	std::string config =
+			"[ General ]\n"
+			"[MemoryController One]\n"
+			"NumColumns = 4\n";
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	System *dram_system = System::getInstance();
+	try
+	{
+		dram_system->ParseConfiguration(&ini_file);
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+
+	// The same configuration with ColumnLow
+	Cleanup();
+	config =
+			"[ General ]\n"
+			"AddressMapping = Controller:Channel:Rank:Bank:Row:"
+			"ColumnHigh:ColumnLow\n"
+			"[MemoryController One]\n"
+			"NumColumns = 4\n";
+	misc::IniFile ini_file_low;
+	ini_file_low.LoadFromString(config);
+	dram_system = System::getInstance();
+	std::string message;
+	try
+	{
+		dram_system->ParseConfiguration(&ini_file_low);
+	}
+	catch (misc::Error &error)
+	{
+		message = error.getMessage();
+	}
+
+	EXPECT_REGEX_MATCH(misc::fmt(".*%s:.*LineColumns must be a power "
+			"of 2 not larger than NumColumns.*\n.*",
+			ini_file_low.getPath().c_str()).c_str(),
+			message.c_str());
+}
+
 TEST(TestSystemConfiguration, section_invalid_vaiable)
 {
 	// Cleanup singleton instance
@@ -17,15 +17,19 @@
  *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
  */
 
+#include <array>
 #include <string>
 #include <regex>
+#include <sstream>
 #include <exception>
+#include <vector>
 
 #include <dram/Address.h>
 #include <dram/Bank.h>
 #include <dram/Channel.h>
 #include <dram/Controller.h>
 #include <dram/Rank.h>
+#include <dram/Request.h>
 #include <dram/System.h>
 #include <gtest/gtest.h>
 #include <lib/cpp/IniFile.h>
@@ -806,4 +810,349 @@ TEST(TestSystemEvents, section_test_address_out_of_bounds)
 	EXPECT_REGEX_MATCH(misc::fmt("Invalid Address").c_str(),
 			message.c_str());
 }
+
+// Submit requests straight to bank 0, with the given scheduling policy and
+// row hit cap, and return the type of the command at the front of the bank
+// queue after each cycle.
+static std::vector<std::string> RunBankRequests(const std::string &policy,
+		int row_hit_cap, const std::vector<long long> &addresses)
+{
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(zero_time_config +
+			"SchedulingPolicy = " + policy + "\n" +
+			misc::fmt("RowHitCap = %d\n", row_hit_cap));
+
+	// Set up dram instance
+	System *dram_system = System::getInstance();
+	dram_system->ParseConfiguration(&ini_file);
+	Bank *bank = dram_system->getController(0)->
+			getChannel(0)->getRank(0)->getBank(0);
+
+	// All requests reach the bank in the same cycle
+	for (long long address : addresses)
+	{
+		auto request = std::make_shared<Request>();
+		request->setType(RequestRead);
+		request->setEncodedAddress(address);
+		bank->ProcessRequest(request);
+	}
+
+	// Step through cycle by cycle, starting when the scheduler runs
+	std::vector<std::string> results;
+	esim::Engine *engine = esim::Engine::getInstance();
+	engine->ProcessEvents();
+	while (bank->getNumCommandsInQueue() > 0)
+	{
+		results.push_back(bank->getCommandInQueueType());
+		engine->ProcessEvents();
+	}
+	return results;
+}
+
+TEST(TestSystemEvents, section_fr_fcfs_row_hit_first)
+{
+	// cleanup singleton instance
+	Cleanup();
+
+	// The second access to row 0 is served before the access to row 1
+	std::vector<std::string> expected = { "Activate", "Read", "Read",
+		"Precharge", "Activate", "Read" };
+	std::vector<std::string> results;
+	try
+	{
+		results = RunBankRequests("FRFCFS", 4, { 0, 1024, 0 });
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+	EXPECT_TRUE(results == expected);
+}
+
+TEST(TestSystemEvents, section_fr_fcfs_row_hit_cap)
+{
+	// cleanup singleton instance
+	Cleanup();
+
+	// With a cap of 1, the access to row 1 goes after a single row hit,
+	// and the last access to row 0 finds row 1 open.
+	std::vector<std::string> expected = { "Activate", "Read", "Read",
+		"Precharge", "Activate", "Read", "Precharge", "Activate",
+		"Read" };
+	std::vector<std::string> results;
+	try
+	{
+		results = RunBankRequests("FRFCFS", 1, { 0, 1024, 0, 0 });
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+	EXPECT_TRUE(results == expected);
+
+	// Without the cap, the order of the oldest first scheduler is kept
+	Cleanup();
+	expected = { "Activate", "Read", "Precharge", "Activate", "Read",
+		"Precharge", "Activate", "Read" };
+	EXPECT_TRUE(RunBankRequests("FRFCFS", 0, { 0, 1024, 0 }) == expected);
+	Cleanup();
+	EXPECT_TRUE(RunBankRequests("OldestFirst", 4, { 0, 1024, 0 }) ==
+			expected);
+}
+
+TEST(TestSystemEvents, section_fr_fcfs_ready_first)
+{
+	// cleanup singleton instance
+	Cleanup();
+
+	try
+	{
+		// Set up INI file
+		misc::IniFile ini_file;
+		ini_file.LoadFromString(default_config +
+				"SchedulingPolicy = FRFCFS\n"
+				"RefreshPolicy = None\n"
+				"tCCD = 20\n");
+
+		// Set up dram instance
+		System *dram_system = System::getInstance();
+		dram_system->ParseConfiguration(&ini_file);
+		Rank *rank = dram_system->getController(0)->
+				getChannel(0)->getRank(0);
+		Bank *bank_0 = rank->getBank(0);
+		Bank *bank_1 = rank->getBank(1);
+
+		// Open row 0 of bank 0 with a first read
+		esim::Engine *engine = esim::Engine::getInstance();
+		auto request = std::make_shared<Request>();
+		request->setType(RequestRead);
+		request->setEncodedAddress(0);
+		bank_0->ProcessRequest(request);
+		while (bank_0->getNumCommandsInQueue() > 0)
+			engine->ProcessEvents();
+
+		// A row hit in bank 0, which waits for tCCD after the first
+		// read, and a row miss in bank 1, which can be activated now.
+		request = std::make_shared<Request>();
+		request->setType(RequestRead);
+		request->setEncodedAddress(0);
+		bank_0->ProcessRequest(request);
+		request = std::make_shared<Request>();
+		request->setType(RequestRead);
+		request->setEncodedAddress(1 << 20);
+		bank_1->ProcessRequest(request);
+
+		// The activation in bank 1 runs before the row hit
+		while (bank_0->getNumCommandsInQueue() > 0)
+			engine->ProcessEvents();
+		EXPECT_EQ("Read", bank_1->getCommandInQueueType());
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+// Run reads to the given addresses in the given cycles, until the last
+// cycle, and return the DRAM report.
+static std::string RunReport(const std::string &config,
+		const std::vector<std::pair<long long, long long>> &reads,
+		long long last_cycle, const std::string &general = "")
+{
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString("[ General ]\n"
+			"Frequency = 800\n" + general +
+			"[ MemoryController One ]\n" + config);
+
+	// Set up dram instance
+	System *dram_system = System::getInstance();
+	dram_system->ParseConfiguration(&ini_file);
+
+	// Run simulation
+	esim::Engine *engine = esim::Engine::getInstance();
+	auto it = reads.begin();
+	for (long long cycle = 0; cycle < last_cycle; cycle++)
+	{
+		while (it != reads.end() && it->first == cycle)
+			dram_system->Read((it++)->second);
+		engine->ProcessEvents();
+	}
+
+	// Report
+	std::ostringstream report;
+	dram_system->DumpReport(report);
+	return report.str();
+}
+
+// Return the value of a variable in a report section
+static std::string getReportValue(const std::string &report,
+		const std::string &section, const std::string &variable)
+{
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(report);
+	return ini_file.ReadString(section, variable);
+}
+
+TEST(TestSystemEvents, section_refresh_policies)
+{
+	// Two reads to the same row, with a refresh of bank 0 in between
+	// that closes the row, except without refresh. Refreshes run until
+	// cycle 1000, exclusive.
+	std::string section = "DRAM.One.Channel0.Rank0";
+	std::vector<std::pair<long long, long long>> reads = { { 0, 0 },
+			{ 500, 0 } };
+	try
+	{
+		// One refresh of all banks every 300 cycles
+		Cleanup();
+		std::string report = RunReport("tREFI = 300\n", reads, 1000);
+		EXPECT_EQ("24", getReportValue(report, section,
+				"BankRefreshes"));
+		EXPECT_EQ("2", getReportValue(report, section, "Activates"));
+		EXPECT_EQ("2", getReportValue(report, section, "Precharges"));
+
+		// One refresh of one bank every 100 cycles
+		Cleanup();
+		report = RunReport("RefreshPolicy = PerBank\n"
+				"tREFI = 800\n", reads, 1000);
+		EXPECT_EQ("9", getReportValue(report, section,
+				"BankRefreshes"));
+		EXPECT_EQ("2", getReportValue(report, section, "Activates"));
+
+		// No refresh
+		Cleanup();
+		report = RunReport("RefreshPolicy = None\n", reads, 1000);
+		EXPECT_EQ("0", getReportValue(report, section,
+				"BankRefreshes"));
+		EXPECT_EQ("1", getReportValue(report, section, "Activates"));
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+TEST(TestSystemEvents, section_power_down_energy)
+{
+	std::string section = "DRAM.One.Channel0.Rank0";
+	std::vector<std::pair<long long, long long>> reads = { { 0, 0 },
+			{ 500, 0 } };
+	try
+	{
+		// Without power-down
+		Cleanup();
+		std::string report = RunReport("RefreshPolicy = None\n",
+				reads, 1000);
+		EXPECT_EQ("0", getReportValue(report, section, "PowerDowns"));
+		EXPECT_EQ("0", getReportValue(report, section,
+				"ActivePowerDownCycles"));
+		double energy = std::stod(getReportValue(report, section,
+				"Energy"));
+
+		// Each read costs (IDD4R - IDD3N) * tBURST * VDD * tCK for
+		// each of the 8 devices.
+		EXPECT_EQ("12.3600", getReportValue(report, section,
+				"ReadEnergy"));
+
+		// The rank powers down twice with the row open, after each
+		// read finishes and stays idle for 50 cycles.
+		Cleanup();
+		report = RunReport("RefreshPolicy = None\n"
+				"PowerDownIdle = 50\n", reads, 1000);
+		EXPECT_EQ("2", getReportValue(report, section, "PowerDowns"));
+		EXPECT_NE("0", getReportValue(report, section,
+				"ActivePowerDownCycles"));
+		EXPECT_LT(std::stod(getReportValue(report, section, "Energy")),
+				energy);
+
+		// The other rank is idle, and powers down from the start
+		report = getReportValue(report, "DRAM.One.Channel0.Rank1",
+				"PrechargePowerDownCycles");
+		EXPECT_EQ("951", report);
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+TEST(TestSystemEvents, section_address_mapping)
+{
+	// Eight reads to consecutive rows of the default mapping, which are
+	// all in bank 0. Each row has 1024 columns.
+	std::string section = "DRAM.One.Channel0.Rank0";
+	std::vector<std::pair<long long, long long>> reads;
+	for (int i = 0; i < 8; i++)
+		reads.push_back({ i, i * 1024 });
+	try
+	{
+		// Default mapping
+		Cleanup();
+		std::string report = RunReport("RefreshPolicy = None\n",
+				reads, 1000);
+		EXPECT_EQ("8 0 0 0 0 0 0 0", getReportValue(report, section,
+				"BankRequests"));
+		EXPECT_EQ("16.00", getReportValue(report, "DRAM.One",
+				"BankImbalance"));
+
+		// Banks above the row
+		Cleanup();
+		report = RunReport("RefreshPolicy = None\n", reads, 1000,
+				"AddressMapping = Row:Controller:Channel:Rank:"
+				"Bank:Column\n");
+		EXPECT_EQ("1 1 1 1 1 1 1 1", getReportValue(report, section,
+				"BankRequests"));
+
+		// XOR bank hashing
+		Cleanup();
+		report = RunReport("RefreshPolicy = None\n", reads, 1000,
+				"BankHash = Xor\n");
+		EXPECT_EQ("1 1 1 1 1 1 1 1", getReportValue(report, section,
+				"BankRequests"));
+		EXPECT_EQ("2.00", getReportValue(report, "DRAM.One",
+				"BankImbalance"));
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+TEST(TestSystemEvents, section_cache_line_interleaving)
+{
+	// Two cache lines of 8 columns each, interleaved across two channels
+	std::string general = "AddressMapping = Row:Rank:Bank:ColumnHigh:"
+			"Controller:Channel:ColumnLow\n";
+	try
+	{
+		Cleanup();
+		std::string report = RunReport("NumChannels = 2\n"
+				"RefreshPolicy = None\n",
+				{ { 0, 0 }, { 0, 8 }, { 0, 16 } }, 1000, general);
+		EXPECT_EQ("2 0 0 0 0 0 0 0", getReportValue(report,
+				"DRAM.One.Channel0.Rank0", "BankRequests"));
+		EXPECT_EQ("1 0 0 0 0 0 0 0", getReportValue(report,
+				"DRAM.One.Channel1.Rank0", "BankRequests"));
+
+		// Columns of the second cache line in channel 0
+		Address address(16 + 3);
+		EXPECT_EQ(0, address.getLogical());
+		EXPECT_EQ(11, address.getColumn());
+		EXPECT_EQ(0, address.getRow());
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
 }
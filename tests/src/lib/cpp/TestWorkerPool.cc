@@ -0,0 +1,89 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/WorkerPool.h>
+
+
+namespace misc
+{
+
+// Every work item runs exactly once in every step
+TEST(TestWorkerPool, test_all_items_run_once)
+{
+	WorkerPool worker_pool(4);
+	EXPECT_EQ(4, worker_pool.getNumThreads());
+
+	std::vector<int> counts(100);
+	for (int step = 0; step < 50; step++)
+		worker_pool.Run(counts.size(), [&](int index)
+		{
+			counts[index]++;
+		});
+
+	for (int count : counts)
+		EXPECT_EQ(50, count);
+}
+
+// A pool with one thread runs work items sequentially in index order
+TEST(TestWorkerPool, test_sequential)
+{
+	WorkerPool worker_pool(1);
+	EXPECT_EQ(1, worker_pool.getNumThreads());
+
+	std::vector<int> order;
+	worker_pool.Run(10, [&](int index)
+	{
+		order.push_back(index);
+	});
+
+	ASSERT_EQ(10, (int) order.size());
+	for (int i = 0; i < 10; i++)
+		EXPECT_EQ(i, order[i]);
+}
+
+// Exceptions thrown by a work item reach the caller after the step
+// completes, and the pool remains usable
+TEST(TestWorkerPool, test_exception)
+{
+	WorkerPool worker_pool(3);
+
+	std::vector<int> counts(20);
+	EXPECT_THROW(worker_pool.Run(counts.size(), [&](int index)
+	{
+		counts[index]++;
+		if (index == 7)
+			throw Panic("Work item failed");
+	}), Panic);
+	for (int count : counts)
+		EXPECT_EQ(1, count);
+
+	worker_pool.Run(counts.size(), [&](int index)
+	{
+		counts[index]++;
+	});
+	for (int count : counts)
+		EXPECT_EQ(2, count);
+}
+
+}
@@ -0,0 +1,71 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <lib/esim/Engine.h>
+
+#include "Bench.h"
+
+
+namespace esim
+{
+
+// Number of events processed
+static long long num_events;
+
+// Event handler rescheduling itself at a varying distance, keeping the
+// event heap populated
+static void Handler(Event *event, Frame *frame)
+{
+	num_events++;
+	Engine *engine = Engine::getInstance();
+	engine->Next(event, 1 + num_events % 61);
+}
+
+
+// Schedule and dispatch events with 1000 events in flight
+static long long ScheduleDispatch(long long count)
+{
+	// Engine
+	Engine::Destroy();
+	Engine *engine = Engine::getInstance();
+	FrequencyDomain *frequency_domain = engine->RegisterFrequencyDomain(
+			"Bench", 1000);
+	Event *event = engine->RegisterEvent("bench", Handler,
+			frequency_domain);
+
+	// In-flight events
+	for (int i = 0; i < 1000; i++)
+		engine->Next(event, 1 + i % 61);
+
+	// Process events
+	num_events = 0;
+	while (num_events < count)
+		engine->ProcessEvents();
+	return num_events;
+}
+
+
+}  // namespace esim
+
+
+int main()
+{
+	bench::Run("esim.schedule_dispatch", "event", esim::ScheduleDispatch);
+	return 0;
+}
@@ -0,0 +1,109 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <sstream>
+
+#include <lib/esim/Engine.h>
+#include <lib/esim/Profiler.h>
+
+
+namespace esim
+{
+
+// Event handler entering a nested region
+static void ProfiledHandler(Event *event, Frame *frame)
+{
+	ProfilerScope scope(Profiler::getRegion("test.nested"));
+}
+
+
+TEST(TestProfiler, inactive)
+{
+	Profiler::setActive(false);
+	Profiler::Reset();
+	ProfilerRegion *region = Profiler::getRegion("test.inactive");
+	{
+		ProfilerScope scope(region);
+	}
+	EXPECT_EQ(0, region->getCount());
+	EXPECT_EQ(0, region->getTime());
+}
+
+
+TEST(TestProfiler, nested_regions)
+{
+	Profiler::setActive(true);
+	Profiler::Reset();
+	ProfilerRegion *outer = Profiler::getRegion("test.outer");
+	ProfilerRegion *inner = Profiler::getRegion("test.inner");
+	EXPECT_EQ(outer, Profiler::getRegion("test.outer"));
+	{
+		ProfilerScope outer_scope(outer);
+		for (int i = 0; i < 3; i++)
+			ProfilerScope inner_scope(inner);
+	}
+	Profiler::setActive(false);
+
+	// The time of the inner region is excluded from the self time of
+	// the outer region
+	EXPECT_EQ(1, outer->getCount());
+	EXPECT_EQ(3, inner->getCount());
+	EXPECT_GE(outer->getTime(), inner->getTime());
+	EXPECT_EQ(outer->getTime() - inner->getTime(), outer->getSelfTime());
+	EXPECT_EQ(inner->getTime(), inner->getSelfTime());
+}
+
+
+TEST(TestProfiler, event_handlers)
+{
+	// Set up esim engine
+	Engine::Destroy();
+	Engine *engine = Engine::getInstance();
+	FrequencyDomain *frequency_domain = engine->RegisterFrequencyDomain(
+			"Test frequency domain", 1000);
+	Event *event = engine->RegisterEvent("test_event", ProfiledHandler,
+			frequency_domain);
+
+	// Run the event in two cycles
+	Profiler::setActive(true);
+	Profiler::Reset();
+	engine->Next(event, 1);
+	engine->Next(event, 2);
+	for (int i = 0; i < 4; i++)
+		engine->ProcessEvents();
+	Profiler::setActive(false);
+
+	// Handler region
+	ProfilerRegion *region = Profiler::getEventRegion(event);
+	EXPECT_EQ("test_event", region->getName());
+	EXPECT_EQ(2, region->getCount());
+	EXPECT_EQ(2, Profiler::getRegion("test.nested")->getCount());
+
+	// Summary
+	std::ostringstream os;
+	Profiler::Dump(os, 4, 1000);
+	EXPECT_NE(std::string::npos, os.str().find("Events = 2\n"));
+	EXPECT_NE(std::string::npos, os.str().find("Event.test_event = "));
+	Engine::Destroy();
+}
+
+
+}  // namespace esim
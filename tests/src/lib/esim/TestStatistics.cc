@@ -0,0 +1,124 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/String.h>
+#include <lib/esim/Statistics.h>
+
+
+namespace esim
+{
+
+// Read the contents of a file
+static std::string ReadFile(const std::string &path)
+{
+	std::ifstream f(path, std::ios::binary);
+	return std::string(std::istreambuf_iterator<char>(f),
+			std::istreambuf_iterator<char>());
+}
+
+
+TEST(TestStatistics, inactive)
+{
+	// Counters registered while inactive are ignored
+	StatisticsRegistry::Destroy();
+	long long counter = 0;
+	StatisticsRegistry::Register("counter", &counter);
+	StatisticsRegistry::Update(1000000);
+	EXPECT_FALSE(StatisticsRegistry::getInstance()->isActive());
+	StatisticsRegistry::Destroy();
+}
+
+
+TEST(TestStatistics, csv)
+{
+	std::string path = misc::fmt("/tmp/m2s-test-stats-%d.csv",
+			(int) getpid());
+	StatisticsRegistry::Destroy();
+	StatisticsRegistry *registry = StatisticsRegistry::getInstance();
+	registry->setPath(path, 10);
+
+	// Register two counters
+	long long a = 5;
+	long long b = 0;
+	StatisticsRegistry::Register("a", &a);
+	StatisticsRegistry::Register("b", &b);
+
+	// Simulate cycles, sampling every 10 cycles
+	for (int cycle = 1; cycle <= 25; cycle++)
+	{
+		a += 2;
+		if (cycle % 5 == 0)
+			b++;
+		StatisticsRegistry::Update(cycle);
+	}
+
+	// Counters registered after the first sample are ignored
+	long long c = 0;
+	StatisticsRegistry::Register("c", &c);
+	registry->Finish(25);
+
+	EXPECT_EQ("cycle,a,b\n"
+			"10,20,2\n"
+			"20,20,2\n"
+			"25,10,1\n", ReadFile(path));
+	unlink(path.c_str());
+	StatisticsRegistry::Destroy();
+}
+
+
+TEST(TestStatistics, binary)
+{
+	std::string path = misc::fmt("/tmp/m2s-test-stats-%d.bin",
+			(int) getpid());
+	StatisticsRegistry::Destroy();
+	StatisticsRegistry *registry = StatisticsRegistry::getInstance();
+	registry->setPath(path, 100, true);
+
+	// One counter decreasing over the single interval
+	long long a = 10;
+	StatisticsRegistry::Register("a", &a);
+	a = 7;
+	registry->Finish(50);
+
+	// Header, last cycle, and zigzag-encoded -3
+	EXPECT_EQ(std::string("M2SSTATS\x01\x01" "a\x32\x05", 13),
+			ReadFile(path));
+	unlink(path.c_str());
+	StatisticsRegistry::Destroy();
+}
+
+
+TEST(TestStatistics, invalid_interval)
+{
+	StatisticsRegistry::Destroy();
+	StatisticsRegistry *registry = StatisticsRegistry::getInstance();
+	EXPECT_THROW(registry->setPath("/tmp/m2s-test-stats", 0),
+			misc::Error);
+	StatisticsRegistry::Destroy();
+}
+
+
+}  // namespace esim
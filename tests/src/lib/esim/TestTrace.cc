@@ -0,0 +1,355 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <unistd.h>
+#include <vector>
+#include <zlib.h>
+
+#include <lib/cpp/Misc.h>
+#include <lib/cpp/String.h>
+#include <lib/esim/Engine.h>
+#include <lib/esim/Trace.h>
+
+
+namespace esim
+{
+
+// Read the uncompressed contents of a trace file
+static std::string ReadTrace(const std::string &path)
+{
+	gzFile f = gzopen(path.c_str(), "rb");
+	EXPECT_NE(f, nullptr);
+	std::string contents;
+	char buf[4096];
+	int count;
+	while ((count = gzread(f, buf, sizeof buf)) > 0)
+		contents.append(buf, count);
+	gzclose(f);
+	return contents;
+}
+
+
+// Read a 64-bit little-endian integer from a file
+static long long ReadInt64(const std::string &file_contents, size_t pos)
+{
+	unsigned long long value = 0;
+	for (int i = 0; i < 8; i++)
+		value |= (unsigned long long) (unsigned char)
+				file_contents.at(pos + i) << (i * 8);
+	return value;
+}
+
+
+// Read the first bytes of the block starting at the given offset of a
+// trace file
+static std::string ReadBlockStart(const std::string &path, long long offset)
+{
+	FILE *f = fopen(path.c_str(), "rb");
+	EXPECT_NE(f, nullptr);
+	fseek(f, offset, SEEK_SET);
+	gzFile gz_file = gzdopen(dup(fileno(f)), "rb");
+	char buf[64];
+	int count = gzread(gz_file, buf, sizeof buf);
+	gzclose(gz_file);
+	fclose(f);
+	return std::string(buf, std::max(count, 0));
+}
+
+
+// Read an unsigned LEB128 integer
+static unsigned long long ReadVarInt(const std::string &s, size_t &pos)
+{
+	unsigned long long value = 0;
+	int shift = 0;
+	while (true)
+	{
+		unsigned char c = s.at(pos++);
+		value |= (unsigned long long) (c & 0x7f) << shift;
+		shift += 7;
+		if (!(c & 0x80))
+			return value;
+	}
+}
+
+
+// Decode a trace containing binary records into plain text
+static std::string Decode(const std::string &s)
+{
+	std::vector<std::string> strings;
+	std::string output;
+	size_t pos = 0;
+	while (pos < s.length())
+	{
+		// String definition
+		if (s[pos] == TraceEncoder::StringMarker)
+		{
+			pos++;
+			unsigned id = ReadVarInt(s, pos);
+			EXPECT_EQ(strings.size(), id);
+			int length = ReadVarInt(s, pos);
+			strings.push_back(s.substr(pos, length));
+			pos += length;
+			continue;
+		}
+
+		// Reset
+		if (s[pos] == TraceEncoder::ResetMarker)
+		{
+			pos++;
+			strings.clear();
+			continue;
+		}
+
+		// Plain text line
+		if (s[pos] != TraceEncoder::RecordMarker)
+		{
+			size_t end = s.find('\n', pos);
+			output += s.substr(pos, end + 1 - pos);
+			pos = end + 1;
+			continue;
+		}
+
+		// Record
+		pos++;
+		output += strings.at(ReadVarInt(s, pos));
+		int num_fields = ReadVarInt(s, pos);
+		for (int i = 0; i < num_fields; i++)
+		{
+			output += ' ' + strings.at(ReadVarInt(s, pos)) + '=';
+			char type = s.at(pos++);
+			unsigned long long value = 0;
+			int length = 0;
+			if (type == 'Q' || type == 'r')
+				length = ReadVarInt(s, pos);
+			else
+				value = ReadVarInt(s, pos);
+			switch (type)
+			{
+			case 'd':
+				output += misc::fmt("%lld", (long long) (value >> 1) ^
+						-(long long) (value & 1));
+				break;
+			case 'x':
+				output += misc::fmt("0x%llx", value);
+				break;
+			case 'q':
+				output += '"' + strings.at(value) + '"';
+				break;
+			case 'Q':
+				output += '"' + s.substr(pos, length) + '"';
+				pos += length;
+				break;
+			case 'r':
+				output += s.substr(pos, length);
+				pos += length;
+				break;
+			default:
+				ADD_FAILURE() << "invalid type " << type;
+				return output;
+			}
+		}
+		output += '\n';
+	}
+	return output;
+}
+
+
+TEST(TestTrace, encoder_record)
+{
+	TraceEncoder encoder;
+	std::string output;
+	std::string line = "x86.inst id=5 core=0 stg=\"wb\"\n";
+	encoder.Encode(line.c_str(), line.length(), output);
+
+	// Definitions of 'x86.inst', 'id', 'core', 'stg', and 'wb', followed
+	// by the record
+	std::string expected =
+			std::string("\x02\x00\x08x86.inst", 11) +
+			std::string("\x02\x01\x02id", 5) +
+			std::string("\x02\x02\x04" "core", 7) +
+			std::string("\x02\x03\x03stg", 6) +
+			std::string("\x02\x04\x02wb", 5) +
+			std::string("\x01\x00\x03"
+					"\x01" "d\x0a"
+					"\x02" "d\x00"
+					"\x03" "q\x04", 12);
+	EXPECT_EQ(expected, output);
+
+	// A second record only refers to existing strings
+	output.clear();
+	line = "x86.inst id=-1 core=1 stg=\"wb\"\n";
+	encoder.Encode(line.c_str(), line.length(), output);
+	EXPECT_EQ(std::string("\x01\x00\x03"
+			"\x01" "d\x01"
+			"\x02" "d\x02"
+			"\x03" "q\x04", 12), output);
+}
+
+
+TEST(TestTrace, encoder_plain_text)
+{
+	// Other commands, and lines that would not decode into the exact same
+	// text, are copied as plain text.
+	TraceEncoder encoder;
+	std::vector<std::string> lines = {
+		"c clk=10\n",
+		"mem.new_access name=\"A-1\" type=\"load\" state=\"mod:load\"\n",
+		"x86.inst\n",
+		"x86.inst  id=5\n",
+		"x86.inst id\n",
+		"si.inst id=5 asm=\"s_mov_b32\n",
+	};
+	for (const std::string &line : lines)
+	{
+		std::string output;
+		encoder.Encode(line.c_str(), line.length(), output);
+		EXPECT_EQ(line, output);
+	}
+}
+
+
+TEST(TestTrace, encoder_round_trip)
+{
+	TraceEncoder encoder;
+	std::string text =
+		"x86.inst id=0 core=0 stg=\"fe\"\n"
+		"mem.access name=\"A-12\" state=\"mod-l1-0:load_lock\"\n"
+		"si.inst id=9223 cu=3 wf=-17 uop_id=007 addr=0x1a40 "
+				"zero=0x0 pad=0x01 big=0xFF\n"
+		"si.inst id=1 asm=\"v_add_f32 v1, v2, v3 and a long operand "
+				"list\" x=abc-def e=\n"
+		"c clk=1\n"
+		"x86.inst id=123456789012 core=-0 stg=\"\"\n";
+	std::string output;
+	size_t start = 0;
+	while (start < text.length())
+	{
+		size_t end = text.find('\n', start) + 1;
+		encoder.Encode(text.c_str() + start, end - start, output);
+		start = end;
+	}
+	EXPECT_EQ(text, Decode(output));
+}
+
+
+TEST(TestTrace, trace_system)
+{
+	for (bool binary : { false, true })
+	{
+		// Set up esim engine
+		Engine::Destroy();
+		Engine *engine = Engine::getInstance();
+		engine->RegisterFrequencyDomain("Test frequency domain", 1000);
+
+		// Activate trace
+		std::string path = misc::fmt("/tmp/m2s-test-trace-%d.gz",
+				(int) getpid());
+		TraceSystem *trace_system = TraceSystem::getInstance();
+		trace_system->setPath(path, binary);
+		EXPECT_TRUE(trace_system->isActive());
+		EXPECT_EQ(binary, trace_system->isBinary());
+
+		// Write more data than fits in the ring of buffers, with lines
+		// crossing buffer boundaries
+		Trace trace;
+		trace.Header("init version=\"1.0\"\n");
+		std::string expected = "init version=\"1.0\"\n";
+		expected += "c clk=1\n";
+		for (int i = 0; i < 200000; i++)
+		{
+			std::string line = misc::fmt("x86.inst id=%d core=%d "
+					"stg=\"%s\"\n", i, i % 4,
+					i % 2 ? "fe" : "dec");
+			if (i && i % 1000 == 0)
+			{
+				engine->ProcessEvents();
+				expected += misc::fmt("c clk=%lld\n",
+						engine->getCycle());
+			}
+			trace << line;
+			expected += line;
+		}
+		trace << "mem.access name=\"A-1\" ";
+		trace << "state=\"mod:load\"\n";
+		expected += "mem.access name=\"A-1\" state=\"mod:load\"\n";
+		trace << 1234 << '\n';
+		expected += "1234\n";
+
+		// Close trace and check contents. The gzip reader decompresses
+		// all blocks as one stream, ignoring the index.
+		TraceSystem::Destroy();
+		Engine::Destroy();
+		std::string contents = ReadTrace(path);
+
+		// Check index
+		std::ifstream ifs(path, std::ios::binary);
+		std::string file_contents((std::istreambuf_iterator<char>(ifs)),
+				std::istreambuf_iterator<char>());
+		size_t size = file_contents.size();
+		ASSERT_GT(size, 24u);
+		EXPECT_EQ("M2STRIDX", file_contents.substr(size - 8));
+		long long num_blocks = ReadInt64(file_contents, size - 24);
+		long long index_offset = ReadInt64(file_contents, size - 16);
+		ASSERT_EQ(index_offset + 8 + num_blocks * 16 + 24, (long long) size);
+		EXPECT_EQ("M2STRIDX", file_contents.substr(index_offset, 8));
+		EXPECT_GT(num_blocks, 2);
+
+		// The first block is the header, and every other block starts
+		// with its cycle line
+		for (int i = 0; i < num_blocks; i++)
+		{
+			long long cycle = ReadInt64(file_contents,
+					index_offset + 8 + i * 16);
+			long long offset = ReadInt64(file_contents,
+					index_offset + 16 + i * 16);
+			std::string block_start = ReadBlockStart(path, offset);
+			if (!i)
+			{
+				EXPECT_EQ(-1, cycle);
+				EXPECT_EQ(0, offset);
+				EXPECT_EQ("init", block_start.substr(0, 4));
+				continue;
+			}
+			if (binary && i > 1)
+			{
+				EXPECT_EQ(TraceEncoder::ResetMarker, block_start[0]);
+				block_start = block_start.substr(1);
+			}
+			EXPECT_EQ(misc::fmt("c clk=%lld\n", cycle),
+					block_start.substr(0, block_start.find('\n') + 1));
+		}
+		unlink(path.c_str());
+		if (binary)
+		{
+			EXPECT_LT(contents.length(), expected.length() / 2);
+			contents = Decode(contents);
+		}
+		EXPECT_EQ(expected.length(), contents.length());
+		EXPECT_TRUE(expected == contents);
+
+	}
+}
+
+}
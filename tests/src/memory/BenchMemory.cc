@@ -0,0 +1,115 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdlib>
+#include <vector>
+
+#include <memory/Cache.h>
+#include <memory/Memory.h>
+
+#include "Bench.h"
+
+
+namespace mem
+{
+
+// Random addresses, the same for all runs
+static std::vector<unsigned> addresses;
+
+
+// Look up addresses in a 256-set, 8-way cache filled with half of the
+// blocks that the addresses map to
+static long long CacheFindBlock(long long count)
+{
+	// Cache
+	static Cache cache("bench", 256, 8, 64, Cache::ReplacementLRU,
+			Cache::WriteBack);
+	static bool initialized = false;
+	if (!initialized)
+	{
+		for (unsigned set_id = 0; set_id < 256; set_id++)
+			for (unsigned way_id = 0; way_id < 8; way_id++)
+				cache.setBlock(set_id, way_id,
+						(set_id + way_id * 2 * 256) * 64,
+						Cache::BlockExclusive);
+		initialized = true;
+	}
+
+	// Look up
+	long long num_hits = 0;
+	for (long long i = 0; i < count; i++)
+	{
+		unsigned set_id;
+		unsigned way_id;
+		Cache::BlockState state;
+		unsigned address = addresses[i & (addresses.size() - 1)];
+		num_hits += cache.FindBlock(address, set_id, way_id, state);
+	}
+
+	// Keep the result alive
+	if (num_hits < 0)
+		abort();
+	return count;
+}
+
+
+// Read and write 4-byte words at random addresses of a 1MB region
+static long long MemoryAccess(long long count)
+{
+	// Memory
+	static Memory memory;
+	static bool initialized = false;
+	if (!initialized)
+	{
+		memory.Map(0x10000000, 1 << 20, Memory::AccessRead |
+				Memory::AccessWrite);
+		initialized = true;
+	}
+
+	// Access
+	unsigned value = 0;
+	for (long long i = 0; i < count; i++)
+	{
+		unsigned address = 0x10000000 +
+				(addresses[i & (addresses.size() - 1)] &
+				((1 << 20) - 4));
+		if (i & 1)
+			memory.Write(address, 4, (const char *) &value);
+		else
+			memory.Read(address, 4, (char *) &value);
+		value++;
+	}
+	return count;
+}
+
+
+}  // namespace mem
+
+
+int main()
+{
+	// Addresses over 16 times the capacity of the cache, word-aligned
+	srandom(1);
+	for (int i = 0; i < 4096; i++)
+		mem::addresses.push_back((random() % (256 * 16 * 64)) & ~3);
+
+	bench::Run("mem.cache_find_block", "lookup", mem::CacheFindBlock);
+	bench::Run("mem.memory_access", "access", mem::MemoryAccess);
+	return 0;
+}
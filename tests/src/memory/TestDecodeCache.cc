@@ -0,0 +1,122 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <memory/DecodeCache.h>
+#include <memory/Memory.h>
+
+namespace mem
+{
+
+// Decoded instruction of the tests, holding the instruction word
+struct TestInst
+{
+	unsigned word = 0;
+};
+
+// Decode function of the tests, counting the number of decoded words
+static int num_decoded;
+static void DecodeTestInst(TestInst &inst, const char *buffer)
+{
+	inst.word = * (const unsigned *) buffer;
+	num_decoded++;
+}
+
+
+TEST(TestDecodeCache, hit_after_decode)
+{
+	Memory memory;
+	memory.Map(0x1000, Memory::PageSize, Memory::AccessRead |
+			Memory::AccessExec | Memory::AccessInit);
+	unsigned word = 0x12345678;
+	memory.Init(0x1004, 4, (const char *) &word);
+	DecodeCache<TestInst, 4> cache(&memory);
+
+	// First lookup decodes, second one hits
+	num_decoded = 0;
+	TestInst *inst = cache.Lookup(0x1004, DecodeTestInst);
+	ASSERT_TRUE(inst != nullptr);
+	EXPECT_EQ(0x12345678u, inst->word);
+	inst = cache.Lookup(0x1004, DecodeTestInst);
+	ASSERT_TRUE(inst != nullptr);
+	EXPECT_EQ(0x12345678u, inst->word);
+	EXPECT_EQ(1, num_decoded);
+	EXPECT_EQ(1, cache.getNumHits());
+	EXPECT_EQ(1, cache.getNumMisses());
+}
+
+
+TEST(TestDecodeCache, invalidate_on_write)
+{
+	Memory memory;
+	memory.Map(0x1000, 2 * Memory::PageSize, Memory::AccessRead |
+			Memory::AccessWrite | Memory::AccessExec);
+	DecodeCache<TestInst, 4> cache(&memory);
+	num_decoded = 0;
+	cache.Lookup(0x1000, DecodeTestInst);
+	cache.Lookup(0x2000, DecodeTestInst);
+
+	// Writing to the first page drops only its instructions
+	unsigned word = 0xdeadbeef;
+	memory.Write(0x1ffc, 4, (const char *) &word);
+	TestInst *inst = cache.Lookup(0x1000, DecodeTestInst);
+	EXPECT_EQ(0u, inst->word);
+	cache.Lookup(0x2000, DecodeTestInst);
+	EXPECT_EQ(3, num_decoded);
+	EXPECT_EQ(1, cache.getNumInvalidations());
+
+	// New contents are decoded
+	inst = cache.Lookup(0x1ffc, DecodeTestInst);
+	EXPECT_EQ(0xdeadbeefu, inst->word);
+}
+
+
+TEST(TestDecodeCache, invalidate_on_remap)
+{
+	Memory memory;
+	memory.Map(0x1000, Memory::PageSize, Memory::AccessRead |
+			Memory::AccessExec);
+	DecodeCache<TestInst, 4> cache(&memory);
+	num_decoded = 0;
+	cache.Lookup(0x1000, DecodeTestInst);
+
+	// A page mapped again at the same address is decoded again
+	memory.Unmap(0x1000, Memory::PageSize);
+	memory.Map(0x1000, Memory::PageSize, Memory::AccessRead |
+			Memory::AccessExec);
+	cache.Lookup(0x1000, DecodeTestInst);
+	EXPECT_EQ(2, num_decoded);
+}
+
+
+TEST(TestDecodeCache, no_exec_permission)
+{
+	Memory memory;
+	memory.setSafe(true);
+	memory.Map(0x1000, Memory::PageSize, Memory::AccessRead);
+	DecodeCache<TestInst, 4> cache(&memory);
+
+	// Unmapped pages and pages without execute permission are left to
+	// the regular fetch path
+	EXPECT_TRUE(cache.Lookup(0x1000, DecodeTestInst) == nullptr);
+	EXPECT_TRUE(cache.Lookup(0x8000, DecodeTestInst) == nullptr);
+}
+
+}  // namespace mem
@@ -0,0 +1,137 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <memory/Directory.h>
+
+namespace mem
+{
+
+TEST(TestDirectory, full_map)
+{
+	Directory directory("test", 4, 2, 1, 64);
+	EXPECT_EQ(Directory::EncodingFullMap, directory.getEncoding());
+
+	// Add sharers
+	for (int i = 0; i < 10; i++)
+		directory.setSharer(1, 1, 0, i * 6);
+	directory.setSharer(1, 1, 0, 6);
+	Directory::Entry *entry = directory.getEntry(1, 1, 0);
+	EXPECT_EQ(10, entry->getNumSharers());
+	EXPECT_FALSE(entry->isOverflow());
+	EXPECT_TRUE(directory.isSharer(1, 1, 0, 54));
+	EXPECT_FALSE(directory.isSharer(1, 1, 0, 55));
+
+	// Remove sharers
+	directory.clearSharer(1, 1, 0, 54);
+	EXPECT_EQ(9, entry->getNumSharers());
+	EXPECT_FALSE(directory.isSharer(1, 1, 0, 54));
+	directory.clearAllSharers(1, 1, 0);
+	EXPECT_EQ(0, entry->getNumSharers());
+	EXPECT_FALSE(directory.isBlockSharedOrOwned(1, 1));
+}
+
+
+TEST(TestDirectory, limited_pointer)
+{
+	Directory directory("test", 4, 2, 1, 64,
+			Directory::EncodingLimitedPointer, 2);
+
+	// Sharers fit in the pointers
+	directory.setSharer(2, 0, 0, 3);
+	directory.setSharer(2, 0, 0, 40);
+	directory.setSharer(2, 0, 0, 3);
+	Directory::Entry *entry = directory.getEntry(2, 0, 0);
+	EXPECT_EQ(2, entry->getNumSharers());
+	EXPECT_FALSE(entry->isOverflow());
+	EXPECT_TRUE(directory.isSharer(2, 0, 0, 40));
+	EXPECT_FALSE(directory.isSharer(2, 0, 0, 41));
+
+	// Removing a sharer frees its pointer
+	directory.clearSharer(2, 0, 0, 3);
+	EXPECT_EQ(1, entry->getNumSharers());
+	EXPECT_FALSE(directory.isSharer(2, 0, 0, 3));
+	EXPECT_TRUE(directory.isSharer(2, 0, 0, 40));
+	directory.setSharer(2, 0, 0, 5);
+	EXPECT_FALSE(entry->isOverflow());
+
+	// A third sharer overflows the pointers, and all nodes are considered
+	// sharers from then on.
+	directory.setSharer(2, 0, 0, 7);
+	EXPECT_TRUE(entry->isOverflow());
+	EXPECT_EQ(3, entry->getNumSharers());
+	EXPECT_TRUE(directory.isSharer(2, 0, 0, 63));
+	directory.clearSharer(2, 0, 0, 7);
+	EXPECT_TRUE(directory.isSharer(2, 0, 0, 7));
+
+	// Invalidating all sharers but one makes the entry exact again
+	directory.clearAllSharersExcept(2, 0, 0, 5);
+	EXPECT_FALSE(entry->isOverflow());
+	EXPECT_EQ(1, entry->getNumSharers());
+	EXPECT_TRUE(directory.isSharer(2, 0, 0, 5));
+	EXPECT_FALSE(directory.isSharer(2, 0, 0, 40));
+
+	// Other entries are not affected
+	EXPECT_EQ(0, directory.getEntry(2, 1, 0)->getNumSharers());
+	EXPECT_FALSE(directory.isSharer(2, 1, 0, 5));
+}
+
+
+TEST(TestDirectory, coarse_vector)
+{
+	// With 1 pointer of 16 bits and 64 nodes, each bit covers 4 nodes
+	Directory directory("test", 4, 2, 2, 64,
+			Directory::EncodingCoarseVector, 1);
+
+	// Overflow
+	directory.setSharer(0, 1, 1, 9);
+	directory.setSharer(0, 1, 1, 33);
+	Directory::Entry *entry = directory.getEntry(0, 1, 1);
+	EXPECT_TRUE(entry->isOverflow());
+	EXPECT_EQ(2, entry->getNumSharers());
+
+	// Nodes in the same group as a sharer are considered sharers
+	EXPECT_TRUE(directory.isSharer(0, 1, 1, 8));
+	EXPECT_TRUE(directory.isSharer(0, 1, 1, 11));
+	EXPECT_TRUE(directory.isSharer(0, 1, 1, 32));
+	EXPECT_FALSE(directory.isSharer(0, 1, 1, 12));
+	EXPECT_FALSE(directory.isSharer(0, 1, 1, 0));
+	EXPECT_TRUE(directory.isBlockSharedOrOwned(0, 1));
+
+	// Invalidating all sharers clears the entry
+	directory.clearAllSharersExcept(0, 1, 1, -1);
+	EXPECT_FALSE(entry->isOverflow());
+	EXPECT_EQ(0, entry->getNumSharers());
+	EXPECT_FALSE(directory.isSharer(0, 1, 1, 9));
+	EXPECT_FALSE(directory.isBlockSharedOrOwned(0, 1));
+}
+
+
+TEST(TestDirectory, storage_size)
+{
+	// Pointers use less storage than a full map with many nodes
+	Directory full_map("test", 256, 16, 1, 1024);
+	Directory limited_pointer("test", 256, 16, 1, 1024,
+			Directory::EncodingLimitedPointer, 4);
+	EXPECT_LT(limited_pointer.getStorageSize() * 4,
+			full_map.getStorageSize());
+}
+
+}
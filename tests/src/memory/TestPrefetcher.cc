@@ -0,0 +1,321 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <arch/x86/timing/Timing.h>
+#include <arch/common/Arch.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/Error.h>
+#include <lib/esim/Engine.h>
+#include <memory/System.h>
+#include <memory/Module.h>
+#include <network/System.h>
+
+namespace mem
+{
+
+// Configuration with one L1 cache and main memory. The prefetcher of the
+// L1 cache geometry is appended by each test.
+const std::string mem_config_prefetcher =
+		"[Module mod-l1-0]\n"
+		"Type = Cache\n"
+		"Geometry = geo-l1\n"
+		"LowNetwork = l1-mm\n"
+		"LowModules = mod-mm\n"
+		"\n"
+		"[Module mod-mm]\n"
+		"Type = MainMemory\n"
+		"BlockSize = 64\n"
+		"Latency = 200\n"
+		"HighNetwork = l1-mm\n"
+		"\n"
+		"[Entry core-0]\n"
+		"Arch = x86\n"
+		"Core = 0\n"
+		"Thread = 0\n"
+		"DataModule = mod-l1-0\n"
+		"InstModule = mod-l1-0\n"
+		"\n"
+		"[Network l1-mm]\n"
+		"DefaultInputBufferSize = 1024\n"
+		"DefaultOutputBufferSize = 1024\n"
+		"DefaultBandwidth = 256\n"
+		"\n"
+		"[CacheGeometry geo-l1]\n"
+		"Sets = 64\n"
+		"Assoc = 4\n"
+		"BlockSize = 64\n"
+		"Latency = 2\n"
+		"MSHR = 8\n"
+		"Ports = 2\n";
+
+const std::string x86_config_prefetcher =
+		"[ General ]\n"
+		"Cores = 1\n"
+		"Threads = 1\n";
+
+static void Cleanup()
+{
+	esim::Engine::Destroy();
+
+	net::System::Destroy();
+
+	System::Destroy();
+
+	x86::Timing::Destroy();
+
+	comm::ArchPool::Destroy();
+}
+
+// Set up the memory system with the given prefetcher configuration for the
+// L1 cache, and return the L1 module.
+static Module *SetUpPrefetcher(const std::string &prefetcher_config)
+{
+	// Cleanup singleton instances
+	Cleanup();
+
+	// Load configuration files
+	misc::IniFile ini_file_mem;
+	misc::IniFile ini_file_x86;
+	ini_file_mem.LoadFromString(mem_config_prefetcher + prefetcher_config);
+	ini_file_x86.LoadFromString(x86_config_prefetcher);
+
+	// Set up x86 timing simulator
+	x86::Timing::ParseConfiguration(&ini_file_x86);
+	x86::Timing::getInstance();
+
+	// Set up memory system
+	System *memory_system = System::getInstance();
+	memory_system->ReadConfiguration(&ini_file_mem);
+	return memory_system->getModule("mod-l1-0");
+}
+
+// Run the simulation until all prefetches have completed
+static void Drain(Module *module)
+{
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	while (module->getPrefetcher()->getNumInFlight())
+		esim_engine->ProcessEvents();
+}
+
+// Run one load to the given address in the module until it completes,
+// together with the prefetches it triggers.
+static void Load(Module *module, unsigned address)
+{
+	int witness = -1;
+	module->Access(Module::AccessLoad, address, &witness);
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	while (witness < 0)
+		esim_engine->ProcessEvents();
+	Drain(module);
+}
+
+
+TEST(TestPrefetcher, config_invalid_kind)
+{
+	std::string actual_str;
+	try
+	{
+		SetUpPrefetcher("Prefetcher = anything\n");
+	}
+	catch (misc::Error &actual_error)
+	{
+		actual_str = actual_error.getMessage();
+	}
+
+	EXPECT_REGEX_MATCH(".*: Cache mod-l1-0: anything: "
+			"Invalid prefetcher.\n.*",
+			actual_str.c_str());
+}
+
+
+TEST(TestPrefetcher, config_max_in_flight)
+{
+	std::string actual_str;
+	try
+	{
+		SetUpPrefetcher("Prefetcher = NextLine\n"
+				"PrefetcherMaxInFlight = 9\n");
+	}
+	catch (misc::Error &actual_error)
+	{
+		actual_str = actual_error.getMessage();
+	}
+
+	EXPECT_REGEX_MATCH(".*: cache mod-l1-0: invalid value for "
+			"variable 'PrefetcherMaxInFlight'.\n.*",
+			actual_str.c_str());
+}
+
+
+// Sequential loads with a next-line prefetcher of degree 2. The first load
+// misses and prefetches the next two blocks, and every following load hits
+// a prefetched block, which in turn prefetches the next block.
+TEST(TestPrefetcher, next_line)
+{
+	try
+	{
+		Module *module = SetUpPrefetcher("Prefetcher = NextLine\n"
+				"PrefetcherDegree = 2\n");
+		ASSERT_NE(module, nullptr);
+		Prefetcher *prefetcher = module->getPrefetcher();
+		ASSERT_NE(prefetcher, nullptr);
+		EXPECT_EQ(Prefetcher::KindNextLine, prefetcher->getKind());
+
+		// Accesses
+		for (unsigned address = 0; address < 0x200; address += 0x40)
+			Load(module, address);
+		Drain(module);
+
+		// Check statistics
+		EXPECT_EQ(1, module->num_read_misses);
+		EXPECT_EQ(7, module->num_read_hits);
+		EXPECT_EQ(9, prefetcher->getNumIssued());
+		EXPECT_EQ(7, prefetcher->getNumUseful());
+		EXPECT_EQ(0, prefetcher->getNumLate());
+
+		// The last two prefetched blocks were not used yet
+		int set;
+		int way;
+		int tag;
+		Cache::BlockState state;
+		ASSERT_TRUE(module->FindBlock(0x200, set, way, tag, state));
+		EXPECT_TRUE(module->getCache()->getBlock(set, way)->isPrefetched());
+		ASSERT_TRUE(module->FindBlock(0x1c0, set, way, tag, state));
+		EXPECT_FALSE(module->getCache()->getBlock(set, way)->isPrefetched());
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
+// A demand load arriving while the prefetch of its block is still in flight
+// waits for it, and is counted as a late prefetch.
+TEST(TestPrefetcher, next_line_late)
+{
+	try
+	{
+		Module *module = SetUpPrefetcher("Prefetcher = NextLine\n"
+				"PrefetcherDegree = 1\n");
+		ASSERT_NE(module, nullptr);
+		Prefetcher *prefetcher = module->getPrefetcher();
+		ASSERT_NE(prefetcher, nullptr);
+
+		// First access, triggering a prefetch of block 0x40
+		int witness = -2;
+		module->Access(Module::AccessLoad, 0x0, &witness);
+		esim::Engine *esim_engine = esim::Engine::getInstance();
+		for (int i = 0; i < 20; i++)
+			esim_engine->ProcessEvents();
+		EXPECT_EQ(1, prefetcher->getNumInFlight());
+
+		// Second access to the block being prefetched
+		module->Access(Module::AccessLoad, 0x40, &witness);
+		while (witness < 0)
+			esim_engine->ProcessEvents();
+		Drain(module);
+
+		// Check statistics
+		EXPECT_EQ(1, prefetcher->getNumUseful());
+		EXPECT_EQ(1, prefetcher->getNumLate());
+
+		// The block used by the demand access is not flagged
+		int set;
+		int way;
+		int tag;
+		Cache::BlockState state;
+		ASSERT_TRUE(module->FindBlock(0x40, set, way, tag, state));
+		EXPECT_FALSE(module->getCache()->getBlock(set, way)->isPrefetched());
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
+// Loads with a stride of 3 blocks within a page. The stride prefetcher
+// needs three accesses to confirm the stride, and then covers every
+// following access.
+TEST(TestPrefetcher, stride)
+{
+	try
+	{
+		Module *module = SetUpPrefetcher("Prefetcher = Stride\n"
+				"PrefetcherDegree = 1\n");
+		ASSERT_NE(module, nullptr);
+		Prefetcher *prefetcher = module->getPrefetcher();
+		ASSERT_NE(prefetcher, nullptr);
+
+		// Accesses
+		for (unsigned address = 0; address < 0x1000; address += 0xc0)
+			Load(module, address);
+		Drain(module);
+
+		// Check statistics. Of the 22 accesses, the first 4 miss, and
+		// the block following the last access is in the next page, so
+		// it is not prefetched.
+		EXPECT_EQ(4, module->num_read_misses);
+		EXPECT_EQ(18, prefetcher->getNumUseful());
+		EXPECT_EQ(18, prefetcher->getNumIssued());
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+
+// Descending loads with a stream prefetcher. The stream is detected after
+// two adjacent misses, and runs ahead of the demand accesses.
+TEST(TestPrefetcher, stream)
+{
+	try
+	{
+		Module *module = SetUpPrefetcher("Prefetcher = Stream\n"
+				"PrefetcherDegree = 2\n"
+				"PrefetcherDistance = 4\n");
+		ASSERT_NE(module, nullptr);
+		Prefetcher *prefetcher = module->getPrefetcher();
+		ASSERT_NE(prefetcher, nullptr);
+
+		// Accesses
+		for (int address = 0xfc0; address >= 0xc00; address -= 0x40)
+			Load(module, address);
+		Drain(module);
+
+		// Check statistics
+		EXPECT_EQ(2, module->num_read_misses);
+		EXPECT_EQ(14, prefetcher->getNumUseful());
+		EXPECT_EQ(0, prefetcher->getNumLate());
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
+}
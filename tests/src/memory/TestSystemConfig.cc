@@ -469,6 +469,50 @@ TEST(TestSystemConfiguration, section_module_cache_directory_latency)
 }
 
 
+TEST(TestSystemConfiguration, section_module_directory_encoding)
+{
+	// Cleanup singleton instances
+	Cleanup();
+
+	// Setup configuration file
+	std::string config =
+		"[ General ]\n"
+		"Frequency = 1000\n"
+		"[ Module test ]\n"
+		"Type = Cache\n"
+		"Geometry = cacheTest\n"
+		"DirectoryEncoding = anything\n"
+		"[ CacheGeometry cacheTest ]\n"
+		"Sets = 16\n"
+		"Assoc = 2\n"
+		"BlockSize = 64\n"
+		"Latency = 1";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+
+	// Set up memory system instance
+	System *memory_system = System::getInstance();
+
+	// Test body
+	std::string actual_str;
+	try
+	{
+		memory_system->ReadConfiguration(&ini_file);
+	}
+	catch (misc::Error &actual_error)
+	{
+		actual_str = actual_error.getMessage();
+	}
+
+	EXPECT_REGEX_MATCH(misc::fmt("%s: test: anything: invalid value for "
+			"variable 'DirectoryEncoding'.\n.*",
+			ini_file.getPath().c_str()).c_str(),
+			actual_str.c_str());
+}
+
+
 TEST(TestSystemConfiguration, section_module_cache_latency)
 {
 	// Cleanup singleton instances
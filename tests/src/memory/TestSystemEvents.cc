@@ -4618,6 +4618,123 @@ TEST(TestSystemEvents, config_1_evict_0)
 	}
 }
 
+// All four l1 modules read address 0, which overflows the single sharer
+// pointer of the directories of l2_0, l2_1, and l3. Then l1_0 writes
+// address 0, and the broadcast invalidation must reach every sharer.
+TEST(TestSystemEvents, config_1_limited_pointer_overflow)
+{
+	try
+	{
+		// Cleanup singleton instances
+		Cleanup();
+
+		// Load configuration files, with one sharer pointer per entry
+		misc::IniFile ini_file_mem_1;
+		misc::IniFile ini_file_x86;
+		misc::IniFile ini_file_net_1;
+		ini_file_mem_1.LoadFromString(mem_config_1);
+		ini_file_x86.LoadFromString(x86_config);
+		ini_file_net_1.LoadFromString(net_config_1);
+		for (std::string name : { "mod-l2-0", "mod-l2-1", "mod-l3" })
+		{
+			ini_file_mem_1.WriteString("Module " + name,
+					"DirectoryEncoding", "LimitedPointer");
+			ini_file_mem_1.WriteInt("Module " + name,
+					"DirectoryPointers", 1);
+		}
+
+		// Set up x86 timing simulator
+		x86::Timing::ParseConfiguration(&ini_file_x86);
+		x86::Timing::getInstance();
+
+		// Set up network system
+		net::System *network_system = net::System::getInstance();
+		network_system->ParseConfiguration(&ini_file_net_1);
+
+		// Set up memory system
+		System *memory_system = System::getInstance();
+		memory_system->ReadConfiguration(&ini_file_mem_1);
+
+		// Get modules
+		Module *module_l1[4];
+		for (int i = 0; i < 4; i++)
+		{
+			module_l1[i] = memory_system->getModule(
+					misc::fmt("mod-l1-%d", i));
+			ASSERT_NE(module_l1[i], nullptr);
+		}
+		Module *module_l2_0 = memory_system->getModule("mod-l2-0");
+		Module *module_l2_1 = memory_system->getModule("mod-l2-1");
+		Module *module_l3 = memory_system->getModule("mod-l3");
+		ASSERT_NE(module_l2_0, nullptr);
+		ASSERT_NE(module_l2_1, nullptr);
+		ASSERT_NE(module_l3, nullptr);
+
+		// Loads, one at a time
+		esim::Engine *esim_engine = esim::Engine::getInstance();
+		for (int i = 0; i < 4; i++)
+		{
+			int witness = -1;
+			module_l1[i]->Access(Module::AccessLoad, 0x0, &witness);
+			while (witness < 0)
+				esim_engine->ProcessEvents();
+		}
+
+		// Check overflow
+		EXPECT_TRUE(module_l2_0->getDirectory()->getEntry(0, 0, 0)->
+				isOverflow());
+		EXPECT_TRUE(module_l2_1->getDirectory()->getEntry(0, 0, 0)->
+				isOverflow());
+		EXPECT_TRUE(module_l3->getDirectory()->getEntry(0, 0, 0)->
+				isOverflow());
+
+		// Store. The witness of a store is incremented as soon as its
+		// write request is sent, so give the invalidations time to
+		// complete.
+		int witness = -1;
+		module_l1[0]->Access(Module::AccessStore, 0x0, &witness);
+		while (witness < 0)
+			esim_engine->ProcessEvents();
+		for (int cycle = 0; cycle < 1000; cycle++)
+			esim_engine->ProcessEvents();
+
+		// Check block
+		unsigned tag;
+		Cache::BlockState state;
+		module_l1[0]->getCache()->getBlock(0, 0, tag, state);
+		EXPECT_EQ(tag, 0x0);
+		EXPECT_EQ(state, Cache::BlockModified);
+
+		// Check blocks of the other sharers
+		for (int i = 1; i < 4; i++)
+		{
+			module_l1[i]->getCache()->getBlock(0, 0, tag, state);
+			EXPECT_EQ(state, Cache::BlockInvalid);
+		}
+		module_l2_1->getCache()->getBlock(0, 0, tag, state);
+		EXPECT_EQ(state, Cache::BlockInvalid);
+
+		// Check sharers, exact again after the invalidation
+		EXPECT_FALSE(module_l2_0->getDirectory()->getEntry(0, 0, 0)->
+				isOverflow());
+		EXPECT_EQ(module_l2_0->getNumSharers(0, 0, 0), 1);
+		EXPECT_EQ(module_l2_0->isSharer(0, 0, 0, module_l1[0]), true);
+		EXPECT_FALSE(module_l3->getDirectory()->getEntry(0, 0, 0)->
+				isOverflow());
+		EXPECT_EQ(module_l3->getNumSharers(0, 0, 0), 1);
+		EXPECT_EQ(module_l3->isSharer(0, 0, 0, module_l2_0), true);
+
+		// Check owner
+		EXPECT_EQ(module_l2_0->getOwner(0, 0, 0), module_l1[0]);
+		EXPECT_EQ(module_l3->getOwner(0, 0, 0), module_l2_0);
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
 /* TODO: This test will be added again when the support for the test
 is provided in the multi2sim 
 TEST(TestSystemEvents, test_flood)
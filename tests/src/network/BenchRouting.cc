@@ -0,0 +1,209 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Rafael Ubal (ubal@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/String.h>
+#include <lib/esim/Engine.h>
+#include <network/EndNode.h>
+#include <network/Network.h>
+#include <network/RoutingTable.h>
+#include <network/System.h>
+
+#include "Bench.h"
+
+
+namespace net
+{
+
+// Mesh size
+static const int mesh_size = 4;
+
+// Mesh size of the network used to measure route computation
+static const int large_mesh_size = 16;
+
+// Size of the messages sent
+static const int message_size = 16;
+
+
+// Return the configuration of network 'name', a mesh of switches with one
+// end node per switch
+static std::string getMeshConfig(const std::string &name, int size)
+{
+	// Nodes
+	std::string config = misc::fmt(
+			"[ Network.%s ]\n"
+			"DefaultInputBufferSize = 64\n"
+			"DefaultOutputBufferSize = 64\n"
+			"DefaultBandwidth = 8\n", name.c_str());
+	int num_switches = size * size;
+	for (int i = 0; i < num_switches; i++)
+		config += misc::fmt("[ Network.%s.Node.n%d ]\n"
+				"Type = EndNode\n"
+				"[ Network.%s.Node.s%d ]\n"
+				"Type = Switch\n",
+				name.c_str(), i, name.c_str(), i);
+
+	// Links
+	for (int i = 0; i < num_switches; i++)
+	{
+		config += misc::fmt("[ Network.%s.Link.n%d-s%d ]\n"
+				"Type = Bidirectional\n"
+				"Source = n%d\n"
+				"Dest = s%d\n", name.c_str(), i, i, i, i);
+		if (i % size < size - 1)
+			config += misc::fmt("[ Network.%s.Link.s%d-s%d ]\n"
+					"Type = Bidirectional\n"
+					"Source = s%d\n"
+					"Dest = s%d\n", name.c_str(),
+					i, i + 1, i, i + 1);
+		if (i + size < num_switches)
+			config += misc::fmt("[ Network.%s.Link.s%d-s%d ]\n"
+					"Type = Bidirectional\n"
+					"Source = s%d\n"
+					"Dest = s%d\n", name.c_str(),
+					i, i + size, i, i + size);
+	}
+	return config;
+}
+
+
+// Return the network used to measure routing and packet delivery
+static Network *getNetwork()
+{
+	// Network already created
+	static Network *network;
+	if (network)
+		return network;
+
+	// Both networks, created together since the system parses the
+	// configuration only once
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(getMeshConfig("net0", mesh_size) +
+			getMeshConfig("net1", large_mesh_size));
+	System *system = System::getInstance();
+	system->ParseConfiguration(&ini_file);
+	network = system->getNetworkByName("net0");
+	return network;
+}
+
+
+// Return the end nodes of the network
+static const std::vector<EndNode *> &getEndNodes()
+{
+	static std::vector<EndNode *> end_nodes;
+	if (end_nodes.empty())
+	{
+		Network *network = getNetwork();
+		for (int i = 0; i < network->getNumNodes(); i++)
+		{
+			EndNode *node = dynamic_cast<EndNode *>(
+					network->getNode(i));
+			if (node)
+				end_nodes.push_back(node);
+		}
+	}
+	return end_nodes;
+}
+
+
+// Follow the route between random pairs of end nodes, hop by hop
+static long long RouteLookup(long long count)
+{
+	Network *network = getNetwork();
+	RoutingTable *routing_table = network->getRoutingTable();
+	const std::vector<EndNode *> &end_nodes = getEndNodes();
+	long long num_hops = 0;
+	while (num_hops < count)
+	{
+		Node *node = end_nodes[random() % end_nodes.size()];
+		Node *destination = end_nodes[random() % end_nodes.size()];
+		while (node != destination)
+		{
+			node = routing_table->Lookup(node, destination)->
+					getNextNode();
+			num_hops++;
+		}
+	}
+	return num_hops;
+}
+
+
+// Compute the routes between all pairs of nodes of the large mesh
+static long long RouteComputation(long long count)
+{
+	getNetwork();
+	Network *network = System::getInstance()->getNetworkByName("net1");
+	long long num_routes = 0;
+	while (num_routes < count)
+	{
+		RoutingTable routing_table(network);
+		routing_table.ComputeRoutes();
+		num_routes += (long long) network->getNumNodes() *
+				network->getNumNodes();
+	}
+	return num_routes;
+}
+
+
+// Deliver messages between random pairs of end nodes, with every end node
+// injecting one message every 8 cycles
+static long long PacketDelivery(long long count)
+{
+	Network *network = getNetwork();
+	const std::vector<EndNode *> &end_nodes = getEndNodes();
+	esim::Engine *engine = esim::Engine::getInstance();
+	long long num_transfers = network->getNumTransfers();
+	long long cycle = 0;
+	while (network->getNumTransfers() - num_transfers < count)
+	{
+		for (unsigned i = 0; i < end_nodes.size(); i++)
+		{
+			if ((cycle + i) % 8)
+				continue;
+			EndNode *source = end_nodes[i];
+			EndNode *destination = end_nodes[random() %
+					end_nodes.size()];
+			if (destination != source && network->CanSend(source,
+					destination, message_size))
+				network->Send(source, destination,
+						message_size);
+		}
+		engine->ProcessEvents();
+		cycle++;
+	}
+	return network->getNumTransfers() - num_transfers;
+}
+
+
+}  // namespace net
+
+
+int main()
+{
+	srandom(1);
+	bench::Run("net.route_lookup", "hop", net::RouteLookup);
+	bench::Run("net.route_computation", "route",
+			net::RouteComputation);
+	bench::Run("net.packet_delivery", "msg", net::PacketDelivery);
+	return 0;
+}
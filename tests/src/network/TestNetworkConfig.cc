@@ -2413,47 +2413,47 @@ TEST(TestSystemConfiguration, thorough_manual_routing)
 
 		// Checking the table one entry at a time -- N0 to N1
 		RoutingTable::Entry *entry = table->RoutingTable::Lookup(N0, N1);
-		EXPECT_EQ(entry->cost, 3);
+		EXPECT_EQ(table->getCost(N0, N1), 3);
 		EXPECT_EQ(entry->getNextNode(), S0);
 		entry = table->RoutingTable::Lookup(S0, N1);
-		EXPECT_EQ(entry->cost, 2);
+		EXPECT_EQ(table->getCost(S0, N1), 2);
 		EXPECT_EQ(entry->getNextNode(), S1);
 		Connection *connection = entry->getBuffer()->getConnection();
 		EXPECT_EQ(entry->getBuffer(), connection->getSourceBuffer(0));
 		entry = table->RoutingTable::Lookup(S1, N1);
-		EXPECT_EQ(entry->cost, 1);
+		EXPECT_EQ(table->getCost(S1, N1), 1);
 		EXPECT_EQ(entry->getNextNode(), N1);
 
 		// Checking the table one entry at a time -- N1 to N4
 		entry = table->RoutingTable::Lookup(N1, N4);
-		EXPECT_EQ(entry->cost, 5);
+		EXPECT_EQ(table->getCost(N1, N4), 5);
 		EXPECT_EQ(entry->getNextNode(), S1);
 		entry = table->RoutingTable::Lookup(S1, N4);
-		EXPECT_EQ(entry->cost, 4);
+		EXPECT_EQ(table->getCost(S1, N4), 4);
 		EXPECT_EQ(entry->getNextNode(), S2);
 		connection = entry->getBuffer()->getConnection();
 		EXPECT_EQ(entry->getBuffer(), connection->getSourceBuffer(1));
 		entry = table->RoutingTable::Lookup(S2, N4);
-		EXPECT_EQ(entry->cost, 3);
+		EXPECT_EQ(table->getCost(S2, N4), 3);
 		EXPECT_EQ(entry->getNextNode(), S3);
 		entry = table->RoutingTable::Lookup(S3, N4);
-		EXPECT_EQ(entry->cost, 2);
+		EXPECT_EQ(table->getCost(S3, N4), 2);
 		EXPECT_EQ(entry->getNextNode(), S4);
 		entry = table->RoutingTable::Lookup(S4, N4);
-		EXPECT_EQ(entry->cost, 1);
+		EXPECT_EQ(table->getCost(S4, N4), 1);
 		EXPECT_EQ(entry->getNextNode(), N4);
 
 		// Checking the table on entry at a time -- N3 to N2
 		entry = table->RoutingTable::Lookup(N3, N2);	
-		EXPECT_EQ(entry->cost, 3);
+		EXPECT_EQ(table->getCost(N3, N2), 3);
 		EXPECT_EQ(entry->getNextNode(), S3);
 		entry = table->RoutingTable::Lookup(S3, N2);
-		EXPECT_EQ(entry->cost, 2);
+		EXPECT_EQ(table->getCost(S3, N2), 2);
 		EXPECT_EQ(entry->getNextNode(), S2);
 		connection = entry->getBuffer()->getConnection();
 		EXPECT_EQ(entry->getBuffer(), connection->getSourceBuffer(0));
 		entry = table->RoutingTable::Lookup(S2, N2);
-		EXPECT_EQ(entry->cost, 1);
+		EXPECT_EQ(table->getCost(S2, N2), 1);
 		EXPECT_EQ(entry->getNextNode(), N2);
 	}
 	catch (misc::Error &e)
@@ -2463,4 +2463,78 @@ TEST(TestSystemConfiguration, thorough_manual_routing)
 	}
 }
 
+TEST(TestSystemConfiguration, automatic_routing_ring)
+{
+	// Cleanup singleton instance
+	Cleanup();
+
+	// Ring of 6 switches, each with one end node, and 2 virtual
+	// channels between switches s0 and s1
+	std::string config =
+			"[ Network.net0 ]\n"
+			"DefaultInputBufferSize = 4\n"
+			"DefaultOutputBufferSize = 4\n"
+			"DefaultBandwidth = 1\n";
+	for (int i = 0; i < 6; i++)
+		config += misc::fmt("[Network.net0.Node.n%d]\n"
+				"Type = EndNode\n"
+				"[Network.net0.Node.s%d]\n"
+				"Type = Switch\n"
+				"[Network.net0.Link.n%d-s%d]\n"
+				"Type = Bidirectional\n"
+				"Source = n%d\n"
+				"Dest = s%d\n"
+				"[Network.net0.Link.s%d-s%d]\n"
+				"Type = Bidirectional\n"
+				"Source = s%d\n"
+				"Dest = s%d\n"
+				"VC = %d\n",
+				i, i, i, i, i, i, i, (i + 1) % 6,
+				i, (i + 1) % 6, i ? 1 : 2);
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+
+	// Test body
+	try
+	{
+		// Parse the configuration file
+		System *system = System::getInstance();
+		system->ParseConfiguration(&ini_file);
+		Network *network = system->getNetworkByName("net0");
+		RoutingTable *table = network->getRoutingTable();
+
+		// Routes take the shortest way around the ring
+		for (int i = 0; i < 6; i++)
+		{
+			for (int j = 0; j < 6; j++)
+			{
+				Node *source = network->getNodeByName(
+						misc::fmt("n%d", i));
+				Node *destination = network->getNodeByName(
+						misc::fmt("n%d", j));
+				int distance = (j - i + 6) % 6;
+				distance = std::min(distance, 6 - distance);
+				EXPECT_EQ(i == j ? 0 : distance + 2,
+						table->getCost(source,
+						destination));
+			}
+		}
+
+		// The first virtual channel is used
+		Node *S0 = network->getNodeByName("s0");
+		Node *N1 = network->getNodeByName("n1");
+		RoutingTable::Entry *entry = table->Lookup(S0, N1);
+		Connection *connection = entry->getBuffer()->getConnection();
+		EXPECT_EQ(entry->getBuffer(), connection->getSourceBuffer(0));
+		EXPECT_EQ(network->getNodeByName("s1"), entry->getNextNode());
+	}
+	catch (misc::Error &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+}
+
 }
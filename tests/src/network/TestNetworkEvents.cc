@@ -1884,4 +1884,67 @@ TEST(TestSystemConfiguration, event_config_13_ideal_fix_latency)
 	}
 }
 
+TEST(TestSystemConfiguration, event_config_7_latency_statistics)
+{
+	// cleanup singleton instance
+	Cleanup();
+
+	std::string net_config =
+			"[ Network.net0 ]\n"
+			"DefaultInputBufferSize = 4\n"
+			"DefaultOutputBufferSize = 4\n"
+			"DefaultBandwidth = 1\n"
+			"\n"
+			"[ Network.net0.Node.n0 ]\n"
+			"Type = EndNode\n"
+			"\n"
+			"[ Network.net0.Node.n1 ]\n"
+			"Type = EndNode\n"
+			"\n"
+			"[ Network.net0.Node.s0 ]\n"
+			"Type = Switch\n"
+			"\n"
+			"[ Network.net0.Link.n0-s0 ]\n"
+			"Type = Bidirectional\n"
+			"Source = n0\n"
+			"Dest = s0\n"
+			"\n"
+			"[ Network.net0.Link.n1-s0 ]\n"
+			"Type = Bidirectional\n"
+			"Source = n1\n"
+			"Dest = s0";
+
+	// Set up INI file
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(net_config);
+
+	// Set up network instance
+	System *network_system = System::getInstance();
+	network_system->ParseConfiguration(&ini_file);
+	Network *network = network_system->getNetworkByName("net0");
+	EndNode *src = misc::cast<EndNode *>(network->getNodeByName("n0"));
+	EndNode *dst = misc::cast<EndNode *>(network->getNodeByName("n1"));
+
+	// No messages delivered
+	EXPECT_EQ(0.0, network->getAverageLatency());
+	EXPECT_EQ(0, network->getLatencyPercentile(1.0));
+
+	// Send four messages in the same cycle, which are serialized in the
+	// output buffer of the source
+	for (int i = 0; i < 4; i++)
+		network->Send(src, dst, 1);
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	for (int i = 0; i < 100 && network->getNumTransfers() < 4; i++)
+		esim_engine->ProcessEvents();
+	ASSERT_EQ(4, network->getNumTransfers());
+
+	// Latencies are all different
+	long long min_latency = network->getLatencyPercentile(0.0);
+	long long p50_latency = network->getLatencyPercentile(0.5);
+	long long max_latency = network->getLatencyPercentile(1.0);
+	EXPECT_EQ(min_latency + 1, p50_latency);
+	EXPECT_EQ(min_latency + 3, max_latency);
+	EXPECT_EQ(min_latency + 1.5, network->getAverageLatency());
+}
+
 }
@@ -0,0 +1,311 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2016  Amir Kavyan Ziabari (aziabari@ece.neu.edu)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <dirent.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <unistd.h>
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/cpp/String.h>
+#include <lib/esim/Engine.h>
+#include <network/Network.h>
+#include <network/RoutingTable.h>
+#include <network/System.h>
+
+namespace net
+{
+
+// Size of the header of a routing table cache file: magic string, hash, and
+// dimension
+static const int cache_header_size = 8 + sizeof(unsigned long long) +
+		sizeof(int);
+
+
+// Create network 'net0', a mesh of size x size switches with one end node
+// per switch, given in the configuration file so that its routes are
+// computed with a table.
+static Network *CreateMesh(int size)
+{
+	// Cleanup singleton instances
+	esim::Engine::Destroy();
+	System::Destroy();
+
+	// Nodes
+	std::string config =
+			"[ Network.net0 ]\n"
+			"DefaultInputBufferSize = 4\n"
+			"DefaultOutputBufferSize = 4\n"
+			"DefaultBandwidth = 1\n";
+	int num_switches = size * size;
+	for (int i = 0; i < num_switches; i++)
+		config += misc::fmt("[ Network.net0.Node.n%d ]\n"
+				"Type = EndNode\n"
+				"[ Network.net0.Node.s%d ]\n"
+				"Type = Switch\n", i, i);
+
+	// Links
+	for (int i = 0; i < num_switches; i++)
+	{
+		config += misc::fmt("[ Network.net0.Link.n%d-s%d ]\n"
+				"Type = Bidirectional\n"
+				"Source = n%d\n"
+				"Dest = s%d\n", i, i, i, i);
+		if (i % size < size - 1)
+			config += misc::fmt("[ Network.net0.Link.s%d-s%d ]\n"
+					"Type = Bidirectional\n"
+					"Source = s%d\n"
+					"Dest = s%d\n", i, i + 1, i, i + 1);
+		if (i + size < num_switches)
+			config += misc::fmt("[ Network.net0.Link.s%d-s%d ]\n"
+					"Type = Bidirectional\n"
+					"Source = s%d\n"
+					"Dest = s%d\n", i, i + size, i, i + size);
+	}
+
+	// Network
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(config);
+	System *network_system = System::getInstance();
+	network_system->ParseConfiguration(&ini_file);
+	return network_system->getNetworkByName("net0");
+}
+
+
+// Return whether two routing tables of the network give the same next node
+// and output buffer for every pair of nodes
+static bool SameRoutes(Network *network, const RoutingTable &a,
+		const RoutingTable &b)
+{
+	for (int i = 0; i < network->getNumNodes(); i++)
+	{
+		for (int j = 0; j < network->getNumNodes(); j++)
+		{
+			Node *source = network->getNode(i);
+			Node *destination = network->getNode(j);
+			RoutingTable::Entry *entry_a = a.Lookup(source,
+					destination);
+			RoutingTable::Entry *entry_b = b.Lookup(source,
+					destination);
+			if (entry_a->getNextNode() != entry_b->getNextNode() ||
+					entry_a->getBuffer() !=
+					entry_b->getBuffer())
+				return false;
+		}
+	}
+	return true;
+}
+
+
+// Return the path of the only file in a directory, or an empty string if
+// there is not exactly one
+static std::string getOnlyFile(const std::string &directory)
+{
+	std::string path;
+	int num_files = 0;
+	DIR *dir = opendir(directory.c_str());
+	if (!dir)
+		return "";
+	while (struct dirent *entry = readdir(dir))
+	{
+		std::string name = entry->d_name;
+		if (name == "." || name == "..")
+			continue;
+		path = directory + "/" + name;
+		num_files++;
+	}
+	closedir(dir);
+	return num_files == 1 ? path : "";
+}
+
+
+// Read a whole file
+static std::string ReadFile(const std::string &path)
+{
+	std::ifstream f(path, std::ios::binary);
+	std::ostringstream contents;
+	contents << f.rdbuf();
+	return contents.str();
+}
+
+
+// Write a whole file
+static void WriteFile(const std::string &path, const std::string &contents)
+{
+	std::ofstream f(path, std::ios::binary);
+	f << contents;
+}
+
+
+// Remove a cache directory with its files
+static void RemoveCacheDirectory(const std::string &directory)
+{
+	std::string path;
+	while (!(path = getOnlyFile(directory)).empty())
+		remove(path.c_str());
+	rmdir(directory.c_str());
+}
+
+
+TEST(TestRoutingTable, cache_save_load)
+{
+	char directory[] = "/tmp/m2s-route-cache-XXXXXX";
+	ASSERT_TRUE(mkdtemp(directory) != nullptr);
+	try
+	{
+		// Routes computed without cache
+		Network *network = CreateMesh(4);
+		RoutingTable reference(network);
+		reference.ComputeRoutes();
+
+		// Routes computed and saved into the cache
+		System::setRouteCacheDirectory(directory);
+		RoutingTable saved(network);
+		saved.ComputeRoutes();
+		std::string path = getOnlyFile(directory);
+		ASSERT_FALSE(path.empty());
+		std::string contents = ReadFile(path);
+		int dimension = network->getNumNodes();
+		EXPECT_EQ(cache_header_size + dimension * dimension * 2,
+				(int) contents.size());
+		EXPECT_EQ("M2SROUTE", contents.substr(0, 8));
+
+		// Routes loaded from the cache
+		RoutingTable loaded(network);
+		loaded.ComputeRoutes();
+		EXPECT_TRUE(SameRoutes(network, reference, saved));
+		EXPECT_TRUE(SameRoutes(network, reference, loaded));
+
+		// The table is really loaded from the file. Routes all through
+		// the first hop of each node differ from the shortest routes.
+		std::string first_hops = contents.substr(0, cache_header_size) +
+				std::string(contents.size() - cache_header_size,
+				'\0');
+		WriteFile(path, first_hops);
+		RoutingTable modified(network);
+		modified.ComputeRoutes();
+		EXPECT_FALSE(SameRoutes(network, reference, modified));
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+	System::setRouteCacheDirectory("");
+	RemoveCacheDirectory(directory);
+}
+
+
+TEST(TestRoutingTable, cache_rejected)
+{
+	char directory[] = "/tmp/m2s-route-cache-XXXXXX";
+	ASSERT_TRUE(mkdtemp(directory) != nullptr);
+	try
+	{
+		// Routes computed without cache
+		Network *network = CreateMesh(4);
+		RoutingTable reference(network);
+		reference.ComputeRoutes();
+
+		// Cache file
+		System::setRouteCacheDirectory(directory);
+		RoutingTable saved(network);
+		saved.ComputeRoutes();
+		std::string path = getOnlyFile(directory);
+		ASSERT_FALSE(path.empty());
+		std::string contents = ReadFile(path);
+
+		// Table with wrong routes, which would be detected if loaded
+		std::string first_hops = contents.substr(0, cache_header_size) +
+				std::string(contents.size() - cache_header_size,
+				'\0');
+
+		// Hash of another topology
+		std::string wrong_hash = first_hops;
+		wrong_hash[8] ^= 1;
+		WriteFile(path, wrong_hash);
+		RoutingTable hash_table(network);
+		hash_table.ComputeRoutes();
+		EXPECT_TRUE(SameRoutes(network, reference, hash_table));
+
+		// The file was replaced with the recomputed routes
+		EXPECT_EQ(contents, ReadFile(path));
+
+		// Truncated file
+		WriteFile(path, first_hops.substr(0, first_hops.size() - 1));
+		RoutingTable truncated_table(network);
+		truncated_table.ComputeRoutes();
+		EXPECT_TRUE(SameRoutes(network, reference, truncated_table));
+		EXPECT_EQ(contents, ReadFile(path));
+
+		// File with extra data at the end
+		WriteFile(path, first_hops + '\0');
+		RoutingTable extended_table(network);
+		extended_table.ComputeRoutes();
+		EXPECT_TRUE(SameRoutes(network, reference, extended_table));
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+	System::setRouteCacheDirectory("");
+	RemoveCacheDirectory(directory);
+}
+
+
+TEST(TestRoutingTable, parallel_breadth_first_search)
+{
+	try
+	{
+		// Large enough to compute the routes in parallel
+		Network *network = CreateMesh(12);
+		ASSERT_GE(network->getNumNodes(), 256);
+
+		// Sequential and parallel searches
+		System::setRouteThreads(1);
+		RoutingTable sequential(network);
+		sequential.ComputeRoutes();
+		System::setRouteThreads(4);
+		RoutingTable parallel(network);
+		parallel.ComputeRoutes();
+		EXPECT_TRUE(SameRoutes(network, sequential, parallel));
+
+		// Shortest routes between the corners of the mesh, through
+		// 12 + 12 - 2 switch-to-switch links and the two end node links
+		Node *first = network->getNodeByName("n0");
+		Node *last = network->getNodeByName("n143");
+		EXPECT_EQ(24, parallel.getCost(first, last));
+	}
+	catch (misc::Exception &e)
+	{
+		e.Dump();
+		FAIL();
+	}
+	System::setRouteThreads(0);
+}
+
+
+}  // namespace net
@@ -0,0 +1,331 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Amir Kavyan Ziabari (ziabari@gmail.com)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <lib/cpp/Error.h>
+#include <lib/cpp/IniFile.h>
+#include <lib/esim/Engine.h>
+#include <network/EndNode.h>
+#include <network/Link.h>
+#include <network/Network.h>
+#include <network/System.h>
+
+namespace net
+{
+
+static Network *CreateNetwork(const std::string &parameters)
+{
+	// Cleanup singleton instances
+	esim::Engine::Destroy();
+	System::Destroy();
+
+	// Configuration
+	std::string net_config =
+			"[ Network.net0 ]\n"
+			"DefaultInputBufferSize = 4\n"
+			"DefaultOutputBufferSize = 4\n"
+			"DefaultBandwidth = 1\n" +
+			parameters;
+	misc::IniFile ini_file;
+	ini_file.LoadFromString(net_config);
+	System *network_system = System::getInstance();
+	network_system->ParseConfiguration(&ini_file);
+	return network_system->getNetworkByName("net0");
+}
+
+
+// Follow the routes between all pairs of end nodes. Return the total number
+// of hops, and check that the dependencies between output buffers along
+// the routes have no cycle.
+static int CheckRoutes(Network *network)
+{
+	RoutingTable *routing_table = network->getRoutingTable();
+	Topology *topology = network->getTopology();
+	int num_end_nodes = topology->getNumEndNodes();
+	std::map<Buffer *, std::set<Buffer *>> dependencies;
+	int num_hops = 0;
+	for (int i = 0; i < num_end_nodes; i++)
+	{
+		for (int j = 0; j < num_end_nodes; j++)
+		{
+			Node *node = network->getNode(i);
+			Node *destination = network->getNode(j);
+			Buffer *last_buffer = nullptr;
+			int hops = 0;
+			while (node != destination)
+			{
+				RoutingTable::Entry *entry = routing_table->
+						Lookup(node, destination);
+				Buffer *buffer = entry->getBuffer();
+				EXPECT_TRUE(buffer != nullptr);
+				if (!buffer || ++hops > network->getNumNodes())
+					return -1;
+				EXPECT_EQ(node, buffer->getNode());
+				if (last_buffer)
+					dependencies[last_buffer].insert(buffer);
+				last_buffer = buffer;
+				node = entry->getNextNode();
+			}
+			num_hops += hops;
+		}
+	}
+
+	// Depth-first search for cycles
+	std::map<Buffer *, int> state;
+	std::function<bool(Buffer *)> has_cycle = [&](Buffer *buffer)
+	{
+		int &buffer_state = state[buffer];
+		if (buffer_state == 1)
+			return true;
+		if (buffer_state == 2)
+			return false;
+		buffer_state = 1;
+		for (Buffer *next : dependencies[buffer])
+			if (has_cycle(next))
+				return true;
+		state[buffer] = 2;
+		return false;
+	};
+	for (auto &it : dependencies)
+		EXPECT_FALSE(has_cycle(it.first));
+	return num_hops;
+}
+
+
+// Send one message between every pair of end nodes, with all end nodes
+// sending at the same time, and return the number of messages delivered
+// after all of them are sent or a time limit.
+static int DeliverAll(Network *network)
+{
+	int num_end_nodes = network->getTopology()->getNumEndNodes();
+	esim::Engine *esim_engine = esim::Engine::getInstance();
+	std::vector<int> num_sent(num_end_nodes);
+	for (int cycle = 0; cycle < 20000 && network->getNumTransfers() <
+			num_end_nodes * (num_end_nodes - 1); cycle++)
+	{
+		for (int i = 0; i < num_end_nodes; i++)
+		{
+			if (num_sent[i] == num_end_nodes - 1)
+				continue;
+			EndNode *source = misc::cast<EndNode *>(
+					network->getNode(i));
+			EndNode *destination = misc::cast<EndNode *>(
+					network->getNode((i + num_sent[i] + 1) %
+					num_end_nodes));
+			if (!network->CanSend(source, destination, 4))
+				continue;
+			network->Send(source, destination, 4);
+			num_sent[i]++;
+		}
+		esim_engine->ProcessEvents();
+	}
+	return network->getNumTransfers();
+}
+
+
+TEST(TestTopology, mesh)
+{
+	Network *network = CreateNetwork(
+			"Topology = Mesh\n"
+			"Dimensions = 4x3\n");
+	Topology *topology = network->getTopology();
+	ASSERT_TRUE(topology != nullptr);
+	EXPECT_EQ(12, topology->getNumEndNodes());
+	EXPECT_EQ(12, topology->getNumSwitches());
+	EXPECT_EQ(12, network->getNumEndNodes());
+	EXPECT_EQ(network->getNode(5), network->getNodeByName("n5"));
+	EXPECT_EQ(network->getNode(12), network->getNodeByName("s0"));
+
+	// Minimal routes: Manhattan distance plus the two end node links
+	int expected = 0;
+	for (int i = 0; i < 12; i++)
+		for (int j = 0; j < 12; j++)
+			if (i != j)
+				expected += std::abs(i % 4 - j % 4) +
+						std::abs(i / 4 - j / 4) + 2;
+	EXPECT_EQ(expected, CheckRoutes(network));
+}
+
+TEST(TestTopology, torus)
+{
+	Network *network = CreateNetwork(
+			"Topology = Torus\n"
+			"Dimensions = 5x4\n");
+	EXPECT_EQ(20, network->getTopology()->getNumEndNodes());
+
+	// Minimal routes around the rings
+	int expected = 0;
+	for (int i = 0; i < 20; i++)
+	{
+		for (int j = 0; j < 20; j++)
+		{
+			if (i == j)
+				continue;
+			int dx = std::abs(i % 5 - j % 5);
+			int dy = std::abs(i / 5 - j / 5);
+			expected += std::min(dx, 5 - dx) +
+					std::min(dy, 4 - dy) + 2;
+		}
+	}
+	EXPECT_EQ(expected, CheckRoutes(network));
+}
+
+TEST(TestTopology, fat_tree)
+{
+	Network *network = CreateNetwork(
+			"Topology = FatTree\n"
+			"Arity = 2\n"
+			"Levels = 3\n");
+	Topology *topology = network->getTopology();
+	EXPECT_EQ(8, topology->getNumEndNodes());
+	EXPECT_EQ(12, topology->getNumSwitches());
+
+	// Routes go up to the lowest common ancestor and down
+	int expected = 0;
+	for (int i = 0; i < 8; i++)
+	{
+		for (int j = 0; j < 8; j++)
+		{
+			if (i == j)
+				continue;
+			int level = 0;
+			while ((i >> (level + 1)) != (j >> (level + 1)))
+				level++;
+			expected += 2 * level + 2;
+		}
+	}
+	EXPECT_EQ(expected, CheckRoutes(network));
+}
+
+TEST(TestTopology, dragonfly)
+{
+	Network *network = CreateNetwork(
+			"Topology = Dragonfly\n"
+			"RoutersPerGroup = 4\n"
+			"TerminalsPerRouter = 2\n"
+			"GlobalLinksPerRouter = 2\n");
+	Topology *topology = network->getTopology();
+	EXPECT_EQ(9 * 4 * 2, topology->getNumEndNodes());
+	EXPECT_EQ(9 * 4, topology->getNumSwitches());
+	EXPECT_GT(CheckRoutes(network), 0);
+}
+
+TEST(TestTopology, deliver_messages)
+{
+	Network *network = CreateNetwork(
+			"Topology = Torus\n"
+			"Dimensions = 3x3\n");
+	EXPECT_EQ(9 * 8, DeliverAll(network));
+}
+
+TEST(TestTopology, adaptive_routes)
+{
+	Network *network = CreateNetwork(
+			"Topology = Mesh\n"
+			"Dimensions = 4x4\n"
+			"Routing = Adaptive\n");
+	Topology *topology = network->getTopology();
+	EXPECT_TRUE(topology->isAdaptive());
+
+	// Both productive directions from the corner, on the adaptive
+	// channel, which is the last one of links between switches
+	std::vector<Buffer *> buffers;
+	Node *s0 = network->getNodeByName("s0");
+	topology->getAdaptiveRoutes(s0, network->getNodeByName("n15"),
+			buffers);
+	ASSERT_EQ(2u, buffers.size());
+	for (Buffer *buffer : buffers)
+	{
+		Link *link = misc::cast<Link *>(buffer->getConnection());
+		EXPECT_EQ(2, link->getNumVirtualChannels());
+		EXPECT_EQ(link->getSourceBuffer(1), buffer);
+	}
+
+	// Only the escape route towards the attached end node
+	buffers.clear();
+	topology->getAdaptiveRoutes(s0, network->getNodeByName("n0"),
+			buffers);
+	EXPECT_TRUE(buffers.empty());
+
+	// Escape routes reach every end node with no cyclic dependence
+	EXPECT_GT(CheckRoutes(network), 0);
+}
+
+TEST(TestTopology, adaptive_deliver_messages)
+{
+	// Every end node sends to every other one at the same time, so
+	// packets wait on full adaptive channels and take escape routes
+	const char *topologies[] =
+	{
+		"Topology = Mesh\nDimensions = 4x4\n",
+		"Topology = Torus\nDimensions = 4x3\n",
+		"Topology = FatTree\nArity = 2\nLevels = 3\n",
+		"Topology = Dragonfly\nRoutersPerGroup = 2\n"
+				"TerminalsPerRouter = 2\n"
+				"GlobalLinksPerRouter = 1\n"
+	};
+	for (const char *topology : topologies)
+	{
+		Network *network = CreateNetwork(std::string(topology) +
+				"Routing = Adaptive\n");
+		int num_end_nodes = network->getTopology()->getNumEndNodes();
+		EXPECT_EQ(num_end_nodes * (num_end_nodes - 1),
+				DeliverAll(network)) << topology;
+	}
+}
+
+TEST(TestTopology, invalid)
+{
+	EXPECT_THROW(CreateNetwork("Topology = Ring\n"), Error);
+	EXPECT_THROW(CreateNetwork("Topology = Mesh\n"
+			"Dimensions = 4x0\n"), Error);
+	EXPECT_THROW(CreateNetwork("Topology = Mesh\n"
+			"Dimensions = 4x4\n"
+			"Routing = Random\n"), Error);
+	EXPECT_THROW(CreateNetwork("Topology = FatTree\n"
+			"Arity = 1\n"
+			"Levels = 2\n"), Error);
+
+	// Nodes cannot be listed
+	std::string message;
+	try
+	{
+		CreateNetwork("Topology = Mesh\n"
+				"Dimensions = 2x2\n"
+				"\n"
+				"[ Network.net0.Node.n0 ]\n"
+				"Type = EndNode\n");
+	}
+	catch (Error &e)
+	{
+		message = e.getMessage();
+	}
+	EXPECT_NE(std::string::npos, message.find(
+			"Section 'Network.net0.Node.n0' not allowed"));
+}
+
+}  // namespace net
@@ -0,0 +1,141 @@
+/*
+ *  Multi2Sim
+ *  Copyright (C) 2015  Amir Kavyan Ziabari (ziabari@gmail.com)
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "gtest/gtest.h"
+
+#include <vector>
+
+#include <lib/cpp/Error.h>
+#include <network/System.h>
+#include <network/TrafficPattern.h>
+
+namespace net
+{
+
+TEST(TestTrafficPattern, uniform_never_self)
+{
+	TrafficPattern pattern(TrafficPattern::KindUniform, 5);
+	std::vector<int> count(5);
+	for (int i = 0; i < 1000; i++)
+	{
+		int destination = pattern.getDestination(2);
+		ASSERT_NE(2, destination);
+		ASSERT_TRUE(destination >= 0 && destination < 5);
+		count[destination]++;
+	}
+	for (int i = 0; i < 5; i++)
+		if (i != 2)
+			EXPECT_GT(count[i], 0);
+	EXPECT_FALSE(pattern.isIdle(2));
+}
+
+TEST(TestTrafficPattern, transpose)
+{
+	// 4x4 grid, node (x, y) = y * 4 + x
+	TrafficPattern pattern(TrafficPattern::KindTranspose, 16);
+	EXPECT_EQ(4, pattern.getSide());
+	EXPECT_EQ(4, pattern.getDestination(1));
+	EXPECT_EQ(1, pattern.getDestination(4));
+	EXPECT_EQ(14, pattern.getDestination(11));
+	EXPECT_TRUE(pattern.isIdle(0));
+	EXPECT_TRUE(pattern.isIdle(5));
+	EXPECT_FALSE(pattern.isIdle(6));
+}
+
+TEST(TestTrafficPattern, transpose_not_square)
+{
+	std::string message;
+	try
+	{
+		TrafficPattern pattern(TrafficPattern::KindTranspose, 8);
+	}
+	catch (Error &e)
+	{
+		message = e.getMessage();
+	}
+	EXPECT_REGEX_MATCH("Traffic pattern 'transpose' requires a square "
+			"number of end nodes \\(8 found\\)",
+			message.c_str());
+}
+
+TEST(TestTrafficPattern, bit_complement)
+{
+	TrafficPattern pattern(TrafficPattern::KindBitComplement, 8);
+	for (int i = 0; i < 8; i++)
+		EXPECT_EQ(~i & 7, pattern.getDestination(i));
+
+	// Middle node of an odd number of nodes is idle
+	TrafficPattern odd(TrafficPattern::KindBitComplement, 5);
+	EXPECT_TRUE(odd.isIdle(2));
+	EXPECT_EQ(4, odd.getDestination(0));
+}
+
+TEST(TestTrafficPattern, hotspot)
+{
+	// All traffic to the hotspot
+	TrafficPattern pattern(TrafficPattern::KindHotspot, 6, 3, 1.0);
+	for (int i = 0; i < 6; i++)
+		if (i != 3)
+			EXPECT_EQ(3, pattern.getDestination(i));
+
+	// The hotspot itself sends uniformly
+	for (int i = 0; i < 100; i++)
+		EXPECT_NE(3, pattern.getDestination(3));
+
+	// Invalid parameters
+	EXPECT_THROW(TrafficPattern(TrafficPattern::KindHotspot, 6, 6),
+			Error);
+	EXPECT_THROW(TrafficPattern(TrafficPattern::KindHotspot, 6, 0, 1.5),
+			Error);
+}
+
+TEST(TestTrafficPattern, tornado)
+{
+	// Ring of 8 nodes: half way minus one
+	TrafficPattern ring(TrafficPattern::KindTornado, 8);
+	EXPECT_EQ(0, ring.getSide());
+	EXPECT_EQ(3, ring.getDestination(0));
+	EXPECT_EQ(2, ring.getDestination(7));
+
+	// 4x4 grid: offset of 1 in both dimensions
+	TrafficPattern grid(TrafficPattern::KindTornado, 16);
+	EXPECT_EQ(5, grid.getDestination(0));
+	EXPECT_EQ(0, grid.getDestination(15));
+}
+
+TEST(TestTrafficPattern, neighbor)
+{
+	// Ring
+	TrafficPattern ring(TrafficPattern::KindNeighbor, 5);
+	EXPECT_EQ(1, ring.getDestination(0));
+	EXPECT_EQ(0, ring.getDestination(4));
+
+	// Grid, wrapping around within a row
+	TrafficPattern grid(TrafficPattern::KindNeighbor, 9);
+	EXPECT_EQ(4, grid.getDestination(3));
+	EXPECT_EQ(3, grid.getDestination(5));
+	EXPECT_FALSE(grid.isIdle(8));
+}
+
+TEST(TestTrafficPattern, too_few_nodes)
+{
+	EXPECT_THROW(TrafficPattern(TrafficPattern::KindUniform, 1), Error);
+}
+
+}  // namespace net
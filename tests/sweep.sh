@@ -0,0 +1,103 @@
+#!/bin/sh
+#
+# End-to-end test of option '--sweep', run with 'make check'. A sweep with
+# two configurations is simulated on the MIPS sample program, checking that
+# each worker applies only its own options and writes its own output files.
+# A detailed x86 simulation after a functional fast-forward must commit
+# instructions, and a configuration with a stand-alone simulation option
+# must be rejected.
+#
+# The m2s binary and the samples directory are given in environment
+# variables M2S and SAMPLES.
+#
+
+if [ -z "$M2S" ] || [ -z "$SAMPLES" ]
+then
+	echo "usage: M2S=<m2s binary> SAMPLES=<samples directory> $0" >&2
+	exit 1
+fi
+m2s=$(cd "$(dirname "$M2S")" && pwd)/$(basename "$M2S")
+samples=$(cd "$SAMPLES" && pwd)
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+cp "$samples/mips/test-sort" "$samples/hsa/vector_copy/vector_copy" "$tmp"
+cd "$tmp" || exit 1
+
+# Report a failure
+#	$1 - Message
+fail()
+{
+	echo "FAIL: $1" >&2
+	exit 1
+}
+
+# Sweep with two configurations
+cat > sweep.ini << EOF
+[ General ]
+FastForward = 1000
+Workers = 2
+
+[ Config 0 ]
+Name = first
+Options = --mips-debug-syscall syscall-first
+
+[ Config 1 ]
+Name = second
+Options = --mips-debug-syscall syscall-second --mips-debug-ctx ctx-second --mips-no-decode-cache
+EOF
+"$m2s" --sweep sweep.ini test-sort > output 2>&1 ||
+	fail "sweep exited with an error"
+
+# Both workers finished and ran the guest program to completion
+[ "$(grep -c '^ExitStatus = 0$' sweep-report)" = 2 ] ||
+	fail "sweep report does not have two successful configurations"
+for name in first second
+do
+	grep -q "^\[ $name MIPS \]$" sweep-report ||
+		fail "no summary for configuration '$name'"
+	grep -q '^Finished$' sweep-report.$name.log ||
+		fail "no guest output in log of configuration '$name'"
+done
+
+# Each worker wrote the output files given in its own options
+[ -s syscall-first ] && [ -s syscall-second ] && [ -s ctx-second ] ||
+	fail "missing output file of a configuration"
+grep '^system call' syscall-first > calls-first
+grep '^system call' syscall-second > calls-second
+cmp -s calls-first calls-second ||
+	fail "configurations simulated different system calls"
+
+# Detailed x86 simulation after the fast-forward, on the statically linked
+# host program of an HSA sample
+cat > sweep.ini << EOF
+[ General ]
+FastForward = 1000
+Workers = 1
+
+[ Config 0 ]
+Name = detailed
+Options = --x86-sim detailed --x86-max-inst 2000
+EOF
+"$m2s" --sweep sweep.ini vector_copy > output 2>&1 ||
+	fail "detailed sweep exited with an error"
+grep -q '^ExitStatus = 0$' sweep-report ||
+	fail "detailed configuration failed"
+grep -q '^\[ detailed x86 \]$' sweep-report ||
+	fail "no x86 summary for the detailed configuration"
+committed=$(sed -n 's/^CommittedInstructions = //p' sweep-report)
+[ -n "$committed" ] && [ "$committed" -gt 0 ] ||
+	fail "detailed configuration committed no instructions"
+
+# Stand-alone simulations are rejected
+cat > sweep.ini << EOF
+[ Config 0 ]
+Options = --net-sim net0
+EOF
+if "$m2s" --sweep sweep.ini test-sort > output 2>&1
+then
+	fail "option '--net-sim' accepted in a configuration"
+fi
+grep -q "Option '--net-sim' not allowed" output ||
+	fail "wrong error message for option '--net-sim'"
+
+exit 0
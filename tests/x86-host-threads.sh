@@ -0,0 +1,80 @@
+#!/bin/sh
+#
+# End-to-end test of option '--x86-host-threads', run with 'make check'. The
+# statically linked host program of an HSA sample is simulated on a two-core
+# detailed x86 model, stepping the cores on host threads. Repeated runs must
+# give the same report, and emulate and commit as many instructions as the
+# sequential simulation.
+#
+# The m2s binary and the samples directory are given in environment
+# variables M2S and SAMPLES.
+#
+
+if [ -z "$M2S" ] || [ -z "$SAMPLES" ]
+then
+	echo "usage: M2S=<m2s binary> SAMPLES=<samples directory> $0" >&2
+	exit 1
+fi
+m2s=$(cd "$(dirname "$M2S")" && pwd)/$(basename "$M2S")
+samples=$(cd "$SAMPLES" && pwd)
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+cp "$samples/hsa/vector_copy/vector_copy" "$tmp"
+cd "$tmp" || exit 1
+
+# Report a failure
+#	$1 - Message
+fail()
+{
+	echo "FAIL: $1" >&2
+	exit 1
+}
+
+cat > x86.ini << EOF
+[ General ]
+Cores = 2
+EOF
+
+# Simulate the host program until it commits 10000 instructions, before it
+# loads the kernel binary, which is not distributed with the sample
+#	$1 - Name of the run
+#	$2... - Additional options
+simulate()
+{
+	name=$1
+	shift
+	"$m2s" --x86-sim detailed --x86-config x86.ini --x86-max-inst 10000 \
+			--x86-report report-$name "$@" vector_copy \
+			> output-$name 2>&1 ||
+		fail "simulation '$name' exited with an error"
+	grep -q '^SimEnd = X86MaxInstructions$' output-$name ||
+		fail "simulation '$name' did not reach the instruction limit"
+
+	# Report without the host time
+	grep -v '^\(Time\|CyclesPerSecond\) = ' report-$name \
+			> stats-$name
+}
+
+simulate sequential
+simulate parallel --x86-host-threads 2
+simulate repeated --x86-host-threads 2
+
+# Parallel simulations are deterministic
+cmp -s stats-parallel stats-repeated ||
+	fail "parallel simulations gave different reports"
+
+# Same instructions emulated, including those in the wrong path, and
+# committed as in the sequential simulation
+for counter in Instructions CommittedInstructions CommittedMicroInstructions
+do
+	sequential=$(sed -n "/^\[ x86 \]$/,/^$/s/^$counter = //p" \
+			output-sequential)
+	parallel=$(sed -n "/^\[ x86 \]$/,/^$/s/^$counter = //p" \
+			output-parallel)
+	[ -n "$sequential" ] && [ "$sequential" -gt 0 ] ||
+		fail "no $counter in the sequential simulation"
+	[ "$parallel" = "$sequential" ] ||
+		fail "$counter is $parallel in the parallel simulation, $sequential in the sequential one"
+done
+
+exit 0